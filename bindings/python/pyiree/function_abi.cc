@@ -87,17 +87,6 @@ py::object PyRawUnpackResults(FunctionAbi* self, VmVariantList& f_args) {
   return py_result_tuple;
 }
 
-// RAII wrapper for a Py_buffer which calls PyBuffer_Release when it goes
-// out of scope.
-class PyBufferReleaser {
- public:
-  PyBufferReleaser(Py_buffer& b) : b_(b) {}
-  ~PyBufferReleaser() { PyBuffer_Release(&b_); }
-
- private:
-  Py_buffer& b_;
-};
-
 pybind11::error_already_set RaiseBufferMismatchError(
     std::string message, py::handle obj,
     const RawSignatureParser::Description& desc) {
@@ -335,66 +324,55 @@ void FunctionAbi::PackBuffer(const RawSignatureParser::Description& desc,
                              py::handle py_arg, VmVariantList& f_args,
                              bool writable) {
   // Request a view of the buffer (use the raw python C API to avoid some
-  // allocation and copying at the pybind level).
-  Py_buffer py_view;
-  // Note that only C-Contiguous ND-arrays are presently supported, so
-  // only request that via PyBUF_ND. Long term, we should consult an
-  // "oracle" in the runtime to determine the precise required format and
-  // set flags accordingly (and fallback/copy on failure).
-  int flags = PyBUF_FORMAT | PyBUF_ND;
+  // allocation and copying at the pybind level). Strides are requested so
+  // that non C-contiguous arrays can be accepted by copying. Long term, we
+  // should consult an "oracle" in the runtime to determine the precise
+  // required format and set flags accordingly.
+  int flags = PyBUF_FORMAT | PyBUF_STRIDES;
   if (writable) {
     flags |= PyBUF_WRITABLE;
   }
-
-  // Acquire the backing buffer and setup RAII release.
-  if (PyObject_GetBuffer(py_arg.ptr(), &py_view, flags) != 0) {
-    // The GetBuffer call is required to set an appropriate error.
-    throw py::error_already_set();
-  }
-  PyBufferReleaser py_view_releaser(py_view);
-
-  // Whether the py object needs to be retained with the argument.
-  // Should be set to true if directly mapping, false if copied.
-  bool depends_on_pyobject = false;
+  PyBufferPtr py_view = AcquirePyBuffer(py_arg, flags);
 
   // Verify compatibility.
   absl::InlinedVector<int, 2> dynamic_dims;
-  MapBufferAttrs(py_view, desc, dynamic_dims);
+  MapBufferAttrs(*py_view, desc, dynamic_dims);
   if (!dynamic_dims.empty()) {
     throw RaisePyError(PyExc_NotImplementedError,
                        "Dynamic argument dimensions not implemented");
   }
 
-  // Allocate a HalBuffer.
+  // Use the original buffer if the layout and alignment allow and otherwise
+  // copy into a new buffer. The wrapped buffer retains the exporting object
+  // for as long as it is in use.
   // This is hard-coded to C-contiguous right now.
   // TODO(laurenzo): Expand to other layouts as needed.
-  // TODO(laurenzo): Wrap and retain original buffer (depends_on_pyobject=true).
-  iree_hal_buffer_t* raw_buffer;
-  CheckApiStatus(iree_hal_allocator_allocate_buffer(
-                     device_.allocator(),
-                     static_cast<iree_hal_memory_type_t>(
-                         IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
-                         IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE),
-                     IREE_HAL_BUFFER_USAGE_ALL, py_view.len, &raw_buffer),
-                 "Failed to allocate device visible buffer");
-  CheckApiStatus(
-      iree_hal_buffer_write_data(raw_buffer, 0, py_view.buf, py_view.len),
-      "Error writing to input buffer");
-  iree_vm_ref_t buffer_ref = iree_hal_buffer_move_ref(raw_buffer);
+  iree_hal_memory_type_t memory_type = static_cast<iree_hal_memory_type_t>(
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE);
+  iree_hal_memory_access_t allowed_access =
+      writable ? IREE_HAL_MEMORY_ACCESS_ALL : IREE_HAL_MEMORY_ACCESS_READ;
+  HalBuffer buffer = WrapPyBuffer(
+      py_view, [&](iree_byte_span_t data,
+                   iree_hal_buffer_release_callback_t release_callback,
+                   iree_hal_buffer_t** out_buffer) {
+        return iree_hal_allocator_wrap_buffer_with_release(
+            device_.allocator(), memory_type, allowed_access,
+            IREE_HAL_BUFFER_USAGE_ALL, data, release_callback, out_buffer);
+      });
+  if (!buffer) {
+    iree_hal_buffer_t* raw_buffer;
+    CheckApiStatus(iree_hal_allocator_allocate_buffer(
+                       device_.allocator(), memory_type,
+                       IREE_HAL_BUFFER_USAGE_ALL, py_view->len, &raw_buffer),
+                   "Failed to allocate device visible buffer");
+    buffer = HalBuffer::CreateRetained(raw_buffer);
+    CopyPyBuffer(*py_view, buffer);
+  }
+
+  iree_vm_ref_t buffer_ref = iree_hal_buffer_move_ref(buffer.steal_raw_ptr());
   CheckApiStatus(
       iree_vm_variant_list_append_ref_move(f_args.raw_ptr(), &buffer_ref),
       "Error moving buffer");
-
-  // Only capture the reference to the exporting object (incrementing it)
-  // once guaranteed successful.
-  if (depends_on_pyobject) {
-    // Note for future implementation: there needs to be a place to stash
-    // references to be kept alive which back a buffer. This is likely an
-    // additional bag of refs returned from this function, which can then
-    // be attached to an invocation.
-    throw RaisePyError(PyExc_NotImplementedError,
-                       "Dependent buffer arguments not implemented");
-  }
 }
 
 void SetupFunctionAbiBindings(pybind11::module m) {
@@ -85,6 +85,18 @@ class FunctionAbiTest(absltest.TestCase):
     py_result, = fabi.raw_unpack_results(f_results)
     self.assertEqual(np.int32, py_result.dtype)
     self.assertEqual((32, 8, 64), py_result.shape)
+    # The result aliases the mapped buffer.
+    self.assertFalse(py_result.flags.owndata)
+    self.assertTrue(py_result.flags.writeable)
+
+  def test_static_arg_non_contiguous_copied(self):
+    fabi = pyiree.binding.function_abi.create(
+        self.device, self.htf,
+        ATTRS_1ARG_FLOAT32_10X128X64_TO_SINT32_32X8X64_V1)
+    arg = np.zeros((10, 128, 128), dtype=np.float32)[:, :, ::2]
+    self.assertFalse(arg.flags.c_contiguous)
+    packed = fabi.raw_pack_inputs([arg])
+    self.assertEqual("<VmVariantList(1): [HalBuffer(327680)]>", repr(packed))
 
   def test_dynamic_alloc_result_success(self):
     fabi = pyiree.binding.function_abi.create(
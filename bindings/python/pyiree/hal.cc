@@ -14,6 +14,9 @@
 
 #include "bindings/python/pyiree/hal.h"
 
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "absl/container/inlined_vector.h"
 #include "iree/hal/api.h"
 
@@ -115,6 +118,53 @@ HalDriver HalDriver::Create(const std::string& driver_name) {
   return HalDriver::CreateRetained(driver);
 }
 
+namespace {
+
+py::dict AllocationStatisticsToDict(
+    const iree_hal_allocation_statistics_t& statistics) {
+  py::dict dict;
+  dict["bytes_live"] = statistics.bytes_live;
+  dict["peak_bytes_live"] = statistics.peak_bytes_live;
+  dict["live_allocation_count"] = statistics.live_allocation_count;
+  dict["allocation_count"] = statistics.allocation_count;
+  return dict;
+}
+
+}  // namespace
+
+py::dict HalDevice::QueryAllocatorStatistics() {
+  iree_hal_allocator_statistics_t statistics;
+  CheckApiStatus(iree_hal_allocator_query_statistics(allocator(), &statistics),
+                 "Error querying allocator statistics");
+  iree_host_size_t memory_type_count = 0;
+  CheckApiStatus(iree_hal_allocator_query_memory_type_statistics(
+                     allocator(), 0, nullptr, &memory_type_count),
+                 "Error querying allocator statistics");
+  std::vector<iree_hal_memory_type_statistics_t> memory_type_statistics(
+      memory_type_count);
+  CheckApiStatus(iree_hal_allocator_query_memory_type_statistics(
+                     allocator(), memory_type_statistics.size(),
+                     memory_type_statistics.data(), &memory_type_count),
+                 "Error querying allocator statistics");
+
+  py::dict dict = AllocationStatisticsToDict(statistics.total);
+  dict["backing_bytes_reserved"] = statistics.backing_bytes_reserved;
+  dict["backing_bytes_used"] = statistics.backing_bytes_used;
+  dict["fragmentation"] = statistics.fragmentation;
+  py::dict memory_types;
+  for (const auto& memory_type : memory_type_statistics) {
+    memory_types[py::int_(static_cast<int>(memory_type.memory_type))] =
+        AllocationStatisticsToDict(memory_type.statistics);
+  }
+  dict["memory_types"] = memory_types;
+  return dict;
+}
+
+void HalDevice::ResetAllocatorPeakStatistics() {
+  CheckApiStatus(iree_hal_allocator_reset_peak_statistics(allocator()),
+                 "Error resetting allocator statistics");
+}
+
 HalDevice HalDriver::CreateDefaultDevice() {
   iree_hal_device_t* device;
   CheckApiStatus(iree_hal_driver_create_default_device(
@@ -123,6 +173,129 @@ HalDevice HalDriver::CreateDefaultDevice() {
   return HalDevice::CreateRetained(device);
 }
 
+//------------------------------------------------------------------------------
+// Python buffer protocol interop
+//------------------------------------------------------------------------------
+
+void PyBufferDeleter::operator()(Py_buffer* py_view) const {
+  PyBuffer_Release(py_view);
+  delete py_view;
+}
+
+PyBufferPtr AcquirePyBuffer(py::handle py_obj, int flags) {
+  PyBufferPtr py_view(new Py_buffer);
+  if (PyObject_GetBuffer(py_obj.ptr(), py_view.get(), flags) != 0) {
+    // Not acquired so must not be released.
+    delete py_view.release();
+    // The GetBuffer call is required to set an appropriate error.
+    throw py::error_already_set();
+  }
+  return py_view;
+}
+
+namespace {
+
+// Views released on threads not holding the GIL, waiting to be released by
+// the interpreter.
+struct DeferredPyBufferReleases {
+  std::mutex mu;
+  std::vector<Py_buffer*> views;
+  // True while a pending call to ReleaseDeferredPyBuffers is queued.
+  bool release_scheduled = false;
+};
+
+DeferredPyBufferReleases& deferred_py_buffer_releases() {
+  // Leaked as releases may arrive during interpreter shutdown.
+  static auto* deferred = new DeferredPyBufferReleases();
+  return *deferred;
+}
+
+// Must be called with the GIL held.
+void ReleaseDeferredPyBuffers() {
+  auto& deferred = deferred_py_buffer_releases();
+  std::vector<Py_buffer*> views;
+  {
+    std::lock_guard<std::mutex> lock(deferred.mu);
+    deferred.release_scheduled = false;
+    views.swap(deferred.views);
+  }
+  for (Py_buffer* view : views) {
+    PyBufferDeleter()(view);
+  }
+}
+
+int ReleaseDeferredPyBuffersPendingCall(void*) {
+  ReleaseDeferredPyBuffers();
+  return 0;
+}
+
+// Releases a wrapped view once its HAL buffer is destroyed. That may happen on
+// any thread, such as when a device queue retires a submission, and the thread
+// holding the GIL may be blocked waiting on that same work. The GIL is
+// therefore never acquired here: the view is deferred and a pending call is
+// queued to release it on the interpreter's main thread.
+void ReleaseWrappedPyBuffer(void* self, iree_byte_span_t data) {
+  auto* view = static_cast<Py_buffer*>(self);
+  if (!Py_IsInitialized()) {
+    // The exporting object no longer exists.
+    delete view;
+    return;
+  }
+  if (PyGILState_Check()) {
+    PyBufferDeleter()(view);
+    return;
+  }
+  // The view is added before the pending call is queued (under the same lock)
+  // so that any release that runs afterwards includes it. If the pending call
+  // queue is full the view stays deferred until the next release from another
+  // thread queues one or the next wrap releases it.
+  auto& deferred = deferred_py_buffer_releases();
+  std::lock_guard<std::mutex> lock(deferred.mu);
+  deferred.views.push_back(view);
+  if (!deferred.release_scheduled) {
+    deferred.release_scheduled =
+        Py_AddPendingCall(&ReleaseDeferredPyBuffersPendingCall, nullptr) == 0;
+  }
+}
+
+}  // namespace
+
+HalBuffer WrapPyBuffer(PyBufferPtr& py_view, const PyBufferWrapFn& wrap_fn) {
+  ReleaseDeferredPyBuffers();
+  if (!PyBuffer_IsContiguous(py_view.get(), 'C') || py_view->len == 0 ||
+      reinterpret_cast<uintptr_t>(py_view->buf) % kPyBufferWrapAlignment) {
+    return HalBuffer();
+  }
+  iree_byte_span_t data{static_cast<uint8_t*>(py_view->buf),
+                        static_cast<iree_host_size_t>(py_view->len)};
+  iree_hal_buffer_t* raw_buffer = nullptr;
+  if (wrap_fn(data, {py_view.get(), &ReleaseWrappedPyBuffer}, &raw_buffer) !=
+      IREE_STATUS_OK) {
+    // Host memory cannot be used by the device.
+    return HalBuffer();
+  }
+  // Released by ReleaseWrappedPyBuffer.
+  py_view.release();
+  return HalBuffer::CreateRetained(raw_buffer);
+}
+
+void CopyPyBuffer(const Py_buffer& py_view, HalBuffer& buffer) {
+  iree_hal_mapped_memory_t mapped_memory;
+  CheckApiStatus(iree_hal_buffer_map(buffer.raw_ptr(),
+                                     IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE,
+                                     0 /* element_offset */, py_view.len,
+                                     &mapped_memory),
+                 "Could not map memory");
+  int rc = PyBuffer_ToContiguous(mapped_memory.contents.data,
+                                 const_cast<Py_buffer*>(&py_view),
+                                 py_view.len, 'C');
+  CheckApiStatus(iree_hal_buffer_unmap(buffer.raw_ptr(), &mapped_memory),
+                 "Error unmapping memory");
+  if (rc != 0) {
+    throw py::error_already_set();
+  }
+}
+
 void SetupHalBindings(pybind11::module m) {
   // Enums.
   py::enum_<iree_hal_memory_type_t>(m, "MemoryType")
@@ -152,7 +325,10 @@ void SetupHalBindings(pybind11::module m) {
       .value("ALL", IREE_HAL_MEMORY_ACCESS_ALL)
       .export_values();
 
-  py::class_<HalDevice>(m, "HalDevice");
+  py::class_<HalDevice>(m, "HalDevice")
+      .def("query_allocator_statistics", &HalDevice::QueryAllocatorStatistics)
+      .def("reset_allocator_peak_statistics",
+           &HalDevice::ResetAllocatorPeakStatistics);
   py::class_<HalDriver>(m, "HalDriver")
       .def_static("query", &HalDriver::Query)
       .def_static("create", &HalDriver::Create, py::arg("driver_name"))
@@ -15,6 +15,10 @@
 #ifndef IREE_BINDINGS_PYTHON_PYIREE_HAL_H_
 #define IREE_BINDINGS_PYTHON_PYIREE_HAL_H_
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+
 #include "bindings/python/pyiree/binding.h"
 #include "bindings/python/pyiree/status_utils.h"
 #include "iree/hal/api.h"
@@ -63,6 +67,12 @@ class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
   iree_hal_allocator_t* allocator() {
     return iree_hal_device_allocator(raw_ptr());
   }
+
+  // Returns the statistics of the device allocator as a dict with a nested
+  // dict of statistics for each memory type under "memory_types".
+  py::dict QueryAllocatorStatistics();
+
+  void ResetAllocatorPeakStatistics();
 };
 
 class HalDriver : public ApiRefCounted<HalDriver, iree_hal_driver_t> {
@@ -128,6 +138,42 @@ class HalBuffer : public ApiRefCounted<HalBuffer, iree_hal_buffer_t> {
   }
 };
 
+//------------------------------------------------------------------------------
+// Python buffer protocol interop
+//------------------------------------------------------------------------------
+
+// Releases and frees a view acquired with AcquirePyBuffer.
+struct PyBufferDeleter {
+  void operator()(Py_buffer* py_view) const;
+};
+using PyBufferPtr = std::unique_ptr<Py_buffer, PyBufferDeleter>;
+
+// Acquires a view of |py_obj| with the PyObject_GetBuffer |flags|.
+PyBufferPtr AcquirePyBuffer(py::handle py_obj, int flags);
+
+// Alignment required of the memory of a view for it to be wrapped instead of
+// copied. Matches the alignment of HAL host allocations.
+constexpr uintptr_t kPyBufferWrapAlignment = 16;
+
+// Wraps a host allocation with a release callback, such as with
+// iree_hal_allocator_wrap_buffer_with_release.
+using PyBufferWrapFn = std::function<iree_status_t(
+    iree_byte_span_t data, iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer)>;
+
+// Wraps the memory of |py_view| in a buffer with |wrap_fn| so that it is used
+// without a copy. The buffer takes ownership of |py_view| and keeps the
+// exporting object alive until the buffer is destroyed.
+//
+// Returns a null buffer and leaves |py_view| untouched if the memory is not
+// C-contiguous and aligned to kPyBufferWrapAlignment or |wrap_fn| fails, in
+// which case callers should fall back to CopyPyBuffer.
+HalBuffer WrapPyBuffer(PyBufferPtr& py_view, const PyBufferWrapFn& wrap_fn);
+
+// Copies the contents of |py_view| in C-contiguous order into |buffer|, which
+// must have a byte length of at least |py_view|.len.
+void CopyPyBuffer(const Py_buffer& py_view, HalBuffer& buffer);
+
 void SetupHalBindings(pybind11::module m);
 
 }  // namespace python
@@ -51,6 +51,21 @@ class HalTest(absltest.TestCase):
         np.array(bv.map()).strides,
         (1 * 8 * 4 * 2 * 4, 8 * 4 * 2 * 4, 4 * 2 * 4, 2 * 4, 4))
 
+  def testAllocatorStatistics(self):
+    if "interpreter" not in pyiree.binding.hal.HalDriver.query():
+      self.skipTest("interpreter driver not available")
+    driver = pyiree.binding.hal.HalDriver.create("interpreter")
+    device = driver.create_default_device()
+    stats = device.query_allocator_statistics()
+    print("Allocator statistics =", stats)
+    self.assertGreaterEqual(stats["peak_bytes_live"], stats["bytes_live"])
+    self.assertGreaterEqual(stats["allocation_count"],
+                            stats["live_allocation_count"])
+    self.assertIn("memory_types", stats)
+    device.reset_allocator_peak_statistics()
+    stats = device.query_allocator_statistics()
+    self.assertEqual(stats["peak_bytes_live"], stats["bytes_live"])
+
 
 if __name__ == "__main__":
   absltest.main()
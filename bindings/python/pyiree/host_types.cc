@@ -98,21 +98,37 @@ class PyMappedMemory {
     }
   }
   PyMappedMemory(PyMappedMemory&& other)
-      : mapped_memory_(other.mapped_memory_), buf_(std::move(other.buf_)) {}
+      : desc_(std::move(other.desc_)),
+        mapped_memory_(other.mapped_memory_),
+        buf_(std::move(other.buf_)) {}
 
   const Description& desc() const { return desc_; }
+  bool writable() const { return writable_; }
 
-  static std::unique_ptr<PyMappedMemory> Read(Description desc,
-                                              HalBuffer buffer) {
+  // Maps |buffer| for reading and, if the buffer allows it, writing.
+  static std::unique_ptr<PyMappedMemory> Map(Description desc,
+                                             HalBuffer buffer) {
     iree_device_size_t byte_length =
         iree_hal_buffer_byte_length(buffer.raw_ptr());
     iree_hal_mapped_memory_t mapped_memory;
-    CheckApiStatus(iree_hal_buffer_map(
-                       buffer.raw_ptr(), IREE_HAL_MEMORY_ACCESS_READ,
-                       0 /* element_offset */, byte_length, &mapped_memory),
-                   "Could not map memory");
-    return absl::make_unique<PyMappedMemory>(std::move(desc), mapped_memory,
-                                             std::move(buffer));
+    bool writable = true;
+    if (iree_hal_buffer_map(buffer.raw_ptr(),
+                            static_cast<iree_hal_memory_access_t>(
+                                IREE_HAL_MEMORY_ACCESS_READ |
+                                IREE_HAL_MEMORY_ACCESS_WRITE),
+                            0 /* element_offset */, byte_length,
+                            &mapped_memory) != IREE_STATUS_OK) {
+      // Buffers such as constants may only allow reads.
+      writable = false;
+      CheckApiStatus(iree_hal_buffer_map(
+                         buffer.raw_ptr(), IREE_HAL_MEMORY_ACCESS_READ,
+                         0 /* element_offset */, byte_length, &mapped_memory),
+                     "Could not map memory");
+    }
+    auto mapped = absl::make_unique<PyMappedMemory>(
+        std::move(desc), mapped_memory, std::move(buffer));
+    mapped->writable_ = writable;
+    return mapped;
   }
 
   py::buffer_info ToBufferInfo() {
@@ -129,23 +145,31 @@ class PyMappedMemory {
   Description desc_;
   iree_hal_mapped_memory_t mapped_memory_;
   HalBuffer buf_;
+  bool writable_ = false;
 };
 
 class NumpyHostTypeFactory : public HostTypeFactory {
   py::object CreateImmediateNdarray(AbiConstants::ScalarType element_type,
                                     absl::Span<const int> dims,
                                     HalBuffer buffer) override {
-    auto mapped_memory = PyMappedMemory::Read(
+    auto mapped_memory = PyMappedMemory::Map(
         PyMappedMemory::Description::ForNdarray(element_type, dims),
         std::move(buffer));
     // Since an immediate ndarray was requested, we can just return a native
     // ndarray directly (versus a proxy that needs to lazily map on access).
+    // The ndarray aliases the mapped memory without a copy and keeps the
+    // mapping alive through its base object.
     auto buffer_info = mapped_memory->ToBufferInfo();
+    bool writable = mapped_memory->writable();
     auto py_mapped_memory = py::cast(mapped_memory.release(),
                                      py::return_value_policy::take_ownership);
-    return py::array(py::dtype(buffer_info), buffer_info.shape,
-                     buffer_info.strides, buffer_info.ptr,
-                     std::move(py_mapped_memory) /* base */);
+    py::array py_array(py::dtype(buffer_info), buffer_info.shape,
+                       buffer_info.strides, buffer_info.ptr,
+                       std::move(py_mapped_memory) /* base */);
+    if (!writable) {
+      py_array.attr("setflags")(py::arg("write") = false);
+    }
+    return std::move(py_array);
   }
 };
 
@@ -22,57 +22,47 @@ namespace iree {
 namespace python {
 
 HalBufferView RtContext::WrapPyBufferForInput(py::buffer py_buffer) {
-  auto py_buffer_info = py_buffer.request(false /* writable */);
-  if (py_buffer_info.ndim > IREE_SHAPE_MAX_RANK || py_buffer_info.ndim < 0) {
-    RaiseValueError("Unsupported buffer rank");
+  PyBufferPtr py_view =
+      AcquirePyBuffer(py_buffer, PyBUF_FORMAT | PyBUF_STRIDES);
+  if (py_view->ndim > IREE_SHAPE_MAX_RANK || py_view->ndim < 0) {
+    throw RaiseValueError("Unsupported buffer rank");
   }
-  if (py_buffer_info.size < 0) {
-    RaiseValueError("Illegal buffer size");
+  if (py_view->len < 0) {
+    throw RaiseValueError("Illegal buffer size");
   }
 
-  // For the moment, allocate a device visible buffer of equivalent size and
-  // copy into it.
-  // TODO(laurenzo): Once sequencer is in place, switch to HeapBuffer, wrap
-  // and retain the original buffer.
-  iree_host_size_t byte_size = py_buffer_info.size * py_buffer_info.itemsize;
-  HalBuffer buffer =
-      AllocateDeviceVisible(byte_size, IREE_HAL_BUFFER_USAGE_ALL);
-  CheckApiStatus(iree_hal_buffer_write_data(buffer.raw_ptr(), 0,
-                                            py_buffer_info.ptr, byte_size),
-                 "Error writing to input buffer");
-
-  // Create the buffer view.
   // TODO(laurenzo): This does no validation on dtype and only cares if the
   // elementsize matches. Figure out where to enforce actual dtype.
   iree_shape_t shape;
-  shape.rank = py_buffer_info.ndim;
-
-  // Verify strides are row-major.
-  // TODO(laurenzo): Test this with rank>1.
-  for (int i = 1; i < shape.rank; ++i) {
-    if ((py_buffer_info.strides[i - 1] * py_buffer_info.itemsize) !=
-        py_buffer_info.shape[i]) {
-      RaiseValueError("Expected row-major layout");
-    }
-  }
-  if (!py_buffer_info.strides.empty()) {
-    if (py_buffer_info.strides.back() != 1) {
-      RaiseValueError("Expected row-major layout");
-    }
-  }
-
-  // Populate shape.
+  shape.rank = py_view->ndim;
   for (int i = 0; i < shape.rank; ++i) {
-    ssize_t dim = py_buffer_info.shape[i];
+    ssize_t dim = py_view->shape[i];
     if (dim < 0) {
-      RaiseValueError("Unsupported negative dim");
+      throw RaiseValueError("Unsupported negative dim");
     }
     shape.dims[i] = dim;
   }
+  int8_t element_size = py_view->itemsize;
+
+  // Use the original buffer if the layout and alignment allow and otherwise
+  // copy into a device visible buffer. The wrapped buffer retains the
+  // exporting object for as long as it is in use.
+  HalBuffer buffer = WrapPyBuffer(
+      py_view, [&](iree_byte_span_t data,
+                   iree_hal_buffer_release_callback_t release_callback,
+                   iree_hal_buffer_t** out_buffer) {
+        return iree_rt_context_wrap_device_visible_buffer(
+            raw_ptr(), IREE_HAL_MEMORY_ACCESS_READ, IREE_HAL_BUFFER_USAGE_ALL,
+            data, release_callback, out_buffer);
+      });
+  if (!buffer) {
+    buffer = AllocateDeviceVisible(py_view->len, IREE_HAL_BUFFER_USAGE_ALL);
+    CopyPyBuffer(*py_view, buffer);
+  }
 
   iree_hal_buffer_view_t* bv;
   CheckApiStatus(iree_hal_buffer_view_create(buffer.raw_ptr(), shape,
-                                             py_buffer_info.itemsize,
+                                             element_size,
                                              IREE_ALLOCATOR_SYSTEM, &bv),
                  "Error allocating buffer view");
 
@@ -16,6 +16,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import gc
+
 from absl.testing import absltest
 import numpy as np
 import pyiree
@@ -123,6 +125,26 @@ class RuntimeTest(absltest.TestCase):
     self.assertEqual(18., result_ary[2])
     self.assertEqual(28., result_ary[3])
 
+  def testInvokeWrappedAndCopiedInputs(self):
+    policy = pyiree.binding.rt.Policy()
+    instance = pyiree.binding.rt.Instance()
+    context = pyiree.binding.rt.Context(instance=instance, policy=policy)
+    m = create_simple_mul_module()
+    context.register_module(m)
+    f = context.resolve_function("module.simple_mul")
+    # Not C-contiguous so copied.
+    strided = np.array([1., 0., 2., 0., 3., 0., 4., 0.], dtype=np.float32)[::2]
+    arg0 = context.wrap_for_input(strided)
+    # Wrapped if aligned, in which case the buffer keeps the array alive.
+    arg1 = context.wrap_for_input(np.array([4., 5., 6., 7.], dtype=np.float32))
+    del strided
+    gc.collect()
+
+    inv = context.invoke(f, policy, [arg0, arg1])
+    inv.await_ready()
+    result_ary = np.array(inv.results[0].map(), copy=False)
+    np.testing.assert_array_equal([4., 10., 18., 28.], result_ary)
+
 
 if __name__ == "__main__":
   absltest.main()
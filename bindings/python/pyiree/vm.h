@@ -119,6 +119,9 @@ class VmModule : public ApiRefCounted<VmModule, iree_vm_module_t> {
  public:
   static VmModule FromFlatbufferBlob(
       std::shared_ptr<OpaqueBlob> flatbuffer_blob);
+  // Memory maps the module file at |path| so that it is loaded on demand and
+  // its constants are used in place.
+  static VmModule FromFile(const std::string& path);
 
   absl::optional<iree_vm_function_t> LookupFunction(
       const std::string& name, iree_vm_function_linkage_t linkage);
@@ -15,12 +15,15 @@
 
 # pylint: disable=unused-variable
 
+import os
+import tempfile
+
 from absl.testing import absltest
 import numpy as np
 import pyiree
 
 
-def create_simple_mul_module():
+def compile_simple_mul_module():
   ctx = pyiree.CompilerContext()
   input_module = ctx.parse_asm("""
     func @simple_mul(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32>
@@ -29,7 +32,22 @@ def create_simple_mul_module():
         return %0 : tensor<4xf32>
     }
     """)
-  binary = input_module.compile()
+  return input_module.compile()
+
+
+def compile_constant_module():
+  ctx = pyiree.CompilerContext()
+  input_module = ctx.parse_asm("""
+    func @constant() -> tensor<4xf32> attributes { iree.module.export } {
+        %0 = constant dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32>
+        return %0 : tensor<4xf32>
+    }
+    """)
+  return input_module.compile()
+
+
+def create_simple_mul_module():
+  binary = compile_simple_mul_module()
   m = pyiree.binding.vm.VmModule.from_flatbuffer(binary)
   return m
 
@@ -64,6 +82,18 @@ class VmTest(absltest.TestCase):
     notfound = m.lookup_function("notfound")
     self.assertIs(notfound, None)
 
+  def test_module_from_file(self):
+    binary = compile_simple_mul_module()
+    with tempfile.TemporaryDirectory() as temp_dir:
+      path = os.path.join(temp_dir, "simple_mul.vmfb")
+      with open(path, "wb") as f:
+        f.write(binary.bytes)
+      m = pyiree.binding.vm.VmModule.from_file(path)
+      f = m.lookup_function("simple_mul")
+      self.assertGreater(f.ordinal, 0)
+      # The module maps the file; drop it before the directory is removed.
+      del m
+
   def test_dynamic_module_context(self):
     instance = pyiree.binding.vm.VmInstance()
     context = pyiree.binding.vm.VmContext(instance)
@@ -100,6 +130,31 @@ class VmTest(absltest.TestCase):
     print("RESULTS:", results)
     np.testing.assert_allclose(results[0], [4., 10., 18., 28.])
 
+  def test_constant_outlives_module(self):
+    # Devices that can access host memory wrap aligned constants in place
+    # instead of copying them, so results must keep the mapped module alive.
+    driver = pyiree.binding.hal.HalDriver.create("interpreter")
+    device = driver.create_default_device()
+    hal_module = pyiree.binding.vm.create_hal_module(device)
+    binary = compile_constant_module()
+    with tempfile.TemporaryDirectory() as temp_dir:
+      path = os.path.join(temp_dir, "constant.vmfb")
+      with open(path, "wb") as f:
+        f.write(binary.bytes)
+      m = pyiree.binding.vm.VmModule.from_file(path)
+      instance = pyiree.binding.vm.VmInstance()
+      context = pyiree.binding.vm.VmContext(
+          instance, modules=[hal_module, m])
+      f = m.lookup_function("constant")
+      abi = context.create_function_abi(device, self.htf, f)
+      inputs = abi.raw_pack_inputs(())
+      allocated_results = abi.allocate_results(inputs, static_alloc=False)
+      context.invoke(f, inputs, allocated_results)
+      results = abi.raw_unpack_results(allocated_results)
+      # Destroy the module and everything referencing it before reading.
+      del f, abi, inputs, allocated_results, context, instance, m
+      np.testing.assert_allclose(results[0], [1., 2., 3., 4.])
+
 
 if __name__ == "__main__":
   absltest.main()
@@ -55,6 +55,12 @@ if(${IREE_ENABLE_TRACING})
   )
 endif()
 
+if(${IREE_ENABLE_NATIVE_TRACING})
+  list(APPEND IREE_DEFAULT_COPTS
+    "-DIREE_NATIVE_TRACING_ENABLE=1"
+  )
+endif()
+
 #-------------------------------------------------------------------------------
 # Compiler: Clang/LLVM
 #-------------------------------------------------------------------------------
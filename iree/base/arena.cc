@@ -14,6 +14,9 @@
 
 #include "iree/base/arena.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
 #include <memory>
 
 #include "absl/base/attributes.h"
@@ -30,28 +33,142 @@ ABSL_ATTRIBUTE_ALWAYS_INLINE constexpr T RoundToAlignment(
   return ((value + alignment - 1) / alignment) * alignment;
 }
 
+// Returns the largest size class whose minimum size is at most |length|.
+// Chunks in this class can satisfy any request of the class minimum size.
+int FloorSizeClass(size_t length) {
+  int size_class = 0;
+  while (size_class + 1 < Arena::kSizeClassCount &&
+         (Arena::kMinFreeChunkSize << (size_class + 1)) <= length) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// Returns the smallest size class whose minimum size is at least |length| or
+// kSizeClassCount if no class is large enough.
+int CeilSizeClass(size_t length) {
+  int size_class = 0;
+  while (size_class < Arena::kSizeClassCount &&
+         (Arena::kMinFreeChunkSize << size_class) < length) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// Per-thread arena used by ThreadLocalArena.
+struct ThreadArenaState {
+  Arena arena;
+  int scope_depth = 0;
+};
+
+thread_local ThreadArenaState thread_arena_state;
+
 }  // namespace
 
-Arena::Arena(size_t block_size) : block_size_(block_size) {}
+// static
+ArenaBlockPool* ArenaBlockPool::Default() {
+  // Intentionally leaked so that thread arenas can release blocks during
+  // shutdown.
+  static ArenaBlockPool* pool =
+      new ArenaBlockPool(Arena::kBlockOverhead + Arena::kDefaultBlockSize);
+  return pool;
+}
+
+ArenaBlockPool::ArenaBlockPool(size_t block_size) : block_size_(block_size) {
+  for (auto& slot : slots_) {
+    slot.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+ArenaBlockPool::~ArenaBlockPool() { Trim(); }
+
+void* ArenaBlockPool::AcquireBlock() {
+  for (auto& slot : slots_) {
+    if (!slot.load(std::memory_order_relaxed)) continue;
+    void* block = slot.exchange(nullptr, std::memory_order_acquire);
+    if (block) return block;
+  }
+  return std::malloc(block_size_);
+}
+
+void ArenaBlockPool::ReleaseBlock(void* block) {
+  for (auto& slot : slots_) {
+    void* expected = nullptr;
+    if (slot.load(std::memory_order_relaxed)) continue;
+    if (slot.compare_exchange_strong(expected, block,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  std::free(block);
+}
+
+void ArenaBlockPool::Trim() {
+  for (auto& slot : slots_) {
+    std::free(slot.exchange(nullptr, std::memory_order_acquire));
+  }
+}
+
+size_t ArenaBlockPool::cached_block_count() const {
+  size_t count = 0;
+  for (const auto& slot : slots_) {
+    if (slot.load(std::memory_order_relaxed)) ++count;
+  }
+  return count;
+}
+
+Arena::Arena(size_t block_size)
+    : block_pool_(block_size == kDefaultBlockSize ? ArenaBlockPool::Default()
+                                                  : nullptr),
+      block_size_(block_size) {}
+
+Arena::Arena(ArenaBlockPool* block_pool)
+    : block_pool_(block_pool),
+      block_size_(block_pool->block_size() - kBlockOverhead) {
+  CHECK_GT(block_pool->block_size(), kBlockOverhead);
+}
 
 Arena::~Arena() { Clear(); }
 
+void Arena::ReleaseBlock(BlockHeader* block_header) {
+  if (block_pool_) {
+    block_pool_->ReleaseBlock(block_header);
+  } else {
+    std::free(block_header);
+  }
+}
+
+void Arena::FreeOversizeBlocks() {
+  auto block_header = oversize_block_list_head_;
+  while (block_header) {
+    auto next_block = block_header->next_block;
+    block_bytes_allocated_ -=
+        sizeof(BlockHeader) + block_header->bytes_allocated;
+    std::free(block_header);
+    block_header = next_block;
+  }
+  oversize_block_list_head_ = nullptr;
+}
+
 void Arena::Clear() {
   // Deallocate all memory.
   auto block_header = block_list_head_;
   while (block_header) {
     auto next_block = block_header->next_block;
-    std::free(block_header);
+    ReleaseBlock(block_header);
     block_header = next_block;
   }
   block_list_head_ = nullptr;
   block_header = unused_block_list_head_;
   while (block_header) {
     auto next_block = block_header->next_block;
-    std::free(block_header);
+    ReleaseBlock(block_header);
     block_header = next_block;
   }
   unused_block_list_head_ = nullptr;
+  FreeOversizeBlocks();
+  std::fill(std::begin(free_lists_), std::end(free_lists_), nullptr);
 
   bytes_allocated_ = 0;
   block_bytes_allocated_ = 0;
@@ -68,58 +185,161 @@ void Arena::Reset() {
     block_header = next_block;
   }
   block_list_head_ = nullptr;
+  FreeOversizeBlocks();
+  std::fill(std::begin(free_lists_), std::end(free_lists_), nullptr);
 
   bytes_allocated_ = 0;
 }
 
-uint8_t* Arena::AllocateBytes(size_t length) {
+void Arena::AddFreeChunk(uint8_t* ptr, size_t length) {
+  if (length < kMinFreeChunkSize) return;
+  int size_class = FloorSizeClass(length);
+  auto* chunk = reinterpret_cast<FreeChunk*>(ptr);
+  chunk->next_chunk = free_lists_[size_class];
+  chunk->length = length;
+  free_lists_[size_class] = chunk;
+}
+
+uint8_t* Arena::TakeFreeChunk(size_t length) {
+  for (int size_class = CeilSizeClass(length); size_class < kSizeClassCount;
+       ++size_class) {
+    auto* chunk = free_lists_[size_class];
+    if (!chunk) continue;
+    free_lists_[size_class] = chunk->next_chunk;
+    auto* chunk_ptr = reinterpret_cast<uint8_t*>(chunk);
+    AddFreeChunk(chunk_ptr + length, chunk->length - length);
+    return chunk_ptr;
+  }
+  return nullptr;
+}
+
+void Arena::StartBlock() {
+  if (block_list_head_) {
+    // Keep the unused tail of the current block around for small allocations.
+    auto* block_data = reinterpret_cast<uint8_t*>(block_list_head_ + 1);
+    AddFreeChunk(block_data + block_list_head_->bytes_allocated,
+                 block_size_ - block_list_head_->bytes_allocated);
+    block_list_head_->bytes_allocated = block_size_;
+  }
+
+  BlockHeader* block_header = nullptr;
+  if (unused_block_list_head_) {
+    // Move block from unused list to main list.
+    block_header = unused_block_list_head_;
+    unused_block_list_head_ = block_header->next_block;
+  } else {
+    // Allocate a new block.
+    block_header = reinterpret_cast<BlockHeader*>(
+        block_pool_ ? block_pool_->AcquireBlock()
+                    : std::malloc(sizeof(BlockHeader) + block_size_));
+    block_bytes_allocated_ += sizeof(BlockHeader) + block_size_;
+  }
+  block_header->next_block = block_list_head_;
+  block_header->bytes_allocated = 0;
+  block_list_head_ = block_header;
+}
+
+uint8_t* Arena::AllocateOversize(size_t length, size_t aligned_length,
+                                 size_t alignment) {
+  // Over-allocate so that the data can be aligned within the block.
+  size_t usable_length = aligned_length + alignment - kMinAlignment;
+  auto block_header = reinterpret_cast<BlockHeader*>(
+      std::malloc(sizeof(BlockHeader) + usable_length));
+  block_header->next_block = oversize_block_list_head_;
+  block_header->bytes_allocated = usable_length;
+  oversize_block_list_head_ = block_header;
+  block_bytes_allocated_ += sizeof(BlockHeader) + usable_length;
+  bytes_allocated_ += length;
+  return reinterpret_cast<uint8_t*>(RoundToAlignment(
+      reinterpret_cast<uintptr_t>(block_header + 1), alignment));
+}
+
+uint8_t* Arena::AllocateBytes(size_t length, size_t alignment) {
   if (!length) {
     // Guarantee zero-length allocations return nullptr.
     return nullptr;
   }
+  DCHECK_EQ(0u, alignment & (alignment - 1))
+      << "Alignment must be a power of 2";
+  if (alignment < kMinAlignment) alignment = kMinAlignment;
 
   // Pad length allocated so we are machine word aligned.
   // This ensures the next allocation starts at the right boundary.
-  size_t aligned_length = RoundToAlignment(length, sizeof(uintptr_t));
+  size_t aligned_length = RoundToAlignment(length, kMinAlignment);
 
-  if (aligned_length > block_size_) {
-    // This allocation is larger than an entire block. That's bad.
-    // We could allocate this with malloc (and then keep track of those to free
-    // things), but for now let's just die.
-    CHECK(false);
-    return nullptr;
+  // Reuse a deallocated chunk if one is large enough. Chunks are only
+  // guaranteed to have the minimum alignment.
+  if (alignment == kMinAlignment) {
+    if (uint8_t* chunk_ptr = TakeFreeChunk(aligned_length)) {
+      bytes_allocated_ += length;
+      return chunk_ptr;
+    }
   }
 
-  if (!block_list_head_ ||
-      block_list_head_->bytes_allocated + aligned_length > block_size_) {
-    // Check to see if we have an existing unused block we can use.
-    if (unused_block_list_head_) {
-      // Move block from unused list to main list.
-      auto block_header = unused_block_list_head_;
-      unused_block_list_head_ = block_header->next_block;
-      block_header->next_block = block_list_head_;
-      block_header->bytes_allocated = 0;
-      block_list_head_ = block_header;
-    } else {
-      // Allocate a new block.
-      auto block_ptr = reinterpret_cast<uint8_t*>(
-          std::malloc(sizeof(BlockHeader) + block_size_));
-      auto block_header = reinterpret_cast<BlockHeader*>(block_ptr);
-      block_header->next_block = block_list_head_;
-      block_header->bytes_allocated = 0;
-      block_list_head_ = block_header;
-      block_bytes_allocated_ += sizeof(BlockHeader) + block_size_;
-    }
+  // Blocks are at least minimally aligned so this bounds the padding needed.
+  if (aligned_length + alignment - kMinAlignment > block_size_) {
+    // This allocation is larger than an entire block so give it its own.
+    return AllocateOversize(length, aligned_length, alignment);
+  }
+
+  if (!block_list_head_) StartBlock();
+  auto block_data = reinterpret_cast<uintptr_t>(block_list_head_ + 1);
+  size_t offset =
+      RoundToAlignment(block_data + block_list_head_->bytes_allocated,
+                       static_cast<uintptr_t>(alignment)) -
+      block_data;
+  if (offset + aligned_length > block_size_) {
+    StartBlock();
+    block_data = reinterpret_cast<uintptr_t>(block_list_head_ + 1);
+    offset = RoundToAlignment(block_data, static_cast<uintptr_t>(alignment)) -
+             block_data;
   }
 
   BlockHeader* target_block = block_list_head_;
-  auto data_ptr = reinterpret_cast<uint8_t*>(target_block) +
-                  sizeof(BlockHeader) + target_block->bytes_allocated;
-  target_block->bytes_allocated += aligned_length;
+  auto data_ptr = reinterpret_cast<uint8_t*>(block_data);
+  AddFreeChunk(data_ptr + target_block->bytes_allocated,
+               offset - target_block->bytes_allocated);
+  target_block->bytes_allocated = offset + aligned_length;
 
   bytes_allocated_ += length;
 
-  return data_ptr;
+  return data_ptr + offset;
+}
+
+void Arena::Deallocate(void* ptr, size_t length) {
+  if (!ptr || !length) return;
+  bytes_allocated_ -= length;
+
+  // Oversized allocations own their block and can be freed immediately.
+  auto data_ptr = static_cast<uint8_t*>(ptr);
+  for (BlockHeader** link = &oversize_block_list_head_; *link;
+       link = &(*link)->next_block) {
+    auto block_header = *link;
+    auto block_data = reinterpret_cast<uint8_t*>(block_header + 1);
+    if (data_ptr >= block_data &&
+        data_ptr < block_data + block_header->bytes_allocated) {
+      *link = block_header->next_block;
+      block_bytes_allocated_ -=
+          sizeof(BlockHeader) + block_header->bytes_allocated;
+      std::free(block_header);
+      return;
+    }
+  }
+
+  AddFreeChunk(data_ptr, RoundToAlignment(length, kMinAlignment));
+}
+
+ThreadLocalArena::ThreadLocalArena() : arena_(&thread_arena_state.arena) {
+  ++thread_arena_state.scope_depth;
+}
+
+ThreadLocalArena::~ThreadLocalArena() {
+  if (--thread_arena_state.scope_depth > 0) return;
+  if (arena_->block_bytes_allocated() > kMaxRetainedBytes) {
+    arena_->Clear();
+  } else {
+    arena_->Reset();
+  }
 }
 
 }  // namespace iree
@@ -15,6 +15,8 @@
 #ifndef IREE_BASE_ARENA_H_
 #define IREE_BASE_ARENA_H_
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
 
@@ -24,12 +26,59 @@ namespace iree {
 
 // TODO(b/140026716): add InlineArena/FixedArena to avoid malloc.
 
+// A process-wide cache of equally-sized arena blocks.
+// Arenas return their blocks to the pool when cleared so that short-lived
+// arenas (such as those used per submission) don't hit malloc for every use.
+// At most kMaxCachedBlocks are retained and any beyond that are freed.
+//
+// ArenaBlockPool is thread-safe and lock-free.
+class ArenaBlockPool final {
+ public:
+  static constexpr size_t kMaxCachedBlocks = 64;
+
+  // Returns the pool used by arenas with the default block size.
+  static ArenaBlockPool* Default();
+
+  // |block_size| is the total size of each block, including any header.
+  explicit ArenaBlockPool(size_t block_size);
+  ~ArenaBlockPool();
+
+  ArenaBlockPool(const ArenaBlockPool&) = delete;
+  ArenaBlockPool& operator=(const ArenaBlockPool&) = delete;
+
+  // Total size of each block in bytes.
+  size_t block_size() const { return block_size_; }
+
+  // Returns a cached block or allocates a new one.
+  void* AcquireBlock();
+
+  // Returns |block| to the pool or frees it if the pool is full.
+  void ReleaseBlock(void* block);
+
+  // Frees all cached blocks.
+  void Trim();
+
+  // Number of blocks currently cached. Racy; for diagnostics only.
+  size_t cached_block_count() const;
+
+ private:
+  const size_t block_size_;
+  // Occupied slots hold a cached block and empty slots hold nullptr. Blocks
+  // are moved in and out with single atomic operations so there is no ABA.
+  std::atomic<void*> slots_[kMaxCachedBlocks];
+};
+
 // Arena allocator.
 // Allocates memory from a cached block list grown at specified intervals.
-// Individual allocations cannot be freed.
 // Default constructors will be called when allocating but no destructors will
 // ever be called.
 //
+// Allocations larger than the block size get a dedicated block that is freed
+// on Reset/Clear. Individual allocations may be returned with Deallocate, which
+// places them in per-size-class free lists for reuse (and splitting) by later
+// allocations. Unused space at the end of a block is reused the same way when
+// a new block is started. All memory is reclaimed together with Reset/Clear.
+//
 // This should be used in places where extreme dynamic memory growth is required
 // to ensure that the allocations stay close to each other in memory, are easy
 // to account for, and can be released together. For example, proto or file
@@ -38,28 +87,50 @@ namespace iree {
 // Usage:
 //   Arena arena;
 //   auto t0 = arena.Allocate<MyType>();
+//
+// Arena is thread-compatible.
 class Arena {
  public:
   static constexpr size_t kDefaultBlockSize = 32 * 1024;
   static constexpr size_t kBlockOverhead = sizeof(void*) + sizeof(size_t);
 
+  // Minimum alignment of all allocations.
+  static constexpr size_t kMinAlignment = sizeof(uintptr_t);
+
+  // Smallest deallocated chunk that is retained for reuse.
+  static constexpr size_t kMinFreeChunkSize = 2 * sizeof(void*);
+
+  // Number of free list size classes. Class i holds free chunks of at least
+  // kMinFreeChunkSize << i bytes.
+  static constexpr int kSizeClassCount = 10;
+
+  // Uses blocks from ArenaBlockPool::Default().
   Arena() : Arena(kDefaultBlockSize) {}
+  // Uses blocks from ArenaBlockPool::Default() if |block_size| is
+  // kDefaultBlockSize and otherwise allocates blocks directly.
   explicit Arena(size_t block_size);
+  // Uses blocks from |block_pool|, which must outlive the arena.
+  explicit Arena(ArenaBlockPool* block_pool);
   ~Arena();
 
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
   // Clears all data in the arena and deallocates blocks.
   // Use Reset to avoid reallocation.
   void Clear();
 
   // Resets data in the arena but does not deallocate blocks.
+  // Oversized allocations are always deallocated.
   // Use Clear to reclaim memory.
   void Reset();
 
   // Block size, excluding the block header.
-  // This is the largest size of any allocation that can be made of the arena.
+  // Allocations larger than this are given their own block.
   size_t block_size() const { return block_size_; }
 
-  // Total number of bytes that have been allocated, excluding wasted space.
+  // Total number of bytes that have been allocated and not deallocated,
+  // excluding wasted space.
   size_t bytes_allocated() const { return bytes_allocated_; }
   // Total number of bytes as blocks allocated, including wasted space.
   // If this number is much higher than bytes_allocated the block size requires
@@ -69,7 +140,7 @@ class Arena {
   // Allocates an instance of the given type and calls its constructor.
   template <typename T>
   T* Allocate() {
-    void* storage = AllocateBytes(sizeof(T));
+    void* storage = AllocateBytes(sizeof(T), alignof(T));
     return new (storage) T();
   }
 
@@ -77,28 +148,27 @@ class Arena {
   // arguments.
   template <typename T, typename... Args>
   T* Allocate(Args&&... args) {
-    void* storage = AllocateBytes(sizeof(T));
+    void* storage = AllocateBytes(sizeof(T), alignof(T));
     return new (storage) T(std::forward<Args>(args)...);
   }
 
   // Allocates an array of items and returns a span pointing to them.
   template <typename T>
   absl::Span<T> AllocateSpan(size_t count) {
-    void* storage = AllocateBytes(count * sizeof(T));
+    void* storage = AllocateBytes(count * sizeof(T), alignof(T));
     return absl::MakeSpan(reinterpret_cast<T*>(storage), count);
   }
 
-  // Allocates a block of raw bytes from the arena.
+  // Allocates a block of raw bytes from the arena aligned to at least
+  // |alignment|, which must be a power of two.
   // Zero-byte allocations will return nullptr.
-  uint8_t* AllocateBytes(size_t length);
+  uint8_t* AllocateBytes(size_t length, size_t alignment = kMinAlignment);
 
- private:
-  // Block size contains the BlockHeader, so a 1024b block size will result in
-  // 1024-sizeof(BlockHeader) usable bytes.
-  size_t block_size_ = kDefaultBlockSize;
-  size_t bytes_allocated_ = 0;
-  size_t block_bytes_allocated_ = 0;
+  // Returns |length| bytes at |ptr| previously returned by AllocateBytes for
+  // reuse by later allocations. No destructors are called.
+  void Deallocate(void* ptr, size_t length);
 
+ private:
   // Each block in the arena contains a prefixed header that lets us link the
   // blocks together (to make freeing easier) as well as tracking current byte
   // count to let us fill gaps.
@@ -110,12 +180,127 @@ class Arena {
   };
   static_assert(sizeof(BlockHeader) == kBlockOverhead, "Block header mismatch");
 
+  // Intrusive free list entry stored in deallocated chunks.
+  struct FreeChunk {
+    FreeChunk* next_chunk;
+    size_t length;
+  };
+  static_assert(sizeof(FreeChunk) <= kMinFreeChunkSize,
+                "Free list entries must fit in the smallest free chunk");
+
+  // Allocates a dedicated block for an allocation that doesn't fit a block.
+  uint8_t* AllocateOversize(size_t length, size_t aligned_length,
+                            size_t alignment);
+
+  // Makes a new block current, reusing unused blocks when possible.
+  void StartBlock();
+
+  // Adds the chunk at |ptr| of |length| bytes to the free lists.
+  void AddFreeChunk(uint8_t* ptr, size_t length);
+
+  // Returns a free chunk of at least |length| bytes or nullptr. Any excess is
+  // returned to the free lists.
+  uint8_t* TakeFreeChunk(size_t length);
+
+  // Frees all oversized blocks.
+  void FreeOversizeBlocks();
+
+  // Returns a block to the pool or frees it.
+  void ReleaseBlock(BlockHeader* block_header);
+
+  // Pool providing blocks or nullptr to allocate them directly.
+  ArenaBlockPool* block_pool_ = nullptr;
+
+  // Block size contains the BlockHeader, so a 1024b block size will result in
+  // 1024-sizeof(BlockHeader) usable bytes.
+  size_t block_size_ = kDefaultBlockSize;
+  size_t bytes_allocated_ = 0;
+  size_t block_bytes_allocated_ = 0;
+
   // Singly-linked list of allocated blocks in reverse allocation order (so
   // the most recently allocated block is first).
   BlockHeader* block_list_head_ = nullptr;
 
   // Allocated but unused blocks.
   BlockHeader* unused_block_list_head_ = nullptr;
+
+  // Dedicated blocks for oversized allocations. bytes_allocated holds the
+  // usable size of the block.
+  BlockHeader* oversize_block_list_head_ = nullptr;
+
+  // Free lists of deallocated chunks by size class.
+  FreeChunk* free_lists_[kSizeClassCount] = {};
+};
+
+// Provides scoped access to an arena owned by the calling thread.
+// Useful for short-lived scratch memory such as per-dispatch temporaries
+// without the cost of creating an arena each time. Scopes may nest and the
+// arena is reset when the outermost scope on the thread ends, so memory
+// allocated within a scope must not be used after it ends.
+//
+// Usage:
+//   ThreadLocalArena arena;
+//   auto values = arena->AllocateSpan<int>(count);
+class ThreadLocalArena final {
+ public:
+  // Bytes of blocks a thread arena retains between outermost scopes. Arenas
+  // that grew beyond this return their blocks to the pool.
+  static constexpr size_t kMaxRetainedBytes =
+      4 * (Arena::kDefaultBlockSize + Arena::kBlockOverhead);
+
+  ThreadLocalArena();
+  ~ThreadLocalArena();
+
+  ThreadLocalArena(const ThreadLocalArena&) = delete;
+  ThreadLocalArena& operator=(const ThreadLocalArena&) = delete;
+
+  Arena* get() const { return arena_; }
+  Arena* operator->() const { return arena_; }
+  Arena& operator*() const { return *arena_; }
+
+ private:
+  Arena* arena_;
+};
+
+// STL-compatible allocator that allocates from an Arena.
+// Deallocated storage is returned to the arena free lists so that growing
+// containers reuse their previous storage.
+//
+// Usage:
+//   Arena arena;
+//   absl::InlinedVector<int, 4, ArenaAllocator<int>> values(
+//       ArenaAllocator<int>(&arena));
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  Arena* arena() const { return arena_; }
+
+  T* allocate(size_t count) {
+    return reinterpret_cast<T*>(
+        arena_->AllocateBytes(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t count) {
+    arena_->Deallocate(ptr, count * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  Arena* arena_;
 };
 
 }  // namespace iree
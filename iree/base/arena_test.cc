@@ -14,6 +14,10 @@
 
 #include "iree/base/arena.h"
 
+#include <cstring>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
 #include "iree/testing/gtest.h"
 
 namespace iree {
@@ -143,5 +147,157 @@ TEST(ArenaTest, FastReset) {
   EXPECT_EQ(32 + 2 * Arena::kBlockOverhead, arena.block_bytes_allocated());
 }
 
+// Tests allocations larger than the block size.
+TEST(ArenaTest, OversizeAllocation) {
+  Arena arena(16);
+  uint8_t* small_ptr = arena.AllocateBytes(8);
+  EXPECT_NE(nullptr, small_ptr);
+  uint8_t* large_ptr = arena.AllocateBytes(100);
+  EXPECT_NE(nullptr, large_ptr);
+  std::memset(large_ptr, 0xCD, 100);
+  EXPECT_EQ(108, arena.bytes_allocated());
+  EXPECT_EQ(16 + 104 + 2 * Arena::kBlockOverhead,
+            arena.block_bytes_allocated());
+
+  // Oversized allocations don't affect the current block.
+  EXPECT_EQ(small_ptr + 8, arena.AllocateBytes(8));
+
+  // Deallocating an oversized allocation frees its block.
+  arena.Deallocate(large_ptr, 100);
+  EXPECT_EQ(16, arena.bytes_allocated());
+  EXPECT_EQ(16 + Arena::kBlockOverhead, arena.block_bytes_allocated());
+
+  // Reset frees oversized blocks but retains regular ones.
+  EXPECT_NE(nullptr, arena.AllocateBytes(100));
+  arena.Reset();
+  EXPECT_EQ(0, arena.bytes_allocated());
+  EXPECT_EQ(16 + Arena::kBlockOverhead, arena.block_bytes_allocated());
+}
+
+// Tests that deallocated chunks are reused by size class.
+TEST(ArenaTest, DeallocateReusesChunks) {
+  Arena arena(256);
+  uint8_t* ptr_a = arena.AllocateBytes(64);
+  uint8_t* ptr_b = arena.AllocateBytes(24);
+  EXPECT_EQ(88, arena.bytes_allocated());
+
+  arena.Deallocate(ptr_a, 64);
+  EXPECT_EQ(24, arena.bytes_allocated());
+  // Smaller allocations may reuse the larger chunk.
+  EXPECT_EQ(ptr_a, arena.AllocateBytes(40));
+  EXPECT_EQ(64, arena.bytes_allocated());
+
+  arena.Deallocate(ptr_b, 24);
+  // A 24 byte chunk can only serve allocations of up to 16 bytes.
+  EXPECT_NE(ptr_b, arena.AllocateBytes(24));
+  EXPECT_EQ(ptr_b, arena.AllocateBytes(16));
+  EXPECT_EQ(256 + Arena::kBlockOverhead, arena.block_bytes_allocated());
+}
+
+// Tests that the unused tail of a block is reused after moving on.
+TEST(ArenaTest, ReusesBlockTail) {
+  Arena arena(64);
+  uint8_t* first_ptr = arena.AllocateBytes(32);
+  EXPECT_NE(nullptr, arena.AllocateBytes(48));
+  EXPECT_EQ(2 * (64 + Arena::kBlockOverhead), arena.block_bytes_allocated());
+  EXPECT_EQ(first_ptr + 32, arena.AllocateBytes(16));
+}
+
+// Tests over-aligned allocations.
+TEST(ArenaTest, AlignedAllocation) {
+  Arena arena(256);
+  EXPECT_NE(nullptr, arena.AllocateBytes(8));
+  auto ptr = reinterpret_cast<uintptr_t>(arena.AllocateBytes(8, 64));
+  EXPECT_EQ(0, ptr % 64);
+  ptr = reinterpret_cast<uintptr_t>(arena.AllocateBytes(512, 128));
+  EXPECT_EQ(0, ptr % 128);
+
+  struct alignas(32) AlignedType {
+    int value = 3;
+  };
+  auto* aligned_ptr = arena.Allocate<AlignedType>();
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned_ptr) % 32);
+  EXPECT_EQ(3, aligned_ptr->value);
+}
+
+// Tests that blocks are recycled through the pool.
+TEST(ArenaTest, BlockPool) {
+  ArenaBlockPool block_pool(64 + Arena::kBlockOverhead);
+  EXPECT_EQ(0, block_pool.cached_block_count());
+  {
+    Arena arena(&block_pool);
+    EXPECT_EQ(64, arena.block_size());
+    EXPECT_NE(nullptr, arena.AllocateBytes(64));
+    EXPECT_NE(nullptr, arena.AllocateBytes(64));
+    arena.Reset();
+    EXPECT_EQ(0, block_pool.cached_block_count());
+    arena.Clear();
+    EXPECT_EQ(2, block_pool.cached_block_count());
+    EXPECT_NE(nullptr, arena.AllocateBytes(64));
+    EXPECT_EQ(1, block_pool.cached_block_count());
+  }
+  EXPECT_EQ(2, block_pool.cached_block_count());
+  block_pool.Trim();
+  EXPECT_EQ(0, block_pool.cached_block_count());
+}
+
+// Tests that the pool frees blocks beyond its capacity.
+TEST(ArenaTest, BlockPoolCapacity) {
+  ArenaBlockPool block_pool(16 + Arena::kBlockOverhead);
+  std::vector<void*> blocks;
+  for (int i = 0; i < ArenaBlockPool::kMaxCachedBlocks + 4; ++i) {
+    blocks.push_back(block_pool.AcquireBlock());
+  }
+  for (void* block : blocks) {
+    block_pool.ReleaseBlock(block);
+  }
+  EXPECT_EQ(ArenaBlockPool::kMaxCachedBlocks,
+            block_pool.cached_block_count());
+}
+
+// Tests that thread arenas reset when the outermost scope ends.
+TEST(ThreadLocalArenaTest, ResetsOnScopeExit) {
+  {
+    ThreadLocalArena arena;
+    EXPECT_EQ(0, arena->bytes_allocated());
+    EXPECT_NE(nullptr, arena->AllocateBytes(32));
+    {
+      ThreadLocalArena nested_arena;
+      EXPECT_EQ(arena.get(), nested_arena.get());
+      EXPECT_NE(nullptr, nested_arena->AllocateBytes(32));
+    }
+    // Nested scopes don't reset the arena.
+    EXPECT_EQ(64, arena->bytes_allocated());
+  }
+  ThreadLocalArena arena;
+  EXPECT_EQ(0, arena->bytes_allocated());
+  EXPECT_GE(ThreadLocalArena::kMaxRetainedBytes,
+            arena->block_bytes_allocated());
+}
+
+// Tests that containers can allocate from arenas.
+TEST(ArenaAllocatorTest, Containers) {
+  Arena arena(1024);
+  {
+    std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(&arena)};
+    for (int i = 0; i < 100; ++i) {
+      values.push_back(i);
+    }
+    EXPECT_EQ(99, values.back());
+    EXPECT_LT(100 * sizeof(int), arena.bytes_allocated());
+  }
+  // Growth released previous storage and destruction released the rest.
+  EXPECT_EQ(0, arena.bytes_allocated());
+
+  absl::InlinedVector<int, 2, ArenaAllocator<int>> values{
+      ArenaAllocator<int>(&arena)};
+  values.push_back(1);
+  values.push_back(2);
+  EXPECT_EQ(0, arena.bytes_allocated());
+  values.push_back(3);
+  EXPECT_LT(0, arena.bytes_allocated());
+  EXPECT_EQ(ArenaAllocator<char>(&arena), values.get_allocator());
+}
+
 }  // namespace
 }  // namespace iree
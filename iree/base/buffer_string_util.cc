@@ -14,18 +14,24 @@
 
 #include "iree/base/buffer_string_util.h"
 
-#include <functional>
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <system_error>  // NOLINT
+#include <thread>        // NOLINT
 #include <type_traits>
+#include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/charconv.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
-#include "absl/types/optional.h"
 #include "iree/base/memory.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
@@ -128,69 +134,187 @@ Status ParseBinaryData(absl::string_view data_str, absl::Span<uint8_t> output) {
   return OkStatus();
 }
 
+// Inputs and outputs are split into chunks of at least this many bytes that
+// are processed on separate threads.
+constexpr size_t kMinParallelChunkBytes = 1024 * 1024;
+
+// Returns the number of chunks |byte_length| bytes of work is split into.
+int ChunkCountForSize(size_t byte_length) {
+  size_t max_chunk_count = std::max(1u, std::thread::hardware_concurrency());
+  return static_cast<int>(std::min(
+      max_chunk_count,
+      std::max(size_t{1}, byte_length / kMinParallelChunkBytes)));
+}
+
+// Runs |fn| for each chunk index in [0, chunk_count), with all but the first
+// chunk on their own threads.
+template <typename F>
+void ForEachChunk(int chunk_count, const F& fn) {
+  std::vector<std::thread> threads;
+  threads.reserve(chunk_count - 1);
+  for (int i = 1; i < chunk_count; ++i) {
+    threads.emplace_back([&fn, i]() { fn(i); });
+  }
+  fn(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Returns true if |c| separates elements in numerical data strings.
+inline bool IsElementSeparator(char c) {
+  return absl::ascii_isspace(c) || c == ',' || c == '[' || c == ']';
+}
+
+// Parses a base-10 integer with an optional sign from [begin, end).
+bool ParseDecimal(const char* begin, const char* end, bool* negative,
+                  uint64_t* magnitude) {
+  *negative = false;
+  if (begin != end && (*begin == '-' || *begin == '+')) {
+    *negative = *begin == '-';
+    ++begin;
+  }
+  if (begin == end) return false;
+  uint64_t value = 0;
+  for (const char* p = begin; p != end; ++p) {
+    unsigned digit = static_cast<unsigned char>(*p) - '0';
+    if (digit > 9) return false;
+    if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  *magnitude = value;
+  return true;
+}
+
+// Stores the parsed integer in |out| if it is representable as T.
+template <typename T>
+bool NarrowDecimal(bool negative, uint64_t magnitude, T* out) {
+  constexpr uint64_t kMax =
+      static_cast<uint64_t>(std::numeric_limits<T>::max());
+  if (!std::is_signed<T>::value) {
+    if ((negative && magnitude) || magnitude > kMax) return false;
+    *out = static_cast<T>(magnitude);
+  } else if (negative) {
+    if (magnitude > kMax + 1) return false;
+    *out = magnitude ? -static_cast<T>(magnitude - 1) - 1 : 0;
+  } else {
+    if (magnitude > kMax) return false;
+    *out = static_cast<T>(magnitude);
+  }
+  return true;
+}
+
 template <typename ElementType, typename Enabled = void>
-struct SimpleStrToValue {
-  absl::optional<ElementType> operator()(absl::string_view text) const = delete;
+struct ElementParser {
+  bool operator()(const char* begin, const char* end,
+                  ElementType* out) const = delete;
 };
 
 template <typename IntegerType>
-struct SimpleStrToValue<
+struct ElementParser<
     IntegerType,
-    typename std::enable_if<(sizeof(IntegerType) < 4), void>::type> {
-  absl::optional<IntegerType> operator()(absl::string_view text) const {
+    typename std::enable_if<std::is_integral<IntegerType>::value &&
+                                (sizeof(IntegerType) < 4),
+                            void>::type> {
+  bool operator()(const char* begin, const char* end, IntegerType* out) const {
+    // Small types are parsed as int32 and truncated, like absl::SimpleAtoi.
+    bool negative;
+    uint64_t magnitude;
     int32_t value;
-    return absl::SimpleAtoi(text, &value) ? absl::optional<IntegerType>{value}
-                                          : absl::nullopt;
+    if (!ParseDecimal(begin, end, &negative, &magnitude) ||
+        !NarrowDecimal(negative, magnitude, &value)) {
+      return false;
+    }
+    *out = static_cast<IntegerType>(value);
+    return true;
   }
 };
 
 template <typename IntegerType>
-struct SimpleStrToValue<
+struct ElementParser<
     IntegerType,
-    typename std::enable_if<(sizeof(IntegerType) >= 4), void>::type> {
-  absl::optional<IntegerType> operator()(absl::string_view text) const {
-    IntegerType value;
-    return absl::SimpleAtoi(text, &value) ? absl::optional<IntegerType>{value}
-                                          : absl::nullopt;
+    typename std::enable_if<std::is_integral<IntegerType>::value &&
+                                (sizeof(IntegerType) >= 4),
+                            void>::type> {
+  bool operator()(const char* begin, const char* end, IntegerType* out) const {
+    bool negative;
+    uint64_t magnitude;
+    return ParseDecimal(begin, end, &negative, &magnitude) &&
+           NarrowDecimal(negative, magnitude, out);
   }
 };
 
-template <>
-struct SimpleStrToValue<float, void> {
-  absl::optional<float> operator()(absl::string_view text) const {
-    float value;
-    return absl::SimpleAtof(text, &value) ? absl::optional<float>{value}
-                                          : absl::nullopt;
+template <typename FloatType>
+struct ElementParser<
+    FloatType,
+    typename std::enable_if<std::is_floating_point<FloatType>::value,
+                            void>::type> {
+  bool operator()(const char* begin, const char* end, FloatType* out) const {
+    // absl::from_chars never matches a leading '+'.
+    if (begin != end && *begin == '+') {
+      ++begin;
+      if (begin != end && *begin == '-') return false;
+    }
+    FloatType value;
+    auto result = absl::from_chars(begin, end, value);
+    if (result.ptr != end || begin == end) return false;
+    if (result.ec == std::errc::result_out_of_range) {
+      // Saturate to infinity or zero, like strtod.
+      if (value > FloatType(1)) {
+        value = std::numeric_limits<FloatType>::infinity();
+      } else if (value < FloatType(-1)) {
+        value = -std::numeric_limits<FloatType>::infinity();
+      }
+    } else if (result.ec != std::errc()) {
+      return false;
+    }
+    *out = value;
+    return true;
   }
 };
 
-template <>
-struct SimpleStrToValue<double, void> {
-  absl::optional<double> operator()(absl::string_view text) const {
-    double value;
-    return absl::SimpleAtod(text, &value) ? absl::optional<double>{value}
-                                          : absl::nullopt;
+// Returns the number of elements in data_str[begin, end).
+size_t CountElements(absl::string_view data_str, size_t begin, size_t end) {
+  size_t count = 0;
+  bool in_token = false;
+  for (size_t i = begin; i < end; ++i) {
+    bool is_separator = IsElementSeparator(data_str[i]);
+    if (!is_separator && !in_token) ++count;
+    in_token = !is_separator;
   }
-};
+  return count;
+}
 
+// Parses the elements in data_str[begin, end) directly into |output| starting
+// at |*dst_i|. |begin| and |end| must not split an element.
 template <typename T>
-Status ParseNumericalDataElement(absl::string_view data_str, size_t token_start,
-                                 size_t token_end, absl::Span<T> output,
-                                 int dst_i) {
-  if (dst_i >= output.size()) {
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Input data string contains more elements than the underlying "
-              "buffer ("
-           << output.size() << "): " << data_str;
-  }
-  auto element_str = data_str.substr(token_start, token_end - token_start + 1);
-  auto element = SimpleStrToValue<T>()(element_str);
-  if (!element.has_value()) {
-    return InvalidArgumentErrorBuilder(IREE_LOC)
-           << "Unable to parse element " << dst_i << " = '" << element_str
-           << "'";
+Status ParseElements(absl::string_view data_str, size_t begin, size_t end,
+                     absl::Span<T> output, size_t* dst_i) {
+  ElementParser<T> parser;
+  const char* data = data_str.data();
+  size_t src_i = begin;
+  while (src_i < end) {
+    if (IsElementSeparator(data[src_i])) {
+      ++src_i;
+      continue;
+    }
+    size_t token_start = src_i;
+    while (src_i < end && !IsElementSeparator(data[src_i])) ++src_i;
+    if (*dst_i >= output.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Input data string contains more elements than the "
+                "underlying buffer ("
+             << output.size() << "): " << data_str;
+    }
+    if (!parser(data + token_start, data + src_i, &output[*dst_i])) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Unable to parse element " << *dst_i << " = '"
+             << data_str.substr(token_start, src_i - token_start) << "'";
+    }
+    ++*dst_i;
   }
-  output[dst_i] = element.value();
   return OkStatus();
 }
 
@@ -198,28 +322,50 @@ template <typename T>
 Status ParseNumericalDataAsType(absl::string_view data_str,
                                 absl::Span<uint8_t> output) {
   auto cast_output = ReinterpretSpan<T>(output);
-  size_t src_i = 0;
+  int chunk_count = ChunkCountForSize(data_str.size());
   size_t dst_i = 0;
-  size_t token_start = std::string::npos;
-  while (src_i < data_str.size()) {
-    char c = data_str[src_i++];
-    bool is_separator =
-        absl::ascii_isspace(c) || c == ',' || c == '[' || c == ']';
-    if (token_start == std::string::npos) {
-      if (!is_separator) {
-        token_start = src_i - 1;
+  if (chunk_count == 1) {
+    RETURN_IF_ERROR(ParseElements(data_str, 0, data_str.size(), cast_output,
+                                  &dst_i));
+  } else {
+    // Split at separators so that no element spans two chunks, count the
+    // elements in each chunk to find where it starts in the output, and then
+    // parse all chunks in parallel.
+    std::vector<size_t> chunk_bounds(chunk_count + 1, data_str.size());
+    chunk_bounds[0] = 0;
+    for (int i = 1; i < chunk_count; ++i) {
+      size_t bound = std::max(chunk_bounds[i - 1],
+                              data_str.size() / chunk_count * i);
+      while (bound < data_str.size() && !IsElementSeparator(data_str[bound])) {
+        ++bound;
       }
-      continue;
-    } else if (token_start != std::string::npos && !is_separator) {
-      continue;
+      chunk_bounds[i] = bound;
+    }
+    std::vector<size_t> chunk_offsets(chunk_count + 1, 0);
+    ForEachChunk(chunk_count, [&](int i) {
+      chunk_offsets[i + 1] =
+          CountElements(data_str, chunk_bounds[i], chunk_bounds[i + 1]);
+    });
+    for (int i = 0; i < chunk_count; ++i) {
+      chunk_offsets[i + 1] += chunk_offsets[i];
+    }
+    dst_i = chunk_offsets[chunk_count];
+    if (dst_i > cast_output.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Input data string contains more elements than the "
+                "underlying buffer ("
+             << cast_output.size() << "): " << data_str;
+    }
+    std::vector<Status> chunk_statuses(chunk_count);
+    ForEachChunk(chunk_count, [&](int i) {
+      size_t chunk_dst_i = chunk_offsets[i];
+      chunk_statuses[i] = ParseElements(data_str, chunk_bounds[i],
+                                        chunk_bounds[i + 1], cast_output,
+                                        &chunk_dst_i);
+    });
+    for (auto& status : chunk_statuses) {
+      RETURN_IF_ERROR(status);
     }
-    RETURN_IF_ERROR(ParseNumericalDataElement<T>(
-        data_str, token_start, src_i - 2, cast_output, dst_i++));
-    token_start = std::string::npos;
-  }
-  if (token_start != std::string::npos) {
-    RETURN_IF_ERROR(ParseNumericalDataElement<T>(
-        data_str, token_start, data_str.size() - 1, cast_output, dst_i++));
   }
   if (dst_i < cast_output.size()) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
@@ -260,43 +406,107 @@ Status ParseNumericalData(absl::string_view type_str,
   }
 }
 
+// Appends brackets for each dimension of |dims| when there are no elements to
+// print because one of the inner dimensions is zero.
+void AppendEmptyNesting(absl::Span<const int> dims, std::string* out) {
+  for (int i = 0; i < dims[0]; ++i) {
+    out->push_back('[');
+    if (dims.size() > 1) AppendEmptyNesting(dims.subspan(1), out);
+    out->push_back(']');
+  }
+}
+
+// Appends rows [row_begin, row_end) of |data| laid out as |shape|, where a row
+// is one run of the innermost dimension. Rows are wrapped in brackets for each
+// outer dimension and only the first |max_entries| elements are printed, with
+// an ellipsis in each row that was truncated.
 template <typename T>
-void PrintElementList(const Shape& shape, absl::Span<const T> data,
-                      size_t* max_entries, std::ostream* stream) {
-  if (shape.empty()) {
-    // Scalar value.
-    PrintElementList({1}, data, max_entries, stream);
-    return;
-  } else if (shape.size() == 1) {
-    // Leaf dimension; output data.
-    size_t max_count = std::min(*max_entries, static_cast<size_t>(shape[0]));
-    *stream << absl::StrJoin(data.subspan(0, max_count), " ");
-    if (max_count < shape[0]) {
-      *stream << "...";
+void AppendElementRows(absl::Span<const int> shape, absl::Span<const T> data,
+                       size_t max_entries, size_t row_begin, size_t row_end,
+                       std::string* out) {
+  size_t row_length = shape.back();
+  // Number of rows within each of the outer dimensions, outermost first.
+  absl::InlinedVector<size_t, 6> rows_per_dim(shape.size() - 1, 1);
+  for (int i = static_cast<int>(rows_per_dim.size()) - 2; i >= 0; --i) {
+    rows_per_dim[i] = rows_per_dim[i + 1] * shape[i + 1];
+  }
+  for (size_t row = row_begin; row < row_end; ++row) {
+    for (size_t dim_rows : rows_per_dim) {
+      if (row % dim_rows == 0) out->push_back('[');
     }
-    *max_entries -= max_count;
-  } else {
-    // Nested; recurse into next dimension.
-    Shape nested_shape = Shape(shape.subspan(1));
-    size_t length = nested_shape.element_count();
-    size_t offset = 0;
-    for (int i = 0; i < shape[0]; ++i) {
-      *stream << "[";
-      PrintElementList<T>(nested_shape, data.subspan(offset, length),
-                          max_entries, stream);
-      offset += length;
-      *stream << "]";
+    size_t row_offset = row * row_length;
+    size_t print_count =
+        max_entries > row_offset ? std::min(max_entries - row_offset,
+                                            row_length)
+                                 : 0;
+    size_t data_end = std::min(row_offset + print_count, data.size());
+    for (size_t i = row_offset; i < data_end; ++i) {
+      if (i > row_offset) out->push_back(' ');
+      absl::AlphaNum element(data[i]);
+      out->append(element.data(), element.size());
+    }
+    if (print_count < row_length) out->append("...");
+    for (auto it = rows_per_dim.rbegin(); it != rows_per_dim.rend(); ++it) {
+      if ((row + 1) % *it == 0) out->push_back(']');
     }
   }
 }
 
 template <typename T>
-Status PrintNumericalDataToStreamAsType(const Shape& shape,
+Status PrintNumericalDataToStringAsType(const Shape& shape,
                                         absl::Span<const uint8_t> contents,
                                         size_t max_entries,
-                                        std::ostream* stream) {
+                                        std::string* out_result) {
   auto cast_contents = ReinterpretSpan<T>(contents);
-  PrintElementList(shape, cast_contents, &max_entries, stream);
+  out_result->clear();
+  // Scalars are printed as a single element list.
+  absl::InlinedVector<int, 6> dims(shape.begin(), shape.end());
+  if (dims.empty()) dims.push_back(1);
+  auto dims_span = absl::MakeConstSpan(dims);
+  auto outer_dims = dims_span.subspan(0, dims.size() - 1);
+  size_t row_count = 1;
+  for (int dim : outer_dims) row_count *= dim;
+  if (row_count == 0) {
+    if (!outer_dims.empty()) AppendEmptyNesting(outer_dims, out_result);
+    return OkStatus();
+  }
+
+  // Split the rows with elements to print into chunks that are formatted in
+  // parallel. Truncated rows are cheap and left to the last chunk.
+  size_t row_length = dims.back();
+  size_t print_count = std::min(max_entries, row_count * row_length);
+  size_t print_row_count =
+      row_length ? (print_count + row_length - 1) / row_length : 0;
+  constexpr size_t kEstimatedElementChars = 8;
+  int chunk_count = static_cast<int>(
+      std::min(std::max(print_row_count, size_t{1}),
+               static_cast<size_t>(ChunkCountForSize(
+                   print_count * kEstimatedElementChars))));
+  if (chunk_count == 1) {
+    out_result->reserve(print_count * kEstimatedElementChars);
+    AppendElementRows(dims_span, cast_contents, max_entries, 0, row_count,
+                      out_result);
+    return OkStatus();
+  }
+  std::vector<std::string> chunk_results(chunk_count);
+  ForEachChunk(chunk_count, [&](int i) {
+    size_t row_begin = print_row_count * i / chunk_count;
+    size_t row_end = i + 1 == chunk_count
+                         ? row_count
+                         : print_row_count * (i + 1) / chunk_count;
+    chunk_results[i].reserve((row_end - row_begin) * row_length *
+                             kEstimatedElementChars);
+    AppendElementRows(dims_span, cast_contents, max_entries, row_begin,
+                      row_end, &chunk_results[i]);
+  });
+  size_t total_length = 0;
+  for (const auto& chunk_result : chunk_results) {
+    total_length += chunk_result.size();
+  }
+  out_result->reserve(total_length);
+  for (const auto& chunk_result : chunk_results) {
+    out_result->append(chunk_result);
+  }
   return OkStatus();
 }
 
@@ -413,30 +623,32 @@ StatusOr<std::string> PrintBinaryDataToString(
 Status PrintBinaryDataToString(int element_size,
                                absl::Span<const uint8_t> contents,
                                size_t max_entries, std::string* out_result) {
-  std::ostringstream stream;
-  RETURN_IF_ERROR(
-      PrintBinaryDataToStream(element_size, contents, max_entries, &stream));
-  *out_result = stream.str();
-  return OkStatus();
-}
-
-Status PrintBinaryDataToStream(int element_size,
-                               absl::Span<const uint8_t> contents,
-                               size_t max_entries, std::ostream* stream) {
   // TODO(gcmn) Can we avoid this fiddly byte counting?
   max_entries *= element_size;  // Counting bytes, but treat them as elements.
   constexpr size_t hex_chars_per_byte = 2;
   constexpr size_t max_bytes = sizeof(int64_t);
   CHECK_LE(element_size, max_bytes);
-  // Plus one char for the null terminator.
-  char hex_buffer[hex_chars_per_byte * max_bytes + 1] = {0};
-  for (size_t i = 0; i < std::min(max_entries, contents.size());
-       i += element_size) {
-    if (i > 0) *stream << " ";
+  size_t byte_count = std::min(max_entries, contents.size());
+  size_t element_count = (byte_count + element_size - 1) / element_size;
+  out_result->clear();
+  out_result->reserve(byte_count * hex_chars_per_byte + element_count + 3);
+  char hex_buffer[hex_chars_per_byte * max_bytes];
+  for (size_t i = 0; i < byte_count; i += element_size) {
+    if (i > 0) out_result->push_back(' ');
     BytesToHexString(contents.data() + i, hex_buffer, element_size);
-    *stream << hex_buffer;
+    out_result->append(hex_buffer, element_size * hex_chars_per_byte);
   }
-  if (contents.size() > max_entries) *stream << "...";
+  if (contents.size() > max_entries) out_result->append("...");
+  return OkStatus();
+}
+
+Status PrintBinaryDataToStream(int element_size,
+                               absl::Span<const uint8_t> contents,
+                               size_t max_entries, std::ostream* stream) {
+  std::string result;
+  RETURN_IF_ERROR(
+      PrintBinaryDataToString(element_size, contents, max_entries, &result));
+  stream->write(result.data(), result.size());
   return OkStatus();
 }
 
@@ -449,58 +661,58 @@ StatusOr<std::string> PrintNumericalDataToString(
   return result;
 }
 
+// Prints numerical data (ints, floats, etc) from some typed form.
 Status PrintNumericalDataToString(const Shape& shape,
                                   absl::string_view type_str,
                                   absl::Span<const uint8_t> contents,
                                   size_t max_entries, std::string* out_result) {
-  std::ostringstream stream;
-  RETURN_IF_ERROR(PrintNumericalDataToStream(shape, type_str, contents,
-                                             max_entries, &stream));
-  *out_result = stream.str();
-  return OkStatus();
-}
-
-// Prints numerical data (ints, floats, etc) from some typed form.
-Status PrintNumericalDataToStream(const Shape& shape,
-                                  absl::string_view type_str,
-                                  absl::Span<const uint8_t> contents,
-                                  size_t max_entries, std::ostream* stream) {
   if (type_str == "i8") {
-    return PrintNumericalDataToStreamAsType<int8_t>(shape, contents,
-                                                    max_entries, stream);
+    return PrintNumericalDataToStringAsType<int8_t>(shape, contents,
+                                                    max_entries, out_result);
   } else if (type_str == "u8") {
-    return PrintNumericalDataToStreamAsType<uint8_t>(shape, contents,
-                                                     max_entries, stream);
+    return PrintNumericalDataToStringAsType<uint8_t>(shape, contents,
+                                                     max_entries, out_result);
   } else if (type_str == "i16") {
-    return PrintNumericalDataToStreamAsType<int16_t>(shape, contents,
-                                                     max_entries, stream);
+    return PrintNumericalDataToStringAsType<int16_t>(shape, contents,
+                                                     max_entries, out_result);
   } else if (type_str == "u16") {
-    return PrintNumericalDataToStreamAsType<uint16_t>(shape, contents,
-                                                      max_entries, stream);
+    return PrintNumericalDataToStringAsType<uint16_t>(shape, contents,
+                                                      max_entries, out_result);
   } else if (type_str == "i32") {
-    return PrintNumericalDataToStreamAsType<int32_t>(shape, contents,
-                                                     max_entries, stream);
+    return PrintNumericalDataToStringAsType<int32_t>(shape, contents,
+                                                     max_entries, out_result);
   } else if (type_str == "u32") {
-    return PrintNumericalDataToStreamAsType<uint32_t>(shape, contents,
-                                                      max_entries, stream);
+    return PrintNumericalDataToStringAsType<uint32_t>(shape, contents,
+                                                      max_entries, out_result);
   } else if (type_str == "i64") {
-    return PrintNumericalDataToStreamAsType<int64_t>(shape, contents,
-                                                     max_entries, stream);
+    return PrintNumericalDataToStringAsType<int64_t>(shape, contents,
+                                                     max_entries, out_result);
   } else if (type_str == "u64") {
-    return PrintNumericalDataToStreamAsType<uint64_t>(shape, contents,
-                                                      max_entries, stream);
+    return PrintNumericalDataToStringAsType<uint64_t>(shape, contents,
+                                                      max_entries, out_result);
   } else if (type_str == "f32") {
-    return PrintNumericalDataToStreamAsType<float>(shape, contents, max_entries,
-                                                   stream);
+    return PrintNumericalDataToStringAsType<float>(shape, contents, max_entries,
+                                                   out_result);
   } else if (type_str == "f64") {
-    return PrintNumericalDataToStreamAsType<double>(shape, contents,
-                                                    max_entries, stream);
+    return PrintNumericalDataToStringAsType<double>(shape, contents,
+                                                    max_entries, out_result);
   } else {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Unsupported type: " << type_str;
   }
 }
 
+Status PrintNumericalDataToStream(const Shape& shape,
+                                  absl::string_view type_str,
+                                  absl::Span<const uint8_t> contents,
+                                  size_t max_entries, std::ostream* stream) {
+  std::string result;
+  RETURN_IF_ERROR(PrintNumericalDataToString(shape, type_str, contents,
+                                             max_entries, &result));
+  stream->write(result.data(), result.size());
+  return OkStatus();
+}
+
 Status ParseBufferDataAsType(absl::string_view data_str,
                              absl::string_view type_str,
                              absl::Span<uint8_t> output) {
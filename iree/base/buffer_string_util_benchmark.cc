@@ -0,0 +1,94 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/buffer_string_util.h"
+#include "iree/base/logging.h"
+#include "iree/base/memory.h"
+
+namespace iree {
+namespace {
+
+// Returns |element_count| values that print with a mix of lengths.
+template <typename T>
+std::vector<T> MakeValues(int element_count) {
+  std::vector<T> values(element_count);
+  for (int i = 0; i < element_count; ++i) {
+    values[i] = static_cast<T>((i % 2 ? -1 : 1) * (i % 1000) * 1.375);
+  }
+  return values;
+}
+
+template <typename T>
+const char* TypeString();
+template <>
+const char* TypeString<int32_t>() {
+  return "i32";
+}
+template <>
+const char* TypeString<float>() {
+  return "f32";
+}
+
+// Parsing and printing throughput is reported in bytes of text per second.
+template <typename T>
+void BM_ParseBufferData(benchmark::State& state) {
+  const char* type_str = TypeString<T>();
+  int element_count = state.range(0);
+  auto values = MakeValues<T>(element_count);
+  std::string data_str;
+  CHECK_OK(PrintNumericalDataToString(
+      {element_count}, type_str,
+      ReinterpretSpan<uint8_t>(absl::MakeSpan(values)), element_count,
+      &data_str));
+  auto output = ReinterpretSpan<uint8_t>(absl::MakeSpan(values));
+  for (auto _ : state) {
+    CHECK_OK(ParseBufferDataAsType(data_str, type_str, output));
+  }
+  state.SetBytesProcessed(state.iterations() * data_str.size());
+}
+
+template <typename T>
+void BM_PrintNumericalData(benchmark::State& state) {
+  const char* type_str = TypeString<T>();
+  int element_count = state.range(0);
+  auto values = MakeValues<T>(element_count);
+  auto contents = ReinterpretSpan<uint8_t>(absl::MakeConstSpan(values));
+  std::string data_str;
+  for (auto _ : state) {
+    CHECK_OK(PrintNumericalDataToString({element_count / 1024, 1024}, type_str,
+                                        contents, element_count, &data_str));
+    benchmark::DoNotOptimize(data_str.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data_str.size());
+}
+
+BENCHMARK_TEMPLATE(BM_ParseBufferData, int32_t)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_ParseBufferData, float)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_PrintNumericalData, int32_t)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_PrintNumericalData, float)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024);
+
+}  // namespace
+}  // namespace iree
@@ -14,6 +14,11 @@
 
 #include "iree/base/buffer_string_util.h"
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "iree/base/memory.h"
 #include "iree/base/status.h"
@@ -108,6 +113,29 @@ TEST(BufferStringUtilTest, PrintNumericalDataToString) {
             PrintNumericalDataToString({4}, "i32", bytes, 10).ValueOrDie());
 }
 
+TEST(BufferStringUtilTest, PrintNumericalDataToStringNested) {
+  std::vector<uint8_t> data = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  EXPECT_EQ("[[0 1 2][3 4 5]][[6 7 8][9 10 11]]",
+            PrintNumericalDataToString({2, 2, 3}, "u8", data, 100)
+                .ValueOrDie());
+  EXPECT_EQ("[[0 1 2][3 4...]][[...][...]]",
+            PrintNumericalDataToString({2, 2, 3}, "u8", data, 5)
+                .ValueOrDie());
+  EXPECT_EQ("0 1...",
+            PrintNumericalDataToString({12}, "u8", data, 2).ValueOrDie());
+  EXPECT_EQ("7", PrintNumericalDataToString({}, "u8", {7}, 2).ValueOrDie());
+  EXPECT_EQ("[][]",
+            PrintNumericalDataToString({2, 0, 3}, "u8", {}, 2).ValueOrDie());
+  EXPECT_EQ("[][]",
+            PrintNumericalDataToString({2, 0}, "u8", {}, 2).ValueOrDie());
+  std::vector<float> floats = {0.5f, -1.25f, 1e10f, 3.14159265f};
+  EXPECT_EQ("[0.5 -1.25][1e+10 3.14159]",
+            PrintNumericalDataToString(
+                {2, 2}, "f32", ReinterpretSpan<uint8_t>(absl::MakeSpan(floats)),
+                10)
+                .ValueOrDie());
+}
+
 TEST(BufferStringUtilTest, ParseBufferDatai8) {
   std::vector<uint8_t> data(4);
   auto data_span = absl::MakeSpan(data);
@@ -129,6 +157,73 @@ TEST(BufferStringUtilTest, ParseBufferDataf32) {
   EXPECT_THAT(ReinterpretSpan<float>(data_span), ElementsAre(0, 1.1, 2, 3));
 }
 
+TEST(BufferStringUtilTest, ParseBufferDataIntegerLimits) {
+  std::vector<uint8_t> data(2 * sizeof(int64_t));
+  auto data_span = absl::MakeSpan(data);
+  ASSERT_OK(ParseBufferDataAsType(
+      "-9223372036854775808 +9223372036854775807", "i64", data_span));
+  EXPECT_THAT(ReinterpretSpan<int64_t>(data_span),
+              ElementsAre(std::numeric_limits<int64_t>::min(),
+                          std::numeric_limits<int64_t>::max()));
+  EXPECT_TRUE(IsInvalidArgument(
+      ParseBufferDataAsType("0 9223372036854775808", "i64", data_span)));
+  EXPECT_TRUE(
+      IsInvalidArgument(ParseBufferDataAsType("0 -1", "u64", data_span)));
+  EXPECT_TRUE(
+      IsInvalidArgument(ParseBufferDataAsType("0 1x", "u64", data_span)));
+  EXPECT_TRUE(
+      IsInvalidArgument(ParseBufferDataAsType("0 -", "i64", data_span)));
+}
+
+TEST(BufferStringUtilTest, ParseBufferDataFloatSyntax) {
+  std::vector<uint8_t> data(5 * sizeof(double));
+  auto data_span = absl::MakeSpan(data);
+  ASSERT_OK(ParseBufferDataAsType("[+1.5, -2e3, inf, 1e400, .25]", "f64",
+                                  data_span));
+  EXPECT_THAT(ReinterpretSpan<double>(data_span),
+              ElementsAre(1.5, -2000.0, std::numeric_limits<double>::infinity(),
+                          std::numeric_limits<double>::infinity(), 0.25));
+  EXPECT_TRUE(IsInvalidArgument(
+      ParseBufferDataAsType("1 2 3 4 +-5", "f64", data_span)));
+  EXPECT_TRUE(IsInvalidArgument(
+      ParseBufferDataAsType("1 2 3 4 5.0f", "f64", data_span)));
+}
+
+TEST(BufferStringUtilTest, ParseBufferDataElementCountMismatch) {
+  std::vector<uint8_t> data(4 * sizeof(int32_t));
+  auto data_span = absl::MakeSpan(data);
+  EXPECT_TRUE(
+      IsInvalidArgument(ParseBufferDataAsType("0 1 2", "i32", data_span)));
+  EXPECT_TRUE(
+      IsInvalidArgument(ParseBufferDataAsType("0 1 2 3 4", "i32", data_span)));
+}
+
+// Large enough to be split into multiple chunks when threads are available.
+TEST(BufferStringUtilTest, LargeRoundTrip) {
+  constexpr int kElementCount = 1024 * 1024;
+  std::vector<float> values(kElementCount);
+  for (int i = 0; i < kElementCount; ++i) {
+    values[i] = (i % 2 ? -1.0f : 1.0f) * i / 8.0f;
+  }
+  auto bytes = ReinterpretSpan<uint8_t>(absl::MakeSpan(values));
+  std::string str;
+  ASSERT_OK(PrintNumericalDataToString({1024, 1024}, "f32", bytes,
+                                       kElementCount, &str));
+  EXPECT_EQ(0, str.find("[0 -0.125 0.25 "));
+
+  std::vector<float> parsed_values(kElementCount);
+  ASSERT_OK(ParseBufferDataAsType(
+      str, "f32", ReinterpretSpan<uint8_t>(absl::MakeSpan(parsed_values))));
+  for (int i = 0; i < kElementCount; ++i) {
+    // Values are printed with six significant digits.
+    ASSERT_NEAR(values[i], parsed_values[i], std::abs(values[i]) * 1e-5f)
+        << "element " << i;
+  }
+  EXPECT_TRUE(IsInvalidArgument(ParseBufferDataAsType(
+      absl::StrCat(str, " 1"), "f32",
+      ReinterpretSpan<uint8_t>(absl::MakeSpan(parsed_values)))));
+}
+
 TEST(BufferStringUtilTest, ParseBufferDataBinary) {
   std::vector<uint8_t> data(4);
   auto data_span = absl::MakeSpan(data);
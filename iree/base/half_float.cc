@@ -0,0 +1,89 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/half_float.h"
+
+#include <cstring>
+
+#include "iree/base/logging.h"
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(__AVX512BF16__)
+#include <immintrin.h>
+#endif
+
+namespace iree {
+
+void ConvertToFloat(absl::Span<const Float16> src, absl::Span<float> dst) {
+  DCHECK_EQ(src.size(), dst.size());
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= src.size(); i += 8) {
+    __m128i half_values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i));
+    _mm256_storeu_ps(dst.data() + i, _mm256_cvtph_ps(half_values));
+  }
+#endif  // __F16C__
+  for (; i < src.size(); ++i) {
+    dst[i] = Float16BitsToFloat(src[i].bits());
+  }
+}
+
+void ConvertToFloat(absl::Span<const BFloat16> src, absl::Span<float> dst) {
+  DCHECK_EQ(src.size(), dst.size());
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 8 <= src.size(); i += 8) {
+    __m128i half_values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i));
+    __m256i float_bits =
+        _mm256_slli_epi32(_mm256_cvtepu16_epi32(half_values), 16);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.data() + i),
+                        float_bits);
+  }
+#endif  // __AVX2__
+  for (; i < src.size(); ++i) {
+    dst[i] = BFloat16BitsToFloat(src[i].bits());
+  }
+}
+
+void ConvertFromFloat(absl::Span<const float> src, absl::Span<Float16> dst) {
+  DCHECK_EQ(src.size(), dst.size());
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= src.size(); i += 8) {
+    __m128i half_values = _mm256_cvtps_ph(_mm256_loadu_ps(src.data() + i),
+                                          _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.data() + i), half_values);
+  }
+#endif  // __F16C__
+  for (; i < src.size(); ++i) {
+    dst[i] = Float16::FromBits(FloatToFloat16Bits(src[i]));
+  }
+}
+
+void ConvertFromFloat(absl::Span<const float> src, absl::Span<BFloat16> dst) {
+  DCHECK_EQ(src.size(), dst.size());
+  size_t i = 0;
+#if defined(__AVX512BF16__)
+  for (; i + 16 <= src.size(); i += 16) {
+    __m256bh half_values = _mm512_cvtneps_pbh(_mm512_loadu_ps(src.data() + i));
+    std::memcpy(dst.data() + i, &half_values, sizeof(half_values));
+  }
+#endif  // __AVX512BF16__
+  for (; i < src.size(); ++i) {
+    dst[i] = BFloat16::FromBits(FloatToBFloat16Bits(src[i]));
+  }
+}
+
+}  // namespace iree
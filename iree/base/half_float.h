@@ -0,0 +1,148 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// 16-bit floating point storage types.
+//
+// Float16 (IEEE 754 binary16) and BFloat16 (the upper half of an IEEE binary32)
+// are storage-only types: arithmetic on them promotes to float and the result
+// is rounded back (to nearest even) when stored. Bulk conversion routines use
+// F16C/AVX-512 instructions when the target supports them.
+
+#ifndef IREE_BASE_HALF_FLOAT_H_
+#define IREE_BASE_HALF_FLOAT_H_
+
+#include <cstdint>
+
+#include "absl/base/casts.h"
+#include "absl/types/span.h"
+#include "iree/base/math.h"
+
+namespace iree {
+
+// Returns the float value of the IEEE binary16 |bits|.
+IREE_FORCEINLINE float Float16BitsToFloat(uint16_t bits) {
+  constexpr uint32_t kShiftedExponent = 0x7C00u << 13;
+  uint32_t value = (bits & 0x7FFFu) << 13;
+  uint32_t exponent = value & kShiftedExponent;
+  value += (127 - 15) << 23;
+  if (exponent == kShiftedExponent) {
+    // Inf/NaN.
+    value += (128 - 16) << 23;
+  } else if (exponent == 0) {
+    // Zero/denormal; renormalize through the FPU.
+    value += 1 << 23;
+    value = absl::bit_cast<uint32_t>(absl::bit_cast<float>(value) -
+                                     absl::bit_cast<float>(113u << 23));
+  }
+  value |= static_cast<uint32_t>(bits & 0x8000u) << 16;
+  return absl::bit_cast<float>(value);
+}
+
+// Returns |value| rounded to the nearest IEEE binary16 value.
+IREE_FORCEINLINE uint16_t FloatToFloat16Bits(float value) {
+  constexpr uint32_t kFloatInfinity = 255u << 23;
+  constexpr uint32_t kFloat16Max = (127u + 16) << 23;
+  constexpr uint32_t kDenormMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+  uint32_t bits = absl::bit_cast<uint32_t>(value);
+  uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+  uint16_t result;
+  if (bits >= kFloat16Max) {
+    // Overflow to Inf or NaN (all NaNs are made quiet).
+    result = bits > kFloatInfinity ? 0x7E00 : 0x7C00;
+  } else if (bits < (113u << 23)) {
+    // Result is a denormal or zero; let the FPU do the rounding.
+    float denorm = absl::bit_cast<float>(bits) +
+                   absl::bit_cast<float>(kDenormMagic);
+    result =
+        static_cast<uint16_t>(absl::bit_cast<uint32_t>(denorm) - kDenormMagic);
+  } else {
+    uint32_t mantissa_odd = (bits >> 13) & 1;
+    bits += ((15u - 127) << 23) + 0xFFF;
+    bits += mantissa_odd;
+    result = static_cast<uint16_t>(bits >> 13);
+  }
+  return result | static_cast<uint16_t>(sign >> 16);
+}
+
+// Returns the float value of the bfloat16 |bits|.
+IREE_FORCEINLINE float BFloat16BitsToFloat(uint16_t bits) {
+  return absl::bit_cast<float>(static_cast<uint32_t>(bits) << 16);
+}
+
+// Returns |value| rounded to the nearest bfloat16 value.
+IREE_FORCEINLINE uint16_t FloatToBFloat16Bits(float value) {
+  uint32_t bits = absl::bit_cast<uint32_t>(value);
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    // Keep NaNs NaN (and quiet) instead of rounding them to Inf.
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+// IEEE 754 binary16 storage type.
+class Float16 {
+ public:
+  Float16() = default;
+  explicit Float16(float value) : bits_(FloatToFloat16Bits(value)) {}
+
+  static Float16 FromBits(uint16_t bits) {
+    Float16 value;
+    value.bits_ = bits;
+    return value;
+  }
+
+  uint16_t bits() const { return bits_; }
+
+  operator float() const { return Float16BitsToFloat(bits_); }
+
+ private:
+  uint16_t bits_ = 0;
+};
+static_assert(sizeof(Float16) == 2, "Float16 must be 2 bytes");
+
+// bfloat16 storage type.
+class BFloat16 {
+ public:
+  BFloat16() = default;
+  explicit BFloat16(float value) : bits_(FloatToBFloat16Bits(value)) {}
+
+  static BFloat16 FromBits(uint16_t bits) {
+    BFloat16 value;
+    value.bits_ = bits;
+    return value;
+  }
+
+  uint16_t bits() const { return bits_; }
+
+  operator float() const { return BFloat16BitsToFloat(bits_); }
+
+ private:
+  uint16_t bits_ = 0;
+};
+static_assert(sizeof(BFloat16) == 2, "BFloat16 must be 2 bytes");
+
+// Widens |src| into |dst|, which must be the same size.
+void ConvertToFloat(absl::Span<const Float16> src, absl::Span<float> dst);
+void ConvertToFloat(absl::Span<const BFloat16> src, absl::Span<float> dst);
+
+// Narrows |src| into |dst|, which must be the same size, rounding to nearest
+// even. The AVX-512 BF16 path flushes denormals to zero.
+void ConvertFromFloat(absl::Span<const float> src, absl::Span<Float16> dst);
+void ConvertFromFloat(absl::Span<const float> src, absl::Span<BFloat16> dst);
+
+}  // namespace iree
+
+#endif  // IREE_BASE_HALF_FLOAT_H_
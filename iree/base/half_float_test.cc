@@ -0,0 +1,93 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/half_float.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace {
+
+// Tests exactly representable Float16 values round trip.
+TEST(Float16Test, ExactValues) {
+  EXPECT_EQ(0x0000, Float16(0.0f).bits());
+  EXPECT_EQ(0x8000, Float16(-0.0f).bits());
+  EXPECT_EQ(0x3C00, Float16(1.0f).bits());
+  EXPECT_EQ(0xC000, Float16(-2.0f).bits());
+  EXPECT_EQ(0x7BFF, Float16(65504.0f).bits());
+  EXPECT_EQ(0x0001, Float16(std::ldexp(1.0f, -24)).bits());
+  EXPECT_EQ(1.0f, static_cast<float>(Float16::FromBits(0x3C00)));
+  EXPECT_EQ(65504.0f, static_cast<float>(Float16::FromBits(0x7BFF)));
+  EXPECT_EQ(std::ldexp(1.0f, -24),
+            static_cast<float>(Float16::FromBits(0x0001)));
+}
+
+// Tests Float16 rounding, overflow, and special values.
+TEST(Float16Test, Rounding) {
+  // 1 + 2^-11 is halfway between 1 and the next value; ties go to even.
+  EXPECT_EQ(0x3C00, Float16(1.0f + std::ldexp(1.0f, -11)).bits());
+  EXPECT_EQ(0x3C02, Float16(1.0f + 3 * std::ldexp(1.0f, -11)).bits());
+  EXPECT_EQ(0x7C00, Float16(65520.0f).bits());
+  EXPECT_EQ(0xFC00, Float16(-1.0e10f).bits());
+  EXPECT_EQ(0x0000, Float16(std::ldexp(1.0f, -26)).bits());
+  EXPECT_TRUE(std::isinf(static_cast<float>(Float16::FromBits(0x7C00))));
+  EXPECT_TRUE(std::isnan(static_cast<float>(
+      Float16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+// Tests BFloat16 truncation with round to nearest even.
+TEST(BFloat16Test, Rounding) {
+  EXPECT_EQ(0x3F80, BFloat16(1.0f).bits());
+  EXPECT_EQ(0xC000, BFloat16(-2.0f).bits());
+  // 1 + 2^-8 is halfway between 1 and the next value; ties go to even.
+  EXPECT_EQ(0x3F80, BFloat16(1.0f + std::ldexp(1.0f, -8)).bits());
+  EXPECT_EQ(0x3F82, BFloat16(1.0f + 3 * std::ldexp(1.0f, -8)).bits());
+  EXPECT_EQ(1.0f, static_cast<float>(BFloat16::FromBits(0x3F80)));
+  EXPECT_EQ(0x7F80,
+            BFloat16(std::numeric_limits<float>::infinity()).bits());
+  EXPECT_TRUE(std::isnan(static_cast<float>(
+      BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+// Tests bulk conversions match the scalar ones, including the tails left over
+// by the vectorized paths.
+TEST(HalfFloatTest, BulkConversions) {
+  std::vector<float> values(37);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = (static_cast<int>(i) - 18) * 0.375f;
+  }
+
+  std::vector<Float16> f16_values(values.size());
+  ConvertFromFloat(values, absl::MakeSpan(f16_values));
+  std::vector<BFloat16> bf16_values(values.size());
+  ConvertFromFloat(values, absl::MakeSpan(bf16_values));
+  std::vector<float> f16_widened(values.size());
+  ConvertToFloat(f16_values, absl::MakeSpan(f16_widened));
+  std::vector<float> bf16_widened(values.size());
+  ConvertToFloat(bf16_values, absl::MakeSpan(bf16_widened));
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(Float16(values[i]).bits(), f16_values[i].bits());
+    EXPECT_EQ(BFloat16(values[i]).bits(), bf16_values[i].bits());
+    EXPECT_EQ(values[i], f16_widened[i]);
+    EXPECT_EQ(values[i], bf16_widened[i]);
+  }
+}
+
+}  // namespace
+}  // namespace iree
@@ -35,7 +35,7 @@ Status FileExists(const std::string& path) {
 }
 
 StatusOr<std::string> GetFileContents(const std::string& path) {
-  std::unique_ptr<FILE, void (*)(FILE*)> file = {std::fopen(path.c_str(), "r"),
+  std::unique_ptr<FILE, void (*)(FILE*)> file = {std::fopen(path.c_str(), "rb"),
                                                  +[](FILE* file) {
                                                    if (file) fclose(file);
                                                  }};
@@ -58,7 +58,7 @@ StatusOr<std::string> GetFileContents(const std::string& path) {
   }
   std::string contents;
   contents.resize(file_size);
-  if (std::fread(const_cast<char*>(contents.data()), file_size, 1,
+  if (std::fread(const_cast<char*>(contents.data()), 1, file_size,
                  file.get()) != file_size) {
     return UnavailableErrorBuilder(IREE_LOC)
            << "Unable to read entire file contents";
@@ -66,6 +66,27 @@ StatusOr<std::string> GetFileContents(const std::string& path) {
   return contents;
 }
 
+Status SetFileContents(const std::string& path, absl::string_view content) {
+  std::unique_ptr<FILE, void (*)(FILE*)> file = {std::fopen(path.c_str(), "wb"),
+                                                 +[](FILE* file) {
+                                                   if (file) fclose(file);
+                                                 }};
+  if (file == nullptr) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to open file",
+                                         IREE_LOC);
+  }
+  if (!content.empty() &&
+      std::fwrite(content.data(), content.size(), 1, file.get()) != 1) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to write file",
+                                         IREE_LOC);
+  }
+  if (std::fclose(file.release()) != 0) {
+    return ErrnoToCanonicalStatusBuilder(errno, "Failed to close file",
+                                         IREE_LOC);
+  }
+  return OkStatus();
+}
+
 Status DeleteFile(const std::string& path) {
   if (::remove(path.c_str()) == -1) {
     return ErrnoToCanonicalStatusBuilder(errno, "Failed to delete file",
@@ -51,6 +51,30 @@ StatusOr<std::string> GetFileContents(const std::string& path) {
   return result;
 }
 
+Status SetFileContents(const std::string& path, absl::string_view content) {
+  HANDLE handle = ::CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return Win32ErrorToCanonicalStatusBuilder(GetLastError(), IREE_LOC)
+           << "Unable to open file for writing: " << path;
+  }
+  DWORD bytes_written = 0;
+  BOOL result = ::WriteFile(handle, content.data(),
+                            static_cast<DWORD>(content.size()), &bytes_written,
+                            nullptr);
+  DWORD error = GetLastError();
+  ::CloseHandle(handle);
+  if (result == FALSE) {
+    return Win32ErrorToCanonicalStatusBuilder(error, IREE_LOC)
+           << "Unable to write " << content.size() << " bytes to " << path;
+  } else if (bytes_written != content.size()) {
+    return ResourceExhaustedErrorBuilder(IREE_LOC)
+           << "Unable to write all " << content.size() << " bytes to " << path
+           << " (wrote " << bytes_written << ")";
+  }
+  return OkStatus();
+}
+
 Status DeleteFile(const std::string& path) {
   if (::DeleteFileA(path.c_str()) == FALSE) {
     return Win32ErrorToCanonicalStatusBuilder(GetLastError(), IREE_LOC)
@@ -153,6 +153,9 @@ ABSL_MUST_USE_RESULT Cleanup<DecayF> MakeCleanup(F&& f) {
 #if __has_feature(address_sanitizer)
 #define IREE_CONFIG_ASAN 1
 #endif  // __has_feature(address_sanitizer)
+#if __has_feature(memory_sanitizer)
+#define IREE_CONFIG_MSAN 1
+#endif  // __has_feature(memory_sanitizer)
 #endif  // __has_feature
 
 // If you see these macros being used it means that the code between is not
@@ -166,4 +169,14 @@ ABSL_MUST_USE_RESULT Cleanup<DecayF> MakeCleanup(F&& f) {
 #define IREE_ENABLE_LEAK_CHECKS()
 #endif  // IREE_CONFIG_ASAN
 
+// Marks |size| bytes at |ptr| as newly allocated and uninitialized such that
+// MSan reports reads that happen before the memory is written. Allocators that
+// reuse memory without zeroing it use this to keep MSan coverage.
+#if defined(IREE_CONFIG_MSAN)
+#include <sanitizer/msan_interface.h>
+#define IREE_MSAN_ALLOCATED_MEMORY(ptr, size) __msan_allocated_memory(ptr, size)
+#else
+#define IREE_MSAN_ALLOCATED_MEMORY(ptr, size)
+#endif  // IREE_CONFIG_MSAN
+
 #endif  // IREE_BASE_MEMORY_H_
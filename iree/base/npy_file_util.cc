@@ -0,0 +1,557 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/npy_file_util.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "iree/base/buffer_string_util.h"
+#include "iree/base/source_location.h"
+
+namespace iree {
+
+namespace {
+
+// .npy files start with the magic followed by a major and minor version.
+constexpr char kNpyMagic[] = "\x93NUMPY";
+constexpr size_t kNpyMagicLength = sizeof(kNpyMagic) - 1;
+// np.save pads headers so that array data is aligned to this many bytes.
+constexpr size_t kNpyHeaderAlignment = 64;
+
+// Zip record signatures and fields used by .npz archives.
+// https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+constexpr uint32_t kZipLocalFileHeaderSignature = 0x04034b50;
+constexpr uint32_t kZipCentralDirectorySignature = 0x02014b50;
+constexpr uint32_t kZipEndOfCentralDirectorySignature = 0x06054b50;
+constexpr uint32_t kZip64EndOfCentralDirectorySignature = 0x06064b50;
+constexpr uint32_t kZip64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+constexpr size_t kZipLocalFileHeaderSize = 30;
+constexpr size_t kZipCentralDirectoryHeaderSize = 46;
+constexpr size_t kZipEndOfCentralDirectorySize = 22;
+constexpr size_t kZip64EndOfCentralDirectorySize = 56;
+constexpr size_t kZip64EndOfCentralDirectoryLocatorSize = 20;
+constexpr size_t kZipMaxCommentLength = 0xFFFF;
+constexpr uint16_t kZip64ExtraFieldId = 0x0001;
+constexpr uint16_t kZipVersion = 20;
+constexpr uint16_t kZipMethodStored = 0;
+// MS-DOS date of 1980-01-01, the earliest representable.
+constexpr uint16_t kZipDate = (1 << 5) | 1;
+constexpr uint32_t kZip32Max = 0xFFFFFFFF;
+constexpr uint16_t kZip16Max = 0xFFFF;
+
+// Zip and .npy integers are little-endian, as are all supported hosts.
+template <typename T>
+T LoadLittleEndian(absl::Span<const uint8_t> data, size_t offset) {
+  T value;
+  std::memcpy(&value, data.data() + offset, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void AppendLittleEndian(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Returns true if [offset, offset + length) lies within |size| bytes.
+bool InBounds(uint64_t size, uint64_t offset, uint64_t length) {
+  return offset <= size && length <= size - offset;
+}
+
+// Returns the CRC-32 of |data| continuing from |crc|, as used by zip.
+uint32_t UpdateCrc32(uint32_t crc, absl::Span<const uint8_t> data) {
+  static const auto* table = []() {
+    auto* table = new std::array<uint32_t, 256>();
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t value = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+      }
+      (*table)[i] = value;
+    }
+    return table;
+  }();
+  crc = ~crc;
+  for (uint8_t byte : data) {
+    crc = (*table)[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+absl::Span<const uint8_t> StringBytes(absl::string_view str) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(str.data()),
+                             str.size());
+}
+
+// Returns the text following the |key| entry in a .npy header dictionary.
+StatusOr<absl::string_view> FindHeaderValue(absl::string_view header,
+                                            absl::string_view key) {
+  for (const char* quote : {"'", "\""}) {
+    std::string quoted_key = absl::StrCat(quote, key, quote);
+    auto key_pos = header.find(quoted_key);
+    if (key_pos == absl::string_view::npos) continue;
+    auto value = absl::StripLeadingAsciiWhitespace(
+        header.substr(key_pos + quoted_key.size()));
+    if (absl::ConsumePrefix(&value, ":")) {
+      return absl::StripLeadingAsciiWhitespace(value);
+    }
+  }
+  return InvalidArgumentErrorBuilder(IREE_LOC)
+         << "Missing '" << key << "' in .npy header: " << header;
+}
+
+// Converts a NumPy dtype descriptor such as '<f4' to an element type.
+Status ParseDescr(absl::string_view descr, std::string* out_type_str,
+                  int* out_element_size) {
+  int element_size = 0;
+  if (descr.size() < 3 || !absl::SimpleAtoi(descr.substr(2), &element_size) ||
+      element_size <= 0) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Unsupported .npy dtype '" << descr << "'";
+  }
+  char byte_order = descr[0];
+  char kind = descr[1];
+  if (byte_order == '>' && element_size > 1) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Big-endian .npy arrays are not supported (dtype '" << descr
+           << "')";
+  } else if (byte_order != '<' && byte_order != '|' && byte_order != '=' &&
+             byte_order != '>') {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid .npy dtype '" << descr << "'";
+  }
+  bool is_standard_size = element_size == 1 || element_size == 2 ||
+                          element_size == 4 || element_size == 8;
+  if ((kind == 'i' || kind == 'u') && is_standard_size) {
+    *out_type_str = absl::StrCat(std::string(1, kind), element_size * 8);
+  } else if (kind == 'f' && (element_size == 4 || element_size == 8)) {
+    *out_type_str = absl::StrCat("f", element_size * 8);
+  } else if (kind == 'b' || kind == 'f' || kind == 'c' || kind == 'V') {
+    // Fixed-size types without an equivalent are treated as binary data.
+    *out_type_str = std::to_string(element_size);
+  } else {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Unsupported .npy dtype '" << descr << "'";
+  }
+  *out_element_size = element_size;
+  return OkStatus();
+}
+
+// Converts an element type to a NumPy dtype descriptor.
+StatusOr<std::string> MakeDescr(absl::string_view type_str, int element_size) {
+  char kind = type_str.empty() ? 0 : type_str[0];
+  if (absl::ascii_isdigit(kind)) {
+    return absl::StrCat("|V", element_size);
+  } else if (kind != 'i' && kind != 'u' && kind != 'f') {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Unsupported element type '" << type_str << "'";
+  }
+  return absl::StrCat(element_size == 1 ? "|" : "<", std::string(1, kind),
+                      element_size);
+}
+
+// Parses the .npy header dictionary into |array|.
+Status ParseNpyHeader(absl::string_view header, NpyArray* array) {
+  ASSIGN_OR_RETURN(auto descr_value, FindHeaderValue(header, "descr"));
+  if (descr_value.empty() ||
+      (descr_value[0] != '\'' && descr_value[0] != '"')) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Structured .npy dtypes are not supported: " << header;
+  }
+  auto descr_end = descr_value.find(descr_value[0], 1);
+  if (descr_end == absl::string_view::npos) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid .npy header: " << header;
+  }
+  RETURN_IF_ERROR(ParseDescr(descr_value.substr(1, descr_end - 1),
+                             &array->type_str, &array->element_size));
+
+  ASSIGN_OR_RETURN(auto fortran_order_value,
+                   FindHeaderValue(header, "fortran_order"));
+  if (absl::StartsWith(fortran_order_value, "True")) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Fortran-order .npy arrays are not supported";
+  }
+
+  ASSIGN_OR_RETURN(auto shape_value, FindHeaderValue(header, "shape"));
+  auto shape_end = shape_value.find(')');
+  if (!absl::StartsWith(shape_value, "(") ||
+      shape_end == absl::string_view::npos) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid .npy shape: " << header;
+  }
+  std::vector<int> dims;
+  int64_t element_count = 1;
+  for (auto dim_str : absl::StrSplit(shape_value.substr(1, shape_end - 1), ',',
+                                     absl::SkipWhitespace())) {
+    dim_str = absl::StripAsciiWhitespace(dim_str);
+    // Python 2 writes longs with an L suffix.
+    absl::ConsumeSuffix(&dim_str, "L");
+    int dim = 0;
+    if (!absl::SimpleAtoi(dim_str, &dim) || dim < 0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid .npy shape dimension '" << dim_str << "'";
+    }
+    element_count *= dim;
+    if (element_count > std::numeric_limits<int>::max()) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << ".npy array has too many elements: " << header;
+    }
+    dims.push_back(dim);
+  }
+  array->shape = Shape(absl::MakeConstSpan(dims));
+  return OkStatus();
+}
+
+// Appends the .npy magic, version and header describing |array| to |out|.
+Status AppendNpyHeader(const NpyArray& array, std::string* out) {
+  ASSIGN_OR_RETURN(int element_size,
+                   ParseBufferTypeElementSize(array.type_str));
+  if (array.contents.size() !=
+      static_cast<size_t>(array.shape.element_count()) * element_size) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Array contents of " << array.contents.size()
+           << " bytes do not match the shape "
+           << PrintShapedTypeToString(array.shape, array.type_str);
+  }
+  ASSIGN_OR_RETURN(auto descr, MakeDescr(array.type_str, element_size));
+  std::string header = absl::StrCat(
+      "{'descr': '", descr, "', 'fortran_order': False, 'shape': (",
+      absl::StrJoin(array.shape.subspan(), ", "),
+      array.shape.size() == 1 ? "," : "", "), }");
+  // Pad with spaces and a trailing newline so the data is aligned.
+  size_t prefix_length = kNpyMagicLength + 2 + sizeof(uint16_t);
+  size_t unpadded_length = prefix_length + header.size() + 1;
+  size_t padded_length = (unpadded_length + kNpyHeaderAlignment - 1) /
+                         kNpyHeaderAlignment * kNpyHeaderAlignment;
+  header.append(padded_length - unpadded_length, ' ');
+  header.push_back('\n');
+  if (header.size() > kZip16Max) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << ".npy header too large for shape "
+           << PrintShapedTypeToString(array.shape, array.type_str);
+  }
+  out->append(kNpyMagic, kNpyMagicLength);
+  out->push_back(1);  // major version
+  out->push_back(0);  // minor version
+  AppendLittleEndian(static_cast<uint16_t>(header.size()), out);
+  out->append(header);
+  return OkStatus();
+}
+
+// Parses the zip64 extra field of a central directory entry, replacing any
+// sizes and offsets that were too large for their 32-bit fields.
+Status ParseZip64ExtraField(absl::Span<const uint8_t> extra,
+                            uint64_t* uncompressed_size,
+                            uint64_t* compressed_size,
+                            uint64_t* local_header_offset) {
+  size_t offset = 0;
+  while (InBounds(extra.size(), offset, 4)) {
+    auto field_id = LoadLittleEndian<uint16_t>(extra, offset);
+    auto field_size = LoadLittleEndian<uint16_t>(extra, offset + 2);
+    offset += 4;
+    if (!InBounds(extra.size(), offset, field_size)) break;
+    if (field_id == kZip64ExtraFieldId) {
+      auto field = extra.subspan(offset, field_size);
+      size_t field_offset = 0;
+      for (uint64_t* value :
+           {uncompressed_size, compressed_size, local_header_offset}) {
+        if (*value != kZip32Max) continue;
+        if (!InBounds(field.size(), field_offset, sizeof(uint64_t))) {
+          return InvalidArgumentErrorBuilder(IREE_LOC)
+                 << "Truncated zip64 extra field";
+        }
+        *value = LoadLittleEndian<uint64_t>(field, field_offset);
+        field_offset += sizeof(uint64_t);
+      }
+    }
+    offset += field_size;
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+bool IsNpyFile(absl::Span<const uint8_t> file_data) {
+  return file_data.size() >= kNpyMagicLength &&
+         std::memcmp(file_data.data(), kNpyMagic, kNpyMagicLength) == 0;
+}
+
+bool IsNpzFile(absl::Span<const uint8_t> file_data) {
+  return file_data.size() >= sizeof(uint32_t) &&
+         (LoadLittleEndian<uint32_t>(file_data, 0) ==
+              kZipLocalFileHeaderSignature ||
+          LoadLittleEndian<uint32_t>(file_data, 0) ==
+              kZipEndOfCentralDirectorySignature);
+}
+
+StatusOr<NpyArray> ParseNpyFile(absl::Span<const uint8_t> file_data) {
+  if (!IsNpyFile(file_data) || file_data.size() < kNpyMagicLength + 4) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Not a .npy file";
+  }
+  uint8_t major_version = file_data[kNpyMagicLength];
+  size_t header_offset = kNpyMagicLength + 2;
+  size_t header_length = 0;
+  if (major_version == 1) {
+    header_length = LoadLittleEndian<uint16_t>(file_data, header_offset);
+    header_offset += sizeof(uint16_t);
+  } else if (major_version == 2 || major_version == 3) {
+    if (!InBounds(file_data.size(), header_offset, sizeof(uint32_t))) {
+      return InvalidArgumentErrorBuilder(IREE_LOC) << "Truncated .npy header";
+    }
+    header_length = LoadLittleEndian<uint32_t>(file_data, header_offset);
+    header_offset += sizeof(uint32_t);
+  } else {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Unsupported .npy version " << static_cast<int>(major_version);
+  }
+  if (!InBounds(file_data.size(), header_offset, header_length)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Truncated .npy header";
+  }
+
+  NpyArray array;
+  RETURN_IF_ERROR(ParseNpyHeader(
+      absl::string_view(
+          reinterpret_cast<const char*>(file_data.data()) + header_offset,
+          header_length),
+      &array));
+  size_t data_offset = header_offset + header_length;
+  uint64_t data_length =
+      static_cast<uint64_t>(array.shape.element_count()) * array.element_size;
+  if (!InBounds(file_data.size(), data_offset, data_length)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Truncated .npy data; expected " << data_length << " bytes for "
+           << PrintShapedTypeToString(array.shape, array.type_str);
+  }
+  array.contents = file_data.subspan(data_offset, data_length);
+  return array;
+}
+
+StatusOr<std::vector<NpyArray>> ParseNpzFile(
+    absl::Span<const uint8_t> file_data) {
+  // Find the end of central directory record, which may be followed by a
+  // comment.
+  if (file_data.size() < kZipEndOfCentralDirectorySize) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Not a .npz file";
+  }
+  size_t eocd_offset = file_data.size() - kZipEndOfCentralDirectorySize;
+  size_t min_eocd_offset =
+      eocd_offset > kZipMaxCommentLength ? eocd_offset - kZipMaxCommentLength
+                                         : 0;
+  while (LoadLittleEndian<uint32_t>(file_data, eocd_offset) !=
+         kZipEndOfCentralDirectorySignature) {
+    if (eocd_offset == min_eocd_offset) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Not a .npz file; no zip end of central directory record";
+    }
+    --eocd_offset;
+  }
+  uint64_t entry_count =
+      LoadLittleEndian<uint16_t>(file_data, eocd_offset + 10);
+  uint64_t directory_offset =
+      LoadLittleEndian<uint32_t>(file_data, eocd_offset + 16);
+  if (entry_count == kZip16Max || directory_offset == kZip32Max) {
+    // The real values are in the zip64 end of central directory record.
+    size_t locator_offset =
+        eocd_offset - std::min(eocd_offset,
+                               kZip64EndOfCentralDirectoryLocatorSize);
+    if (eocd_offset < kZip64EndOfCentralDirectoryLocatorSize ||
+        LoadLittleEndian<uint32_t>(file_data, locator_offset) !=
+            kZip64EndOfCentralDirectoryLocatorSignature) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Missing zip64 end of central directory locator";
+    }
+    uint64_t zip64_eocd_offset =
+        LoadLittleEndian<uint64_t>(file_data, locator_offset + 8);
+    if (!InBounds(file_data.size(), zip64_eocd_offset,
+                  kZip64EndOfCentralDirectorySize) ||
+        LoadLittleEndian<uint32_t>(file_data, zip64_eocd_offset) !=
+            kZip64EndOfCentralDirectorySignature) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid zip64 end of central directory record";
+    }
+    entry_count = LoadLittleEndian<uint64_t>(file_data, zip64_eocd_offset + 32);
+    directory_offset =
+        LoadLittleEndian<uint64_t>(file_data, zip64_eocd_offset + 48);
+  }
+
+  std::vector<NpyArray> arrays;
+  uint64_t offset = directory_offset;
+  for (uint64_t i = 0; i < entry_count; ++i) {
+    if (!InBounds(file_data.size(), offset, kZipCentralDirectoryHeaderSize) ||
+        LoadLittleEndian<uint32_t>(file_data, offset) !=
+            kZipCentralDirectorySignature) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid zip central directory entry " << i;
+    }
+    auto method = LoadLittleEndian<uint16_t>(file_data, offset + 10);
+    uint64_t compressed_size =
+        LoadLittleEndian<uint32_t>(file_data, offset + 20);
+    uint64_t uncompressed_size =
+        LoadLittleEndian<uint32_t>(file_data, offset + 24);
+    auto name_length = LoadLittleEndian<uint16_t>(file_data, offset + 28);
+    auto extra_length = LoadLittleEndian<uint16_t>(file_data, offset + 30);
+    auto comment_length = LoadLittleEndian<uint16_t>(file_data, offset + 32);
+    uint64_t local_header_offset =
+        LoadLittleEndian<uint32_t>(file_data, offset + 42);
+    size_t name_offset = offset + kZipCentralDirectoryHeaderSize;
+    if (!InBounds(file_data.size(), name_offset,
+                  name_length + extra_length)) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Truncated zip central directory entry " << i;
+    }
+    std::string name(
+        reinterpret_cast<const char*>(file_data.data()) + name_offset,
+        name_length);
+    RETURN_IF_ERROR(ParseZip64ExtraField(
+        file_data.subspan(name_offset + name_length, extra_length),
+        &uncompressed_size, &compressed_size, &local_header_offset));
+    if (method != kZipMethodStored || compressed_size != uncompressed_size) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Compressed .npz entry '" << name
+             << "' is not supported; save with np.savez instead of "
+                "np.savez_compressed";
+    }
+
+    if (!InBounds(file_data.size(), local_header_offset,
+                  kZipLocalFileHeaderSize) ||
+        LoadLittleEndian<uint32_t>(file_data, local_header_offset) !=
+            kZipLocalFileHeaderSignature) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid zip local file header for '" << name << "'";
+    }
+    uint64_t data_offset =
+        local_header_offset + kZipLocalFileHeaderSize +
+        LoadLittleEndian<uint16_t>(file_data, local_header_offset + 26) +
+        LoadLittleEndian<uint16_t>(file_data, local_header_offset + 28);
+    if (!InBounds(file_data.size(), data_offset, compressed_size)) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Truncated .npz entry '" << name << "'";
+    }
+    ASSIGN_OR_RETURN(
+        auto array,
+        ParseNpyFile(file_data.subspan(data_offset, compressed_size)),
+        _ << "while parsing .npz entry '" << name << "'");
+    array.name = std::string(absl::StripSuffix(name, ".npy"));
+    arrays.push_back(std::move(array));
+
+    offset = name_offset + name_length + extra_length + comment_length;
+  }
+  return arrays;
+}
+
+Status AppendNpyFile(const NpyArray& array, std::string* out) {
+  RETURN_IF_ERROR(AppendNpyHeader(array, out));
+  out->append(reinterpret_cast<const char*>(array.contents.data()),
+              array.contents.size());
+  return OkStatus();
+}
+
+Status AppendNpzFile(absl::Span<const NpyArray> arrays, std::string* out) {
+  struct Entry {
+    std::string name;
+    uint32_t crc;
+    uint32_t size;
+    uint32_t local_header_offset;
+  };
+  if (arrays.size() >= kZip16Max) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Too many arrays for a .npz file: " << arrays.size();
+  }
+  size_t archive_offset = out->size();
+  std::vector<Entry> entries;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const auto& array = arrays[i];
+    Entry entry;
+    entry.name = absl::StrCat(
+        array.name.empty() ? absl::StrCat("arr_", i) : array.name, ".npy");
+    std::string npy_header;
+    RETURN_IF_ERROR(AppendNpyHeader(array, &npy_header));
+    uint64_t size = npy_header.size() + array.contents.size();
+    uint64_t local_header_offset = out->size() - archive_offset;
+    if (size >= kZip32Max || local_header_offset >= kZip32Max) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << ".npz files over 4GiB are not supported; save array '"
+             << entry.name << "' as .npy";
+    }
+    entry.crc = UpdateCrc32(UpdateCrc32(0, StringBytes(npy_header)),
+                            array.contents);
+    entry.size = static_cast<uint32_t>(size);
+    entry.local_header_offset = static_cast<uint32_t>(local_header_offset);
+
+    AppendLittleEndian(kZipLocalFileHeaderSignature, out);
+    AppendLittleEndian(kZipVersion, out);
+    AppendLittleEndian<uint16_t>(0, out);  // flags
+    AppendLittleEndian(kZipMethodStored, out);
+    AppendLittleEndian<uint16_t>(0, out);  // time
+    AppendLittleEndian(kZipDate, out);
+    AppendLittleEndian(entry.crc, out);
+    AppendLittleEndian(entry.size, out);  // compressed size
+    AppendLittleEndian(entry.size, out);  // uncompressed size
+    AppendLittleEndian(static_cast<uint16_t>(entry.name.size()), out);
+    AppendLittleEndian<uint16_t>(0, out);  // extra field length
+    out->append(entry.name);
+    out->append(npy_header);
+    out->append(reinterpret_cast<const char*>(array.contents.data()),
+                array.contents.size());
+    entries.push_back(std::move(entry));
+  }
+
+  uint64_t directory_offset = out->size() - archive_offset;
+  for (const auto& entry : entries) {
+    AppendLittleEndian(kZipCentralDirectorySignature, out);
+    AppendLittleEndian(kZipVersion, out);  // version made by
+    AppendLittleEndian(kZipVersion, out);  // version needed
+    AppendLittleEndian<uint16_t>(0, out);  // flags
+    AppendLittleEndian(kZipMethodStored, out);
+    AppendLittleEndian<uint16_t>(0, out);  // time
+    AppendLittleEndian(kZipDate, out);
+    AppendLittleEndian(entry.crc, out);
+    AppendLittleEndian(entry.size, out);  // compressed size
+    AppendLittleEndian(entry.size, out);  // uncompressed size
+    AppendLittleEndian(static_cast<uint16_t>(entry.name.size()), out);
+    AppendLittleEndian<uint16_t>(0, out);  // extra field length
+    AppendLittleEndian<uint16_t>(0, out);  // comment length
+    AppendLittleEndian<uint16_t>(0, out);  // disk number
+    AppendLittleEndian<uint16_t>(0, out);  // internal attributes
+    AppendLittleEndian<uint32_t>(0, out);  // external attributes
+    AppendLittleEndian(entry.local_header_offset, out);
+    out->append(entry.name);
+  }
+  uint64_t directory_size = out->size() - archive_offset - directory_offset;
+  if (directory_offset >= kZip32Max) {
+    return OutOfRangeErrorBuilder(IREE_LOC)
+           << ".npz files over 4GiB are not supported";
+  }
+
+  AppendLittleEndian(kZipEndOfCentralDirectorySignature, out);
+  AppendLittleEndian<uint16_t>(0, out);  // disk number
+  AppendLittleEndian<uint16_t>(0, out);  // central directory disk number
+  AppendLittleEndian(static_cast<uint16_t>(entries.size()), out);
+  AppendLittleEndian(static_cast<uint16_t>(entries.size()), out);
+  AppendLittleEndian(static_cast<uint32_t>(directory_size), out);
+  AppendLittleEndian(static_cast<uint32_t>(directory_offset), out);
+  AppendLittleEndian<uint16_t>(0, out);  // comment length
+  return OkStatus();
+}
+
+}  // namespace iree
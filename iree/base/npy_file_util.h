@@ -0,0 +1,77 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Utilities for reading and writing arrays in the NumPy .npy format and .npz
+// archives of .npy files, as produced by np.save and np.savez.
+// https://numpy.org/doc/stable/reference/generated/numpy.lib.format.html
+//
+// Element types are named as in buffer_string_util.h (i8, u16, f32, etc).
+// Arrays of other fixed-size NumPy types (bool, float16, complex, void) are
+// read as binary data of their element size. Only little-endian C-order
+// arrays and uncompressed archives are supported; np.savez_compressed output
+// must be re-saved with np.savez.
+//
+// Parsing does not copy: the parsed arrays reference the file data directly,
+// allowing memory-mapped files to be used in place.
+
+#ifndef IREE_BASE_NPY_FILE_UTIL_H_
+#define IREE_BASE_NPY_FILE_UTIL_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "iree/base/shape.h"
+#include "iree/base/status.h"
+
+namespace iree {
+
+// An array stored in a .npy file or .npz archive.
+struct NpyArray {
+  // Name of the array within an .npz archive without the .npy extension.
+  // Empty for standalone .npy files.
+  std::string name;
+  Shape shape;
+  // Element type, e.g. f32, or the element size in bytes for binary data.
+  std::string type_str;
+  int element_size = 0;
+  // Array contents in row-major order.
+  absl::Span<const uint8_t> contents;
+};
+
+// Returns true if |file_data| starts with the .npy or .npz (zip) magic.
+bool IsNpyFile(absl::Span<const uint8_t> file_data);
+bool IsNpzFile(absl::Span<const uint8_t> file_data);
+
+// Parses a .npy file. The returned contents reference |file_data|.
+StatusOr<NpyArray> ParseNpyFile(absl::Span<const uint8_t> file_data);
+
+// Parses the arrays in a .npz archive in archive order. The returned contents
+// reference |file_data|.
+StatusOr<std::vector<NpyArray>> ParseNpzFile(
+    absl::Span<const uint8_t> file_data);
+
+// Appends a .npy file containing |array| to |out|. The name is ignored.
+Status AppendNpyFile(const NpyArray& array, std::string* out);
+
+// Appends an uncompressed .npz archive containing |arrays| to |out|.
+// Arrays without names are named arr_0, arr_1, etc like np.savez.
+Status AppendNpzFile(absl::Span<const NpyArray> arrays, std::string* out);
+
+}  // namespace iree
+
+#endif  // IREE_BASE_NPY_FILE_UTIL_H_
@@ -0,0 +1,215 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/npy_file_util.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "iree/base/memory.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace {
+
+using ::testing::ElementsAre;
+
+absl::Span<const uint8_t> StringBytes(absl::string_view str) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(str.data()),
+                             str.size());
+}
+
+// Returns a version 1.0 .npy file with the given header and data.
+std::string MakeNpyFile(absl::string_view header, absl::string_view data) {
+  std::string file("\x93NUMPY\x01\x00", 8);
+  file.push_back(static_cast<char>(header.size() & 0xFF));
+  file.push_back(static_cast<char>(header.size() >> 8));
+  file.append(header.data(), header.size());
+  file.append(data.data(), data.size());
+  return file;
+}
+
+// Written by np.savez({'a': np.int32([1, 2, 3]),
+//                      'b': np.float32([[0.5, 1.5], [2.5, 3.5]])}),
+// which uses zip64 local headers.
+constexpr char kNpzFile[] =
+    "\x50\x4b\x03\x04\x2d\x00\x00\x00\x00\x00\x00\x00\x21\x00\xeb\xc0"
+    "\x2b\x04\xff\xff\xff\xff\xff\xff\xff\xff\x05\x00\x14\x00\x61\x2e"
+    "\x6e\x70\x79\x01\x00\x10\x00\x8c\x00\x00\x00\x00\x00\x00\x00\x8c"
+    "\x00\x00\x00\x00\x00\x00\x00\x93\x4e\x55\x4d\x50\x59\x01\x00\x76"
+    "\x00\x7b\x27\x64\x65\x73\x63\x72\x27\x3a\x20\x27\x3c\x69\x34\x27"
+    "\x2c\x20\x27\x66\x6f\x72\x74\x72\x61\x6e\x5f\x6f\x72\x64\x65\x72"
+    "\x27\x3a\x20\x46\x61\x6c\x73\x65\x2c\x20\x27\x73\x68\x61\x70\x65"
+    "\x27\x3a\x20\x28\x33\x2c\x29\x2c\x20\x7d\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x0a\x01\x00\x00\x00\x02\x00\x00\x00\x03"
+    "\x00\x00\x00\x50\x4b\x03\x04\x2d\x00\x00\x00\x00\x00\x00\x00\x21"
+    "\x00\xbf\xea\x7c\xf7\xff\xff\xff\xff\xff\xff\xff\xff\x05\x00\x14"
+    "\x00\x62\x2e\x6e\x70\x79\x01\x00\x10\x00\x90\x00\x00\x00\x00\x00"
+    "\x00\x00\x90\x00\x00\x00\x00\x00\x00\x00\x93\x4e\x55\x4d\x50\x59"
+    "\x01\x00\x76\x00\x7b\x27\x64\x65\x73\x63\x72\x27\x3a\x20\x27\x3c"
+    "\x66\x34\x27\x2c\x20\x27\x66\x6f\x72\x74\x72\x61\x6e\x5f\x6f\x72"
+    "\x64\x65\x72\x27\x3a\x20\x46\x61\x6c\x73\x65\x2c\x20\x27\x73\x68"
+    "\x61\x70\x65\x27\x3a\x20\x28\x32\x2c\x20\x32\x29\x2c\x20\x7d\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20\x20"
+    "\x20\x20\x20\x20\x20\x20\x20\x20\x20\x0a\x00\x00\x00\x3f\x00\x00"
+    "\xc0\x3f\x00\x00\x20\x40\x00\x00\x60\x40\x50\x4b\x01\x02\x2d\x03"
+    "\x2d\x00\x00\x00\x00\x00\x00\x00\x21\x00\xeb\xc0\x2b\x04\x8c\x00"
+    "\x00\x00\x8c\x00\x00\x00\x05\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+    "\x00\x00\x80\x01\x00\x00\x00\x00\x61\x2e\x6e\x70\x79\x50\x4b\x01"
+    "\x02\x2d\x03\x2d\x00\x00\x00\x00\x00\x00\x00\x21\x00\xbf\xea\x7c"
+    "\xf7\x90\x00\x00\x00\x90\x00\x00\x00\x05\x00\x00\x00\x00\x00\x00"
+    "\x00\x00\x00\x00\x00\x80\x01\xc3\x00\x00\x00\x62\x2e\x6e\x70\x79"
+    "\x50\x4b\x05\x06\x00\x00\x00\x00\x02\x00\x02\x00\x66\x00\x00\x00"
+    "\x8a\x01\x00\x00\x00\x00";
+
+TEST(NpyFileUtilTest, RoundTripNpy) {
+  std::vector<float> values = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  NpyArray array;
+  array.shape = Shape{2, 3};
+  array.type_str = "f32";
+  array.contents = ReinterpretSpan<uint8_t>(absl::MakeConstSpan(values));
+  std::string file;
+  ASSERT_OK(AppendNpyFile(array, &file));
+  EXPECT_TRUE(IsNpyFile(StringBytes(file)));
+  EXPECT_FALSE(IsNpzFile(StringBytes(file)));
+  EXPECT_THAT(file, ::testing::HasSubstr(
+                        "{'descr': '<f4', 'fortran_order': False, "
+                        "'shape': (2, 3), }"));
+
+  ASSERT_OK_AND_ASSIGN(auto parsed_array, ParseNpyFile(StringBytes(file)));
+  EXPECT_EQ(Shape({2, 3}), parsed_array.shape);
+  EXPECT_EQ("f32", parsed_array.type_str);
+  EXPECT_EQ(4, parsed_array.element_size);
+  // Data is aligned and referenced in place.
+  size_t data_offset =
+      parsed_array.contents.data() - StringBytes(file).data();
+  EXPECT_EQ(0, data_offset % 64);
+  EXPECT_THAT(ReinterpretSpan<float>(parsed_array.contents),
+              ElementsAre(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f));
+}
+
+TEST(NpyFileUtilTest, ParseNpyShapes) {
+  // Parsed arrays reference the file data so it must outlive them.
+  std::string scalar_file = MakeNpyFile(
+      "{'descr': '<i8', 'fortran_order': False, 'shape': (), }\n",
+      std::string("\x07\0\0\0\0\0\0\0", 8));
+  ASSERT_OK_AND_ASSIGN(auto scalar, ParseNpyFile(StringBytes(scalar_file)));
+  EXPECT_EQ(Shape{}, scalar.shape);
+  EXPECT_EQ("i64", scalar.type_str);
+  EXPECT_THAT(ReinterpretSpan<int64_t>(scalar.contents), ElementsAre(7));
+
+  std::string vector_file = MakeNpyFile(
+      "{\"descr\": \"|u1\", \"fortran_order\": False, \"shape\": (3L,)}\n",
+      "\x01\x02\x03");
+  ASSERT_OK_AND_ASSIGN(auto vector, ParseNpyFile(StringBytes(vector_file)));
+  EXPECT_EQ(Shape{3}, vector.shape);
+  EXPECT_EQ("u8", vector.type_str);
+  EXPECT_THAT(vector.contents, ElementsAre(1, 2, 3));
+
+  // Types without an equivalent are loaded as binary data.
+  std::string halves_file = MakeNpyFile(
+      "{'descr': '<f2', 'fortran_order': False, 'shape': (1, 2), }\n",
+      std::string("\x00\x3c\x00\x40", 4));
+  ASSERT_OK_AND_ASSIGN(auto halves, ParseNpyFile(StringBytes(halves_file)));
+  EXPECT_EQ("2", halves.type_str);
+  EXPECT_EQ(2, halves.element_size);
+}
+
+TEST(NpyFileUtilTest, ParseNpyErrors) {
+  EXPECT_TRUE(IsInvalidArgument(
+      ParseNpyFile(StringBytes("not a numpy file")).status()));
+  EXPECT_TRUE(IsUnimplemented(
+      ParseNpyFile(StringBytes(MakeNpyFile(
+                       "{'descr': '>f4', 'fortran_order': False, "
+                       "'shape': (1,), }\n",
+                       std::string("\x3f\x80\x00\x00", 4))))
+          .status()));
+  EXPECT_TRUE(IsUnimplemented(
+      ParseNpyFile(StringBytes(MakeNpyFile(
+                       "{'descr': '<f4', 'fortran_order': True, "
+                       "'shape': (1,), }\n",
+                       std::string("\x00\x00\x80\x3f", 4))))
+          .status()));
+  EXPECT_TRUE(IsUnimplemented(
+      ParseNpyFile(StringBytes(MakeNpyFile(
+                       "{'descr': '|O', 'fortran_order': False, "
+                       "'shape': (1,), }\n",
+                       "")))
+          .status()));
+  EXPECT_TRUE(IsInvalidArgument(
+      ParseNpyFile(StringBytes(MakeNpyFile(
+                       "{'descr': '<f4', 'fortran_order': False, "
+                       "'shape': (2,), }\n",
+                       std::string("\x00\x00\x80\x3f", 4))))
+          .status()));
+}
+
+TEST(NpyFileUtilTest, ParseNpz) {
+  auto file = StringBytes(absl::string_view(kNpzFile, sizeof(kNpzFile) - 1));
+  ASSERT_TRUE(IsNpzFile(file));
+  ASSERT_OK_AND_ASSIGN(auto arrays, ParseNpzFile(file));
+  ASSERT_EQ(2, arrays.size());
+  EXPECT_EQ("a", arrays[0].name);
+  EXPECT_EQ(Shape{3}, arrays[0].shape);
+  EXPECT_EQ("i32", arrays[0].type_str);
+  EXPECT_THAT(ReinterpretSpan<int32_t>(arrays[0].contents),
+              ElementsAre(1, 2, 3));
+  EXPECT_EQ("b", arrays[1].name);
+  EXPECT_EQ(Shape({2, 2}), arrays[1].shape);
+  EXPECT_EQ("f32", arrays[1].type_str);
+  EXPECT_THAT(ReinterpretSpan<float>(arrays[1].contents),
+              ElementsAre(0.5f, 1.5f, 2.5f, 3.5f));
+}
+
+TEST(NpyFileUtilTest, RoundTripNpz) {
+  std::vector<int16_t> values0 = {-1, 2};
+  std::vector<uint8_t> values1 = {0xab, 0xcd, 0xef, 0x01};
+  std::vector<NpyArray> arrays(2);
+  arrays[0].shape = Shape{2};
+  arrays[0].type_str = "i16";
+  arrays[0].contents = ReinterpretSpan<uint8_t>(absl::MakeConstSpan(values0));
+  arrays[1].name = "raw";
+  arrays[1].shape = Shape{2};
+  arrays[1].type_str = "2";
+  arrays[1].contents = values1;
+  std::string file;
+  ASSERT_OK(AppendNpzFile(arrays, &file));
+
+  ASSERT_OK_AND_ASSIGN(auto parsed_arrays, ParseNpzFile(StringBytes(file)));
+  ASSERT_EQ(2, parsed_arrays.size());
+  EXPECT_EQ("arr_0", parsed_arrays[0].name);
+  EXPECT_EQ("i16", parsed_arrays[0].type_str);
+  EXPECT_THAT(ReinterpretSpan<int16_t>(parsed_arrays[0].contents),
+              ElementsAre(-1, 2));
+  EXPECT_EQ("raw", parsed_arrays[1].name);
+  EXPECT_EQ("2", parsed_arrays[1].type_str);
+  EXPECT_THAT(parsed_arrays[1].contents, ElementsAre(0xab, 0xcd, 0xef, 0x01));
+
+  // Mismatched contents are rejected.
+  arrays[1].contents = arrays[1].contents.subspan(1);
+  file.clear();
+  EXPECT_TRUE(IsInvalidArgument(AppendNpzFile(arrays, &file)));
+}
+
+}  // namespace
+}  // namespace iree
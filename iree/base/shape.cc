@@ -23,10 +23,27 @@
 
 namespace iree {
 
-Shape::Shape(const int* values, int size) : rank_(size) {
-  QCHECK_LE(size, kMaxRank)
-      << "Max rank of " << kMaxRank << ", shape has " << size;
-  std::memcpy(value_, values, size * sizeof(int));
+Shape::Shape(const int* values, int size) {
+  storage_.resize(size * 2);
+  std::memcpy(storage_.data(), values, size * sizeof(int));
+  UpdateCachedValues();
+}
+
+void Shape::UpdateCachedValues() {
+  int rank = size();
+  int* dims = storage_.data();
+  int* strides = dims + rank;
+  size_t stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    strides[i] = static_cast<int>(stride);
+    if (dims[i] == -1) {
+      stride = 0;
+    } else {
+      stride *= dims[i];
+    }
+  }
+  // Partial shapes have no elements.
+  element_count_ = static_cast<int>(stride);
 }
 
 std::string Shape::DebugString() const {
@@ -35,64 +52,60 @@ std::string Shape::DebugString() const {
 
 absl::Span<const int> Shape::subspan(size_type pos, size_type len) const {
   if (len == npos) {
-    len = rank_ - pos;
+    len = size() - pos;
   }
-  return absl::MakeConstSpan(&value_[pos], len);
+  return absl::MakeConstSpan(storage_.data() + pos, len);
 }
 
-void Shape::push_back(int dim) {
-  DCHECK_LE(rank_ + 1, kMaxRank);
-  value_[rank_++] = dim;
+void Shape::set_dim(size_type i, int dim) {
+  DCHECK_GE(i, 0);
+  DCHECK_LT(i, size());
+  storage_[i] = dim;
+  UpdateCachedValues();
 }
 
-void Shape::insert(iterator pos, int dim) {
-  int axis = static_cast<int>(pos - value_);
-  DCHECK_GE(axis, 0);
-  DCHECK_LE(axis, rank_);
-  DCHECK_LE(rank_ + 1, kMaxRank);
-  ++rank_;
-  for (int i = rank_ - 1; i > axis; --i) {
-    value_[i] = value_[i - 1];
-  }
-  value_[axis] = dim;
-}
+void Shape::push_back(int dim) { insert(end(), dim); }
 
-void Shape::erase(iterator pos) {
-  int axis = static_cast<int>(pos - value_);
+void Shape::insert(const_iterator pos, int dim) {
+  int axis = static_cast<int>(pos - begin());
   DCHECK_GE(axis, 0);
-  DCHECK_LE(axis, rank_);
-  for (int i = axis; i < rank_ - 1; ++i) {
-    value_[i] = value_[i + 1];
+  DCHECK_LE(axis, size());
+  // Strides are recomputed below so only the dimensions need to be moved.
+  int rank = size() + 1;
+  storage_.resize(rank * 2);
+  for (int i = rank - 1; i > axis; --i) {
+    storage_[i] = storage_[i - 1];
   }
-  --rank_;
+  storage_[axis] = dim;
+  UpdateCachedValues();
 }
 
-int Shape::element_count() const {
-  size_t element_count = 1;
-  for (int i = 0; i < rank_; ++i) {
-    int dim = value_[i];
-    if (dim == -1) {
-      return 0;
-    }
-    element_count *= dim;
+void Shape::erase(const_iterator pos) {
+  int axis = static_cast<int>(pos - begin());
+  DCHECK_GE(axis, 0);
+  DCHECK_LE(axis, size());
+  int rank = size() - 1;
+  for (int i = axis; i < rank; ++i) {
+    storage_[i] = storage_[i + 1];
   }
-  return element_count;
+  storage_.resize(rank * 2);
+  UpdateCachedValues();
 }
 
 StatusOr<int> Shape::ResolveAxis(int axis) const {
-  if (rank_ == 0 && (axis == -1 || axis == 0)) {
+  if (empty() && (axis == -1 || axis == 0)) {
     // Scalar axes resolves to 0.
     return 0;
   }
 
   int new_axis = axis;
   if (new_axis < 0) {
-    new_axis += rank_;
+    new_axis += size();
   }
-  if (new_axis < 0 || new_axis >= rank_) {
+  if (new_axis < 0 || new_axis >= size()) {
     return InvalidArgumentErrorBuilder(IREE_LOC)
            << "Axis " << new_axis << " (orig " << axis
-           << ") out of bounds of rank " << rank_;
+           << ") out of bounds of rank " << size();
   }
   return new_axis;
 }
@@ -23,6 +23,7 @@
 #include <type_traits>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/meta/type_traits.h"
 #include "absl/types/span.h"
 #include "iree/base/logging.h"
@@ -30,26 +31,27 @@
 
 namespace iree {
 
-// For simplicity we limit our shapes to a max of rank-N (shape.size() == N) as
-// this prevents dynamic allocations and rarely are there greater ranks.
-constexpr int kMaxRank = 5;
-
-// Represent indices and lengths of tensors.
-using Index = std::array<int, kMaxRank>;
-using Length = std::array<int, kMaxRank>;
-
 // Represents the number of elements in multiple dimensions.
-// Can be rank-0 (scalar) to rank-kMaxRank. Tries to match the API of
+// Can be rank-0 (scalar) or any higher rank. Tries to match the API of
 // std::vector and can be converted to a Span via subspan().
 //
+// Shapes up to kInlineRank are stored inline; larger ranks spill to the heap.
+// The element count and row-major strides are computed whenever the shape is
+// modified so that kernels can query them without recomputing per call. As
+// the cached values must stay in sync dimensions can only be modified through
+// the mutation methods (set_dim, push_back, etc) and not by reference.
+//
 // https://www.tensorflow.org/guide/tensors#shape
 class Shape {
  public:
   using size_type = int;
   static constexpr size_type npos = ~(size_type(0));  // NOLINT
-  using iterator = int*;
+  using iterator = const int*;
   using const_iterator = const int*;
 
+  // Ranks up to this are stored without heap allocation.
+  static constexpr int kInlineRank = 6;
+
   Shape() = default;
   Shape(const int* values, int size);
   Shape(std::initializer_list<int> values)
@@ -63,81 +65,155 @@ class Shape {
       std::forward_iterator_tag>::value>;
   template <typename Iterator, EnableIfForwardIterator<Iterator>* = nullptr>
   Shape(Iterator first, Iterator last) {
-    rank_ = std::distance(first, last);
-    QCHECK_LE(rank_, kMaxRank);
+    int rank = static_cast<int>(std::distance(first, last));
+    storage_.resize(rank * 2);
     for (int i = 0; first != last; ++i, static_cast<void>(++first)) {
-      value_[i] = *first;
+      storage_[i] = *first;
     }
+    UpdateCachedValues();
   }
 
   // Returns a string representation of the given shape.
   std::string DebugString() const;
 
   // Size (aka 'rank') of the shape, counting the number of dimensions.
-  constexpr size_type size() const noexcept { return rank_; }
+  size_type size() const noexcept {
+    return static_cast<size_type>(storage_.size() / 2);
+  }
 
   // Whether the shape is rank-0 (scalar).
-  constexpr bool empty() const noexcept { return rank_ == 0; }
+  bool empty() const noexcept { return storage_.empty(); }
 
   // Returns the total elements in the tensor shape.
   // Returns 0 if the tensor shape is not complete and 1 if the shape is a
   // scalar value.
-  int element_count() const;
+  int element_count() const noexcept { return element_count_; }
+
+  // Returns the row-major stride, in elements, of each dimension. The stride
+  // of dimensions outer to an unknown (-1) dimension is 0.
+  absl::Span<const int> strides() const noexcept {
+    return absl::MakeConstSpan(storage_.data() + size(), size());
+  }
+
+  // Returns the stride, in elements, of dimension |i|.
+  int stride(size_type i) const noexcept {
+    DCHECK_GE(i, 0);
+    DCHECK_LT(i, size());
+    return storage_[size() + i];
+  }
 
   // Resolves an axis in [-R,R) to the real axis value and verifies the range.
   StatusOr<int> ResolveAxis(int axis) const;
 
   // Compares two shapes for equality.
   inline static bool Equal(const Shape& a, const Shape& b) {
-    return a.rank_ == b.rank_ &&
-           std::memcmp(a.value_, b.value_, a.rank_ * sizeof(value_[0])) == 0;
-  }
-
-  int& operator[](size_type i) noexcept {
-    DCHECK_GE(i, 0);
-    DCHECK_LT(i, rank_);
-    return value_[i];
+    // Strides are a function of the dimensions and need not be compared.
+    return a.size() == b.size() &&
+           std::memcmp(a.storage_.data(), b.storage_.data(),
+                       a.size() * sizeof(int)) == 0;
   }
 
   const int& operator[](size_type i) const noexcept {
     DCHECK_GE(i, 0);
-    DCHECK_LT(i, rank_);
-    return value_[i];
+    DCHECK_LT(i, size());
+    return storage_[i];
   }
 
   int front() const noexcept {
-    DCHECK_GE(rank_, 1);
-    return value_[0];
+    DCHECK_GE(size(), 1);
+    return storage_[0];
   }
 
   int back() const noexcept {
-    DCHECK_GE(rank_, 1);
-    return value_[rank_ - 1];
+    DCHECK_GE(size(), 1);
+    return storage_[size() - 1];
   }
 
-  constexpr iterator begin() const noexcept {
-    return const_cast<iterator>(&value_[0]);
-  }
-  constexpr iterator end() const noexcept {
-    return const_cast<iterator>(&value_[rank_]);
-  }
-  constexpr const_iterator cbegin() const noexcept { return &value_[0]; }
-  constexpr const_iterator cend() const noexcept { return &value_[rank_]; }
+  const_iterator begin() const noexcept { return storage_.data(); }
+  const_iterator end() const noexcept { return storage_.data() + size(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
 
   absl::Span<const int> subspan(size_type pos = 0, size_type len = npos) const;
   absl::Span<const int> data() const { return subspan(); }
 
+  // Sets dimension |i| to |dim|.
+  void set_dim(size_type i, int dim);
+
   void push_back(int dim);
 
-  void insert(iterator pos, int dim);
+  void insert(const_iterator pos, int dim);
 
-  void erase(iterator pos);
+  void erase(const_iterator pos);
 
-  void clear() { rank_ = 0; }
+  void clear() {
+    storage_.clear();
+    element_count_ = 1;
+  }
 
  private:
-  size_type rank_ = 0;
-  int value_[kMaxRank];
+  // Recomputes element_count_ and the strides from the dimensions.
+  void UpdateCachedValues();
+
+  // Dimensions followed by their strides: [d0, ..., dN-1, s0, ..., sN-1].
+  absl::InlinedVector<int, kInlineRank * 2> storage_;
+  int element_count_ = 1;
+};
+
+// A shape with dimensions known at compile time.
+// Kernels specialized on a StaticShape get constant ranks, strides and element
+// counts so that index math is fully unrolled:
+//
+//   using Filter = StaticShape<3, 3, 64>;
+//   for (int y = 0; y < Filter::dim(0); ++y) {
+//     ... filter[Filter::Offset(y, x, c)] ...
+//   }
+template <int... kDims>
+struct StaticShape {
+  static constexpr int kRank = sizeof...(kDims);
+
+  // Returns dimension |i|.
+  static constexpr int dim(int i) {
+    // The trailing 0 keeps the array non-empty for scalars.
+    const int dims[] = {kDims..., 0};
+    return dims[i];
+  }
+
+  // Returns the total number of elements.
+  static constexpr int element_count() {
+    int element_count = 1;
+    for (int i = 0; i < kRank; ++i) element_count *= dim(i);
+    return element_count;
+  }
+
+  // Returns the row-major stride, in elements, of dimension |i|.
+  static constexpr int stride(int i) {
+    int stride = 1;
+    for (int j = i + 1; j < kRank; ++j) stride *= dim(j);
+    return stride;
+  }
+
+  // Returns the flat row-major offset of the element at |indices|.
+  template <typename... Indices>
+  static constexpr int Offset(Indices... indices) {
+    static_assert(sizeof...(Indices) == kRank, "One index per dimension");
+    const int index_values[] = {static_cast<int>(indices)..., 0};
+    int offset = 0;
+    for (int i = 0; i < kRank; ++i) offset += index_values[i] * stride(i);
+    return offset;
+  }
+
+  // Returns true if |shape| has exactly these dimensions.
+  static bool Matches(const Shape& shape) {
+    if (shape.size() != kRank) return false;
+    for (int i = 0; i < kRank; ++i) {
+      if (shape[i] != dim(i)) return false;
+    }
+    return true;
+  }
+
+  // Returns the dynamic Shape with these dimensions.
+  static Shape ToShape() { return Shape({kDims...}); }
 };
 
 inline bool operator==(const Shape& a, const Shape& b) {
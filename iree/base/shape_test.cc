@@ -170,6 +170,77 @@ TEST(ShapeTest, ElementCount) {
   EXPECT_EQ(0, Shape({1, -1, 2, 3}).element_count());
 }
 
+TEST(ShapeTest, Strides) {
+  EXPECT_THAT(Shape({}).strides(), ElementsAre());
+  EXPECT_THAT(Shape({5}).strides(), ElementsAre(1));
+  EXPECT_THAT(Shape({2, 3, 4}).strides(), ElementsAre(12, 4, 1));
+  EXPECT_EQ(4, Shape({2, 3, 4}).stride(1));
+
+  // Dimensions outside of an unknown dimension have no stride.
+  EXPECT_THAT(Shape({2, -1, 4}).strides(), ElementsAre(0, 4, 1));
+}
+
+// Tests that cached values track modifications of the shape.
+TEST(ShapeTest, CachedValuesUpdate) {
+  Shape shape = {2, 3};
+  shape.set_dim(1, 5);
+  EXPECT_THAT(shape.subspan(), ElementsAre(2, 5));
+  EXPECT_EQ(10, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre(5, 1));
+
+  shape.push_back(4);
+  EXPECT_EQ(40, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre(20, 4, 1));
+
+  shape.insert(shape.begin(), 3);
+  EXPECT_EQ(120, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre(40, 20, 4, 1));
+
+  shape.erase(shape.begin() + 2);
+  EXPECT_THAT(shape.subspan(), ElementsAre(3, 2, 4));
+  EXPECT_EQ(24, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre(8, 4, 1));
+
+  shape.clear();
+  EXPECT_EQ(1, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre());
+}
+
+// Tests shapes with a rank beyond the inline storage.
+TEST(ShapeTest, HighRank) {
+  Shape shape = {1, 2, 1, 2, 1, 2, 1, 2};
+  EXPECT_GT(shape.size(), Shape::kInlineRank);
+  EXPECT_EQ(8, shape.size());
+  EXPECT_EQ(16, shape.element_count());
+  EXPECT_THAT(shape.strides(), ElementsAre(16, 8, 8, 4, 4, 2, 2, 1));
+  EXPECT_EQ(shape, Shape(shape.subspan()));
+  shape.push_back(3);
+  EXPECT_EQ(9, shape.size());
+  EXPECT_EQ(48, shape.element_count());
+  EXPECT_EQ("[1,2,1,2,1,2,1,2,3]", shape.DebugString());
+}
+
+TEST(ShapeTest, StaticShape) {
+  using Scalar = StaticShape<>;
+  static_assert(Scalar::kRank == 0, "");
+  static_assert(Scalar::element_count() == 1, "");
+  static_assert(Scalar::Offset() == 0, "");
+
+  using Image = StaticShape<2, 3, 4>;
+  static_assert(Image::kRank == 3, "");
+  static_assert(Image::dim(1) == 3, "");
+  static_assert(Image::element_count() == 24, "");
+  static_assert(Image::stride(0) == 12, "");
+  static_assert(Image::stride(2) == 1, "");
+  static_assert(Image::Offset(1, 2, 3) == 23, "");
+
+  EXPECT_TRUE(Image::Matches(Shape({2, 3, 4})));
+  EXPECT_FALSE(Image::Matches(Shape({2, 3})));
+  EXPECT_FALSE(Image::Matches(Shape({2, 3, 5})));
+  EXPECT_EQ(Shape({2, 3, 4}), Image::ToShape());
+  EXPECT_EQ(Scalar::ToShape(), Shape());
+}
+
 TEST(ShapeTest, ResolveAxis) {
   int axis;
   ASSERT_OK_AND_ASSIGN(axis, Shape({0}).ResolveAxis(0));
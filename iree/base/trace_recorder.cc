@@ -0,0 +1,434 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/trace_recorder.h"
+
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "iree/base/logging.h"
+
+namespace iree {
+namespace tracing {
+
+namespace {
+
+// All events are attributed to a single process.
+constexpr int kProcessId = 1;
+
+// Per-thread recording state.
+struct ThreadState {
+  ~ThreadState() {
+    if (buffer) buffer->Retire();
+  }
+
+  // Ring owned by the recorder; lazily registered on the first event.
+  TraceRingBuffer* buffer = nullptr;
+  // Name to register the ring with.
+  std::string name;
+  // Flow current on this thread or 0.
+  uint64_t flow_id = 0;
+};
+
+thread_local ThreadState thread_state;
+
+int64_t SteadyNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Appends |value| as a quoted JSON string.
+void AppendJsonString(absl::string_view value, std::string* out) {
+  out->push_back('"');
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppend(out, "\\u", absl::Hex(c, absl::kZeroPad4));
+        } else {
+          out->push_back(c);
+        }
+        break;
+    }
+  }
+  out->push_back('"');
+}
+
+// Appends |nanos| as microseconds with nanosecond precision.
+void AppendMicros(int64_t nanos, std::string* out) {
+  if (nanos < 0) nanos = 0;
+  absl::StrAppend(out, nanos / 1000, ".", absl::Dec(nanos % 1000,
+                                                    absl::kZeroPad3));
+}
+
+}  // namespace
+
+TraceRingBuffer::TraceRingBuffer(int thread_id, std::string thread_name)
+    : thread_id_(thread_id), thread_name_(std::move(thread_name)) {
+  static_assert((kCapacity & (kCapacity - 1)) == 0,
+                "Capacity must be a power of two");
+  // Fault in the pages now instead of while recording.
+  std::memset(events_, 0, sizeof(events_));
+}
+
+constexpr size_t TraceRingBuffer::kCapacity;
+constexpr const char ChromeTraceWriter::kFileHeader[];
+constexpr const char ChromeTraceWriter::kFileFooter[];
+
+ChromeTraceWriter::ChromeTraceWriter(uint64_t base_ticks, double ns_per_tick)
+    : base_ticks_(base_ticks), ns_per_tick_(ns_per_tick) {}
+
+void ChromeTraceWriter::AppendSeparator(std::string* out) {
+  if (has_events_) out->append(",\n");
+  has_events_ = true;
+}
+
+void ChromeTraceWriter::AppendTimestamp(uint64_t ticks,
+                                        std::string* out) const {
+  int64_t delta_ticks = static_cast<int64_t>(ticks - base_ticks_);
+  AppendMicros(static_cast<int64_t>(delta_ticks * ns_per_tick_), out);
+}
+
+void ChromeTraceWriter::AppendThreadName(int thread_id,
+                                         absl::string_view thread_name,
+                                         std::string* out) {
+  AppendSeparator(out);
+  absl::StrAppend(out, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":",
+                  kProcessId, ",\"tid\":", thread_id, ",\"args\":{\"name\":");
+  AppendJsonString(thread_name, out);
+  out->append("}}");
+}
+
+void ChromeTraceWriter::AppendEvents(int thread_id,
+                                     absl::Span<const TraceEvent> events,
+                                     std::string* out) {
+  for (const auto& event : events) {
+    AppendSeparator(out);
+    // Name specs follow WTF conventions and may name their argument as in
+    // "Foo::Bar:size". The scope operator is not an argument separator.
+    absl::string_view name = event.name;
+    absl::string_view arg_name = "arg0";
+    size_t arg_pos = name.rfind(':');
+    if (arg_pos != absl::string_view::npos && arg_pos > 0 &&
+        name[arg_pos - 1] != ':') {
+      arg_name = name.substr(arg_pos + 1);
+      name = name.substr(0, arg_pos);
+    }
+
+    bool is_flow = false;
+    switch (event.type) {
+      case TraceEventType::kComplete:
+        out->append("{\"ph\":\"X\",\"cat\":\"iree\",\"name\":");
+        break;
+      case TraceEventType::kInstant:
+        out->append("{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"iree\",\"name\":");
+        break;
+      case TraceEventType::kFlowStart:
+      case TraceEventType::kFlowStep:
+        // Flows are joined on category and id so all steps share a name and
+        // carry the step name as an argument.
+        absl::StrAppend(
+            out, "{\"ph\":\"",
+            event.type == TraceEventType::kFlowStart ? "s" : "t",
+            "\",\"cat\":\"flow\",\"name\":\"flow\",\"bp\":\"e\",\"id\":",
+            event.arg, ",\"args\":{\"step\":");
+        is_flow = true;
+        break;
+    }
+    AppendJsonString(name, out);
+    if (is_flow) out->append("}");
+    absl::StrAppend(out, ",\"pid\":", kProcessId, ",\"tid\":", thread_id,
+                    ",\"ts\":");
+    AppendTimestamp(event.timestamp, out);
+    if (event.type == TraceEventType::kComplete) {
+      out->append(",\"dur\":");
+      AppendMicros(static_cast<int64_t>(event.duration * ns_per_tick_), out);
+    }
+    if (event.has_arg && !is_flow) {
+      out->append(",\"args\":{");
+      AppendJsonString(arg_name, out);
+      absl::StrAppend(out, ":", event.arg, "}");
+    }
+    out->append("}");
+  }
+}
+
+class TraceRecorder::Impl {
+ public:
+  // Returns the ring of the calling thread, registering it if needed.
+  TraceRingBuffer* RegisterCurrentThread() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    buffers_.push_back(absl::make_unique<TraceRingBuffer>(next_thread_id_++,
+                                                          thread_state.name));
+    thread_state.buffer = buffers_.back().get();
+    return thread_state.buffer;
+  }
+
+  void SetCurrentThreadName(absl::string_view name)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    thread_state.name = std::string(name);
+    if (thread_state.buffer) {
+      absl::MutexLock lock(&mutex_);
+      thread_state.buffer->set_thread_name(thread_state.name);
+    }
+  }
+
+  Status Start(std::string path, absl::Duration drain_period)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    if (file_) {
+      return FailedPreconditionErrorBuilder(IREE_LOC)
+             << "Trace recording already started to " << path_;
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+      return UnavailableErrorBuilder(IREE_LOC)
+             << "Unable to open trace file " << path << ": "
+             << std::strerror(errno);
+    }
+    path_ = std::move(path);
+    std::fputs(ChromeTraceWriter::kFileHeader, file_);
+
+    // Discard anything left in the rings from a previous recording.
+    for (auto& buffer : buffers_) {
+      buffer->Drain([](absl::Span<const TraceEvent>) {});
+    }
+    emitted_names_.clear();
+
+    // Measure an initial tick rate; it is refined on each drain.
+    base_ticks_ = ReadTimestamp();
+    base_nanos_ = SteadyNanos();
+    absl::SleepFor(absl::Milliseconds(1));
+    writer_ = absl::make_unique<ChromeTraceWriter>(base_ticks_, NsPerTick());
+
+    stop_requested_ = false;
+    drain_thread_ = std::thread([this, drain_period]() {
+      TraceRecorder::SetCurrentThreadName("trace_drain");
+      absl::MutexLock lock(&mutex_);
+      while (!stop_requested_) {
+        mutex_.AwaitWithTimeout(absl::Condition(&stop_requested_),
+                                drain_period);
+        DrainLocked();
+      }
+    });
+
+    enabled_flag_.store(true, std::memory_order_relaxed);
+    return OkStatus();
+  }
+
+  void Stop() ABSL_LOCKS_EXCLUDED(mutex_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!file_) return;
+      enabled_flag_.store(false, std::memory_order_relaxed);
+      stop_requested_ = true;
+    }
+    drain_thread_.join();
+
+    absl::MutexLock lock(&mutex_);
+    DrainLocked();
+    std::fputs(ChromeTraceWriter::kFileFooter, file_);
+    std::fclose(file_);
+    file_ = nullptr;
+    writer_.reset();
+    uint64_t dropped_count = DroppedCountLocked();
+    if (dropped_count > 0) {
+      LOG(WARNING) << "Dropped " << dropped_count
+                   << " trace events; increase the drain frequency";
+    }
+    LOG(INFO) << "Wrote trace to " << path_;
+  }
+
+  void Drain() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    DrainLocked();
+  }
+
+  uint64_t dropped_count() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    return DroppedCountLocked();
+  }
+
+ private:
+  double NsPerTick() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    uint64_t elapsed_ticks = ReadTimestamp() - base_ticks_;
+    int64_t elapsed_nanos = SteadyNanos() - base_nanos_;
+    if (elapsed_ticks == 0 || elapsed_nanos <= 0) return 1.0;
+    return static_cast<double>(elapsed_nanos) / elapsed_ticks;
+  }
+
+  uint64_t DroppedCountLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    uint64_t dropped_count = retired_dropped_count_;
+    for (const auto& buffer : buffers_) {
+      dropped_count += buffer->dropped_count();
+    }
+    return dropped_count;
+  }
+
+  void DrainLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (!file_) return;
+    writer_->set_ns_per_tick(NsPerTick());
+    scratch_.clear();
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+      auto* buffer = it->get();
+      // Checked before draining so that no events pushed prior to retiring
+      // are missed.
+      bool retired = buffer->is_retired();
+      auto& emitted_name = emitted_names_[buffer];
+      if (!buffer->thread_name().empty() &&
+          emitted_name != buffer->thread_name()) {
+        emitted_name = buffer->thread_name();
+        writer_->AppendThreadName(buffer->thread_id(), emitted_name,
+                                  &scratch_);
+      }
+      buffer->Drain([&](absl::Span<const TraceEvent> events) {
+        writer_->AppendEvents(buffer->thread_id(), events, &scratch_);
+      });
+      if (retired) {
+        retired_dropped_count_ += buffer->dropped_count();
+        emitted_names_.erase(buffer);
+        it = buffers_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (!scratch_.empty()) {
+      std::fwrite(scratch_.data(), 1, scratch_.size(), file_);
+      std::fflush(file_);
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<TraceRingBuffer>> buffers_
+      ABSL_GUARDED_BY(mutex_);
+  int next_thread_id_ ABSL_GUARDED_BY(mutex_) = 1;
+  uint64_t retired_dropped_count_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  std::string path_ ABSL_GUARDED_BY(mutex_);
+  std::FILE* file_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::unique_ptr<ChromeTraceWriter> writer_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<const TraceRingBuffer*, std::string> emitted_names_
+      ABSL_GUARDED_BY(mutex_);
+  std::string scratch_ ABSL_GUARDED_BY(mutex_);
+  uint64_t base_ticks_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t base_nanos_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  bool stop_requested_ ABSL_GUARDED_BY(mutex_) = false;
+  std::thread drain_thread_;
+};
+
+std::atomic<bool> TraceRecorder::enabled_flag_{false};
+
+// static
+TraceRecorder* TraceRecorder::Get() {
+  // Intentionally leaked so that threads may record during shutdown.
+  static TraceRecorder* recorder = new TraceRecorder();
+  return recorder;
+}
+
+TraceRecorder::TraceRecorder() : impl_(new Impl()) {}
+
+// static
+void TraceRecorder::Record(const TraceEvent& event) {
+  // Scopes entered before recording stopped may still complete afterward.
+  if (!enabled()) return;
+  auto* buffer = thread_state.buffer;
+  if (!buffer) buffer = Get()->impl_->RegisterCurrentThread();
+  buffer->TryPush(event);
+}
+
+// static
+void TraceRecorder::SetCurrentThreadName(absl::string_view name) {
+  Get()->impl_->SetCurrentThreadName(name);
+}
+
+// static
+uint64_t TraceRecorder::NextFlowId() {
+  static std::atomic<uint64_t> next_flow_id{0};
+  return next_flow_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+Status TraceRecorder::Start(std::string path, absl::Duration drain_period) {
+  return impl_->Start(std::move(path), drain_period);
+}
+
+void TraceRecorder::Stop() { impl_->Stop(); }
+
+void TraceRecorder::Drain() { impl_->Drain(); }
+
+uint64_t TraceRecorder::dropped_count() { return impl_->dropped_count(); }
+
+uint64_t CurrentFlowId() { return thread_state.flow_id; }
+
+namespace {
+
+void RecordFlowEvent(TraceEventType type, const char* name_spec,
+                     uint64_t flow_id) {
+  TraceEvent event;
+  event.timestamp = ReadTimestamp();
+  event.duration = 0;
+  event.name = name_spec;
+  event.arg = static_cast<int64_t>(flow_id);
+  event.type = type;
+  event.has_arg = 0;
+  TraceRecorder::Record(event);
+}
+
+}  // namespace
+
+ScopedFlow::ScopedFlow(const char* name_spec)
+    : previous_flow_id_(thread_state.flow_id) {
+  if (!TraceRecorder::enabled()) return;
+  thread_state.flow_id = TraceRecorder::NextFlowId();
+  RecordFlowEvent(TraceEventType::kFlowStart, name_spec, thread_state.flow_id);
+}
+
+ScopedFlow::ScopedFlow(const char* name_spec, uint64_t flow_id)
+    : previous_flow_id_(thread_state.flow_id) {
+  if (!TraceRecorder::enabled() || !flow_id) return;
+  thread_state.flow_id = flow_id;
+  RecordFlowEvent(TraceEventType::kFlowStep, name_spec, flow_id);
+}
+
+ScopedFlow::~ScopedFlow() { thread_state.flow_id = previous_flow_id_; }
+
+// static
+void ScopedFlow::Step(const char* name_spec) {
+  if (!TraceRecorder::enabled() || !thread_state.flow_id) return;
+  RecordFlowEvent(TraceEventType::kFlowStep, name_spec, thread_state.flow_id);
+}
+
+}  // namespace tracing
+}  // namespace iree
@@ -0,0 +1,364 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Low-overhead in-process trace recorder backing the IREE_TRACE_* macros when
+// built with IREE_NATIVE_TRACING_ENABLE (see tracing.h).
+//
+// Each thread records fixed-size events into its own lock-free ring buffer.
+// Recording an event is a timestamp read and a single store into the ring with
+// no locks, allocations, or string copies: event names are string literals
+// that are interned by address and only formatted when the rings are drained.
+// A background thread periodically drains all rings and appends the events to
+// a Chrome trace event format JSON file that can be loaded in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// If a ring fills up before it is drained new events are dropped and counted.
+
+#ifndef IREE_BASE_TRACE_RECORDER_H_
+#define IREE_BASE_TRACE_RECORDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "iree/base/target_platform.h"
+
+#if defined(IREE_ARCH_X86_64)
+#if defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif  // IREE_COMPILER_MSVC
+#else
+#include <chrono>  // NOLINT
+#endif  // IREE_ARCH_X86_64
+
+namespace iree {
+namespace tracing {
+
+// Returns a monotonically increasing timestamp in implementation-defined
+// ticks. TraceRecorder converts ticks to wall time when draining.
+inline uint64_t ReadTimestamp() {
+#if defined(IREE_ARCH_X86_64)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif  // IREE_ARCH_X86_64
+}
+
+enum class TraceEventType : uint32_t {
+  // A scope with a start timestamp and duration.
+  kComplete = 0,
+  // A point in time.
+  kInstant = 1,
+  // Starts the flow |arg| bound to the enclosing scope.
+  kFlowStart = 2,
+  // Continues the flow |arg| bound to the enclosing scope.
+  kFlowStep = 3,
+};
+
+// A single fixed-size trace event as stored in the ring buffers.
+struct TraceEvent {
+  // Start time in ticks (see ReadTimestamp).
+  uint64_t timestamp;
+  // Duration in ticks for kComplete events.
+  uint64_t duration;
+  // Name (or WTF-style "name:arg_name" spec) with static storage duration.
+  const char* name;
+  // Optional argument value or the flow id for flow events.
+  int64_t arg;
+  TraceEventType type;
+  // True if |arg| is a user argument that should be emitted.
+  uint32_t has_arg;
+};
+static_assert(std::is_trivially_copyable<TraceEvent>::value,
+              "Trace events are copied in and out of the rings");
+
+// Single-producer single-consumer ring of TraceEvents.
+// The producer is the owning thread and the consumer the drain thread.
+class TraceRingBuffer {
+ public:
+  // Capacity in events; must be a power of two.
+  static constexpr size_t kCapacity = 16 * 1024;
+
+  TraceRingBuffer(int thread_id, std::string thread_name);
+
+  TraceRingBuffer(const TraceRingBuffer&) = delete;
+  TraceRingBuffer& operator=(const TraceRingBuffer&) = delete;
+
+  int thread_id() const { return thread_id_; }
+
+  // Appends |event| or drops it if the ring is full. Producer only.
+  inline bool TryPush(const TraceEvent& event) {
+    uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+    if (write_index - cached_read_index_ >= kCapacity) {
+      // Only touch the consumer's cache line when the ring appears full.
+      cached_read_index_ = read_index_.load(std::memory_order_acquire);
+      if (write_index - cached_read_index_ >= kCapacity) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    events_[write_index & (kCapacity - 1)] = event;
+    write_index_.store(write_index + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Calls |fn| with each contiguous range of pending events and then releases
+  // them back to the producer. Consumer only.
+  template <typename Fn>
+  size_t Drain(Fn fn) {
+    uint64_t read_index = read_index_.load(std::memory_order_relaxed);
+    uint64_t write_index = write_index_.load(std::memory_order_acquire);
+    size_t count = write_index - read_index;
+    size_t start = read_index & (kCapacity - 1);
+    size_t first_count = std::min(count, kCapacity - start);
+    if (first_count > 0) {
+      fn(absl::MakeConstSpan(&events_[start], first_count));
+    }
+    if (count > first_count) {
+      fn(absl::MakeConstSpan(&events_[0], count - first_count));
+    }
+    read_index_.store(write_index, std::memory_order_release);
+    return count;
+  }
+
+  // Total number of events dropped because the ring was full.
+  uint64_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  // Thread name; guarded by the owning TraceRecorder.
+  const std::string& thread_name() const { return thread_name_; }
+  void set_thread_name(std::string thread_name) {
+    thread_name_ = std::move(thread_name);
+  }
+
+  // Set once the owning thread has exited and will record no more events.
+  bool is_retired() const { return retired_.load(std::memory_order_acquire); }
+  void Retire() { retired_.store(true, std::memory_order_release); }
+
+ private:
+  // Assumed cache line size used to keep the indices from false sharing.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const int thread_id_;
+  std::string thread_name_;
+  std::atomic<bool> retired_{false};
+  // Rings are heap allocated and C++14 operator new does not honor alignas, so
+  // the producer and consumer indices are kept on separate cache lines by
+  // explicit padding rather than by alignment.
+  char producer_padding_[kCacheLineSize];
+  std::atomic<uint64_t> write_index_{0};
+  // Producer's last observed read index.
+  uint64_t cached_read_index_ = 0;
+  char consumer_padding_[kCacheLineSize];
+  std::atomic<uint64_t> read_index_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+  TraceEvent events_[kCapacity];
+};
+
+// Formats TraceEvents as Chrome trace event format JSON objects.
+// See the Trace Event Format document linked from chrome://tracing.
+class ChromeTraceWriter {
+ public:
+  // Timestamps are emitted relative to |base_ticks| and converted to wall time
+  // at |ns_per_tick|.
+  ChromeTraceWriter(uint64_t base_ticks, double ns_per_tick);
+
+  // Appends the metadata event naming |thread_id| to |out|.
+  void AppendThreadName(int thread_id, absl::string_view thread_name,
+                        std::string* out);
+
+  // Updates the tick rate used for subsequently appended events.
+  void set_ns_per_tick(double ns_per_tick) { ns_per_tick_ = ns_per_tick; }
+
+  // Appends |events| recorded on |thread_id| to |out|. Each event is preceded
+  // by a separating comma unless it is the first written by this writer.
+  void AppendEvents(int thread_id, absl::Span<const TraceEvent> events,
+                    std::string* out);
+
+  // Prefix and suffix of a complete trace file.
+  static constexpr const char kFileHeader[] =
+      "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  static constexpr const char kFileFooter[] = "\n]}\n";
+
+ private:
+  // Appends the separator required before the next event object.
+  void AppendSeparator(std::string* out);
+  // Appends the "ts" value for |ticks| in microseconds.
+  void AppendTimestamp(uint64_t ticks, std::string* out) const;
+
+  uint64_t base_ticks_;
+  double ns_per_tick_;
+  bool has_events_ = false;
+};
+
+// Process-wide trace recorder.
+// Recording is enabled between Start and Stop. When not enabled the recording
+// functions return immediately after a single relaxed atomic load.
+class TraceRecorder {
+ public:
+  // Returns the process-wide recorder.
+  static TraceRecorder* Get();
+
+  // True if events are currently being recorded.
+  static inline bool enabled() {
+    return enabled_flag_.load(std::memory_order_relaxed);
+  }
+
+  // Records |event| into the calling thread's ring.
+  static void Record(const TraceEvent& event);
+
+  // Names the calling thread in the trace. |name| is copied.
+  static void SetCurrentThreadName(absl::string_view name);
+
+  // Returns a new process-unique nonzero flow id.
+  static uint64_t NextFlowId();
+
+  // Starts recording and writing the trace file at |path|, draining all rings
+  // every |drain_period|. Fails if already started.
+  Status Start(std::string path, absl::Duration drain_period);
+
+  // Stops recording, drains all remaining events, and closes the trace file.
+  // No-op if not started.
+  void Stop();
+
+  // Drains all rings into the trace file now.
+  void Drain();
+
+  // Total number of events dropped across all threads because their rings
+  // were full.
+  uint64_t dropped_count();
+
+ private:
+  class Impl;
+
+  TraceRecorder();
+  ~TraceRecorder() = delete;
+
+  static std::atomic<bool> enabled_flag_;
+
+  Impl* impl_;
+};
+
+// Returns the flow id that is current on the calling thread or 0 if none.
+uint64_t CurrentFlowId();
+
+// Records a complete event for the lifetime of the scope once entered.
+// Used by IREE_TRACE_SCOPE0 and IREE_TRACE_SCOPE.
+class ScopedEvent {
+ public:
+  explicit ScopedEvent(const char* name_spec) : name_spec_(name_spec) {}
+  ~ScopedEvent() {
+    if (start_ticks_) {
+      TraceEvent event;
+      event.timestamp = start_ticks_;
+      event.duration = ReadTimestamp() - start_ticks_;
+      event.name = name_spec_;
+      event.arg = arg_;
+      event.type = TraceEventType::kComplete;
+      event.has_arg = has_arg_;
+      TraceRecorder::Record(event);
+    }
+  }
+
+  ScopedEvent(const ScopedEvent&) = delete;
+  ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+  // Begins the scope, optionally with a single integral argument.
+  void Enter() {
+    if (TraceRecorder::enabled()) start_ticks_ = ReadTimestamp();
+  }
+  template <typename T>
+  void Enter(T arg) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "Only integral trace arguments are supported");
+    arg_ = static_cast<int64_t>(arg);
+    has_arg_ = 1;
+    Enter();
+  }
+
+ private:
+  const char* name_spec_;
+  uint64_t start_ticks_ = 0;
+  int64_t arg_ = 0;
+  uint32_t has_arg_ = 0;
+};
+
+// Records an instant event, optionally with a single integral argument.
+// Used by IREE_TRACE_EVENT0 and IREE_TRACE_EVENT.
+class InstantEvent {
+ public:
+  explicit InstantEvent(const char* name_spec) : name_spec_(name_spec) {}
+
+  void operator()() const { Record(0, 0); }
+  template <typename T>
+  void operator()(T arg) const {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "Only integral trace arguments are supported");
+    Record(static_cast<int64_t>(arg), 1);
+  }
+
+ private:
+  void Record(int64_t arg, uint32_t has_arg) const {
+    if (!TraceRecorder::enabled()) return;
+    TraceEvent event;
+    event.timestamp = ReadTimestamp();
+    event.duration = 0;
+    event.name = name_spec_;
+    event.arg = arg;
+    event.type = TraceEventType::kInstant;
+    event.has_arg = has_arg;
+    TraceRecorder::Record(event);
+  }
+
+  const char* name_spec_;
+};
+
+// Makes a flow current on the calling thread for the lifetime of the scope.
+// Flows link causally related scopes across threads, such as a VM invocation
+// and the HAL submissions and dispatches it produces. Each flow event binds
+// to the enclosing scope on the recording thread.
+// Used by the IREE_TRACE_FLOW_* macros.
+class ScopedFlow {
+ public:
+  // Starts a new flow.
+  explicit ScopedFlow(const char* name_spec);
+  // Continues |flow_id| (if nonzero) that was started on another thread.
+  ScopedFlow(const char* name_spec, uint64_t flow_id);
+  ~ScopedFlow();
+
+  ScopedFlow(const ScopedFlow&) = delete;
+  ScopedFlow& operator=(const ScopedFlow&) = delete;
+
+  // Records a step on the current flow of the calling thread, if any.
+  static void Step(const char* name_spec);
+
+ private:
+  uint64_t previous_flow_id_;
+};
+
+}  // namespace tracing
+}  // namespace iree
+
+#endif  // IREE_BASE_TRACE_RECORDER_H_
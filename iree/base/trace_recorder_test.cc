@@ -0,0 +1,183 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/trace_recorder.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "iree/base/file_path.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace tracing {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TraceEvent MakeEvent(TraceEventType type, const char* name, uint64_t timestamp,
+                     int64_t arg = 0, bool has_arg = false) {
+  TraceEvent event;
+  event.timestamp = timestamp;
+  event.duration = 0;
+  event.name = name;
+  event.arg = arg;
+  event.type = type;
+  event.has_arg = has_arg ? 1 : 0;
+  return event;
+}
+
+TEST(TraceRingBufferTest, DropsWhenFull) {
+  auto ring = absl::make_unique<TraceRingBuffer>(1, "thread");
+  for (int i = 0; i < TraceRingBuffer::kCapacity; ++i) {
+    ASSERT_TRUE(
+        ring->TryPush(MakeEvent(TraceEventType::kInstant, "a", 0, i)));
+  }
+  EXPECT_FALSE(ring->TryPush(MakeEvent(TraceEventType::kInstant, "a", 0)));
+  EXPECT_EQ(1, ring->dropped_count());
+
+  size_t drained_count = 0;
+  EXPECT_EQ(TraceRingBuffer::kCapacity,
+            ring->Drain([&](absl::Span<const TraceEvent> events) {
+              drained_count += events.size();
+            }));
+  EXPECT_EQ(TraceRingBuffer::kCapacity, drained_count);
+  EXPECT_TRUE(ring->TryPush(MakeEvent(TraceEventType::kInstant, "a", 0)));
+}
+
+TEST(TraceRingBufferTest, DrainsInOrderAcrossWrap) {
+  auto ring = absl::make_unique<TraceRingBuffer>(1, "thread");
+  for (int i = 0; i < 10; ++i) {
+    ring->TryPush(MakeEvent(TraceEventType::kInstant, "a", 0));
+  }
+  ring->Drain([](absl::Span<const TraceEvent>) {});
+
+  for (int i = 0; i < TraceRingBuffer::kCapacity; ++i) {
+    ASSERT_TRUE(
+        ring->TryPush(MakeEvent(TraceEventType::kInstant, "a", 0, i)));
+  }
+  std::vector<size_t> span_sizes;
+  int64_t expected_arg = 0;
+  ring->Drain([&](absl::Span<const TraceEvent> events) {
+    span_sizes.push_back(events.size());
+    for (const auto& event : events) {
+      EXPECT_EQ(expected_arg++, event.arg);
+    }
+  });
+  EXPECT_THAT(span_sizes,
+              ::testing::ElementsAre(TraceRingBuffer::kCapacity - 10, 10));
+  EXPECT_EQ(0, ring->dropped_count());
+}
+
+TEST(ChromeTraceWriterTest, FormatsEvents) {
+  ChromeTraceWriter writer(/*base_ticks=*/1000, /*ns_per_tick=*/1.0);
+  std::string out;
+  writer.AppendThreadName(7, "my \"thread\"", &out);
+  auto complete = MakeEvent(TraceEventType::kComplete, "Foo::Bar:size", 3500,
+                            42, /*has_arg=*/true);
+  complete.duration = 1250;
+  TraceEvent events[] = {
+      complete,
+      MakeEvent(TraceEventType::kInstant, "Foo::Baz", 4000),
+      MakeEvent(TraceEventType::kFlowStart, "Foo::Flow", 5000, 3),
+  };
+  writer.AppendEvents(7, events, &out);
+  EXPECT_EQ(
+      "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":7,"
+      "\"args\":{\"name\":\"my \\\"thread\\\"\"}},\n"
+      "{\"ph\":\"X\",\"cat\":\"iree\",\"name\":\"Foo::Bar\",\"pid\":1,"
+      "\"tid\":7,\"ts\":2.500,\"dur\":1.250,\"args\":{\"size\":42}},\n"
+      "{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"iree\",\"name\":\"Foo::Baz\","
+      "\"pid\":1,\"tid\":7,\"ts\":3.000},\n"
+      "{\"ph\":\"s\",\"cat\":\"flow\",\"name\":\"flow\",\"bp\":\"e\","
+      "\"id\":3,\"args\":{\"step\":\"Foo::Flow\"},\"pid\":1,\"tid\":7,"
+      "\"ts\":4.000}",
+      out);
+}
+
+TEST(TraceRecorderTest, RecordsScopesAndFlowsAcrossThreads) {
+  // Events outside of a recording are ignored.
+  { ScopedEvent("Ignored").Enter(); }
+
+  std::string trace_path =
+      file_path::JoinPaths(::testing::TempDir(), "trace_recorder_test.json");
+  auto* recorder = TraceRecorder::Get();
+  ASSERT_OK(recorder->Start(trace_path, absl::Milliseconds(1)));
+  EXPECT_TRUE(TraceRecorder::enabled());
+  EXPECT_TRUE(IsFailedPrecondition(
+      recorder->Start(trace_path, absl::Milliseconds(1))));
+
+  uint64_t flow_id = 0;
+  {
+    ScopedEvent scope("Outer:count");
+    scope.Enter(5);
+    ScopedFlow flow("Outer");
+    flow_id = CurrentFlowId();
+    EXPECT_NE(0, flow_id);
+    InstantEvent("Mark")();
+  }
+  EXPECT_EQ(0, CurrentFlowId());
+
+  std::thread worker([flow_id]() {
+    TraceRecorder::SetCurrentThreadName("worker");
+    ScopedEvent scope("Inner");
+    scope.Enter();
+    ScopedFlow flow("Inner", flow_id);
+    ScopedFlow::Step("InnerStep");
+  });
+  worker.join();
+  recorder->Stop();
+  EXPECT_FALSE(TraceRecorder::enabled());
+  EXPECT_EQ(0, recorder->dropped_count());
+
+  std::ifstream trace_file(trace_path, std::ios::binary);
+  ASSERT_TRUE(trace_file.good());
+  std::stringstream trace_stream;
+  trace_stream << trace_file.rdbuf();
+  std::string contents = trace_stream.str();
+  EXPECT_TRUE(absl::StartsWith(contents, ChromeTraceWriter::kFileHeader));
+  EXPECT_TRUE(absl::EndsWith(contents, ChromeTraceWriter::kFileFooter));
+  EXPECT_THAT(contents, Not(HasSubstr("Ignored")));
+  EXPECT_THAT(contents, HasSubstr("\"name\":\"Outer\""));
+  EXPECT_THAT(contents, HasSubstr("\"args\":{\"count\":5}"));
+  EXPECT_THAT(contents, HasSubstr("\"name\":\"Mark\""));
+  EXPECT_THAT(contents, HasSubstr("\"name\":\"Inner\""));
+  EXPECT_THAT(contents, HasSubstr("\"args\":{\"name\":\"worker\"}"));
+  std::string flow_key = absl::StrCat("\"id\":", flow_id, ",");
+  const char kFlowStart[] =
+      "{\"ph\":\"s\",\"cat\":\"flow\",\"name\":\"flow\",\"bp\":\"e\",";
+  const char kFlowStep[] =
+      "{\"ph\":\"t\",\"cat\":\"flow\",\"name\":\"flow\",\"bp\":\"e\",";
+  EXPECT_THAT(contents, HasSubstr(absl::StrCat(kFlowStart, flow_key)));
+  EXPECT_THAT(contents,
+              HasSubstr(absl::StrCat(kFlowStep, flow_key,
+                                     "\"args\":{\"step\":\"Inner\"")));
+  EXPECT_THAT(contents,
+              HasSubstr(absl::StrCat(kFlowStep, flow_key,
+                                     "\"args\":{\"step\":\"InnerStep\"")));
+}
+
+}  // namespace
+}  // namespace tracing
+}  // namespace iree
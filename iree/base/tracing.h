@@ -24,10 +24,22 @@
 //
 // If GLOBAL_WTF_ENABLE=1 is specified WTF will automatically be initialized on
 // startup and flushed on exit.
+//
+// Tracing with the native trace recorder (see trace_recorder.h):
+// - build with --define=IREE_TRACING=native
+//   (or -DIREE_ENABLE_NATIVE_TRACING=ON with CMake)
+// - pass --iree_trace_file=/tmp/foo.json when running
+// - view trace in chrome://tracing or https://ui.perfetto.dev
+//
+// Flows link scopes across threads, such as a VM invocation with the HAL
+// submissions and dispatches it produces. They are only recorded by the native
+// trace recorder and compile away otherwise.
 
 #ifndef IREE_BASE_TRACING_H_
 #define IREE_BASE_TRACING_H_
 
+#include <cstdint>
+
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -78,6 +90,80 @@ void FlushTrace(absl::optional<absl::string_view> explicit_trace_path =
 // See WTF_EVENT for more information.
 #define IREE_TRACE_EVENT WTF_EVENT
 
+#define IREE_TRACE_FLOW_BEGIN(name_spec)
+#define IREE_TRACE_FLOW_CONTINUE(name_spec, flow_id)
+#define IREE_TRACE_FLOW_STEP(name_spec)
+#define IREE_TRACE_FLOW_ID() uint64_t{0}
+
+}  // namespace iree
+
+#elif defined(IREE_NATIVE_TRACING_ENABLE)
+
+#include "iree/base/trace_recorder.h"  // IWYU pragma: export
+
+namespace iree {
+
+// Initializes tracing if it is built into the binary.
+// Starts recording if --iree_trace_file is set.
+void InitializeTracing();
+
+// Returns whether tracing support is compiled into the binary.
+bool IsTracingAvailable();
+
+// Starts recording to --iree_trace_file (if not already started), draining
+// to the file at the given period.
+void StartTracingAutoFlush(absl::Duration period);
+
+// Stops tracing and flushes any pending data.
+void StopTracing();
+
+// Flushes pending trace data to disk, if enabled. An explicit path different
+// from the current one completes the current file and starts a new one.
+void FlushTrace(absl::optional<absl::string_view> explicit_trace_path =
+                    absl::optional<absl::string_view>());
+
+// Names the current thread in the trace.
+#define IREE_TRACE_THREAD_ENABLE(name) \
+  ::iree::tracing::TraceRecorder::SetCurrentThreadName(name);
+
+// Tracing scope recorded from construction until the end of the enclosing
+// block. |name_spec| must be a string literal.
+#define IREE_TRACE_SCOPE0(name_spec)                         \
+  ::iree::tracing::ScopedEvent __iree_trace_scope0(name_spec); \
+  __iree_trace_scope0.Enter();
+
+// Tracing scope with a single integral argument, used as
+// IREE_TRACE_SCOPE("Foo::Bar:size", int)(size). The argument type is ignored.
+#define IREE_TRACE_SCOPE(name_spec, ...)                    \
+  ::iree::tracing::ScopedEvent __iree_trace_scope(name_spec); \
+  __iree_trace_scope.Enter
+
+// Instant tracing event, used as IREE_TRACE_EVENT0("Foo::Bar").
+#define IREE_TRACE_EVENT0(name_spec) \
+  ::iree::tracing::InstantEvent(name_spec)()
+
+// Instant tracing event with a single integral argument, used as
+// IREE_TRACE_EVENT("Foo::Bar:size", int)(size).
+#define IREE_TRACE_EVENT(name_spec, ...) \
+  ::iree::tracing::InstantEvent(name_spec)
+
+// Starts a new flow that is current on this thread until the end of the
+// enclosing block.
+#define IREE_TRACE_FLOW_BEGIN(name_spec) \
+  ::iree::tracing::ScopedFlow __iree_trace_flow(name_spec);
+
+// Continues |flow_id| (as returned by IREE_TRACE_FLOW_ID on another thread)
+// and makes it current on this thread until the end of the enclosing block.
+#define IREE_TRACE_FLOW_CONTINUE(name_spec, flow_id) \
+  ::iree::tracing::ScopedFlow __iree_trace_flow(name_spec, flow_id);
+
+// Records a step on the flow current on this thread, if any.
+#define IREE_TRACE_FLOW_STEP(name_spec) \
+  ::iree::tracing::ScopedFlow::Step(name_spec);
+
+// Returns the id of the flow current on this thread or 0.
+#define IREE_TRACE_FLOW_ID() ::iree::tracing::CurrentFlowId()
+
 }  // namespace iree
 
 #else
@@ -96,9 +182,13 @@ inline void FlushTrace(absl::optional<absl::string_view> explicit_trace_path =
 #define IREE_TRACE_SCOPE(name_spec, ...) (void)
 #define IREE_TRACE_EVENT0
 #define IREE_TRACE_EVENT (void)
+#define IREE_TRACE_FLOW_BEGIN(name_spec)
+#define IREE_TRACE_FLOW_CONTINUE(name_spec, flow_id)
+#define IREE_TRACE_FLOW_STEP(name_spec)
+#define IREE_TRACE_FLOW_ID() uint64_t{0}
 
 }  // namespace iree
 
-#endif  // GLOBAL_WTF_ENABLE
+#endif  // WTF_ENABLE
 
 #endif  // IREE_BASE_TRACING_H_
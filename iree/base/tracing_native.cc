@@ -0,0 +1,131 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This file is linked in only when the native trace recorder is enabled.
+// It drives TraceRecorder with the same flags and functions as WTF.
+
+// Force the header to detect IREE_NATIVE_TRACING_ENABLE so that this library
+// builds (for when building recursively).
+#if !defined(IREE_NATIVE_TRACING_ENABLE)
+#define IREE_NATIVE_TRACING_ENABLE
+#endif
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/initializer.h"
+#include "iree/base/logging.h"
+#include "iree/base/trace_recorder.h"
+#include "iree/base/tracing.h"
+
+ABSL_FLAG(int32_t, iree_trace_file_period, 0,
+          "Unused by the native trace recorder; see "
+          "--iree_trace_drain_period_ms.");
+ABSL_FLAG(std::string, iree_trace_file, "",
+          "Chrome trace JSON file to save when built with "
+          "--define=IREE_TRACING=native.");
+ABSL_FLAG(int32_t, iree_trace_drain_period_ms, 100,
+          "Milliseconds between draining per-thread trace buffers to the "
+          "trace file. Buffers hold 16K events per thread and events beyond "
+          "that between drains are dropped.");
+
+namespace iree {
+namespace {
+
+// Guards the recorder lifecycle.
+ABSL_CONST_INIT absl::Mutex global_tracing_mutex(absl::kConstInit);
+
+// Path of the trace file currently being recorded or empty if stopped.
+std::string* global_trace_path ABSL_GUARDED_BY(global_tracing_mutex) =
+    nullptr;
+
+void StartRecording(const std::string& path, absl::Duration drain_period)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(global_tracing_mutex) {
+  auto status = tracing::TraceRecorder::Get()->Start(path, drain_period);
+  if (!status.ok()) {
+    LOG(ERROR) << "Unable to start tracing: " << status;
+    return;
+  }
+  global_trace_path = new std::string(path);
+  LOG(INFO) << "Tracing enabled and streaming to: " << path;
+}
+
+void StopRecording() ABSL_EXCLUSIVE_LOCKS_REQUIRED(global_tracing_mutex) {
+  if (!global_trace_path) return;
+  tracing::TraceRecorder::Get()->Stop();
+  delete global_trace_path;
+  global_trace_path = nullptr;
+}
+
+absl::Duration DrainPeriod() {
+  return absl::Milliseconds(absl::GetFlag(FLAGS_iree_trace_drain_period_ms));
+}
+
+}  // namespace
+
+void InitializeTracing() {
+  const auto& trace_path = absl::GetFlag(FLAGS_iree_trace_file);
+  if (trace_path.empty()) return;
+
+  absl::MutexLock lock(&global_tracing_mutex);
+  if (global_trace_path) return;
+
+  // Enable tracing on this thread, which we know is main.
+  IREE_TRACE_THREAD_ENABLE("main");
+
+  StartRecording(trace_path, DrainPeriod());
+
+  // Register atexit callback to stop tracking.
+  atexit(StopTracing);
+}
+
+bool IsTracingAvailable() { return true; }
+
+void StartTracingAutoFlush(absl::Duration period) {
+  // The recorder always drains in the background; this only starts recording
+  // if it was not already started by InitializeTracing.
+  const auto& trace_path = absl::GetFlag(FLAGS_iree_trace_file);
+  if (trace_path.empty()) return;
+  absl::MutexLock lock(&global_tracing_mutex);
+  if (global_trace_path) return;
+  StartRecording(trace_path, period);
+}
+
+void StopTracing() {
+  absl::MutexLock lock(&global_tracing_mutex);
+  StopRecording();
+}
+
+void FlushTrace(absl::optional<absl::string_view> explicit_trace_path) {
+  absl::MutexLock lock(&global_tracing_mutex);
+  if (explicit_trace_path && (!global_trace_path ||
+                              *global_trace_path != *explicit_trace_path)) {
+    // Switch files: complete the current one and start a new one.
+    StopRecording();
+    StartRecording(std::string(*explicit_trace_path), DrainPeriod());
+    return;
+  }
+  if (global_trace_path) tracing::TraceRecorder::Get()->Drain();
+}
+
+}  // namespace iree
+
+IREE_DECLARE_MODULE_INITIALIZER(iree_tracing);
+
+IREE_REGISTER_MODULE_INITIALIZER(iree_tracing, ::iree::InitializeTracing());
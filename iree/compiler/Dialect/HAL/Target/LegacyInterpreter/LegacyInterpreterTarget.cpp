@@ -103,6 +103,9 @@ static void buildInterpreterConversionPassPipeline(OpPassManager *passManager) {
   // This also looks for other weird types (i1, etc).
   passManager->addPass(createLegalizeTypeStoragePass());
 
+  // bf16 is storage-only in the interpreter; compute on it in f32.
+  passManager->addNestedPass<FuncOp>(createLegalizeBFloat16ComputePass());
+
   // Perform any last-minute optimizations to trim down the IR.
   passManager->addPass(createAggressiveOpEliminationPass());
   passManager->addNestedPass<FuncOp>(createCanonicalizerPass());
@@ -21,10 +21,11 @@ flow.executable @simpleMath_ex_dispatch_0 {
 // INTERP-SAME:     format = 1230128453 : i32} {
 // INTERP-NEXT:     module {
 // INTERP-NEXT:       func @simpleMath_rgn_dispatch_0(%arg0: memref<4xf32>, %arg1: memref<4xf32>) attributes {
+// INTERP-SAME:           iree.bytecode.stack_size = 16 : i32,
 // INTERP-SAME:           iree.executable.export,
 // INTERP-SAME:           iree.executable.workload = dense<[4, 1, 1]> : vector<3xi32>,
 // INTERP-SAME:           iree.ordinal = 0 : i32} {
-// INTERP-NEXT:         %0 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+// INTERP-NEXT:         %0 = "iree_ll_interp.alloc_stack"() {offset = 0 : i32, uninitialized} : () -> memref<4xf32>
 // INTERP-NEXT:         "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
 // INTERP-NEXT:         %1 = "iree_ll_interp.constant"() {value = dense<0> : tensor<1xi64>} : () -> memref<1xi64>
 // INTERP-NEXT:         %2 = "iree_ll_interp.constant"() {value = dense<4> : tensor<1xi64>} : () -> memref<1xi64>
@@ -292,8 +292,17 @@ static Offset<iree::vm::BytecodeModuleDef> buildFlatBufferModule(
   std::vector<Offset<Vector<uint8_t>>> rodataContentOffsets;
   rodataContentOffsets.reserve(rodataOps.size());
   for (auto rodataOp : rodataOps) {
+    size_t alignment = kRodataMinAlignment;
+    if (targetOptions.pageAlignRodata) {
+      auto valueType = rodataOp.value().getType();
+      int64_t byteLength = valueType.getNumElements() *
+                           valueType.getElementTypeBitWidth() / 8;
+      if (byteLength >= static_cast<int64_t>(kRodataPageAlignment)) {
+        alignment = kRodataPageAlignment;
+      }
+    }
     auto dataOffset =
-        serializeConstant(rodataOp.getLoc(), rodataOp.value(), fbb);
+        serializeConstant(rodataOp.getLoc(), rodataOp.value(), alignment, fbb);
     if (dataOffset.IsNull()) {
       rodataOp.emitOpError() << "failed to encode";
       return {};
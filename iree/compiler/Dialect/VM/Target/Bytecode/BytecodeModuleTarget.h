@@ -51,8 +51,21 @@ struct BytecodeTargetOptions {
   bool stripSourceMap = false;
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
+
+  // Aligns read-only data segments of at least kRodataPageAlignment bytes to
+  // page boundaries in the file. When the module is memory mapped those
+  // segments can then be wrapped in place as buffers, paged in on demand, and
+  // shared across processes without touching neighboring module data.
+  bool pageAlignRodata = true;
 };
 
+// Alignment of large read-only data segments when pageAlignRodata is set.
+constexpr size_t kRodataPageAlignment = 4096;
+
+// Minimum alignment of all read-only data segments so that they can be used
+// directly by SIMD kernels.
+constexpr size_t kRodataMinAlignment = 16;
+
 // Translates a vm.module to a bytecode module flatbuffer.
 // See iree/schemas/bytecode_module_def.fbs for the description of the
 // serialized module format.
@@ -34,11 +34,21 @@ using flatbuffers::Vector;
 
 // TODO(benvanik): switch to LLVM's BinaryStreamWriter to handle endianness.
 
+// Creates an uninitialized byte vector whose contents start at a multiple of
+// |alignment| bytes from the start of the finished FlatBuffer.
+static Offset<Vector<uint8_t>> createAlignedByteVector(size_t byteLength,
+                                                       size_t alignment,
+                                                       FlatBufferBuilder &fbb,
+                                                       uint8_t **bytePtr) {
+  fbb.ForceVectorAlignment(byteLength, sizeof(uint8_t), alignment);
+  return fbb.CreateUninitializedVector(byteLength, bytePtr);
+}
+
 static Offset<Vector<uint8_t>> serializeConstantI8Array(
-    DenseIntElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseIntElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 1, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 1,
+                                            alignment, fbb, &bytePtr);
   for (APInt value : attr.getIntValues()) {
     *(bytePtr++) = value.extractBitsAsZExtValue(8, 0) & UINT8_MAX;
   }
@@ -46,10 +56,10 @@ static Offset<Vector<uint8_t>> serializeConstantI8Array(
 }
 
 static Offset<Vector<uint8_t>> serializeConstantI16Array(
-    DenseIntElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseIntElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 2, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 2,
+                                            alignment, fbb, &bytePtr);
   uint16_t *nativePtr = reinterpret_cast<uint16_t *>(bytePtr);
   for (APInt value : attr.getIntValues()) {
     *(nativePtr++) = value.extractBitsAsZExtValue(16, 0) & UINT16_MAX;
@@ -58,10 +68,10 @@ static Offset<Vector<uint8_t>> serializeConstantI16Array(
 }
 
 static Offset<Vector<uint8_t>> serializeConstantI32Array(
-    DenseIntElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseIntElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 4, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 4,
+                                            alignment, fbb, &bytePtr);
   uint32_t *nativePtr = reinterpret_cast<uint32_t *>(bytePtr);
   for (APInt value : attr.getIntValues()) {
     *(nativePtr++) = value.extractBitsAsZExtValue(32, 0) & UINT32_MAX;
@@ -70,10 +80,10 @@ static Offset<Vector<uint8_t>> serializeConstantI32Array(
 }
 
 static Offset<Vector<uint8_t>> serializeConstantI64Array(
-    DenseIntElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseIntElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 8, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 8,
+                                            alignment, fbb, &bytePtr);
   uint64_t *nativePtr = reinterpret_cast<uint64_t *>(bytePtr);
   for (APInt value : attr.getIntValues()) {
     *(nativePtr++) = value.extractBitsAsZExtValue(64, 0) & UINT64_MAX;
@@ -82,10 +92,10 @@ static Offset<Vector<uint8_t>> serializeConstantI64Array(
 }
 
 static Offset<Vector<uint8_t>> serializeConstantF32Array(
-    DenseFPElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseFPElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 4, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 4,
+                                            alignment, fbb, &bytePtr);
   float *nativePtr = reinterpret_cast<float *>(bytePtr);
   for (APFloat value : attr.getFloatValues()) {
     *(nativePtr++) = value.convertToFloat();
@@ -94,10 +104,10 @@ static Offset<Vector<uint8_t>> serializeConstantF32Array(
 }
 
 static Offset<Vector<uint8_t>> serializeConstantF64Array(
-    DenseFPElementsAttr attr, FlatBufferBuilder &fbb) {
+    DenseFPElementsAttr attr, size_t alignment, FlatBufferBuilder &fbb) {
   uint8_t *bytePtr = nullptr;
-  auto byteVector =
-      fbb.CreateUninitializedVector(attr.getNumElements() * 8, &bytePtr);
+  auto byteVector = createAlignedByteVector(attr.getNumElements() * 8,
+                                            alignment, fbb, &bytePtr);
   double *nativePtr = reinterpret_cast<double *>(bytePtr);
   for (APFloat value : attr.getFloatValues()) {
     *(nativePtr++) = value.convertToDouble();
@@ -107,17 +117,18 @@ static Offset<Vector<uint8_t>> serializeConstantF64Array(
 
 Offset<Vector<uint8_t>> serializeConstant(Location loc,
                                           ElementsAttr elementsAttr,
+                                          size_t alignment,
                                           FlatBufferBuilder &fbb) {
   if (auto attr = elementsAttr.dyn_cast<DenseIntElementsAttr>()) {
     switch (attr.getType().getElementTypeBitWidth()) {
       case 8:
-        return serializeConstantI8Array(attr, fbb);
+        return serializeConstantI8Array(attr, alignment, fbb);
       case 16:
-        return serializeConstantI16Array(attr, fbb);
+        return serializeConstantI16Array(attr, alignment, fbb);
       case 32:
-        return serializeConstantI32Array(attr, fbb);
+        return serializeConstantI32Array(attr, alignment, fbb);
       case 64:
-        return serializeConstantI64Array(attr, fbb);
+        return serializeConstantI64Array(attr, alignment, fbb);
       default:
         emitError(loc) << "unhandled element bitwidth "
                        << attr.getType().getElementTypeBitWidth();
@@ -126,9 +137,9 @@ Offset<Vector<uint8_t>> serializeConstant(Location loc,
   } else if (auto attr = elementsAttr.dyn_cast<DenseFPElementsAttr>()) {
     switch (attr.getType().getElementTypeBitWidth()) {
       case 32:
-        return serializeConstantF32Array(attr, fbb);
+        return serializeConstantF32Array(attr, alignment, fbb);
       case 64:
-        return serializeConstantF64Array(attr, fbb);
+        return serializeConstantF64Array(attr, alignment, fbb);
       default:
         emitError(loc) << "unhandled element bitwidth "
                        << attr.getType().getElementTypeBitWidth();
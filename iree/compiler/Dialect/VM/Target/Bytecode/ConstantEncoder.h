@@ -25,8 +25,10 @@ namespace IREE {
 namespace VM {
 
 // Serializes a constant attribute to the FlatBuffer as a binary blob.
+// The blob contents will be aligned to |alignment| bytes (a power of two)
+// relative to the start of the finished FlatBuffer.
 flatbuffers::Offset<flatbuffers::Vector<uint8_t>> serializeConstant(
-    Location loc, ElementsAttr elementsAttr,
+    Location loc, ElementsAttr elementsAttr, size_t alignment,
     flatbuffers::FlatBufferBuilder &fbb);
 
 }  // namespace VM
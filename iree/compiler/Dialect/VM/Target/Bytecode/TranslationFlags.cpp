@@ -63,6 +63,13 @@ static llvm::cl::opt<bool> stripDebugOpsFlag{
     llvm::cl::init(false),
 };
 
+static llvm::cl::opt<bool> pageAlignRodataFlag{
+    "iree-vm-bytecode-module-page-align-rodata",
+    llvm::cl::desc("Aligns large read-only data segments to page boundaries so "
+                   "that they can be used in place from mapped modules"),
+    llvm::cl::init(true),
+};
+
 BytecodeTargetOptions getBytecodeTargetOptionsFromFlags() {
   BytecodeTargetOptions targetOptions;
   targetOptions.outputFormat = outputFormatFlag;
@@ -70,6 +77,7 @@ BytecodeTargetOptions getBytecodeTargetOptionsFromFlags() {
   targetOptions.stripSymbols = stripSymbolsFlag;
   targetOptions.stripSourceMap = stripSourceMapFlag;
   targetOptions.stripDebugOps = stripDebugOpsFlag;
+  targetOptions.pageAlignRodata = pageAlignRodataFlag;
   return targetOptions;
 }
 
@@ -210,6 +210,8 @@ struct ConcatToCopies : public OpRewritePattern<ConcatOp> {
     std::vector<Value> dimPieces;
     auto dst =
         rewriter.create<IREEInterp::HL::AllocHeapOp>(loc, finalType, dimPieces);
+    // The copies below tile the entire result.
+    dst.setAttr("uninitialized", rewriter.getUnitAttr());
 
     llvm::SmallVector<int64_t, 4> zeroOffset(finalType.getRank(), 0);
     auto srcIndices = createArrayConstant(rewriter, loc, zeroOffset);
@@ -114,6 +114,33 @@ LogicalResult writeOp(IREEInterp::LL::ConvertUSOp op, BytecodeWriter *writer) {
   return WriteConvertOperands(op, writer);
 }
 
+// Floats are always signed so float conversions share the integer opcodes; the
+// operand types select the runtime conversion.
+LogicalResult writeOp(IREEInterp::LL::ConvertSFOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvertSS));
+  return WriteConvertOperands(op, writer);
+}
+
+LogicalResult writeOp(IREEInterp::LL::ConvertUFOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvertUS));
+  return WriteConvertOperands(op, writer);
+}
+
+LogicalResult writeOp(IREEInterp::LL::ConvertFSOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvertSS));
+  return WriteConvertOperands(op, writer);
+}
+
+LogicalResult writeOp(IREEInterp::LL::ConvertFUOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvertSU));
+  return WriteConvertOperands(op, writer);
+}
+
+LogicalResult writeOp(IREEInterp::LL::ConvertFFOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConvertSS));
+  return WriteConvertOperands(op, writer);
+}
+
 LogicalResult writeOp(IREEInterp::LL::BranchOp op, BytecodeWriter *writer) {
   RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kBranch));
   RETURN_IF_FAILURE(writer->WriteBlockOffset(op.getDest()));
@@ -169,7 +196,27 @@ LogicalResult writeOp(IREEInterp::LL::CmpFOp op, BytecodeWriter *writer) {
 LogicalResult writeOp(IREEInterp::LL::AllocHeapOp op, BytecodeWriter *writer) {
   auto memrefType = op.getType().cast<MemRefType>();
   RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kAllocHeap));
-  RETURN_IF_FAILURE(writer->WriteInt32(0));
+  auto heapFlags = iree::AllocHeapFlag::kDefault;
+  if (op.getAttrOfType<UnitAttr>("uninitialized")) {
+    heapFlags |= iree::AllocHeapFlag::kUninitialized;
+  }
+  RETURN_IF_FAILURE(writer->WriteInt32(static_cast<int32_t>(heapFlags)));
+  RETURN_IF_FAILURE(writer->WriteTypeIndex(memrefType.getElementType()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(memrefType));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.getOperands()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.getResult()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::AllocStackOp op, BytecodeWriter *writer) {
+  auto memrefType = op.getType().cast<MemRefType>();
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kAllocStack));
+  auto heapFlags = iree::AllocHeapFlag::kDefault;
+  if (op.getAttrOfType<UnitAttr>("uninitialized")) {
+    heapFlags |= iree::AllocHeapFlag::kUninitialized;
+  }
+  RETURN_IF_FAILURE(writer->WriteInt32(static_cast<int32_t>(heapFlags)));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.offset().getSExtValue()));
   RETURN_IF_FAILURE(writer->WriteTypeIndex(memrefType.getElementType()));
   RETURN_IF_FAILURE(writer->WriteShapePieces(memrefType));
   RETURN_IF_FAILURE(writer->WriteLocals(op.getOperands()));
@@ -177,6 +224,20 @@ LogicalResult writeOp(IREEInterp::LL::AllocHeapOp op, BytecodeWriter *writer) {
   return success();
 }
 
+LogicalResult writeOp(IREEInterp::LL::AllocStackInitOp op,
+                      BytecodeWriter *writer) {
+  auto memrefType = op.getType().cast<MemRefType>();
+  RETURN_IF_FAILURE(
+      writer->WriteOpcode(iree::InterpreterOpcode::kAllocStackInit));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.offset().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteTypeIndex(memrefType.getElementType()));
+  RETURN_IF_FAILURE(writer->WriteShapePieces(memrefType));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.getOperands()));
+  RETURN_IF_FAILURE(writer->WriteConstant(memrefType, op.value()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.getResult()));
+  return success();
+}
+
 LogicalResult writeOp(IREEInterp::LL::StaticCopyOp op, BytecodeWriter *writer) {
   RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kStaticCopy));
   RETURN_IF_FAILURE(writer->WriteLocal(op.src()));
@@ -187,6 +248,66 @@ LogicalResult writeOp(IREEInterp::LL::StaticCopyOp op, BytecodeWriter *writer) {
   return success();
 }
 
+LogicalResult writeOp(IREEInterp::LL::Conv2DFOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConv2DF));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.input()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.filter()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.window_strides()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.rhs_dilation()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.padding()));
+  RETURN_IF_FAILURE(
+      writer->WriteInt32(op.feature_group_count().getZExtValue()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::FusedElementwiseFOp op,
+                      BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(
+      writer->WriteOpcode(iree::InterpreterOpcode::kFusedElementwiseF));
+  RETURN_IF_FAILURE(writer->WriteLocals(op.args()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.program()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::MatMulQOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kMatMulQ));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.lhs()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.rhs()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.bias()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.multiplier_mantissa()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.multiplier_exponent()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.lhs_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.rhs_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.result_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.clamp_min().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.clamp_max().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
+LogicalResult writeOp(IREEInterp::LL::Conv2DQOp op, BytecodeWriter *writer) {
+  RETURN_IF_FAILURE(writer->WriteOpcode(iree::InterpreterOpcode::kConv2DQ));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.input()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.filter()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.bias()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.multiplier_mantissa()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.multiplier_exponent()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.window_strides()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.rhs_dilation()));
+  RETURN_IF_FAILURE(writer->WriteElementsAttrInt32(op.padding()));
+  RETURN_IF_FAILURE(
+      writer->WriteInt32(op.feature_group_count().getZExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.input_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.filter_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.result_zero_point().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.clamp_min().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteInt32(op.clamp_max().getSExtValue()));
+  RETURN_IF_FAILURE(writer->WriteLocal(op.dst()));
+  return success();
+}
+
 LogicalResult writeReduceOperands(Operation *op, BytecodeWriter *writer,
                                   APInt dimension) {
   RETURN_IF_FAILURE(writer->WriteLocal(op->getOperand(0)));
@@ -245,10 +366,21 @@ void registerInterpreterCustomWriters(VMFunctionBuilder *builder) {
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertUUOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertSUOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertUSOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertSFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertUFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertFSOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertFUOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ConvertFFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::CmpIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::CmpFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AllocHeapOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AllocStackOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::AllocStackInitOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::StaticCopyOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::Conv2DFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::FusedElementwiseFOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::MatMulQOp);
+  REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::Conv2DQOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumIOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceSumFOp);
   REGISTER_CUSTOM_WRITER_IMPL(IREEInterp::LL::ReduceMinIOp);
@@ -5,7 +5,7 @@
 // CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
 func @concat.1D(%arg0 : memref<4xi32>, %arg1 : memref<3xi32>) -> memref<7xi32> {
   // CHECK-DAG: [[SRC_INDICES:%.+]]  = iree.constant[dense<0> : tensor<1x
-  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() : () -> memref<7xi32>
+  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<7xi32>
 
   // CHECK-DAG: [[DST_INDICES0:%.+]] = iree.constant[dense<0> : tensor<1x
   // CHECK-DAG: [[LENGTHS0:%.+]]     = iree.constant[dense<4> : tensor<1x
@@ -28,7 +28,7 @@ func @concat.1D(%arg0 : memref<4xi32>, %arg1 : memref<3xi32>) -> memref<7xi32> {
 // CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
 func @concat.2D.Dim0(%arg0 : memref<4x4xi32>, %arg1 : memref<3x4xi32>) -> memref<7x4xi32> {
   // CHECK-DAG: [[SRC_INDICES:%.+]]  = iree.constant[dense<0> : tensor<2x
-  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() : () -> memref<7x4xi32>
+  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<7x4xi32>
 
   // CHECK-DAG: [[DST_INDICES0:%.+]] = iree.constant[dense<0> : tensor<2x
   // CHECK-DAG: [[LENGTHS0:%.+]]     = iree.constant[dense<4> : tensor<2x
@@ -51,7 +51,7 @@ func @concat.2D.Dim0(%arg0 : memref<4x4xi32>, %arg1 : memref<3x4xi32>) -> memref
 // CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
 func @concat.2D.Dim1(%arg0 : memref<4x4xi32>, %arg1 : memref<4x3xi32>) -> memref<4x7xi32> {
   // CHECK-DAG: [[SRC_INDICES:%.+]]  = iree.constant[dense<0> : tensor<2x
-  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() : () -> memref<4x7xi32>
+  // CHECK-DAG: [[DST:%.+]]          = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<4x7xi32>
 
   // CHECK-DAG: [[DST_INDICES0:%.+]] = iree.constant[dense<0> : tensor<2x
   // CHECK-DAG: [[LENGTHS0:%.+]]     = iree.constant[dense<4> : tensor<2x
@@ -188,7 +188,11 @@ LogicalResult writeOp(IREESeq::LL::StaticDispatchOp op,
 LogicalResult writeOp(IREESeq::LL::AllocHeapOp op, BytecodeWriter *writer) {
   auto memRefType = op.getType().cast<MemRefType>();
   RETURN_IF_FAILURE(writer->WriteOpcode(iree::SequencerOpcode::kAllocHeap));
-  RETURN_IF_FAILURE(writer->WriteInt32(0));
+  auto heapFlags = iree::AllocHeapFlag::kDefault;
+  if (op.getAttrOfType<UnitAttr>("uninitialized")) {
+    heapFlags |= iree::AllocHeapFlag::kUninitialized;
+  }
+  RETURN_IF_FAILURE(writer->WriteInt32(static_cast<int32_t>(heapFlags)));
   RETURN_IF_FAILURE(writer->WriteTypeIndex(memRefType.getElementType()));
   RETURN_IF_FAILURE(writer->WriteShapePieces(memRefType));
   RETURN_IF_FAILURE(writer->WriteLocals(op.getOperands()));
@@ -51,6 +51,8 @@ LogicalResult BytecodeWriter::WriteTypeIndex(Type type) {
     type_index = iree::BuiltinType::kF32;
   } else if (type.isF64()) {
     type_index = iree::BuiltinType::kF64;
+  } else if (type.isBF16()) {
+    type_index = iree::BuiltinType::kBF16;
   } else {
     // TODO(benvanik): support unknown types as BuiltinType::kOpaque?
     return emitError(UnknownLoc::get(type.getContext()))
@@ -162,11 +162,17 @@ LogicalResult VMFunctionBuilder::ConvertBytecode() {
   RETURN_IF_FAILURE(EndFunction(function_, &writer));
 
   int localCount = writer.local_count();
+  int stackSize = 0;
+  if (auto stackSizeAttr =
+          function_.getAttrOfType<IntegerAttr>("iree.bytecode.stack_size")) {
+    stackSize = stackSizeAttr.getInt();
+  }
   auto bodyBytes = writer.Finish();
   auto bodyOffset = fbb_->CreateVector(
       reinterpret_cast<const int8_t *>(bodyBytes.data()), bodyBytes.size());
   iree::BytecodeDefBuilder bdb(*fbb_);
   bdb.add_local_count(localCount);
+  bdb.add_stack_size(stackSize);
   bdb.add_contents(bodyOffset);
   bytecodeDef_ = bdb.Finish();
 
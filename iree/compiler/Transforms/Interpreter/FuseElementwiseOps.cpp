@@ -0,0 +1,230 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "iree/compiler/IR/Interpreter/HLDialect.h"
+#include "iree/compiler/IR/Interpreter/HLOps.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Maximum number of ops fused into a single op. The program is serialized as
+// an index list and limited to UINT8_MAX values.
+constexpr int kMaxFusedOps = UINT8_MAX / iree::kFusedElementwiseInstructionSize;
+
+// Returns the fused program op matching |op| or None if |op| is not a float
+// elementwise op that can be fused.
+llvm::Optional<iree::FusedElementwiseOp> getFusedElementwiseOp(Operation *op) {
+  using iree::FusedElementwiseOp;
+  if (isa<IREEInterp::HL::AddFOp>(op)) return FusedElementwiseOp::kAdd;
+  if (isa<IREEInterp::HL::SubFOp>(op)) return FusedElementwiseOp::kSub;
+  if (isa<IREEInterp::HL::MulFOp>(op)) return FusedElementwiseOp::kMul;
+  if (isa<IREEInterp::HL::DivFOp>(op)) return FusedElementwiseOp::kDiv;
+  if (isa<IREEInterp::HL::RemFOp>(op)) return FusedElementwiseOp::kRem;
+  if (isa<IREEInterp::HL::MinFOp>(op)) return FusedElementwiseOp::kMin;
+  if (isa<IREEInterp::HL::MaxFOp>(op)) return FusedElementwiseOp::kMax;
+  if (isa<IREEInterp::HL::AbsFOp>(op)) return FusedElementwiseOp::kAbs;
+  if (isa<IREEInterp::HL::ExpFOp>(op)) return FusedElementwiseOp::kExp;
+  if (isa<IREEInterp::HL::LogFOp>(op)) return FusedElementwiseOp::kLog;
+  if (isa<IREEInterp::HL::RsqrtFOp>(op)) return FusedElementwiseOp::kRsqrt;
+  if (isa<IREEInterp::HL::SqrtFOp>(op)) return FusedElementwiseOp::kSqrt;
+  if (isa<IREEInterp::HL::CosFOp>(op)) return FusedElementwiseOp::kCos;
+  if (isa<IREEInterp::HL::SinFOp>(op)) return FusedElementwiseOp::kSin;
+  if (isa<IREEInterp::HL::TanhFOp>(op)) return FusedElementwiseOp::kTanh;
+  if (isa<IREEInterp::HL::FloorFOp>(op)) return FusedElementwiseOp::kFloor;
+  if (isa<IREEInterp::HL::CeilFOp>(op)) return FusedElementwiseOp::kCeil;
+  if (isa<IREEInterp::HL::MulAddFOp>(op)) return FusedElementwiseOp::kMulAdd;
+  if (isa<IREEInterp::HL::ClampFOp>(op)) return FusedElementwiseOp::kClamp;
+  return llvm::None;
+}
+
+// Returns true if |op| can be part of a fused_elementwise_f op.
+// The ternary ops do not verify their operand types so we check that all
+// operands match the (statically shaped) result here.
+bool isFusableOp(Operation *op) {
+  if (!getFusedElementwiseOp(op).hasValue() || op->getNumResults() != 1) {
+    return false;
+  }
+  auto resultType = op->getResult(0)->getType().dyn_cast<MemRefType>();
+  if (!resultType || !resultType.hasStaticShape()) return false;
+  return llvm::all_of(op->getOperandTypes(),
+                      [&](Type type) { return type == resultType; });
+}
+
+// Fuses chains of float elementwise ops (add_f, mul_f, tanh_f, etc) within each
+// block into fused_elementwise_f ops so that the runtime can evaluate the
+// whole chain in a single pass without materializing the intermediate buffers.
+//
+// Groups are formed from a root op by pulling in producers whose results are
+// only used within the group. Producers are not moved across ops with side
+// effects (such as copies into a buffer the chain may read).
+class FuseElementwiseOpsPass : public FunctionPass<FuseElementwiseOpsPass> {
+ public:
+  void runOnFunction() override {
+    for (auto &block : getFunction()) {
+      for (auto &groupOps : findFusionGroupsInBlock(block)) {
+        fuseGroup(groupOps);
+      }
+    }
+  }
+
+ private:
+  // Returns the groups of ops in |block| that can be fused, with each group
+  // sorted in block order and ending with the root op.
+  SmallVector<SmallVector<Operation *, 8>, 4> findFusionGroupsInBlock(
+      Block &block) {
+    SmallVector<Operation *, 8> opsWithSideEffects;
+    for (auto &op : block) {
+      if (!op.hasNoSideEffect()) opsWithSideEffects.push_back(&op);
+    }
+
+    llvm::SmallPtrSet<Operation *, 16> processedOps;
+    SmallVector<SmallVector<Operation *, 8>, 4> groups;
+    for (auto &op : llvm::reverse(block.getOperations())) {
+      // Find the op prior to |op| that has side-effects. Producers before it
+      // must stay where they are.
+      while (!opsWithSideEffects.empty() &&
+             op.isBeforeInBlock(opsWithSideEffects.back())) {
+        opsWithSideEffects.pop_back();
+      }
+      Operation *blockerOp =
+          opsWithSideEffects.empty() ? nullptr : opsWithSideEffects.back();
+      if (processedOps.count(&op) || !isFusableOp(&op)) continue;
+
+      auto groupOps = collectFusionGroup(&op, blockerOp, processedOps);
+      if (groupOps.size() > 1) groups.push_back(std::move(groupOps));
+    }
+    return groups;
+  }
+
+  // Collects |rootOp| and the producers that can be fused into it.
+  SmallVector<Operation *, 8> collectFusionGroup(
+      Operation *rootOp, Operation *blockerOp,
+      llvm::SmallPtrSetImpl<Operation *> &processedOps) {
+    llvm::SmallSetVector<Operation *, 8> groupOps;
+    groupOps.insert(rootOp);
+    processedOps.insert(rootOp);
+    SmallVector<Operation *, 8> worklist{rootOp};
+    while (!worklist.empty()) {
+      auto *op = worklist.pop_back_val();
+      for (auto operand : op->getOperands()) {
+        auto *depOp = operand->getDefiningOp();
+        if (!depOp || depOp->getBlock() != rootOp->getBlock() ||
+            processedOps.count(depOp) || !isFusableOp(depOp)) {
+          continue;
+        } else if (blockerOp && depOp->isBeforeInBlock(blockerOp)) {
+          continue;
+        } else if (groupOps.size() >= kMaxFusedOps) {
+          continue;
+        }
+        // The intermediate result is not materialized so all of its users must
+        // be in the group. If some are not yet they may pull it in later.
+        bool allUsersFused = llvm::all_of(
+            depOp->getResult(0)->getUsers(),
+            [&](Operation *user) { return groupOps.count(user) != 0; });
+        if (!allUsersFused) continue;
+        groupOps.insert(depOp);
+        processedOps.insert(depOp);
+        worklist.push_back(depOp);
+      }
+    }
+
+    auto sortedOps = groupOps.takeVector();
+    llvm::sort(sortedOps, [](Operation *lhs, Operation *rhs) {
+      return lhs->isBeforeInBlock(rhs);
+    });
+    return SmallVector<Operation *, 8>(sortedOps.begin(), sortedOps.end());
+  }
+
+  // Replaces |groupOps| with a single fused_elementwise_f op at the root.
+  void fuseGroup(ArrayRef<Operation *> groupOps) {
+    auto *rootOp = groupOps.back();
+    llvm::SmallPtrSet<Operation *, 8> groupOpSet(groupOps.begin(),
+                                                 groupOps.end());
+
+    // Values defined outside of the group become the inputs and take the
+    // first registers.
+    llvm::SetVector<Value> inputs;
+    for (auto *op : groupOps) {
+      for (auto operand : op->getOperands()) {
+        auto *defOp = operand->getDefiningOp();
+        if (!defOp || !groupOpSet.count(defOp)) inputs.insert(operand);
+      }
+    }
+    llvm::DenseMap<Value, int32_t> registers;
+    int32_t nextRegister = 0;
+    for (auto input : inputs) {
+      registers[input] = nextRegister++;
+    }
+
+    SmallVector<int32_t, 32> program;
+    SmallVector<Location, 8> opLocs;
+    for (auto *op : groupOps) {
+      program.push_back(
+          static_cast<int32_t>(getFusedElementwiseOp(op).getValue()));
+      for (unsigned i = 0; i < iree::kFusedElementwiseInstructionSize - 1;
+           ++i) {
+        program.push_back(
+            i < op->getNumOperands() ? registers[op->getOperand(i)] : 0);
+      }
+      registers[op->getResult(0)] = nextRegister++;
+      opLocs.push_back(op->getLoc());
+    }
+
+    OpBuilder builder(rootOp);
+    auto programAttr =
+        DenseIntElementsAttr::get(
+            RankedTensorType::get(program.size(), builder.getIntegerType(32)),
+            llvm::makeArrayRef(program))
+            .cast<DenseIntElementsAttr>();
+    auto fusedOp = builder.create<IREEInterp::HL::FusedElementwiseFOp>(
+        FusedLoc::get(opLocs, builder.getContext()),
+        rootOp->getResult(0)->getType(), inputs.getArrayRef(), programAttr);
+    rootOp->getResult(0)->replaceAllUsesWith(fusedOp.getResult());
+    for (auto *op : llvm::reverse(groupOps)) {
+      op->erase();
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass() {
+  return std::make_unique<FuseElementwiseOpsPass>();
+}
+
+static PassRegistration<FuseElementwiseOpsPass> pass(
+    "iree-interpreter-fuse-elementwise-ops",
+    "Fuses chains of elementwise ops into fused_elementwise_f ops");
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,126 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/compiler/IR/Interpreter/HLDialect.h"
+#include "iree/compiler/IR/Interpreter/HLOps.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Returns true if |op| computes on float values (as opposed to only moving
+// them around) and must see f32 values in place of bf16.
+bool isFloatComputeOp(Operation *op) {
+  return isa<IREEInterp::HL::AddFOp>(op) || isa<IREEInterp::HL::SubFOp>(op) ||
+         isa<IREEInterp::HL::MulFOp>(op) || isa<IREEInterp::HL::DivFOp>(op) ||
+         isa<IREEInterp::HL::RemFOp>(op) || isa<IREEInterp::HL::MinFOp>(op) ||
+         isa<IREEInterp::HL::MaxFOp>(op) || isa<IREEInterp::HL::AbsFOp>(op) ||
+         isa<IREEInterp::HL::ExpFOp>(op) || isa<IREEInterp::HL::LogFOp>(op) ||
+         isa<IREEInterp::HL::RsqrtFOp>(op) ||
+         isa<IREEInterp::HL::SqrtFOp>(op) || isa<IREEInterp::HL::CosFOp>(op) ||
+         isa<IREEInterp::HL::SinFOp>(op) || isa<IREEInterp::HL::TanhFOp>(op) ||
+         isa<IREEInterp::HL::Atan2FOp>(op) ||
+         isa<IREEInterp::HL::FloorFOp>(op) ||
+         isa<IREEInterp::HL::CeilFOp>(op) ||
+         isa<IREEInterp::HL::MulAddFOp>(op) ||
+         isa<IREEInterp::HL::ClampFOp>(op) ||
+         isa<IREEInterp::HL::CmpFOp>(op) ||
+         isa<IREEInterp::HL::FusedElementwiseFOp>(op) ||
+         isa<IREEInterp::HL::MatMulFOp>(op) ||
+         isa<IREEInterp::HL::Conv2DFOp>(op) ||
+         isa<IREEInterp::HL::ReduceSumFOp>(op) ||
+         isa<IREEInterp::HL::ReduceMinFOp>(op) ||
+         isa<IREEInterp::HL::ReduceMaxFOp>(op);
+}
+
+// Returns |type| with its bf16 element type replaced by f32 or a null type if
+// |type| is not a bf16 memref.
+MemRefType getWidenedType(Type type) {
+  auto memRefType = type.dyn_cast<MemRefType>();
+  if (!memRefType || !memRefType.getElementType().isBF16()) return {};
+  return MemRefType::get(memRefType.getShape(),
+                         FloatType::getF32(type.getContext()));
+}
+
+// Wraps float compute ops on bf16 values with conversions to and from f32.
+//
+// The runtime stores bf16 but has no bf16 kernels (and cannot tell bf16 from
+// f16 by element size alone), so bf16 operands are widened with convert_f_f
+// before each compute op and bf16 results are narrowed back after it. Ops that
+// only move data (copies, slices, reshapes, etc) are left operating on bf16.
+class LegalizeBFloat16ComputePass
+    : public FunctionPass<LegalizeBFloat16ComputePass> {
+ public:
+  void runOnFunction() override {
+    SmallVector<Operation *, 8> computeOps;
+    getFunction().walk([&](Operation *op) {
+      if (!isFloatComputeOp(op)) return;
+      bool hasBFloat16 =
+          llvm::any_of(op->getOperandTypes(),
+                       [](Type type) { return !!getWidenedType(type); }) ||
+          llvm::any_of(op->getResultTypes(),
+                       [](Type type) { return !!getWidenedType(type); });
+      if (hasBFloat16) computeOps.push_back(op);
+    });
+    for (auto *op : computeOps) {
+      widenOp(op);
+    }
+  }
+
+ private:
+  void widenOp(Operation *op) {
+    OpBuilder builder(op);
+    for (auto &operand : op->getOpOperands()) {
+      auto widenedType = getWidenedType(operand.get()->getType());
+      if (!widenedType) continue;
+      auto convertOp = builder.create<IREEInterp::HL::ConvertFFOp>(
+          op->getLoc(), widenedType, operand.get());
+      operand.set(convertOp.getResult());
+    }
+
+    builder.setInsertionPointAfter(op);
+    for (auto result : op->getResults()) {
+      auto originalType = result->getType();
+      auto widenedType = getWidenedType(originalType);
+      if (!widenedType) continue;
+      result->setType(widenedType);
+      auto convertOp = builder.create<IREEInterp::HL::ConvertFFOp>(
+          op->getLoc(), originalType, result);
+      result->replaceAllUsesWith(convertOp.getResult());
+      convertOp.getOperation()->setOperand(0, result);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OpPassBase<FuncOp>> createLegalizeBFloat16ComputePass() {
+  return std::make_unique<LegalizeBFloat16ComputePass>();
+}
+
+static PassRegistration<LegalizeBFloat16ComputePass> pass(
+    "iree-interpreter-legalize-bf16-compute",
+    "Wraps bf16 float compute ops with conversions to and from f32");
+
+}  // namespace iree_compiler
+}  // namespace mlir
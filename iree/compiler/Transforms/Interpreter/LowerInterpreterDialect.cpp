@@ -119,6 +119,9 @@ class SimpleOpLowering : public OpRewritePattern<SrcOp> {
       ArrayRef<Value> dim_pieces;
       auto allocOp = rewriter.create<IREEInterp::LL::AllocHeapOp>(
           op.getLoc(), memRefType, dim_pieces);
+      // The op defines the entire value of its result, so the output buffer
+      // is fully written before anything can read it.
+      allocOp.setAttr("uninitialized", rewriter.getUnitAttr());
       operands.push_back(allocOp);
       replacementValues.push_back(allocOp);
     }
@@ -165,6 +168,13 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(ConvertUUOp),
       SAME_NAME_SIMPLE_PATTERN(ConvertSUOp),
       SAME_NAME_SIMPLE_PATTERN(ConvertUSOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvertSFOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvertUFOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvertFSOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvertFUOp),
+      SAME_NAME_SIMPLE_PATTERN(ConvertFFOp),
+      SAME_NAME_SIMPLE_PATTERN(Conv2DFOp),
+      SAME_NAME_SIMPLE_PATTERN(Conv2DQOp),
       SAME_NAME_SIMPLE_PATTERN(CondBreakOp),
       SAME_NAME_SIMPLE_PATTERN(CosFOp),
       SAME_NAME_SIMPLE_PATTERN(DimOp),
@@ -176,9 +186,11 @@ void populateInterpreterLoweringPatterns(OwningRewritePatternList &patterns,
       SAME_NAME_SIMPLE_PATTERN(RsqrtFOp),
       SAME_NAME_SIMPLE_PATTERN(SqrtFOp),
       SAME_NAME_SIMPLE_PATTERN(FloorFOp),
+      SAME_NAME_SIMPLE_PATTERN(FusedElementwiseFOp),
       SAME_NAME_SIMPLE_PATTERN(LengthOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulFOp),
       SAME_NAME_SIMPLE_PATTERN(MatMulIOp),
+      SAME_NAME_SIMPLE_PATTERN(MatMulQOp),
       SAME_NAME_SIMPLE_PATTERN(MaxFOp),
       SAME_NAME_SIMPLE_PATTERN(MaxISOp),
       SAME_NAME_SIMPLE_PATTERN(MaxIUOp),
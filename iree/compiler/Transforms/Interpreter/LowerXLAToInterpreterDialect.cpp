@@ -160,6 +160,109 @@ struct ConcatOpLowering : public XlaOpLowering<xla_hlo::ConcatenateOp> {
   }
 };
 
+// Returns true if the dimension ordering [outer, feature, spatial...] of a
+// conv operand matches |expected|.
+template <typename SpatialDimsAttr>
+bool isConvDimensionOrder(IntegerAttr outerDim, IntegerAttr featureDim,
+                          SpatialDimsAttr spatialDims,
+                          ArrayRef<int64_t> expected) {
+  llvm::SmallVector<int64_t, 4> ordering{outerDim.getInt(),
+                                         featureDim.getInt()};
+  for (const auto &dim : spatialDims) {
+    ordering.push_back(dim.getSExtValue());
+  }
+  return llvm::makeArrayRef(ordering) == expected;
+}
+
+// Returns the values of an optional conv window attribute or |count| copies of
+// |defaultValue| if it is not present.
+template <typename OptionalElementsAttr>
+llvm::SmallVector<int32_t, 4> getConvWindowValues(OptionalElementsAttr attr,
+                                                  int count,
+                                                  int32_t defaultValue) {
+  llvm::SmallVector<int32_t, 4> values;
+  if (attr.hasValue()) {
+    for (const auto &value : attr.getValue().getIntValues()) {
+      values.push_back(value.getSExtValue());
+    }
+  } else {
+    values.resize(count, defaultValue);
+  }
+  return values;
+}
+
+struct ConvOpLowering : public XlaOpLowering<xla_hlo::ConvOp> {
+  using XlaOpLowering::XlaOpLowering;
+
+  Operation *rewriteInternal(
+      xla_hlo::ConvOp *op, ArrayRef<Value> operands,
+      ConversionPatternRewriter &rewriter) const override {
+    auto inputType = operands[0]->getType().cast<MemRefType>();
+    auto filterType = operands[1]->getType().cast<MemRefType>();
+    auto finalType = convertTypeToMemRef(*op);
+    if (!finalType.getElementType().isa<FloatType>()) {
+      op->emitRemark() << "Could not lower non-floating point conv";
+      return nullptr;
+    }
+    if (inputType.getRank() != 4 || filterType.getRank() != 4 ||
+        finalType.getRank() != 4) {
+      op->emitRemark() << "Could not lower conv with rank != 4 (only 2D)";
+      return nullptr;
+    }
+
+    // The interpreter kernel works on NHWC inputs/outputs with HWIO filters.
+    auto dimensionNumbers = op->dimension_numbers();
+    if (!isConvDimensionOrder(dimensionNumbers.input_batch_dimension(),
+                              dimensionNumbers.input_feature_dimension(),
+                              dimensionNumbers.input_spatial_dimensions(),
+                              {0, 3, 1, 2}) ||
+        !isConvDimensionOrder(
+            dimensionNumbers.kernel_output_feature_dimension(),
+            dimensionNumbers.kernel_input_feature_dimension(),
+            dimensionNumbers.kernel_spatial_dimensions(), {3, 2, 0, 1}) ||
+        !isConvDimensionOrder(dimensionNumbers.output_batch_dimension(),
+                              dimensionNumbers.output_feature_dimension(),
+                              dimensionNumbers.output_spatial_dimensions(),
+                              {0, 3, 1, 2})) {
+      op->emitRemark() << "Could not lower conv with non NHWC/HWIO layouts";
+      return nullptr;
+    }
+    if (op->batch_group_count().getZExtValue() != 1) {
+      op->emitRemark() << "Could not lower conv with batch_group_count != 1";
+      return nullptr;
+    }
+
+    auto windowStrides = getConvWindowValues(op->window_strides(), 2, 1);
+    auto lhsDilation = getConvWindowValues(op->lhs_dilation(), 2, 1);
+    auto rhsDilation = getConvWindowValues(op->rhs_dilation(), 2, 1);
+    auto padding = getConvWindowValues(op->padding(), 4, 0);
+    auto isNotOne = [](int32_t value) { return value != 1; };
+    auto isNegative = [](int32_t value) { return value < 0; };
+    if (llvm::any_of(lhsDilation, isNotOne)) {
+      op->emitRemark() << "Could not lower conv with lhs (input) dilation";
+      return nullptr;
+    }
+    if (windowStrides.size() != 2 || rhsDilation.size() != 2 ||
+        padding.size() != 4 || llvm::any_of(padding, isNegative)) {
+      op->emitRemark() << "Could not lower conv with unsupported window";
+      return nullptr;
+    }
+
+    auto getI32ElementsAttr = [&](ArrayRef<int32_t> values) {
+      return DenseIntElementsAttr::get(
+                 RankedTensorType::get(values.size(),
+                                       rewriter.getIntegerType(32)),
+                 values)
+          .cast<DenseIntElementsAttr>();
+    };
+    return rewriter.create<IREEInterp::HL::Conv2DFOp>(
+        op->getLoc(), finalType, operands[0], operands[1],
+        getI32ElementsAttr(windowStrides), getI32ElementsAttr(rhsDilation),
+        getI32ElementsAttr(padding),
+        rewriter.getI32IntegerAttr(op->feature_group_count().getZExtValue()));
+  }
+};
+
 struct DotOpLowering : public XlaOpLowering<xla_hlo::DotOp> {
   using XlaOpLowering::XlaOpLowering;
 
@@ -434,6 +537,8 @@ struct GatherOpLowering : public OpConversionPattern<xla_hlo::GatherOp> {
     std::vector<Value> dim_pieces;
     auto dst = rewriter.create<IREEInterp::HL::AllocHeapOp>(
         gatherOp.getLoc(), dstType, dim_pieces);
+    // The copy below writes the entire slice.
+    dst.setAttr("uninitialized", rewriter.getUnitAttr());
     auto lengths = rewriter.create<IREE::ConstantOp>(gatherOp.getLoc(),
                                                      gatherOp.slice_sizes());
     llvm::SmallVector<int64_t, 4> zero_offset;
@@ -473,6 +578,8 @@ struct SliceOpLowering : public XlaOpLowering<xla_hlo::SliceOp> {
     std::vector<Value> dim_pieces;
     auto dst = rewriter.create<IREEInterp::HL::AllocHeapOp>(
         op->getLoc(), finalType, dim_pieces);
+    // The copy below writes the entire slice.
+    dst.setAttr("uninitialized", rewriter.getUnitAttr());
     auto srcIndices =
         rewriter.create<IREE::ConstantOp>(op->getLoc(), op->start_indices());
     auto lengths =
@@ -563,12 +670,13 @@ struct ReverseOpLowering : public XlaOpLowering<xla_hlo::ReverseOp> {
 void populateLowerXlaToInterpreterPatterns(OwningRewritePatternList &patterns,
                                            MLIRContext *ctx) {
   patterns.insert<AbsOpLowering, BroadcastInDimOpLowering, ConcatOpLowering,
-                  ConvertLowering, CopyOpLowering, DotOpLowering,
-                  DynamicUpdateSliceOpLowering, ExpOpLowering, FloorOpLowering,
-                  GatherOpLowering, LogOpLowering, MaxOpLowering, MinOpLowering,
-                  PadOpLowering, ReshapeOpLowering, ReverseOpLowering,
-                  RsqrtOpLowering, SqrtOpLowering, SelectOpLowering,
-                  SliceOpLowering, TransposeOpLowering, TanhOpLowering>(ctx);
+                  ConvertLowering, ConvOpLowering, CopyOpLowering,
+                  DotOpLowering, DynamicUpdateSliceOpLowering, ExpOpLowering,
+                  FloorOpLowering, GatherOpLowering, LogOpLowering,
+                  MaxOpLowering, MinOpLowering, PadOpLowering,
+                  ReshapeOpLowering, ReverseOpLowering, RsqrtOpLowering,
+                  SqrtOpLowering, SelectOpLowering, SliceOpLowering,
+                  TransposeOpLowering, TanhOpLowering>(ctx);
 }
 
 namespace {
@@ -25,15 +25,25 @@ namespace iree_compiler {
 // Expands reduction functions to their interpreter ops.
 std::unique_ptr<OpPassBase<ModuleOp>> createExpandReductionsToOpsPass();
 
+// Fuses chains of elementwise ops into single-pass fused_elementwise_f ops.
+std::unique_ptr<OpPassBase<FuncOp>> createFuseElementwiseOpsPass();
+
 // Refactors entry points to match the IREE dispatch executable ABI.
 std::unique_ptr<OpPassBase<ModuleOp>> createMakeExecutableABIPass();
 
+// Wraps float compute ops on bf16 memrefs with conversions to and from f32.
+std::unique_ptr<OpPassBase<FuncOp>> createLegalizeBFloat16ComputePass();
+
 // Lowers IREE HL ops (iree_hl_interp.*) to LL ops (iree_ll_interp.*).
 std::unique_ptr<OpPassBase<FuncOp>> createLowerInterpreterDialectPass();
 
 // Lowers input dialect ops (e.g. std, xla_hlo) to IREE Interpreter HL dialect.
 std::unique_ptr<OpPassBase<FuncOp>> createLowerToInterpreterDialectPass();
 
+// Replaces function-local LL heap allocations with alloc_stack ops packed into
+// a per-function stack arena.
+std::unique_ptr<OpPassBase<FuncOp>> createPlanStackAllocationsPass();
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
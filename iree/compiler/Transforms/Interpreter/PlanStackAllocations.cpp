@@ -0,0 +1,205 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "iree/compiler/IR/Interpreter/LLDialect.h"
+#include "iree/compiler/IR/Interpreter/LLOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Function.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/StandardTypes.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassRegistry.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Function attribute holding the size in bytes of the stack arena.
+constexpr const char kStackSizeAttrName[] = "iree.bytecode.stack_size";
+
+// Alignment of each allocation within the stack arena.
+constexpr int64_t kStackAllocationAlignment = 64;
+
+// A heap allocation that can be placed in the stack arena.
+struct StackAllocation {
+  IREEInterp::LL::AllocHeapOp allocOp;
+  int64_t byteSize = 0;
+  // Live range as op indices within the function, inclusive.
+  int64_t liveBegin = 0;
+  int64_t liveEnd = 0;
+  int64_t offset = 0;
+};
+
+// Returns the size in bytes of |allocOp| or 0 if it cannot be placed in the
+// stack arena.
+int64_t getStaticAllocationSize(IREEInterp::LL::AllocHeapOp allocOp) {
+  auto memrefType = allocOp.getType().cast<MemRefType>();
+  if (!memrefType.hasStaticShape() || allocOp.getNumOperands() != 0 ||
+      !memrefType.getElementType().isIntOrFloat()) {
+    return 0;
+  }
+  int64_t elementSize =
+      (memrefType.getElementType().getIntOrFloatBitWidth() + 8 - 1) / 8;
+  return elementSize * memrefType.getNumElements();
+}
+
+// Returns true if the buffer allocated by |allocOp| is not used outside of the
+// invocation of the function. Uses are limited to the defining block and may
+// not be passed to successors, returned, or aliased by ops producing results
+// (such as reshape, slice, and calls).
+bool isLocalToBlock(IREEInterp::LL::AllocHeapOp allocOp) {
+  auto *block = allocOp.getOperation()->getBlock();
+  return llvm::all_of(allocOp.getResult()->getUsers(), [&](Operation *user) {
+    return user->getBlock() == block && !user->isKnownTerminator() &&
+           user->getNumResults() == 0;
+  });
+}
+
+// Plans the temporary buffers of each function into a single stack arena.
+//
+// Statically-shaped heap allocations whose buffers do not escape their block
+// are replaced with alloc_stack ops at fixed offsets within the arena.
+// Allocations with disjoint live ranges share storage, packed greedily in
+// order of decreasing size. The total arena size is stored on the function as
+// the iree.bytecode.stack_size attribute and the runtime reuses the arena for
+// every invocation so that these allocations do not hit the heap.
+//
+// As the arena is reused the `uninitialized` attribute is carried over to the
+// alloc_stack; without it the runtime zeroes the range as alloc_heap would.
+class PlanStackAllocationsPass
+    : public FunctionPass<PlanStackAllocationsPass> {
+ public:
+  void runOnFunction() override {
+    auto allocations = findStackAllocations();
+    int64_t stackSize = assignOffsets(allocations);
+    for (auto &allocation : allocations) {
+      replaceWithStackAllocation(allocation);
+    }
+    if (stackSize > 0) {
+      Builder builder(&getContext());
+      getFunction().setAttr(kStackSizeAttrName,
+                            builder.getI32IntegerAttr(stackSize));
+    }
+  }
+
+ private:
+  // Returns all allocations that can be placed in the stack arena along with
+  // their live ranges.
+  SmallVector<StackAllocation, 16> findStackAllocations() {
+    llvm::DenseMap<Operation *, int64_t> opIndices;
+    getFunction().walk([&](Operation *op) {
+      opIndices.insert({op, static_cast<int64_t>(opIndices.size())});
+    });
+
+    SmallVector<StackAllocation, 16> allocations;
+    getFunction().walk([&](IREEInterp::LL::AllocHeapOp allocOp) {
+      int64_t byteSize = getStaticAllocationSize(allocOp);
+      if (byteSize == 0 || !isLocalToBlock(allocOp)) return;
+      StackAllocation allocation;
+      allocation.allocOp = allocOp;
+      allocation.byteSize = byteSize;
+      allocation.liveBegin = opIndices[allocOp.getOperation()];
+      allocation.liveEnd = allocation.liveBegin;
+      for (auto *user : allocOp.getResult()->getUsers()) {
+        allocation.liveEnd = std::max(allocation.liveEnd, opIndices[user]);
+      }
+      allocations.push_back(allocation);
+    });
+    return allocations;
+  }
+
+  // Assigns each allocation an offset such that allocations with overlapping
+  // live ranges do not overlap in memory. Returns the total arena size.
+  int64_t assignOffsets(MutableArrayRef<StackAllocation> allocations) {
+    SmallVector<StackAllocation *, 16> sortedAllocations;
+    for (auto &allocation : allocations) {
+      sortedAllocations.push_back(&allocation);
+    }
+    llvm::stable_sort(sortedAllocations,
+                      [](StackAllocation *lhs, StackAllocation *rhs) {
+                        return lhs->byteSize > rhs->byteSize;
+                      });
+
+    int64_t stackSize = 0;
+    SmallVector<StackAllocation *, 16> placedAllocations;
+    SmallVector<StackAllocation *, 16> liveAllocations;
+    for (auto *allocation : sortedAllocations) {
+      // Gather placed allocations live at the same time, by offset.
+      liveAllocations.clear();
+      for (auto *placed : placedAllocations) {
+        if (placed->liveBegin <= allocation->liveEnd &&
+            allocation->liveBegin <= placed->liveEnd) {
+          liveAllocations.push_back(placed);
+        }
+      }
+      llvm::sort(liveAllocations,
+                 [](StackAllocation *lhs, StackAllocation *rhs) {
+                   return lhs->offset < rhs->offset;
+                 });
+
+      // First fit: take the lowest gap large enough for the allocation.
+      int64_t offset = 0;
+      for (auto *live : liveAllocations) {
+        if (offset + allocation->byteSize <= live->offset) break;
+        int64_t liveEnd = llvm::alignTo(live->offset + live->byteSize,
+                                        kStackAllocationAlignment);
+        offset = std::max(offset, liveEnd);
+      }
+      allocation->offset = offset;
+      stackSize = std::max(stackSize, offset + allocation->byteSize);
+      placedAllocations.push_back(allocation);
+    }
+    return stackSize;
+  }
+
+  // Replaces the heap allocation with an alloc_stack at the assigned offset.
+  void replaceWithStackAllocation(const StackAllocation &allocation) {
+    auto allocOp = allocation.allocOp;
+    OpBuilder builder(allocOp);
+    auto offsetAttr = builder.getI32IntegerAttr(
+        static_cast<int32_t>(allocation.offset));
+    SmallVector<NamedAttribute, 2> attrs{
+        builder.getNamedAttr("offset", offsetAttr)};
+    if (auto uninitializedAttr =
+            allocOp.getAttrOfType<UnitAttr>("uninitialized")) {
+      attrs.push_back(builder.getNamedAttr("uninitialized", uninitializedAttr));
+    }
+    auto stackOp = builder.create<IREEInterp::LL::AllocStackOp>(
+        allocOp.getLoc(), ArrayRef<Type>{allocOp.getType()},
+        ArrayRef<Value>{}, attrs);
+    allocOp.getResult()->replaceAllUsesWith(stackOp.getResult());
+    allocOp.erase();
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OpPassBase<FuncOp>> createPlanStackAllocationsPass() {
+  return std::make_unique<PlanStackAllocationsPass>();
+}
+
+static PassRegistration<PlanStackAllocationsPass> pass(
+    "iree-interpreter-plan-stack-allocations",
+    "Plans temporary buffers into a per-function stack arena");
+
+}  // namespace iree_compiler
+}  // namespace mlir
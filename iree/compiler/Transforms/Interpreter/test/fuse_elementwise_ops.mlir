@@ -0,0 +1,71 @@
+// RUN: iree-opt %s -iree-interpreter-fuse-elementwise-ops -split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @chain
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
+func @chain(%arg0 : memref<4xf32>, %arg1 : memref<4xf32>) -> memref<4xf32> {
+  // CHECK-NEXT: [[RES:%.+]] = "iree_hl_interp.fused_elementwise_f"([[ARG0]], [[ARG1]]) {program = dense<[2, 0, 1, 0, 0, 2, 0, 0, 14, 3, 0, 0]> : tensor<12xi32>}
+  %0 = "iree_hl_interp.mul_f"(%arg0, %arg1) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %1 = "iree_hl_interp.add_f"(%0, %arg0) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.tanh_f"(%1) : (memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: return [[RES]]
+  return %2 : memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @ternary
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ARG2:%[a-zA-Z0-9]+]]
+func @ternary(%arg0 : memref<2x3xf32>, %arg1 : memref<2x3xf32>, %arg2 : memref<2x3xf32>) -> memref<2x3xf32> {
+  // CHECK-NEXT: [[RES:%.+]] = "iree_hl_interp.fused_elementwise_f"([[ARG0]], [[ARG1]], [[ARG2]]) {program = dense<[17, 0, 1, 2, 18, 3, 1, 2]> : tensor<8xi32>}
+  %0 = "iree_hl_interp.madd_f"(%arg0, %arg1, %arg2) : (memref<2x3xf32>, memref<2x3xf32>, memref<2x3xf32>) -> memref<2x3xf32>
+  %1 = "iree_hl_interp.clamp_f"(%0, %arg1, %arg2) : (memref<2x3xf32>, memref<2x3xf32>, memref<2x3xf32>) -> memref<2x3xf32>
+  // CHECK-NEXT: return [[RES]]
+  return %1 : memref<2x3xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @intermediateUsedOutside
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
+func @intermediateUsedOutside(%arg0 : memref<4xf32>, %arg1 : memref<4xf32>) -> (memref<4xf32>, memref<4xf32>) {
+  // CHECK-NEXT: [[MUL:%.+]] = "iree_hl_interp.mul_f"([[ARG0]], [[ARG1]])
+  %0 = "iree_hl_interp.mul_f"(%arg0, %arg1) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: [[RES:%.+]] = "iree_hl_interp.fused_elementwise_f"([[MUL]], [[ARG0]]) {program = dense<[8, 0, 0, 0, 0, 2, 1, 0]> : tensor<8xi32>}
+  %1 = "iree_hl_interp.exp_f"(%0) : (memref<4xf32>) -> memref<4xf32>
+  %2 = "iree_hl_interp.add_f"(%1, %arg0) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: return [[MUL]], [[RES]]
+  return %0, %2 : memref<4xf32>, memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @sideEffectBarrier
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+func @sideEffectBarrier(%arg0 : memref<4xf32>, %arg1 : memref<4xf32>) -> memref<4xf32> {
+  // The add reads %arg0 after the copy so the chain before it fuses separately.
+  // CHECK-NEXT: [[ABS:%.+]] = "iree_hl_interp.fused_elementwise_f"([[ARG0]]) {program = dense<[8, 0, 0, 0, 7, 1, 0, 0]> : tensor<8xi32>}
+  %0 = "iree_hl_interp.exp_f"(%arg0) : (memref<4xf32>) -> memref<4xf32>
+  %1 = "iree_hl_interp.abs_f"(%0) : (memref<4xf32>) -> memref<4xf32>
+  %indices = iree.constant[dense<0> : tensor<1xi32>] : memref<1xi32>
+  %lengths = iree.constant[dense<4> : tensor<1xi32>] : memref<1xi32>
+  // CHECK: "iree_hl_interp.copy"
+  "iree_hl_interp.copy"(%arg1, %indices, %arg0, %indices, %lengths) : (memref<4xf32>, memref<1xi32>, memref<4xf32>, memref<1xi32>, memref<1xi32>) -> ()
+  // CHECK-NEXT: "iree_hl_interp.add_f"([[ABS]], [[ARG0]])
+  %2 = "iree_hl_interp.add_f"(%1, %arg0) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  return %2 : memref<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @integerNotFused
+func @integerNotFused(%arg0 : memref<4xi32>, %arg1 : memref<4xi32>) -> memref<4xi32> {
+  // CHECK-NEXT: "iree_hl_interp.mul_i"
+  %0 = "iree_hl_interp.mul_i"(%arg0, %arg1) : (memref<4xi32>, memref<4xi32>) -> memref<4xi32>
+  // CHECK-NEXT: "iree_hl_interp.add_i"
+  %1 = "iree_hl_interp.add_i"(%0, %arg0) : (memref<4xi32>, memref<4xi32>) -> memref<4xi32>
+  return %1 : memref<4xi32>
+}
@@ -0,0 +1,41 @@
+// RUN: iree-opt %s -iree-interpreter-legalize-bf16-compute -split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @binary
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[ARG1:%[a-zA-Z0-9]+]]
+func @binary(%arg0 : memref<4xbf16>, %arg1 : memref<4xbf16>) -> memref<4xbf16> {
+  // CHECK-NEXT: [[LHS:%.+]] = "iree_hl_interp.convert_f_f"([[ARG0]]) : (memref<4xbf16>) -> memref<4xf32>
+  // CHECK-NEXT: [[RHS:%.+]] = "iree_hl_interp.convert_f_f"([[ARG1]]) : (memref<4xbf16>) -> memref<4xf32>
+  // CHECK-NEXT: [[SUM:%.+]] = "iree_hl_interp.add_f"([[LHS]], [[RHS]]) : (memref<4xf32>, memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: [[RES:%.+]] = "iree_hl_interp.convert_f_f"([[SUM]]) : (memref<4xf32>) -> memref<4xbf16>
+  %0 = "iree_hl_interp.add_f"(%arg0, %arg1) : (memref<4xbf16>, memref<4xbf16>) -> memref<4xbf16>
+  // CHECK-NEXT: return [[RES]]
+  return %0 : memref<4xbf16>
+}
+
+// -----
+
+// CHECK-LABEL: func @chain
+// CHECK-SAME: [[ARG0:%[a-zA-Z0-9]+]]
+func @chain(%arg0 : memref<4xbf16>) -> memref<4xbf16> {
+  // CHECK-NEXT: [[SRC:%.+]] = "iree_hl_interp.convert_f_f"([[ARG0]]) : (memref<4xbf16>) -> memref<4xf32>
+  // CHECK-NEXT: [[EXP:%.+]] = "iree_hl_interp.exp_f"([[SRC]]) : (memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: [[TMP:%.+]] = "iree_hl_interp.convert_f_f"([[EXP]]) : (memref<4xf32>) -> memref<4xbf16>
+  %0 = "iree_hl_interp.exp_f"(%arg0) : (memref<4xbf16>) -> memref<4xbf16>
+  // CHECK-NEXT: [[TMP_F32:%.+]] = "iree_hl_interp.convert_f_f"([[TMP]]) : (memref<4xbf16>) -> memref<4xf32>
+  // CHECK-NEXT: [[ABS:%.+]] = "iree_hl_interp.abs_f"([[TMP_F32]]) : (memref<4xf32>) -> memref<4xf32>
+  // CHECK-NEXT: [[RES:%.+]] = "iree_hl_interp.convert_f_f"([[ABS]]) : (memref<4xf32>) -> memref<4xbf16>
+  %1 = "iree_hl_interp.abs_f"(%0) : (memref<4xbf16>) -> memref<4xbf16>
+  // CHECK-NEXT: return [[RES]]
+  return %1 : memref<4xbf16>
+}
+
+// -----
+
+// CHECK-LABEL: func @f32
+func @f32(%arg0 : memref<4xf32>) -> memref<4xf32> {
+  // CHECK-NEXT: "iree_hl_interp.exp_f"
+  // CHECK-NOT: convert_f_f
+  %0 = "iree_hl_interp.exp_f"(%arg0) : (memref<4xf32>) -> memref<4xf32>
+  return %0 : memref<4xf32>
+}
@@ -0,0 +1,64 @@
+// RUN: iree-opt %s -lower-iree-interpreter-hl-to-ll -split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @matmul_q
+// CHECK-SAME: [[LHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[RHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[MANTISSA:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[EXPONENT:%[a-zA-Z0-9]+]]
+func @matmul_q(%lhs : memref<4x8xi8>, %rhs : memref<8x16xi8>, %bias : memref<16xi32>, %mantissa : memref<16xi32>, %exponent : memref<16xi32>) -> memref<4x16xi8> {
+  // CHECK-NEXT: [[DST:%.+]] = "iree_ll_interp.alloc_heap"() {uninitialized} : () -> memref<4x16xi8>
+  // CHECK-NEXT: "iree_ll_interp.matmul_q"([[LHS]], [[RHS]], [[BIAS]], [[MANTISSA]], [[EXPONENT]], [[DST]])
+  // CHECK-SAME: clamp_max = 127 : i32
+  // CHECK-SAME: clamp_min = -128 : i32
+  // CHECK-SAME: lhs_zero_point = -3 : i32
+  // CHECK-SAME: result_zero_point = 5 : i32
+  // CHECK-SAME: rhs_zero_point = 0 : i32
+  // CHECK-SAME: (memref<4x8xi8>, memref<8x16xi8>, memref<16xi32>, memref<16xi32>, memref<16xi32>, memref<4x16xi8>) -> ()
+  %0 = "iree_hl_interp.matmul_q"(%lhs, %rhs, %bias, %mantissa, %exponent) {lhs_zero_point = -3 : i32, rhs_zero_point = 0 : i32, result_zero_point = 5 : i32, clamp_min = -128 : i32, clamp_max = 127 : i32} : (memref<4x8xi8>, memref<8x16xi8>, memref<16xi32>, memref<16xi32>, memref<16xi32>) -> memref<4x16xi8>
+  // CHECK-NEXT: iree.return [[DST]]
+  iree.return %0 : memref<4x16xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @matmul_q_per_tensor
+// CHECK-SAME: [[LHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[RHS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[MANTISSA:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[EXPONENT:%[a-zA-Z0-9]+]]
+func @matmul_q_per_tensor(%lhs : memref<2x3xi8>, %rhs : memref<3x4xi8>, %bias : memref<0xi32>, %mantissa : memref<1xi32>, %exponent : memref<1xi32>) -> memref<2x4xi8> {
+  // CHECK-NEXT: [[DST:%.+]] = "iree_ll_interp.alloc_heap"() {uninitialized} : () -> memref<2x4xi8>
+  // CHECK-NEXT: "iree_ll_interp.matmul_q"([[LHS]], [[RHS]], [[BIAS]], [[MANTISSA]], [[EXPONENT]], [[DST]])
+  // CHECK-SAME: (memref<2x3xi8>, memref<3x4xi8>, memref<0xi32>, memref<1xi32>, memref<1xi32>, memref<2x4xi8>) -> ()
+  %0 = "iree_hl_interp.matmul_q"(%lhs, %rhs, %bias, %mantissa, %exponent) {lhs_zero_point = 0 : i32, rhs_zero_point = 0 : i32, result_zero_point = 0 : i32, clamp_min = -128 : i32, clamp_max = 127 : i32} : (memref<2x3xi8>, memref<3x4xi8>, memref<0xi32>, memref<1xi32>, memref<1xi32>) -> memref<2x4xi8>
+  // CHECK-NEXT: iree.return [[DST]]
+  iree.return %0 : memref<2x4xi8>
+}
+
+// -----
+
+// CHECK-LABEL: func @conv2d_q
+// CHECK-SAME: [[INPUT:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[FILTER:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[BIAS:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[MANTISSA:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[EXPONENT:%[a-zA-Z0-9]+]]
+func @conv2d_q(%input : memref<1x8x8x4xi8>, %filter : memref<3x3x4x16xi8>, %bias : memref<16xi32>, %mantissa : memref<16xi32>, %exponent : memref<16xi32>) -> memref<1x4x4x16xi8> {
+  // CHECK-NEXT: [[DST:%.+]] = "iree_ll_interp.alloc_heap"() {uninitialized} : () -> memref<1x4x4x16xi8>
+  // CHECK-NEXT: "iree_ll_interp.conv2d_q"([[INPUT]], [[FILTER]], [[BIAS]], [[MANTISSA]], [[EXPONENT]], [[DST]])
+  // CHECK-SAME: clamp_max = 100 : i32
+  // CHECK-SAME: clamp_min = -100 : i32
+  // CHECK-SAME: feature_group_count = 1 : i32
+  // CHECK-SAME: filter_zero_point = 0 : i32
+  // CHECK-SAME: input_zero_point = 7 : i32
+  // CHECK-SAME: padding = dense<[0, 1, 0, 1]> : tensor<4xi32>
+  // CHECK-SAME: result_zero_point = -2 : i32
+  // CHECK-SAME: rhs_dilation = dense<1> : tensor<2xi32>
+  // CHECK-SAME: window_strides = dense<2> : tensor<2xi32>
+  // CHECK-SAME: (memref<1x8x8x4xi8>, memref<3x3x4x16xi8>, memref<16xi32>, memref<16xi32>, memref<16xi32>, memref<1x4x4x16xi8>) -> ()
+  %0 = "iree_hl_interp.conv2d_q"(%input, %filter, %bias, %mantissa, %exponent) {window_strides = dense<2> : tensor<2xi32>, rhs_dilation = dense<1> : tensor<2xi32>, padding = dense<[0, 1, 0, 1]> : tensor<4xi32>, feature_group_count = 1 : i32, input_zero_point = 7 : i32, filter_zero_point = 0 : i32, result_zero_point = -2 : i32, clamp_min = -100 : i32, clamp_max = 100 : i32} : (memref<1x8x8x4xi8>, memref<3x3x4x16xi8>, memref<16xi32>, memref<16xi32>, memref<16xi32>) -> memref<1x4x4x16xi8>
+  // CHECK-NEXT: iree.return [[DST]]
+  iree.return %0 : memref<1x4x4x16xi8>
+}
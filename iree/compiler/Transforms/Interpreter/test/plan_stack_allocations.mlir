@@ -0,0 +1,77 @@
+// RUN: iree-opt %s -iree-interpreter-plan-stack-allocations -split-input-file | IreeFileCheck %s
+
+// CHECK-LABEL: func @disjoint
+// CHECK-SAME: iree.bytecode.stack_size = 16 : i32
+func @disjoint(%arg0 : memref<4xf32>, %arg1 : memref<4xf32>) {
+  // CHECK-NEXT: [[T0:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32} : () -> memref<4xf32>
+  %0 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.mul_f"(%0, %arg0, %arg1) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  // CHECK: [[T1:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32} : () -> memref<4xf32>
+  %1 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg1, %arg1, %1) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.mul_f"(%1, %arg1, %arg0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.return"() : () -> ()
+}
+
+// -----
+
+// Zero-initialized allocations sharing an offset must stay zero-initialized as
+// the earlier allocation leaves its data in the arena.
+// CHECK-LABEL: func @sharedZeroInit
+// CHECK-SAME: iree.bytecode.stack_size = 16 : i32
+func @sharedZeroInit(%arg0 : memref<4xf32>, %arg1 : memref<4xf32>) {
+  // CHECK-NEXT: [[T0:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32, uninitialized} : () -> memref<4xf32>
+  %0 = "iree_ll_interp.alloc_heap"() {uninitialized} : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.mul_f"(%0, %arg0, %arg1) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  // CHECK: [[T1:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32} : () -> memref<4xf32>
+  %1 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg1, %arg1, %1) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.mul_f"(%1, %arg1, %arg0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  // CHECK: [[T2:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32} : () -> memref<4xf32>
+  %2 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.mul_f"(%2, %arg0, %arg1) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.return"() : () -> ()
+}
+
+// -----
+
+// CHECK-LABEL: func @overlapping
+// CHECK-SAME: iree.bytecode.stack_size = 80 : i32
+func @overlapping(%arg0 : memref<4xf32>, %arg1 : memref<8xf32>, %arg2 : memref<8xf32>) {
+  // CHECK-NEXT: [[T0:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 64 : i32} : () -> memref<4xf32>
+  %0 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  // CHECK-NEXT: [[T1:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32} : () -> memref<8xf32>
+  %1 = "iree_ll_interp.alloc_heap"() : () -> memref<8xf32>
+  "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.add_f"(%arg1, %arg1, %1) : (memref<8xf32>, memref<8xf32>, memref<8xf32>) -> ()
+  "iree_ll_interp.mul_f"(%0, %0, %arg0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.mul_f"(%1, %1, %arg2) : (memref<8xf32>, memref<8xf32>, memref<8xf32>) -> ()
+  "iree_ll_interp.return"() : () -> ()
+}
+
+// -----
+
+// CHECK-LABEL: func @escaping
+// CHECK-NOT: iree.bytecode.stack_size
+func @escaping(%arg0 : memref<4xf32>) -> memref<4xf32> {
+  // CHECK-NEXT: [[RES:%.+]] = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  %0 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.return"(%0) : (memref<4xf32>) -> ()
+}
+
+// -----
+
+// CHECK-LABEL: func @acrossBlocks
+// CHECK-NOT: iree.bytecode.stack_size
+func @acrossBlocks(%arg0 : memref<4xf32>) {
+  // CHECK-NEXT: [[TMP:%.+]] = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  %0 = "iree_ll_interp.alloc_heap"() : () -> memref<4xf32>
+  "iree_ll_interp.add_f"(%arg0, %arg0, %0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.br"()[^bb1] : () -> ()
+^bb1:
+  "iree_ll_interp.mul_f"(%0, %0, %arg0) : (memref<4xf32>, memref<4xf32>, memref<4xf32>) -> ()
+  "iree_ll_interp.return"() : () -> ()
+}
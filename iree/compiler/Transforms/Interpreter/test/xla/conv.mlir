@@ -0,0 +1,40 @@
+// RUN: iree-opt --lower-xla-to-iree-interpreter %s | IreeFileCheck %s
+
+// CHECK-LABEL: @conv2d_nhwc
+// CHECK-SAME: [[INPUT:%[a-zA-Z0-9]+]]
+// CHECK-SAME: [[FILTER:%[a-zA-Z0-9]+]]
+func @conv2d_nhwc(%input : tensor<1x8x8x4xf32>, %filter : tensor<3x3x4x16xf32>) -> tensor<1x4x4x16xf32> {
+  // CHECK-DAG:  [[INPUT_MEMREF:%.+]] = iree.tensor_to_memref([[INPUT]]
+  // CHECK-DAG:  [[FILTER_MEMREF:%.+]] = iree.tensor_to_memref([[FILTER]]
+  // CHECK-NEXT: [[RESULT:%.+]] = "iree_hl_interp.conv2d_f"([[INPUT_MEMREF]], [[FILTER_MEMREF]])
+  // CHECK-SAME: feature_group_count = 1 : i32
+  // CHECK-SAME: padding = dense<[0, 1, 0, 1]> : tensor<4xi32>
+  // CHECK-SAME: rhs_dilation = dense<1> : tensor<2xi32>
+  // CHECK-SAME: window_strides = dense<2> : tensor<2xi32>
+  // CHECK-SAME: -> memref<1x4x4x16xf32>
+  // CHECK-NEXT: [[RESULT_TENSOR:%.+]] = iree.memref_to_tensor([[RESULT]]
+  %result = "xla_hlo.conv"(%input, %filter) {batch_group_count = 1 : i64, dimension_numbers = {input_batch_dimension = 0 : i64, input_feature_dimension = 3 : i64, input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>, kernel_input_feature_dimension = 2 : i64, kernel_output_feature_dimension = 3 : i64, kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>, output_batch_dimension = 0 : i64, output_feature_dimension = 3 : i64, output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>}, feature_group_count = 1 : i64, padding = dense<[[0, 1], [0, 1]]> : tensor<2x2xi64>, rhs_dilation = dense<1> : tensor<2xi64>, window_strides = dense<2> : tensor<2xi64>} : (tensor<1x8x8x4xf32>, tensor<3x3x4x16xf32>) -> tensor<1x4x4x16xf32>
+  // CHECK-NEXT: return [[RESULT_TENSOR]]
+  return %result : tensor<1x4x4x16xf32>
+}
+
+// CHECK-LABEL: @conv2d_default_window
+func @conv2d_default_window(%input : tensor<1x4x4x2xf32>, %filter : tensor<3x3x1x4xf32>) -> tensor<1x2x2x4xf32> {
+  // CHECK: "iree_hl_interp.conv2d_f"
+  // CHECK-SAME: feature_group_count = 2 : i32
+  // CHECK-SAME: padding = dense<0> : tensor<4xi32>
+  // CHECK-SAME: rhs_dilation = dense<1> : tensor<2xi32>
+  // CHECK-SAME: window_strides = dense<1> : tensor<2xi32>
+  %result = "xla_hlo.conv"(%input, %filter) {batch_group_count = 1 : i64, dimension_numbers = {input_batch_dimension = 0 : i64, input_feature_dimension = 3 : i64, input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>, kernel_input_feature_dimension = 2 : i64, kernel_output_feature_dimension = 3 : i64, kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>, output_batch_dimension = 0 : i64, output_feature_dimension = 3 : i64, output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>}, feature_group_count = 2 : i64} : (tensor<1x4x4x2xf32>, tensor<3x3x1x4xf32>) -> tensor<1x2x2x4xf32>
+  return %result : tensor<1x2x2x4xf32>
+}
+
+// CHECK-LABEL: @conv2d_batch_group_not_lowered
+func @conv2d_batch_group_not_lowered(%input : tensor<2x4x4x2xf32>, %filter : tensor<3x3x2x4xf32>) -> tensor<1x2x2x4xf32> {
+  // CHECK-NOT: iree_hl_interp.conv2d_f
+  // CHECK: "xla_hlo.conv"
+  // CHECK-SAME: batch_group_count = 2 : i64
+  %result = "xla_hlo.conv"(%input, %filter) {batch_group_count = 2 : i64, dimension_numbers = {input_batch_dimension = 0 : i64, input_feature_dimension = 3 : i64, input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>, kernel_input_feature_dimension = 2 : i64, kernel_output_feature_dimension = 3 : i64, kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>, output_batch_dimension = 0 : i64, output_feature_dimension = 3 : i64, output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>}, feature_group_count = 1 : i64} : (tensor<2x4x4x2xf32>, tensor<3x3x2x4xf32>) -> tensor<1x2x2x4xf32>
+  // CHECK-NOT: iree_hl_interp.conv2d_f
+  return %result : tensor<1x2x2x4xf32>
+}
@@ -10,7 +10,7 @@ func @gather(%input : tensor<5x2x3xf32>, %start_indices : tensor<i64>) -> tensor
   // CHECK-DAG:  [[START_INDICES_RESHAPED:%.+]] = "iree_hl_interp.reshape"([[START_INDICES_MEMREF]], [[START_INDICES_NEW_SHAPE]])
   // CHECK-DAG:  [[ZEROES:%.+]] = iree.constant[dense<0> : tensor<2xi64>
   // CHECK-DAG:  [[START_INDICES_PADDED:%.+]] = "iree_hl_interp.concat"([[START_INDICES_RESHAPED]], [[ZEROES]])
-  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() : () -> memref<1x2x3xf32>
+  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<1x2x3xf32>
   // CHECK-DAG:  [[DST_INDICES:%.+]] = iree.constant[dense<0>
   // CHECK-DAG:  [[LENGTHS:%.+]] = iree.constant[dense<[1, 2, 3]>
   // CHECK-NEXT: "iree_hl_interp.copy"([[SRC]], [[START_INDICES_PADDED]], [[DST]], [[DST_INDICES]], [[LENGTHS]])
@@ -38,7 +38,7 @@ func @gather_nonscalar_indices(%input : tensor<5x2x3xf32>, %start_indices : tens
   // CHECK-DAG:  [[START_INDICES_MEMREF:%.+]] = iree.tensor_to_memref([[START_INDICES]] : tensor<1xi64>)
   // CHECK-DAG:  [[ZEROES:%.+]] = iree.constant[dense<0> : tensor<2xi64>
   // CHECK-DAG:  [[START_INDICES_PADDED:%.+]] = "iree_hl_interp.concat"([[START_INDICES_MEMREF]], [[ZEROES]])
-  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() : () -> memref<1x2x3xf32>
+  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<1x2x3xf32>
   // CHECK-DAG:  [[DST_INDICES:%.+]] = iree.constant[dense<0>
   // CHECK-DAG:  [[LENGTHS:%.+]] = iree.constant[dense<[1, 2, 3]>
   // CHECK-NEXT: "iree_hl_interp.copy"([[SRC]], [[START_INDICES_PADDED]], [[DST]], [[DST_INDICES]], [[LENGTHS]])
@@ -64,7 +64,7 @@ func @gather_nonscalar_indices(%input : tensor<5x2x3xf32>, %start_indices : tens
 func @gather_fully_specified_indices(%input : tensor<5x2x3xf32>, %start_indices : tensor<3xi64>) -> tensor<2x3xf32> {
   // CHECK-DAG:  [[SRC:%.+]] = iree.tensor_to_memref([[INPUT]] : tensor<5x2x3xf32>)
   // CHECK-DAG:  [[START_INDICES_MEMREF:%.+]] = iree.tensor_to_memref([[START_INDICES]] : tensor<3xi64>)
-  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() : () -> memref<1x2x3xf32>
+  // CHECK-DAG:  [[DST:%.+]] = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<1x2x3xf32>
   // CHECK-DAG:  [[DST_INDICES:%.+]] = iree.constant[dense<0>
   // CHECK-DAG:  [[LENGTHS:%.+]] = iree.constant[dense<[1, 2, 3]>
   // CHECK-NEXT: "iree_hl_interp.copy"([[SRC]], [[START_INDICES_MEMREF]], [[DST]], [[DST_INDICES]], [[LENGTHS]])
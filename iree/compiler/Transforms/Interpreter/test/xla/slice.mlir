@@ -5,7 +5,7 @@
 func @slice(%arg : tensor<3x4xf32>) -> tensor<1x4xf32> {
   // CHECK-DAG:  [[SRC:%.+]]   = iree.tensor_to_memref([[ARG]]
   // CHECK-DAG:  [[SRC_INDICES:%.+]] = iree.constant[dense<[1, 0]>
-  // CHECK-DAG:  [[DST:%.+]]     = "iree_hl_interp.alloc_heap"() : () -> memref<1x4xf32>
+  // CHECK-DAG:  [[DST:%.+]]     = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<1x4xf32>
   // CHECK-DAG:  [[DST_INDICES:%.+]] = iree.constant[dense<0>
   // CHECK-DAG:  [[LENGTHS:%.+]] = iree.constant[dense<[1, 4]>
   // CHECK-NEXT: "iree_hl_interp.copy"([[SRC]], [[SRC_INDICES]], [[DST]], [[DST_INDICES]], [[LENGTHS]])
@@ -20,7 +20,7 @@ func @slice(%arg : tensor<3x4xf32>) -> tensor<1x4xf32> {
 func @slice_noncontiguous(%arg : tensor<3x4xf32>) -> tensor<2x2xf32> {
   // CHECK-DAG:  [[SRC:%.+]]   = iree.tensor_to_memref([[ARG]]
   // CHECK-DAG:  [[SRC_INDICES:%.+]] = iree.constant[dense<1>
-  // CHECK-DAG:  [[DST:%.+]]     = "iree_hl_interp.alloc_heap"() : () -> memref<2x2xf32>
+  // CHECK-DAG:  [[DST:%.+]]     = "iree_hl_interp.alloc_heap"() {uninitialized} : () -> memref<2x2xf32>
   // CHECK-DAG:  [[DST_INDICES:%.+]] = iree.constant[dense<0>
   // CHECK-DAG:  [[LENGTHS:%.+]] = iree.constant[dense<2>
   // CHECK-NEXT: "iree_hl_interp.copy"([[SRC]], [[SRC_INDICES]], [[DST]], [[DST_INDICES]], [[LENGTHS]])
@@ -102,6 +102,9 @@ void buildInterpreterConversionPassPipeline(PassManager *passManager) {
   // This also looks for other weird types (i1, etc).
   passManager->addPass(createLegalizeTypeStoragePass());
 
+  // bf16 is storage-only in the interpreter; compute on it in f32.
+  passManager->addNestedPass<FuncOp>(createLegalizeBFloat16ComputePass());
+
   // Perform any last-minute optimizations to trim down the IR.
   passManager->addPass(createAggressiveOpEliminationPass());
   passManager->addNestedPass<FuncOp>(createCanonicalizerPass());
@@ -112,6 +115,10 @@ void buildInterpreterConversionPassPipeline(PassManager *passManager) {
   passManager->addNestedPass<FuncOp>(createCSEPass());
   passManager->addNestedPass<FuncOp>(createCanonicalizerPass());
 
+  // Fuse chains of elementwise ops so that they run as a single pass over
+  // memory instead of materializing every intermediate buffer.
+  passManager->addNestedPass<FuncOp>(createFuseElementwiseOpsPass());
+
   // Drop all functions that are not reachable.
   passManager->addPass(createDropUnreachableExecutableFunctionsPass());
 }
@@ -122,6 +129,10 @@ void buildInterpreterLoweringPassPipeline(PassManager *passManager) {
   // Lower iree_hl_interp -> iree_ll_interp.
   passManager->addPass(createLowerInterpreterDialectPass());
 
+  // Pack temporary buffers into a per-function stack arena that is reused
+  // across invocations instead of allocating each from the heap.
+  passManager->addNestedPass<FuncOp>(createPlanStackAllocationsPass());
+
   // Assign ordinals used by the bytecode to reference executables and
   // functions.
   passManager->addPass(createAssignFunctionOrdinalsPass());
@@ -0,0 +1,77 @@
+// RUN: iree-opt -split-input-file -iree-hal-translate-executables -iree-hal-target-backends=interpreter-bytecode %s | IreeFileCheck %s
+
+flow.executable @matmul_q_ex_dispatch_0 {
+  flow.dispatch.entry @matmul_q_rgn_dispatch_0 attributes {
+      workgroup_size = dense<[32, 1, 1]> : vector<3xi32>,
+      workload = dense<[16, 4, 1]> : vector<3xi32>
+  }
+  module {
+    func @matmul_q_rgn_dispatch_0(%arg0: tensor<4x8xi8>, %arg1: tensor<8x16xi8>, %arg2: tensor<16xi32>, %arg3: tensor<16xi32>, %arg4: tensor<16xi32>) -> tensor<4x16xi8> {
+      %0 = iree.tensor_to_memref(%arg0 : tensor<4x8xi8>) : memref<4x8xi8>
+      %1 = iree.tensor_to_memref(%arg1 : tensor<8x16xi8>) : memref<8x16xi8>
+      %2 = iree.tensor_to_memref(%arg2 : tensor<16xi32>) : memref<16xi32>
+      %3 = iree.tensor_to_memref(%arg3 : tensor<16xi32>) : memref<16xi32>
+      %4 = iree.tensor_to_memref(%arg4 : tensor<16xi32>) : memref<16xi32>
+      %5 = "iree_hl_interp.matmul_q"(%0, %1, %2, %3, %4) {lhs_zero_point = -3 : i32, rhs_zero_point = 0 : i32, result_zero_point = 5 : i32, clamp_min = -128 : i32, clamp_max = 127 : i32} : (memref<4x8xi8>, memref<8x16xi8>, memref<16xi32>, memref<16xi32>, memref<16xi32>) -> memref<4x16xi8>
+      %6 = iree.memref_to_tensor(%5 : memref<4x16xi8>) : tensor<4x16xi8>
+      return %6 : tensor<4x16xi8>
+    }
+  }
+}
+
+// CHECK-LABEL: hal.executable @matmul_q_ex_dispatch_0 {
+// CHECK-NEXT:   hal.executable.entry_point @matmul_q_rgn_dispatch_0
+// CHECK-NEXT:   hal.executable.binary attributes {
+// CHECK-SAME:     data = dense
+// CHECK-SAME:     format = 1230128453 : i32} {
+// CHECK-NEXT:     module {
+// CHECK-NEXT:       func @matmul_q_rgn_dispatch_0(%arg0: memref<4x8xi8>, %arg1: memref<8x16xi8>, %arg2: memref<16xi32>, %arg3: memref<16xi32>, %arg4: memref<16xi32>, %arg5: memref<4x16xi8>)
+// CHECK:              [[DST:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32, uninitialized} : () -> memref<4x16xi8>
+// CHECK-NEXT:         "iree_ll_interp.matmul_q"(%arg0, %arg1, %arg2, %arg3, %arg4, [[DST]])
+// CHECK-SAME:           clamp_max = 127 : i32
+// CHECK-SAME:           clamp_min = -128 : i32
+// CHECK-SAME:           lhs_zero_point = -3 : i32
+// CHECK-SAME:           result_zero_point = 5 : i32
+// CHECK-SAME:           rhs_zero_point = 0 : i32
+// CHECK:              "iree_ll_interp.dynamic_copy"([[DST]], {{.+}}, %arg5,
+// CHECK:              iree.return
+
+// -----
+
+flow.executable @conv2d_q_ex_dispatch_0 {
+  flow.dispatch.entry @conv2d_q_rgn_dispatch_0 attributes {
+      workgroup_size = dense<[32, 1, 1]> : vector<3xi32>,
+      workload = dense<[16, 4, 4]> : vector<3xi32>
+  }
+  module {
+    func @conv2d_q_rgn_dispatch_0(%arg0: tensor<1x8x8x4xi8>, %arg1: tensor<3x3x4x16xi8>, %arg2: tensor<16xi32>, %arg3: tensor<1xi32>, %arg4: tensor<1xi32>) -> tensor<1x4x4x16xi8> {
+      %0 = iree.tensor_to_memref(%arg0 : tensor<1x8x8x4xi8>) : memref<1x8x8x4xi8>
+      %1 = iree.tensor_to_memref(%arg1 : tensor<3x3x4x16xi8>) : memref<3x3x4x16xi8>
+      %2 = iree.tensor_to_memref(%arg2 : tensor<16xi32>) : memref<16xi32>
+      %3 = iree.tensor_to_memref(%arg3 : tensor<1xi32>) : memref<1xi32>
+      %4 = iree.tensor_to_memref(%arg4 : tensor<1xi32>) : memref<1xi32>
+      %5 = "iree_hl_interp.conv2d_q"(%0, %1, %2, %3, %4) {window_strides = dense<2> : tensor<2xi32>, rhs_dilation = dense<1> : tensor<2xi32>, padding = dense<[0, 1, 0, 1]> : tensor<4xi32>, feature_group_count = 1 : i32, input_zero_point = 7 : i32, filter_zero_point = 0 : i32, result_zero_point = -2 : i32, clamp_min = -100 : i32, clamp_max = 100 : i32} : (memref<1x8x8x4xi8>, memref<3x3x4x16xi8>, memref<16xi32>, memref<1xi32>, memref<1xi32>) -> memref<1x4x4x16xi8>
+      %6 = iree.memref_to_tensor(%5 : memref<1x4x4x16xi8>) : tensor<1x4x4x16xi8>
+      return %6 : tensor<1x4x4x16xi8>
+    }
+  }
+}
+
+// CHECK-LABEL: hal.executable @conv2d_q_ex_dispatch_0 {
+// CHECK-NEXT:   hal.executable.entry_point @conv2d_q_rgn_dispatch_0
+// CHECK-NEXT:   hal.executable.binary attributes {
+// CHECK-SAME:     data = dense
+// CHECK-SAME:     format = 1230128453 : i32} {
+// CHECK-NEXT:     module {
+// CHECK-NEXT:       func @conv2d_q_rgn_dispatch_0(%arg0: memref<1x8x8x4xi8>, %arg1: memref<3x3x4x16xi8>, %arg2: memref<16xi32>, %arg3: memref<1xi32>, %arg4: memref<1xi32>, %arg5: memref<1x4x4x16xi8>)
+// CHECK:              [[DST:%.+]] = "iree_ll_interp.alloc_stack"() {offset = 0 : i32, uninitialized} : () -> memref<1x4x4x16xi8>
+// CHECK-NEXT:         "iree_ll_interp.conv2d_q"(%arg0, %arg1, %arg2, %arg3, %arg4, [[DST]])
+// CHECK-SAME:           feature_group_count = 1 : i32
+// CHECK-SAME:           filter_zero_point = 0 : i32
+// CHECK-SAME:           input_zero_point = 7 : i32
+// CHECK-SAME:           padding = dense<[0, 1, 0, 1]> : tensor<4xi32>
+// CHECK-SAME:           result_zero_point = -2 : i32
+// CHECK-SAME:           rhs_dilation = dense<1> : tensor<2xi32>
+// CHECK-SAME:           window_strides = dense<2> : tensor<2xi32>
+// CHECK:              "iree_ll_interp.dynamic_copy"([[DST]], {{.+}}, %arg5,
+// CHECK:              iree.return
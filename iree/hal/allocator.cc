@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 
+#include "iree/base/logging.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
@@ -73,5 +74,31 @@ StatusOr<ref_ptr<Buffer>> Allocator::WrapMutable(
          << "Allocator does not support wrapping host memory";
 }
 
+StatusOr<ref_ptr<Buffer>> Allocator::WrapMutableWithRelease(
+    MemoryTypeBitfield memory_type, MemoryAccessBitfield allowed_access,
+    BufferUsageBitfield buffer_usage, void* data, size_t data_length,
+    std::function<void()> release_callback) {
+  ASSIGN_OR_RETURN(auto buffer, WrapMutable(memory_type, allowed_access,
+                                            buffer_usage, data, data_length));
+  DCHECK(!buffer->release_callback_) << "Wrapped buffer already releasing";
+  buffer->release_callback_ = std::move(release_callback);
+  return buffer;
+}
+
+AllocatorStatistics Allocator::statistics() const {
+  return allocation_tracker_->statistics();
+}
+
+void Allocator::ResetPeakStatistics() { allocation_tracker_->ResetPeaks(); }
+
+void Allocator::TrackAllocation(Buffer* buffer) {
+  DCHECK(!buffer->allocation_tracker_) << "Buffer already tracked";
+  buffer->allocation_tag_index_ = AllocationTagScope::current_tag_index();
+  allocation_tracker_->RecordAllocation(buffer->memory_type_,
+                                        buffer->allocation_size_,
+                                        buffer->allocation_tag_index_);
+  buffer->allocation_tracker_ = add_ref(allocation_tracker_);
+}
+
 }  // namespace hal
 }  // namespace iree
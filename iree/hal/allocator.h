@@ -16,11 +16,13 @@
 #define IREE_HAL_ALLOCATOR_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 
 #include "absl/types/span.h"
 #include "iree/base/ref_ptr.h"
 #include "iree/base/status.h"
+#include "iree/hal/allocator_statistics.h"
 #include "iree/hal/buffer.h"
 
 namespace iree {
@@ -78,6 +80,20 @@ class Allocator : public RefObject<Allocator> {
                                              BufferUsageBitfield buffer_usage,
                                              size_t allocation_size) = 0;
 
+  // Allocates a buffer from the allocator with undefined contents.
+  // Callers must write every byte of the buffer before reading it, as is the
+  // case for buffers that are fully overwritten by a dispatch or copy. This
+  // avoids the cost of zeroing memory that will never be read. Allocators that
+  // cannot skip initialization may return the same buffer as Allocate.
+  //
+  // Host allocators fill the contents with a pattern in debug builds and mark
+  // them uninitialized in MSan builds to catch reads before writes.
+  virtual StatusOr<ref_ptr<Buffer>> AllocateUninitialized(
+      MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+      size_t allocation_size) {
+    return Allocate(memory_type, buffer_usage, allocation_size);
+  }
+
   // Allocates a buffer from the allocator for use as a constant value.
   // The provided |source_buffer| may be returned if the device can use it
   // directly and otherwise will be copied.
@@ -114,6 +130,34 @@ class Allocator : public RefObject<Allocator> {
                                         MemoryAccessBitfield allowed_access,
                                         BufferUsageBitfield buffer_usage,
                                         absl::Span<T> data);
+
+  // Wraps an existing host allocation as with WrapMutable and calls
+  // |release_callback| once the buffer and all subspans of it have been
+  // destroyed. This allows callers to hand off memory they cannot otherwise
+  // track the lifetime of, such as memory owned by a language runtime.
+  // If wrapping fails the callback is not called.
+  StatusOr<ref_ptr<Buffer>> WrapMutableWithRelease(
+      MemoryTypeBitfield memory_type, MemoryAccessBitfield allowed_access,
+      BufferUsageBitfield buffer_usage, void* data, size_t data_length,
+      std::function<void()> release_callback);
+
+  // Returns a snapshot of the buffers allocated from the allocator that are
+  // still live, broken down by memory type and allocation tag.
+  // Wrapped host memory is not counted.
+  virtual AllocatorStatistics statistics() const;
+
+  // Resets the peak statistics to the current live values, such as between
+  // benchmark phases.
+  void ResetPeakStatistics();
+
+ protected:
+  // Records |buffer| as allocated from this allocator until it is destroyed.
+  // Implementations must call this on each buffer they allocate memory for.
+  void TrackAllocation(Buffer* buffer);
+
+ private:
+  ref_ptr<AllocationTracker> allocation_tracker_ =
+      make_ref<AllocationTracker>();
 };
 
 // Inline functions and template definitions follow:
@@ -0,0 +1,244 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/allocator_statistics.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/logging.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+thread_local absl::string_view current_allocation_tag;
+thread_local int current_allocation_tag_index = -1;
+
+// Process-wide tag names. Only touched when scopes are entered and snapshots
+// are taken so a mutex is fine here.
+class TagRegistry {
+ public:
+  static TagRegistry* Get() {
+    static TagRegistry* registry = new TagRegistry();
+    return registry;
+  }
+
+  int Register(absl::string_view tag) {
+    if (tag.empty()) return -1;
+    absl::MutexLock lock(&mutex_);
+    auto it = indices_.find(tag);
+    if (it != indices_.end()) return it->second;
+    if (names_.size() >= AllocationTracker::kMaxTags) return -1;
+    int index = static_cast<int>(names_.size());
+    names_.emplace_back(tag);
+    indices_.emplace(std::string(tag), index);
+    return index;
+  }
+
+  std::vector<std::string> names() const {
+    absl::MutexLock lock(&mutex_);
+    return names_;
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::vector<std::string> names_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int> indices_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+double AllocatorStatistics::fragmentation() const {
+  if (backing_bytes_reserved <= 0) return 0.0;
+  double used_fraction = static_cast<double>(backing_bytes_used) /
+                         static_cast<double>(backing_bytes_reserved);
+  return std::min(1.0, std::max(0.0, 1.0 - used_fraction));
+}
+
+AllocationTagScope::AllocationTagScope(absl::string_view tag)
+    : previous_tag_(current_allocation_tag),
+      previous_tag_index_(current_allocation_tag_index) {
+  current_allocation_tag = tag;
+  current_allocation_tag_index = AllocationTracker::RegisterTag(tag);
+}
+
+AllocationTagScope::~AllocationTagScope() {
+  current_allocation_tag = previous_tag_;
+  current_allocation_tag_index = previous_tag_index_;
+}
+
+// static
+absl::string_view AllocationTagScope::current_tag() {
+  return current_allocation_tag;
+}
+
+// static
+int AllocationTagScope::current_tag_index() {
+  return current_allocation_tag_index;
+}
+
+void AllocationTracker::Counters::Add(int64_t byte_length) {
+  int64_t new_bytes_live =
+      bytes_live.fetch_add(byte_length, std::memory_order_relaxed) +
+      byte_length;
+  int64_t peak = peak_bytes_live.load(std::memory_order_relaxed);
+  while (peak < new_bytes_live &&
+         !peak_bytes_live.compare_exchange_weak(peak, new_bytes_live,
+                                                std::memory_order_relaxed)) {
+  }
+  live_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::Counters::Remove(int64_t byte_length) {
+  bytes_live.fetch_sub(byte_length, std::memory_order_relaxed);
+  live_allocation_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::Counters::ResetPeak() {
+  peak_bytes_live.store(bytes_live.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+}
+
+AllocationStatistics AllocationTracker::Counters::Snapshot() const {
+  AllocationStatistics statistics;
+  statistics.bytes_live = bytes_live.load(std::memory_order_relaxed);
+  statistics.peak_bytes_live = peak_bytes_live.load(std::memory_order_relaxed);
+  statistics.live_allocation_count =
+      live_allocation_count.load(std::memory_order_relaxed);
+  statistics.allocation_count =
+      allocation_count.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+// static
+int AllocationTracker::RegisterTag(absl::string_view tag) {
+  return TagRegistry::Get()->Register(tag);
+}
+
+AllocationTracker::~AllocationTracker() {
+  for (auto& tag_chunk : tag_chunks_) {
+    delete tag_chunk.load(std::memory_order_relaxed);
+  }
+}
+
+AllocationTracker::Counters* AllocationTracker::memory_type_counters(
+    MemoryType memory_type) {
+  auto index = static_cast<uint32_t>(memory_type);
+  DCHECK_LT(index, static_cast<uint32_t>(kMemoryTypeCount))
+      << "Unknown memory type bits";
+  return &memory_types_[index % kMemoryTypeCount];
+}
+
+AllocationTracker::TagCounters* AllocationTracker::tag_counters(
+    int tag_index) {
+  auto& chunk_slot = tag_chunks_[tag_index / kTagChunkSize];
+  TagChunk* chunk = chunk_slot.load(std::memory_order_acquire);
+  if (!chunk) {
+    // Another thread may race us to the chunk; the loser frees its copy.
+    TagChunk* new_chunk = new TagChunk();
+    if (chunk_slot.compare_exchange_strong(chunk, new_chunk,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+      chunk = new_chunk;
+    } else {
+      delete new_chunk;
+    }
+  }
+  return &chunk->tags[tag_index % kTagChunkSize];
+}
+
+void AllocationTracker::RecordAllocation(MemoryType memory_type,
+                                         int64_t byte_length, int tag_index) {
+  total_.Add(byte_length);
+  memory_type_counters(memory_type)->Add(byte_length);
+  if (tag_index < 0) return;
+  auto* tag = tag_counters(tag_index);
+  if (tag->first_use.load(std::memory_order_relaxed) == 0) {
+    int64_t unused = 0;
+    tag->first_use.compare_exchange_strong(
+        unused, next_first_use_.fetch_add(1, std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+  tag->counters.Add(byte_length);
+}
+
+void AllocationTracker::RecordFree(MemoryType memory_type, int64_t byte_length,
+                                   int tag_index) {
+  total_.Remove(byte_length);
+  memory_type_counters(memory_type)->Remove(byte_length);
+  if (tag_index >= 0) {
+    tag_counters(tag_index)->counters.Remove(byte_length);
+  }
+}
+
+AllocatorStatistics AllocationTracker::statistics() const {
+  AllocatorStatistics statistics;
+  statistics.total = total_.Snapshot();
+  for (int i = 0; i < kMemoryTypeCount; ++i) {
+    auto memory_type_statistics = memory_types_[i].Snapshot();
+    if (memory_type_statistics.allocation_count == 0) continue;
+    statistics.memory_types.emplace_back(static_cast<MemoryType>(i),
+                                         memory_type_statistics);
+  }
+
+  // Gather used tags and order them by first use.
+  std::vector<std::tuple<int64_t, int, AllocationStatistics>> used_tags;
+  for (int i = 0; i < kMaxTags / kTagChunkSize; ++i) {
+    const TagChunk* chunk = tag_chunks_[i].load(std::memory_order_acquire);
+    if (!chunk) continue;
+    for (int j = 0; j < kTagChunkSize; ++j) {
+      const auto& tag = chunk->tags[j];
+      int64_t first_use = tag.first_use.load(std::memory_order_relaxed);
+      if (first_use == 0) continue;
+      used_tags.emplace_back(first_use, i * kTagChunkSize + j,
+                             tag.counters.Snapshot());
+    }
+  }
+  if (used_tags.empty()) return statistics;
+  std::sort(used_tags.begin(), used_tags.end(),
+            [](const std::tuple<int64_t, int, AllocationStatistics>& a,
+               const std::tuple<int64_t, int, AllocationStatistics>& b) {
+              return std::get<0>(a) < std::get<0>(b);
+            });
+  auto tag_names = TagRegistry::Get()->names();
+  statistics.tags.reserve(used_tags.size());
+  for (const auto& used_tag : used_tags) {
+    statistics.tags.emplace_back(tag_names[std::get<1>(used_tag)],
+                                 std::get<2>(used_tag));
+  }
+  return statistics;
+}
+
+void AllocationTracker::ResetPeaks() {
+  total_.ResetPeak();
+  for (auto& memory_type : memory_types_) {
+    memory_type.ResetPeak();
+  }
+  for (auto& tag_chunk : tag_chunks_) {
+    TagChunk* chunk = tag_chunk.load(std::memory_order_acquire);
+    if (!chunk) continue;
+    for (auto& tag : chunk->tags) {
+      tag.counters.ResetPeak();
+    }
+  }
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,183 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_ALLOCATOR_STATISTICS_H_
+#define IREE_HAL_ALLOCATOR_STATISTICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "iree/base/ref_ptr.h"
+
+namespace iree {
+namespace hal {
+
+// Defined in buffer.h. Memory types are only used as opaque keys here.
+enum class MemoryType : uint32_t;
+
+// Counters for a set of allocations.
+struct AllocationStatistics {
+  // Bytes allocated and not yet freed.
+  int64_t bytes_live = 0;
+  // High water mark of bytes_live since creation or the last peak reset.
+  int64_t peak_bytes_live = 0;
+  // Allocations not yet freed.
+  int64_t live_allocation_count = 0;
+  // Total number of allocations made.
+  int64_t allocation_count = 0;
+};
+
+// A snapshot of the allocations made from an allocator.
+struct AllocatorStatistics {
+  // All allocations made from the allocator.
+  AllocationStatistics total;
+
+  // Breakdown by the memory type buffers were allocated with, ordered by
+  // memory type.
+  std::vector<std::pair<MemoryType, AllocationStatistics>> memory_types;
+
+  // Breakdown by the AllocationTagScope active when buffers were allocated,
+  // ordered by first use of the tag. Untagged allocations are only counted in
+  // |total|.
+  std::vector<std::pair<std::string, AllocationStatistics>> tags;
+
+  // Bytes the backing memory (such as a memory pool or device heap) holds from
+  // the system, including blocks cached for reuse. 0 if unknown.
+  // Backing memory may be shared with other allocators.
+  int64_t backing_bytes_reserved = 0;
+  // Bytes of backing_bytes_reserved that are in use by allocations, including
+  // any size class rounding.
+  int64_t backing_bytes_used = 0;
+
+  // Returns the fraction of reserved backing memory not in use, in [0, 1].
+  // Returns 0 if the backing memory is unknown.
+  double fragmentation() const;
+};
+
+// Attributes allocations made on the current thread to |tag| while in scope,
+// such as the executable or VM function that caused them.
+// Scopes nest and the innermost tag is used. |tag| must remain valid while the
+// scope is active. The tag is registered with AllocationTracker::RegisterTag
+// when the scope is entered so allocations made within it need no lookup.
+//
+// Usage:
+//   {
+//     AllocationTagScope tag_scope(function.name());
+//     RETURN_IF_ERROR(function.module()->Execute(...));
+//   }
+class AllocationTagScope {
+ public:
+  explicit AllocationTagScope(absl::string_view tag);
+  ~AllocationTagScope();
+
+  AllocationTagScope(const AllocationTagScope&) = delete;
+  AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+  // Returns the tag of the innermost scope on the current thread or an empty
+  // string if there is none.
+  static absl::string_view current_tag();
+
+  // Returns the registered index of current_tag() or -1 if there is none.
+  static int current_tag_index();
+
+ private:
+  absl::string_view previous_tag_;
+  int previous_tag_index_;
+};
+
+// Records allocations and frees made from an allocator.
+// Buffers keep a reference to the tracker they were recorded in so that their
+// frees are recorded even when they outlive the allocator.
+//
+// Thread-safe. Recording is lock-free so that allocations made concurrently
+// from many threads do not contend; snapshots taken while allocations are in
+// flight may be momentarily inconsistent across counters.
+class AllocationTracker final : public RefObject<AllocationTracker> {
+ public:
+  // Maximum number of distinct tags in the process. Tags registered beyond
+  // this are treated as untagged.
+  static constexpr int kMaxTags = 4096;
+
+  // Returns the process-wide index of |tag|, registering it on first use.
+  // Returns -1 if |tag| is empty or kMaxTags tags are already registered.
+  static int RegisterTag(absl::string_view tag);
+
+  AllocationTracker() = default;
+  ~AllocationTracker();
+  AllocationTracker(const AllocationTracker&) = delete;
+  AllocationTracker& operator=(const AllocationTracker&) = delete;
+
+  // Records an allocation of |byte_length| bytes of |memory_type| attributed to
+  // the tag with |tag_index| as returned by RegisterTag (or -1 if untagged).
+  // The same values must be passed to the matching RecordFree.
+  void RecordAllocation(MemoryType memory_type, int64_t byte_length,
+                        int tag_index);
+
+  // Records the free of an allocation previously passed to RecordAllocation.
+  void RecordFree(MemoryType memory_type, int64_t byte_length, int tag_index);
+
+  // Returns a snapshot of the statistics. Backing memory fields are left 0.
+  AllocatorStatistics statistics() const;
+
+  // Resets all peaks to the current live values.
+  void ResetPeaks();
+
+ private:
+  // Atomic version of AllocationStatistics.
+  struct Counters {
+    std::atomic<int64_t> bytes_live{0};
+    std::atomic<int64_t> peak_bytes_live{0};
+    std::atomic<int64_t> live_allocation_count{0};
+    std::atomic<int64_t> allocation_count{0};
+
+    void Add(int64_t byte_length);
+    void Remove(int64_t byte_length);
+    void ResetPeak();
+    AllocationStatistics Snapshot() const;
+  };
+
+  struct TagCounters {
+    Counters counters;
+    // Order in which the tag was first used with this tracker, starting at 1.
+    // 0 if the tag has not been used.
+    std::atomic<int64_t> first_use{0};
+  };
+
+  // Tag counters are allocated in chunks on first use as most processes only
+  // use a handful of tags.
+  static constexpr int kTagChunkSize = 64;
+  struct TagChunk {
+    TagCounters tags[kTagChunkSize];
+  };
+
+  // MemoryType is a 6-bit bitfield so every combination gets a slot.
+  static constexpr int kMemoryTypeCount = 64;
+
+  Counters* memory_type_counters(MemoryType memory_type);
+  TagCounters* tag_counters(int tag_index);
+
+  Counters total_;
+  Counters memory_types_[kMemoryTypeCount];
+  std::atomic<TagChunk*> tag_chunks_[kMaxTags / kTagChunkSize] = {};
+  std::atomic<int64_t> next_first_use_{1};
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_ALLOCATOR_STATISTICS_H_
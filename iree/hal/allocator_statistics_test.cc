@@ -0,0 +1,170 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/allocator_statistics.h"
+
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "iree/hal/allocator.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+TEST(AllocationTrackerTest, Empty) {
+  auto tracker = make_ref<AllocationTracker>();
+  auto statistics = tracker->statistics();
+  EXPECT_EQ(0, statistics.total.bytes_live);
+  EXPECT_EQ(0, statistics.total.peak_bytes_live);
+  EXPECT_EQ(0, statistics.total.allocation_count);
+  EXPECT_TRUE(statistics.memory_types.empty());
+  EXPECT_TRUE(statistics.tags.empty());
+  EXPECT_EQ(0.0, statistics.fragmentation());
+}
+
+TEST(AllocationTrackerTest, LiveAndPeakBytes) {
+  auto tracker = make_ref<AllocationTracker>();
+  tracker->RecordAllocation(MemoryType::kHostLocal, 100, -1);
+  tracker->RecordAllocation(MemoryType::kHostLocal, 50, -1);
+  tracker->RecordFree(MemoryType::kHostLocal, 100, -1);
+  tracker->RecordAllocation(MemoryType::kDeviceLocal, 10, -1);
+
+  auto statistics = tracker->statistics();
+  EXPECT_EQ(60, statistics.total.bytes_live);
+  EXPECT_EQ(150, statistics.total.peak_bytes_live);
+  EXPECT_EQ(2, statistics.total.live_allocation_count);
+  EXPECT_EQ(3, statistics.total.allocation_count);
+
+  ASSERT_EQ(2, statistics.memory_types.size());
+  EXPECT_EQ(MemoryType::kHostLocal, statistics.memory_types[0].first);
+  EXPECT_EQ(50, statistics.memory_types[0].second.bytes_live);
+  EXPECT_EQ(150, statistics.memory_types[0].second.peak_bytes_live);
+  EXPECT_EQ(MemoryType::kDeviceLocal, statistics.memory_types[1].first);
+  EXPECT_EQ(10, statistics.memory_types[1].second.bytes_live);
+
+  tracker->ResetPeaks();
+  tracker->RecordFree(MemoryType::kHostLocal, 50, -1);
+  statistics = tracker->statistics();
+  EXPECT_EQ(10, statistics.total.bytes_live);
+  EXPECT_EQ(60, statistics.total.peak_bytes_live);
+  EXPECT_EQ(50, statistics.memory_types[0].second.peak_bytes_live);
+}
+
+TEST(AllocationTrackerTest, Tags) {
+  auto tracker = make_ref<AllocationTracker>();
+  int f = AllocationTracker::RegisterTag("f");
+  int g = AllocationTracker::RegisterTag("g");
+  EXPECT_EQ(-1, AllocationTracker::RegisterTag(""));
+  EXPECT_EQ(f, AllocationTracker::RegisterTag("f"));
+  EXPECT_NE(f, g);
+  // Tags are ordered by first use within the tracker, not registration.
+  tracker->RecordAllocation(MemoryType::kHostLocal, 8, g);
+  tracker->RecordAllocation(MemoryType::kHostLocal, 16, f);
+  tracker->RecordAllocation(MemoryType::kHostLocal, 32, g);
+  tracker->RecordFree(MemoryType::kHostLocal, 8, g);
+
+  auto statistics = tracker->statistics();
+  ASSERT_EQ(2, statistics.tags.size());
+  EXPECT_EQ("g", statistics.tags[0].first);
+  EXPECT_EQ(32, statistics.tags[0].second.bytes_live);
+  EXPECT_EQ(40, statistics.tags[0].second.peak_bytes_live);
+  EXPECT_EQ(2, statistics.tags[0].second.allocation_count);
+  EXPECT_EQ("f", statistics.tags[1].first);
+  EXPECT_EQ(16, statistics.tags[1].second.bytes_live);
+}
+
+TEST(AllocationTrackerTest, ConcurrentRecording) {
+  auto tracker = make_ref<AllocationTracker>();
+  int tag = AllocationTracker::RegisterTag("concurrent");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&tracker, tag]() {
+      for (int j = 0; j < 1000; ++j) {
+        tracker->RecordAllocation(MemoryType::kHostLocal, 16, tag);
+        tracker->RecordFree(MemoryType::kHostLocal, 16, tag);
+      }
+      tracker->RecordAllocation(MemoryType::kHostLocal, 16, tag);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  auto statistics = tracker->statistics();
+  EXPECT_EQ(4 * 16, statistics.total.bytes_live);
+  EXPECT_EQ(4, statistics.total.live_allocation_count);
+  EXPECT_EQ(4 * 1001, statistics.total.allocation_count);
+  EXPECT_GE(statistics.total.peak_bytes_live, 4 * 16);
+  EXPECT_LE(statistics.total.peak_bytes_live, 2 * 4 * 16);
+  ASSERT_EQ(1, statistics.tags.size());
+  EXPECT_EQ(4 * 16, statistics.tags[0].second.bytes_live);
+}
+
+TEST(AllocationTagScopeTest, Nesting) {
+  EXPECT_EQ("", AllocationTagScope::current_tag());
+  EXPECT_EQ(-1, AllocationTagScope::current_tag_index());
+  {
+    AllocationTagScope outer("outer");
+    EXPECT_EQ("outer", AllocationTagScope::current_tag());
+    EXPECT_EQ(AllocationTracker::RegisterTag("outer"),
+              AllocationTagScope::current_tag_index());
+    {
+      AllocationTagScope inner("inner");
+      EXPECT_EQ("inner", AllocationTagScope::current_tag());
+      EXPECT_EQ(AllocationTracker::RegisterTag("inner"),
+                AllocationTagScope::current_tag_index());
+    }
+    EXPECT_EQ("outer", AllocationTagScope::current_tag());
+    EXPECT_EQ(AllocationTracker::RegisterTag("outer"),
+              AllocationTagScope::current_tag_index());
+  }
+  EXPECT_EQ("", AllocationTagScope::current_tag());
+  EXPECT_EQ(-1, AllocationTagScope::current_tag_index());
+}
+
+TEST(AllocatorStatisticsTest, Fragmentation) {
+  AllocatorStatistics statistics;
+  statistics.backing_bytes_reserved = 400;
+  statistics.backing_bytes_used = 100;
+  EXPECT_DOUBLE_EQ(0.75, statistics.fragmentation());
+}
+
+// The heap allocator is shared by the process so only deltas are checked.
+TEST(AllocatorStatisticsTest, HeapBuffers) {
+  auto* allocator = HeapBuffer::Allocate(BufferUsage::kAll, 1)->allocator();
+  auto before = allocator->statistics();
+  std::vector<uint8_t> host_data(64);
+  {
+    AllocationTagScope tag_scope("HeapBuffers");
+    auto buffer = HeapBuffer::Allocate(BufferUsage::kAll, 1024);
+    auto wrapped = HeapBuffer::Wrap(MemoryType::kHostLocal, BufferUsage::kAll,
+                                    absl::MakeConstSpan(host_data));
+    auto during = allocator->statistics();
+    EXPECT_EQ(before.total.bytes_live + 1024, during.total.bytes_live);
+    EXPECT_EQ(before.total.allocation_count + 1, during.total.allocation_count);
+    ASSERT_FALSE(during.tags.empty());
+    EXPECT_EQ("HeapBuffers", during.tags.back().first);
+    EXPECT_EQ(1024, during.tags.back().second.bytes_live);
+    EXPECT_GE(during.backing_bytes_reserved, during.backing_bytes_used);
+  }
+  auto after = allocator->statistics();
+  EXPECT_EQ(before.total.bytes_live, after.total.bytes_live);
+  EXPECT_EQ(0, after.tags.back().second.bytes_live);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
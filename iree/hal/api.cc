@@ -14,11 +14,14 @@
 
 #include "iree/hal/api.h"
 
+#include <cstring>
+
 #include "absl/types/span.h"
 #include "iree/base/api.h"
 #include "iree/base/api_util.h"
 #include "iree/base/shape.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/allocator.h"
 #include "iree/hal/api_detail.h"
 #include "iree/hal/buffer.h"
 #include "iree/hal/buffer_view.h"
@@ -109,6 +112,117 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_allocator_wrap_buffer(
   return IREE_STATUS_OK;
 }
 
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_wrap_buffer_with_release(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t buffer_usage, iree_byte_span_t data,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_TRACE_SCOPE0("iree_hal_allocator_wrap_buffer_with_release");
+  if (!out_buffer) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  *out_buffer = nullptr;
+  auto* handle = reinterpret_cast<Allocator*>(allocator);
+  if (!handle || !release_callback.release) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+
+  IREE_API_ASSIGN_OR_RETURN(
+      auto buffer,
+      handle->WrapMutableWithRelease(
+          static_cast<MemoryTypeBitfield>(memory_type),
+          static_cast<MemoryAccessBitfield>(allowed_access),
+          static_cast<BufferUsageBitfield>(buffer_usage), data.data,
+          data.data_length,
+          [release_callback, data]() {
+            release_callback.release(release_callback.self, data);
+          }));
+
+  *out_buffer = reinterpret_cast<iree_hal_buffer_t*>(buffer.release());
+  return IREE_STATUS_OK;
+}
+
+namespace {
+
+iree_hal_allocation_statistics_t ToApiAllocationStatistics(
+    const AllocationStatistics& statistics) {
+  iree_hal_allocation_statistics_t api_statistics;
+  api_statistics.bytes_live = statistics.bytes_live;
+  api_statistics.peak_bytes_live = statistics.peak_bytes_live;
+  api_statistics.live_allocation_count = statistics.live_allocation_count;
+  api_statistics.allocation_count = statistics.allocation_count;
+  return api_statistics;
+}
+
+}  // namespace
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_query_statistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  IREE_TRACE_SCOPE0("iree_hal_allocator_query_statistics");
+  if (!out_statistics) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  std::memset(out_statistics, 0, sizeof(*out_statistics));
+  auto* handle = reinterpret_cast<Allocator*>(allocator);
+  if (!handle) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+
+  auto statistics = handle->statistics();
+  out_statistics->total = ToApiAllocationStatistics(statistics.total);
+  out_statistics->backing_bytes_reserved = statistics.backing_bytes_reserved;
+  out_statistics->backing_bytes_used = statistics.backing_bytes_used;
+  out_statistics->fragmentation = statistics.fragmentation();
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_query_memory_type_statistics(
+    iree_hal_allocator_t* allocator, iree_host_size_t statistics_capacity,
+    iree_hal_memory_type_statistics_t* out_statistics,
+    iree_host_size_t* out_statistics_count) {
+  IREE_TRACE_SCOPE0("iree_hal_allocator_query_memory_type_statistics");
+  if (!out_statistics_count) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  *out_statistics_count = 0;
+  auto* handle = reinterpret_cast<Allocator*>(allocator);
+  if (!handle) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+
+  auto statistics = handle->statistics();
+  *out_statistics_count = statistics.memory_types.size();
+  if (!out_statistics) {
+    return IREE_STATUS_OK;
+  } else if (statistics_capacity < statistics.memory_types.size()) {
+    return IREE_STATUS_OUT_OF_RANGE;
+  }
+  for (int i = 0; i < statistics.memory_types.size(); ++i) {
+    const auto& memory_type = statistics.memory_types[i];
+    out_statistics[i].memory_type =
+        static_cast<iree_hal_memory_type_t>(memory_type.first);
+    out_statistics[i].statistics =
+        ToApiAllocationStatistics(memory_type.second);
+  }
+  return IREE_STATUS_OK;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_reset_peak_statistics(iree_hal_allocator_t* allocator) {
+  IREE_TRACE_SCOPE0("iree_hal_allocator_reset_peak_statistics");
+  auto* handle = reinterpret_cast<Allocator*>(allocator);
+  if (!handle) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  handle->ResetPeakStatistics();
+  return IREE_STATUS_OK;
+}
+
 //===----------------------------------------------------------------------===//
 // iree::hal::Buffer
 //===----------------------------------------------------------------------===//
@@ -365,7 +479,7 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
 
   if (!buffer) {
     return IREE_STATUS_INVALID_ARGUMENT;
-  } else if (shape.rank > kMaxRank || element_size <= 0) {
+  } else if (shape.rank > IREE_SHAPE_MAX_RANK || element_size <= 0) {
     return IREE_STATUS_OUT_OF_RANGE;
   }
 
@@ -274,6 +274,48 @@ typedef struct {
   iree_device_size_t length;
 } iree_hal_buffer_barrier_t;
 
+// Counters for a set of allocations made from an allocator.
+typedef struct {
+  // Bytes allocated and not yet freed.
+  int64_t bytes_live;
+  // High water mark of |bytes_live| since creation or the last peak reset.
+  int64_t peak_bytes_live;
+  // Allocations not yet freed.
+  int64_t live_allocation_count;
+  // Total number of allocations made.
+  int64_t allocation_count;
+} iree_hal_allocation_statistics_t;
+
+// Allocation statistics for the buffers allocated with a memory type.
+typedef struct {
+  iree_hal_memory_type_t memory_type;
+  iree_hal_allocation_statistics_t statistics;
+} iree_hal_memory_type_statistics_t;
+
+// A snapshot of the allocations made from an allocator.
+typedef struct {
+  // All allocations made from the allocator. Wrapped host memory is not
+  // counted.
+  iree_hal_allocation_statistics_t total;
+  // Bytes the backing memory (such as a memory pool or device heap) holds from
+  // the system, including blocks cached for reuse. 0 if unknown.
+  // Backing memory may be shared with other allocators.
+  iree_device_size_t backing_bytes_reserved;
+  // Bytes of |backing_bytes_reserved| in use by allocations.
+  iree_device_size_t backing_bytes_used;
+  // Fraction of |backing_bytes_reserved| not in use, in [0, 1].
+  double fragmentation;
+} iree_hal_allocator_statistics_t;
+
+// Releases host memory wrapped in a buffer once the buffer no longer
+// references it. May be called from any thread.
+typedef struct {
+  // User-defined pointer passed to |release|.
+  void* self;
+  // Called once with the wrapped |data|.
+  void(IREE_API_PTR* release)(void* self, iree_byte_span_t data);
+} iree_hal_buffer_release_callback_t;
+
 //===----------------------------------------------------------------------===//
 // iree::hal::Allocator
 //===----------------------------------------------------------------------===//
@@ -319,6 +361,48 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_allocator_wrap_buffer(
     iree_hal_buffer_usage_t buffer_usage, iree_byte_span_t data,
     iree_hal_buffer_t** out_buffer);
 
+// Wraps an existing host allocation in a buffer as with
+// iree_hal_allocator_wrap_buffer and calls |release_callback| once the buffer
+// has been destroyed. This allows the memory to be owned by code that cannot
+// otherwise observe how long the buffer is in use.
+//
+// Fails if the allocator cannot access host memory in this way, in which case
+// |release_callback| is not called and the caller retains ownership.
+// |out_buffer| must be released by the caller.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_wrap_buffer_with_release(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t buffer_usage, iree_byte_span_t data,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer);
+
+// Populates |out_statistics| with a snapshot of the allocations made from the
+// allocator.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_query_statistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_allocator_statistics_t* out_statistics);
+
+// Populates |out_statistics| with the allocation statistics of each memory type
+// allocated from the allocator.
+// |statistics_capacity| defines the number of elements available in
+// |out_statistics| and |out_statistics_count| will be set with the actual
+// number of memory types. If |statistics_capacity| is too small
+// IREE_STATUS_OUT_OF_RANGE will be returned with the required capacity in
+// |out_statistics_count|. To only query the required capacity |out_statistics|
+// may be passed as nullptr.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_query_memory_type_statistics(
+    iree_hal_allocator_t* allocator, iree_host_size_t statistics_capacity,
+    iree_hal_memory_type_statistics_t* out_statistics,
+    iree_host_size_t* out_statistics_count);
+
+// Resets the peak statistics of the allocator to the current live values, such
+// as between the phases of a benchmark.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_reset_peak_statistics(iree_hal_allocator_t* allocator);
+
 #endif  // IREE_API_NO_PROTOTYPES
 
 //===----------------------------------------------------------------------===//
@@ -232,6 +232,16 @@ Buffer::Buffer(Allocator* allocator, MemoryTypeBitfield memory_type,
 #endif  // HAS_IREE_BUFFER_DEBUG_NAME
 }
 
+Buffer::~Buffer() {
+  if (allocation_tracker_) {
+    allocation_tracker_->RecordFree(memory_type_, allocation_size_,
+                                    allocation_tag_index_);
+  }
+  if (release_callback_) {
+    release_callback_();
+  }
+}
+
 Buffer* Buffer::allocated_buffer() const noexcept {
   Buffer* allocated_buffer = allocated_buffer_;
   while (allocated_buffer != this &&
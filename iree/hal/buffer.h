@@ -54,6 +54,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -64,6 +65,7 @@
 #include "iree/base/logging.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
+#include "iree/hal/allocator_statistics.h"
 #include "iree/hal/resource.h"
 
 // Only enable debug names in non-opt modes (unless the user forces it on).
@@ -266,7 +268,7 @@ class Buffer : public Resource {
   Buffer(const Buffer&) = delete;
   Buffer& operator=(const Buffer&) = delete;
 
-  ~Buffer() override = default;
+  ~Buffer() override;
 
 #if HAS_IREE_BUFFER_DEBUG_NAME
   // Optionally populated name useful for logging a persistent name for the
@@ -602,6 +604,14 @@ class Buffer : public Resource {
 
   // Defined when this buffer is a subspan of another buffer.
   ref_ptr<Buffer> parent_buffer_;
+
+  // Set by Allocator::TrackAllocation so the free is recorded on destruction.
+  ref_ptr<AllocationTracker> allocation_tracker_;
+  int allocation_tag_index_ = -1;
+
+  // Set by Allocator::WrapMutableWithRelease to release the wrapped host
+  // memory once the buffer no longer references it.
+  std::function<void()> release_callback_;
 };
 
 // A memory mapping RAII object.
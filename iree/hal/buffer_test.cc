@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "iree/base/status_matchers.h"
+#include "iree/hal/allocator.h"
 #include "iree/hal/heap_buffer.h"
 #include "iree/testing/gtest.h"
 
@@ -63,6 +64,23 @@ TEST(BufferTest, AllocateZeroLength) {
   EXPECT_EQ(0, buffer->allocation_size());
 }
 
+TEST(BufferTest, AllocateUninitialized) {
+  auto buffer = HeapBuffer::AllocateUninitialized(
+      BufferUsage::kTransfer | BufferUsage::kMapping, 14);
+  EXPECT_NE(nullptr, buffer->allocator());
+  EXPECT_EQ(MemoryType::kHostLocal, buffer->memory_type());
+  EXPECT_EQ(BufferUsage::kTransfer | BufferUsage::kMapping, buffer->usage());
+  EXPECT_EQ(14, buffer->byte_length());
+
+  // Contents are undefined until written.
+  std::vector<uint8_t> src_data = {0, 1, 2,  3,  4,  5,  6,
+                                   7, 8, 9, 10, 11, 12, 13};
+  EXPECT_OK(buffer->WriteData(0, src_data.data(), src_data.size()));
+  std::vector<uint8_t> actual_data(src_data.size());
+  EXPECT_OK(buffer->ReadData(0, actual_data.data(), actual_data.size()));
+  EXPECT_THAT(actual_data, Eq(src_data));
+}
+
 TEST(BufferTest, AllocateCopy) {
   std::vector<uint8_t> src_data = {0, 1, 2, 3};
   auto buffer =
@@ -158,6 +176,27 @@ TEST(BufferTest, WrapMutable) {
   EXPECT_THAT(src_data, Eq(new_data));
 }
 
+TEST(BufferTest, WrapMutableWithRelease) {
+  auto* allocator = HeapBuffer::Allocate(BufferUsage::kAll, 1)->allocator();
+  std::vector<uint8_t> src_data = {0, 1, 2, 3};
+  int release_count = 0;
+  ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      allocator->WrapMutableWithRelease(
+          MemoryType::kHostLocal, MemoryAccess::kAll, BufferUsage::kAll,
+          src_data.data(), src_data.size(), [&]() { ++release_count; }));
+  std::vector<uint8_t> actual_data(src_data.size());
+  EXPECT_OK(buffer->ReadData(0, actual_data.data(), actual_data.size()));
+  EXPECT_THAT(actual_data, Eq(src_data));
+
+  // Subspans keep the wrapped memory referenced.
+  ASSERT_OK_AND_ASSIGN(auto subspan, Buffer::Subspan(buffer, 1, 2));
+  buffer.reset();
+  EXPECT_EQ(0, release_count);
+  subspan.reset();
+  EXPECT_EQ(1, release_count);
+}
+
 TEST(BufferTest, WrapExternal) {
   // This is not fully supported yet, but does let us verify that the validation
   // of memory types is working.
@@ -0,0 +1,194 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/buffer_view_file_util.h"
+
+#include <cstdint>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
+#include "iree/base/file_io.h"
+#include "iree/base/file_mapping.h"
+#include "iree/base/npy_file_util.h"
+#include "iree/base/source_location.h"
+#include "iree/hal/buffer_view_string_util.h"
+#include "iree/hal/heap_buffer.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+const MemoryTypeBitfield kFileMemoryType =
+    MemoryType::kHostLocal | MemoryType::kDeviceVisible;
+const BufferUsageBitfield kFileBufferUsage =
+    BufferUsage::kAll | BufferUsage::kConstant;
+
+// Returns a buffer containing |contents| from within |file_mapping|.
+// The mapped data is used in place if it is aligned to the element size and
+// copied otherwise; .npz archive members are only 1-byte aligned.
+StatusOr<ref_ptr<Buffer>> MakeFileBuffer(
+    const ref_ptr<FileMapping>& file_mapping,
+    absl::Span<const uint8_t> contents, int element_size,
+    Allocator* allocator) {
+  uintptr_t alignment = element_size & -element_size;
+  ref_ptr<Buffer> buffer;
+  if (reinterpret_cast<uintptr_t>(contents.data()) % alignment == 0) {
+    buffer = HeapBuffer::WrapMapping(
+        kFileMemoryType, kFileBufferUsage, add_ref(file_mapping),
+        contents.data() - file_mapping->data().data(), contents.size());
+  } else {
+    buffer = HeapBuffer::AllocateCopy(kFileBufferUsage, contents.data(),
+                                      contents.size());
+  }
+  if (allocator) {
+    return allocator->AllocateConstant(kFileBufferUsage, std::move(buffer));
+  }
+  return buffer;
+}
+
+}  // namespace
+
+bool IsNpyFilePath(absl::string_view path) {
+  return absl::EndsWith(path, ".npy") || absl::EndsWith(path, ".npz");
+}
+
+StatusOr<std::vector<BufferView>> LoadBufferViewsFromFile(
+    const std::string& path, Allocator* allocator) {
+  ASSIGN_OR_RETURN(auto file_mapping, FileMapping::OpenRead(path),
+                   _ << "while opening " << path);
+  auto file_data = file_mapping->data();
+  std::vector<NpyArray> arrays;
+  if (IsNpzFile(file_data)) {
+    ASSIGN_OR_RETURN(arrays, ParseNpzFile(file_data), _ << "in " << path);
+  } else {
+    ASSIGN_OR_RETURN(auto array, ParseNpyFile(file_data), _ << "in " << path);
+    arrays.push_back(std::move(array));
+  }
+
+  std::vector<BufferView> buffer_views;
+  buffer_views.reserve(arrays.size());
+  for (const auto& array : arrays) {
+    if (array.element_size > INT8_MAX) {
+      return UnimplementedErrorBuilder(IREE_LOC)
+             << "Element size " << array.element_size << " of array '"
+             << array.name << "' in " << path << " is too large";
+    }
+    ASSIGN_OR_RETURN(auto buffer,
+                     MakeFileBuffer(file_mapping, array.contents,
+                                    array.element_size, allocator));
+    buffer_views.emplace_back(std::move(buffer), array.shape,
+                              array.element_size);
+  }
+  return buffer_views;
+}
+
+StatusOr<BufferView> LoadRawBufferViewFromFile(
+    const std::string& path, absl::string_view shaped_type_str,
+    Allocator* allocator) {
+  auto str_parts = BufferStringParts::ExtractFrom(shaped_type_str);
+  BufferView result;
+  ASSIGN_OR_RETURN(result.element_size,
+                   ParseBufferTypeElementSize(str_parts.type_str));
+  ASSIGN_OR_RETURN(result.shape, ParseShape(str_parts.shape_str));
+
+  ASSIGN_OR_RETURN(auto file_mapping, FileMapping::OpenRead(path),
+                   _ << "while opening " << path);
+  auto file_data = file_mapping->data();
+  if (file_data.size() != result.byte_length()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << path << " has " << file_data.size() << " bytes but "
+           << shaped_type_str << " requires " << result.byte_length();
+  }
+  ASSIGN_OR_RETURN(result.buffer,
+                   MakeFileBuffer(file_mapping, file_data, result.element_size,
+                                  allocator));
+  return result;
+}
+
+StatusOr<std::vector<BufferView>> ParseBufferViewsFromSpec(
+    absl::string_view spec, Allocator* allocator) {
+  spec = absl::StripAsciiWhitespace(spec);
+  if (absl::ConsumePrefix(&spec, "@")) {
+    return LoadBufferViewsFromFile(std::string(spec), allocator);
+  }
+  auto equal_index = spec.find("=@");
+  if (equal_index != absl::string_view::npos) {
+    ASSIGN_OR_RETURN(auto buffer_view,
+                     LoadRawBufferViewFromFile(
+                         std::string(spec.substr(equal_index + 2)),
+                         spec.substr(0, equal_index), allocator));
+    return std::vector<BufferView>{std::move(buffer_view)};
+  }
+  ASSIGN_OR_RETURN(auto buffer_view,
+                   ParseBufferViewFromString(spec, allocator));
+  return std::vector<BufferView>{std::move(buffer_view)};
+}
+
+Status SaveBufferViewsToFile(
+    const std::string& path, absl::Span<const BufferView> buffer_views,
+    absl::Span<const BufferDataPrintMode> print_modes) {
+  if (!print_modes.empty() && print_modes.size() != buffer_views.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Expected " << buffer_views.size() << " print modes but got "
+           << print_modes.size();
+  }
+  bool is_npz = absl::EndsWith(path, ".npz");
+  if (!is_npz && buffer_views.size() != 1) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Only .npz files can hold " << buffer_views.size()
+           << " buffers (saving to " << path << ")";
+  }
+
+  // Mappings must outlive the arrays referencing them.
+  std::vector<MappedMemory<uint8_t>> mappings;
+  std::vector<NpyArray> arrays;
+  mappings.reserve(buffer_views.size());
+  arrays.reserve(buffer_views.size());
+  for (int i = 0; i < buffer_views.size(); ++i) {
+    const auto& buffer_view = buffer_views[i];
+    if (!buffer_view.buffer) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Buffer view " << i << " has no buffer";
+    }
+    auto print_mode = print_modes.empty() ? BufferDataPrintMode::kFloatingPoint
+                                          : print_modes[i];
+    NpyArray array;
+    array.shape = buffer_view.shape;
+    array.element_size = buffer_view.element_size;
+    array.type_str = MakeBufferTypeString(buffer_view.element_size, print_mode);
+    ASSIGN_OR_RETURN(auto mapping,
+                     buffer_view.buffer->MapMemory<uint8_t>(
+                         MemoryAccess::kRead, 0, buffer_view.byte_length()));
+    array.contents = mapping.contents();
+    mappings.push_back(std::move(mapping));
+    arrays.push_back(std::move(array));
+  }
+
+  std::string file_contents;
+  if (is_npz) {
+    RETURN_IF_ERROR(AppendNpzFile(arrays, &file_contents));
+  } else if (absl::EndsWith(path, ".npy")) {
+    RETURN_IF_ERROR(AppendNpyFile(arrays[0], &file_contents));
+  } else {
+    const auto& contents = arrays[0].contents;
+    file_contents.assign(reinterpret_cast<const char*>(contents.data()),
+                         contents.size());
+  }
+  return file_io::SetFileContents(path, file_contents);
+}
+
+}  // namespace hal
+}  // namespace iree
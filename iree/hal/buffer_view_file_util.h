@@ -0,0 +1,78 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Utilities for loading and saving BufferViews as binary files, avoiding the
+// cost of parsing and printing large tensors as text.
+//
+// Supported formats:
+//   .npy/.npz: NumPy arrays as written by np.save/np.savez (see
+//              iree/base/npy_file_util.h).
+//   raw:       row-major element data with no header; the shape and type are
+//              provided separately, as in `4x2xf32=@file.bin`.
+//
+// Input files are memory-mapped and array data that is suitably aligned is
+// used in place without copying.
+
+#ifndef IREE_HAL_BUFFER_VIEW_FILE_UTIL_H_
+#define IREE_HAL_BUFFER_VIEW_FILE_UTIL_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "iree/base/buffer_string_util.h"
+#include "iree/base/status.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer_view.h"
+
+namespace iree {
+namespace hal {
+
+// Returns true if |path| has a .npy or .npz extension.
+bool IsNpyFilePath(absl::string_view path);
+
+// Loads all arrays in a .npy file or .npz archive at |path|.
+// If an |allocator| is provided the buffers will be allocated as constants
+// from it, which may copy the data if the device cannot use the mapped file
+// directly. Otherwise, buffers will be host-local.
+StatusOr<std::vector<BufferView>> LoadBufferViewsFromFile(
+    const std::string& path, Allocator* allocator = nullptr);
+
+// Loads a raw file at |path| containing exactly the data of a buffer of the
+// given shape and type (for example `4x2xf32`).
+StatusOr<BufferView> LoadRawBufferViewFromFile(
+    const std::string& path, absl::string_view shaped_type_str,
+    Allocator* allocator = nullptr);
+
+// Parses one input specification into zero or more BufferViews:
+//   @file.npy or @file.npz     loads all arrays in the file.
+//   [shape]x[type]=@file       loads a raw file.
+//   anything else              parsed by ParseBufferViewFromString.
+StatusOr<std::vector<BufferView>> ParseBufferViewsFromSpec(
+    absl::string_view spec, Allocator* allocator = nullptr);
+
+// Saves |buffer_views| to |path|. Paths ending in .npz produce an archive of
+// arrays named arr_0, arr_1, etc. Otherwise exactly one buffer view must be
+// provided and is written as .npy if the path ends in .npy or as raw data.
+// |print_modes| gives the element type of each buffer view; if empty all
+// types are floating point.
+Status SaveBufferViewsToFile(const std::string& path,
+                             absl::Span<const BufferView> buffer_views,
+                             absl::Span<const BufferDataPrintMode> print_modes);
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_BUFFER_VIEW_FILE_UTIL_H_
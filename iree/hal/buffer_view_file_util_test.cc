@@ -0,0 +1,123 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/buffer_view_file_util.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "iree/base/file_io.h"
+#include "iree/base/file_path.h"
+#include "iree/base/status.h"
+#include "iree/base/status_matchers.h"
+#include "iree/hal/buffer_view_string_util.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::ElementsAre;
+
+template <typename T>
+StatusOr<std::vector<T>> ReadBuffer(const ref_ptr<Buffer>& buffer) {
+  std::vector<T> result;
+  result.resize(buffer->byte_length() / sizeof(T));
+  RETURN_IF_ERROR(
+      buffer->ReadData(0, result.data(), result.size() * sizeof(T)));
+  return result;
+}
+
+std::string TempPath(absl::string_view file_name) {
+  return file_path::JoinPaths(::testing::TempDir(), file_name);
+}
+
+TEST(BufferViewFileUtilTest, RoundTripNpy) {
+  ASSERT_OK_AND_ASSIGN(auto buffer_view,
+                       ParseBufferViewFromString("2x3xi32=1 2 3 4 5 6"));
+  auto path = TempPath("round_trip.npy");
+  ASSERT_OK(SaveBufferViewsToFile(path, {buffer_view},
+                                  {BufferDataPrintMode::kSignedInteger}));
+
+  ASSERT_OK_AND_ASSIGN(auto loaded, LoadBufferViewsFromFile(path));
+  ASSERT_EQ(1, loaded.size());
+  EXPECT_EQ(Shape({2, 3}), loaded[0].shape);
+  EXPECT_EQ(4, loaded[0].element_size);
+  EXPECT_THAT(ReadBuffer<int32_t>(loaded[0].buffer).ValueOrDie(),
+              ElementsAre(1, 2, 3, 4, 5, 6));
+}
+
+TEST(BufferViewFileUtilTest, RoundTripNpz) {
+  ASSERT_OK_AND_ASSIGN(auto buffer_view_0,
+                       ParseBufferViewFromString("2xf32=1.5 2.5"));
+  ASSERT_OK_AND_ASSIGN(auto buffer_view_1,
+                       ParseBufferViewFromString("3xi8=-1 0 1"));
+  auto path = TempPath("round_trip.npz");
+  ASSERT_OK(SaveBufferViewsToFile(path, {buffer_view_0, buffer_view_1},
+                                  {BufferDataPrintMode::kFloatingPoint,
+                                   BufferDataPrintMode::kSignedInteger}));
+
+  // Spec parsing loads every array in the archive.
+  ASSERT_OK_AND_ASSIGN(auto loaded, ParseBufferViewsFromSpec("@" + path));
+  ASSERT_EQ(2, loaded.size());
+  EXPECT_EQ(Shape({2}), loaded[0].shape);
+  EXPECT_THAT(ReadBuffer<float>(loaded[0].buffer).ValueOrDie(),
+              ElementsAre(1.5f, 2.5f));
+  EXPECT_EQ(Shape({3}), loaded[1].shape);
+  EXPECT_THAT(ReadBuffer<int8_t>(loaded[1].buffer).ValueOrDie(),
+              ElementsAre(-1, 0, 1));
+
+  // Multiple buffers require an archive.
+  EXPECT_FALSE(SaveBufferViewsToFile(TempPath("multiple.npy"),
+                                     {buffer_view_0, buffer_view_1}, {})
+                   .ok());
+}
+
+TEST(BufferViewFileUtilTest, RawFiles) {
+  std::vector<uint16_t> data = {1, 2, 3, 4};
+  auto path = TempPath("raw.bin");
+  ASSERT_OK(file_io::SetFileContents(
+      path, absl::string_view(reinterpret_cast<const char*>(data.data()),
+                              data.size() * sizeof(uint16_t))));
+
+  ASSERT_OK_AND_ASSIGN(auto loaded,
+                       ParseBufferViewsFromSpec("2x2xu16=@" + path));
+  ASSERT_EQ(1, loaded.size());
+  EXPECT_EQ(Shape({2, 2}), loaded[0].shape);
+  EXPECT_EQ(2, loaded[0].element_size);
+  EXPECT_THAT(ReadBuffer<uint16_t>(loaded[0].buffer).ValueOrDie(),
+              ElementsAre(1, 2, 3, 4));
+
+  // The file size must match the shape.
+  EXPECT_FALSE(LoadRawBufferViewFromFile(path, "3xu16").ok());
+
+  auto out_path = TempPath("raw_out.bin");
+  ASSERT_OK(SaveBufferViewsToFile(out_path, loaded, {}));
+  ASSERT_OK_AND_ASSIGN(auto out_contents, file_io::GetFileContents(out_path));
+  EXPECT_EQ(data.size() * sizeof(uint16_t), out_contents.size());
+}
+
+TEST(BufferViewFileUtilTest, ParseTextSpec) {
+  ASSERT_OK_AND_ASSIGN(auto loaded, ParseBufferViewsFromSpec(" 2xi32=7 8\n"));
+  ASSERT_EQ(1, loaded.size());
+  EXPECT_THAT(ReadBuffer<int32_t>(loaded[0].buffer).ValueOrDie(),
+              ElementsAre(7, 8));
+
+  EXPECT_FALSE(ParseBufferViewsFromSpec("@missing_file.npy").ok());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,388 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of HAL overheads, the performance companion to the CTS.
+// Like the CTS tests every benchmark is registered once per available driver
+// and runs against the default device of the driver:
+//
+//   BM_Allocate/<driver>/<memory type>/<size>
+//   BM_RecordEmptyCommandBuffer/<driver>
+//   BM_SubmitEmptyCommandBuffer/<driver>: record, submit and fence wait.
+//   BM_FenceSignalToWake/<driver>: time from submitting a fence signal until a
+//       thread blocked on the fence wakes.
+//   BM_FillBuffer/<driver>/<size>, BM_CopyBuffer/<driver>/<size>
+//   BM_Dispatch/<driver>/<binding count>: per-dispatch cost of a command
+//       buffer with many small dispatches.
+//
+// Benchmarks unsupported by a driver are reported as skipped with the error.
+
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/flatbuffer_util.h"
+#include "iree/base/init.h"
+#include "iree/base/logging.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/command_buffer.h"
+#include "iree/hal/command_queue.h"
+#include "iree/hal/cts/hal_benchmark_module.h"
+#include "iree/hal/device.h"
+#include "iree/hal/driver_registry.h"
+#include "iree/hal/executable_cache.h"
+#include "iree/schemas/module_def_generated.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+namespace {
+
+using ModuleFile = FlatBufferFile<ModuleDef>;
+
+// Number of dispatches recorded into each command buffer by BM_Dispatch.
+constexpr int kDispatchesPerSubmission = 64;
+
+// Reports a failed benchmark as skipped, such as when unsupported by a driver.
+void SkipOnError(benchmark::State& state, Status status) {
+  if (!status.ok()) state.SkipWithError(status.ToString().c_str());
+}
+
+CommandQueue* GetDispatchQueue(Device* device) {
+  CHECK(!device->dispatch_queues().empty());
+  return device->dispatch_queues().front();
+}
+
+// Submits |command_buffer| (if any) signaling |fence| to |value| and waits
+// for it to complete.
+Status SubmitAndWait(Device* device, CommandBuffer* command_buffer,
+                     Fence* fence, uint64_t value) {
+  SubmissionBatch batch;
+  if (command_buffer) batch.command_buffers = {&command_buffer, 1};
+  RETURN_IF_ERROR(GetDispatchQueue(device)->Submit(batch, {fence, value}));
+  return device->WaitAllFences({{fence, value}}, absl::InfiniteFuture());
+}
+
+Status AllocateBenchmark(benchmark::State& state, Device* device,
+                         MemoryTypeBitfield memory_type) {
+  device_size_t size = state.range(0);
+  const BufferUsageBitfield usage =
+      BufferUsage::kTransfer | BufferUsage::kDispatch;
+  if (!device->allocator()->CanAllocate(memory_type, usage, size)) {
+    return UnavailableErrorBuilder(IREE_LOC)
+           << "Allocator cannot allocate " << MemoryTypeString(memory_type);
+  }
+  for (auto _ : state) {
+    ASSIGN_OR_RETURN(auto buffer,
+                     device->allocator()->Allocate(memory_type, usage, size));
+    benchmark::DoNotOptimize(buffer);
+  }
+  state.SetItemsProcessed(state.iterations());
+  return OkStatus();
+}
+
+Status RecordEmptyCommandBufferBenchmark(benchmark::State& state,
+                                         Device* device) {
+  for (auto _ : state) {
+    ASSIGN_OR_RETURN(auto command_buffer,
+                     device->CreateCommandBuffer(CommandBufferMode::kOneShot,
+                                                 CommandCategory::kDispatch));
+    RETURN_IF_ERROR(command_buffer->Begin());
+    RETURN_IF_ERROR(command_buffer->End());
+  }
+  return OkStatus();
+}
+
+Status SubmitEmptyCommandBufferBenchmark(benchmark::State& state,
+                                         Device* device) {
+  ASSIGN_OR_RETURN(auto fence, device->CreateFence(0u));
+  uint64_t fence_value = 0;
+  for (auto _ : state) {
+    ASSIGN_OR_RETURN(auto command_buffer,
+                     device->CreateCommandBuffer(CommandBufferMode::kOneShot,
+                                                 CommandCategory::kDispatch));
+    RETURN_IF_ERROR(command_buffer->Begin());
+    RETURN_IF_ERROR(command_buffer->End());
+    RETURN_IF_ERROR(SubmitAndWait(device, command_buffer.get(), fence.get(),
+                                  ++fence_value));
+  }
+  return OkStatus();
+}
+
+// Measures with manual timing from just before an empty submission signaling
+// the fence until a thread already blocked in WaitAllFences returns.
+Status FenceSignalToWakeBenchmark(benchmark::State& state, Device* device) {
+  ASSIGN_OR_RETURN(auto fence, device->CreateFence(0u));
+  CommandQueue* queue = GetDispatchQueue(device);
+  uint64_t fence_value = 0;
+  for (auto _ : state) {
+    ++fence_value;
+    absl::Notification waiter_started;
+    int64_t wake_time_ns = 0;
+    Status wait_status;
+    std::thread waiter([&]() {
+      waiter_started.Notify();
+      wait_status = device->WaitAllFences({{fence.get(), fence_value}},
+                                          absl::InfiniteFuture());
+      wake_time_ns = absl::GetCurrentTimeNanos();
+    });
+    // Give the waiter time to block so that the wake up is measured instead of
+    // the fast path of an already signaled fence.
+    waiter_started.WaitForNotification();
+    absl::SleepFor(absl::Microseconds(200));
+
+    int64_t signal_time_ns = absl::GetCurrentTimeNanos();
+    Status submit_status =
+        queue->Submit(SubmissionBatch{}, {fence.get(), fence_value});
+    waiter.join();
+    RETURN_IF_ERROR(submit_status);
+    RETURN_IF_ERROR(wait_status);
+    state.SetIterationTime((wake_time_ns - signal_time_ns) / 1e9);
+  }
+  return OkStatus();
+}
+
+StatusOr<ref_ptr<Buffer>> AllocateTransferBuffer(Device* device,
+                                                 device_size_t size) {
+  return device->allocator()->Allocate(
+      MemoryType::kDeviceLocal, BufferUsage::kTransfer | BufferUsage::kDispatch,
+      size);
+}
+
+// Fills or copies state.range(0) bytes with one command per submission.
+Status TransferBenchmark(benchmark::State& state, Device* device, bool copy) {
+  device_size_t size = state.range(0);
+  ASSIGN_OR_RETURN(auto source_buffer, AllocateTransferBuffer(device, size));
+  ASSIGN_OR_RETURN(auto target_buffer, AllocateTransferBuffer(device, size));
+  ASSIGN_OR_RETURN(auto fence, device->CreateFence(0u));
+  uint64_t fence_value = 0;
+  const uint32_t pattern = 0x3F800000u;
+  for (auto _ : state) {
+    ASSIGN_OR_RETURN(auto command_buffer,
+                     device->CreateCommandBuffer(CommandBufferMode::kOneShot,
+                                                 CommandCategory::kTransfer));
+    RETURN_IF_ERROR(command_buffer->Begin());
+    if (copy) {
+      RETURN_IF_ERROR(command_buffer->CopyBuffer(
+          source_buffer.get(), 0, target_buffer.get(), 0, size));
+    } else {
+      RETURN_IF_ERROR(command_buffer->FillBuffer(target_buffer.get(), 0, size,
+                                                 &pattern, sizeof(pattern)));
+    }
+    RETURN_IF_ERROR(command_buffer->End());
+    RETURN_IF_ERROR(SubmitAndWait(device, command_buffer.get(), fence.get(),
+                                  ++fence_value));
+  }
+  // Copies read and write each byte.
+  state.SetBytesProcessed(state.iterations() * size * (copy ? 2 : 1));
+  return OkStatus();
+}
+
+// Loads the precompiled module file (from hal_benchmark.mlir).
+ref_ptr<ModuleFile> LoadModuleFile() {
+  const auto* file_toc = hal_benchmark_module_create();
+  return ModuleFile::WrapBuffer(
+             ModuleDefIdentifier(),
+             absl::MakeSpan(reinterpret_cast<const uint8_t*>(file_toc->data),
+                            file_toc->size))
+      .ValueOrDie();
+}
+
+// Prepares the executable of the bindings_N function in hal_benchmark.mlir.
+StatusOr<ref_ptr<Executable>> PrepareDispatchExecutable(
+    Device* device, ExecutableCache* executable_cache, int binding_count) {
+  static auto* module_file = LoadModuleFile().release();
+  std::string executable_name =
+      absl::StrCat("bindings_", binding_count, "_ex_dispatch_0");
+  for (const auto* multi_arch_executable_def :
+       *module_file->root()->executable_table()->multi_arch_executables()) {
+    if (WrapString(multi_arch_executable_def->name()) != executable_name) {
+      continue;
+    }
+    for (const auto* executable_def :
+         *multi_arch_executable_def->executables()) {
+      if (!executable_cache->CanPrepareFormat(executable_def->format())) {
+        continue;
+      }
+      ExecutableSpec spec;
+      spec.format = executable_def->format();
+      spec.executable_data = *executable_def->contents();
+      return executable_cache->PrepareExecutable(
+          ExecutableCachingMode::kDefault, spec);
+    }
+    return UnavailableErrorBuilder(IREE_LOC)
+           << "No format of " << executable_name << " supported by "
+           << device->info().name();
+  }
+  return NotFoundErrorBuilder(IREE_LOC)
+         << "Executable " << executable_name << " not found";
+}
+
+// Records kDispatchesPerSubmission dispatches with state.range(0) bindings
+// into each command buffer and reports the cost per dispatch.
+Status DispatchBenchmark(benchmark::State& state, Device* device) {
+  int binding_count = state.range(0);
+  auto executable_cache = device->CreateExecutableCache();
+  ASSIGN_OR_RETURN(auto executable,
+                   PrepareDispatchExecutable(device, executable_cache.get(),
+                                             binding_count));
+  std::vector<ref_ptr<Buffer>> buffers;
+  std::vector<BufferBinding> bindings;
+  for (int i = 0; i < binding_count; ++i) {
+    ASSIGN_OR_RETURN(auto buffer,
+                     device->allocator()->Allocate(
+                         MemoryType::kHostLocal | MemoryType::kDeviceVisible,
+                         BufferUsage::kAll, 4 * sizeof(float)));
+    RETURN_IF_ERROR(buffer->Fill32(1.0f));
+    bool is_output = i == binding_count - 1;
+    bindings.push_back(BufferBinding(
+        is_output ? MemoryAccess::kDiscardWrite : MemoryAccess::kRead,
+        buffer.get(), Shape{4}, sizeof(float)));
+    buffers.push_back(std::move(buffer));
+  }
+  DispatchRequest dispatch_request;
+  dispatch_request.executable = executable.get();
+  dispatch_request.entry_point = 0;
+  dispatch_request.workload = {4, 1, 1};
+  dispatch_request.bindings = bindings;
+
+  ASSIGN_OR_RETURN(auto fence, device->CreateFence(0u));
+  uint64_t fence_value = 0;
+  for (auto _ : state) {
+    ASSIGN_OR_RETURN(auto command_buffer,
+                     device->CreateCommandBuffer(CommandBufferMode::kOneShot,
+                                                 CommandCategory::kDispatch));
+    RETURN_IF_ERROR(command_buffer->Begin());
+    for (int i = 0; i < kDispatchesPerSubmission; ++i) {
+      RETURN_IF_ERROR(command_buffer->Dispatch(dispatch_request));
+    }
+    RETURN_IF_ERROR(command_buffer->End());
+    RETURN_IF_ERROR(SubmitAndWait(device, command_buffer.get(), fence.get(),
+                                  ++fence_value));
+  }
+  state.SetItemsProcessed(state.iterations() * kDispatchesPerSubmission);
+  return OkStatus();
+}
+
+// Devices are created once per driver and live until exit.
+void RegisterDeviceBenchmarks(const std::string& driver_name, Device* device) {
+  auto name = [&](absl::string_view benchmark_name) {
+    return absl::StrCat(benchmark_name, "/", driver_name);
+  };
+
+  struct MemoryTypeVariant {
+    const char* name;
+    MemoryTypeBitfield memory_type;
+  };
+  const MemoryTypeVariant memory_type_variants[] = {
+      {"host_local", MemoryType::kHostLocal | MemoryType::kDeviceVisible},
+      {"device_local", MemoryType::kDeviceLocal},
+  };
+  for (const auto& variant : memory_type_variants) {
+    MemoryTypeBitfield memory_type = variant.memory_type;
+    benchmark::RegisterBenchmark(
+        absl::StrCat(name("BM_Allocate"), "/", variant.name).c_str(),
+        [device, memory_type](benchmark::State& state) {
+          SkipOnError(state, AllocateBenchmark(state, device, memory_type));
+        })
+        ->RangeMultiplier(16)
+        ->Range(256, 64 << 20);
+  }
+
+  benchmark::RegisterBenchmark(
+      name("BM_RecordEmptyCommandBuffer").c_str(),
+      [device](benchmark::State& state) {
+        SkipOnError(state, RecordEmptyCommandBufferBenchmark(state, device));
+      });
+  benchmark::RegisterBenchmark(
+      name("BM_SubmitEmptyCommandBuffer").c_str(),
+      [device](benchmark::State& state) {
+        SkipOnError(state, SubmitEmptyCommandBufferBenchmark(state, device));
+      })
+      ->UseRealTime();
+  benchmark::RegisterBenchmark(
+      name("BM_FenceSignalToWake").c_str(),
+      [device](benchmark::State& state) {
+        SkipOnError(state, FenceSignalToWakeBenchmark(state, device));
+      })
+      ->UseManualTime();
+
+  for (bool copy : {false, true}) {
+    benchmark::RegisterBenchmark(
+        name(copy ? "BM_CopyBuffer" : "BM_FillBuffer").c_str(),
+        [device, copy](benchmark::State& state) {
+          SkipOnError(state, TransferBenchmark(state, device, copy));
+        })
+        ->RangeMultiplier(16)
+        ->Range(4 << 10, 64 << 20)
+        ->UseRealTime();
+  }
+
+  benchmark::RegisterBenchmark(
+      name("BM_Dispatch").c_str(),
+      [device](benchmark::State& state) {
+        SkipOnError(state, DispatchBenchmark(state, device));
+      })
+      ->Arg(2)
+      ->Arg(4)
+      ->Arg(8)
+      ->Arg(16)
+      ->UseRealTime();
+}
+
+void RegisterAllDriverBenchmarks() {
+  static auto* drivers = new std::vector<ref_ptr<Driver>>();
+  static auto* devices = new std::vector<ref_ptr<Device>>();
+  for (const auto& driver_name :
+       DriverRegistry::shared_registry()->EnumerateAvailableDrivers()) {
+    auto driver_or = DriverRegistry::shared_registry()->Create(driver_name);
+    if (!driver_or.ok()) {
+      LOG(WARNING) << "Skipping driver '" << driver_name
+                   << "': " << driver_or.status();
+      continue;
+    }
+    drivers->push_back(std::move(driver_or).ValueOrDie());
+    auto device_or = drivers->back()->CreateDefaultDevice();
+    if (!device_or.ok()) {
+      LOG(WARNING) << "Skipping driver '" << driver_name
+                   << "' with no default device: " << device_or.status();
+      continue;
+    }
+    devices->push_back(std::move(device_or).ValueOrDie());
+    RegisterDeviceBenchmarks(driver_name, devices->back().get());
+  }
+}
+
+}  // namespace
+}  // namespace cts
+}  // namespace hal
+
+extern "C" int main(int argc, char** argv) {
+  // Benchmark flags must be consumed before InitializeEnvironment parses the
+  // remaining flags. Drivers are registered by InitializeEnvironment so the
+  // benchmarks are registered afterwards.
+  ::benchmark::Initialize(&argc, argv);
+  InitializeEnvironment(&argc, &argv);
+  hal::cts::RegisterAllDriverBenchmarks();
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
+
+}  // namespace iree
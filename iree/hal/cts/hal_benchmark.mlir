@@ -0,0 +1,46 @@
+// Executables used by hal_benchmark to measure dispatch overhead. Each
+// bindings_N function is a single elementwise dispatch with N bindings (N - 1
+// inputs and one output).
+
+func @bindings_2(%arg0: tensor<4xf32>) -> tensor<4xf32>
+    attributes { iree.module.export } {
+  %0 = "xla_hlo.abs"(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+
+func @bindings_4(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>, %arg2: tensor<4xf32>) -> tensor<4xf32>
+    attributes { iree.module.export } {
+  %0 = "xla_hlo.add"(%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "xla_hlo.add"(%0, %arg2) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %1 : tensor<4xf32>
+}
+
+func @bindings_8(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>, %arg2: tensor<4xf32>, %arg3: tensor<4xf32>, %arg4: tensor<4xf32>, %arg5: tensor<4xf32>, %arg6: tensor<4xf32>) -> tensor<4xf32>
+    attributes { iree.module.export } {
+  %0 = "xla_hlo.add"(%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "xla_hlo.add"(%0, %arg2) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %2 = "xla_hlo.add"(%1, %arg3) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %3 = "xla_hlo.add"(%2, %arg4) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %4 = "xla_hlo.add"(%3, %arg5) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %5 = "xla_hlo.add"(%4, %arg6) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %5 : tensor<4xf32>
+}
+
+func @bindings_16(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>, %arg2: tensor<4xf32>, %arg3: tensor<4xf32>, %arg4: tensor<4xf32>, %arg5: tensor<4xf32>, %arg6: tensor<4xf32>, %arg7: tensor<4xf32>, %arg8: tensor<4xf32>, %arg9: tensor<4xf32>, %arg10: tensor<4xf32>, %arg11: tensor<4xf32>, %arg12: tensor<4xf32>, %arg13: tensor<4xf32>, %arg14: tensor<4xf32>) -> tensor<4xf32>
+    attributes { iree.module.export } {
+  %0 = "xla_hlo.add"(%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "xla_hlo.add"(%0, %arg2) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %2 = "xla_hlo.add"(%1, %arg3) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %3 = "xla_hlo.add"(%2, %arg4) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %4 = "xla_hlo.add"(%3, %arg5) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %5 = "xla_hlo.add"(%4, %arg6) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %6 = "xla_hlo.add"(%5, %arg7) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %7 = "xla_hlo.add"(%6, %arg8) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %8 = "xla_hlo.add"(%7, %arg9) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %9 = "xla_hlo.add"(%8, %arg10) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %10 = "xla_hlo.add"(%9, %arg11) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %11 = "xla_hlo.add"(%10, %arg12) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %12 = "xla_hlo.add"(%11, %arg13) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %13 = "xla_hlo.add"(%12, %arg14) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %13 : tensor<4xf32>
+}
@@ -26,6 +26,7 @@
 #include "iree/hal/buffer.h"
 #include "iree/hal/command_queue.h"
 #include "iree/hal/device_info.h"
+#include "iree/hal/dispatch_profile.h"
 #include "iree/hal/event.h"
 #include "iree/hal/executable_cache.h"
 #include "iree/hal/semaphore.h"
@@ -75,6 +76,11 @@ class Device : public RefObject<Device> {
   // using the cache are no longer in-flight.
   virtual ref_ptr<ExecutableCache> CreateExecutableCache() = 0;
 
+  // Returns the profile populated by dispatches of executables prepared with
+  // ExecutableCachingMode::kEnableProfiling or nullptr if the device is not
+  // profiling dispatches.
+  virtual DispatchProfile* dispatch_profile() const { return nullptr; }
+
   // Creates a command buffer for recording commands to submit to queues owned
   // by this device. The command buffer may come from a pool but will be reset
   // prior to being returned to the caller.
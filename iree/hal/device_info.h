@@ -64,10 +64,11 @@ using DeviceFeatureBitfield = DeviceFeature;
 class DeviceInfo {
  public:
   DeviceInfo(std::string name, DeviceFeatureBitfield supported_features,
-             DriverDeviceID device_id = 0)
+             DriverDeviceID device_id = 0, int numa_node = -1)
       : name_(std::move(name)),
         supported_features_(supported_features),
-        device_id_(device_id) {}
+        device_id_(device_id),
+        numa_node_(numa_node) {}
 
   const std::string& name() const { return name_; }
 
@@ -81,10 +82,16 @@ class DeviceInfo {
   // of the current process.
   DriverDeviceID device_id() const { return device_id_; }
 
+  // Host NUMA node the device is local to, or -1 if it has no affinity.
+  // Host devices bound to a node allocate memory from and run their threads on
+  // that node; PlacementSpec can use this to keep work near its data.
+  int numa_node() const { return numa_node_; }
+
  private:
   const std::string name_;
   const DeviceFeatureBitfield supported_features_;
   DriverDeviceID device_id_;
+  int numa_node_;
 };
 
 }  // namespace hal
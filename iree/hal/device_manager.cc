@@ -20,6 +20,7 @@
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/heap_buffer.h"
+#include "iree/hal/host/numa_topology.h"
 
 namespace iree {
 namespace hal {
@@ -64,11 +65,21 @@ StatusOr<DevicePlacement> DeviceManager::ResolvePlacement(
     return NotFoundErrorBuilder(IREE_LOC) << "No devices registered";
   }
 
-  // TODO(benvanik): multiple devices and placement.
-  QCHECK_EQ(devices_.size(), 1)
-      << "Multiple devices not yet supported (need placement)";
+  // TODO(benvanik): filter by available_formats and features.
+  // Prefer a device on the requested (or current) NUMA node and otherwise fall
+  // back to the first registered device.
+  int numa_node = placement_spec.numa_node >= 0 ? placement_spec.numa_node
+                                                : GetCurrentNumaNode();
   DevicePlacement device_placement;
   device_placement.device = devices_.front().get();
+  if (numa_node >= 0) {
+    for (const auto& device : devices_) {
+      if (device->info().numa_node() == numa_node) {
+        device_placement.device = device.get();
+        break;
+      }
+    }
+  }
 
   return device_placement;
 }
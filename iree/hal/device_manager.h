@@ -44,6 +44,12 @@ struct PlacementSpec {
   // will be considered for placement. The formats can be sorted in descending
   // priority order to prefer the first available format in the case of ties.
   absl::Span<const ExecutableFormat> available_formats;
+
+  // Preferred host NUMA node of the device (see DeviceInfo::numa_node).
+  // When -1 the node the calling thread is running on is preferred so that
+  // contexts created on pinned threads use their local device. Devices on
+  // other nodes are only chosen if no device on the preferred node exists.
+  int numa_node = -1;
 };
 
 // Manages device lifetime and placement resolution.
@@ -0,0 +1,121 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/dispatch_profile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+double PerKilo(int64_t count, int64_t instructions) {
+  if (instructions <= 0) return 0.0;
+  return 1000.0 * static_cast<double>(count) / instructions;
+}
+
+}  // namespace
+
+DispatchCounters& DispatchCounters::operator+=(const DispatchCounters& other) {
+  dispatch_count += other.dispatch_count;
+  duration += other.duration;
+  cycles += other.cycles;
+  instructions += other.instructions;
+  llc_misses += other.llc_misses;
+  branch_misses += other.branch_misses;
+  return *this;
+}
+
+double DispatchCounters::instructions_per_cycle() const {
+  if (cycles <= 0) return 0.0;
+  return static_cast<double>(instructions) / cycles;
+}
+
+double DispatchCounters::llc_misses_per_kilo_instruction() const {
+  return PerKilo(llc_misses, instructions);
+}
+
+double DispatchCounters::branch_misses_per_kilo_instruction() const {
+  return PerKilo(branch_misses, instructions);
+}
+
+void DispatchProfile::Record(absl::string_view entry_point_name,
+                             const DispatchCounters& counters) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entry_point_indices_.find(entry_point_name);
+  if (it == entry_point_indices_.end()) {
+    it = entry_point_indices_
+             .emplace(std::string(entry_point_name), entry_points_.size())
+             .first;
+    entry_points_.emplace_back(std::string(entry_point_name),
+                               DispatchCounters{});
+  }
+  entry_points_[it->second].second += counters;
+}
+
+std::vector<std::pair<std::string, DispatchCounters>>
+DispatchProfile::entry_points() const {
+  absl::MutexLock lock(&mutex_);
+  return entry_points_;
+}
+
+void DispatchProfile::Reset() {
+  absl::MutexLock lock(&mutex_);
+  entry_points_.clear();
+  entry_point_indices_.clear();
+}
+
+std::string FormatDispatchProfile(const DispatchProfile& profile) {
+  auto entry_points = profile.entry_points();
+  std::stable_sort(entry_points.begin(), entry_points.end(),
+                   [](const std::pair<std::string, DispatchCounters>& lhs,
+                      const std::pair<std::string, DispatchCounters>& rhs) {
+                     return lhs.second.duration > rhs.second.duration;
+                   });
+
+  size_t name_width = 11;
+  for (const auto& entry_point : entry_points) {
+    name_width = std::max(name_width, entry_point.first.size());
+  }
+
+  std::ostringstream stream;
+  stream << std::left << std::setw(name_width) << "entry point" << std::right
+         << std::setw(10) << "count" << std::setw(12) << "total ms"
+         << std::setw(12) << "mean us" << std::setw(8) << "IPC"
+         << std::setw(10) << "LLC MPKI" << std::setw(10) << "BR MPKI"
+         << "\n";
+  stream << std::fixed;
+  for (const auto& entry_point : entry_points) {
+    const auto& counters = entry_point.second;
+    double total_ms = absl::ToDoubleMilliseconds(counters.duration);
+    double mean_us = counters.dispatch_count > 0
+                         ? absl::ToDoubleMicroseconds(counters.duration) /
+                               counters.dispatch_count
+                         : 0.0;
+    stream << std::left << std::setw(name_width) << entry_point.first
+           << std::right << std::setw(10) << counters.dispatch_count
+           << std::setprecision(3) << std::setw(12) << total_ms
+           << std::setw(12) << mean_us << std::setprecision(2) << std::setw(8)
+           << counters.instructions_per_cycle() << std::setw(10)
+           << counters.llc_misses_per_kilo_instruction() << std::setw(10)
+           << counters.branch_misses_per_kilo_instruction() << "\n";
+  }
+  return stream.str();
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,97 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_DISPATCH_PROFILE_H_
+#define IREE_HAL_DISPATCH_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace iree {
+namespace hal {
+
+// Measurements accumulated over one or more dispatches.
+// Hardware counters are 0 when the device is unable to read them.
+struct DispatchCounters {
+  int64_t dispatch_count = 0;
+  // Wall time spent executing the dispatches.
+  absl::Duration duration;
+  // CPU cycles.
+  int64_t cycles = 0;
+  // Retired instructions.
+  int64_t instructions = 0;
+  // Last-level cache misses.
+  int64_t llc_misses = 0;
+  // Mispredicted branches.
+  int64_t branch_misses = 0;
+
+  DispatchCounters& operator+=(const DispatchCounters& other);
+
+  // Retired instructions per cycle or 0 if cycles are unavailable.
+  double instructions_per_cycle() const;
+  // Last-level cache misses per thousand instructions or 0 if instructions
+  // are unavailable.
+  double llc_misses_per_kilo_instruction() const;
+  // Branch misses per thousand instructions or 0 if instructions are
+  // unavailable.
+  double branch_misses_per_kilo_instruction() const;
+};
+
+// Aggregates dispatch measurements by executable entry point.
+// Devices populate the profile for dispatches of executables prepared with
+// ExecutableCachingMode::kEnableProfiling.
+//
+// Thread-safe.
+class DispatchProfile {
+ public:
+  DispatchProfile() = default;
+  DispatchProfile(const DispatchProfile&) = delete;
+  DispatchProfile& operator=(const DispatchProfile&) = delete;
+
+  // Adds |counters| to the totals of |entry_point_name|.
+  void Record(absl::string_view entry_point_name,
+              const DispatchCounters& counters);
+
+  // Returns the totals of each entry point in the order first recorded.
+  std::vector<std::pair<std::string, DispatchCounters>> entry_points() const;
+
+  // Clears all recorded measurements.
+  void Reset();
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::vector<std::pair<std::string, DispatchCounters>> entry_points_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int> entry_point_indices_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Formats |profile| as a table with one row per entry point, sorted by total
+// time. Entry points with a low instructions per cycle and many last-level
+// cache misses are likely memory-bound while those with a high instructions
+// per cycle are likely compute-bound.
+std::string FormatDispatchProfile(const DispatchProfile& profile);
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_DISPATCH_PROFILE_H_
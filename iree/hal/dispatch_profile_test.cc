@@ -0,0 +1,84 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/dispatch_profile.h"
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::HasSubstr;
+
+DispatchCounters MakeCounters(int64_t duration_us, int64_t cycles,
+                              int64_t instructions, int64_t llc_misses) {
+  DispatchCounters counters;
+  counters.dispatch_count = 1;
+  counters.duration = absl::Microseconds(duration_us);
+  counters.cycles = cycles;
+  counters.instructions = instructions;
+  counters.llc_misses = llc_misses;
+  return counters;
+}
+
+TEST(DispatchCountersTest, Ratios) {
+  DispatchCounters counters;
+  EXPECT_EQ(0.0, counters.instructions_per_cycle());
+  EXPECT_EQ(0.0, counters.llc_misses_per_kilo_instruction());
+
+  counters = MakeCounters(10, 1000, 2000, 40);
+  counters.branch_misses = 2;
+  EXPECT_DOUBLE_EQ(2.0, counters.instructions_per_cycle());
+  EXPECT_DOUBLE_EQ(20.0, counters.llc_misses_per_kilo_instruction());
+  EXPECT_DOUBLE_EQ(1.0, counters.branch_misses_per_kilo_instruction());
+}
+
+TEST(DispatchProfileTest, AggregatesByEntryPoint) {
+  DispatchProfile profile;
+  EXPECT_TRUE(profile.entry_points().empty());
+  profile.Record("a", MakeCounters(10, 100, 200, 1));
+  profile.Record("b", MakeCounters(5, 50, 50, 2));
+  profile.Record("a", MakeCounters(20, 300, 400, 3));
+
+  auto entry_points = profile.entry_points();
+  ASSERT_EQ(2, entry_points.size());
+  EXPECT_EQ("a", entry_points[0].first);
+  EXPECT_EQ(2, entry_points[0].second.dispatch_count);
+  EXPECT_EQ(absl::Microseconds(30), entry_points[0].second.duration);
+  EXPECT_EQ(400, entry_points[0].second.cycles);
+  EXPECT_EQ(600, entry_points[0].second.instructions);
+  EXPECT_EQ(4, entry_points[0].second.llc_misses);
+  EXPECT_EQ("b", entry_points[1].first);
+  EXPECT_EQ(1, entry_points[1].second.dispatch_count);
+
+  profile.Reset();
+  EXPECT_TRUE(profile.entry_points().empty());
+}
+
+TEST(DispatchProfileTest, Format) {
+  DispatchProfile profile;
+  profile.Record("fast", MakeCounters(1, 100, 400, 0));
+  profile.Record("slow_dispatch", MakeCounters(2000, 1000, 500, 50));
+  auto report = FormatDispatchProfile(profile);
+  EXPECT_THAT(report, HasSubstr("entry point"));
+  // Sorted by total time.
+  EXPECT_LT(report.find("slow_dispatch"), report.find("fast"));
+  EXPECT_THAT(report, HasSubstr("2.000"));
+  EXPECT_THAT(report, HasSubstr("100.00"));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -15,15 +15,16 @@
 #include "iree/hal/heap_buffer.h"
 
 #include <cstdint>
-#include <cstdlib>
 #include <string>
 #include <utility>
 
+#include "iree/base/logging.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/host/host_buffer.h"
+#include "iree/hal/host/host_memory_pool.h"
 
 namespace iree {
 namespace hal {
@@ -36,12 +37,11 @@ namespace {
 class HeapAllocator : public Allocator {
  public:
   // Returns a singleton heap allocator that can provide buffers that have
-  // MemoryType::kHostLocal and are allocated with malloc/free.
+  // MemoryType::kHostLocal and are allocated from the default HostMemoryPool.
   // These buffers will not be usable by devices directly and may incur
   // additional copies.
   static Allocator* std_heap();
 
-  // TODO(benvanik): specify custom allocator (not malloc/free).
   HeapAllocator();
   ~HeapAllocator() override;
 
@@ -58,11 +58,41 @@ class HeapAllocator : public Allocator {
                                      BufferUsageBitfield buffer_usage,
                                      size_t allocation_size) override;
 
+  StatusOr<ref_ptr<Buffer>> AllocateUninitialized(
+      MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+      size_t allocation_size) override;
+
   StatusOr<ref_ptr<Buffer>> WrapMutable(MemoryTypeBitfield memory_type,
                                         MemoryAccessBitfield allowed_access,
                                         BufferUsageBitfield buffer_usage,
                                         void* data,
                                         size_t data_length) override;
+
+  AllocatorStatistics statistics() const override;
+
+ private:
+  StatusOr<ref_ptr<Buffer>> AllocateInternal(MemoryTypeBitfield memory_type,
+                                             BufferUsageBitfield buffer_usage,
+                                             size_t allocation_size,
+                                             bool zero_fill);
+};
+
+// A host buffer referencing a file mapping that it keeps alive.
+class FileMappingBuffer final : public HostBuffer {
+ public:
+  FileMappingBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
+                    BufferUsageBitfield usage,
+                    ref_ptr<FileMapping> file_mapping, size_t data_offset,
+                    size_t data_length)
+      : HostBuffer(allocator, memory_type, MemoryAccess::kRead, usage,
+                   data_length,
+                   const_cast<uint8_t*>(file_mapping->data().data()) +
+                       data_offset,
+                   /*owns_data=*/false),
+        file_mapping_(std::move(file_mapping)) {}
+
+ private:
+  ref_ptr<FileMapping> file_mapping_;
 };
 
 // static
@@ -106,7 +136,29 @@ StatusOr<ref_ptr<Buffer>> HeapAllocator::Allocate(
     MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
     size_t allocation_size) {
   IREE_TRACE_SCOPE0("HeapAllocator::Allocate");
+  return AllocateInternal(memory_type, buffer_usage, allocation_size,
+                          /*zero_fill=*/true);
+}
+
+StatusOr<ref_ptr<Buffer>> HeapAllocator::AllocateUninitialized(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size) {
+  IREE_TRACE_SCOPE0("HeapAllocator::AllocateUninitialized");
+  return AllocateInternal(memory_type, buffer_usage, allocation_size,
+                          /*zero_fill=*/false);
+}
 
+AllocatorStatistics HeapAllocator::statistics() const {
+  auto statistics = Allocator::statistics();
+  auto pool_statistics = HostMemoryPool::Default()->statistics();
+  statistics.backing_bytes_reserved = pool_statistics.bytes_reserved;
+  statistics.backing_bytes_used = pool_statistics.bytes_allocated;
+  return statistics;
+}
+
+StatusOr<ref_ptr<Buffer>> HeapAllocator::AllocateInternal(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size, bool zero_fill) {
   if (!CanAllocate(memory_type, buffer_usage, allocation_size)) {
     return FailedPreconditionErrorBuilder(IREE_LOC)
            << "Allocation not supported; memory_type="
@@ -115,15 +167,14 @@ StatusOr<ref_ptr<Buffer>> HeapAllocator::Allocate(
            << ", allocation_size=" << allocation_size;
   }
 
-  void* malloced_data = std::calloc(1, allocation_size);
-  if (!malloced_data) {
-    return ResourceExhaustedErrorBuilder(IREE_LOC)
-           << "Failed to malloc " << allocation_size << " bytes";
-  }
+  auto* memory_pool = HostMemoryPool::Default();
+  ASSIGN_OR_RETURN(void* data,
+                   memory_pool->Allocate(allocation_size, zero_fill));
 
   auto buffer =
       make_ref<HostBuffer>(this, memory_type, MemoryAccess::kAll, buffer_usage,
-                           allocation_size, malloced_data, true);
+                           allocation_size, data, memory_pool);
+  TrackAllocation(buffer.get());
   return buffer;
 }
 
@@ -146,6 +197,15 @@ ref_ptr<Buffer> HeapBuffer::Allocate(MemoryTypeBitfield memory_type,
   return std::move(buffer_or.ValueOrDie());
 }
 
+// static
+ref_ptr<Buffer> HeapBuffer::AllocateUninitialized(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield usage,
+    size_t allocation_size) {
+  auto buffer_or = HeapAllocator::std_heap()->AllocateUninitialized(
+      memory_type, usage, allocation_size);
+  return std::move(buffer_or.ValueOrDie());
+}
+
 // static
 ref_ptr<Buffer> HeapBuffer::AllocateCopy(BufferUsageBitfield usage,
                                          const void* data, size_t data_length) {
@@ -159,8 +219,9 @@ ref_ptr<Buffer> HeapBuffer::AllocateCopy(BufferUsageBitfield usage,
   IREE_TRACE_SCOPE0("HeapBuffer::AllocateCopy");
   // Ensure we can map so that we can copy into it.
   usage |= BufferUsage::kMapping;
-  auto buffer_or = HeapAllocator::std_heap()->Allocate(MemoryType::kHostLocal,
-                                                       usage, data_length);
+  // The contents are fully overwritten below so skip zeroing them.
+  auto buffer_or = HeapAllocator::std_heap()->AllocateUninitialized(
+      MemoryType::kHostLocal, usage, data_length);
   auto buffer = std::move(buffer_or.ValueOrDie());
   buffer->WriteData(0, data, data_length).IgnoreError();
   buffer->set_allowed_access(allowed_access);
@@ -186,5 +247,17 @@ ref_ptr<Buffer> HeapBuffer::WrapMutable(MemoryTypeBitfield memory_type,
   return std::move(buffer_or.ValueOrDie());
 }
 
+// static
+ref_ptr<Buffer> HeapBuffer::WrapMapping(MemoryTypeBitfield memory_type,
+                                        BufferUsageBitfield usage,
+                                        ref_ptr<FileMapping> file_mapping,
+                                        size_t data_offset,
+                                        size_t data_length) {
+  CHECK_LE(data_offset + data_length, file_mapping->data().size());
+  return make_ref<FileMappingBuffer>(HeapAllocator::std_heap(), memory_type,
+                                     usage, std::move(file_mapping),
+                                     data_offset, data_length);
+}
+
 }  // namespace hal
 }  // namespace iree
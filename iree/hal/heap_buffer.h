@@ -17,20 +17,21 @@
 
 #include <memory>
 
+#include "iree/base/file_mapping.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer.h"
 
 namespace iree {
 namespace hal {
 
-// Factory for buffers that are allocated from the host heap (malloc/free).
+// Factory for buffers that are allocated from the host heap (HostMemoryPool).
 // These buffers cannot be used by devices and will incur copies/transfers when
 // used. Prefer device-specific allocators instead.
 class HeapBuffer {
  public:
   // Allocates a zeroed host heap buffer of the given size.
-  // Returns a buffer allocated with malloc and have MemoryType::kHostLocal
-  // and will not be usable by devices without copies.
+  // Returns a buffer allocated from the default HostMemoryPool and have
+  // MemoryType::kHostLocal and will not be usable by devices without copies.
   static ref_ptr<Buffer> Allocate(MemoryTypeBitfield memory_type,
                                   BufferUsageBitfield usage,
                                   size_t allocation_size);
@@ -39,6 +40,18 @@ class HeapBuffer {
     return Allocate(MemoryType::kHostLocal, usage, allocation_size);
   }
 
+  // Allocates a host heap buffer of the given size with undefined contents.
+  // Callers must write every byte before reading it.
+  // See Allocator::AllocateUninitialized.
+  static ref_ptr<Buffer> AllocateUninitialized(MemoryTypeBitfield memory_type,
+                                               BufferUsageBitfield usage,
+                                               size_t allocation_size);
+  static ref_ptr<Buffer> AllocateUninitialized(BufferUsageBitfield usage,
+                                               size_t allocation_size) {
+    return AllocateUninitialized(MemoryType::kHostLocal, usage,
+                                 allocation_size);
+  }
+
   // Allocates a host heap buffer with a copy of the given data.
   // Returns a buffer allocated with malloc and have MemoryType::kHostLocal
   // and will not be usable by devices without copies.
@@ -76,6 +89,14 @@ class HeapBuffer {
                                      MemoryAccessBitfield allowed_access,
                                      BufferUsageBitfield usage,
                                      absl::Span<T> data);
+
+  // Wraps |data_length| bytes at |data_offset| in a read-only file mapping in
+  // a buffer without copying. The buffer retains the mapping until it is
+  // destroyed.
+  static ref_ptr<Buffer> WrapMapping(MemoryTypeBitfield memory_type,
+                                     BufferUsageBitfield usage,
+                                     ref_ptr<FileMapping> file_mapping,
+                                     size_t data_offset, size_t data_length);
 };
 
 // Inline functions and template definitions follow:
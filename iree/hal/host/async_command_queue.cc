@@ -17,15 +17,18 @@
 #include "absl/base/thread_annotations.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/host/numa_topology.h"
 
 namespace iree {
 namespace hal {
 
-AsyncCommandQueue::AsyncCommandQueue(std::unique_ptr<CommandQueue> target_queue)
+AsyncCommandQueue::AsyncCommandQueue(std::unique_ptr<CommandQueue> target_queue,
+                                     absl::Span<const int> thread_cpu_ids)
     : CommandQueue(target_queue->name(), target_queue->supported_categories()),
       target_queue_(std::move(target_queue)) {
   IREE_TRACE_SCOPE0("AsyncCommandQueue::ctor");
   thread_ = std::thread([this]() { ThreadMain(); });
+  PinThreadToCpus(&thread_, thread_cpu_ids);
 }
 
 AsyncCommandQueue::~AsyncCommandQueue() {
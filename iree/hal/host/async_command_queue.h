@@ -20,6 +20,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "iree/hal/command_queue.h"
 #include "iree/hal/fence.h"
 #include "iree/hal/host/host_submission_queue.h"
@@ -41,7 +42,10 @@ namespace hal {
 // such a case depends entirely on the synchronization primitives provided.
 class AsyncCommandQueue final : public CommandQueue {
  public:
-  explicit AsyncCommandQueue(std::unique_ptr<CommandQueue> target_queue);
+  // The queue thread is pinned to |thread_cpu_ids| if any are provided, such
+  // as the CPUs of the NUMA node the target queue allocates from.
+  explicit AsyncCommandQueue(std::unique_ptr<CommandQueue> target_queue,
+                             absl::Span<const int> thread_cpu_ids = {});
   ~AsyncCommandQueue() override;
 
   Status Submit(absl::Span<const SubmissionBatch> batches,
@@ -36,8 +36,20 @@ HostBuffer::HostBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
       data_(data),
       owns_data_(owns_data) {}
 
+HostBuffer::HostBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
+                       MemoryAccessBitfield allowed_access,
+                       BufferUsageBitfield usage, device_size_t allocation_size,
+                       void* data, HostMemoryPool* memory_pool)
+    : Buffer(allocator, memory_type, allowed_access, usage, allocation_size, 0,
+             allocation_size),
+      data_(data),
+      memory_pool_(memory_pool) {}
+
 HostBuffer::~HostBuffer() {
-  if (owns_data_ && data_) {
+  if (memory_pool_ && data_) {
+    memory_pool_->Free(data_, allocation_size());
+    data_ = nullptr;
+  } else if (owns_data_ && data_) {
     std::free(data_);
     data_ = nullptr;
   }
@@ -19,6 +19,7 @@
 
 #include "iree/base/status.h"
 #include "iree/hal/buffer.h"
+#include "iree/hal/host/host_memory_pool.h"
 
 namespace iree {
 namespace hal {
@@ -32,6 +33,14 @@ class HostBuffer : public Buffer {
              MemoryAccessBitfield allowed_access, BufferUsageBitfield usage,
              device_size_t allocation_size, void* data, bool owns_data);
 
+  // Takes ownership of |data| allocated from |memory_pool| with a size of
+  // |allocation_size|. The memory is returned to the pool when the buffer is
+  // destroyed and the pool must outlive the buffer.
+  HostBuffer(Allocator* allocator, MemoryTypeBitfield memory_type,
+             MemoryAccessBitfield allowed_access, BufferUsageBitfield usage,
+             device_size_t allocation_size, void* data,
+             HostMemoryPool* memory_pool);
+
   ~HostBuffer() override;
 
  protected:
@@ -59,6 +68,7 @@ class HostBuffer : public Buffer {
  private:
   void* data_ = nullptr;
   bool owns_data_ = false;
+  HostMemoryPool* memory_pool_ = nullptr;
 };
 
 }  // namespace hal
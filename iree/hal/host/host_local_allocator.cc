@@ -14,7 +14,6 @@
 
 #include "iree/hal/host/host_local_allocator.h"
 
-#include <cstdlib>
 #include <string>
 #include <utility>
 
@@ -26,7 +25,11 @@
 namespace iree {
 namespace hal {
 
-HostLocalAllocator::HostLocalAllocator() = default;
+HostLocalAllocator::HostLocalAllocator()
+    : HostLocalAllocator(HostMemoryPool::Default()) {}
+
+HostLocalAllocator::HostLocalAllocator(HostMemoryPool* memory_pool)
+    : memory_pool_(memory_pool) {}
 
 HostLocalAllocator::~HostLocalAllocator() = default;
 
@@ -83,7 +86,44 @@ StatusOr<ref_ptr<Buffer>> HostLocalAllocator::Allocate(
     MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
     size_t allocation_size) {
   IREE_TRACE_SCOPE0("HostLocalAllocator::Allocate");
+  return AllocateInternal(memory_type, buffer_usage, allocation_size,
+                          /*zero_fill=*/true);
+}
+
+StatusOr<ref_ptr<Buffer>> HostLocalAllocator::AllocateUninitialized(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size) {
+  IREE_TRACE_SCOPE0("HostLocalAllocator::AllocateUninitialized");
+  return AllocateInternal(memory_type, buffer_usage, allocation_size,
+                          /*zero_fill=*/false);
+}
+
+StatusOr<ref_ptr<Buffer>> HostLocalAllocator::WrapMutable(
+    MemoryTypeBitfield memory_type, MemoryAccessBitfield allowed_access,
+    BufferUsageBitfield buffer_usage, void* data, size_t data_length) {
+  IREE_TRACE_SCOPE0("HostLocalAllocator::WrapMutable");
+  if (!CanAllocate(memory_type, buffer_usage, data_length)) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Wrapping not supported; memory_type="
+           << MemoryTypeString(memory_type)
+           << ", buffer_usage=" << BufferUsageString(buffer_usage);
+  }
+  RETURN_IF_ERROR(MakeCompatible(&memory_type, &buffer_usage));
+  return make_ref<HostBuffer>(this, memory_type, allowed_access, buffer_usage,
+                              data_length, data, /*owns_data=*/false);
+}
 
+AllocatorStatistics HostLocalAllocator::statistics() const {
+  auto statistics = Allocator::statistics();
+  auto pool_statistics = memory_pool_->statistics();
+  statistics.backing_bytes_reserved = pool_statistics.bytes_reserved;
+  statistics.backing_bytes_used = pool_statistics.bytes_allocated;
+  return statistics;
+}
+
+StatusOr<ref_ptr<Buffer>> HostLocalAllocator::AllocateInternal(
+    MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+    size_t allocation_size, bool zero_fill) {
   if (!CanAllocate(memory_type, buffer_usage, allocation_size)) {
     return FailedPreconditionErrorBuilder(IREE_LOC)
            << "Allocation not supported; memory_type="
@@ -95,15 +135,13 @@ StatusOr<ref_ptr<Buffer>> HostLocalAllocator::Allocate(
   // Make compatible with our requirements.
   RETURN_IF_ERROR(MakeCompatible(&memory_type, &buffer_usage));
 
-  void* malloced_data = std::calloc(1, allocation_size);
-  if (!malloced_data) {
-    return ResourceExhaustedErrorBuilder(IREE_LOC)
-           << "Failed to malloc " << allocation_size << " bytes";
-  }
+  ASSIGN_OR_RETURN(void* data,
+                   memory_pool_->Allocate(allocation_size, zero_fill));
 
   auto buffer =
       make_ref<HostBuffer>(this, memory_type, MemoryAccess::kAll, buffer_usage,
-                           allocation_size, malloced_data, true);
+                           allocation_size, data, memory_pool_);
+  TrackAllocation(buffer.get());
   return buffer;
 }
 
@@ -21,6 +21,7 @@
 #include "iree/base/status.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
+#include "iree/hal/host/host_memory_pool.h"
 
 namespace iree {
 namespace hal {
@@ -32,11 +33,18 @@ namespace hal {
 // the 'device' in the case of a host-local queue *is* the host. To keep code
 // written initially for a host-local queue working when other queues are used
 // the allocator only works with buffers that are kDeviceVisible.
+//
+// Memory is allocated from a HostMemoryPool, which aligns allocations for SIMD
+// access and caches small blocks for reuse.
 class HostLocalAllocator : public Allocator {
  public:
   HostLocalAllocator();
+  // |memory_pool| must outlive the allocator and all buffers allocated from it.
+  explicit HostLocalAllocator(HostMemoryPool* memory_pool);
   ~HostLocalAllocator() override;
 
+  HostMemoryPool* memory_pool() const { return memory_pool_; }
+
   bool CanUseBufferLike(Allocator* source_allocator,
                         MemoryTypeBitfield memory_type,
                         BufferUsageBitfield buffer_usage,
@@ -52,6 +60,30 @@ class HostLocalAllocator : public Allocator {
   StatusOr<ref_ptr<Buffer>> Allocate(MemoryTypeBitfield memory_type,
                                      BufferUsageBitfield buffer_usage,
                                      size_t allocation_size) override;
+
+  StatusOr<ref_ptr<Buffer>> AllocateUninitialized(
+      MemoryTypeBitfield memory_type, BufferUsageBitfield buffer_usage,
+      size_t allocation_size) override;
+
+  // Wraps host memory without copying. As the device is the host the buffer
+  // can be used by dispatches directly.
+  StatusOr<ref_ptr<Buffer>> WrapMutable(MemoryTypeBitfield memory_type,
+                                        MemoryAccessBitfield allowed_access,
+                                        BufferUsageBitfield buffer_usage,
+                                        void* data,
+                                        size_t data_length) override;
+
+  // Includes the memory pool usage as the backing memory. The pool may be
+  // shared with other allocators.
+  AllocatorStatistics statistics() const override;
+
+ private:
+  StatusOr<ref_ptr<Buffer>> AllocateInternal(MemoryTypeBitfield memory_type,
+                                             BufferUsageBitfield buffer_usage,
+                                             size_t allocation_size,
+                                             bool zero_fill);
+
+  HostMemoryPool* memory_pool_;
 };
 
 }  // namespace hal
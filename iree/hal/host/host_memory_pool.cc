@@ -0,0 +1,429 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_memory_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/logging.h"
+#include "iree/base/memory.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/host/numa_topology.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_HOST_MEMORY_POOL_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_HOST_MEMORY_POOL_VIRTUAL_ALLOC 1
+#include <malloc.h>
+#include <windows.h>
+#endif  // IREE_PLATFORM_*
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Large allocations at least this size are eligible for huge pages.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+std::atomic<uint64_t> next_pool_id{0};
+
+#ifndef NDEBUG
+// Byte pattern written over uninitialized allocations in debug builds; matches
+// the pattern HostBuffer uses for discarded mappings.
+constexpr uint8_t kUninitializedFillPattern = 0xCD;
+#endif  // !NDEBUG
+
+size_t GetPageSize() {
+#if defined(IREE_HOST_MEMORY_POOL_MMAP)
+  return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#elif defined(IREE_HOST_MEMORY_POOL_VIRTUAL_ALLOC)
+  SYSTEM_INFO system_info;
+  ::GetSystemInfo(&system_info);
+  return system_info.dwPageSize;
+#else
+  return 4096;
+#endif  // IREE_HOST_MEMORY_POOL_*
+}
+
+void* AlignedAlloc(size_t alignment, size_t size) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  return ::_aligned_malloc(size, alignment);
+#else
+  void* ptr = nullptr;
+  if (::posix_memalign(&ptr, alignment, size) != 0) return nullptr;
+  return ptr;
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+void AlignedFree(void* ptr) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  ::_aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Returns the largest power of two less than or equal to |value|.
+size_t FloorPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result <= value / 2) result *= 2;
+  return result;
+}
+
+}  // namespace
+
+// State shared between the pool and the thread caches that reference it.
+// Thread caches hold a weak reference so that blocks cached by threads that
+// outlive the pool can be returned to the system on thread exit.
+struct HostMemoryPool::SharedState {
+  explicit SharedState(std::vector<size_t> class_sizes)
+      : class_sizes(std::move(class_sizes)),
+        free_blocks(this->class_sizes.size()) {}
+
+  ~SharedState() {
+    for (auto& blocks : free_blocks) {
+      for (void* block : blocks) AlignedFree(block);
+    }
+  }
+
+  // Moves the blocks in |blocks| of size class |class_index| into the central
+  // cache, returning to the system any that do not fit.
+  void Release(int class_index, std::vector<void*>* blocks) {
+    size_t class_size = class_sizes[class_index];
+    absl::MutexLock lock(&mutex);
+    while (!blocks->empty()) {
+      void* block = blocks->back();
+      blocks->pop_back();
+      if (cached_bytes + class_size <= central_cache_bytes) {
+        free_blocks[class_index].push_back(block);
+        cached_bytes += class_size;
+      } else {
+        AlignedFree(block);
+        bytes_reserved -= class_size;
+      }
+    }
+  }
+
+  void Trim() {
+    absl::MutexLock lock(&mutex);
+    for (int i = 0; i < free_blocks.size(); ++i) {
+      for (void* block : free_blocks[i]) AlignedFree(block);
+      bytes_reserved -= free_blocks[i].size() * class_sizes[i];
+      free_blocks[i].clear();
+    }
+    cached_bytes = 0;
+  }
+
+  const std::vector<size_t> class_sizes;
+  size_t central_cache_bytes = 0;
+
+  absl::Mutex mutex;
+  std::vector<std::vector<void*>> free_blocks ABSL_GUARDED_BY(mutex);
+  size_t cached_bytes ABSL_GUARDED_BY(mutex) = 0;
+
+  std::atomic<size_t> bytes_allocated{0};
+  std::atomic<size_t> peak_bytes_allocated{0};
+  std::atomic<size_t> bytes_reserved{0};
+  std::atomic<int64_t> allocation_count{0};
+  std::atomic<int64_t> thread_cache_hit_count{0};
+  std::atomic<int64_t> central_cache_hit_count{0};
+  std::atomic<int64_t> large_allocation_count{0};
+};
+
+struct HostMemoryPool::ThreadCache {
+  ThreadCache(uint64_t pool_id, std::shared_ptr<SharedState> shared_state)
+      : pool_id(pool_id),
+        shared_state(shared_state),
+        free_blocks(shared_state->class_sizes.size()) {}
+
+  ~ThreadCache() {
+    auto state = shared_state.lock();
+    for (int i = 0; i < free_blocks.size(); ++i) {
+      if (state) {
+        state->Release(i, &free_blocks[i]);
+      } else {
+        for (void* block : free_blocks[i]) AlignedFree(block);
+      }
+    }
+  }
+
+  const uint64_t pool_id;
+  const std::weak_ptr<SharedState> shared_state;
+  std::vector<std::vector<void*>> free_blocks;
+  size_t cached_bytes = 0;
+};
+
+// static
+HostMemoryPool* HostMemoryPool::Default() {
+  static HostMemoryPool* default_pool = new HostMemoryPool();
+  return default_pool;
+}
+
+HostMemoryPool* HostMemoryPool::ForNumaNode(int numa_node) {
+  static absl::Mutex mutex(absl::kConstInit);
+  static auto* node_pools = new std::vector<HostMemoryPool*>();
+  CHECK_GE(numa_node, 0);
+  absl::MutexLock lock(&mutex);
+  if (static_cast<size_t>(numa_node) >= node_pools->size()) {
+    node_pools->resize(numa_node + 1);
+  }
+  auto*& pool = (*node_pools)[numa_node];
+  if (!pool) {
+    Options options;
+    options.numa_node = numa_node;
+    pool = new HostMemoryPool(std::move(options));
+  }
+  return pool;
+}
+
+HostMemoryPool::HostMemoryPool() : HostMemoryPool(Options{}) {}
+
+HostMemoryPool::HostMemoryPool(Options options)
+    : options_(std::move(options)), id_(next_pool_id++) {
+  page_size_ = GetPageSize();
+  CHECK_GE(options_.alignment, sizeof(void*));
+  CHECK_EQ(0, options_.alignment & (options_.alignment - 1));
+  CHECK_LE(options_.alignment, page_size_);
+
+  // Classes step by the alignment up to four times the alignment and then by a
+  // quarter of the current power of two, bounding rounding waste to 25%.
+  size_t max_small_size = RoundUp(options_.max_small_size, options_.alignment);
+  for (size_t size = options_.alignment; size < max_small_size;) {
+    class_sizes_.push_back(size);
+    size += RoundUp(std::max(options_.alignment, FloorPowerOfTwo(size) / 4),
+                    options_.alignment);
+  }
+  class_sizes_.push_back(max_small_size);
+
+  shared_state_ = std::make_shared<SharedState>(class_sizes_);
+  shared_state_->central_cache_bytes = options_.central_cache_bytes;
+}
+
+HostMemoryPool::~HostMemoryPool() { Trim(); }
+
+int HostMemoryPool::SizeClassIndex(size_t size) const {
+  return static_cast<int>(
+      std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size) -
+      class_sizes_.begin());
+}
+
+// static
+std::vector<std::unique_ptr<HostMemoryPool::ThreadCache>>&
+HostMemoryPool::thread_caches() {
+  thread_local std::vector<std::unique_ptr<ThreadCache>> thread_caches;
+  return thread_caches;
+}
+
+HostMemoryPool::ThreadCache* HostMemoryPool::GetThreadCache() {
+  auto& thread_caches = HostMemoryPool::thread_caches();
+  for (auto& thread_cache : thread_caches) {
+    if (thread_cache->pool_id == id_) return thread_cache.get();
+  }
+  // Drop caches of pools that have since been destroyed.
+  thread_caches.erase(
+      std::remove_if(thread_caches.begin(), thread_caches.end(),
+                     [](const std::unique_ptr<ThreadCache>& thread_cache) {
+                       return thread_cache->shared_state.expired();
+                     }),
+      thread_caches.end());
+  thread_caches.push_back(absl::make_unique<ThreadCache>(id_, shared_state_));
+  return thread_caches.back().get();
+}
+
+StatusOr<void*> HostMemoryPool::Allocate(size_t size, bool zero_fill) {
+  auto& state = *shared_state_;
+  size = std::max(size, size_t{1});
+
+  void* ptr = nullptr;
+  size_t allocated_size = 0;
+  bool is_zero = false;
+  if (size > class_sizes_.back()) {
+    allocated_size = RoundUp(size, page_size_);
+    ptr = AllocateLarge(allocated_size);
+    if (!ptr) {
+      return ResourceExhaustedErrorBuilder(IREE_LOC)
+             << "Failed to map " << allocated_size << " bytes";
+    }
+    ++state.large_allocation_count;
+    state.bytes_reserved += allocated_size;
+#if defined(IREE_HOST_MEMORY_POOL_MMAP) || \
+    defined(IREE_HOST_MEMORY_POOL_VIRTUAL_ALLOC)
+    // Freshly mapped pages are always zero.
+    is_zero = true;
+#endif  // IREE_HOST_MEMORY_POOL_*
+  } else {
+    int class_index = SizeClassIndex(size);
+    allocated_size = class_sizes_[class_index];
+    auto* thread_cache = GetThreadCache();
+    auto& thread_blocks = thread_cache->free_blocks[class_index];
+    if (!thread_blocks.empty()) {
+      ptr = thread_blocks.back();
+      thread_blocks.pop_back();
+      thread_cache->cached_bytes -= allocated_size;
+      ++state.thread_cache_hit_count;
+    } else {
+      {
+        absl::MutexLock lock(&state.mutex);
+        auto& central_blocks = state.free_blocks[class_index];
+        if (!central_blocks.empty()) {
+          ptr = central_blocks.back();
+          central_blocks.pop_back();
+          state.cached_bytes -= allocated_size;
+        }
+      }
+      if (ptr) {
+        ++state.central_cache_hit_count;
+      } else {
+        ptr = AlignedAlloc(options_.alignment, allocated_size);
+        if (!ptr) {
+          return ResourceExhaustedErrorBuilder(IREE_LOC)
+                 << "Failed to allocate " << allocated_size << " bytes";
+        }
+        state.bytes_reserved += allocated_size;
+      }
+    }
+  }
+
+  if (zero_fill) {
+    if (!is_zero) std::memset(ptr, 0, size);
+  } else {
+#ifndef NDEBUG
+    // Scribble over the memory so that reads before writes produce obviously
+    // wrong values instead of stale data from a previous allocation.
+    std::memset(ptr, kUninitializedFillPattern, size);
+#endif  // !NDEBUG
+    IREE_MSAN_ALLOCATED_MEMORY(ptr, size);
+  }
+
+  ++state.allocation_count;
+  size_t bytes_allocated = state.bytes_allocated += allocated_size;
+  size_t peak_bytes_allocated = state.peak_bytes_allocated.load();
+  while (bytes_allocated > peak_bytes_allocated &&
+         !state.peak_bytes_allocated.compare_exchange_weak(
+             peak_bytes_allocated, bytes_allocated)) {
+  }
+  return ptr;
+}
+
+void HostMemoryPool::Free(void* ptr, size_t size) {
+  if (!ptr) return;
+  auto& state = *shared_state_;
+  size = std::max(size, size_t{1});
+
+  if (size > class_sizes_.back()) {
+    size_t allocated_size = RoundUp(size, page_size_);
+    FreeLarge(ptr, allocated_size);
+    state.bytes_allocated -= allocated_size;
+    state.bytes_reserved -= allocated_size;
+    return;
+  }
+
+  int class_index = SizeClassIndex(size);
+  size_t allocated_size = class_sizes_[class_index];
+  state.bytes_allocated -= allocated_size;
+  auto* thread_cache = GetThreadCache();
+  if (thread_cache->cached_bytes + allocated_size <=
+      options_.thread_cache_bytes) {
+    thread_cache->free_blocks[class_index].push_back(ptr);
+    thread_cache->cached_bytes += allocated_size;
+    return;
+  }
+  std::vector<void*> blocks = {ptr};
+  state.Release(class_index, &blocks);
+}
+
+void HostMemoryPool::Trim() {
+  IREE_TRACE_SCOPE0("HostMemoryPool::Trim");
+  auto& thread_caches = HostMemoryPool::thread_caches();
+  for (auto it = thread_caches.begin(); it != thread_caches.end(); ++it) {
+    if ((*it)->pool_id == id_) {
+      // Releases the blocks to the central cache, trimmed below.
+      thread_caches.erase(it);
+      break;
+    }
+  }
+  shared_state_->Trim();
+}
+
+HostMemoryPool::Statistics HostMemoryPool::statistics() const {
+  const auto& state = *shared_state_;
+  Statistics statistics;
+  statistics.bytes_allocated = state.bytes_allocated;
+  statistics.peak_bytes_allocated = state.peak_bytes_allocated;
+  statistics.bytes_reserved = state.bytes_reserved;
+  statistics.allocation_count = state.allocation_count;
+  statistics.thread_cache_hit_count = state.thread_cache_hit_count;
+  statistics.central_cache_hit_count = state.central_cache_hit_count;
+  statistics.large_allocation_count = state.large_allocation_count;
+  return statistics;
+}
+
+void* HostMemoryPool::AllocateLarge(size_t size) {
+  IREE_TRACE_SCOPE0("HostMemoryPool::AllocateLarge");
+#if defined(IREE_HOST_MEMORY_POOL_MMAP)
+  void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+  if (options_.use_huge_pages && size >= kHugePageSize) {
+    ::madvise(ptr, size, MADV_HUGEPAGE);
+  }
+#endif  // MADV_HUGEPAGE
+  if (options_.numa_node >= 0) {
+    // Binding must happen before the pages are first touched.
+    auto status = BindMemoryToNumaNode(ptr, size, options_.numa_node);
+    static std::atomic<bool> warned{false};
+    if (!status.ok() && !warned.exchange(true)) {
+      LOG(WARNING) << "Large allocations will not be NUMA bound: " << status;
+    }
+  }
+  return ptr;
+#elif defined(IREE_HOST_MEMORY_POOL_VIRTUAL_ALLOC)
+  return ::VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE,
+                        PAGE_READWRITE);
+#else
+  return AlignedAlloc(page_size_, size);
+#endif  // IREE_HOST_MEMORY_POOL_*
+}
+
+void HostMemoryPool::FreeLarge(void* ptr, size_t size) {
+#if defined(IREE_HOST_MEMORY_POOL_MMAP)
+  if (::munmap(ptr, size) != 0) {
+    LOG(WARNING) << "Unable to unmap " << size << " bytes";
+  }
+#elif defined(IREE_HOST_MEMORY_POOL_VIRTUAL_ALLOC)
+  ::VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+  AlignedFree(ptr);
+#endif  // IREE_HOST_MEMORY_POOL_*
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,152 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_HOST_MEMORY_POOL_H_
+#define IREE_HAL_HOST_HOST_MEMORY_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "iree/base/status.h"
+
+namespace iree {
+namespace hal {
+
+// Allocates aligned host memory for buffer contents.
+//
+// Small allocations are rounded up to one of a set of size classes and freed
+// blocks are kept in a per-thread cache for reuse by the next allocation of
+// the same class on that thread, falling back to a shared central cache and
+// then to the system heap. This avoids the global heap lock on the hot path of
+// functions that allocate and drop temporaries on every invocation. Large
+// allocations bypass the caches and are mapped directly from the OS, where
+// they can optionally be backed by transparent huge pages.
+//
+// All allocations are aligned to at least Options::alignment so that kernels
+// can use aligned vector loads and morsels start on cache line boundaries.
+// Zeroing is opt-in per allocation as most buffers are fully overwritten.
+//
+// HostMemoryPool is thread-safe. Blocks may be freed on a different thread
+// than the one that allocated them.
+class HostMemoryPool final {
+ public:
+  struct Options {
+    // Alignment of all returned allocations. Must be a power of two no larger
+    // than the system page size.
+    size_t alignment = 64;
+
+    // Allocations larger than this are mapped directly from the OS and are
+    // never cached.
+    size_t max_small_size = 256 * 1024;
+
+    // Maximum bytes of freed blocks each thread keeps for reuse.
+    size_t thread_cache_bytes = 4 * 1024 * 1024;
+
+    // Maximum bytes of freed blocks kept in the central cache shared by all
+    // threads.
+    size_t central_cache_bytes = 64 * 1024 * 1024;
+
+    // Advises the OS to back large allocations with transparent huge pages
+    // where supported. Reduces TLB misses when streaming over large buffers at
+    // the cost of coarser-grained memory usage.
+    bool use_huge_pages = false;
+
+    // NUMA node that large allocations are preferentially placed on, or -1 to
+    // use the default first-touch placement of the OS. Small blocks come from
+    // the system heap and are placed by first touch; pools bound to a node
+    // should be used from threads pinned to that node.
+    int numa_node = -1;
+  };
+
+  struct Statistics {
+    // Bytes currently allocated to callers, including size class rounding.
+    size_t bytes_allocated = 0;
+    // High water mark of bytes_allocated.
+    size_t peak_bytes_allocated = 0;
+    // Bytes held from the system, including blocks waiting in caches.
+    size_t bytes_reserved = 0;
+    // Total number of allocations served.
+    int64_t allocation_count = 0;
+    // Allocations served from the calling thread's cache.
+    int64_t thread_cache_hit_count = 0;
+    // Allocations served from the central cache.
+    int64_t central_cache_hit_count = 0;
+    // Allocations served by the large object path.
+    int64_t large_allocation_count = 0;
+  };
+
+  // Returns a process-wide pool with the default options.
+  static HostMemoryPool* Default();
+
+  // Returns a process-wide pool with the default options bound to |numa_node|.
+  // Pools are never destroyed as buffers may outlive the devices using them.
+  static HostMemoryPool* ForNumaNode(int numa_node);
+
+  HostMemoryPool();
+  explicit HostMemoryPool(Options options);
+  ~HostMemoryPool();
+
+  HostMemoryPool(const HostMemoryPool&) = delete;
+  HostMemoryPool& operator=(const HostMemoryPool&) = delete;
+
+  const Options& options() const { return options_; }
+
+  // Allocates |size| bytes. The contents are zeroed only if |zero_fill| is
+  // set and are otherwise undefined. Debug builds fill undefined contents with
+  // a pattern and MSan builds report reads of them before they are written.
+  StatusOr<void*> Allocate(size_t size, bool zero_fill);
+
+  // Frees |ptr| previously returned by Allocate with the same |size|.
+  void Free(void* ptr, size_t size);
+
+  // Returns blocks cached by the calling thread and the central cache to the
+  // system. Blocks cached by other threads are returned when they exit.
+  void Trim();
+
+  // Returns a snapshot of the pool statistics.
+  Statistics statistics() const;
+
+ private:
+  struct SharedState;
+  struct ThreadCache;
+
+  // Returns the index of the smallest size class that fits |size|.
+  int SizeClassIndex(size_t size) const;
+
+  // Returns the caches of the calling thread for each pool it has used.
+  static std::vector<std::unique_ptr<ThreadCache>>& thread_caches();
+
+  // Returns the calling thread's cache for this pool, creating it if needed.
+  ThreadCache* GetThreadCache();
+
+  void* AllocateLarge(size_t size);
+  void FreeLarge(void* ptr, size_t size);
+
+  const Options options_;
+  const uint64_t id_;
+  size_t page_size_ = 4096;
+
+  // Size in bytes of each size class in ascending order.
+  std::vector<size_t> class_sizes_;
+
+  // State shared with thread caches, which may outlive the pool.
+  std::shared_ptr<SharedState> shared_state_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_HOST_MEMORY_POOL_H_
@@ -0,0 +1,176 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_memory_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/notification.h"
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+HostMemoryPool::Options SmallOptions() {
+  HostMemoryPool::Options options;
+  options.max_small_size = 64 * 1024;
+  options.thread_cache_bytes = 256 * 1024;
+  options.central_cache_bytes = 1024 * 1024;
+  return options;
+}
+
+bool IsZero(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    if (bytes[i]) return false;
+  }
+  return true;
+}
+
+// Tests that small and large allocations honor the alignment.
+TEST(HostMemoryPoolTest, Alignment) {
+  HostMemoryPool pool(SmallOptions());
+  for (size_t size : {1, 63, 64, 100, 4096, 64 * 1024, 64 * 1024 + 1,
+                      1024 * 1024}) {
+    ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(size, /*zero_fill=*/false));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % 64) << size;
+    std::memset(ptr, 0xAB, size);
+    pool.Free(ptr, size);
+  }
+}
+
+// Tests that zeroing is applied when requested, including on reuse.
+TEST(HostMemoryPoolTest, ZeroFill) {
+  HostMemoryPool pool(SmallOptions());
+  for (size_t size : {100, 1024 * 1024}) {
+    ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(size, /*zero_fill=*/false));
+    std::memset(ptr, 0xAB, size);
+    pool.Free(ptr, size);
+    ASSERT_OK_AND_ASSIGN(ptr, pool.Allocate(size, /*zero_fill=*/true));
+    EXPECT_TRUE(IsZero(ptr, size)) << size;
+    pool.Free(ptr, size);
+  }
+}
+
+#ifndef NDEBUG
+// Tests that uninitialized contents are filled with a pattern in debug builds.
+TEST(HostMemoryPoolTest, UninitializedFill) {
+  HostMemoryPool pool(SmallOptions());
+  for (size_t size : {100, 1024 * 1024}) {
+    ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(size, /*zero_fill=*/false));
+    const uint8_t* bytes = static_cast<const uint8_t*>(ptr);
+    EXPECT_EQ(0xCD, bytes[0]) << size;
+    EXPECT_EQ(0xCD, bytes[size - 1]) << size;
+    pool.Free(ptr, size);
+  }
+}
+#endif  // !NDEBUG
+
+// Tests that freed small blocks are reused from the thread cache.
+TEST(HostMemoryPoolTest, ThreadCacheReuse) {
+  HostMemoryPool pool(SmallOptions());
+  ASSERT_OK_AND_ASSIGN(void* first, pool.Allocate(1000, /*zero_fill=*/false));
+  pool.Free(first, 1000);
+  // Same size class as 1000.
+  ASSERT_OK_AND_ASSIGN(void* second, pool.Allocate(1020, /*zero_fill=*/false));
+  EXPECT_EQ(first, second);
+  pool.Free(second, 1020);
+
+  auto statistics = pool.statistics();
+  EXPECT_EQ(2, statistics.allocation_count);
+  EXPECT_EQ(1, statistics.thread_cache_hit_count);
+  EXPECT_EQ(0, statistics.bytes_allocated);
+  EXPECT_EQ(1024, statistics.peak_bytes_allocated);
+  EXPECT_EQ(1024, statistics.bytes_reserved);
+
+  pool.Trim();
+  EXPECT_EQ(0, pool.statistics().bytes_reserved);
+}
+
+// Tests that large allocations bypass the caches.
+TEST(HostMemoryPoolTest, LargeAllocations) {
+  HostMemoryPool pool(SmallOptions());
+  size_t size = 1024 * 1024 + 1;
+  ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(size, /*zero_fill=*/true));
+  EXPECT_TRUE(IsZero(ptr, size));
+  auto statistics = pool.statistics();
+  EXPECT_EQ(1, statistics.large_allocation_count);
+  EXPECT_LE(size, statistics.bytes_allocated);
+  pool.Free(ptr, size);
+  statistics = pool.statistics();
+  EXPECT_EQ(0, statistics.bytes_allocated);
+  EXPECT_EQ(0, statistics.bytes_reserved);
+}
+
+// Tests that NUMA-bound pools allocate even where binding is unsupported.
+TEST(HostMemoryPoolTest, NumaBoundAllocations) {
+  auto options = SmallOptions();
+  options.numa_node = 0;
+  HostMemoryPool pool(options);
+  for (size_t size : {100, 4 * 1024 * 1024}) {
+    ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(size, /*zero_fill=*/true));
+    EXPECT_TRUE(IsZero(ptr, size)) << size;
+    std::memset(ptr, 0xAB, size);
+    pool.Free(ptr, size);
+  }
+}
+
+// Tests that blocks freed by another thread are reused through the central
+// cache once that thread exits.
+TEST(HostMemoryPoolTest, CrossThreadFree) {
+  HostMemoryPool pool(SmallOptions());
+  std::vector<void*> blocks;
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(4096, /*zero_fill=*/false));
+    blocks.push_back(ptr);
+  }
+  std::thread thread([&]() {
+    for (void* ptr : blocks) pool.Free(ptr, 4096);
+  });
+  thread.join();
+
+  ASSERT_OK_AND_ASSIGN(void* ptr, pool.Allocate(4096, /*zero_fill=*/false));
+  EXPECT_NE(blocks.end(), std::find(blocks.begin(), blocks.end(), ptr));
+  EXPECT_EQ(1, pool.statistics().central_cache_hit_count);
+  pool.Free(ptr, 4096);
+}
+
+// Tests that a thread may keep blocks cached after the pool is destroyed.
+TEST(HostMemoryPoolTest, ThreadOutlivesPool) {
+  auto pool = absl::make_unique<HostMemoryPool>(SmallOptions());
+  ASSERT_OK_AND_ASSIGN(void* ptr, pool->Allocate(128, /*zero_fill=*/false));
+  absl::Notification freed;
+  absl::Notification pool_destroyed;
+  std::thread thread([&]() {
+    pool->Free(ptr, 128);
+    freed.Notify();
+    pool_destroyed.WaitForNotification();
+  });
+  freed.WaitForNotification();
+  pool.reset();
+  pool_destroyed.Notify();
+  thread.join();
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -111,6 +111,7 @@ bool HostSubmissionQueue::IsBatchReady(const PendingBatch& batch) const {
 Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
                                     FenceValue fence) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::Enqueue");
+  IREE_TRACE_FLOW_STEP("HostSubmissionQueue::Enqueue");
 
   if (has_shutdown_) {
     return FailedPreconditionErrorBuilder(IREE_LOC)
@@ -155,6 +156,7 @@ Status HostSubmissionQueue::Enqueue(absl::Span<const SubmissionBatch> batches,
         {batches[i].command_buffers.begin(), batches[i].command_buffers.end()},
         {batches[i].signal_semaphores.begin(),
          batches[i].signal_semaphores.end()},
+        IREE_TRACE_FLOW_ID(),
     };
   }
   list_.push_back(std::move(submission));
@@ -227,6 +229,8 @@ Status HostSubmissionQueue::ProcessBatches(ExecuteFn execute_fn) {
 Status HostSubmissionQueue::ProcessBatch(const PendingBatch& batch,
                                          const ExecuteFn& execute_fn) {
   IREE_TRACE_SCOPE0("HostSubmissionQueue::ProcessBatch");
+  IREE_TRACE_FLOW_CONTINUE("HostSubmissionQueue::ProcessBatch",
+                           batch.trace_flow_id);
 
   // Complete the waits on all semaphores and reset them.
   for (auto& semaphore_value : batch.wait_semaphores) {
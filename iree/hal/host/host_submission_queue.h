@@ -122,6 +122,8 @@ class HostSubmissionQueue {
     absl::InlinedVector<SemaphoreValue, 4> wait_semaphores;
     absl::InlinedVector<CommandBuffer*, 4> command_buffers;
     absl::InlinedVector<SemaphoreValue, 4> signal_semaphores;
+    // Trace flow of the submitter, continued when the batch is processed.
+    uint64_t trace_flow_id;
   };
   struct Submission : public IntrusiveLinkBase<void> {
     absl::InlinedVector<PendingBatch, 4> pending_batches;
@@ -0,0 +1,129 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "iree/base/tracing.h"
+#include "iree/hal/host/numa_topology.h"
+
+namespace iree {
+namespace hal {
+
+HostThreadPool::HostThreadPool(Options options) {
+  IREE_TRACE_SCOPE0("HostThreadPool::ctor");
+  int thread_count = options.thread_count;
+  if (thread_count <= 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers_.reserve(thread_count - 1);
+  for (int i = 0; i < thread_count - 1; ++i) {
+    workers_.emplace_back([this]() { WorkerMain(); });
+    if (!options.worker_cpu_ids.empty()) {
+      int cpu_id = options.worker_cpu_ids[i % options.worker_cpu_ids.size()];
+      PinThreadToCpus(&workers_.back(), {cpu_id});
+    }
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  IREE_TRACE_SCOPE0("HostThreadPool::dtor");
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void HostThreadPool::ParallelFor(int task_count,
+                                 const std::function<void(int)>& fn) {
+  if (task_count <= 0) return;
+  if (workers_.empty() || task_count == 1 || !job_mutex_.TryLock()) {
+    // Single task, no workers, or the workers are busy with another job.
+    for (int i = 0; i < task_count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  IREE_TRACE_SCOPE0("HostThreadPool::ParallelFor");
+  {
+    absl::MutexLock lock(&mutex_);
+    job_fn_ = &fn;
+    job_task_count_ = task_count;
+    next_task_.store(0, std::memory_order_relaxed);
+    busy_worker_count_ = static_cast<int>(workers_.size());
+    ++job_generation_;
+  }
+
+  RunTasks(fn, task_count);
+
+  {
+    // All tasks have been claimed; wait for workers still running theirs.
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](int* busy_worker_count) { return *busy_worker_count == 0; },
+        &busy_worker_count_));
+    job_fn_ = nullptr;
+  }
+  job_mutex_.Unlock();
+}
+
+void HostThreadPool::RunTasks(const std::function<void(int)>& fn,
+                              int task_count) {
+  int task_index;
+  while ((task_index = next_task_.fetch_add(1, std::memory_order_relaxed)) <
+         task_count) {
+    fn(task_index);
+  }
+}
+
+void HostThreadPool::WorkerMain() {
+  IREE_TRACE_THREAD_ENABLE("HostThreadPool worker");
+
+  uint64_t seen_generation = 0;
+  while (true) {
+    const std::function<void(int)>* fn = nullptr;
+    int task_count = 0;
+    {
+      absl::MutexLock lock(&mutex_);
+      struct WaitState {
+        HostThreadPool* pool;
+        uint64_t seen_generation;
+      } wait_state = {this, seen_generation};
+      mutex_.Await(absl::Condition(
+          +[](WaitState* state) {
+            return state->pool->shutdown_ ||
+                   state->pool->job_generation_ != state->seen_generation;
+          },
+          &wait_state));
+      if (shutdown_) return;
+      seen_generation = job_generation_;
+      fn = job_fn_;
+      task_count = job_task_count_;
+    }
+
+    RunTasks(*fn, task_count);
+
+    absl::MutexLock lock(&mutex_);
+    --busy_worker_count_;
+  }
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,90 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_HOST_THREAD_POOL_H_
+#define IREE_HAL_HOST_HOST_THREAD_POOL_H_
+
+#include <atomic>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace iree {
+namespace hal {
+
+// A fixed-size pool of host worker threads used to parallelize work within a
+// single kernel or command. Devices own a single pool that is shared by all
+// executables and queues to avoid oversubscribing cores.
+//
+// Only one ParallelFor may use the workers at a time. Calls made while the
+// workers are busy (such as from another fiber or from within a task) run
+// inline on the calling thread instead of queuing, which keeps nested
+// parallelism from deadlocking or spawning additional threads.
+//
+// HostThreadPool is thread-safe.
+class HostThreadPool final {
+ public:
+  struct Options {
+    // Total number of threads that participate in a ParallelFor, including the
+    // calling thread. 0 uses std::thread::hardware_concurrency().
+    int thread_count = 0;
+
+    // CPU ids that worker threads are pinned to, assigned round-robin. The
+    // calling thread is never pinned. Empty leaves workers unpinned. Ignored
+    // on platforms without thread affinity support.
+    std::vector<int> worker_cpu_ids;
+  };
+
+  explicit HostThreadPool(Options options);
+  ~HostThreadPool();
+
+  HostThreadPool(const HostThreadPool&) = delete;
+  HostThreadPool& operator=(const HostThreadPool&) = delete;
+
+  // Total number of threads that may run tasks, including the caller.
+  int thread_count() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Runs |fn|(i) for all i in [0, task_count) across the workers and the
+  // calling thread and blocks until all tasks have completed. Tasks are
+  // claimed dynamically so uneven task costs balance across threads.
+  void ParallelFor(int task_count, const std::function<void(int)>& fn);
+
+ private:
+  // Thread entry point for workers. Waits for jobs and runs their tasks.
+  void WorkerMain();
+
+  // Claims and runs tasks from the current job until none remain.
+  void RunTasks(const std::function<void(int)>& fn, int task_count);
+
+  std::vector<std::thread> workers_;
+
+  // Held for the duration of a ParallelFor that uses the workers.
+  absl::Mutex job_mutex_;
+
+  absl::Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  uint64_t job_generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  const std::function<void(int)>* job_fn_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  int job_task_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int busy_worker_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_HOST_THREAD_POOL_H_
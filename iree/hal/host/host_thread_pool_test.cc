@@ -0,0 +1,103 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/host_thread_pool.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Tests that every task runs exactly once.
+TEST(HostThreadPoolTest, RunsAllTasks) {
+  HostThreadPool::Options options;
+  options.thread_count = 4;
+  HostThreadPool thread_pool(options);
+  EXPECT_EQ(4, thread_pool.thread_count());
+
+  std::vector<std::atomic<int>> counts(1000);
+  thread_pool.ParallelFor(counts.size(), [&](int i) { ++counts[i]; });
+  for (const auto& count : counts) {
+    EXPECT_EQ(1, count.load());
+  }
+}
+
+// Tests that a pool with a single thread runs everything on the caller.
+TEST(HostThreadPoolTest, SingleThread) {
+  HostThreadPool::Options options;
+  options.thread_count = 1;
+  HostThreadPool thread_pool(options);
+  EXPECT_EQ(1, thread_pool.thread_count());
+
+  std::thread::id caller_id = std::this_thread::get_id();
+  int task_count = 0;
+  thread_pool.ParallelFor(16, [&](int i) {
+    EXPECT_EQ(caller_id, std::this_thread::get_id());
+    ++task_count;
+  });
+  EXPECT_EQ(16, task_count);
+}
+
+// Tests that the pool can be reused for many jobs.
+TEST(HostThreadPoolTest, SequentialJobs) {
+  HostThreadPool::Options options;
+  options.thread_count = 3;
+  HostThreadPool thread_pool(options);
+  std::atomic<int> sum{0};
+  for (int job = 0; job < 100; ++job) {
+    thread_pool.ParallelFor(8, [&](int i) { sum += i; });
+  }
+  EXPECT_EQ(100 * 28, sum.load());
+}
+
+// Tests that nested ParallelFor calls run inline instead of deadlocking.
+TEST(HostThreadPoolTest, NestedRunsInline) {
+  HostThreadPool::Options options;
+  options.thread_count = 4;
+  HostThreadPool thread_pool(options);
+  std::atomic<int> inner_count{0};
+  thread_pool.ParallelFor(8, [&](int i) {
+    thread_pool.ParallelFor(8, [&](int j) { ++inner_count; });
+  });
+  EXPECT_EQ(64, inner_count.load());
+}
+
+// Tests that concurrent callers from multiple threads all complete.
+TEST(HostThreadPoolTest, ConcurrentCallers) {
+  HostThreadPool::Options options;
+  options.thread_count = 4;
+  HostThreadPool thread_pool(options);
+  std::atomic<int> total{0};
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 4; ++i) {
+    callers.emplace_back([&]() {
+      for (int job = 0; job < 50; ++job) {
+        thread_pool.ParallelFor(10, [&](int j) { ++total; });
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(4 * 50 * 10, total.load());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
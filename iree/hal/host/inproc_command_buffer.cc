@@ -14,11 +14,46 @@
 
 #include "iree/hal/host/inproc_command_buffer.h"
 
+#include <cstring>
+
+#include "absl/container/inlined_vector.h"
 #include "iree/base/tracing.h"
 
 namespace iree {
 namespace hal {
 
+namespace {
+
+// Returns |size| rounded up to |alignment| (which must be a power of two).
+constexpr size_t AlignSize(size_t size, size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Writes the POD |values| at |*ptr| and advances it by |padded_size|.
+template <typename T>
+void WriteArray(uint8_t** ptr, absl::Span<const T> values,
+                size_t padded_size) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Inline arrays must be trivially copyable");
+  if (!values.empty()) {
+    std::memcpy(*ptr, values.data(), values.size() * sizeof(T));
+  }
+  *ptr += padded_size;
+}
+
+// Returns a span of |count| values of T at |*ptr| and advances it past them.
+template <typename T>
+absl::Span<T> ReadArray(const uint8_t** ptr, size_t count,
+                        size_t alignment) {
+  // The stream is only ever read in-process and the values are not mutated:
+  // the const_cast only exists for the CommandBuffer::WaitEvents signature.
+  auto* data = reinterpret_cast<T*>(const_cast<uint8_t*>(*ptr));
+  *ptr += AlignSize(count * sizeof(T), alignment);
+  return absl::Span<T>(data, count);
+}
+
+}  // namespace
+
 InProcCommandBuffer::InProcCommandBuffer(
     Allocator* allocator, CommandBufferModeBitfield mode,
     CommandCategoryBitfield command_categories)
@@ -45,29 +80,43 @@ Status InProcCommandBuffer::ExecutionBarrier(
     absl::Span<const MemoryBarrier> memory_barriers,
     absl::Span<const BufferBarrier> buffer_barriers) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::ExecutionBarrier");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<ExecutionBarrierCmd>());
+  size_t memory_barriers_size =
+      AlignSize(memory_barriers.size() * sizeof(MemoryBarrier), kCmdAlignment);
+  size_t buffer_barriers_size =
+      AlignSize(buffer_barriers.size() * sizeof(BufferBarrier), kCmdAlignment);
+  auto* cmd = AppendCmd<ExecutionBarrierCmd>(memory_barriers_size +
+                                             buffer_barriers_size);
   cmd->source_stage_mask = source_stage_mask;
   cmd->target_stage_mask = target_stage_mask;
-  cmd->memory_barriers = AppendStructSpan(memory_barriers);
-  cmd->buffer_barriers = AppendStructSpan(buffer_barriers);
+  cmd->memory_barrier_count = memory_barriers.size();
+  cmd->buffer_barrier_count = buffer_barriers.size();
+  auto* ptr = reinterpret_cast<uint8_t*>(cmd) +
+              AlignSize(sizeof(*cmd), kCmdAlignment);
+  WriteArray(&ptr, memory_barriers, memory_barriers_size);
+  WriteArray(&ptr, buffer_barriers, buffer_barriers_size);
+  for (const auto& buffer_barrier : buffer_barriers) {
+    RetainResource(buffer_barrier.buffer);
+  }
   return OkStatus();
 }
 
 Status InProcCommandBuffer::SignalEvent(
     Event* event, ExecutionStageBitfield source_stage_mask) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::SignalEvent");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<SignalEventCmd>());
+  auto* cmd = AppendCmd<SignalEventCmd>(0);
   cmd->event = event;
   cmd->source_stage_mask = source_stage_mask;
+  RetainResource(event);
   return OkStatus();
 }
 
 Status InProcCommandBuffer::ResetEvent(
     Event* event, ExecutionStageBitfield source_stage_mask) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::ResetEvent");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<ResetEventCmd>());
+  auto* cmd = AppendCmd<ResetEventCmd>(0);
   cmd->event = event;
   cmd->source_stage_mask = source_stage_mask;
+  RetainResource(event);
   return OkStatus();
 }
 
@@ -77,12 +126,29 @@ Status InProcCommandBuffer::WaitEvents(
     absl::Span<const MemoryBarrier> memory_barriers,
     absl::Span<const BufferBarrier> buffer_barriers) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::WaitEvents");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<WaitEventsCmd>());
-  cmd->events = AppendStructSpan(events);
+  size_t events_size = AlignSize(events.size() * sizeof(Event*), kCmdAlignment);
+  size_t memory_barriers_size =
+      AlignSize(memory_barriers.size() * sizeof(MemoryBarrier), kCmdAlignment);
+  size_t buffer_barriers_size =
+      AlignSize(buffer_barriers.size() * sizeof(BufferBarrier), kCmdAlignment);
+  auto* cmd = AppendCmd<WaitEventsCmd>(events_size + memory_barriers_size +
+                                       buffer_barriers_size);
   cmd->source_stage_mask = source_stage_mask;
   cmd->target_stage_mask = target_stage_mask;
-  cmd->memory_barriers = AppendStructSpan(memory_barriers);
-  cmd->buffer_barriers = AppendStructSpan(buffer_barriers);
+  cmd->event_count = events.size();
+  cmd->memory_barrier_count = memory_barriers.size();
+  cmd->buffer_barrier_count = buffer_barriers.size();
+  auto* ptr = reinterpret_cast<uint8_t*>(cmd) +
+              AlignSize(sizeof(*cmd), kCmdAlignment);
+  WriteArray(&ptr, absl::Span<Event* const>(events), events_size);
+  WriteArray(&ptr, memory_barriers, memory_barriers_size);
+  WriteArray(&ptr, buffer_barriers, buffer_barriers_size);
+  for (auto* event : events) {
+    RetainResource(event);
+  }
+  for (const auto& buffer_barrier : buffer_barriers) {
+    RetainResource(buffer_barrier.buffer);
+  }
   return OkStatus();
 }
 
@@ -92,19 +158,27 @@ Status InProcCommandBuffer::FillBuffer(Buffer* target_buffer,
                                        const void* pattern,
                                        size_t pattern_length) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::FillBuffer");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<FillBufferCmd>());
+  if (pattern_length > sizeof(FillBufferCmd::pattern)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Fill patterns must be at most "
+           << sizeof(FillBufferCmd::pattern) << " bytes; got "
+           << pattern_length;
+  }
+  auto* cmd = AppendCmd<FillBufferCmd>(0);
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
   std::memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
+  RetainResource(target_buffer);
   return OkStatus();
 }
 
 Status InProcCommandBuffer::DiscardBuffer(Buffer* buffer) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::DiscardBuffer");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<DiscardBufferCmd>());
+  auto* cmd = AppendCmd<DiscardBufferCmd>(0);
   cmd->buffer = buffer;
+  RetainResource(buffer);
   return OkStatus();
 }
 
@@ -114,11 +188,15 @@ Status InProcCommandBuffer::UpdateBuffer(const void* source_buffer,
                                          device_size_t target_offset,
                                          device_size_t length) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::UpdateBuffer");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<UpdateBufferCmd>());
-  cmd->source_buffer = AppendCmdData(source_buffer, source_offset, length);
+  auto* cmd = AppendCmd<UpdateBufferCmd>(AlignSize(length, kCmdAlignment));
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
+  std::memcpy(reinterpret_cast<uint8_t*>(cmd) +
+                  AlignSize(sizeof(*cmd), kCmdAlignment),
+              static_cast<const uint8_t*>(source_buffer) + source_offset,
+              length);
+  RetainResource(target_buffer);
   return OkStatus();
 }
 
@@ -128,58 +206,95 @@ Status InProcCommandBuffer::CopyBuffer(Buffer* source_buffer,
                                        device_size_t target_offset,
                                        device_size_t length) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::CopyBuffer");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<CopyBufferCmd>());
+  auto* cmd = AppendCmd<CopyBufferCmd>(0);
   cmd->source_buffer = source_buffer;
   cmd->source_offset = source_offset;
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
+  RetainResource(source_buffer);
+  RetainResource(target_buffer);
   return OkStatus();
 }
 
 Status InProcCommandBuffer::Dispatch(const DispatchRequest& dispatch_request) {
   IREE_TRACE_SCOPE0("InProcCommandBuffer::Dispatch");
-  ASSIGN_OR_RETURN(auto* cmd, AppendCmd<DispatchCmd>());
-  cmd->request.executable = dispatch_request.executable;
-  cmd->request.entry_point = dispatch_request.entry_point;
-  cmd->request.workload = dispatch_request.workload;
-  cmd->request.workload_buffer = dispatch_request.workload_buffer;
-  cmd->request.bindings = AppendStructSpan(dispatch_request.bindings);
+  size_t bindings_size = 0;
+  for (const auto& binding : dispatch_request.bindings) {
+    bindings_size += AlignSize(
+        sizeof(BindingEntry) + binding.shape.size() * sizeof(int),
+        kCmdAlignment);
+  }
+  auto* cmd = AppendCmd<DispatchCmd>(bindings_size);
+  cmd->executable = dispatch_request.executable;
+  cmd->workload_buffer = dispatch_request.workload_buffer;
+  cmd->entry_point = dispatch_request.entry_point;
+  for (int i = 0; i < 3; ++i) {
+    cmd->workload[i] = dispatch_request.workload[i];
+  }
+  cmd->binding_count = dispatch_request.bindings.size();
+  auto* ptr = reinterpret_cast<uint8_t*>(cmd) +
+              AlignSize(sizeof(*cmd), kCmdAlignment);
+  for (const auto& binding : dispatch_request.bindings) {
+    BindingEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.buffer = binding.buffer;
+    entry.access = binding.access;
+    entry.rank = binding.shape.size();
+    entry.element_size = binding.element_size;
+    std::memcpy(ptr, &entry, sizeof(entry));
+    std::memcpy(ptr + sizeof(entry), binding.shape.begin(),
+                entry.rank * sizeof(int));
+    ptr += AlignSize(sizeof(entry) + entry.rank * sizeof(int), kCmdAlignment);
+    RetainResource(binding.buffer);
+  }
+  RetainResource(dispatch_request.executable);
+  RetainResource(dispatch_request.workload_buffer);
   return OkStatus();
 }
 
+StatusOr<ref_ptr<InProcCommandBuffer>> InProcCommandBuffer::Clone() const {
+  IREE_TRACE_SCOPE0("InProcCommandBuffer::Clone");
+  if (is_recording_) {
+    return FailedPreconditionErrorBuilder(IREE_LOC)
+           << "Command buffers cannot be cloned while recording";
+  }
+  auto clone = make_ref<InProcCommandBuffer>(allocator(), mode(),
+                                             command_categories());
+  // The stream contains no internal pointers and can be copied as-is.
+  clone->cmd_stream_ = cmd_stream_;
+  clone->resource_set_ = resource_set_;
+  clone->resources_.reserve(resources_.size());
+  for (const auto& resource : resources_) {
+    clone->resources_.push_back(add_ref(resource));
+  }
+  return clone;
+}
+
 void InProcCommandBuffer::Reset() {
-  auto* cmd_list = &current_cmd_list_;
-  cmd_list->head = cmd_list->tail = nullptr;
-  cmd_list->arena.Reset();
+  cmd_stream_.clear();
+  resource_set_.clear();
+  resources_.clear();
 }
 
 InProcCommandBuffer::CmdHeader* InProcCommandBuffer::AppendCmdHeader(
-    CmdType type, size_t cmd_size) {
-  auto* cmd_list = &current_cmd_list_;
-  auto* cmd_header = reinterpret_cast<CmdHeader*>(
-      cmd_list->arena.AllocateBytes(sizeof(CmdHeader) + cmd_size));
-  cmd_header->next = nullptr;
+    CmdType type, size_t cmd_size, size_t trailing_size) {
+  size_t cmd_offset = cmd_stream_.size();
+  size_t total_size = sizeof(CmdHeader) +
+                      AlignSize(cmd_size, kCmdAlignment) + trailing_size;
+  DCHECK_EQ(0, total_size % kCmdAlignment);
+  cmd_stream_.resize(cmd_offset + total_size);
+  auto* cmd_header =
+      reinterpret_cast<CmdHeader*>(cmd_stream_.data() + cmd_offset);
   cmd_header->type = type;
-  if (!cmd_list->head) {
-    cmd_list->head = cmd_header;
-  } else if (cmd_list->tail) {
-    cmd_list->tail->next = cmd_header;
-  }
-  cmd_list->tail = cmd_header;
+  cmd_header->size = static_cast<uint32_t>(total_size);
   return cmd_header;
 }
 
-void* InProcCommandBuffer::AppendCmdData(const void* source_buffer,
-                                         device_size_t source_offset,
-                                         device_size_t source_length) {
-  auto* cmd_list = &current_cmd_list_;
-
-  uint8_t* allocated_bytes = cmd_list->arena.AllocateBytes(source_length);
-  std::memcpy(allocated_bytes,
-              static_cast<const uint8_t*>(source_buffer) + source_offset,
-              source_length);
-  return allocated_bytes;
+void InProcCommandBuffer::RetainResource(Resource* resource) {
+  if (resource && resource_set_.insert(resource).second) {
+    resources_.push_back(add_ref(resource));
+  }
 }
 
 Status InProcCommandBuffer::Process(CommandBuffer* command_processor) const {
@@ -188,15 +303,17 @@ Status InProcCommandBuffer::Process(CommandBuffer* command_processor) const {
   RETURN_IF_ERROR(command_processor->Begin());
 
   // Process each command in the order they were recorded.
-  auto* cmd_list = &current_cmd_list_;
-  for (CmdHeader* cmd_header = cmd_list->head; cmd_header != nullptr;
-       cmd_header = cmd_header->next) {
+  const uint8_t* cmd_ptr = cmd_stream_.data();
+  const uint8_t* cmd_end = cmd_ptr + cmd_stream_.size();
+  while (cmd_ptr < cmd_end) {
+    const auto* cmd_header = reinterpret_cast<const CmdHeader*>(cmd_ptr);
     auto command_status = ProcessCmd(cmd_header, command_processor);
     if (!command_status.ok()) {
       LOG(ERROR) << "DeviceQueue failure while executing command; permanently "
                     "failing all future commands: "
                  << command_status;
     }
+    cmd_ptr += cmd_header->size;
   }
 
   RETURN_IF_ERROR(command_processor->End());
@@ -204,54 +321,87 @@ Status InProcCommandBuffer::Process(CommandBuffer* command_processor) const {
   return OkStatus();
 }
 
-Status InProcCommandBuffer::ProcessCmd(CmdHeader* cmd_header,
+Status InProcCommandBuffer::ProcessCmd(const CmdHeader* cmd_header,
                                        CommandBuffer* command_processor) const {
+  const auto* cmd_data = reinterpret_cast<const uint8_t*>(cmd_header + 1);
   switch (cmd_header->type) {
     case CmdType::kExecutionBarrier: {
-      auto* cmd = reinterpret_cast<ExecutionBarrierCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const ExecutionBarrierCmd*>(cmd_data);
+      const uint8_t* ptr = cmd_data + AlignSize(sizeof(*cmd), kCmdAlignment);
+      auto memory_barriers = ReadArray<const MemoryBarrier>(
+          &ptr, cmd->memory_barrier_count, kCmdAlignment);
+      auto buffer_barriers = ReadArray<const BufferBarrier>(
+          &ptr, cmd->buffer_barrier_count, kCmdAlignment);
       return command_processor->ExecutionBarrier(
-          cmd->source_stage_mask, cmd->target_stage_mask, cmd->memory_barriers,
-          cmd->buffer_barriers);
+          cmd->source_stage_mask, cmd->target_stage_mask, memory_barriers,
+          buffer_barriers);
     }
     case CmdType::kSignalEvent: {
-      auto* cmd = reinterpret_cast<SignalEventCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const SignalEventCmd*>(cmd_data);
       return command_processor->SignalEvent(cmd->event, cmd->source_stage_mask);
     }
     case CmdType::kResetEvent: {
-      auto* cmd = reinterpret_cast<ResetEventCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const ResetEventCmd*>(cmd_data);
       return command_processor->ResetEvent(cmd->event, cmd->source_stage_mask);
     }
     case CmdType::kWaitEvents: {
-      auto* cmd = reinterpret_cast<WaitEventsCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const WaitEventsCmd*>(cmd_data);
+      const uint8_t* ptr = cmd_data + AlignSize(sizeof(*cmd), kCmdAlignment);
+      auto events = ReadArray<Event*>(&ptr, cmd->event_count, kCmdAlignment);
+      auto memory_barriers = ReadArray<const MemoryBarrier>(
+          &ptr, cmd->memory_barrier_count, kCmdAlignment);
+      auto buffer_barriers = ReadArray<const BufferBarrier>(
+          &ptr, cmd->buffer_barrier_count, kCmdAlignment);
       return command_processor->WaitEvents(
-          cmd->events, cmd->source_stage_mask, cmd->target_stage_mask,
-          cmd->memory_barriers, cmd->buffer_barriers);
+          events, cmd->source_stage_mask, cmd->target_stage_mask,
+          memory_barriers, buffer_barriers);
     }
     case CmdType::kFillBuffer: {
-      auto* cmd = reinterpret_cast<FillBufferCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const FillBufferCmd*>(cmd_data);
       return command_processor->FillBuffer(cmd->target_buffer,
                                            cmd->target_offset, cmd->length,
                                            cmd->pattern, cmd->pattern_length);
     }
     case CmdType::kDiscardBuffer: {
-      auto* cmd = reinterpret_cast<DiscardBufferCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const DiscardBufferCmd*>(cmd_data);
       return command_processor->DiscardBuffer(cmd->buffer);
     }
     case CmdType::kUpdateBuffer: {
-      auto* cmd = reinterpret_cast<UpdateBufferCmd*>(cmd_header + 1);
-      return command_processor->UpdateBuffer(cmd->source_buffer, 0,
-                                             cmd->target_buffer,
-                                             cmd->target_offset, cmd->length);
+      const auto* cmd = reinterpret_cast<const UpdateBufferCmd*>(cmd_data);
+      return command_processor->UpdateBuffer(
+          cmd_data + AlignSize(sizeof(*cmd), kCmdAlignment), 0,
+          cmd->target_buffer, cmd->target_offset, cmd->length);
     }
     case CmdType::kCopyBuffer: {
-      auto* cmd = reinterpret_cast<CopyBufferCmd*>(cmd_header + 1);
+      const auto* cmd = reinterpret_cast<const CopyBufferCmd*>(cmd_data);
       return command_processor->CopyBuffer(
           cmd->source_buffer, cmd->source_offset, cmd->target_buffer,
           cmd->target_offset, cmd->length);
     }
     case CmdType::kDispatch: {
-      auto* cmd = reinterpret_cast<DispatchCmd*>(cmd_header + 1);
-      return command_processor->Dispatch(cmd->request);
+      const auto* cmd = reinterpret_cast<const DispatchCmd*>(cmd_data);
+      const uint8_t* ptr = cmd_data + AlignSize(sizeof(*cmd), kCmdAlignment);
+      absl::InlinedVector<BufferBinding, 8> bindings(cmd->binding_count);
+      for (auto& binding : bindings) {
+        BindingEntry entry;
+        std::memcpy(&entry, ptr, sizeof(entry));
+        binding.buffer = entry.buffer;
+        binding.access = entry.access;
+        binding.shape = Shape(
+            reinterpret_cast<const int*>(ptr + sizeof(entry)), entry.rank);
+        binding.element_size = entry.element_size;
+        ptr += AlignSize(sizeof(entry) + entry.rank * sizeof(int),
+                         kCmdAlignment);
+      }
+      DispatchRequest request;
+      request.executable = cmd->executable;
+      request.entry_point = cmd->entry_point;
+      for (int i = 0; i < 3; ++i) {
+        request.workload[i] = cmd->workload[i];
+      }
+      request.workload_buffer = cmd->workload_buffer;
+      request.bindings = bindings;
+      return command_processor->Dispatch(request);
     }
     default:
       return DataLossErrorBuilder(IREE_LOC)
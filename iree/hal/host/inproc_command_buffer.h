@@ -15,19 +15,30 @@
 #ifndef IREE_HAL_HOST_INPROC_COMMAND_BUFFER_H_
 #define IREE_HAL_HOST_INPROC_COMMAND_BUFFER_H_
 
-#include "iree/base/arena.h"
-#include "iree/base/intrusive_list.h"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "iree/base/ref_ptr.h"
 #include "iree/base/status.h"
 #include "iree/hal/command_buffer.h"
+#include "iree/hal/resource.h"
 
 namespace iree {
 namespace hal {
 
 // In-process command buffer with support for recording and playback.
-// Commands are recorded into heap-allocated arenas with pointers to used
-// resources (Buffer*, etc). To replay a command buffer against a real
-// implementation use Process to call each command method as it was originally
-// recorded.
+// Commands are encoded into a single contiguous byte stream of fixed-size
+// headers followed by their payloads, with variable-length data such as
+// barriers, bindings, and update contents stored inline. The stream contains no
+// pointers into itself and so can be grown, copied, and cloned with memcpy.
+// To replay a command buffer against a real implementation use Process to call
+// each command method as it was originally recorded.
+//
+// Resources referenced by commands (buffers, events, executables) are retained
+// once per command buffer for as long as they are recorded into it and are
+// released on the next Begin or when the command buffer is destroyed.
 //
 // Thread-compatible (as with CommandBuffer itself).
 class InProcCommandBuffer final : public CommandBuffer {
@@ -38,6 +49,9 @@ class InProcCommandBuffer final : public CommandBuffer {
 
   bool is_recording() const override { return is_recording_; }
 
+  // Size in bytes of the encoded command stream.
+  size_t encoded_size() const { return cmd_stream_.size(); }
+
   Status Begin() override;
   Status End() override;
 
@@ -79,9 +93,17 @@ class InProcCommandBuffer final : public CommandBuffer {
   // The commands are issued in the order they were recorded.
   Status Process(CommandBuffer* command_processor) const;
 
+  // Returns a new command buffer with the same commands that can be processed
+  // independently of this one. The clone shares (and retains) all referenced
+  // resources. Must not be called while recording.
+  StatusOr<ref_ptr<InProcCommandBuffer>> Clone() const;
+
  private:
+  // Alignment of each command and of each inline array within the stream.
+  static constexpr size_t kCmdAlignment = 8;
+
   // Type of Cmd, used by CmdHeader to identify the command payload.
-  enum class CmdType {
+  enum class CmdType : uint32_t {
     kExecutionBarrier,
     kSignalEvent,
     kResetEvent,
@@ -93,40 +115,26 @@ class InProcCommandBuffer final : public CommandBuffer {
     kDispatch,
   };
 
-  // Prefix for commands encoded into the CmdList.
-  // This is used to identify the type of a command as well as connect commands
-  // in the list sequence. Command data immediately follows the header in
-  // memory.
+  // Prefix for commands encoded into the stream.
+  // Command data immediately follows the header and the next command begins
+  // |size| bytes after the start of the header.
   struct CmdHeader {
-    // Optional next command in the list.
-    CmdHeader* next;
     // Type of the command.
     CmdType type;
-  };
-
-  // A lightweight linked list of commands and an arena that stores them.
-  // CmdLists are designed to be reused so that the arena allocations are
-  // amortized across multiple uses.
-  //
-  // Note that this and the CmdHeader/Cmd types include raw pointers and as
-  // such are *not* portable across processes. It'd be possible, though, to
-  // extend this for cross-process use if a shared-memory Buffer was also
-  // implemented. For YAGNI we avoid that here.
-  struct CmdList : public IntrusiveLinkBase<void> {
-    static constexpr size_t kArenaBlockSize = 64 * 1024;
-
-    Arena arena{kArenaBlockSize};
-    CmdHeader* head = nullptr;
-    CmdHeader* tail = nullptr;
+    // Total size of the command including this header, padding, and any
+    // trailing inline data. Always a multiple of kCmdAlignment.
+    uint32_t size;
   };
 
   // Defines an execution barrier.
+  // Followed by MemoryBarrier[memory_barrier_count] and
+  // BufferBarrier[buffer_barrier_count].
   struct ExecutionBarrierCmd {
     static constexpr CmdType kType = CmdType::kExecutionBarrier;
     ExecutionStageBitfield source_stage_mask;
     ExecutionStageBitfield target_stage_mask;
-    absl::Span<const MemoryBarrier> memory_barriers;
-    absl::Span<const BufferBarrier> buffer_barriers;
+    uint32_t memory_barrier_count;
+    uint32_t buffer_barrier_count;
   };
 
   // Signals an event.
@@ -144,13 +152,15 @@ class InProcCommandBuffer final : public CommandBuffer {
   };
 
   // Waits for one or more events.
+  // Followed by Event*[event_count], MemoryBarrier[memory_barrier_count], and
+  // BufferBarrier[buffer_barrier_count].
   struct WaitEventsCmd {
     static constexpr CmdType kType = CmdType::kWaitEvents;
-    absl::Span<Event*> events;
     ExecutionStageBitfield source_stage_mask;
     ExecutionStageBitfield target_stage_mask;
-    absl::Span<const MemoryBarrier> memory_barriers;
-    absl::Span<const BufferBarrier> buffer_barriers;
+    uint32_t event_count;
+    uint32_t memory_barrier_count;
+    uint32_t buffer_barrier_count;
   };
 
   // Fills the target buffer with the given repeating value.
@@ -160,7 +170,7 @@ class InProcCommandBuffer final : public CommandBuffer {
     device_size_t target_offset;
     device_size_t length;
     uint8_t pattern[4];
-    size_t pattern_length;
+    uint32_t pattern_length;
   };
 
   // Hints to the device queue that the given buffer will not be used again.
@@ -170,10 +180,9 @@ class InProcCommandBuffer final : public CommandBuffer {
   };
 
   // Writes a range of the given target buffer from the embedded memory.
-  // The source buffer contents immediately follow the command in the arena.
+  // Followed by |length| bytes of source data.
   struct UpdateBufferCmd {
     static constexpr CmdType kType = CmdType::kUpdateBuffer;
-    const void* source_buffer;
     Buffer* target_buffer;
     device_size_t target_offset;
     device_size_t length;
@@ -190,49 +199,64 @@ class InProcCommandBuffer final : public CommandBuffer {
   };
 
   // Dispatches an execution request.
+  // Followed by |binding_count| BindingEntry values, each immediately followed
+  // by its shape dimensions as int[rank].
   struct DispatchCmd {
     static constexpr CmdType kType = CmdType::kDispatch;
-    DispatchRequest request;
+    Executable* executable;
+    Buffer* workload_buffer;
+    int32_t entry_point;
+    int32_t workload[3];
+    uint32_t binding_count;
   };
 
-  // Resets the command list.
+  // Flattened BufferBinding; Shape is not trivially copyable and so the
+  // dimensions are stored inline after the entry instead.
+  struct BindingEntry {
+    Buffer* buffer;
+    MemoryAccessBitfield access;
+    int32_t rank;
+    int8_t element_size;
+  };
+
+  // Releases all recorded commands and retained resources.
   void Reset();
 
-  // Allocates a command and appends it to the current command list.
-  // The caller must populate the fields in the returned pointer.
+  // Appends a command of type T with |trailing_size| bytes of inline data.
+  // The returned command is zeroed and the trailing data follows it at
+  // kCmdAlignment. The pointer is only valid until the next append.
   template <typename T>
-  StatusOr<T*> AppendCmd() {
-    return reinterpret_cast<T*>(AppendCmdHeader(T::kType, sizeof(T)) + 1);
+  T* AppendCmd(size_t trailing_size) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Commands must be trivially copyable");
+    return reinterpret_cast<T*>(
+        AppendCmdHeader(T::kType, sizeof(T), trailing_size) + 1);
   }
 
   // Appends a command with the given |type| and payload |cmd_size| prefixed
-  // with a CmdHeader. Returns a pointer to the CmdHeader that is followed
-  // immediately by |cmd_size| zero bytes.
-  CmdHeader* AppendCmdHeader(CmdType type, size_t cmd_size);
+  // with a CmdHeader and followed by |trailing_size| bytes. Returns a pointer
+  // to the CmdHeader that is followed by zeroed storage.
+  CmdHeader* AppendCmdHeader(CmdType type, size_t cmd_size,
+                             size_t trailing_size);
 
-  // Appends a byte buffer to the command buffer and returns a pointer to the
-  // copied data within the command buffer arena.
-  void* AppendCmdData(const void* source_buffer, device_size_t source_offset,
-                      device_size_t source_length);
-
-  // Appends a span of POD structs to the current CmdList and returns a span
-  // pointing into the CmdList arena.
-  template <typename T>
-  absl::Span<T> AppendStructSpan(absl::Span<T> value) {
-    static_assert(std::is_standard_layout<T>::value,
-                  "Struct must be a POD type");
-    void* data_ptr = AppendCmdData(value.data(), 0, value.size() * sizeof(T));
-    return absl::MakeSpan(static_cast<T*>(data_ptr), value.size());
-  }
+  // Retains |resource| for the lifetime of the recorded commands.
+  void RetainResource(Resource* resource);
 
   // Processes a single command.
-  Status ProcessCmd(CmdHeader* cmd_header,
+  Status ProcessCmd(const CmdHeader* cmd_header,
                     CommandBuffer* command_processor) const;
 
   bool is_recording_ = false;
 
   // NOTE: not synchronized. Expected to be used from a single thread.
-  CmdList current_cmd_list_;
+  // Encoded commands; capacity is kept across resets so that re-recording
+  // does not allocate once the stream has grown to its steady-state size.
+  std::vector<uint8_t> cmd_stream_;
+
+  // Resources referenced by the recorded commands. Each resource is retained
+  // by resources_ once regardless of how many commands reference it.
+  absl::flat_hash_set<Resource*> resource_set_;
+  std::vector<ref_ptr<Resource>> resources_;
 };
 
 }  // namespace hal
@@ -0,0 +1,203 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/inproc_command_buffer.h"
+
+#include <cstring>
+
+#include "iree/base/status_matchers.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/testing/mock_command_buffer.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class InProcCommandBufferTest : public ::testing::Test {
+ protected:
+  ref_ptr<InProcCommandBuffer> CreateCommandBuffer() {
+    return make_ref<InProcCommandBuffer>(
+        /*allocator=*/nullptr, CommandBufferMode::kOneShot,
+        CommandCategory::kTransfer | CommandCategory::kDispatch);
+  }
+
+  testing::MockCommandBuffer mock_processor_{
+      /*allocator=*/nullptr, CommandBufferMode::kOneShot,
+      CommandCategory::kTransfer | CommandCategory::kDispatch};
+};
+
+TEST_F(InProcCommandBufferTest, Empty) {
+  auto command_buffer = CreateCommandBuffer();
+  ASSERT_OK(command_buffer->Begin());
+  EXPECT_TRUE(command_buffer->is_recording());
+  ASSERT_OK(command_buffer->End());
+  EXPECT_FALSE(command_buffer->is_recording());
+  EXPECT_EQ(0, command_buffer->encoded_size());
+
+  InSequence sequence;
+  EXPECT_CALL(mock_processor_, Begin()).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, End()).WillOnce(Return(OkStatus()));
+  EXPECT_OK(command_buffer->Process(&mock_processor_));
+}
+
+// Tests that variable-length command data round-trips through the stream.
+TEST_F(InProcCommandBufferTest, ReplaysInlineData) {
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll, 64);
+  auto command_buffer = CreateCommandBuffer();
+  ASSERT_OK(command_buffer->Begin());
+
+  MemoryBarrier memory_barrier;
+  memory_barrier.source_scope = AccessScope::kTransferWrite;
+  memory_barrier.target_scope = AccessScope::kDispatchRead;
+  BufferBarrier buffer_barrier;
+  buffer_barrier.buffer = buffer.get();
+  buffer_barrier.offset = 4;
+  buffer_barrier.length = 8;
+  ASSERT_OK(command_buffer->ExecutionBarrier(
+      ExecutionStage::kTransfer, ExecutionStage::kDispatch, {memory_barrier},
+      {buffer_barrier}));
+
+  // An odd length ensures the following command is realigned.
+  const char kUpdateData[] = "abcdefghi";
+  ASSERT_OK(command_buffer->UpdateBuffer(kUpdateData, 1, buffer.get(), 2, 7));
+
+  uint16_t pattern = 0xABCD;
+  ASSERT_OK(command_buffer->FillBuffer(buffer.get(), 0, 16, &pattern,
+                                       sizeof(pattern)));
+
+  // The second binding has a rank that exceeds the Shape inline storage.
+  BufferBinding bindings[2] = {
+      {MemoryAccess::kRead, buffer.get(), Shape{4}, 4},
+      {MemoryAccess::kWrite, buffer.get(), Shape{1, 1, 2, 1, 1, 2, 2}, 2},
+  };
+  DispatchRequest dispatch_request;
+  dispatch_request.entry_point = 3;
+  dispatch_request.workload = {4, 5, 6};
+  dispatch_request.bindings = bindings;
+  ASSERT_OK(command_buffer->Dispatch(dispatch_request));
+  ASSERT_OK(command_buffer->End());
+
+  InSequence sequence;
+  EXPECT_CALL(mock_processor_, Begin()).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, ExecutionBarrier(ExecutionStage::kTransfer,
+                                                ExecutionStage::kDispatch, _,
+                                                _))
+      .WillOnce(Invoke([&](ExecutionStageBitfield, ExecutionStageBitfield,
+                           absl::Span<const MemoryBarrier> memory_barriers,
+                           absl::Span<const BufferBarrier> buffer_barriers) {
+        EXPECT_EQ(1, memory_barriers.size());
+        EXPECT_EQ(AccessScope::kTransferWrite,
+                  memory_barriers[0].source_scope);
+        EXPECT_EQ(AccessScope::kDispatchRead, memory_barriers[0].target_scope);
+        EXPECT_EQ(1, buffer_barriers.size());
+        EXPECT_EQ(buffer.get(), buffer_barriers[0].buffer);
+        EXPECT_EQ(4, buffer_barriers[0].offset);
+        EXPECT_EQ(8, buffer_barriers[0].length);
+        return OkStatus();
+      }));
+  EXPECT_CALL(mock_processor_, UpdateBuffer(_, 0, buffer.get(), 2, 7))
+      .WillOnce(Invoke([](const void* source_buffer, device_size_t,
+                          Buffer*, device_size_t, device_size_t length) {
+        EXPECT_EQ(0, std::memcmp(source_buffer, "bcdefgh", length));
+        return OkStatus();
+      }));
+  EXPECT_CALL(mock_processor_, FillBuffer(buffer.get(), 0, 16, _, 2))
+      .WillOnce(Invoke([](Buffer*, device_size_t, device_size_t,
+                          const void* pattern, size_t pattern_length) {
+        uint16_t value = 0;
+        std::memcpy(&value, pattern, pattern_length);
+        EXPECT_EQ(0xABCD, value);
+        return OkStatus();
+      }));
+  EXPECT_CALL(mock_processor_, Dispatch(_))
+      .WillOnce(Invoke([&](const DispatchRequest& request) {
+        EXPECT_EQ(nullptr, request.executable);
+        EXPECT_EQ(3, request.entry_point);
+        EXPECT_THAT(request.workload, ElementsAre(4, 5, 6));
+        EXPECT_EQ(nullptr, request.workload_buffer);
+        EXPECT_EQ(2, request.bindings.size());
+        EXPECT_EQ(MemoryAccess::kRead, request.bindings[0].access);
+        EXPECT_EQ(buffer.get(), request.bindings[0].buffer);
+        EXPECT_EQ(Shape({4}), request.bindings[0].shape);
+        EXPECT_EQ(4, request.bindings[0].element_size);
+        EXPECT_EQ(MemoryAccess::kWrite, request.bindings[1].access);
+        EXPECT_EQ(Shape({1, 1, 2, 1, 1, 2, 2}), request.bindings[1].shape);
+        EXPECT_EQ(8, request.bindings[1].shape.element_count());
+        EXPECT_EQ(2, request.bindings[1].element_size);
+        return OkStatus();
+      }));
+  EXPECT_CALL(mock_processor_, End()).WillOnce(Return(OkStatus()));
+  EXPECT_OK(command_buffer->Process(&mock_processor_));
+}
+
+// Tests that referenced resources outlive the caller's references.
+TEST_F(InProcCommandBufferTest, RetainsResources) {
+  auto command_buffer = CreateCommandBuffer();
+  ASSERT_OK(command_buffer->Begin());
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll, 16);
+  Buffer* buffer_ptr = buffer.get();
+  ASSERT_OK(command_buffer->DiscardBuffer(buffer_ptr));
+  ASSERT_OK(command_buffer->CopyBuffer(buffer_ptr, 0, buffer_ptr, 8, 8));
+  ASSERT_OK(command_buffer->End());
+  buffer.reset();
+
+  InSequence sequence;
+  EXPECT_CALL(mock_processor_, Begin()).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, DiscardBuffer(buffer_ptr))
+      .WillOnce(Invoke([](Buffer* buffer) {
+        EXPECT_EQ(16, buffer->byte_length());
+        return OkStatus();
+      }));
+  EXPECT_CALL(mock_processor_, CopyBuffer(buffer_ptr, 0, buffer_ptr, 8, 8))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, End()).WillOnce(Return(OkStatus()));
+  EXPECT_OK(command_buffer->Process(&mock_processor_));
+}
+
+TEST_F(InProcCommandBufferTest, Clone) {
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll, 16);
+  auto command_buffer = CreateCommandBuffer();
+  ASSERT_OK(command_buffer->Begin());
+  ASSERT_OK(command_buffer->DiscardBuffer(buffer.get()));
+  EXPECT_TRUE(IsFailedPrecondition(command_buffer->Clone().status()));
+  ASSERT_OK(command_buffer->End());
+
+  ASSERT_OK_AND_ASSIGN(auto clone, command_buffer->Clone());
+  EXPECT_EQ(command_buffer->encoded_size(), clone->encoded_size());
+  EXPECT_EQ(command_buffer->mode(), clone->mode());
+
+  // Re-recording the original must not affect the clone.
+  ASSERT_OK(command_buffer->Begin());
+  ASSERT_OK(command_buffer->End());
+  command_buffer.reset();
+
+  InSequence sequence;
+  EXPECT_CALL(mock_processor_, Begin()).WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, DiscardBuffer(Eq(buffer.get())))
+      .WillOnce(Return(OkStatus()));
+  EXPECT_CALL(mock_processor_, End()).WillOnce(Return(OkStatus()));
+  EXPECT_OK(clone->Process(&mock_processor_));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
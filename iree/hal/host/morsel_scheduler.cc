@@ -0,0 +1,126 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/morsel_scheduler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "iree/base/logging.h"
+#include "iree/base/tracing.h"
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+// Morsels larger than this many elements are rounded to a multiple of it so
+// that they start on cache line (and SIMD vector) boundaries for all element
+// types. Smaller morsels are only produced for large elements, such as the rows
+// of a copy, and are left as-is.
+constexpr size_t kMorselElementAlignment = 64;
+
+}  // namespace
+
+MorselScheduler::MorselScheduler(HostThreadPool* thread_pool, Options options)
+    : thread_pool_(thread_pool), options_(std::move(options)) {
+  CHECK(!options_.grain_bytes_candidates.empty());
+}
+
+size_t MorselScheduler::tuned_grain_bytes(Key key) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = tuners_.find(key);
+  if (it == tuners_.end() ||
+      it->second.next_candidate < options_.grain_bytes_candidates.size()) {
+    return 0;
+  }
+  return it->second.grain_bytes;
+}
+
+size_t MorselScheduler::SelectGrainBytes(Key key, int* candidate_index) {
+  const auto& candidates = options_.grain_bytes_candidates;
+  absl::MutexLock lock(&mutex_);
+  auto& tuner = tuners_[key];
+  if (tuner.next_candidate >= candidates.size()) {
+    if (++tuner.runs_since_tune < options_.retune_interval) {
+      *candidate_index = -1;
+      return tuner.grain_bytes;
+    }
+    // Re-tune in case the working set or machine load has changed.
+    tuner.next_candidate = 0;
+    tuner.runs_since_tune = 0;
+  }
+  if (tuner.next_candidate == 0) {
+    tuner.nanos_per_byte.assign(candidates.size(),
+                                std::numeric_limits<double>::infinity());
+  }
+  *candidate_index = static_cast<int>(tuner.next_candidate++);
+  return candidates[*candidate_index];
+}
+
+void MorselScheduler::RecordRun(Key key, int candidate_index,
+                                size_t byte_count, int64_t duration_nanos) {
+  absl::MutexLock lock(&mutex_);
+  auto& tuner = tuners_[key];
+  if (static_cast<size_t>(candidate_index) >= tuner.nanos_per_byte.size()) {
+    return;  // Raced with the start of a re-tune.
+  }
+  tuner.nanos_per_byte[candidate_index] =
+      static_cast<double>(duration_nanos) / byte_count;
+  auto best = std::min_element(tuner.nanos_per_byte.begin(),
+                               tuner.nanos_per_byte.end());
+  tuner.grain_bytes = options_.grain_bytes_candidates[std::distance(
+      tuner.nanos_per_byte.begin(), best)];
+}
+
+Status MorselScheduler::ParallelForMorsels(
+    Key key, size_t element_count, size_t bytes_per_element,
+    const std::function<Status(size_t, size_t)>& fn) {
+  IREE_TRACE_SCOPE0("MorselScheduler::ParallelFor");
+
+  int candidate_index = -1;
+  size_t grain_bytes = SelectGrainBytes(key, &candidate_index);
+  size_t grain_elements = std::max(size_t{1}, grain_bytes / bytes_per_element);
+  if (grain_elements > kMorselElementAlignment) {
+    grain_elements = (grain_elements + kMorselElementAlignment - 1) /
+                     kMorselElementAlignment * kMorselElementAlignment;
+  }
+  size_t morsel_count = (element_count + grain_elements - 1) / grain_elements;
+
+  absl::Mutex status_mutex;
+  Status status;
+  int64_t start_nanos = absl::GetCurrentTimeNanos();
+  thread_pool_->ParallelFor(morsel_count, [&](int morsel_index) {
+    size_t begin = morsel_index * grain_elements;
+    size_t end = std::min(element_count, begin + grain_elements);
+    Status morsel_status = fn(begin, end);
+    if (!morsel_status.ok()) {
+      absl::MutexLock lock(&status_mutex);
+      if (status.ok()) status = std::move(morsel_status);
+    }
+  });
+  int64_t duration_nanos = absl::GetCurrentTimeNanos() - start_nanos;
+
+  if (candidate_index != -1) {
+    RecordRun(key, candidate_index, element_count * bytes_per_element,
+              duration_nanos);
+  }
+  return status;
+}
+
+}  // namespace hal
+}  // namespace iree
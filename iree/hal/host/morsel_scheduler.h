@@ -0,0 +1,128 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_MORSEL_SCHEDULER_H_
+#define IREE_HAL_HOST_MORSEL_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/status.h"
+#include "iree/hal/host/host_thread_pool.h"
+
+namespace iree {
+namespace hal {
+
+// Splits large data-parallel kernels into cache-sized morsels of contiguous
+// elements that run on a HostThreadPool.
+//
+// Small invocations run inline on the calling thread. Larger ones are split
+// into morsels whose size (the grain) is autotuned per kernel: the first runs
+// of each kernel try each candidate grain and measure throughput, after which
+// the fastest grain is used until the next periodic re-tune. This lets memory
+// bound kernels (copies, adds) settle on larger morsels than compute bound ones
+// (exp, tanh) without any per-kernel configuration.
+//
+// MorselScheduler is thread-safe.
+class MorselScheduler final {
+ public:
+  struct Options {
+    // Invocations touching fewer bytes than this run inline.
+    size_t min_parallel_bytes = 1024 * 1024;
+
+    // Grain sizes, in bytes touched per morsel, tried by the autotuner. These
+    // span L1 to L2 sized working sets on common cores.
+    std::vector<size_t> grain_bytes_candidates = {
+        32 * 1024, 64 * 1024, 128 * 1024, 256 * 1024, 512 * 1024,
+    };
+
+    // Number of parallel runs of a kernel between re-tunes.
+    int retune_interval = 1024;
+  };
+
+  // Identifies a kernel for grain tuning; see KeyFor.
+  using Key = const void*;
+
+  // Returns a unique key for the type |KERNEL|.
+  template <typename KERNEL>
+  static Key KeyFor() {
+    static const char key = 0;
+    return &key;
+  }
+
+  // |thread_pool| must outlive the scheduler.
+  MorselScheduler(HostThreadPool* thread_pool, Options options);
+  explicit MorselScheduler(HostThreadPool* thread_pool)
+      : MorselScheduler(thread_pool, Options{}) {}
+
+  MorselScheduler(const MorselScheduler&) = delete;
+  MorselScheduler& operator=(const MorselScheduler&) = delete;
+
+  // Runs |fn|(begin, end) over disjoint ranges covering [0, element_count) and
+  // returns the first error produced, if any. |bytes_per_element| is the total
+  // number of bytes read and written for each element across all operands.
+  template <typename FN>
+  Status ParallelFor(Key key, size_t element_count, size_t bytes_per_element,
+                     FN&& fn) {
+    if (element_count * bytes_per_element < options_.min_parallel_bytes ||
+        thread_pool_->thread_count() == 1) {
+      return fn(size_t{0}, element_count);
+    }
+    return ParallelForMorsels(key, element_count, bytes_per_element,
+                              std::forward<FN>(fn));
+  }
+
+  // Returns the tuned grain for |key| in bytes or 0 if it is still being tuned.
+  size_t tuned_grain_bytes(Key key) const;
+
+ private:
+  struct Tuner {
+    // Index of the next candidate grain to measure. Once every candidate has
+    // been tried the kernel runs with |grain_bytes| until the next re-tune.
+    size_t next_candidate = 0;
+    // Measured cost of each candidate; infinity if not yet measured.
+    std::vector<double> nanos_per_byte;
+    // Fastest candidate measured so far.
+    size_t grain_bytes = 0;
+    int runs_since_tune = 0;
+  };
+
+  Status ParallelForMorsels(
+      Key key, size_t element_count, size_t bytes_per_element,
+      const std::function<Status(size_t, size_t)>& fn);
+
+  // Returns the grain to use for the next run of |key| and the index of the
+  // candidate it measures, or -1 if the run is not part of tuning.
+  size_t SelectGrainBytes(Key key, int* candidate_index);
+
+  void RecordRun(Key key, int candidate_index, size_t byte_count,
+                 int64_t duration_nanos);
+
+  HostThreadPool* const thread_pool_;
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<Key, Tuner> tuners_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_MORSEL_SCHEDULER_H_
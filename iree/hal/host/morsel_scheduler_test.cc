@@ -0,0 +1,132 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/morsel_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+struct TestKernel {};
+
+HostThreadPool::Options ThreadPoolOptions(int thread_count) {
+  HostThreadPool::Options options;
+  options.thread_count = thread_count;
+  return options;
+}
+
+MorselScheduler::Options SchedulerOptions() {
+  MorselScheduler::Options options;
+  options.min_parallel_bytes = 1024;
+  options.grain_bytes_candidates = {256, 1024, 4096};
+  options.retune_interval = 4;
+  return options;
+}
+
+// Tests that every element is covered by exactly one morsel.
+TEST(MorselSchedulerTest, CoversAllElements) {
+  HostThreadPool thread_pool(ThreadPoolOptions(4));
+  MorselScheduler scheduler(&thread_pool, SchedulerOptions());
+
+  std::vector<std::atomic<int>> counts(100000);
+  for (int run = 0; run < 10; ++run) {
+    ASSERT_OK(scheduler.ParallelFor(
+        MorselScheduler::KeyFor<TestKernel>(), counts.size(), sizeof(float),
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) ++counts[i];
+          return OkStatus();
+        }));
+  }
+  for (const auto& count : counts) {
+    EXPECT_EQ(10, count.load());
+  }
+}
+
+// Tests that small invocations run as a single range on the caller.
+TEST(MorselSchedulerTest, SmallRunsInline) {
+  HostThreadPool thread_pool(ThreadPoolOptions(4));
+  MorselScheduler scheduler(&thread_pool, SchedulerOptions());
+
+  std::thread::id caller_id = std::this_thread::get_id();
+  int call_count = 0;
+  ASSERT_OK(scheduler.ParallelFor(MorselScheduler::KeyFor<TestKernel>(), 16,
+                                  sizeof(float),
+                                  [&](size_t begin, size_t end) {
+                                    EXPECT_EQ(caller_id,
+                                              std::this_thread::get_id());
+                                    EXPECT_EQ(0, begin);
+                                    EXPECT_EQ(16, end);
+                                    ++call_count;
+                                    return OkStatus();
+                                  }));
+  EXPECT_EQ(1, call_count);
+  EXPECT_EQ(0,
+            scheduler.tuned_grain_bytes(MorselScheduler::KeyFor<TestKernel>()));
+}
+
+// Tests that a grain is chosen from the candidates after each was measured.
+TEST(MorselSchedulerTest, TunesGrain) {
+  HostThreadPool thread_pool(ThreadPoolOptions(2));
+  auto options = SchedulerOptions();
+  MorselScheduler scheduler(&thread_pool, options);
+  auto key = MorselScheduler::KeyFor<TestKernel>();
+
+  std::vector<float> values(64 * 1024);
+  auto fn = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) values[i] += 1.0f;
+    return OkStatus();
+  };
+  for (int i = 0; i < options.grain_bytes_candidates.size(); ++i) {
+    EXPECT_EQ(0, scheduler.tuned_grain_bytes(key));
+    ASSERT_OK(scheduler.ParallelFor(key, values.size(), sizeof(float), fn));
+  }
+  size_t grain_bytes = scheduler.tuned_grain_bytes(key);
+  EXPECT_NE(options.grain_bytes_candidates.end(),
+            std::find(options.grain_bytes_candidates.begin(),
+                      options.grain_bytes_candidates.end(), grain_bytes));
+
+  // Runs with the tuned grain until the re-tune interval has passed.
+  for (int i = 1; i < options.retune_interval; ++i) {
+    ASSERT_OK(scheduler.ParallelFor(key, values.size(), sizeof(float), fn));
+    EXPECT_EQ(grain_bytes, scheduler.tuned_grain_bytes(key));
+  }
+  ASSERT_OK(scheduler.ParallelFor(key, values.size(), sizeof(float), fn));
+  EXPECT_EQ(0, scheduler.tuned_grain_bytes(key));
+}
+
+// Tests that errors from a morsel are returned to the caller.
+TEST(MorselSchedulerTest, PropagatesErrors) {
+  HostThreadPool thread_pool(ThreadPoolOptions(4));
+  MorselScheduler scheduler(&thread_pool, SchedulerOptions());
+
+  auto status = scheduler.ParallelFor(
+      MorselScheduler::KeyFor<TestKernel>(), 100000, sizeof(float),
+      [&](size_t begin, size_t end) -> Status {
+        if (begin == 0) return InvalidArgumentErrorBuilder(IREE_LOC) << "fail";
+        return OkStatus();
+      });
+  EXPECT_TRUE(IsInvalidArgument(status));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,182 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/numa_topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "iree/base/logging.h"
+#include "iree/base/target_platform.h"
+
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#define IREE_HAL_HOST_NUMA_LINUX 1
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_ANDROID
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+#if defined(IREE_HAL_HOST_NUMA_LINUX)
+
+constexpr char kSysfsNodePath[] = "/sys/devices/system/node";
+
+// Mirrors MPOL_PREFERRED from <numaif.h>, which is only shipped with libnuma.
+constexpr int kMemoryPolicyPreferred = 1;
+
+// Reads the first line of a sysfs file.
+StatusOr<std::string> ReadSysfsLine(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  if (!file || !std::getline(file, line)) {
+    return UnavailableErrorBuilder(IREE_LOC) << "Unable to read " << path;
+  }
+  return line;
+}
+
+StatusOr<std::vector<NumaNode>> QueryLinuxNumaNodes() {
+  ASSIGN_OR_RETURN(auto online_list,
+                   ReadSysfsLine(absl::StrCat(kSysfsNodePath, "/online")));
+  ASSIGN_OR_RETURN(auto node_ids, ParseCpuList(online_list));
+  std::vector<NumaNode> nodes;
+  for (int node_id : node_ids) {
+    ASSIGN_OR_RETURN(auto cpu_list,
+                     ReadSysfsLine(absl::StrCat(kSysfsNodePath, "/node",
+                                                node_id, "/cpulist")));
+    NumaNode node;
+    node.id = node_id;
+    ASSIGN_OR_RETURN(node.cpu_ids, ParseCpuList(cpu_list));
+    // Memory-only nodes can't host devices.
+    if (!node.cpu_ids.empty()) nodes.push_back(std::move(node));
+  }
+  return nodes;
+}
+
+#endif  // IREE_HAL_HOST_NUMA_LINUX
+
+}  // namespace
+
+std::vector<NumaNode> QueryNumaNodes() {
+#if defined(IREE_HAL_HOST_NUMA_LINUX)
+  auto nodes_or = QueryLinuxNumaNodes();
+  if (nodes_or.ok() && !nodes_or.ValueOrDie().empty()) {
+    return std::move(nodes_or).ValueOrDie();
+  }
+  if (!nodes_or.ok()) {
+    VLOG(1) << "NUMA topology unavailable: " << nodes_or.status();
+  }
+#endif  // IREE_HAL_HOST_NUMA_LINUX
+  return {NumaNode{}};
+}
+
+StatusOr<std::vector<int>> ParseCpuList(absl::string_view cpu_list) {
+  std::vector<int> cpu_ids;
+  for (auto range : absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                                   absl::SkipWhitespace())) {
+    // Ranges are either "N" or "N-M".
+    size_t dash = range.find('-');
+    absl::string_view first_str = range.substr(0, dash);
+    absl::string_view last_str =
+        dash == absl::string_view::npos ? first_str : range.substr(dash + 1);
+    int first = 0;
+    int last = 0;
+    if (!absl::SimpleAtoi(first_str, &first) ||
+        !absl::SimpleAtoi(last_str, &last) ||
+        first < 0 || last < first) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid CPU list range '" << range << "'";
+    }
+    for (int cpu_id = first; cpu_id <= last; ++cpu_id) {
+      cpu_ids.push_back(cpu_id);
+    }
+  }
+  return cpu_ids;
+}
+
+int GetCurrentNumaNode() {
+#if defined(IREE_HAL_HOST_NUMA_LINUX) && defined(SYS_getcpu)
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif  // IREE_HAL_HOST_NUMA_LINUX && SYS_getcpu
+  return -1;
+}
+
+Status BindMemoryToNumaNode(void* ptr, size_t size, int node_id) {
+  if (node_id < 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid NUMA node " << node_id;
+  }
+#if defined(IREE_HAL_HOST_NUMA_LINUX) && defined(SYS_mbind)
+  constexpr int kBitsPerWord = sizeof(unsigned long) * 8;  // NOLINT
+  std::vector<unsigned long> node_mask(  // NOLINT
+      node_id / kBitsPerWord + 1, 0);
+  node_mask[node_id / kBitsPerWord] = 1ul << (node_id % kBitsPerWord);
+  // The kernel reads one bit less than maxnode.
+  unsigned long max_node = node_mask.size() * kBitsPerWord + 1;  // NOLINT
+  if (::syscall(SYS_mbind, ptr, size, kMemoryPolicyPreferred, node_mask.data(),
+                max_node, 0) != 0) {
+    return UnavailableErrorBuilder(IREE_LOC)
+           << "mbind to NUMA node " << node_id
+           << " failed: " << std::strerror(errno);
+  }
+  return OkStatus();
+#else
+  return UnimplementedErrorBuilder(IREE_LOC)
+         << "NUMA memory binding not supported on this platform";
+#endif  // IREE_HAL_HOST_NUMA_LINUX && SYS_mbind
+}
+
+void PinThreadToCpus(std::thread* thread, absl::Span<const int> cpu_ids) {
+#if defined(IREE_HAL_HOST_NUMA_LINUX)
+  if (cpu_ids.empty()) return;
+  // Sized dynamically as hosts may have more CPUs than the CPU_SETSIZE of a
+  // fixed cpu_set_t.
+  int cpu_count = *std::max_element(cpu_ids.begin(), cpu_ids.end()) + 1;
+  if (cpu_count <= 0) return;
+  cpu_set_t* cpu_set = CPU_ALLOC(cpu_count);
+  if (!cpu_set) return;
+  size_t cpu_set_size = CPU_ALLOC_SIZE(cpu_count);
+  CPU_ZERO_S(cpu_set_size, cpu_set);
+  for (int cpu_id : cpu_ids) {
+    if (cpu_id >= 0) CPU_SET_S(cpu_id, cpu_set_size, cpu_set);
+  }
+  int result = pthread_setaffinity_np(thread->native_handle(), cpu_set_size,
+                                      cpu_set);
+  CPU_FREE(cpu_set);
+  if (result != 0) {
+    LOG(WARNING) << "Unable to pin thread to CPUs "
+                 << absl::StrJoin(cpu_ids, ",") << " (error " << result << ")";
+  }
+#endif  // IREE_HAL_HOST_NUMA_LINUX
+}
+
+}  // namespace hal
+}  // namespace iree
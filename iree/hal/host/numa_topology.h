@@ -0,0 +1,62 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_NUMA_TOPOLOGY_H_
+#define IREE_HAL_HOST_NUMA_TOPOLOGY_H_
+
+#include <cstddef>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+
+namespace iree {
+namespace hal {
+
+// A NUMA node and the CPUs local to it.
+struct NumaNode {
+  // OS node id as used by mbind and DeviceInfo::numa_node.
+  int id = 0;
+  // OS CPU ids local to the node in ascending order.
+  std::vector<int> cpu_ids;
+};
+
+// Returns the NUMA nodes of the system that have at least one CPU, ordered by
+// node id. On platforms without NUMA support, or if the topology cannot be
+// queried, returns a single node 0 with no CPUs listed.
+std::vector<NumaNode> QueryNumaNodes();
+
+// Parses a Linux cpulist string such as "0-3,8,10-11" into the listed ids.
+StatusOr<std::vector<int>> ParseCpuList(absl::string_view cpu_list);
+
+// Returns the NUMA node the calling thread is currently running on, or -1 if
+// unknown. The result may change at any time unless the thread is pinned.
+int GetCurrentNumaNode();
+
+// Sets the preferred NUMA node of the pages in [ptr, ptr + size). Pages not yet
+// faulted in are allocated from |node_id| while it has free memory. |ptr| must
+// be page aligned.
+Status BindMemoryToNumaNode(void* ptr, size_t size, int node_id);
+
+// Restricts |thread| to run on any of |cpu_ids|. Logs a warning and leaves the
+// thread unpinned on failure. No-op on platforms without thread affinity
+// support or if |cpu_ids| is empty.
+void PinThreadToCpus(std::thread* thread, absl::Span<const int> cpu_ids);
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_NUMA_TOPOLOGY_H_
@@ -0,0 +1,82 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/numa_topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+
+#include "iree/base/status_matchers.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(NumaTopologyTest, ParseCpuList) {
+  ASSERT_OK_AND_ASSIGN(auto empty, ParseCpuList(""));
+  EXPECT_THAT(empty, IsEmpty());
+  ASSERT_OK_AND_ASSIGN(auto single, ParseCpuList("3\n"));
+  EXPECT_THAT(single, ElementsAre(3));
+  ASSERT_OK_AND_ASSIGN(auto ranges, ParseCpuList("0-2,8,10-11"));
+  EXPECT_THAT(ranges, ElementsAre(0, 1, 2, 8, 10, 11));
+}
+
+TEST(NumaTopologyTest, ParseCpuListInvalid) {
+  EXPECT_TRUE(IsInvalidArgument(ParseCpuList("a").status()));
+  EXPECT_TRUE(IsInvalidArgument(ParseCpuList("3-1").status()));
+  EXPECT_TRUE(IsInvalidArgument(ParseCpuList("1-").status()));
+  EXPECT_TRUE(IsInvalidArgument(ParseCpuList("-1").status()));
+}
+
+// Tests that at least one node is always reported, with sorted unique CPUs.
+TEST(NumaTopologyTest, QueryNumaNodes) {
+  auto nodes = QueryNumaNodes();
+  ASSERT_FALSE(nodes.empty());
+  for (const auto& node : nodes) {
+    EXPECT_GE(node.id, 0);
+    EXPECT_TRUE(std::is_sorted(node.cpu_ids.begin(), node.cpu_ids.end()));
+    EXPECT_EQ(node.cpu_ids.end(),
+              std::adjacent_find(node.cpu_ids.begin(), node.cpu_ids.end()));
+  }
+}
+
+TEST(NumaTopologyTest, BindMemoryInvalidNode) {
+  int value = 0;
+  EXPECT_TRUE(IsInvalidArgument(BindMemoryToNumaNode(&value, sizeof(value),
+                                                     /*node_id=*/-1)));
+}
+
+// Pinning must tolerate CPU ids beyond the fixed cpu_set_t size, as found on
+// hosts with more than 1024 CPUs.
+TEST(NumaTopologyTest, PinThreadToLargeCpuIds) {
+  auto nodes = QueryNumaNodes();
+  ASSERT_FALSE(nodes.empty());
+  ASSERT_FALSE(nodes[0].cpu_ids.empty());
+  std::atomic<bool> pinned{false};
+  std::thread thread([&pinned]() {
+    while (!pinned.load()) std::this_thread::yield();
+  });
+  PinThreadToCpus(&thread, {nodes[0].cpu_ids[0], 4096});
+  pinned = true;
+  thread.join();
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
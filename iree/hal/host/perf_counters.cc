@@ -0,0 +1,190 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/perf_counters.h"
+
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "iree/base/logging.h"
+#include "iree/base/target_platform.h"
+
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#define IREE_HAL_HOST_PERF_EVENTS 1
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_ANDROID
+
+namespace iree {
+namespace hal {
+
+namespace {
+
+#if defined(IREE_HAL_HOST_PERF_EVENTS)
+
+// Hardware events in PerfCounterValues order.
+constexpr uint64_t kEventConfigs[4] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    // Usually last-level cache misses; see perf_event_open(2).
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int OpenPerfEvent(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // User space only so that counters are allowed at perf_event_paranoid 2.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(::syscall(SYS_perf_event_open, &attr, /*pid=*/0,
+                                    /*cpu=*/-1, group_fd, /*flags=*/0));
+}
+
+#endif  // IREE_HAL_HOST_PERF_EVENTS
+
+}  // namespace
+
+// static
+StatusOr<std::unique_ptr<PerfCounterGroup>> PerfCounterGroup::Create() {
+#if defined(IREE_HAL_HOST_PERF_EVENTS)
+  auto group = absl::WrapUnique(new PerfCounterGroup());
+  group->fds_[0] = OpenPerfEvent(kEventConfigs[0], /*group_fd=*/-1);
+  if (group->fds_[0] < 0) {
+    return UnavailableErrorBuilder(IREE_LOC)
+           << "perf_event_open failed: " << std::strerror(errno);
+  }
+  // Not all PMUs support every event; missing events read as 0.
+  for (int i = 1; i < 4; ++i) {
+    group->fds_[i] = OpenPerfEvent(kEventConfigs[i], group->fds_[0]);
+  }
+  return group;
+#else
+  return UnavailableErrorBuilder(IREE_LOC)
+         << "Hardware performance counters are not supported on this platform";
+#endif  // IREE_HAL_HOST_PERF_EVENTS
+}
+
+// static
+PerfCounterGroup* PerfCounterGroup::ForCurrentThread() {
+  struct ThreadState {
+    bool initialized = false;
+    std::unique_ptr<PerfCounterGroup> group;
+  };
+  thread_local ThreadState thread_state;
+  if (!thread_state.initialized) {
+    thread_state.initialized = true;
+    auto group_or = Create();
+    if (group_or.ok()) {
+      thread_state.group = std::move(group_or).ValueOrDie();
+    } else {
+      VLOG(1) << "Hardware performance counters unavailable: "
+              << group_or.status();
+    }
+  }
+  return thread_state.group.get();
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+#if defined(IREE_HAL_HOST_PERF_EVENTS)
+  // Members must be closed before the leader.
+  for (int i = 3; i >= 0; --i) {
+    if (fds_[i] >= 0) ::close(fds_[i]);
+  }
+#endif  // IREE_HAL_HOST_PERF_EVENTS
+}
+
+PerfCounterValues PerfCounterGroup::Read() {
+  PerfCounterValues values;
+#if defined(IREE_HAL_HOST_PERF_EVENTS)
+  // Layout of a PERF_FORMAT_GROUP read: counters are in the order they were
+  // added to the group, skipping those that failed to open.
+  struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[4];
+  } data;
+  if (::read(fds_[0], &data, sizeof(data)) <= 0) {
+    return values;
+  }
+  values.time_enabled = static_cast<int64_t>(data.time_enabled);
+  values.time_running = static_cast<int64_t>(data.time_running);
+  int64_t* outputs[4] = {&values.cycles, &values.instructions,
+                         &values.llc_misses, &values.branch_misses};
+  uint64_t value_index = 0;
+  for (int i = 0; i < 4 && value_index < data.nr; ++i) {
+    if (fds_[i] < 0) continue;
+    *outputs[i] = static_cast<int64_t>(data.values[value_index++]);
+  }
+#endif  // IREE_HAL_HOST_PERF_EVENTS
+  return values;
+}
+
+PerfCounterValues operator-(const PerfCounterValues& end,
+                            const PerfCounterValues& start) {
+  PerfCounterValues values;
+  values.time_enabled = end.time_enabled - start.time_enabled;
+  values.time_running = end.time_running - start.time_running;
+  // Scaling the delta (rather than each read) keeps the result correct when
+  // the multiplexing ratio changes between reads.
+  double scale = values.time_running > 0
+                     ? static_cast<double>(values.time_enabled) /
+                           values.time_running
+                     : 0.0;
+  auto scaled_delta = [scale](int64_t end_count, int64_t start_count) {
+    return static_cast<int64_t>((end_count - start_count) * scale);
+  };
+  values.cycles = scaled_delta(end.cycles, start.cycles);
+  values.instructions = scaled_delta(end.instructions, start.instructions);
+  values.llc_misses = scaled_delta(end.llc_misses, start.llc_misses);
+  values.branch_misses = scaled_delta(end.branch_misses, start.branch_misses);
+  return values;
+}
+
+ScopedDispatchProfile::ScopedDispatchProfile(
+    DispatchProfile* dispatch_profile, absl::string_view entry_point_name)
+    : dispatch_profile_(dispatch_profile),
+      entry_point_name_(entry_point_name) {
+  if (!dispatch_profile_) return;
+  perf_counters_ = PerfCounterGroup::ForCurrentThread();
+  start_time_ = absl::Now();
+  if (perf_counters_) start_values_ = perf_counters_->Read();
+}
+
+ScopedDispatchProfile::~ScopedDispatchProfile() {
+  if (!dispatch_profile_) return;
+  DispatchCounters counters;
+  if (perf_counters_) {
+    auto values = perf_counters_->Read() - start_values_;
+    counters.cycles = values.cycles;
+    counters.instructions = values.instructions;
+    counters.llc_misses = values.llc_misses;
+    counters.branch_misses = values.branch_misses;
+  }
+  counters.duration = absl::Now() - start_time_;
+  counters.dispatch_count = 1;
+  dispatch_profile_->Record(entry_point_name_, counters);
+}
+
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,112 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_HOST_PERF_COUNTERS_H_
+#define IREE_HAL_HOST_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "iree/base/status.h"
+#include "iree/hal/dispatch_profile.h"
+
+namespace iree {
+namespace hal {
+
+// Hardware event counts. Events that could not be counted are 0.
+struct PerfCounterValues {
+  int64_t cycles = 0;
+  int64_t instructions = 0;
+  int64_t llc_misses = 0;
+  int64_t branch_misses = 0;
+  // Nanoseconds the counters were enabled and actually counting. These differ
+  // when the kernel multiplexes the counters with other events.
+  int64_t time_enabled = 0;
+  int64_t time_running = 0;
+};
+
+// Counts hardware events of the calling thread with Linux perf_event_open.
+// Counters run continuously once opened and a region is measured by the
+// difference of the values read before and after it. Work the thread hands
+// off to other threads (such as a kernel thread pool) is not counted.
+//
+// Counters are unavailable on other platforms, without a hardware PMU (as in
+// many VMs) or when disallowed by /proc/sys/kernel/perf_event_paranoid.
+//
+// Thread-compatible; only the thread that created the group may read it.
+class PerfCounterGroup {
+ public:
+  // Opens counters for the calling thread.
+  static StatusOr<std::unique_ptr<PerfCounterGroup>> Create();
+
+  // Returns the group of the calling thread, opening it on first use, or
+  // nullptr if counters are unavailable. The group lives until the thread
+  // exits.
+  static PerfCounterGroup* ForCurrentThread();
+
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+  ~PerfCounterGroup();
+
+  // Reads the current raw counter values. Counts are not scaled for
+  // multiplexing; subtract two reads to get scaled counts for the region.
+  PerfCounterValues Read();
+
+ private:
+  PerfCounterGroup() = default;
+
+  // File descriptors for each counter in PerfCounterValues order. The first is
+  // the group leader. -1 for counters that could not be opened.
+  int fds_[4] = {-1, -1, -1, -1};
+};
+
+// Returns |end| - |start| per counter, with the counts scaled up by the
+// fraction of the region the counters were multiplexed out for. Counts are 0
+// if the counters did not run at all during the region.
+PerfCounterValues operator-(const PerfCounterValues& end,
+                            const PerfCounterValues& start);
+
+// Measures a dispatch executed on the calling thread while in scope and
+// records its wall time and hardware counters in |dispatch_profile| under
+// |entry_point_name|. No-op if |dispatch_profile| is nullptr.
+//
+// Usage:
+//   {
+//     ScopedDispatchProfile profile_scope(executable->dispatch_profile(),
+//                                         entry_function.name());
+//     RETURN_IF_ERROR(...);
+//   }
+class ScopedDispatchProfile {
+ public:
+  ScopedDispatchProfile(DispatchProfile* dispatch_profile,
+                        absl::string_view entry_point_name);
+  ~ScopedDispatchProfile();
+
+  ScopedDispatchProfile(const ScopedDispatchProfile&) = delete;
+  ScopedDispatchProfile& operator=(const ScopedDispatchProfile&) = delete;
+
+ private:
+  DispatchProfile* dispatch_profile_;
+  absl::string_view entry_point_name_;
+  PerfCounterGroup* perf_counters_ = nullptr;
+  PerfCounterValues start_values_;
+  absl::Time start_time_;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_HOST_PERF_COUNTERS_H_
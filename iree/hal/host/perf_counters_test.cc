@@ -0,0 +1,98 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/host/perf_counters.h"
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+TEST(PerfCountersTest, Difference) {
+  PerfCounterValues start;
+  start.cycles = 10;
+  start.instructions = 20;
+  start.llc_misses = 30;
+  start.branch_misses = 40;
+  PerfCounterValues end;
+  end.cycles = 15;
+  end.instructions = 40;
+  end.llc_misses = 31;
+  end.branch_misses = 44;
+  start.time_enabled = start.time_running = 100;
+  end.time_enabled = end.time_running = 250;
+  auto delta = end - start;
+  EXPECT_EQ(5, delta.cycles);
+  EXPECT_EQ(20, delta.instructions);
+  EXPECT_EQ(1, delta.llc_misses);
+  EXPECT_EQ(4, delta.branch_misses);
+  EXPECT_EQ(150, delta.time_enabled);
+  EXPECT_EQ(150, delta.time_running);
+}
+
+TEST(PerfCountersTest, DifferenceMultiplexed) {
+  // The counters ran for half of the time before the region but only a
+  // quarter of it during the region. Scaling each read separately would give
+  // 1100 * 3 - 1000 * 2 = 1300 instead of 100 * 4.
+  PerfCounterValues start;
+  start.cycles = 1000;
+  start.time_enabled = 100;
+  start.time_running = 50;
+  PerfCounterValues end;
+  end.cycles = 1100;
+  end.time_enabled = 300;
+  end.time_running = 100;
+  EXPECT_EQ(400, (end - start).cycles);
+
+  // Counters that never ran during the region count nothing.
+  end.time_running = start.time_running;
+  EXPECT_EQ(0, (end - start).cycles);
+}
+
+// Counters are commonly unavailable in containers and VMs so only their
+// behavior when present is checked.
+TEST(PerfCountersTest, CountsCurrentThread) {
+  auto* group = PerfCounterGroup::ForCurrentThread();
+  if (!group) {
+    GTEST_SKIP() << "Hardware performance counters unavailable";
+  }
+  EXPECT_EQ(group, PerfCounterGroup::ForCurrentThread());
+  auto start = group->Read();
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 1000000; ++i) {
+    sum = sum + i;
+  }
+  auto delta = group->Read() - start;
+  EXPECT_GT(delta.cycles, 0);
+  EXPECT_GT(delta.instructions, 1000000);
+}
+
+TEST(PerfCountersTest, ScopedDispatchProfile) {
+  { ScopedDispatchProfile profile_scope(nullptr, "ignored"); }
+
+  DispatchProfile dispatch_profile;
+  for (int i = 0; i < 2; ++i) {
+    ScopedDispatchProfile profile_scope(&dispatch_profile, "entry");
+  }
+  auto entry_points = dispatch_profile.entry_points();
+  ASSERT_EQ(1, entry_points.size());
+  EXPECT_EQ("entry", entry_points[0].first);
+  EXPECT_EQ(2, entry_points[0].second.dispatch_count);
+  EXPECT_GE(entry_points[0].second.duration, absl::ZeroDuration());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,39 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/buffer_mapping_cache.h"
+
+#include <utility>
+
+namespace iree {
+namespace hal {
+
+StatusOr<MappedMemory<uint8_t>*> BufferMappingCache::LookupMapping(
+    Buffer* buffer) {
+  if (!buffer) {
+    return InvalidArgumentErrorBuilder(IREE_LOC) << "Buffer view has no buffer";
+  }
+  auto it = mappings_.find(buffer);
+  if (it != mappings_.end()) {
+    return &it->second;
+  }
+  auto memory_access =
+      buffer->allowed_access() & (MemoryAccess::kRead | MemoryAccess::kWrite);
+  ASSIGN_OR_RETURN(auto mapping, buffer->MapMemory<uint8_t>(memory_access));
+  ++map_count_;
+  return &mappings_.emplace(buffer, std::move(mapping)).first->second;
+}
+
+}  // namespace hal
+}  // namespace iree
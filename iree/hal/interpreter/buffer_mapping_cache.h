@@ -0,0 +1,95 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_INTERPRETER_BUFFER_MAPPING_CACHE_H_
+#define IREE_HAL_INTERPRETER_BUFFER_MAPPING_CACHE_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "iree/base/status.h"
+#include "iree/hal/buffer.h"
+#include "iree/hal/buffer_view.h"
+
+namespace iree {
+namespace hal {
+
+// Caches host mappings of the buffers touched by a single dispatch.
+//
+// Each buffer is mapped once (with all of the access it allows) on first use
+// and the raw host pointer is reused by every following op, avoiding the
+// validation and map/unmap bookkeeping of Buffer::MapMemory per op. Mappings
+// retain their buffers so a cached pointer cannot outlive its storage; to bound
+// the number of temporaries kept alive the cache is flushed by BeginOp once it
+// holds kMaxEntries mappings. Mappings are never flushed in the middle of an op
+// so an op may map any number of buffers (such as the inputs of a fused
+// elementwise op) and all of the spans it was handed remain valid.
+//
+// Thread-compatible; each dispatch owns its own cache.
+class BufferMappingCache {
+ public:
+  static constexpr int kMaxEntries = 64;
+
+  BufferMappingCache() = default;
+  BufferMappingCache(const BufferMappingCache&) = delete;
+  BufferMappingCache& operator=(const BufferMappingCache&) = delete;
+
+  // Returns the contents of |buffer_view| for reading as elements of T.
+  template <typename T>
+  StatusOr<absl::Span<const T>> MapRead(const BufferView* buffer_view) {
+    ASSIGN_OR_RETURN(auto* mapping, LookupMapping(buffer_view->buffer.get()));
+    if (!mapping->data() && mapping->size() > 0) {
+      return PermissionDeniedErrorBuilder(IREE_LOC)
+             << "Buffer does not allow read access";
+    }
+    return absl::Span<const T>(reinterpret_cast<const T*>(mapping->data()),
+                               mapping->size() / sizeof(T));
+  }
+
+  // Returns the contents of |buffer_view| for writing as elements of T.
+  template <typename T>
+  StatusOr<absl::Span<T>> MapWrite(const BufferView* buffer_view) {
+    ASSIGN_OR_RETURN(auto* mapping, LookupMapping(buffer_view->buffer.get()));
+    if (!mapping->mutable_data() && mapping->size() > 0) {
+      return PermissionDeniedErrorBuilder(IREE_LOC)
+             << "Buffer does not allow write access";
+    }
+    return absl::Span<T>(reinterpret_cast<T*>(mapping->mutable_data()),
+                         mapping->size() / sizeof(T));
+  }
+
+  // Marks the start of the next op, flushing the cache if it is full. Spans
+  // returned before this call must no longer be used.
+  void BeginOp() {
+    if (mappings_.size() >= kMaxEntries) mappings_.clear();
+  }
+
+  // Unmaps all buffers and releases their references.
+  void Clear() { mappings_.clear(); }
+
+  // Total number of Buffer::MapMemory calls made by the cache.
+  int64_t map_count() const { return map_count_; }
+
+ private:
+  StatusOr<MappedMemory<uint8_t>*> LookupMapping(Buffer* buffer);
+
+  absl::flat_hash_map<Buffer*, MappedMemory<uint8_t>> mappings_;
+  int64_t map_count_ = 0;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_BUFFER_MAPPING_CACHE_H_
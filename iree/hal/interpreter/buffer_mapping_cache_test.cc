@@ -0,0 +1,135 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/buffer_mapping_cache.h"
+
+#include <vector>
+
+#include "iree/base/status_matchers.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+BufferView MakeBufferView(int32_t element_count) {
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll,
+                                     element_count * sizeof(float));
+  return BufferView(std::move(buffer), Shape{element_count}, sizeof(float));
+}
+
+// Tests that each buffer is only mapped once no matter how often it is used.
+TEST(BufferMappingCacheTest, MapsOncePerBuffer) {
+  auto lhs = MakeBufferView(4);
+  auto dst = MakeBufferView(4);
+  BufferMappingCache mappings;
+
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto lhs_contents, mappings.MapRead<float>(&lhs));
+    ASSERT_OK_AND_ASSIGN(auto dst_contents, mappings.MapWrite<float>(&dst));
+    EXPECT_EQ(4, lhs_contents.size());
+    EXPECT_EQ(4, dst_contents.size());
+  }
+  EXPECT_EQ(2, mappings.map_count());
+}
+
+// Tests that writes through a cached pointer are visible to later reads.
+TEST(BufferMappingCacheTest, WritesVisible) {
+  auto buffer_view = MakeBufferView(2);
+  BufferMappingCache mappings;
+
+  ASSERT_OK_AND_ASSIGN(auto dst_contents,
+                       mappings.MapWrite<float>(&buffer_view));
+  dst_contents[0] = 1.0f;
+  dst_contents[1] = 2.0f;
+  ASSERT_OK_AND_ASSIGN(auto src_contents,
+                       mappings.MapRead<float>(&buffer_view));
+  EXPECT_EQ(1.0f, src_contents[0]);
+  EXPECT_EQ(2.0f, src_contents[1]);
+
+  mappings.Clear();
+  std::vector<float> data(2);
+  ASSERT_OK(buffer_view.buffer->ReadData(0, data.data(), 2 * sizeof(float)));
+  EXPECT_EQ(1.0f, data[0]);
+  EXPECT_EQ(2.0f, data[1]);
+}
+
+// Tests that read-only buffers can be read but not written.
+TEST(BufferMappingCacheTest, ReadOnly) {
+  float data[2] = {1.0f, 2.0f};
+  auto buffer = HeapBuffer::Wrap(MemoryType::kHostLocal, BufferUsage::kAll,
+                                 data, sizeof(data));
+  BufferView buffer_view(std::move(buffer), Shape{2}, sizeof(float));
+  BufferMappingCache mappings;
+
+  ASSERT_OK_AND_ASSIGN(auto contents, mappings.MapRead<float>(&buffer_view));
+  EXPECT_EQ(2.0f, contents[1]);
+  EXPECT_FALSE(mappings.MapWrite<float>(&buffer_view).ok());
+}
+
+// Tests that the cache is flushed between ops when full instead of growing
+// unbounded.
+TEST(BufferMappingCacheTest, Bounded) {
+  BufferMappingCache mappings;
+  std::vector<BufferView> buffer_views;
+  for (int i = 0; i < BufferMappingCache::kMaxEntries; ++i) {
+    buffer_views.push_back(MakeBufferView(1));
+    mappings.BeginOp();
+    ASSERT_OK(mappings.MapRead<float>(&buffer_views.back()).status());
+  }
+  EXPECT_EQ(BufferMappingCache::kMaxEntries, mappings.map_count());
+
+  // The cache is full so the next op starts from an empty cache and the first
+  // buffer must be mapped again.
+  mappings.BeginOp();
+  ASSERT_OK(mappings.MapRead<float>(&buffer_views.front()).status());
+  EXPECT_EQ(BufferMappingCache::kMaxEntries + 1, mappings.map_count());
+}
+
+// Tests that an op mapping more than kMaxEntries buffers (like a fused
+// elementwise op with many inputs) keeps every one of its mappings.
+TEST(BufferMappingCacheTest, PinnedWithinOp) {
+  constexpr int kBufferCount = BufferMappingCache::kMaxEntries * 2 + 1;
+  BufferMappingCache mappings;
+  std::vector<BufferView> buffer_views;
+  buffer_views.reserve(kBufferCount);
+  std::vector<absl::Span<float>> contents;
+  mappings.BeginOp();
+  for (int i = 0; i < kBufferCount; ++i) {
+    buffer_views.push_back(MakeBufferView(1));
+    ASSERT_OK_AND_ASSIGN(auto span,
+                         mappings.MapWrite<float>(&buffer_views.back()));
+    span[0] = static_cast<float>(i);
+    contents.push_back(span);
+  }
+  EXPECT_EQ(kBufferCount, mappings.map_count());
+
+  // Nothing was flushed: every buffer resolves to the span it was first given.
+  for (int i = 0; i < kBufferCount; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto span, mappings.MapRead<float>(&buffer_views[i]));
+    EXPECT_EQ(contents[i].data(), span.data());
+    EXPECT_EQ(static_cast<float>(i), span[0]);
+  }
+  EXPECT_EQ(kBufferCount, mappings.map_count());
+
+  // The following op flushes the oversized cache.
+  mappings.BeginOp();
+  ASSERT_OK(mappings.MapRead<float>(&buffer_views.front()).status());
+  EXPECT_EQ(kBufferCount + 1, mappings.map_count());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -24,8 +24,13 @@ namespace iree {
 namespace hal {
 
 BytecodeCache::BytecodeCache(ref_ptr<rt::Instance> instance,
-                             hal::Allocator* allocator)
-    : instance_(std::move(instance)), allocator_(allocator) {}
+                             hal::Allocator* allocator,
+                             kernels::RuntimeState* kernel_runtime_state,
+                             DispatchProfile* dispatch_profile)
+    : instance_(std::move(instance)),
+      allocator_(allocator),
+      kernel_runtime_state_(kernel_runtime_state),
+      dispatch_profile_(dispatch_profile) {}
 
 BytecodeCache::~BytecodeCache() = default;
 
@@ -41,13 +46,18 @@ StatusOr<ref_ptr<Executable>> BytecodeCache::PrepareExecutable(
            << "Unsupported format: " << spec.format;
   }
 
-  // Wrap the data (or copy it).
   bool allow_aliasing_data =
       AllBitsSet(mode, ExecutableCachingMode::kAliasProvidedData);
-  ASSIGN_OR_RETURN(auto executable,
-                   BytecodeExecutable::Load(add_ref(instance_), allocator_,
-                                            spec, !allow_aliasing_data));
+  // Wrap the data (or copy it).
+  ASSIGN_OR_RETURN(
+      auto executable,
+      BytecodeExecutable::Load(add_ref(instance_), allocator_,
+                               kernel_runtime_state_, spec,
+                               allow_aliasing_data));
 
+  if (AllBitsSet(mode, ExecutableCachingMode::kEnableProfiling)) {
+    executable->set_dispatch_profile(dispatch_profile_);
+  }
   return executable;
 }
 
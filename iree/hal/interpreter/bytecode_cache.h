@@ -16,8 +16,10 @@
 #define IREE_HAL_INTERPRETER_BYTECODE_CACHE_H_
 
 #include "iree/hal/allocator.h"
+#include "iree/hal/dispatch_profile.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_cache.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
 #include "iree/rt/instance.h"
 
 namespace iree {
@@ -25,7 +27,11 @@ namespace hal {
 
 class BytecodeCache final : public ExecutableCache {
  public:
-  BytecodeCache(ref_ptr<rt::Instance> instance, hal::Allocator* allocator);
+  // Executables prepared with ExecutableCachingMode::kEnableProfiling record
+  // their dispatches in |dispatch_profile|, if provided.
+  BytecodeCache(ref_ptr<rt::Instance> instance, hal::Allocator* allocator,
+                kernels::RuntimeState* kernel_runtime_state,
+                DispatchProfile* dispatch_profile = nullptr);
   ~BytecodeCache() override;
 
   bool CanPrepareFormat(ExecutableFormat format) const override;
@@ -36,6 +42,8 @@ class BytecodeCache final : public ExecutableCache {
  private:
   ref_ptr<rt::Instance> instance_;
   hal::Allocator* allocator_;
+  kernels::RuntimeState* kernel_runtime_state_;
+  DispatchProfile* dispatch_profile_;
 };
 
 }  // namespace hal
@@ -33,6 +33,7 @@
 #include "iree/hal/interpreter/bytecode_dispatch_conversion.h"
 #include "iree/hal/interpreter/bytecode_dispatch_util.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/hal/interpreter/stack_arena_pool.h"
 #include "iree/rt/function.h"
 #include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
 #include "iree/vm/bytecode_module.h"
@@ -50,6 +51,62 @@ using ::iree::rt::Stack;
 using ::iree::rt::StackFrame;
 using ::iree::vm::BytecodeReader;
 
+// Tracks the stack arenas of the frames executing within a single Dispatch.
+// Arenas are acquired on the first alloc_stack within a frame and returned to
+// the pool when the frame returns or the dispatch exits (including on error).
+class FrameStackArenas {
+ public:
+  FrameStackArenas(hal::Allocator* allocator, StackArenaPool* pool)
+      : allocator_(allocator), pool_(pool) {}
+  ~FrameStackArenas() {
+    while (!arenas_.empty()) PopFrame();
+  }
+
+  void PushFrame() { arenas_.emplace_back(); }
+
+  void PopFrame() {
+    pool_->Release(std::move(arenas_.back()));
+    arenas_.pop_back();
+  }
+
+  // Returns the arena of the current frame, acquiring one of |size| bytes if
+  // the frame does not yet have one.
+  StatusOr<StackArena*> CurrentArena(device_size_t size) {
+    auto& arena = arenas_.back();
+    if (!arena) {
+      ASSIGN_OR_RETURN(arena, pool_->Acquire(allocator_, size));
+    }
+    return arena.get();
+  }
+
+ private:
+  hal::Allocator* allocator_;
+  StackArenaPool* pool_;
+  absl::InlinedVector<std::unique_ptr<StackArena>, 4> arenas_;
+};
+
+// Reads the type and shape of an alloc_stack and returns a view of its range
+// within the arena of the current frame.
+StatusOr<BufferView> ReadStackAllocation(BytecodeReader* reader,
+                                         FrameStackArenas* frame_arenas) {
+  ASSIGN_OR_RETURN(auto offset, reader->ReadInt32());
+  ASSIGN_OR_RETURN(auto type, reader->ReadType());
+  size_t element_size = type.element_size();
+  size_t element_count = 0;
+  ASSIGN_OR_RETURN(auto shape, reader->ReadShapePieces(&element_count));
+  size_t allocation_size = element_size * element_count;
+
+  ASSIGN_OR_RETURN(auto* arena,
+                   frame_arenas->CurrentArena(reader->stack_size()));
+  if (offset < 0 || offset + allocation_size > arena->size()) {
+    return OutOfRangeErrorBuilder(IREE_LOC)
+           << "Stack allocation of " << allocation_size << "b at offset "
+           << offset << " overflows the " << arena->size() << "b stack arena";
+  }
+  ASSIGN_OR_RETURN(auto buffer, arena->Subspan(offset, allocation_size));
+  return BufferView(std::move(buffer), shape, element_size);
+}
+
 }  // namespace
 
 Status Dispatch(hal::Allocator* allocator,
@@ -80,6 +137,12 @@ Status Dispatch(hal::Allocator* allocator,
   // into different functions.
   BytecodeReader reader(stack);
   RETURN_IF_ERROR(reader.SwitchStackFrame(entry_stack_frame));
+  FrameStackArenas frame_arenas(allocator,
+                                &kernel_runtime_state->stack_arena_pool);
+  frame_arenas.PushFrame();
+  // Host mappings of the buffers used by elementwise ops, reused across ops and
+  // pinned for the duration of each op.
+  BufferMappingCache mappings;
 
 #define DISPATCH_NEXT()                                                    \
   {                                                                        \
@@ -87,6 +150,7 @@ Status Dispatch(hal::Allocator* allocator,
     DVLOG(1)                                                               \
         << "Interpreter dispatching op code: "                             \
         << GetOpcodeInfo(vm::interpreter_opcode_table(), opcode).mnemonic; \
+    mappings.BeginOp();                                                    \
     goto* kDispatchTable[opcode];                                          \
   }
 
@@ -117,6 +181,7 @@ Status Dispatch(hal::Allocator* allocator,
             ->GetFunctionDef(target_function.linkage(),
                              target_function.ordinal()));
     ASSIGN_OR_RETURN(auto* new_stack_frame, stack->PushFrame(target_function));
+    frame_arenas.PushFrame();
     new_stack_frame->mutable_registers()->buffer_views.resize(
         function_def->bytecode()->local_count());
     RETURN_IF_ERROR(
@@ -153,6 +218,9 @@ Status Dispatch(hal::Allocator* allocator,
     RETURN_IF_ERROR(reader.CopyResultsAndSwitchStackFrame(old_stack_frame,
                                                           new_stack_frame));
     RETURN_IF_ERROR(stack->PopFrame());
+    // Drop the references to the temporaries of the returning frame.
+    mappings.Clear();
+    frame_arenas.PopFrame();
     DVLOG(1) << "Return; stack now: " << stack->DebugString();
   });
 
@@ -189,43 +257,43 @@ Status Dispatch(hal::Allocator* allocator,
     switch (static_cast<CmpIPredicate>(predicate)) {
       case CmpIPredicate::kEq:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareEQ>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kNe:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareNE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kSlt:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareLT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kSle:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareLE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kSgt:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareGT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kSge:
         RETURN_IF_ERROR(ApplyComparisonOpIS<kernels::CompareGE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kUlt:
         RETURN_IF_ERROR(ApplyComparisonOpIU<kernels::CompareLT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kUle:
         RETURN_IF_ERROR(ApplyComparisonOpIU<kernels::CompareLE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kUgt:
         RETURN_IF_ERROR(ApplyComparisonOpIU<kernels::CompareGT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpIPredicate::kUge:
         RETURN_IF_ERROR(ApplyComparisonOpIU<kernels::CompareGE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
     }
   });
@@ -240,27 +308,27 @@ Status Dispatch(hal::Allocator* allocator,
     switch (predicate) {
       case CmpFPredicate::kOeq:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareEQ>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kUne:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareNE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kOlt:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareLT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kOle:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareLE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kOgt:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareGT>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kOge:
         RETURN_IF_ERROR(ApplyComparisonOpF<kernels::CompareGE>(
-            lhs_local, rhs_local, dst_local));
+            kernel_runtime_state, &mappings, lhs_local, rhs_local, dst_local));
         break;
       case CmpFPredicate::kFalse:
       case CmpFPredicate::kOne:
@@ -285,12 +353,28 @@ Status Dispatch(hal::Allocator* allocator,
   });
 
   DISPATCH_CORE_OPCODE(kAllocStack, {
-    return UnimplementedErrorBuilder(IREE_LOC) << "Unimplemented alloc_stack";
+    ASSIGN_OR_RETURN(auto heap_type, reader.ReadInt32());
+    CHECK_EQ(heap_type & ~static_cast<int32_t>(AllocHeapFlag::kUninitialized),
+             0);
+    ASSIGN_OR_RETURN(auto allocation,
+                     ReadStackAllocation(&reader, &frame_arenas));
+    // The arena range may hold data from an earlier allocation or invocation.
+    auto heap_flags = static_cast<AllocHeapFlagBitfield>(heap_type);
+    if (!AnyBitSet(heap_flags & AllocHeapFlag::kUninitialized)) {
+      RETURN_IF_ERROR(allocation.buffer->Fill8(0));
+    }
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    *dst_local = std::move(allocation);
   });
 
   DISPATCH_CORE_OPCODE(kAllocStackInit, {
-    return UnimplementedErrorBuilder(IREE_LOC)
-           << "Unimplemented alloc_stack_init";
+    ASSIGN_OR_RETURN(auto allocation,
+                     ReadStackAllocation(&reader, &frame_arenas));
+    ASSIGN_OR_RETURN(auto value, reader.ReadConstant());
+    RETURN_IF_ERROR(allocation.buffer->CopyData(
+        0, value.buffer.get(), 0, allocation.buffer->byte_length()));
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    *dst_local = std::move(allocation);
   });
 
   DISPATCH_CORE_OPCODE(kAllocHeap, {
@@ -308,11 +392,19 @@ Status Dispatch(hal::Allocator* allocator,
     dst_local->shape = shape;
 
     // TODO(benvanik): properly allocate with attributes from op.
-    CHECK_EQ(heap_type, 0);
-    ASSIGN_OR_RETURN(
-        dst_local->buffer,
-        allocator->Allocate(MemoryType::kHostLocal | MemoryType::kDeviceVisible,
-                            BufferUsage::kAll, allocation_size));
+    auto heap_flags = static_cast<AllocHeapFlagBitfield>(heap_type);
+    CHECK_EQ(heap_type & ~static_cast<int32_t>(AllocHeapFlag::kUninitialized),
+             0);
+    auto memory_type = MemoryType::kHostLocal | MemoryType::kDeviceVisible;
+    if (AnyBitSet(heap_flags & AllocHeapFlag::kUninitialized)) {
+      ASSIGN_OR_RETURN(dst_local->buffer,
+                       allocator->AllocateUninitialized(
+                           memory_type, BufferUsage::kAll, allocation_size));
+    } else {
+      ASSIGN_OR_RETURN(dst_local->buffer,
+                       allocator->Allocate(memory_type, BufferUsage::kAll,
+                                           allocation_size));
+    }
   });
 
   DISPATCH_CORE_OPCODE(kDiscard, {
@@ -373,8 +465,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_indices, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadSlotElements<int32_t>());
-    RETURN_IF_ERROR(
-        ApplyCopy(src_local, src_indices, dst_local, dst_indices, lengths));
+    RETURN_IF_ERROR(ApplyCopy(kernel_runtime_state, src_local, src_indices,
+                              dst_local, dst_indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kStaticCopy, {
@@ -383,8 +475,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_indices, reader.ReadIndexList());
     ASSIGN_OR_RETURN(auto lengths, reader.ReadIndexList());
-    RETURN_IF_ERROR(
-        ApplyCopy(src_local, src_indices, dst_local, dst_indices, lengths));
+    RETURN_IF_ERROR(ApplyCopy(kernel_runtime_state, src_local, src_indices,
+                              dst_local, dst_indices, lengths));
   });
 
   DISPATCH_CORE_OPCODE(kClone, {
@@ -392,8 +484,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     dst_local->element_size = src_local->element_size;
     dst_local->shape = src_local->shape;
-    dst_local->buffer = HeapBuffer::Allocate(src_local->buffer->usage(),
-                                             src_local->buffer->byte_length());
+    dst_local->buffer = HeapBuffer::AllocateUninitialized(
+        src_local->buffer->usage(), src_local->buffer->byte_length());
     RETURN_IF_ERROR(dst_local->buffer->CopyData(0, src_local->buffer.get()));
   });
 
@@ -457,27 +549,27 @@ Status Dispatch(hal::Allocator* allocator,
     }
     switch (lhs_local->element_size) {
       case 1:
-        RETURN_IF_ERROR(kernels::Select::Execute<uint8_t>(
-            cond_buffer.contents(), lhs_buffer.contents(),
+        RETURN_IF_ERROR(kernels::ExecuteMorsels<kernels::Select>(
+            kernel_runtime_state, cond_buffer.contents(), lhs_buffer.contents(),
             rhs_buffer.contents(), dst_buffer.mutable_contents()));
         break;
       case 2:
-        RETURN_IF_ERROR(kernels::Select::Execute<uint16_t>(
-            cond_buffer.contents(),
+        RETURN_IF_ERROR(kernels::ExecuteMorsels<kernels::Select>(
+            kernel_runtime_state, cond_buffer.contents(),
             ReinterpretSpan<uint16_t>(lhs_buffer.contents()),
             ReinterpretSpan<uint16_t>(rhs_buffer.contents()),
             ReinterpretSpan<uint16_t>(dst_buffer.mutable_contents())));
         break;
       case 4:
-        RETURN_IF_ERROR(kernels::Select::Execute<uint32_t>(
-            cond_buffer.contents(),
+        RETURN_IF_ERROR(kernels::ExecuteMorsels<kernels::Select>(
+            kernel_runtime_state, cond_buffer.contents(),
             ReinterpretSpan<uint32_t>(lhs_buffer.contents()),
             ReinterpretSpan<uint32_t>(rhs_buffer.contents()),
             ReinterpretSpan<uint32_t>(dst_buffer.mutable_contents())));
         break;
       case 8:
-        RETURN_IF_ERROR(kernels::Select::Execute<uint64_t>(
-            cond_buffer.contents(),
+        RETURN_IF_ERROR(kernels::ExecuteMorsels<kernels::Select>(
+            kernel_runtime_state, cond_buffer.contents(),
             ReinterpretSpan<uint64_t>(lhs_buffer.contents()),
             ReinterpretSpan<uint64_t>(rhs_buffer.contents()),
             ReinterpretSpan<uint64_t>(dst_buffer.mutable_contents())));
@@ -493,7 +585,7 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Transpose>(
-        src_local, dst_local, src_local->shape,
+        kernel_runtime_state, &mappings, src_local, dst_local, src_local->shape,
         absl::MakeConstSpan(perm_data)));
   });
 
@@ -501,9 +593,9 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto perm_data, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    RETURN_IF_ERROR(
-        ApplyUnaryOpIU<kernels::Reverse>(src_local, dst_local, src_local->shape,
-                                         absl::MakeConstSpan(perm_data)));
+    RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Reverse>(
+        kernel_runtime_state, &mappings, src_local, dst_local, src_local->shape,
+        absl::MakeConstSpan(perm_data)));
   });
 
   DISPATCH_CORE_OPCODE(kPad, {
@@ -516,7 +608,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
 
     RETURN_IF_ERROR(ApplyBinaryOpIU<kernels::Pad>(
-        src_local, padding_value, dst_local, src_local->shape, dst_local->shape,
+        kernel_runtime_state, &mappings, src_local, padding_value, dst_local,
+        src_local->shape, dst_local->shape,
         absl::MakeConstSpan(edge_padding_low),
         absl::MakeConstSpan(edge_padding_high),
         absl::MakeConstSpan(interior_padding)));
@@ -527,7 +620,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto shape_data, reader.ReadSlotElements<int32_t>());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     dst_local->shape = Shape{shape_data};
-    RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Broadcast>(src_local, dst_local));
+    RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Broadcast>(
+        kernel_runtime_state, &mappings, src_local, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kTile, {
@@ -536,147 +630,188 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     dst_local->shape = Shape{shape_data};
     RETURN_IF_ERROR(ApplyUnaryOpIU<kernels::Tile>(
-        src_local, dst_local, src_local->shape, dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, dst_local, src_local->shape,
+        dst_local->shape));
   });
 
   DISPATCH_CORE_OPCODE(kNot, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIU<kernels::Not>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIU<kernels::Not>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kAnd, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::And>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::And>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kOr, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Or>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Or>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kXor, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Xor>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Xor>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kShiftLeft, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftLeft>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftLeft>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kShiftRightLogical, {
-    RETURN_IF_ERROR(
-        DispatchElementwiseBinaryOpIU<kernels::ShiftRight>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::ShiftRight>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kShiftRightArithmetic, {
-    RETURN_IF_ERROR(
-        DispatchElementwiseBinaryOpIS<kernels::ShiftRight>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::ShiftRight>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kAddI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Add>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Add>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kAddF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Add>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Add>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kSubI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Sub>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Sub>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kSubF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Sub>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Sub>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kAbsI, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIS<kernels::Abs>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpIS<kernels::Abs>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kAbsF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Abs>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Abs>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kMulI, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Mul>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Mul>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kMulF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Mul>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Mul>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kDivIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Div>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kDivIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Div>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kDivF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Div>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Div>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kRemIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Rem>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kRemIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Rem>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kRemF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Rem>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Rem>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kMulAddI, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIU<kernels::MulAdd>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIU<kernels::MulAdd>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kMulAddF, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::MulAdd>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::MulAdd>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kExpF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Exp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Exp>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kLogF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Log>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Log>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kRsqrtF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Rsqrt>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Rsqrt>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kSqrtF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sqrt>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sqrt>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kCosF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Cos>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Cos>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kSinF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sin>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Sin>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kTanhF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Tanh>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Tanh>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kAtan2F, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Atan2>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Atan2>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kMinIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Min>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kMinIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Min>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kMinF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Min>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Min>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kMaxIS, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIS<kernels::Max>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kMaxIU, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpIU<kernels::Max>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kMaxF, {
-    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Max>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseBinaryOpF<kernels::Max>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kClampIS, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_CORE_OPCODE(kClampIU, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpIS<kernels::Clamp>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kClampF, {
-    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::Clamp>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseTernaryOpF<kernels::Clamp>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_FLOAT_OPCODE(kFloorF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Floor>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Floor>(
+        &reader, kernel_runtime_state, &mappings));
   });
   DISPATCH_FLOAT_OPCODE(kCeilF, {
-    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Ceil>(&reader));
+    RETURN_IF_ERROR(DispatchElementwiseUnaryOpF<kernels::Ceil>(
+        &reader, kernel_runtime_state, &mappings));
   });
 
   DISPATCH_CORE_OPCODE(kConvertSS, {
@@ -684,32 +819,32 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    RETURN_IF_ERROR(
-        ApplyConvertSS::Apply(src_type, src_local, dst_type, dst_local));
+    RETURN_IF_ERROR(ApplyConvertSS::Apply(kernel_runtime_state, src_type,
+                                          src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUU, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    RETURN_IF_ERROR(
-        ApplyConvertUU::Apply(src_type, src_local, dst_type, dst_local));
+    RETURN_IF_ERROR(ApplyConvertUU::Apply(kernel_runtime_state, src_type,
+                                          src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertSU, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    RETURN_IF_ERROR(
-        ApplyConvertSU::Apply(src_type, src_local, dst_type, dst_local));
+    RETURN_IF_ERROR(ApplyConvertSU::Apply(kernel_runtime_state, src_type,
+                                          src_local, dst_type, dst_local));
   });
   DISPATCH_CORE_OPCODE(kConvertUS, {
     ASSIGN_OR_RETURN(auto src_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto dst_type, reader.ReadType());
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
-    RETURN_IF_ERROR(
-        ApplyConvertUS::Apply(src_type, src_local, dst_type, dst_local));
+    RETURN_IF_ERROR(ApplyConvertUS::Apply(kernel_runtime_state, src_type,
+                                          src_local, dst_type, dst_local));
   });
 
   DISPATCH_CORE_OPCODE(kMatMulI, {
@@ -729,22 +864,22 @@ Status Dispatch(hal::Allocator* allocator,
     switch (lhs_local->element_size) {
       case 1:
         RETURN_IF_ERROR(ApplyMatMulOpI<int8_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            reader, mat_mul_state, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 2:
         RETURN_IF_ERROR(ApplyMatMulOpI<int16_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            reader, mat_mul_state, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 4:
         RETURN_IF_ERROR(ApplyMatMulOpI<int32_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            reader, mat_mul_state, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       case 8:
         RETURN_IF_ERROR(ApplyMatMulOpI<int64_t>(
-            mat_mul_state, lhs_local, rhs_local, bias_local,
+            reader, mat_mul_state, lhs_local, rhs_local, bias_local,
             multiplier_mantissa_local, multiplier_exponent_local, dst_local));
         break;
       default:
@@ -762,13 +897,20 @@ Status Dispatch(hal::Allocator* allocator,
         ValidateMatMulOpF(lhs_local, rhs_local, bias_local, dst_local));
     auto* mat_mul_state = kernel_runtime_state->mat_mul_state.get();
     switch (lhs_local->element_size) {
+      case 2:
+        RETURN_IF_ERROR(ApplyMatMulOpF16(
+            &mappings, mat_mul_state, lhs_local, rhs_local, bias_local,
+            dst_local));
+        break;
       case 4:
-        RETURN_IF_ERROR(ApplyMatMulOpF<float>(
-            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+        RETURN_IF_ERROR(ApplyMatMulOpF<float>(reader, mat_mul_state, lhs_local,
+                                              rhs_local, bias_local,
+                                              dst_local));
         break;
       case 8:
-        RETURN_IF_ERROR(ApplyMatMulOpF<double>(
-            mat_mul_state, lhs_local, rhs_local, bias_local, dst_local));
+        RETURN_IF_ERROR(ApplyMatMulOpF<double>(reader, mat_mul_state, lhs_local,
+                                               rhs_local, bias_local,
+                                               dst_local));
         break;
       default:
         return UnimplementedErrorBuilder(IREE_LOC)
@@ -776,6 +918,148 @@ Status Dispatch(hal::Allocator* allocator,
     }
   });
 
+  DISPATCH_FLOAT_OPCODE(kConv2DF, {
+    ASSIGN_OR_RETURN(auto* input_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* filter_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto window_strides, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto dilations, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto padding, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto feature_group_count, reader.ReadInt32());
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    if (window_strides.size() != 2 || dilations.size() != 2 ||
+        padding.size() != 4) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Conv2D expects 2 strides, 2 dilations and 4 padding values";
+    }
+    kernels::Conv2D::Params params;
+    params.stride_h = window_strides[0];
+    params.stride_w = window_strides[1];
+    params.dilation_h = dilations[0];
+    params.dilation_w = dilations[1];
+    params.pad_top = padding[0];
+    params.pad_bottom = padding[1];
+    params.pad_left = padding[2];
+    params.pad_right = padding[3];
+    params.feature_group_count = feature_group_count;
+    RETURN_IF_ERROR(
+        ValidateConv2DOpF(input_local, filter_local, dst_local, params));
+    switch (input_local->element_size) {
+      case 2:
+        RETURN_IF_ERROR(ApplyConv2DOpF16(
+            &mappings, kernel_runtime_state, input_local, filter_local,
+            dst_local, params));
+        break;
+      case 4:
+        RETURN_IF_ERROR(ApplyConv2DOpF<float>(reader, kernel_runtime_state,
+                                              input_local, filter_local,
+                                              dst_local, params));
+        break;
+      case 8:
+        RETURN_IF_ERROR(ApplyConv2DOpF<double>(reader, kernel_runtime_state,
+                                               input_local, filter_local,
+                                               dst_local, params));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << input_local->element_size;
+    }
+  });
+
+  DISPATCH_CORE_OPCODE(kMatMulQ, {
+    ASSIGN_OR_RETURN(auto* lhs_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* rhs_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* bias_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* multiplier_mantissa_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* multiplier_exponent_local, reader.ReadLocal());
+    kernels::QuantizationParams quantization;
+    ASSIGN_OR_RETURN(quantization.lhs_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.rhs_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.dst_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.clamp_min, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.clamp_max, reader.ReadInt32());
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    RETURN_IF_ERROR(ValidateMatMulOpQ(
+        lhs_local, rhs_local, bias_local, multiplier_mantissa_local,
+        multiplier_exponent_local, dst_local, quantization));
+    RETURN_IF_ERROR(ApplyMatMulOpQ<int8_t>(
+        reader, kernel_runtime_state->mat_mul_state.get(), lhs_local,
+        rhs_local, bias_local, multiplier_mantissa_local,
+        multiplier_exponent_local, dst_local, quantization));
+  });
+
+  DISPATCH_CORE_OPCODE(kConv2DQ, {
+    ASSIGN_OR_RETURN(auto* input_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* filter_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* bias_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* multiplier_mantissa_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto* multiplier_exponent_local, reader.ReadLocal());
+    ASSIGN_OR_RETURN(auto window_strides, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto dilations, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto padding, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto feature_group_count, reader.ReadInt32());
+    kernels::QuantizationParams quantization;
+    ASSIGN_OR_RETURN(quantization.lhs_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.rhs_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.dst_zero_point, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.clamp_min, reader.ReadInt32());
+    ASSIGN_OR_RETURN(quantization.clamp_max, reader.ReadInt32());
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    if (window_strides.size() != 2 || dilations.size() != 2 ||
+        padding.size() != 4) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Conv2D expects 2 strides, 2 dilations and 4 padding values";
+    }
+    kernels::Conv2D::Params params;
+    params.stride_h = window_strides[0];
+    params.stride_w = window_strides[1];
+    params.dilation_h = dilations[0];
+    params.dilation_w = dilations[1];
+    params.pad_top = padding[0];
+    params.pad_bottom = padding[1];
+    params.pad_left = padding[2];
+    params.pad_right = padding[3];
+    params.feature_group_count = feature_group_count;
+    RETURN_IF_ERROR(ValidateConv2DOpQ(
+        input_local, filter_local, bias_local, multiplier_mantissa_local,
+        multiplier_exponent_local, dst_local, params, quantization));
+    RETURN_IF_ERROR(ApplyConv2DOpQ<int8_t>(
+        reader, kernel_runtime_state, input_local, filter_local, bias_local,
+        multiplier_mantissa_local, multiplier_exponent_local, dst_local, params,
+        quantization));
+  });
+
+  DISPATCH_FLOAT_OPCODE(kFusedElementwiseF, {
+    ASSIGN_OR_RETURN(int input_count, reader.ReadCount());
+    absl::InlinedVector<BufferView*, 8> input_locals(input_count);
+    for (int i = 0; i < input_count; ++i) {
+      ASSIGN_OR_RETURN(input_locals[i], reader.ReadLocal());
+    }
+    ASSIGN_OR_RETURN(auto program, reader.ReadIndexList());
+    ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
+    RETURN_IF_ERROR(
+        ValidateFusedElementwiseOpF(input_locals, program, dst_local));
+    switch (dst_local->element_size) {
+      case 2:
+        RETURN_IF_ERROR(
+            ApplyFusedElementwiseOpF16(kernel_runtime_state, &mappings,
+                                       input_locals, program, dst_local));
+        break;
+      case 4:
+        RETURN_IF_ERROR(
+            ApplyFusedElementwiseOp<float>(kernel_runtime_state, &mappings,
+                                           input_locals, program, dst_local));
+        break;
+      case 8:
+        RETURN_IF_ERROR(
+            ApplyFusedElementwiseOp<double>(kernel_runtime_state, &mappings,
+                                            input_locals, program, dst_local));
+        break;
+      default:
+        return UnimplementedErrorBuilder(IREE_LOC)
+               << "Unimplemented element size: " << dst_local->element_size;
+    }
+  });
+
   DISPATCH_CORE_OPCODE(kReduceSumI, {
     ASSIGN_OR_RETURN(auto* src_local, reader.ReadLocal());
     ASSIGN_OR_RETURN(auto* init_local, reader.ReadLocal());
@@ -783,8 +1067,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceSum>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceSumF, {
@@ -794,8 +1078,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceSum>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_CORE_OPCODE(kReduceMinI, {
@@ -805,8 +1089,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMin>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMinF, {
@@ -816,8 +1100,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMin>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_CORE_OPCODE(kReduceMaxI, {
@@ -827,8 +1111,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpIS<kernels::ReduceMax>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_FLOAT_OPCODE(kReduceMaxF, {
@@ -838,8 +1122,8 @@ Status Dispatch(hal::Allocator* allocator,
     ASSIGN_OR_RETURN(auto* dst_local, reader.ReadLocal());
     // TODO(scotttodd): validate
     RETURN_IF_ERROR(ApplyBinaryOpF<kernels::ReduceMax>(
-        src_local, init_local, dst_local, dimension, src_local->shape,
-        dst_local->shape));
+        kernel_runtime_state, &mappings, src_local, init_local, dst_local,
+        dimension, src_local->shape, dst_local->shape));
   });
 
   DISPATCH_CORE_OPCODE(kTrace, {
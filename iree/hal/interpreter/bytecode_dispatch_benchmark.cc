@@ -0,0 +1,113 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark/benchmark.h"
+#include "iree/base/logging.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/hal/heap_buffer.h"
+#include "iree/hal/interpreter/buffer_mapping_cache.h"
+#include "iree/hal/interpreter/bytecode_dispatch_util.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Number of ops in each chain; roughly a bias add, scale and activation per
+// layer repeated a few times.
+constexpr int kChainLength = 16;
+
+BufferView MakeBufferView(int32_t element_count, float value) {
+  auto buffer = HeapBuffer::Allocate(BufferUsage::kAll,
+                                     element_count * sizeof(float));
+  CHECK_OK(buffer->Fill32(value));
+  return BufferView(std::move(buffer), Shape{element_count}, sizeof(float));
+}
+
+// Runs a chain of alternating add/mul ops over small tensors, ping-ponging
+// between two temporaries like consecutive elementwise ops in a function do.
+// When |map_per_op| is set every op maps its operands again, as the
+// interpreter did before mappings were cached for the whole dispatch.
+void RunSmallOpChain(benchmark::State& state, bool map_per_op) {
+  int32_t element_count = state.range(0);
+  auto lhs = MakeBufferView(element_count, 1.0f);
+  auto rhs = MakeBufferView(element_count, 0.5f);
+  auto tmp0 = MakeBufferView(element_count, 0.0f);
+  auto tmp1 = MakeBufferView(element_count, 0.0f);
+  kernels::RuntimeState runtime_state;
+  for (auto _ : state) {
+    BufferMappingCache mappings;
+    for (int i = 0; i < kChainLength; ++i) {
+      if (map_per_op) mappings.Clear();
+      mappings.BeginOp();
+      BufferView* src = i == 0 ? &lhs : (i % 2 ? &tmp0 : &tmp1);
+      BufferView* dst = i % 2 ? &tmp1 : &tmp0;
+      if (i % 2) {
+        CHECK_OK(ApplyBinaryOpF<kernels::Mul>(&runtime_state, &mappings, src,
+                                              &rhs, dst));
+      } else {
+        CHECK_OK(ApplyBinaryOpF<kernels::Add>(&runtime_state, &mappings, src,
+                                              &rhs, dst));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kChainLength);
+}
+
+void BM_SmallOpChainMapPerOp(benchmark::State& state) {
+  RunSmallOpChain(state, /*map_per_op=*/true);
+}
+BENCHMARK(BM_SmallOpChainMapPerOp)->Arg(16)->Arg(64)->Arg(256)->Arg(4096);
+
+void BM_SmallOpChainCachedMappings(benchmark::State& state) {
+  RunSmallOpChain(state, /*map_per_op=*/false);
+}
+BENCHMARK(BM_SmallOpChainCachedMappings)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(256)
+    ->Arg(4096);
+
+// Runs a single large add, either on the calling thread alone or split into
+// morsels across the default thread pool.
+void RunLargeAdd(benchmark::State& state, int thread_count) {
+  int32_t element_count = state.range(0);
+  auto lhs = MakeBufferView(element_count, 1.0f);
+  auto rhs = MakeBufferView(element_count, 0.5f);
+  auto dst = MakeBufferView(element_count, 0.0f);
+  kernels::RuntimeOptions options;
+  if (thread_count) options.thread_count = thread_count;
+  kernels::RuntimeState runtime_state(options);
+  BufferMappingCache mappings;
+  for (auto _ : state) {
+    CHECK_OK(ApplyBinaryOpF<kernels::Add>(&runtime_state, &mappings, &lhs,
+                                          &rhs, &dst));
+  }
+  state.SetBytesProcessed(state.iterations() * element_count * 3 *
+                          sizeof(float));
+}
+
+void BM_LargeAddSingleThread(benchmark::State& state) {
+  RunLargeAdd(state, /*thread_count=*/1);
+}
+BENCHMARK(BM_LargeAddSingleThread)->Range(1 << 16, 1 << 24);
+
+void BM_LargeAddMorsels(benchmark::State& state) {
+  RunLargeAdd(state, /*thread_count=*/0);
+}
+BENCHMARK(BM_LargeAddMorsels)->Range(1 << 16, 1 << 24)->UseRealTime();
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
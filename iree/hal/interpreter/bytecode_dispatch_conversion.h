@@ -17,6 +17,7 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_CONVERSION_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_CONVERSION_H_
 
+#include "iree/base/half_float.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/hal/interpreter/bytecode_dispatch_util.h"
@@ -28,7 +29,8 @@ namespace hal {
 
 template <typename KERNEL, bool src_signed, bool dst_signed, typename... ARGS>
 struct ApplyConversionOp {
-  static Status Apply(const vm::Type& src_type, BufferView* src_local,
+  static Status Apply(kernels::RuntimeState* runtime_state,
+                      const vm::Type& src_type, BufferView* src_local,
                       const vm::Type& dst_type, BufferView* dst_local,
                       ARGS... args) {
     // Validate ranges so that we cannot go out of bounds on thunk table.
@@ -44,7 +46,8 @@ struct ApplyConversionOp {
     }
 
     // All possible combinations of conversions.
-    using KernelFn = Status (*)(BufferView * src_local, BufferView * dst_local,
+    using KernelFn = Status (*)(kernels::RuntimeState * runtime_state,
+                                BufferView * src_local, BufferView * dst_local,
                                 ARGS... args);
     KernelFn fn = nullptr;
     if (src_signed && dst_signed) {
@@ -56,63 +59,80 @@ struct ApplyConversionOp {
               /* kI16 */ Thunk<int8_t, int16_t>::Apply,
               /* kI32 */ Thunk<int8_t, int32_t>::Apply,
               /* kI64 */ Thunk<int8_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<int8_t, Float16>::Apply,
               /* kF32 */ Thunk<int8_t, float>::Apply,
               /* kF64 */ Thunk<int8_t, double>::Apply,
+              /* kBF16 */ Thunk<int8_t, BFloat16>::Apply,
 
               // src_type = kI16:
               /* kI8 */ Thunk<int16_t, int8_t>::Apply,
               /* kI16 */ Thunk<int16_t, int16_t>::Apply,
               /* kI32 */ Thunk<int16_t, int32_t>::Apply,
               /* kI64 */ Thunk<int16_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<int16_t, Float16>::Apply,
               /* kF32 */ Thunk<int16_t, float>::Apply,
               /* kF64 */ Thunk<int16_t, double>::Apply,
+              /* kBF16 */ Thunk<int16_t, BFloat16>::Apply,
 
               // src_type = kI32:
               /* kI8 */ Thunk<int32_t, int8_t>::Apply,
               /* kI16 */ Thunk<int32_t, int16_t>::Apply,
               /* kI32 */ Thunk<int32_t, int32_t>::Apply,
               /* kI64 */ Thunk<int32_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<int32_t, Float16>::Apply,
               /* kF32 */ Thunk<int32_t, float>::Apply,
               /* kF64 */ Thunk<int32_t, double>::Apply,
+              /* kBF16 */ Thunk<int32_t, BFloat16>::Apply,
 
               // src_type = kI64:
               /* kI8 */ Thunk<int64_t, int8_t>::Apply,
               /* kI16 */ Thunk<int64_t, int16_t>::Apply,
               /* kI32 */ Thunk<int64_t, int32_t>::Apply,
               /* kI64 */ Thunk<int64_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<int64_t, Float16>::Apply,
               /* kF32 */ Thunk<int64_t, float>::Apply,
               /* kF64 */ Thunk<int64_t, double>::Apply,
+              /* kBF16 */ Thunk<int64_t, BFloat16>::Apply,
 
               // src_type = kF16:
-              /* kI8 */ nullptr,
-              /* kI16 */ nullptr,
-              /* kI32 */ nullptr,
-              /* kI64 */ nullptr,
-              /* kF16 */ Thunk<uint16_t, uint16_t>::Apply,
-              /* kF32 */ nullptr,
-              /* kF64 */ nullptr,
+              /* kI8 */ Thunk<Float16, int8_t>::Apply,
+              /* kI16 */ Thunk<Float16, int16_t>::Apply,
+              /* kI32 */ Thunk<Float16, int32_t>::Apply,
+              /* kI64 */ Thunk<Float16, int64_t>::Apply,
+              /* kF16 */ Thunk<Float16, Float16>::Apply,
+              /* kF32 */ Thunk<Float16, float>::Apply,
+              /* kF64 */ Thunk<Float16, double>::Apply,
+              /* kBF16 */ Thunk<Float16, BFloat16>::Apply,
 
               // src_type = kF32:
               /* kI8 */ Thunk<float, int8_t>::Apply,
               /* kI16 */ Thunk<float, int16_t>::Apply,
               /* kI32 */ Thunk<float, int32_t>::Apply,
               /* kI64 */ Thunk<float, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<float, Float16>::Apply,
               /* kF32 */ Thunk<float, float>::Apply,
               /* kF64 */ Thunk<float, double>::Apply,
+              /* kBF16 */ Thunk<float, BFloat16>::Apply,
 
               // src_type = kF64:
               /* kI8 */ Thunk<double, int8_t>::Apply,
               /* kI16 */ Thunk<double, int16_t>::Apply,
               /* kI32 */ Thunk<double, int32_t>::Apply,
               /* kI64 */ Thunk<double, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<double, Float16>::Apply,
               /* kF32 */ Thunk<double, float>::Apply,
               /* kF64 */ Thunk<double, double>::Apply,
+              /* kBF16 */ Thunk<double, BFloat16>::Apply,
+
+              // src_type = kBF16:
+              /* kI8 */ Thunk<BFloat16, int8_t>::Apply,
+              /* kI16 */ Thunk<BFloat16, int16_t>::Apply,
+              /* kI32 */ Thunk<BFloat16, int32_t>::Apply,
+              /* kI64 */ Thunk<BFloat16, int64_t>::Apply,
+              /* kF16 */ Thunk<BFloat16, Float16>::Apply,
+              /* kF32 */ Thunk<BFloat16, float>::Apply,
+              /* kF64 */ Thunk<BFloat16, double>::Apply,
+              /* kBF16 */ Thunk<BFloat16, BFloat16>::Apply,
           };
       fn =
           kConversionTable[src_type_index * kBuiltinTypeCount + dst_type_index];
@@ -128,6 +148,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI16:
               /* kI8 */ Thunk<int16_t, uint8_t>::Apply,
@@ -137,6 +158,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI32:
               /* kI8 */ Thunk<int32_t, uint8_t>::Apply,
@@ -146,6 +168,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI64:
               /* kI8 */ Thunk<int64_t, uint8_t>::Apply,
@@ -155,15 +178,17 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF16:
-              /* kI8 */ nullptr,
-              /* kI16 */ nullptr,
-              /* kI32 */ nullptr,
-              /* kI64 */ nullptr,
+              /* kI8 */ Thunk<Float16, uint8_t>::Apply,
+              /* kI16 */ Thunk<Float16, uint16_t>::Apply,
+              /* kI32 */ Thunk<Float16, uint32_t>::Apply,
+              /* kI64 */ Thunk<Float16, uint64_t>::Apply,
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF32:
               /* kI8 */ Thunk<float, uint8_t>::Apply,
@@ -173,6 +198,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF64:
               /* kI8 */ Thunk<double, uint8_t>::Apply,
@@ -182,6 +208,17 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
+
+              // src_type = kBF16:
+              /* kI8 */ Thunk<BFloat16, uint8_t>::Apply,
+              /* kI16 */ Thunk<BFloat16, uint16_t>::Apply,
+              /* kI32 */ Thunk<BFloat16, uint32_t>::Apply,
+              /* kI64 */ Thunk<BFloat16, uint64_t>::Apply,
+              /* kF16 */ nullptr,
+              /* kF32 */ nullptr,
+              /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
           };
       fn =
           kConversionTable[src_type_index * kBuiltinTypeCount + dst_type_index];
@@ -194,36 +231,40 @@ struct ApplyConversionOp {
               /* kI16 */ Thunk<uint8_t, int16_t>::Apply,
               /* kI32 */ Thunk<uint8_t, int32_t>::Apply,
               /* kI64 */ Thunk<uint8_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<uint8_t, Float16>::Apply,
               /* kF32 */ Thunk<uint8_t, float>::Apply,
               /* kF64 */ Thunk<uint8_t, double>::Apply,
+              /* kBF16 */ Thunk<uint8_t, BFloat16>::Apply,
 
               // src_type = kI16:
               /* kI8 */ Thunk<uint16_t, int8_t>::Apply,
               /* kI16 */ Thunk<uint16_t, int16_t>::Apply,
               /* kI32 */ Thunk<uint16_t, int32_t>::Apply,
               /* kI64 */ Thunk<uint16_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<uint16_t, Float16>::Apply,
               /* kF32 */ Thunk<uint16_t, float>::Apply,
               /* kF64 */ Thunk<uint16_t, double>::Apply,
+              /* kBF16 */ Thunk<uint16_t, BFloat16>::Apply,
 
               // src_type = kI32:
               /* kI8 */ Thunk<uint32_t, int8_t>::Apply,
               /* kI16 */ Thunk<uint32_t, int16_t>::Apply,
               /* kI32 */ Thunk<uint32_t, int32_t>::Apply,
               /* kI64 */ Thunk<uint32_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<uint32_t, Float16>::Apply,
               /* kF32 */ Thunk<uint32_t, float>::Apply,
               /* kF64 */ Thunk<uint32_t, double>::Apply,
+              /* kBF16 */ Thunk<uint32_t, BFloat16>::Apply,
 
               // src_type = kI64:
               /* kI8 */ Thunk<uint64_t, int8_t>::Apply,
               /* kI16 */ Thunk<uint64_t, int16_t>::Apply,
               /* kI32 */ Thunk<uint64_t, int32_t>::Apply,
               /* kI64 */ Thunk<uint64_t, int64_t>::Apply,
-              /* kF16 */ nullptr,
+              /* kF16 */ Thunk<uint64_t, Float16>::Apply,
               /* kF32 */ Thunk<uint64_t, float>::Apply,
               /* kF64 */ Thunk<uint64_t, double>::Apply,
+              /* kBF16 */ Thunk<uint64_t, BFloat16>::Apply,
 
               // src_type = kF16:
               /* kI8 */ nullptr,
@@ -233,6 +274,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF32:
               /* kI8 */ nullptr,
@@ -242,6 +284,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF64:
               /* kI8 */ nullptr,
@@ -251,6 +294,17 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
+
+              // src_type = kBF16:
+              /* kI8 */ nullptr,
+              /* kI16 */ nullptr,
+              /* kI32 */ nullptr,
+              /* kI64 */ nullptr,
+              /* kF16 */ nullptr,
+              /* kF32 */ nullptr,
+              /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
           };
       fn =
           kConversionTable[src_type_index * kBuiltinTypeCount + dst_type_index];
@@ -266,6 +320,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI16:
               /* kI8 */ Thunk<uint16_t, uint8_t>::Apply,
@@ -275,6 +330,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI32:
               /* kI8 */ Thunk<uint32_t, uint8_t>::Apply,
@@ -284,6 +340,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kI64:
               /* kI8 */ Thunk<uint64_t, uint8_t>::Apply,
@@ -293,6 +350,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF16:
               /* kI8 */ nullptr,
@@ -302,6 +360,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF32:
               /* kI8 */ nullptr,
@@ -311,6 +370,7 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
 
               // src_type = kF64:
               /* kI8 */ nullptr,
@@ -320,6 +380,17 @@ struct ApplyConversionOp {
               /* kF16 */ nullptr,
               /* kF32 */ nullptr,
               /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
+
+              // src_type = kBF16:
+              /* kI8 */ nullptr,
+              /* kI16 */ nullptr,
+              /* kI32 */ nullptr,
+              /* kI64 */ nullptr,
+              /* kF16 */ nullptr,
+              /* kF32 */ nullptr,
+              /* kF64 */ nullptr,
+              /* kBF16 */ nullptr,
           };
       fn =
           kConversionTable[src_type_index * kBuiltinTypeCount + dst_type_index];
@@ -329,19 +400,21 @@ struct ApplyConversionOp {
              << "Unsupported conversion from " << src_type_index << " to "
              << dst_type_index;
     }
-    return fn(src_local, dst_local, args...);
+    return fn(runtime_state, src_local, dst_local, args...);
   }
 
   template <typename SRC, typename DST>
   struct Thunk {
-    static Status Apply(BufferView* src_local, BufferView* dst_local,
+    static Status Apply(kernels::RuntimeState* runtime_state,
+                        BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       ASSIGN_OR_RETURN(auto src_buffer,
                        src_local->buffer->MapMemory<SRC>(MemoryAccess::kRead));
       ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<DST>(
                                             MemoryAccess::kDiscardWrite));
-      return KERNEL::Execute(src_buffer.contents(),
-                             dst_buffer.mutable_contents(), args...);
+      return kernels::ExecuteMorsels<KERNEL>(
+          runtime_state, src_buffer.contents(), dst_buffer.mutable_contents(),
+          args...);
     }
   };
 
@@ -349,14 +422,16 @@ struct ApplyConversionOp {
 #if !defined(IREE_SUPPORT_F32)
   template <typename DST>
   struct Thunk<float, DST> {
-    static Status Apply(BufferView* src_local, BufferView* dst_local,
+    static Status Apply(kernels::RuntimeState* runtime_state,
+                        BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       return UnimplementedErrorBuilder(IREE_LOC) << "F32 not supported";
     }
   };
   template <typename SRC>
   struct Thunk<SRC, float> {
-    static Status Apply(BufferView* src_local, BufferView* dst_local,
+    static Status Apply(kernels::RuntimeState* runtime_state,
+                        BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       return UnimplementedErrorBuilder(IREE_LOC) << "F32 not supported";
     }
@@ -365,14 +440,16 @@ struct ApplyConversionOp {
 #if !defined(IREE_SUPPORT_F64)
   template <typename DST>
   struct Thunk<double, DST> {
-    static Status Apply(BufferView* src_local, BufferView* dst_local,
+    static Status Apply(kernels::RuntimeState* runtime_state,
+                        BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       return UnimplementedErrorBuilder(IREE_LOC) << "F64 not supported";
     }
   };
   template <typename SRC>
   struct Thunk<SRC, double> {
-    static Status Apply(BufferView* src_local, BufferView* dst_local,
+    static Status Apply(kernels::RuntimeState* runtime_state,
+                        BufferView* src_local, BufferView* dst_local,
                         ARGS... args) {
       return UnimplementedErrorBuilder(IREE_LOC) << "F64 not supported";
     }
@@ -14,6 +14,8 @@
 
 #include "iree/hal/interpreter/bytecode_dispatch_util.h"
 
+#include <limits>
+
 namespace iree {
 namespace hal {
 
@@ -34,6 +36,26 @@ bool BufferViewIsTrue(const BufferView& buffer_view) {
   return false;
 }
 
+StatusOr<std::vector<float>> WidenFloat16(BufferMappingCache* mappings,
+                                          BufferView* buffer_view) {
+  ASSIGN_OR_RETURN(auto buffer, mappings->MapRead<Float16>(buffer_view));
+  std::vector<float> values(buffer.size());
+  ConvertToFloat(buffer, absl::MakeSpan(values));
+  return values;
+}
+
+Status NarrowFloat16(BufferMappingCache* mappings,
+                     absl::Span<const float> values, BufferView* buffer_view) {
+  ASSIGN_OR_RETURN(auto buffer, mappings->MapWrite<Float16>(buffer_view));
+  if (buffer.size() != values.size()) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Destination has " << buffer.size() << " elements but "
+           << values.size() << " were computed";
+  }
+  ConvertFromFloat(values, buffer);
+  return OkStatus();
+}
+
 Status ValidateElementwiseUnaryOp(BufferView* src_local,
                                   BufferView* dst_local) {
   // TODO(benvanik): validate shapes.
@@ -53,6 +75,57 @@ Status ValidateElementwiseTernaryOp(BufferView* a_local, BufferView* b_local,
   return OkStatus();
 }
 
+Status ValidateFusedElementwiseOpF(absl::Span<BufferView* const> input_locals,
+                                   absl::Span<const int32_t> program,
+                                   BufferView* dst_local) {
+  size_t element_count = dst_local->shape.element_count();
+  for (auto* input_local : input_locals) {
+    if (input_local->element_size != dst_local->element_size ||
+        input_local->shape.element_count() != element_count) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Fused elementwise inputs must match the output; input "
+             << input_local->shape << " (" << input_local->element_size
+             << "b) vs output " << dst_local->shape << " ("
+             << dst_local->element_size << "b)";
+    }
+  }
+  if (program.empty() ||
+      program.size() % kFusedElementwiseInstructionSize != 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Fused elementwise program length " << program.size()
+           << " is not a non-zero multiple of "
+           << kFusedElementwiseInstructionSize;
+  }
+  int register_count = input_locals.size();
+  for (size_t i = 0; i < program.size();
+       i += kFusedElementwiseInstructionSize) {
+    int arity = 0;
+    switch (static_cast<FusedElementwiseOp>(program[i])) {
+#define FUSED_OP_ARITY(ordinal, enum_name, mnemonic, op_arity) \
+  case FusedElementwiseOp::enum_name:                          \
+    arity = op_arity;                                          \
+    break;
+      IREE_FUSED_ELEMENTWISE_OP_LIST(FUSED_OP_ARITY)
+#undef FUSED_OP_ARITY
+      default:
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Unknown fused elementwise op " << program[i];
+    }
+    for (int j = 1; j < kFusedElementwiseInstructionSize; ++j) {
+      int operand = program[i + j];
+      if (operand < 0 || operand >= register_count ||
+          (j > arity && operand != 0)) {
+        return InvalidArgumentErrorBuilder(IREE_LOC)
+               << "Fused elementwise instruction "
+               << i / kFusedElementwiseInstructionSize
+               << " has invalid operand register " << operand;
+      }
+    }
+    ++register_count;
+  }
+  return OkStatus();
+}
+
 Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local,
                          BufferView* multiplier_mantissa_local,
@@ -68,8 +141,154 @@ Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
   return OkStatus();
 }
 
-Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
-                 BufferView* dst_local, absl::Span<const int32_t> dst_indices,
+Status ValidateConv2DOpF(BufferView* input_local, BufferView* filter_local,
+                         BufferView* dst_local,
+                         const kernels::Conv2D::Params& params) {
+  const auto& input_shape = input_local->shape;
+  const auto& filter_shape = filter_local->shape;
+  const auto& dst_shape = dst_local->shape;
+  if (input_shape.size() != 4 || filter_shape.size() != 4 ||
+      dst_shape.size() != 4) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D requires rank-4 NHWC input/output and HWIO filter; got "
+           << input_shape << ", " << filter_shape << " -> " << dst_shape;
+  }
+  if (params.stride_h < 1 || params.stride_w < 1 || params.dilation_h < 1 ||
+      params.dilation_w < 1 || params.feature_group_count < 1) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D strides, dilations and feature group count must be >= 1";
+  }
+  const int groups = params.feature_group_count;
+  if (input_shape[3] != filter_shape[2] * groups ||
+      filter_shape[3] % groups != 0 || dst_shape[3] != filter_shape[3]) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D channel mismatch for " << groups << " group(s): input "
+           << input_shape << ", filter " << filter_shape << ", output "
+           << dst_shape;
+  }
+  auto output_size = [](int input_size, int filter_size, int stride,
+                        int dilation, int pad_before, int pad_after) {
+    int padded_size = input_size + pad_before + pad_after;
+    int dilated_filter_size = (filter_size - 1) * dilation + 1;
+    if (padded_size < dilated_filter_size) return 0;
+    return (padded_size - dilated_filter_size) / stride + 1;
+  };
+  int expected_h = output_size(input_shape[1], filter_shape[0],
+                               params.stride_h, params.dilation_h,
+                               params.pad_top, params.pad_bottom);
+  int expected_w = output_size(input_shape[2], filter_shape[1],
+                               params.stride_w, params.dilation_w,
+                               params.pad_left, params.pad_right);
+  if (dst_shape[0] != input_shape[0] || dst_shape[1] != expected_h ||
+      dst_shape[2] != expected_w) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Conv2D output shape " << dst_shape
+           << " does not match expected [" << input_shape[0] << ","
+           << expected_h << "," << expected_w << "," << filter_shape[3] << "]";
+  }
+  return OkStatus();
+}
+
+namespace {
+
+// Validates the bias and fixed-point multipliers of a quantized op producing
+// |channel_count| output channels along with its zero points and clamp range.
+Status ValidateQuantizedOutputs(
+    BufferView* bias_local, BufferView* multiplier_mantissa_local,
+    BufferView* multiplier_exponent_local, int element_size, int channel_count,
+    const kernels::QuantizationParams& quantization) {
+  if (element_size != 1) {
+    return UnimplementedErrorBuilder(IREE_LOC)
+           << "Only int8 quantized ops are supported; got element size "
+           << element_size;
+  }
+  if (bias_local->element_size != sizeof(int32_t) ||
+      (bias_local->shape.element_count() != 0 &&
+       bias_local->shape.element_count() != channel_count)) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Quantized bias must be empty or " << channel_count
+           << " int32 values; got " << bias_local->shape;
+  }
+  const int multiplier_count = multiplier_mantissa_local->shape.element_count();
+  if (multiplier_mantissa_local->element_size != sizeof(int32_t) ||
+      multiplier_exponent_local->element_size != sizeof(int32_t) ||
+      (multiplier_count != 1 && multiplier_count != channel_count) ||
+      multiplier_exponent_local->shape.element_count() != multiplier_count) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Quantized multipliers must be 1 or " << channel_count
+           << " int32 mantissa/exponent pairs; got "
+           << multiplier_mantissa_local->shape << " and "
+           << multiplier_exponent_local->shape;
+  }
+  for (int32_t zero_point :
+       {quantization.lhs_zero_point, quantization.rhs_zero_point,
+        quantization.dst_zero_point}) {
+    if (zero_point < std::numeric_limits<int8_t>::lowest() ||
+        zero_point > std::numeric_limits<int8_t>::max()) {
+      return OutOfRangeErrorBuilder(IREE_LOC)
+             << "Zero point " << zero_point << " out of range for int8";
+    }
+  }
+  if (quantization.clamp_min > quantization.clamp_max) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Empty clamp range [" << quantization.clamp_min << ", "
+           << quantization.clamp_max << "]";
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status ValidateMatMulOpQ(BufferView* lhs_local, BufferView* rhs_local,
+                         BufferView* bias_local,
+                         BufferView* multiplier_mantissa_local,
+                         BufferView* multiplier_exponent_local,
+                         BufferView* dst_local,
+                         const kernels::QuantizationParams& quantization) {
+  const auto& lhs_shape = lhs_local->shape;
+  const auto& rhs_shape = rhs_local->shape;
+  const auto& dst_shape = dst_local->shape;
+  if (lhs_shape.size() != 2 || rhs_shape.size() != 2 || dst_shape.size() != 2 ||
+      lhs_shape[1] != rhs_shape[0] || dst_shape[0] != lhs_shape[0] ||
+      dst_shape[1] != rhs_shape[1]) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Quantized MatMul shape mismatch: " << lhs_shape << " * "
+           << rhs_shape << " -> " << dst_shape;
+  }
+  if (rhs_local->element_size != lhs_local->element_size ||
+      dst_local->element_size != lhs_local->element_size) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Quantized MatMul operands must share an element type";
+  }
+  return ValidateQuantizedOutputs(bias_local, multiplier_mantissa_local,
+                                  multiplier_exponent_local,
+                                  lhs_local->element_size, rhs_shape[1],
+                                  quantization);
+}
+
+Status ValidateConv2DOpQ(BufferView* input_local, BufferView* filter_local,
+                         BufferView* bias_local,
+                         BufferView* multiplier_mantissa_local,
+                         BufferView* multiplier_exponent_local,
+                         BufferView* dst_local,
+                         const kernels::Conv2D::Params& params,
+                         const kernels::QuantizationParams& quantization) {
+  RETURN_IF_ERROR(
+      ValidateConv2DOpF(input_local, filter_local, dst_local, params));
+  if (filter_local->element_size != input_local->element_size ||
+      dst_local->element_size != input_local->element_size) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Quantized Conv2D operands must share an element type";
+  }
+  return ValidateQuantizedOutputs(bias_local, multiplier_mantissa_local,
+                                  multiplier_exponent_local,
+                                  input_local->element_size,
+                                  filter_local->shape[3], quantization);
+}
+
+Status ApplyCopy(kernels::RuntimeState* runtime_state, BufferView* src_local,
+                 absl::Span<const int32_t> src_indices, BufferView* dst_local,
+                 absl::Span<const int32_t> dst_indices,
                  absl::Span<const int32_t> lengths) {
   ASSIGN_OR_RETURN(auto src_buffer,
                    src_local->buffer->MapMemory<uint8_t>(MemoryAccess::kRead));
@@ -78,25 +297,25 @@ Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
                    dst_local->buffer->MapMemory<uint8_t>(MemoryAccess::kWrite));
   switch (src_local->element_size) {
     case 1:
-      return kernels::Copy::Execute<1>(src_buffer.contents(), src_local->shape,
-                                       src_indices,
-                                       dst_buffer.mutable_contents(),
-                                       dst_local->shape, dst_indices, lengths);
+      return kernels::ExecuteCopyMorsels<1>(
+          runtime_state, src_buffer.contents(), src_local->shape, src_indices,
+          dst_buffer.mutable_contents(), dst_local->shape, dst_indices,
+          lengths);
     case 2:
-      return kernels::Copy::Execute<2>(src_buffer.contents(), src_local->shape,
-                                       src_indices,
-                                       dst_buffer.mutable_contents(),
-                                       dst_local->shape, dst_indices, lengths);
+      return kernels::ExecuteCopyMorsels<2>(
+          runtime_state, src_buffer.contents(), src_local->shape, src_indices,
+          dst_buffer.mutable_contents(), dst_local->shape, dst_indices,
+          lengths);
     case 4:
-      return kernels::Copy::Execute<4>(src_buffer.contents(), src_local->shape,
-                                       src_indices,
-                                       dst_buffer.mutable_contents(),
-                                       dst_local->shape, dst_indices, lengths);
+      return kernels::ExecuteCopyMorsels<4>(
+          runtime_state, src_buffer.contents(), src_local->shape, src_indices,
+          dst_buffer.mutable_contents(), dst_local->shape, dst_indices,
+          lengths);
     case 8:
-      return kernels::Copy::Execute<8>(src_buffer.contents(), src_local->shape,
-                                       src_indices,
-                                       dst_buffer.mutable_contents(),
-                                       dst_local->shape, dst_indices, lengths);
+      return kernels::ExecuteCopyMorsels<8>(
+          runtime_state, src_buffer.contents(), src_local->shape, src_indices,
+          dst_buffer.mutable_contents(), dst_local->shape, dst_indices,
+          lengths);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << src_local->element_size;
@@ -18,11 +18,15 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_UTIL_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_DISPATCH_UTIL_H_
 
+#include <vector>
+
 #include "absl/base/attributes.h"
 #include "absl/container/inlined_vector.h"
+#include "iree/base/half_float.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/hal/heap_buffer.h"
+#include "iree/hal/interpreter/buffer_mapping_cache.h"
 #include "iree/hal/interpreter/bytecode_kernels.h"
 #include "iree/rt/function.h"
 #include "iree/rt/stack.h"
@@ -31,6 +35,7 @@
 #include "iree/vm/type.h"
 
 // TODO(benvanik): move to dedicated config file/build flags.
+#define IREE_SUPPORT_F16 1
 #define IREE_SUPPORT_F32 1
 #define IREE_SUPPORT_F64 1
 
@@ -47,6 +52,9 @@ Status ValidateElementwiseBinaryOp(BufferView* lhs_local, BufferView* rhs_local,
                                    BufferView* dst_local);
 Status ValidateElementwiseTernaryOp(BufferView* a_local, BufferView* b_local,
                                     BufferView* c_local, BufferView* dst_local);
+Status ValidateFusedElementwiseOpF(absl::Span<BufferView* const> input_locals,
+                                   absl::Span<const int32_t> program,
+                                   BufferView* dst_local);
 Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local,
                          BufferView* multiplier_mantissa_local,
@@ -54,74 +62,157 @@ Status ValidateMatMulOpI(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* dst_local);
 Status ValidateMatMulOpF(BufferView* lhs_local, BufferView* rhs_local,
                          BufferView* bias_local, BufferView* dst_local);
-
+Status ValidateConv2DOpF(BufferView* input_local, BufferView* filter_local,
+                         BufferView* dst_local,
+                         const kernels::Conv2D::Params& params);
+Status ValidateMatMulOpQ(BufferView* lhs_local, BufferView* rhs_local,
+                         BufferView* bias_local,
+                         BufferView* multiplier_mantissa_local,
+                         BufferView* multiplier_exponent_local,
+                         BufferView* dst_local,
+                         const kernels::QuantizationParams& quantization);
+Status ValidateConv2DOpQ(BufferView* input_local, BufferView* filter_local,
+                         BufferView* bias_local,
+                         BufferView* multiplier_mantissa_local,
+                         BufferView* multiplier_exponent_local,
+                         BufferView* dst_local,
+                         const kernels::Conv2D::Params& params,
+                         const kernels::QuantizationParams& quantization);
+
+// The Apply*Op helpers resolve their operands to host pointers through the
+// dispatch's BufferMappingCache so that buffers touched by consecutive ops are
+// only mapped once. Kernels run via kernels::ExecuteMorsels so that large
+// elementwise ops are split across the runtime thread pool.
 template <typename KERNEL, typename T, typename... ARGS>
-Status ApplyUnaryOp(BufferView* src_local, BufferView* dst_local,
-                    ARGS... args) {
-  // TODO(benvanik): avoid mapping by changing buffer type?
-  ASSIGN_OR_RETURN(auto src_buffer,
-                   src_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
-  return KERNEL::Execute(src_buffer.contents(), dst_buffer.mutable_contents(),
-                         args...);
+Status ApplyUnaryOp(kernels::RuntimeState* runtime_state,
+                    BufferMappingCache* mappings, BufferView* src_local,
+                    BufferView* dst_local, ARGS... args) {
+  ASSIGN_OR_RETURN(auto src_buffer, mappings->MapRead<T>(src_local));
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<T>(dst_local));
+  return kernels::ExecuteMorsels<KERNEL>(runtime_state, src_buffer, dst_buffer,
+                                         args...);
 }
 
 template <typename KERNEL, typename T, typename... ARGS>
-Status ApplyBinaryOp(BufferView* lhs_local, BufferView* rhs_local,
-                     BufferView* dst_local, ARGS... args) {
-  ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
-  return KERNEL::Execute(lhs_buffer.contents(), rhs_buffer.contents(),
-                         dst_buffer.mutable_contents(), args...);
+Status ApplyBinaryOp(kernels::RuntimeState* runtime_state,
+                     BufferMappingCache* mappings, BufferView* lhs_local,
+                     BufferView* rhs_local, BufferView* dst_local,
+                     ARGS... args) {
+  ASSIGN_OR_RETURN(auto lhs_buffer, mappings->MapRead<T>(lhs_local));
+  ASSIGN_OR_RETURN(auto rhs_buffer, mappings->MapRead<T>(rhs_local));
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<T>(dst_local));
+  return kernels::ExecuteMorsels<KERNEL>(runtime_state, lhs_buffer, rhs_buffer,
+                                         dst_buffer, args...);
 }
 
 template <typename KERNEL, typename T, typename... ARGS>
-Status ApplyTernaryOp(BufferView* a_local, BufferView* b_local,
-                      BufferView* c_local, BufferView* dst_local,
-                      ARGS... args) {
-  ASSIGN_OR_RETURN(auto a_buffer,
-                   a_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto b_buffer,
-                   b_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto c_buffer,
-                   c_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
-                                        MemoryAccess::kDiscardWrite));
-  return KERNEL::Execute(a_buffer.contents(), b_buffer.contents(),
-                         c_buffer.contents(), dst_buffer.mutable_contents(),
-                         args...);
+Status ApplyTernaryOp(kernels::RuntimeState* runtime_state,
+                      BufferMappingCache* mappings, BufferView* a_local,
+                      BufferView* b_local, BufferView* c_local,
+                      BufferView* dst_local, ARGS... args) {
+  ASSIGN_OR_RETURN(auto a_buffer, mappings->MapRead<T>(a_local));
+  ASSIGN_OR_RETURN(auto b_buffer, mappings->MapRead<T>(b_local));
+  ASSIGN_OR_RETURN(auto c_buffer, mappings->MapRead<T>(c_local));
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<T>(dst_local));
+  return kernels::ExecuteMorsels<KERNEL>(runtime_state, a_buffer, b_buffer,
+                                         c_buffer, dst_buffer, args...);
 }
 
 template <typename KERNEL, typename T>
-Status ApplyComparisonOp(BufferView* lhs_local, BufferView* rhs_local,
-                         BufferView* dst_local) {
-  ASSIGN_OR_RETURN(auto lhs_buffer,
-                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto rhs_buffer,
-                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
-  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<uint8_t>(
-                                        MemoryAccess::kDiscardWrite));
-  return KERNEL::Execute(lhs_buffer.contents(), rhs_buffer.contents(),
-                         dst_buffer.mutable_contents());
+Status ApplyComparisonOp(kernels::RuntimeState* runtime_state,
+                         BufferMappingCache* mappings, BufferView* lhs_local,
+                         BufferView* rhs_local, BufferView* dst_local) {
+  ASSIGN_OR_RETURN(auto lhs_buffer, mappings->MapRead<T>(lhs_local));
+  ASSIGN_OR_RETURN(auto rhs_buffer, mappings->MapRead<T>(rhs_local));
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<uint8_t>(dst_local));
+  return kernels::ExecuteMorsels<KERNEL>(runtime_state, lhs_buffer, rhs_buffer,
+                                         dst_buffer);
 }
 
+// Returns the f16 contents of |buffer_view| widened to f32.
+StatusOr<std::vector<float>> WidenFloat16(BufferMappingCache* mappings,
+                                          BufferView* buffer_view);
+
+// Stores f32 |values| into |buffer_view| narrowed to f16.
+Status NarrowFloat16(BufferMappingCache* mappings,
+                     absl::Span<const float> values, BufferView* buffer_view);
+
+// f16 is a storage-only type: operands are widened to f32, the f32 kernel is
+// run, and the results are narrowed (round to nearest even) back to f16.
 template <typename KERNEL, typename... ARGS>
-Status ApplyUnaryOpIS(BufferView* src_local, BufferView* dst_local,
-                      ARGS... args) {
+Status ApplyUnaryOpF16(kernels::RuntimeState* runtime_state,
+                       BufferMappingCache* mappings, BufferView* src_local,
+                       BufferView* dst_local, ARGS... args) {
+  ASSIGN_OR_RETURN(auto src_values, WidenFloat16(mappings, src_local));
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  RETURN_IF_ERROR(kernels::ExecuteMorsels<KERNEL>(
+      runtime_state, absl::MakeConstSpan(src_values),
+      absl::MakeSpan(dst_values), args...));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
+template <typename KERNEL, typename... ARGS>
+Status ApplyBinaryOpF16(kernels::RuntimeState* runtime_state,
+                        BufferMappingCache* mappings, BufferView* lhs_local,
+                        BufferView* rhs_local, BufferView* dst_local,
+                        ARGS... args) {
+  ASSIGN_OR_RETURN(auto lhs_values, WidenFloat16(mappings, lhs_local));
+  ASSIGN_OR_RETURN(auto rhs_values, WidenFloat16(mappings, rhs_local));
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  RETURN_IF_ERROR(kernels::ExecuteMorsels<KERNEL>(
+      runtime_state, absl::MakeConstSpan(lhs_values),
+      absl::MakeConstSpan(rhs_values), absl::MakeSpan(dst_values), args...));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
+template <typename KERNEL, typename... ARGS>
+Status ApplyTernaryOpF16(kernels::RuntimeState* runtime_state,
+                         BufferMappingCache* mappings, BufferView* a_local,
+                         BufferView* b_local, BufferView* c_local,
+                         BufferView* dst_local, ARGS... args) {
+  ASSIGN_OR_RETURN(auto a_values, WidenFloat16(mappings, a_local));
+  ASSIGN_OR_RETURN(auto b_values, WidenFloat16(mappings, b_local));
+  ASSIGN_OR_RETURN(auto c_values, WidenFloat16(mappings, c_local));
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  RETURN_IF_ERROR(kernels::ExecuteMorsels<KERNEL>(
+      runtime_state, absl::MakeConstSpan(a_values),
+      absl::MakeConstSpan(b_values), absl::MakeConstSpan(c_values),
+      absl::MakeSpan(dst_values), args...));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
+template <typename KERNEL>
+Status ApplyComparisonOpF16(kernels::RuntimeState* runtime_state,
+                            BufferMappingCache* mappings, BufferView* lhs_local,
+                            BufferView* rhs_local, BufferView* dst_local) {
+  ASSIGN_OR_RETURN(auto lhs_values, WidenFloat16(mappings, lhs_local));
+  ASSIGN_OR_RETURN(auto rhs_values, WidenFloat16(mappings, rhs_local));
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<uint8_t>(dst_local));
+  return kernels::ExecuteMorsels<KERNEL>(
+      runtime_state, absl::MakeConstSpan(lhs_values),
+      absl::MakeConstSpan(rhs_values), dst_buffer);
+}
+
+template <typename KERNEL, typename... ARGS>
+Status ApplyUnaryOpIS(kernels::RuntimeState* runtime_state,
+                      BufferMappingCache* mappings, BufferView* src_local,
+                      BufferView* dst_local, ARGS... args) {
   switch (src_local->element_size) {
     case 1:
-      return ApplyUnaryOp<KERNEL, int8_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, int8_t>(runtime_state, mappings, src_local,
+                                          dst_local, args...);
     case 2:
-      return ApplyUnaryOp<KERNEL, int16_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, int16_t>(runtime_state, mappings, src_local,
+                                           dst_local, args...);
     case 4:
-      return ApplyUnaryOp<KERNEL, int32_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, int32_t>(runtime_state, mappings, src_local,
+                                           dst_local, args...);
     case 8:
-      return ApplyUnaryOp<KERNEL, int64_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, int64_t>(runtime_state, mappings, src_local,
+                                           dst_local, args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << src_local->element_size;
@@ -129,17 +220,22 @@ Status ApplyUnaryOpIS(BufferView* src_local, BufferView* dst_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyUnaryOpIU(BufferView* src_local, BufferView* dst_local,
-                      ARGS... args) {
+Status ApplyUnaryOpIU(kernels::RuntimeState* runtime_state,
+                      BufferMappingCache* mappings, BufferView* src_local,
+                      BufferView* dst_local, ARGS... args) {
   switch (src_local->element_size) {
     case 1:
-      return ApplyUnaryOp<KERNEL, uint8_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, uint8_t>(runtime_state, mappings, src_local,
+                                           dst_local, args...);
     case 2:
-      return ApplyUnaryOp<KERNEL, uint16_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, uint16_t>(runtime_state, mappings, src_local,
+                                            dst_local, args...);
     case 4:
-      return ApplyUnaryOp<KERNEL, uint32_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, uint32_t>(runtime_state, mappings, src_local,
+                                            dst_local, args...);
     case 8:
-      return ApplyUnaryOp<KERNEL, uint64_t>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, uint64_t>(runtime_state, mappings, src_local,
+                                            dst_local, args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << src_local->element_size;
@@ -147,16 +243,24 @@ Status ApplyUnaryOpIU(BufferView* src_local, BufferView* dst_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyUnaryOpF(BufferView* src_local, BufferView* dst_local,
-                     ARGS... args) {
+Status ApplyUnaryOpF(kernels::RuntimeState* runtime_state,
+                     BufferMappingCache* mappings, BufferView* src_local,
+                     BufferView* dst_local, ARGS... args) {
   switch (src_local->element_size) {
+#if defined(IREE_SUPPORT_F16)
+    case 2:
+      return ApplyUnaryOpF16<KERNEL>(runtime_state, mappings, src_local,
+                                     dst_local, args...);
+#endif  // IREE_SUPPORT_F16
 #if defined(IREE_SUPPORT_F32)
     case 4:
-      return ApplyUnaryOp<KERNEL, float>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, float>(runtime_state, mappings, src_local,
+                                         dst_local, args...);
 #endif  // IREE_SUPPORT_F32
 #if defined(IREE_SUPPORT_F64)
     case 8:
-      return ApplyUnaryOp<KERNEL, double>(src_local, dst_local, args...);
+      return ApplyUnaryOp<KERNEL, double>(runtime_state, mappings, src_local,
+                                          dst_local, args...);
 #endif  // IREE_SUPPORT_F64
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
@@ -165,21 +269,23 @@ Status ApplyUnaryOpF(BufferView* src_local, BufferView* dst_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyBinaryOpIS(BufferView* lhs_local, BufferView* rhs_local,
-                       BufferView* dst_local, ARGS... args) {
+Status ApplyBinaryOpIS(kernels::RuntimeState* runtime_state,
+                       BufferMappingCache* mappings, BufferView* lhs_local,
+                       BufferView* rhs_local, BufferView* dst_local,
+                       ARGS... args) {
   switch (lhs_local->element_size) {
     case 1:
-      return ApplyBinaryOp<KERNEL, int8_t>(lhs_local, rhs_local, dst_local,
-                                           args...);
+      return ApplyBinaryOp<KERNEL, int8_t>(runtime_state, mappings, lhs_local,
+                                           rhs_local, dst_local, args...);
     case 2:
-      return ApplyBinaryOp<KERNEL, int16_t>(lhs_local, rhs_local, dst_local,
-                                            args...);
+      return ApplyBinaryOp<KERNEL, int16_t>(runtime_state, mappings, lhs_local,
+                                            rhs_local, dst_local, args...);
     case 4:
-      return ApplyBinaryOp<KERNEL, int32_t>(lhs_local, rhs_local, dst_local,
-                                            args...);
+      return ApplyBinaryOp<KERNEL, int32_t>(runtime_state, mappings, lhs_local,
+                                            rhs_local, dst_local, args...);
     case 8:
-      return ApplyBinaryOp<KERNEL, int64_t>(lhs_local, rhs_local, dst_local,
-                                            args...);
+      return ApplyBinaryOp<KERNEL, int64_t>(runtime_state, mappings, lhs_local,
+                                            rhs_local, dst_local, args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << lhs_local->element_size;
@@ -187,21 +293,23 @@ Status ApplyBinaryOpIS(BufferView* lhs_local, BufferView* rhs_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyBinaryOpIU(BufferView* lhs_local, BufferView* rhs_local,
-                       BufferView* dst_local, ARGS... args) {
+Status ApplyBinaryOpIU(kernels::RuntimeState* runtime_state,
+                       BufferMappingCache* mappings, BufferView* lhs_local,
+                       BufferView* rhs_local, BufferView* dst_local,
+                       ARGS... args) {
   switch (lhs_local->element_size) {
     case 1:
-      return ApplyBinaryOp<KERNEL, uint8_t>(lhs_local, rhs_local, dst_local,
-                                            args...);
+      return ApplyBinaryOp<KERNEL, uint8_t>(runtime_state, mappings, lhs_local,
+                                            rhs_local, dst_local, args...);
     case 2:
-      return ApplyBinaryOp<KERNEL, uint16_t>(lhs_local, rhs_local, dst_local,
-                                             args...);
+      return ApplyBinaryOp<KERNEL, uint16_t>(runtime_state, mappings, lhs_local,
+                                             rhs_local, dst_local, args...);
     case 4:
-      return ApplyBinaryOp<KERNEL, uint32_t>(lhs_local, rhs_local, dst_local,
-                                             args...);
+      return ApplyBinaryOp<KERNEL, uint32_t>(runtime_state, mappings, lhs_local,
+                                             rhs_local, dst_local, args...);
     case 8:
-      return ApplyBinaryOp<KERNEL, uint64_t>(lhs_local, rhs_local, dst_local,
-                                             args...);
+      return ApplyBinaryOp<KERNEL, uint64_t>(runtime_state, mappings, lhs_local,
+                                             rhs_local, dst_local, args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << lhs_local->element_size;
@@ -209,18 +317,25 @@ Status ApplyBinaryOpIU(BufferView* lhs_local, BufferView* rhs_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyBinaryOpF(BufferView* lhs_local, BufferView* rhs_local,
-                      BufferView* dst_local, ARGS... args) {
+Status ApplyBinaryOpF(kernels::RuntimeState* runtime_state,
+                      BufferMappingCache* mappings, BufferView* lhs_local,
+                      BufferView* rhs_local, BufferView* dst_local,
+                      ARGS... args) {
   switch (lhs_local->element_size) {
+#if defined(IREE_SUPPORT_F16)
+    case 2:
+      return ApplyBinaryOpF16<KERNEL>(runtime_state, mappings, lhs_local,
+                                      rhs_local, dst_local, args...);
+#endif  // IREE_SUPPORT_F16
 #if defined(IREE_SUPPORT_F32)
     case 4:
-      return ApplyBinaryOp<KERNEL, float>(lhs_local, rhs_local, dst_local,
-                                          args...);
+      return ApplyBinaryOp<KERNEL, float>(runtime_state, mappings, lhs_local,
+                                          rhs_local, dst_local, args...);
 #endif  // IREE_SUPPORT_F32
 #if defined(IREE_SUPPORT_F64)
     case 8:
-      return ApplyBinaryOp<KERNEL, double>(lhs_local, rhs_local, dst_local,
-                                           args...);
+      return ApplyBinaryOp<KERNEL, double>(runtime_state, mappings, lhs_local,
+                                           rhs_local, dst_local, args...);
 #endif  // IREE_SUPPORT_F64
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
@@ -229,22 +344,27 @@ Status ApplyBinaryOpF(BufferView* lhs_local, BufferView* rhs_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyTernaryOpIS(BufferView* a_local, BufferView* b_local,
-                        BufferView* c_local, BufferView* dst_local,
-                        ARGS... args) {
+Status ApplyTernaryOpIS(kernels::RuntimeState* runtime_state,
+                        BufferMappingCache* mappings, BufferView* a_local,
+                        BufferView* b_local, BufferView* c_local,
+                        BufferView* dst_local, ARGS... args) {
   switch (a_local->element_size) {
     case 1:
-      return ApplyTernaryOp<KERNEL, int8_t>(a_local, b_local, c_local,
-                                            dst_local, args...);
+      return ApplyTernaryOp<KERNEL, int8_t>(runtime_state, mappings, a_local,
+                                            b_local, c_local, dst_local,
+                                            args...);
     case 2:
-      return ApplyTernaryOp<KERNEL, int16_t>(a_local, b_local, c_local,
-                                             dst_local, args...);
+      return ApplyTernaryOp<KERNEL, int16_t>(runtime_state, mappings, a_local,
+                                             b_local, c_local, dst_local,
+                                             args...);
     case 4:
-      return ApplyTernaryOp<KERNEL, int32_t>(a_local, b_local, c_local,
-                                             dst_local, args...);
+      return ApplyTernaryOp<KERNEL, int32_t>(runtime_state, mappings, a_local,
+                                             b_local, c_local, dst_local,
+                                             args...);
     case 8:
-      return ApplyTernaryOp<KERNEL, int64_t>(a_local, b_local, c_local,
-                                             dst_local, args...);
+      return ApplyTernaryOp<KERNEL, int64_t>(runtime_state, mappings, a_local,
+                                             b_local, c_local, dst_local,
+                                             args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << a_local->element_size;
@@ -252,22 +372,27 @@ Status ApplyTernaryOpIS(BufferView* a_local, BufferView* b_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyTernaryOpIU(BufferView* a_local, BufferView* b_local,
-                        BufferView* c_local, BufferView* dst_local,
-                        ARGS... args) {
+Status ApplyTernaryOpIU(kernels::RuntimeState* runtime_state,
+                        BufferMappingCache* mappings, BufferView* a_local,
+                        BufferView* b_local, BufferView* c_local,
+                        BufferView* dst_local, ARGS... args) {
   switch (a_local->element_size) {
     case 1:
-      return ApplyTernaryOp<KERNEL, uint8_t>(a_local, b_local, c_local,
-                                             dst_local, args...);
+      return ApplyTernaryOp<KERNEL, uint8_t>(runtime_state, mappings, a_local,
+                                             b_local, c_local, dst_local,
+                                             args...);
     case 2:
-      return ApplyTernaryOp<KERNEL, uint16_t>(a_local, b_local, c_local,
-                                              dst_local, args...);
+      return ApplyTernaryOp<KERNEL, uint16_t>(runtime_state, mappings, a_local,
+                                              b_local, c_local, dst_local,
+                                              args...);
     case 4:
-      return ApplyTernaryOp<KERNEL, uint32_t>(a_local, b_local, c_local,
-                                              dst_local, args...);
+      return ApplyTernaryOp<KERNEL, uint32_t>(runtime_state, mappings, a_local,
+                                              b_local, c_local, dst_local,
+                                              args...);
     case 8:
-      return ApplyTernaryOp<KERNEL, uint64_t>(a_local, b_local, c_local,
-                                              dst_local, args...);
+      return ApplyTernaryOp<KERNEL, uint64_t>(runtime_state, mappings, a_local,
+                                              b_local, c_local, dst_local,
+                                              args...);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << a_local->element_size;
@@ -275,19 +400,27 @@ Status ApplyTernaryOpIU(BufferView* a_local, BufferView* b_local,
 }
 
 template <typename KERNEL, typename... ARGS>
-Status ApplyTernaryOpF(BufferView* a_local, BufferView* b_local,
-                       BufferView* c_local, BufferView* dst_local,
-                       ARGS... args) {
+Status ApplyTernaryOpF(kernels::RuntimeState* runtime_state,
+                       BufferMappingCache* mappings, BufferView* a_local,
+                       BufferView* b_local, BufferView* c_local,
+                       BufferView* dst_local, ARGS... args) {
   switch (a_local->element_size) {
+#if defined(IREE_SUPPORT_F16)
+    case 2:
+      return ApplyTernaryOpF16<KERNEL>(runtime_state, mappings, a_local,
+                                       b_local, c_local, dst_local, args...);
+#endif  // IREE_SUPPORT_F16
 #if defined(IREE_SUPPORT_F32)
     case 4:
-      return ApplyTernaryOp<KERNEL, float>(a_local, b_local, c_local, dst_local,
+      return ApplyTernaryOp<KERNEL, float>(runtime_state, mappings, a_local,
+                                           b_local, c_local, dst_local,
                                            args...);
 #endif  // IREE_SUPPORT_F32
 #if defined(IREE_SUPPORT_F64)
     case 8:
-      return ApplyTernaryOp<KERNEL, double>(a_local, b_local, c_local,
-                                            dst_local, args...);
+      return ApplyTernaryOp<KERNEL, double>(runtime_state, mappings, a_local,
+                                            b_local, c_local, dst_local,
+                                            args...);
 #endif  // IREE_SUPPORT_F64
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
@@ -296,19 +429,24 @@ Status ApplyTernaryOpF(BufferView* a_local, BufferView* b_local,
 }
 
 template <typename KERNEL>
-Status ApplyComparisonOpIS(BufferView* lhs_local, BufferView* rhs_local,
-                           BufferView* dst_local) {
+Status ApplyComparisonOpIS(kernels::RuntimeState* runtime_state,
+                           BufferMappingCache* mappings, BufferView* lhs_local,
+                           BufferView* rhs_local, BufferView* dst_local) {
   switch (lhs_local->element_size) {
     case 1:
-      return ApplyComparisonOp<KERNEL, int8_t>(lhs_local, rhs_local, dst_local);
+      return ApplyComparisonOp<KERNEL, int8_t>(runtime_state, mappings,
+                                               lhs_local, rhs_local, dst_local);
     case 2:
-      return ApplyComparisonOp<KERNEL, int16_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, int16_t>(runtime_state, mappings,
+                                                lhs_local, rhs_local,
                                                 dst_local);
     case 4:
-      return ApplyComparisonOp<KERNEL, int32_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, int32_t>(runtime_state, mappings,
+                                                lhs_local, rhs_local,
                                                 dst_local);
     case 8:
-      return ApplyComparisonOp<KERNEL, int64_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, int64_t>(runtime_state, mappings,
+                                                lhs_local, rhs_local,
                                                 dst_local);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
@@ -317,20 +455,25 @@ Status ApplyComparisonOpIS(BufferView* lhs_local, BufferView* rhs_local,
 }
 
 template <typename KERNEL>
-Status ApplyComparisonOpIU(BufferView* lhs_local, BufferView* rhs_local,
-                           BufferView* dst_local) {
+Status ApplyComparisonOpIU(kernels::RuntimeState* runtime_state,
+                           BufferMappingCache* mappings, BufferView* lhs_local,
+                           BufferView* rhs_local, BufferView* dst_local) {
   switch (lhs_local->element_size) {
     case 1:
-      return ApplyComparisonOp<KERNEL, uint8_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, uint8_t>(runtime_state, mappings,
+                                                lhs_local, rhs_local,
                                                 dst_local);
     case 2:
-      return ApplyComparisonOp<KERNEL, uint16_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, uint16_t>(runtime_state, mappings,
+                                                 lhs_local, rhs_local,
                                                  dst_local);
     case 4:
-      return ApplyComparisonOp<KERNEL, uint32_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, uint32_t>(runtime_state, mappings,
+                                                 lhs_local, rhs_local,
                                                  dst_local);
     case 8:
-      return ApplyComparisonOp<KERNEL, uint64_t>(lhs_local, rhs_local,
+      return ApplyComparisonOp<KERNEL, uint64_t>(runtime_state, mappings,
+                                                 lhs_local, rhs_local,
                                                  dst_local);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
@@ -339,21 +482,41 @@ Status ApplyComparisonOpIU(BufferView* lhs_local, BufferView* rhs_local,
 }
 
 template <typename KERNEL>
-Status ApplyComparisonOpF(BufferView* lhs_local, BufferView* rhs_local,
-                          BufferView* dst_local) {
+Status ApplyComparisonOpF(kernels::RuntimeState* runtime_state,
+                          BufferMappingCache* mappings, BufferView* lhs_local,
+                          BufferView* rhs_local, BufferView* dst_local) {
   switch (lhs_local->element_size) {
+#if defined(IREE_SUPPORT_F16)
+    case 2:
+      return ApplyComparisonOpF16<KERNEL>(runtime_state, mappings, lhs_local,
+                                          rhs_local, dst_local);
+#endif  // IREE_SUPPORT_F16
     case 4:
-      return ApplyComparisonOp<KERNEL, float>(lhs_local, rhs_local, dst_local);
+      return ApplyComparisonOp<KERNEL, float>(runtime_state, mappings,
+                                              lhs_local, rhs_local, dst_local);
     case 8:
-      return ApplyComparisonOp<KERNEL, double>(lhs_local, rhs_local, dst_local);
+      return ApplyComparisonOp<KERNEL, double>(runtime_state, mappings,
+                                               lhs_local, rhs_local, dst_local);
     default:
       return UnimplementedErrorBuilder(IREE_LOC)
              << "Unimplemented element size: " << lhs_local->element_size;
   }
 }
 
+// Returns the owner used to cache packed forms of |buffer_view| across calls if
+// it is immutable bytecode constant data mapped at |data|, or nullptr.
+inline const void* GetConstantCacheOwner(const vm::BytecodeReader& reader,
+                                         const BufferView* buffer_view,
+                                         const void* data) {
+  if (AnyBitSet(buffer_view->buffer->allowed_access() & MemoryAccess::kWrite)) {
+    return nullptr;
+  }
+  return reader.LookupBytecodeOwner(data);
+}
+
 template <typename T, typename ACC = int32_t>
-Status ApplyMatMulOpI(kernels::MatMul::RuntimeState* runtime_state,
+Status ApplyMatMulOpI(const vm::BytecodeReader& reader,
+                      kernels::MatMul::RuntimeState* runtime_state,
                       BufferView* lhs_local, BufferView* rhs_local,
                       BufferView* bias_local,
                       BufferView* multiplier_mantissa_local,
@@ -368,6 +531,8 @@ Status ApplyMatMulOpI(kernels::MatMul::RuntimeState* runtime_state,
                    rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
   buffers.rhs_buffer = rhs_buffer.contents();
   buffers.rhs_shape = rhs_local->shape;
+  buffers.rhs_cache_owner =
+      GetConstantCacheOwner(reader, rhs_local, rhs_buffer.data());
   MappedMemory<ACC> bias_buffer;
   if (bias_local && bias_local->buffer && !bias_local->shape.empty()) {
     if (bias_local->element_size != sizeof(ACC)) {
@@ -394,7 +559,8 @@ Status ApplyMatMulOpI(kernels::MatMul::RuntimeState* runtime_state,
 }
 
 template <typename T>
-Status ApplyMatMulOpF(kernels::MatMul::RuntimeState* runtime_state,
+Status ApplyMatMulOpF(const vm::BytecodeReader& reader,
+                      kernels::MatMul::RuntimeState* runtime_state,
                       BufferView* lhs_local, BufferView* rhs_local,
                       BufferView* bias_local, BufferView* dst_local) {
   kernels::MatMul::Buffers<T, T> buffers;
@@ -406,6 +572,8 @@ Status ApplyMatMulOpF(kernels::MatMul::RuntimeState* runtime_state,
                    rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
   buffers.rhs_buffer = rhs_buffer.contents();
   buffers.rhs_shape = rhs_local->shape;
+  buffers.rhs_cache_owner =
+      GetConstantCacheOwner(reader, rhs_local, rhs_buffer.data());
   MappedMemory<T> bias_buffer;
   if (bias_local && bias_local->buffer && !bias_local->shape.empty()) {
     ASSIGN_OR_RETURN(bias_buffer,
@@ -419,92 +587,296 @@ Status ApplyMatMulOpF(kernels::MatMul::RuntimeState* runtime_state,
   return kernels::MatMul::Execute(runtime_state, buffers);
 }
 
+// The widened f16 RHS is a temporary so it is never cached in packed form.
+inline Status ApplyMatMulOpF16(BufferMappingCache* mappings,
+                               kernels::MatMul::RuntimeState* runtime_state,
+                               BufferView* lhs_local, BufferView* rhs_local,
+                               BufferView* bias_local, BufferView* dst_local) {
+  kernels::MatMul::Buffers<float, float> buffers;
+  ASSIGN_OR_RETURN(auto lhs_values, WidenFloat16(mappings, lhs_local));
+  buffers.lhs_buffer = lhs_values;
+  buffers.lhs_shape = lhs_local->shape;
+  ASSIGN_OR_RETURN(auto rhs_values, WidenFloat16(mappings, rhs_local));
+  buffers.rhs_buffer = rhs_values;
+  buffers.rhs_shape = rhs_local->shape;
+  std::vector<float> bias_values;
+  if (bias_local && bias_local->buffer && !bias_local->shape.empty()) {
+    ASSIGN_OR_RETURN(bias_values, WidenFloat16(mappings, bias_local));
+    buffers.bias_buffer = bias_values;
+  }
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  buffers.dst_buffer = absl::MakeSpan(dst_values);
+  buffers.dst_shape = dst_local->shape;
+  RETURN_IF_ERROR(kernels::MatMul::Execute(runtime_state, buffers));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
+template <typename T>
+Status ApplyConv2DOpF(const vm::BytecodeReader& reader,
+                      kernels::RuntimeState* runtime_state,
+                      BufferView* input_local, BufferView* filter_local,
+                      BufferView* dst_local, kernels::Conv2D::Params params) {
+  ASSIGN_OR_RETURN(auto input_buffer,
+                   input_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto filter_buffer,
+                   filter_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
+                                        MemoryAccess::kDiscardWrite));
+  params.filter_cache_owner =
+      GetConstantCacheOwner(reader, filter_local, filter_buffer.data());
+  return kernels::Conv2D::Execute<T>(
+      runtime_state, input_buffer.contents(), input_local->shape,
+      filter_buffer.contents(), filter_local->shape,
+      dst_buffer.mutable_contents(), dst_local->shape, params);
+}
+
+inline Status ApplyConv2DOpF16(BufferMappingCache* mappings,
+                               kernels::RuntimeState* runtime_state,
+                               BufferView* input_local,
+                               BufferView* filter_local, BufferView* dst_local,
+                               kernels::Conv2D::Params params) {
+  ASSIGN_OR_RETURN(auto input_values, WidenFloat16(mappings, input_local));
+  ASSIGN_OR_RETURN(auto filter_values, WidenFloat16(mappings, filter_local));
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  RETURN_IF_ERROR(kernels::Conv2D::Execute<float>(
+      runtime_state, absl::MakeConstSpan(input_values), input_local->shape,
+      absl::MakeConstSpan(filter_values), filter_local->shape,
+      absl::MakeSpan(dst_values), dst_local->shape, params));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
+template <typename T>
+Status ApplyMatMulOpQ(const vm::BytecodeReader& reader,
+                      kernels::MatMul::RuntimeState* runtime_state,
+                      BufferView* lhs_local, BufferView* rhs_local,
+                      BufferView* bias_local,
+                      BufferView* multiplier_mantissa_local,
+                      BufferView* multiplier_exponent_local,
+                      BufferView* dst_local,
+                      const kernels::QuantizationParams& quantization) {
+  kernels::QuantizedMatMul::Buffers<T> buffers;
+  ASSIGN_OR_RETURN(auto lhs_buffer,
+                   lhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  buffers.lhs_buffer = lhs_buffer.contents();
+  buffers.lhs_shape = lhs_local->shape;
+  ASSIGN_OR_RETURN(auto rhs_buffer,
+                   rhs_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  buffers.rhs_buffer = rhs_buffer.contents();
+  buffers.rhs_shape = rhs_local->shape;
+  buffers.rhs_cache_owner =
+      GetConstantCacheOwner(reader, rhs_local, rhs_buffer.data());
+  MappedMemory<int32_t> bias_buffer;
+  if (bias_local->shape.element_count() > 0) {
+    ASSIGN_OR_RETURN(bias_buffer, bias_local->buffer->MapMemory<int32_t>(
+                                      MemoryAccess::kRead));
+    buffers.bias_buffer = bias_buffer.contents();
+  }
+  ASSIGN_OR_RETURN(auto multiplier_mantissa_buffer,
+                   multiplier_mantissa_local->buffer->MapMemory<int32_t>(
+                       MemoryAccess::kRead));
+  buffers.multiplier_mantissa_buffer = multiplier_mantissa_buffer.contents();
+  ASSIGN_OR_RETURN(auto multiplier_exponent_buffer,
+                   multiplier_exponent_local->buffer->MapMemory<int32_t>(
+                       MemoryAccess::kRead));
+  buffers.multiplier_exponent_buffer = multiplier_exponent_buffer.contents();
+  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
+                                        MemoryAccess::kDiscardWrite));
+  buffers.dst_buffer = dst_buffer.mutable_contents();
+  buffers.dst_shape = dst_local->shape;
+  buffers.quantization = quantization;
+  return kernels::QuantizedMatMul::Execute(runtime_state, buffers);
+}
+
+template <typename T>
+Status ApplyConv2DOpQ(const vm::BytecodeReader& reader,
+                      kernels::RuntimeState* runtime_state,
+                      BufferView* input_local, BufferView* filter_local,
+                      BufferView* bias_local,
+                      BufferView* multiplier_mantissa_local,
+                      BufferView* multiplier_exponent_local,
+                      BufferView* dst_local, kernels::Conv2D::Params params,
+                      const kernels::QuantizationParams& quantization) {
+  kernels::QuantizedConv2D::Buffers<T> buffers;
+  ASSIGN_OR_RETURN(auto input_buffer,
+                   input_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  buffers.input_buffer = input_buffer.contents();
+  buffers.input_shape = input_local->shape;
+  ASSIGN_OR_RETURN(auto filter_buffer,
+                   filter_local->buffer->MapMemory<T>(MemoryAccess::kRead));
+  buffers.filter_buffer = filter_buffer.contents();
+  buffers.filter_shape = filter_local->shape;
+  params.filter_cache_owner =
+      GetConstantCacheOwner(reader, filter_local, filter_buffer.data());
+  MappedMemory<int32_t> bias_buffer;
+  if (bias_local->shape.element_count() > 0) {
+    ASSIGN_OR_RETURN(bias_buffer, bias_local->buffer->MapMemory<int32_t>(
+                                      MemoryAccess::kRead));
+    buffers.bias_buffer = bias_buffer.contents();
+  }
+  ASSIGN_OR_RETURN(auto multiplier_mantissa_buffer,
+                   multiplier_mantissa_local->buffer->MapMemory<int32_t>(
+                       MemoryAccess::kRead));
+  buffers.multiplier_mantissa_buffer = multiplier_mantissa_buffer.contents();
+  ASSIGN_OR_RETURN(auto multiplier_exponent_buffer,
+                   multiplier_exponent_local->buffer->MapMemory<int32_t>(
+                       MemoryAccess::kRead));
+  buffers.multiplier_exponent_buffer = multiplier_exponent_buffer.contents();
+  ASSIGN_OR_RETURN(auto dst_buffer, dst_local->buffer->MapMemory<T>(
+                                        MemoryAccess::kDiscardWrite));
+  buffers.dst_buffer = dst_buffer.mutable_contents();
+  buffers.dst_shape = dst_local->shape;
+  buffers.quantization = quantization;
+  return kernels::QuantizedConv2D::Execute(runtime_state, buffers, params);
+}
+
+template <typename T>
+Status ApplyFusedElementwiseOp(kernels::RuntimeState* runtime_state,
+                               BufferMappingCache* mappings,
+                               absl::Span<BufferView* const> input_locals,
+                               absl::Span<const int32_t> program,
+                               BufferView* dst_local) {
+  absl::InlinedVector<absl::Span<const T>, 8> input_buffers;
+  for (auto* input_local : input_locals) {
+    ASSIGN_OR_RETURN(auto input_buffer, mappings->MapRead<T>(input_local));
+    input_buffers.push_back(input_buffer);
+  }
+  ASSIGN_OR_RETURN(auto dst_buffer, mappings->MapWrite<T>(dst_local));
+  return kernels::ExecuteFusedElementwiseMorsels<T>(
+      runtime_state, input_buffers, program, dst_buffer);
+}
+
+inline Status ApplyFusedElementwiseOpF16(
+    kernels::RuntimeState* runtime_state, BufferMappingCache* mappings,
+    absl::Span<BufferView* const> input_locals,
+    absl::Span<const int32_t> program, BufferView* dst_local) {
+  std::vector<std::vector<float>> input_values;
+  absl::InlinedVector<absl::Span<const float>, 8> input_buffers;
+  input_values.reserve(input_locals.size());
+  for (auto* input_local : input_locals) {
+    ASSIGN_OR_RETURN(auto values, WidenFloat16(mappings, input_local));
+    input_values.push_back(std::move(values));
+    input_buffers.push_back(input_values.back());
+  }
+  std::vector<float> dst_values(dst_local->buffer->byte_length() /
+                                sizeof(Float16));
+  RETURN_IF_ERROR(kernels::ExecuteFusedElementwiseMorsels<float>(
+      runtime_state, input_buffers, program, absl::MakeSpan(dst_values)));
+  return NarrowFloat16(mappings, dst_values, dst_local);
+}
+
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpIS(vm::BytecodeReader* reader) {
+Status DispatchElementwiseUnaryOpIS(vm::BytecodeReader* reader,
+                                    kernels::RuntimeState* runtime_state,
+                                    BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpIS<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpIS<KERNEL>(runtime_state, mappings, src_local, dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpIU(vm::BytecodeReader* reader) {
+Status DispatchElementwiseUnaryOpIU(vm::BytecodeReader* reader,
+                                    kernels::RuntimeState* runtime_state,
+                                    BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpIU<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpIU<KERNEL>(runtime_state, mappings, src_local, dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseUnaryOpF(vm::BytecodeReader* reader) {
+Status DispatchElementwiseUnaryOpF(vm::BytecodeReader* reader,
+                                   kernels::RuntimeState* runtime_state,
+                                   BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* src_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseUnaryOp(src_local, dst_local));
-  return ApplyUnaryOpF<KERNEL>(src_local, dst_local);
+  return ApplyUnaryOpF<KERNEL>(runtime_state, mappings, src_local, dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpIS(vm::BytecodeReader* reader) {
+Status DispatchElementwiseBinaryOpIS(vm::BytecodeReader* reader,
+                                     kernels::RuntimeState* runtime_state,
+                                     BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpIS<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpIS<KERNEL>(runtime_state, mappings, lhs_local, rhs_local,
+                                 dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpIU(vm::BytecodeReader* reader) {
+Status DispatchElementwiseBinaryOpIU(vm::BytecodeReader* reader,
+                                     kernels::RuntimeState* runtime_state,
+                                     BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpIU<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpIU<KERNEL>(runtime_state, mappings, lhs_local, rhs_local,
+                                 dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseBinaryOpF(vm::BytecodeReader* reader) {
+Status DispatchElementwiseBinaryOpF(vm::BytecodeReader* reader,
+                                    kernels::RuntimeState* runtime_state,
+                                    BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* lhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* rhs_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(ValidateElementwiseBinaryOp(lhs_local, rhs_local, dst_local));
-  return ApplyBinaryOpF<KERNEL>(lhs_local, rhs_local, dst_local);
+  return ApplyBinaryOpF<KERNEL>(runtime_state, mappings, lhs_local, rhs_local,
+                                dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpIS(vm::BytecodeReader* reader) {
+Status DispatchElementwiseTernaryOpIS(vm::BytecodeReader* reader,
+                                      kernels::RuntimeState* runtime_state,
+                                      BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpIS<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpIS<KERNEL>(runtime_state, mappings, a_local, b_local,
+                                  c_local, dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpIU(vm::BytecodeReader* reader) {
+Status DispatchElementwiseTernaryOpIU(vm::BytecodeReader* reader,
+                                      kernels::RuntimeState* runtime_state,
+                                      BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpIU<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpIU<KERNEL>(runtime_state, mappings, a_local, b_local,
+                                  c_local, dst_local);
 }
 
 template <typename KERNEL>
-Status DispatchElementwiseTernaryOpF(vm::BytecodeReader* reader) {
+Status DispatchElementwiseTernaryOpF(vm::BytecodeReader* reader,
+                                     kernels::RuntimeState* runtime_state,
+                                     BufferMappingCache* mappings) {
   ASSIGN_OR_RETURN(auto* a_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* b_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* c_local, reader->ReadLocal());
   ASSIGN_OR_RETURN(auto* dst_local, reader->ReadLocal());
   RETURN_IF_ERROR(
       ValidateElementwiseTernaryOp(a_local, b_local, c_local, dst_local));
-  return ApplyTernaryOpF<KERNEL>(a_local, b_local, c_local, dst_local);
+  return ApplyTernaryOpF<KERNEL>(runtime_state, mappings, a_local, b_local,
+                                 c_local, dst_local);
 }
 
-Status ApplyCopy(BufferView* src_local, absl::Span<const int32_t> src_indices,
-                 BufferView* dst_local, absl::Span<const int32_t> dst_indices,
+Status ApplyCopy(kernels::RuntimeState* runtime_state, BufferView* src_local,
+                 absl::Span<const int32_t> src_indices, BufferView* dst_local,
+                 absl::Span<const int32_t> dst_indices,
                  absl::Span<const int32_t> lengths);
 
 }  // namespace hal
@@ -25,7 +25,8 @@ namespace hal {
 // static
 StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
     ref_ptr<rt::Instance> instance, hal::Allocator* allocator,
-    ExecutableSpec spec, bool allow_aliasing_data) {
+    kernels::RuntimeState* kernel_runtime_state, ExecutableSpec spec,
+    bool allow_aliasing_data) {
   // Allocate the executable now.
   // We do this here so that if we need to clone the data we are passing that
   // to the VM loader instead of the data we may not have access to later.
@@ -36,7 +37,8 @@ StatusOr<ref_ptr<BytecodeExecutable>> BytecodeExecutable::Load(
   auto module_def =
       ::flatbuffers::GetRoot<ModuleDef>(executable->executable_data().data());
   ASSIGN_OR_RETURN(auto module,
-                   InterpreterModule::FromDef(allocator, *module_def));
+                   InterpreterModule::FromDef(allocator, kernel_runtime_state,
+                                              *module_def));
   executable->module_ = add_ref(module);
   RETURN_IF_ERROR(executable->context()->RegisterModule(std::move(module)));
 
@@ -20,8 +20,10 @@
 #include "absl/types/span.h"
 #include "iree/base/status.h"
 #include "iree/hal/allocator.h"
+#include "iree/hal/dispatch_profile.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/executable_spec.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
 #include "iree/rt/context.h"
 #include "iree/rt/instance.h"
 #include "iree/rt/module.h"
@@ -33,7 +35,8 @@ class BytecodeExecutable final : public Executable {
  public:
   static StatusOr<ref_ptr<BytecodeExecutable>> Load(
       ref_ptr<rt::Instance> instance, hal::Allocator* allocator,
-      ExecutableSpec spec, bool allow_aliasing_data);
+      kernels::RuntimeState* kernel_runtime_state, ExecutableSpec spec,
+      bool allow_aliasing_data);
 
   BytecodeExecutable(ref_ptr<rt::Instance> instance, hal::Allocator* allocator,
                      ExecutableSpec spec, bool allow_aliasing_data);
@@ -54,12 +57,21 @@ class BytecodeExecutable final : public Executable {
   // module can be used to lookup executable exports.
   const ref_ptr<rt::Module>& module() const { return module_; }
 
+  // Profile that dispatches of the executable are recorded in or nullptr if
+  // the executable was not prepared with profiling enabled.
+  DispatchProfile* dispatch_profile() const { return dispatch_profile_; }
+  void set_dispatch_profile(DispatchProfile* dispatch_profile) {
+    dispatch_profile_ = dispatch_profile;
+  }
+
  private:
   ExecutableSpec spec_;
   std::vector<uint8_t> cloned_executable_data_;
 
   ref_ptr<rt::Context> context_;
   ref_ptr<rt::Module> module_;
+
+  DispatchProfile* dispatch_profile_ = nullptr;
 };
 
 }  // namespace hal
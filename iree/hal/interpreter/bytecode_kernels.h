@@ -35,11 +35,21 @@
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_H_
 
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/shape.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/host/host_thread_pool.h"
+#include "iree/hal/host/morsel_scheduler.h"
+#include "iree/hal/interpreter/stack_arena_pool.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
 
 namespace iree {
 namespace hal {
@@ -311,6 +321,22 @@ struct Ceil {
                         absl::Span<T> dst_buffer);
 };
 
+// Evaluates a fused chain of elementwise float ops described by a program of
+// FusedElementwiseOp instructions (see interpreter_bytecode_v0.h). All inputs
+// and the output have the same element count.
+//
+// The program is run over blocks of kBlockSize elements so that intermediate
+// values stay in L1 and each instruction is a simple loop over the block that
+// the compiler can vectorize. The output may alias an input.
+struct FusedElementwise {
+  static constexpr int kBlockSize = 256;
+
+  template <typename T>
+  static Status Execute(absl::Span<const absl::Span<const T>> input_buffers,
+                        absl::Span<const int32_t> program,
+                        absl::Span<T> dst_buffer);
+};
+
 struct Convert {
   template <typename SRC, typename DST>
   static Status Execute(absl::Span<const SRC> src_buffer,
@@ -320,7 +346,18 @@ struct Convert {
 struct MatMul {
   struct RuntimeState;
 
-  static std::unique_ptr<RuntimeState> CreateRuntimeState();
+  // Creates the MatMul state shared by all fibers. Large multiplies are split
+  // into row blocks run on |thread_pool|, which must outlive the state.
+  static std::unique_ptr<RuntimeState> CreateRuntimeState(
+      HostThreadPool* thread_pool);
+
+  // Drops all packed RHS matrices cached on behalf of |owner|.
+  static void ReleaseCachedRhs(RuntimeState* runtime_state, const void* owner);
+
+  // Multiplies with fewer multiply-adds than this run on the calling thread.
+  static constexpr int64_t kMinParallelMultiplyAdds = 1 << 18;
+  // Minimum number of LHS rows given to each thread.
+  static constexpr int kMinRowsPerBlock = 16;
 
   template <typename T, typename ACC>
   struct Buffers {
@@ -339,6 +376,11 @@ struct MatMul {
     // for per-channel.
     absl::Span<const ACC> multiplier_mantissa_buffer;
     absl::Span<const int32_t> multiplier_exponent_buffer;
+
+    // Optional owner of an immutable rhs_buffer (such as the module containing
+    // a constant). When set the packed RHS is cached across calls until
+    // ReleaseCachedRhs is called for the owner.
+    const void* rhs_cache_owner = nullptr;
   };
 
   template <typename T, typename ACC>
@@ -363,9 +405,277 @@ struct MatMul {
   }
 };
 
+// Options for the kernel runtime state shared by all executables on a device.
+using RuntimeOptions = HostThreadPool::Options;
+
 struct RuntimeState {
-  std::unique_ptr<MatMul::RuntimeState> mat_mul_state =
-      MatMul::CreateRuntimeState();
+  RuntimeState() : RuntimeState(RuntimeOptions{}) {}
+  explicit RuntimeState(RuntimeOptions options)
+      : thread_pool(std::move(options)),
+        morsel_scheduler(&thread_pool),
+        mat_mul_state(MatMul::CreateRuntimeState(&thread_pool)) {}
+
+  // Worker threads used by all parallel kernels.
+  HostThreadPool thread_pool;
+
+  // Splits large elementwise and copy kernels across |thread_pool|.
+  MorselScheduler morsel_scheduler;
+
+  std::unique_ptr<MatMul::RuntimeState> mat_mul_state;
+
+  // Arenas backing alloc_stack allocations, reused across invocations.
+  StackArenaPool stack_arena_pool;
+};
+
+// True for kernels whose output at each index depends only on the inputs at the
+// same index. Such kernels can be run over any contiguous subrange of their
+// buffers and are split into morsels by ExecuteMorsels.
+template <typename KERNEL>
+struct IsElementwise : std::false_type {};
+
+#define IREE_KERNEL_IS_ELEMENTWISE(KERNEL) \
+  template <>                              \
+  struct IsElementwise<KERNEL> : std::true_type {}
+IREE_KERNEL_IS_ELEMENTWISE(CompareEQ);
+IREE_KERNEL_IS_ELEMENTWISE(CompareNE);
+IREE_KERNEL_IS_ELEMENTWISE(CompareLT);
+IREE_KERNEL_IS_ELEMENTWISE(CompareLE);
+IREE_KERNEL_IS_ELEMENTWISE(CompareGT);
+IREE_KERNEL_IS_ELEMENTWISE(CompareGE);
+IREE_KERNEL_IS_ELEMENTWISE(Select);
+IREE_KERNEL_IS_ELEMENTWISE(Not);
+IREE_KERNEL_IS_ELEMENTWISE(And);
+IREE_KERNEL_IS_ELEMENTWISE(Or);
+IREE_KERNEL_IS_ELEMENTWISE(Xor);
+IREE_KERNEL_IS_ELEMENTWISE(ShiftLeft);
+IREE_KERNEL_IS_ELEMENTWISE(ShiftRight);
+IREE_KERNEL_IS_ELEMENTWISE(Add);
+IREE_KERNEL_IS_ELEMENTWISE(Sub);
+IREE_KERNEL_IS_ELEMENTWISE(Abs);
+IREE_KERNEL_IS_ELEMENTWISE(Mul);
+IREE_KERNEL_IS_ELEMENTWISE(Div);
+IREE_KERNEL_IS_ELEMENTWISE(Rem);
+IREE_KERNEL_IS_ELEMENTWISE(MulAdd);
+IREE_KERNEL_IS_ELEMENTWISE(Exp);
+IREE_KERNEL_IS_ELEMENTWISE(Log);
+IREE_KERNEL_IS_ELEMENTWISE(Rsqrt);
+IREE_KERNEL_IS_ELEMENTWISE(Sqrt);
+IREE_KERNEL_IS_ELEMENTWISE(Cos);
+IREE_KERNEL_IS_ELEMENTWISE(Sin);
+IREE_KERNEL_IS_ELEMENTWISE(Tanh);
+IREE_KERNEL_IS_ELEMENTWISE(Atan2);
+IREE_KERNEL_IS_ELEMENTWISE(Min);
+IREE_KERNEL_IS_ELEMENTWISE(Max);
+IREE_KERNEL_IS_ELEMENTWISE(Clamp);
+IREE_KERNEL_IS_ELEMENTWISE(Floor);
+IREE_KERNEL_IS_ELEMENTWISE(Ceil);
+IREE_KERNEL_IS_ELEMENTWISE(Convert);
+#undef IREE_KERNEL_IS_ELEMENTWISE
+
+namespace impl {
+
+template <typename KERNEL, typename... ARGS>
+Status ExecuteMorsels(std::false_type, RuntimeState* runtime_state,
+                      ARGS... args) {
+  return KERNEL::Execute(args...);
+}
+
+template <typename KERNEL, typename... BUFFERS>
+Status ExecuteMorsels(std::true_type, RuntimeState* runtime_state,
+                      BUFFERS... buffers) {
+  // The destination is always the last buffer. Operands of any other size are
+  // broadcast by the kernel and cannot be split.
+  const size_t sizes[] = {buffers.size()...};
+  const size_t element_count = sizes[sizeof...(BUFFERS) - 1];
+  for (size_t size : sizes) {
+    if (size != element_count) return KERNEL::Execute(buffers...);
+  }
+  const size_t element_sizes[] = {sizeof(*buffers.data())...};
+  size_t bytes_per_element = 0;
+  for (size_t element_size : element_sizes) bytes_per_element += element_size;
+  return runtime_state->morsel_scheduler.ParallelFor(
+      MorselScheduler::KeyFor<std::tuple<KERNEL, BUFFERS...>>(), element_count,
+      bytes_per_element, [&](size_t begin, size_t end) {
+        return KERNEL::Execute(buffers.subspan(begin, end - begin)...);
+      });
+}
+
+}  // namespace impl
+
+// Executes |KERNEL| with |args|. Elementwise kernels over large buffers are
+// split into morsels that run in parallel on the runtime thread pool; all
+// other kernels run directly on the calling thread.
+template <typename KERNEL, typename... ARGS>
+Status ExecuteMorsels(RuntimeState* runtime_state, ARGS... args) {
+  return impl::ExecuteMorsels<KERNEL>(IsElementwise<KERNEL>{}, runtime_state,
+                                      args...);
+}
+
+// Executes FusedElementwise, splitting large buffers into morsels as with
+// ExecuteMorsels. All inputs and the output have the same element count.
+template <typename T>
+Status ExecuteFusedElementwiseMorsels(
+    RuntimeState* runtime_state,
+    absl::Span<const absl::Span<const T>> input_buffers,
+    absl::Span<const int32_t> program, absl::Span<T> dst_buffer) {
+  return runtime_state->morsel_scheduler.ParallelFor(
+      MorselScheduler::KeyFor<FusedElementwise>(), dst_buffer.size(),
+      (input_buffers.size() + 1) * sizeof(T), [&](size_t begin, size_t end) {
+        absl::InlinedVector<absl::Span<const T>, 8> input_morsels;
+        for (const auto& input_buffer : input_buffers) {
+          input_morsels.push_back(input_buffer.subspan(begin, end - begin));
+        }
+        return FusedElementwise::Execute<T>(
+            input_morsels, program, dst_buffer.subspan(begin, end - begin));
+      });
+}
+
+// Executes Copy, splitting large copies into morsels of rows along the
+// outermost dimension of |lengths|.
+template <int element_size>
+Status ExecuteCopyMorsels(RuntimeState* runtime_state,
+                          absl::Span<const uint8_t> src_buffer,
+                          const Shape& src_shape,
+                          absl::Span<const int32_t> src_indices,
+                          absl::Span<uint8_t> dst_buffer,
+                          const Shape& dst_shape,
+                          absl::Span<const int32_t> dst_indices,
+                          absl::Span<const int32_t> lengths) {
+  if (lengths.empty()) {
+    return Copy::Execute<element_size>(src_buffer, src_shape, src_indices,
+                                       dst_buffer, dst_shape, dst_indices,
+                                       lengths);
+  }
+  size_t row_bytes = 2 * element_size;
+  for (size_t i = 1; i < lengths.size(); ++i) row_bytes *= lengths[i];
+  return runtime_state->morsel_scheduler.ParallelFor(
+      MorselScheduler::KeyFor<
+          std::tuple<Copy, std::integral_constant<int, element_size>>>(),
+      lengths[0], row_bytes, [&](size_t begin, size_t end) {
+        absl::InlinedVector<int32_t, 6> src_morsel_indices(src_indices.begin(),
+                                                           src_indices.end());
+        absl::InlinedVector<int32_t, 6> dst_morsel_indices(dst_indices.begin(),
+                                                           dst_indices.end());
+        absl::InlinedVector<int32_t, 6> morsel_lengths(lengths.begin(),
+                                                       lengths.end());
+        src_morsel_indices[0] += begin;
+        dst_morsel_indices[0] += begin;
+        morsel_lengths[0] = end - begin;
+        return Copy::Execute<element_size>(
+            src_buffer, src_shape, src_morsel_indices, dst_buffer, dst_shape,
+            dst_morsel_indices, morsel_lengths);
+      });
+}
+
+// 2D convolution with NHWC input, HWIO filter and NHWC output layouts.
+// The filter input channel dimension is the per-group channel count
+// (input channels / feature_group_count).
+//
+// Small filters (and grouped convolutions) run as a direct convolution while
+// larger ones are lowered to im2col + MatMul. Both paths process the output in
+// independent tiles of output rows that run in parallel on the thread pool.
+struct Conv2D {
+  struct Params {
+    int32_t stride_h = 1;
+    int32_t stride_w = 1;
+    int32_t dilation_h = 1;
+    int32_t dilation_w = 1;
+    int32_t pad_top = 0;
+    int32_t pad_bottom = 0;
+    int32_t pad_left = 0;
+    int32_t pad_right = 0;
+    int32_t feature_group_count = 1;
+
+    // Optional owner of an immutable filter buffer used to cache its packed
+    // form. See MatMul::Buffers::rhs_cache_owner.
+    const void* filter_cache_owner = nullptr;
+  };
+
+  // Filters with a reduction depth (kh * kw * ic) below this use the direct
+  // path as the im2col packing and transposes dominate the GEMM.
+  static constexpr int kIm2ColMinDepth = 16;
+
+  // Number of output rows (spatial pixels) processed per tile. Bounds the size
+  // of the im2col scratch buffer.
+  static constexpr int kTileRows = 256;
+
+  template <typename T>
+  static Status Execute(RuntimeState* runtime_state,
+                        absl::Span<const T> input_buffer,
+                        const Shape& input_shape,
+                        absl::Span<const T> filter_buffer,
+                        const Shape& filter_shape, absl::Span<T> dst_buffer,
+                        const Shape& dst_shape, const Params& params);
+};
+
+// Asymmetric quantization of an integer MatMul or Conv2D. Real values are
+// (quantized - zero_point) * scale. Products are accumulated in int32, the
+// optional int32 bias is added and the result is rescaled to the destination
+// by a fixed-point multiplier (a Q0.31 mantissa and a power-of-two exponent, as
+// in TFLite) before dst_zero_point is added and the value is clamped.
+struct QuantizationParams {
+  int32_t lhs_zero_point = 0;
+  int32_t rhs_zero_point = 0;
+  int32_t dst_zero_point = 0;
+  // Clamp range in the quantized destination domain. Always narrowed to the
+  // range of the destination type.
+  int32_t clamp_min = std::numeric_limits<int32_t>::min();
+  int32_t clamp_max = std::numeric_limits<int32_t>::max();
+};
+
+// Quantized matrix multiply with fused bias, requantization and clamping.
+// Unlike MatMul the bias and per-channel multipliers have one element per
+// column of the destination (the output channel).
+struct QuantizedMatMul {
+  template <typename T>
+  struct Buffers {
+    Shape lhs_shape;
+    absl::Span<const T> lhs_buffer;
+    Shape rhs_shape;
+    absl::Span<const T> rhs_buffer;
+    Shape dst_shape;
+    absl::Span<T> dst_buffer;
+
+    // Optional bias buffer.
+    absl::Span<const int32_t> bias_buffer;
+
+    // Fixed-point multiplier mantissa/exponent. Either a single value or one
+    // per destination column.
+    absl::Span<const int32_t> multiplier_mantissa_buffer;
+    absl::Span<const int32_t> multiplier_exponent_buffer;
+
+    QuantizationParams quantization;
+
+    // See MatMul::Buffers::rhs_cache_owner.
+    const void* rhs_cache_owner = nullptr;
+  };
+
+  template <typename T>
+  static Status Execute(MatMul::RuntimeState* runtime_state,
+                        const Buffers<T>& buffers);
+};
+
+// Quantized Conv2D with the same layouts and paths as Conv2D. The lhs and rhs
+// quantization parameters apply to the input and filter respectively and the
+// bias and per-channel multipliers have one element per output channel.
+struct QuantizedConv2D {
+  template <typename T>
+  struct Buffers {
+    Shape input_shape;
+    absl::Span<const T> input_buffer;
+    Shape filter_shape;
+    absl::Span<const T> filter_buffer;
+    Shape dst_shape;
+    absl::Span<T> dst_buffer;
+    absl::Span<const int32_t> bias_buffer;
+    absl::Span<const int32_t> multiplier_mantissa_buffer;
+    absl::Span<const int32_t> multiplier_exponent_buffer;
+    QuantizationParams quantization;
+  };
+
+  template <typename T>
+  static Status Execute(RuntimeState* runtime_state, const Buffers<T>& buffers,
+                        const Conv2D::Params& params);
 };
 
 struct ReduceSum {
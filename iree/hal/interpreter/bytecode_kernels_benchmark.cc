@@ -0,0 +1,678 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the interpreter kernels, run single-threaded on the
+// calling thread.
+//
+// Each benchmark reports bytes/s (bytes read and written by the kernel) and,
+// for kernels doing arithmetic, the op rate in the "flops" counter. Integer and
+// transcendental ops count as one op per element. To make numbers comparable
+// across hosts they are also reported relative to baselines measured on the
+// host at startup:
+//  * "memcpy_fraction": bytes/s relative to memcpy moving the same number of
+//    bytes, so 1.0 means the kernel runs at the memory/cache bandwidth of its
+//    working set.
+//  * "peak_fraction": flops relative to a vectorizable multiply-add loop with
+//    all values in registers. This is the peak the compiler reaches for plain
+//    loops and not the theoretical peak of the ISA.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "iree/base/half_float.h"
+#include "iree/base/logging.h"
+#include "iree/base/shape.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
+#include "iree/schemas/bytecode/interpreter_bytecode_v0.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Minimum time spent measuring each baseline.
+constexpr absl::Duration kBaselineMeasureTime = absl::Milliseconds(50);
+
+// Measures the bandwidth of memcpy, counting bytes read and written, with a
+// working set of |total_bytes|.
+double MeasureMemcpyBytesPerSecond(int64_t total_bytes) {
+  int64_t copy_size = std::max<int64_t>(total_bytes / 2, 1);
+  std::vector<uint8_t> src(copy_size, 1);
+  std::vector<uint8_t> dst(copy_size);
+  std::memcpy(dst.data(), src.data(), copy_size);
+  int64_t copy_count = 0;
+  absl::Time start = absl::Now();
+  absl::Duration elapsed;
+  do {
+    for (int i = 0; i < 16; ++i) {
+      std::memcpy(dst.data(), src.data(), copy_size);
+      benchmark::ClobberMemory();
+    }
+    copy_count += 16;
+    elapsed = absl::Now() - start;
+  } while (elapsed < kBaselineMeasureTime);
+  return 2.0 * copy_size * copy_count / absl::ToDoubleSeconds(elapsed);
+}
+
+// Returns the memcpy bandwidth for |total_bytes|, measured once per size.
+double MemcpyBytesPerSecond(int64_t total_bytes) {
+  static absl::Mutex mutex(absl::kConstInit);
+  static auto* baselines = new std::map<int64_t, double>();
+  absl::MutexLock lock(&mutex);
+  auto it = baselines->find(total_bytes);
+  if (it == baselines->end()) {
+    it = baselines
+             ->emplace(total_bytes, MeasureMemcpyBytesPerSecond(total_bytes))
+             .first;
+  }
+  return it->second;
+}
+
+// Measures multiply-adds (counted as two ops) over independent lanes that the
+// compiler keeps in vector registers.
+double MeasurePeakFlopsPerSecond() {
+  constexpr int kLaneCount = 64;
+  constexpr int kStepsPerRound = 64;
+  float lanes[kLaneCount];
+  for (int i = 0; i < kLaneCount; ++i) lanes[i] = i * 0.01f;
+  const float scale = 0.999f;
+  const float offset = 0.001f;
+  int64_t round_count = 0;
+  absl::Time start = absl::Now();
+  absl::Duration elapsed;
+  do {
+    for (int round = 0; round < 1024; ++round) {
+      for (int step = 0; step < kStepsPerRound; ++step) {
+        for (int i = 0; i < kLaneCount; ++i) {
+          lanes[i] = lanes[i] * scale + offset;
+        }
+      }
+      benchmark::DoNotOptimize(lanes);
+    }
+    round_count += 1024;
+    elapsed = absl::Now() - start;
+  } while (elapsed < kBaselineMeasureTime);
+  return 2.0 * kLaneCount * kStepsPerRound * round_count /
+         absl::ToDoubleSeconds(elapsed);
+}
+
+double PeakFlopsPerSecond() {
+  static const double peak = MeasurePeakFlopsPerSecond();
+  return peak;
+}
+
+// Reports throughput for a kernel that reads and writes |bytes| and performs
+// |flops| ops per iteration.
+void SetThroughput(benchmark::State& state, int64_t bytes, int64_t flops) {
+  double iterations = static_cast<double>(state.iterations());
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["memcpy_fraction"] = benchmark::Counter(
+      iterations * bytes / MemcpyBytesPerSecond(bytes),
+      benchmark::Counter::kIsRate);
+  if (flops > 0) {
+    state.counters["flops"] =
+        benchmark::Counter(iterations * flops, benchmark::Counter::kIsRate);
+    state.counters["peak_fraction"] = benchmark::Counter(
+        iterations * flops / PeakFlopsPerSecond(),
+        benchmark::Counter::kIsRate);
+  }
+}
+
+// Returns |count| small positive values that are valid inputs for all kernels
+// (such as divisors, shift amounts and logarithms).
+template <typename T>
+std::vector<T> MakeInput(int64_t count) {
+  std::vector<T> values;
+  values.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    values.push_back(static_cast<T>(1.0f + (i % 7) * 0.75f));
+  }
+  return values;
+}
+
+// Element counts roughly fitting in L1, L2 and only in main memory.
+void ElementCounts(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(1 << 12)->Arg(1 << 18)->Arg(1 << 22);
+}
+
+//===----------------------------------------------------------------------===//
+// Baselines
+//===----------------------------------------------------------------------===//
+
+void BM_Memcpy(benchmark::State& state) {
+  int64_t size = state.range(0);
+  std::vector<uint8_t> src(size, 1);
+  std::vector<uint8_t> dst(size);
+  for (auto _ : state) {
+    std::memcpy(dst.data(), src.data(), size);
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 2 * size, 0);
+}
+BENCHMARK(BM_Memcpy)->Arg(4 << 12)->Arg(4 << 18)->Arg(4 << 22);
+
+void BM_PeakFlops(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MeasurePeakFlopsPerSecond());
+  }
+  state.counters["flops"] = PeakFlopsPerSecond();
+}
+BENCHMARK(BM_PeakFlops)->Iterations(1);
+
+//===----------------------------------------------------------------------===//
+// Elementwise
+//===----------------------------------------------------------------------===//
+
+template <typename KERNEL, typename T>
+void BM_UnaryOp(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto src = MakeInput<T>(count);
+  std::vector<T> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(src, absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 2 * count * sizeof(T), count);
+}
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Abs, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Abs, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Not, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Floor, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Ceil, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Exp, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Log, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Rsqrt, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Sqrt, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Cos, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Sin, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_UnaryOp, kernels::Tanh, float)->Apply(ElementCounts);
+
+template <typename KERNEL, typename T>
+void BM_BinaryOp(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto lhs = MakeInput<T>(count);
+  auto rhs = MakeInput<T>(count);
+  std::vector<T> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(lhs, rhs, absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 3 * count * sizeof(T), count);
+}
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Add, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Add, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Sub, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Mul, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Mul, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Div, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Div, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Rem, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Min, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Max, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Atan2, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::And, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Or, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::Xor, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::ShiftLeft, int32_t)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_BinaryOp, kernels::ShiftRight, int32_t)
+    ->Apply(ElementCounts);
+
+template <typename KERNEL, typename T>
+void BM_CompareOp(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto lhs = MakeInput<T>(count);
+  auto rhs = MakeInput<T>(count);
+  std::reverse(rhs.begin(), rhs.end());
+  std::vector<uint8_t> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<T>(lhs, rhs, absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, count * (2 * sizeof(T) + 1), count);
+}
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareEQ, int32_t)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareNE, int32_t)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareLT, float)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareLE, float)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareGT, float)
+    ->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_CompareOp, kernels::CompareGE, float)
+    ->Apply(ElementCounts);
+
+void BM_Select(benchmark::State& state) {
+  int64_t count = state.range(0);
+  std::vector<uint8_t> cond(count);
+  for (int64_t i = 0; i < count; ++i) cond[i] = i % 3 == 0;
+  auto lhs = MakeInput<float>(count);
+  auto rhs = MakeInput<float>(count);
+  std::vector<float> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(kernels::Select::Execute<float>(cond, lhs, rhs,
+                                             absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, count * (3 * sizeof(float) + 1), count);
+}
+BENCHMARK(BM_Select)->Apply(ElementCounts);
+
+void BM_MulAdd(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto a = MakeInput<float>(count);
+  auto b = MakeInput<float>(count);
+  auto c = MakeInput<float>(count);
+  std::vector<float> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(kernels::MulAdd::Execute<float>(a, b, c, absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 4 * count * sizeof(float), 2 * count);
+}
+BENCHMARK(BM_MulAdd)->Apply(ElementCounts);
+
+void BM_Clamp(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto src = MakeInput<float>(count);
+  std::vector<float> min(count, 1.0f);
+  std::vector<float> max(count, 3.0f);
+  std::vector<float> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(kernels::Clamp::Execute<float>(src, min, max,
+                                            absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 4 * count * sizeof(float), 2 * count);
+}
+BENCHMARK(BM_Clamp)->Apply(ElementCounts);
+
+// max(tanh(x * y + z), z) - x, as in the kernel tests.
+void BM_FusedElementwise(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto x = MakeInput<float>(count);
+  auto y = MakeInput<float>(count);
+  auto z = MakeInput<float>(count);
+  std::vector<absl::Span<const float>> inputs = {x, y, z};
+  auto op = [](FusedElementwiseOp op) { return static_cast<int32_t>(op); };
+  // clang-format off
+  std::vector<int32_t> program = {
+      op(FusedElementwiseOp::kMul),  0, 1, 0,
+      op(FusedElementwiseOp::kAdd),  3, 2, 0,
+      op(FusedElementwiseOp::kTanh), 4, 0, 0,
+      op(FusedElementwiseOp::kMax),  5, 2, 0,
+      op(FusedElementwiseOp::kSub),  6, 0, 0,
+  };
+  // clang-format on
+  std::vector<float> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(kernels::FusedElementwise::Execute<float>(inputs, program,
+                                                       absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 4 * count * sizeof(float), 5 * count);
+}
+BENCHMARK(BM_FusedElementwise)->Apply(ElementCounts);
+
+template <typename SRC, typename DST>
+void BM_Convert(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto src = MakeInput<SRC>(count);
+  std::vector<DST> dst(count);
+  for (auto _ : state) {
+    CHECK_OK((kernels::Convert::Execute<SRC, DST>(src, absl::MakeSpan(dst))));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, count * (sizeof(SRC) + sizeof(DST)), 0);
+}
+BENCHMARK_TEMPLATE(BM_Convert, float, int32_t)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_Convert, int32_t, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_Convert, int8_t, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_Convert, float, Float16)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_Convert, Float16, float)->Apply(ElementCounts);
+BENCHMARK_TEMPLATE(BM_Convert, float, BFloat16)->Apply(ElementCounts);
+
+//===----------------------------------------------------------------------===//
+// Data movement
+//===----------------------------------------------------------------------===//
+
+// Copies the inner [rows/2, cols/2] block of a [rows, cols] i32 tensor.
+void BM_CopySubregion(benchmark::State& state) {
+  int32_t rows = state.range(0);
+  int32_t cols = state.range(1);
+  Shape src_shape = {rows, cols};
+  Shape dst_shape = {rows / 2, cols / 2};
+  std::vector<uint8_t> src(src_shape.element_count() * 4, 1);
+  std::vector<uint8_t> dst(dst_shape.element_count() * 4);
+  std::vector<int32_t> src_indices = {rows / 4, cols / 4};
+  std::vector<int32_t> dst_indices = {0, 0};
+  std::vector<int32_t> lengths = {rows / 2, cols / 2};
+  for (auto _ : state) {
+    CHECK_OK(kernels::Copy::Execute<4>(src, src_shape, src_indices,
+                                       absl::MakeSpan(dst), dst_shape,
+                                       dst_indices, lengths));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 2 * dst.size(), 0);
+}
+BENCHMARK(BM_CopySubregion)->Args({64, 64})->Args({2048, 2048});
+
+void BM_Transpose(benchmark::State& state, Shape src_shape,
+                  std::vector<int32_t> perm) {
+  auto src = MakeInput<float>(src_shape.element_count());
+  std::vector<float> dst(src.size());
+  for (auto _ : state) {
+    CHECK_OK(kernels::Transpose::Execute<float>(src, absl::MakeSpan(dst),
+                                                src_shape, perm));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 2 * src.size() * sizeof(float), 0);
+}
+BENCHMARK_CAPTURE(BM_Transpose, 2D_64x64, Shape{64, 64},
+                  std::vector<int32_t>{1, 0});
+BENCHMARK_CAPTURE(BM_Transpose, 2D_2048x2048, Shape{2048, 2048},
+                  std::vector<int32_t>{1, 0});
+BENCHMARK_CAPTURE(BM_Transpose, NHWC_to_NCHW, Shape{1, 56, 56, 64},
+                  std::vector<int32_t>{0, 3, 1, 2});
+BENCHMARK_CAPTURE(BM_Transpose, NCHW_to_NHWC, Shape{1, 64, 56, 56},
+                  std::vector<int32_t>{0, 2, 3, 1});
+
+void BM_Reverse(benchmark::State& state, Shape shape,
+                std::vector<int32_t> dimensions) {
+  auto src = MakeInput<float>(shape.element_count());
+  std::vector<float> dst(src.size());
+  for (auto _ : state) {
+    CHECK_OK(kernels::Reverse::Execute<float>(src, absl::MakeSpan(dst), shape,
+                                              dimensions));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, 2 * src.size() * sizeof(float), 0);
+}
+BENCHMARK_CAPTURE(BM_Reverse, Inner, Shape{1024, 1024},
+                  std::vector<int32_t>{1});
+BENCHMARK_CAPTURE(BM_Reverse, Outer, Shape{1024, 1024},
+                  std::vector<int32_t>{0});
+
+void BM_Broadcast(benchmark::State& state) {
+  int64_t count = state.range(0);
+  std::vector<float> src = {1.0f};
+  std::vector<float> dst(count);
+  for (auto _ : state) {
+    CHECK_OK(kernels::Broadcast::Execute<float>(src, absl::MakeSpan(dst)));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, count * sizeof(float), 0);
+}
+BENCHMARK(BM_Broadcast)->Apply(ElementCounts);
+
+// Tiles a row of |cols| elements |rows| times.
+void BM_Tile(benchmark::State& state) {
+  int32_t rows = state.range(0);
+  int32_t cols = state.range(1);
+  Shape src_shape = {1, cols};
+  Shape dst_shape = {rows, cols};
+  auto src = MakeInput<float>(cols);
+  std::vector<float> dst(dst_shape.element_count());
+  for (auto _ : state) {
+    CHECK_OK(kernels::Tile::Execute<float>(src, absl::MakeSpan(dst), src_shape,
+                                           dst_shape));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, (src.size() + dst.size()) * sizeof(float), 0);
+}
+BENCHMARK(BM_Tile)->Args({64, 64})->Args({1024, 1024});
+
+void BM_Pad(benchmark::State& state, Shape src_shape,
+            std::vector<int32_t> edge_padding_low,
+            std::vector<int32_t> edge_padding_high,
+            std::vector<int32_t> interior_padding) {
+  std::vector<int> dst_dims;
+  for (int i = 0; i < src_shape.size(); ++i) {
+    dst_dims.push_back(edge_padding_low[i] + edge_padding_high[i] +
+                       src_shape[i] +
+                       std::max(src_shape[i] - 1, 0) * interior_padding[i]);
+  }
+  Shape dst_shape(dst_dims);
+  auto src = MakeInput<float>(src_shape.element_count());
+  std::vector<float> padding_value = {0.0f};
+  std::vector<float> dst(dst_shape.element_count());
+  for (auto _ : state) {
+    CHECK_OK(kernels::Pad::Execute<float>(
+        src, padding_value, absl::MakeSpan(dst), src_shape, dst_shape,
+        edge_padding_low, edge_padding_high, interior_padding));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, (src.size() + dst.size()) * sizeof(float), 0);
+}
+// Spatial padding of an NHWC image before a 3x3 convolution.
+BENCHMARK_CAPTURE(BM_Pad, Spatial, Shape{1, 56, 56, 64},
+                  std::vector<int32_t>{0, 1, 1, 0},
+                  std::vector<int32_t>{0, 1, 1, 0},
+                  std::vector<int32_t>{0, 0, 0, 0});
+// Interior padding as used for transposed convolutions.
+BENCHMARK_CAPTURE(BM_Pad, Interior, Shape{1, 56, 56, 64},
+                  std::vector<int32_t>{0, 0, 0, 0},
+                  std::vector<int32_t>{0, 0, 0, 0},
+                  std::vector<int32_t>{0, 1, 1, 0});
+
+//===----------------------------------------------------------------------===//
+// Reductions
+//===----------------------------------------------------------------------===//
+
+template <typename KERNEL>
+void BM_Reduce(benchmark::State& state) {
+  int32_t rows = state.range(0);
+  int32_t cols = state.range(1);
+  int32_t dimension = state.range(2);
+  Shape src_shape = {rows, cols};
+  Shape dst_shape = {dimension == 0 ? cols : rows};
+  auto src = MakeInput<float>(src_shape.element_count());
+  std::vector<float> init = {0.0f};
+  std::vector<float> dst(dst_shape.element_count());
+  for (auto _ : state) {
+    CHECK_OK(KERNEL::template Execute<float>(
+        src, init, absl::MakeSpan(dst), dimension, src_shape, dst_shape));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, (src.size() + dst.size()) * sizeof(float),
+                src.size());
+}
+// Reductions over the inner (contiguous) and outer dimensions.
+void ReduceShapes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Args({1024, 1024, 1})->Args({1024, 1024, 0});
+  benchmark->Args({16, 65536, 1})->Args({65536, 16, 0});
+}
+BENCHMARK_TEMPLATE(BM_Reduce, kernels::ReduceSum)->Apply(ReduceShapes);
+BENCHMARK_TEMPLATE(BM_Reduce, kernels::ReduceMin)->Apply(ReduceShapes);
+BENCHMARK_TEMPLATE(BM_Reduce, kernels::ReduceMax)->Apply(ReduceShapes);
+
+//===----------------------------------------------------------------------===//
+// MatMul and convolutions
+//===----------------------------------------------------------------------===//
+
+// Kernel state running everything on the calling thread.
+kernels::RuntimeOptions SingleThreadedOptions() {
+  kernels::RuntimeOptions options;
+  options.thread_count = 1;
+  return options;
+}
+
+// [m, k] x [k, n] with the RHS packed once as for constant weights.
+void BM_MatMul(benchmark::State& state) {
+  int32_t m = state.range(0);
+  int32_t k = state.range(1);
+  int32_t n = state.range(2);
+  kernels::RuntimeState runtime_state(SingleThreadedOptions());
+  auto lhs = MakeInput<float>(m * k);
+  auto rhs = MakeInput<float>(k * n);
+  std::vector<float> dst(m * n);
+  kernels::MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = Shape{m, k};
+  buffers.lhs_buffer = lhs;
+  buffers.rhs_shape = Shape{k, n};
+  buffers.rhs_buffer = rhs;
+  buffers.dst_shape = Shape{m, n};
+  buffers.dst_buffer = absl::MakeSpan(dst);
+  buffers.rhs_cache_owner = &rhs;
+  for (auto _ : state) {
+    CHECK_OK(kernels::MatMul::Execute(runtime_state.mat_mul_state.get(),
+                                      buffers));
+    benchmark::ClobberMemory();
+  }
+  kernels::MatMul::ReleaseCachedRhs(runtime_state.mat_mul_state.get(), &rhs);
+  SetThroughput(state, (m * k + k * n + m * n) * sizeof(float),
+                int64_t{2} * m * k * n);
+}
+BENCHMARK(BM_MatMul)
+    ->Args({64, 64, 64})
+    ->Args({256, 256, 256})
+    ->Args({1024, 1024, 1024})
+    // Matrix-vector products as in batch 1 fully connected layers.
+    ->Args({1, 1024, 1024})
+    ->Args({1, 4096, 1000});
+
+void BM_QuantizedMatMul(benchmark::State& state) {
+  int32_t m = state.range(0);
+  int32_t k = state.range(1);
+  int32_t n = state.range(2);
+  kernels::RuntimeState runtime_state(SingleThreadedOptions());
+  auto lhs = MakeInput<int8_t>(m * k);
+  auto rhs = MakeInput<int8_t>(k * n);
+  std::vector<int8_t> dst(m * n);
+  std::vector<int32_t> bias(n, 100);
+  std::vector<int32_t> multiplier_mantissa = {1 << 30};
+  std::vector<int32_t> multiplier_exponent = {-8};
+  kernels::QuantizedMatMul::Buffers<int8_t> buffers;
+  buffers.lhs_shape = Shape{m, k};
+  buffers.lhs_buffer = lhs;
+  buffers.rhs_shape = Shape{k, n};
+  buffers.rhs_buffer = rhs;
+  buffers.dst_shape = Shape{m, n};
+  buffers.dst_buffer = absl::MakeSpan(dst);
+  buffers.bias_buffer = bias;
+  buffers.multiplier_mantissa_buffer = multiplier_mantissa;
+  buffers.multiplier_exponent_buffer = multiplier_exponent;
+  buffers.quantization.lhs_zero_point = 1;
+  buffers.quantization.rhs_zero_point = -1;
+  buffers.rhs_cache_owner = &rhs;
+  for (auto _ : state) {
+    CHECK_OK(kernels::QuantizedMatMul::Execute(
+        runtime_state.mat_mul_state.get(), buffers));
+    benchmark::ClobberMemory();
+  }
+  kernels::MatMul::ReleaseCachedRhs(runtime_state.mat_mul_state.get(), &rhs);
+  SetThroughput(state, m * k + k * n + m * n, int64_t{2} * m * k * n);
+}
+BENCHMARK(BM_QuantizedMatMul)
+    ->Args({256, 256, 256})
+    ->Args({1024, 1024, 1024})
+    ->Args({1, 1024, 1024});
+
+struct ConvShape {
+  Shape input_shape;
+  Shape filter_shape;
+  Shape dst_shape;
+  kernels::Conv2D::Params params;
+  int64_t flops;
+};
+
+// A same-padded NHWC convolution of a [size, size, channels] image with a
+// [kernel_size, kernel_size] filter. Depthwise convolutions use one group per
+// input channel.
+ConvShape MakeConvShape(int32_t size, int32_t channels, int32_t kernel_size,
+                        int32_t output_channels, bool depthwise) {
+  ConvShape shape;
+  int32_t group_count = depthwise ? channels : 1;
+  shape.input_shape = {1, size, size, channels};
+  shape.filter_shape = {kernel_size, kernel_size, channels / group_count,
+                        output_channels};
+  shape.dst_shape = {1, size, size, output_channels};
+  shape.params.pad_top = shape.params.pad_left = (kernel_size - 1) / 2;
+  shape.params.pad_bottom = shape.params.pad_right = kernel_size / 2;
+  shape.params.feature_group_count = group_count;
+  shape.flops = int64_t{2} * shape.dst_shape.element_count() * kernel_size *
+                kernel_size * (channels / group_count);
+  return shape;
+}
+
+void BM_Conv2D(benchmark::State& state, int32_t size, int32_t channels,
+               int32_t kernel_size, int32_t output_channels, bool depthwise) {
+  auto shape = MakeConvShape(size, channels, kernel_size, output_channels,
+                             depthwise);
+  kernels::RuntimeState runtime_state(SingleThreadedOptions());
+  auto input = MakeInput<float>(shape.input_shape.element_count());
+  auto filter = MakeInput<float>(shape.filter_shape.element_count());
+  std::vector<float> dst(shape.dst_shape.element_count());
+  shape.params.filter_cache_owner = &filter;
+  for (auto _ : state) {
+    CHECK_OK(kernels::Conv2D::Execute<float>(
+        &runtime_state, input, shape.input_shape, filter, shape.filter_shape,
+        absl::MakeSpan(dst), shape.dst_shape, shape.params));
+    benchmark::ClobberMemory();
+  }
+  kernels::MatMul::ReleaseCachedRhs(runtime_state.mat_mul_state.get(),
+                                    &filter);
+  SetThroughput(state, (input.size() + filter.size() + dst.size()) * 4,
+                shape.flops);
+}
+BENCHMARK_CAPTURE(BM_Conv2D, 3x3_56x56x64, 56, 64, 3, 64, false);
+BENCHMARK_CAPTURE(BM_Conv2D, 1x1_56x56x64, 56, 64, 1, 256, false);
+BENCHMARK_CAPTURE(BM_Conv2D, 3x3_224x224x3, 224, 3, 3, 32, false);
+BENCHMARK_CAPTURE(BM_Conv2D, Depthwise3x3_112x112x32, 112, 32, 3, 32, true);
+
+void BM_QuantizedConv2D(benchmark::State& state, int32_t size,
+                        int32_t channels, int32_t kernel_size,
+                        int32_t output_channels) {
+  auto shape = MakeConvShape(size, channels, kernel_size, output_channels,
+                             /*depthwise=*/false);
+  kernels::RuntimeState runtime_state(SingleThreadedOptions());
+  auto input = MakeInput<int8_t>(shape.input_shape.element_count());
+  auto filter = MakeInput<int8_t>(shape.filter_shape.element_count());
+  std::vector<int8_t> dst(shape.dst_shape.element_count());
+  std::vector<int32_t> bias(output_channels, 100);
+  std::vector<int32_t> multiplier_mantissa = {1 << 30};
+  std::vector<int32_t> multiplier_exponent = {-8};
+  kernels::QuantizedConv2D::Buffers<int8_t> buffers;
+  buffers.input_shape = shape.input_shape;
+  buffers.input_buffer = input;
+  buffers.filter_shape = shape.filter_shape;
+  buffers.filter_buffer = filter;
+  buffers.dst_shape = shape.dst_shape;
+  buffers.dst_buffer = absl::MakeSpan(dst);
+  buffers.bias_buffer = bias;
+  buffers.multiplier_mantissa_buffer = multiplier_mantissa;
+  buffers.multiplier_exponent_buffer = multiplier_exponent;
+  for (auto _ : state) {
+    CHECK_OK(kernels::QuantizedConv2D::Execute<int8_t>(&runtime_state, buffers,
+                                                       shape.params));
+    benchmark::ClobberMemory();
+  }
+  SetThroughput(state, input.size() + filter.size() + dst.size(),
+                shape.flops);
+}
+BENCHMARK_CAPTURE(BM_QuantizedConv2D, 3x3_56x56x64, 56, 64, 3, 64);
+BENCHMARK_CAPTURE(BM_QuantizedConv2D, 1x1_56x56x64, 56, 64, 1, 256);
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -15,9 +15,16 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_GENERIC_H_
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
+#include "iree/base/half_float.h"
+#include "iree/base/shape.h"
 #include "iree/base/status.h"
 
 namespace iree {
@@ -88,9 +95,8 @@ namespace impl {
 inline absl::InlinedVector<size_t, 6> ComputeCopyStrides(const Shape& shape,
                                                          size_t element_size) {
   absl::InlinedVector<size_t, 6> strides(shape.size());
-  strides.back() = element_size;
-  for (int i = shape.size() - 2; i >= 0; --i) {
-    strides[i] = strides[i + 1] * shape[i + 1];
+  for (int i = 0; i < shape.size(); ++i) {
+    strides[i] = shape.stride(i) * element_size;
   }
   return strides;
 }
@@ -172,14 +178,11 @@ Status Transpose::Execute(absl::Span<const T> src_buffer,
                           absl::Span<const int32_t> perm) {
   // This implementation is .... not fast.
   int rank = src_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
+  auto src_strides = src_shape.strides();
   absl::InlinedVector<int, 8> dst_strides(rank);
-  size_t src_stride = 1;
   size_t dst_stride = 1;
   for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    src_strides[dim_i] = src_stride;
     dst_strides[dim_i] = dst_stride;
-    src_stride *= src_shape[dim_i];
     dst_stride *= src_shape[perm[dim_i]];
   }
   for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
@@ -269,12 +272,7 @@ Status Reverse::Execute(absl::Span<const T> src_buffer,
                         absl::Span<const int32_t> dimensions) {
   // This implementation is not fast either
   int rank = src_shape.size();
-  absl::InlinedVector<int, 8> strides(rank);
-  size_t stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    strides[dim_i] = stride;
-    stride *= src_shape[dim_i];
-  }
+  auto strides = src_shape.strides();
   absl::flat_hash_set<int32_t> dims_set(dimensions.begin(), dimensions.end());
   for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
     size_t src_i = 0;
@@ -305,16 +303,8 @@ Status Tile::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer,
                      const Shape& src_shape, const Shape& dst_shape) {
   // This implementation is .... not fast.
   int rank = dst_shape.size();
-  absl::InlinedVector<int, 8> src_strides(rank);
-  absl::InlinedVector<int, 8> dst_strides(rank);
-  size_t src_stride = 1;
-  size_t dst_stride = 1;
-  for (int dim_i = rank - 1; dim_i >= 0; --dim_i) {
-    src_strides[dim_i] = src_stride;
-    dst_strides[dim_i] = dst_stride;
-    src_stride *= src_shape[dim_i];
-    dst_stride *= dst_shape[dim_i];
-  }
+  auto src_strides = src_shape.strides();
+  auto dst_strides = dst_shape.strides();
   for (size_t dst_i = 0; dst_i < dst_buffer.size(); ++dst_i) {
     size_t src_i = 0;
     size_t t = dst_i;
@@ -561,6 +551,120 @@ Status Ceil::Execute(absl::Span<const T> src_buffer, absl::Span<T> dst_buffer) {
   return OkStatus();
 }
 
+namespace impl {
+
+// Applies a single fused elementwise |op| to |count| elements of the operand
+// registers |a|, |b| and |c| (unused for lower-arity ops).
+template <typename T>
+Status ApplyFusedElementwiseOp(FusedElementwiseOp op, const T* a, const T* b,
+                               const T* c, int count, T* dst) {
+  switch (op) {
+    case FusedElementwiseOp::kAdd:
+      for (int i = 0; i < count; ++i) dst[i] = a[i] + b[i];
+      break;
+    case FusedElementwiseOp::kSub:
+      for (int i = 0; i < count; ++i) dst[i] = a[i] - b[i];
+      break;
+    case FusedElementwiseOp::kMul:
+      for (int i = 0; i < count; ++i) dst[i] = a[i] * b[i];
+      break;
+    case FusedElementwiseOp::kDiv:
+      for (int i = 0; i < count; ++i) dst[i] = a[i] / b[i];
+      break;
+    case FusedElementwiseOp::kRem:
+      for (int i = 0; i < count; ++i) dst[i] = remainder(a[i], b[i]);
+      break;
+    case FusedElementwiseOp::kMin:
+      for (int i = 0; i < count; ++i) dst[i] = std::min(a[i], b[i]);
+      break;
+    case FusedElementwiseOp::kMax:
+      for (int i = 0; i < count; ++i) dst[i] = std::max(a[i], b[i]);
+      break;
+    case FusedElementwiseOp::kAbs:
+      for (int i = 0; i < count; ++i) dst[i] = std::abs(a[i]);
+      break;
+    case FusedElementwiseOp::kExp:
+      for (int i = 0; i < count; ++i) dst[i] = std::exp(a[i]);
+      break;
+    case FusedElementwiseOp::kLog:
+      for (int i = 0; i < count; ++i) dst[i] = std::log(a[i]);
+      break;
+    case FusedElementwiseOp::kRsqrt:
+      for (int i = 0; i < count; ++i) dst[i] = 1.0 / std::sqrt(a[i]);
+      break;
+    case FusedElementwiseOp::kSqrt:
+      for (int i = 0; i < count; ++i) dst[i] = std::sqrt(a[i]);
+      break;
+    case FusedElementwiseOp::kCos:
+      for (int i = 0; i < count; ++i) dst[i] = std::cos(a[i]);
+      break;
+    case FusedElementwiseOp::kSin:
+      for (int i = 0; i < count; ++i) dst[i] = std::sin(a[i]);
+      break;
+    case FusedElementwiseOp::kTanh:
+      for (int i = 0; i < count; ++i) dst[i] = std::tanh(a[i]);
+      break;
+    case FusedElementwiseOp::kFloor:
+      for (int i = 0; i < count; ++i) dst[i] = std::floor(a[i]);
+      break;
+    case FusedElementwiseOp::kCeil:
+      for (int i = 0; i < count; ++i) dst[i] = std::ceil(a[i]);
+      break;
+    case FusedElementwiseOp::kMulAdd:
+      for (int i = 0; i < count; ++i) dst[i] = a[i] + (b[i] * c[i]);
+      break;
+    case FusedElementwiseOp::kClamp:
+      for (int i = 0; i < count; ++i) {
+        dst[i] = a[i] <= b[i] ? b[i] : a[i] >= c[i] ? c[i] : a[i];
+      }
+      break;
+    default:
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Unknown fused elementwise op " << static_cast<int>(op);
+  }
+  return OkStatus();
+}
+
+}  // namespace impl
+
+template <typename T>
+Status FusedElementwise::Execute(
+    absl::Span<const absl::Span<const T>> input_buffers,
+    absl::Span<const int32_t> program, absl::Span<T> dst_buffer) {
+  const int block_size = kBlockSize;
+  const int input_count = input_buffers.size();
+  const int instruction_count =
+      program.size() / kFusedElementwiseInstructionSize;
+  if (instruction_count == 0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Fused elementwise program is empty";
+  }
+
+  // Intermediate registers for one block. The last instruction writes directly
+  // into the output.
+  std::vector<T> scratch((instruction_count - 1) * block_size);
+  absl::InlinedVector<const T*, 16> registers(input_count + instruction_count);
+  for (size_t offset = 0; offset < dst_buffer.size(); offset += block_size) {
+    int count = static_cast<int>(
+        std::min<size_t>(block_size, dst_buffer.size() - offset));
+    for (int i = 0; i < input_count; ++i) {
+      registers[i] = input_buffers[i].data() + offset;
+    }
+    for (int i = 0; i < instruction_count; ++i) {
+      const int32_t* instruction =
+          program.data() + i * kFusedElementwiseInstructionSize;
+      T* dst = i == instruction_count - 1 ? dst_buffer.data() + offset
+                                          : scratch.data() + i * block_size;
+      RETURN_IF_ERROR(impl::ApplyFusedElementwiseOp(
+          static_cast<FusedElementwiseOp>(instruction[0]),
+          registers[instruction[1]], registers[instruction[2]],
+          registers[instruction[3]], count, dst));
+      registers[input_count + i] = dst;
+    }
+  }
+  return OkStatus();
+}
+
 template <typename SRC, typename DST>
 Status Convert::Execute(absl::Span<const SRC> src_buffer,
                         absl::Span<DST> dst_buffer) {
@@ -571,6 +675,32 @@ Status Convert::Execute(absl::Span<const SRC> src_buffer,
   return OkStatus();
 }
 
+// Half-precision widening and narrowing use the bulk (vectorized) converters.
+template <>
+inline Status Convert::Execute<Float16, float>(
+    absl::Span<const Float16> src_buffer, absl::Span<float> dst_buffer) {
+  ConvertToFloat(src_buffer, dst_buffer);
+  return OkStatus();
+}
+template <>
+inline Status Convert::Execute<BFloat16, float>(
+    absl::Span<const BFloat16> src_buffer, absl::Span<float> dst_buffer) {
+  ConvertToFloat(src_buffer, dst_buffer);
+  return OkStatus();
+}
+template <>
+inline Status Convert::Execute<float, Float16>(
+    absl::Span<const float> src_buffer, absl::Span<Float16> dst_buffer) {
+  ConvertFromFloat(src_buffer, dst_buffer);
+  return OkStatus();
+}
+template <>
+inline Status Convert::Execute<float, BFloat16>(
+    absl::Span<const float> src_buffer, absl::Span<BFloat16> dst_buffer) {
+  ConvertFromFloat(src_buffer, dst_buffer);
+  return OkStatus();
+}
+
 namespace impl {
 
 struct SumKernel {
@@ -718,6 +848,389 @@ Status ReduceMax::Execute(absl::Span<const T> src_buffer,
       src_buffer, init_buffer, dst_buffer, dimension, src_shape, dst_shape);
 }
 
+namespace impl {
+
+// Filter windows the direct convolution tiles are specialized on. A static
+// window gives the tap loops constant trip counts so they are fully unrolled;
+// DynamicWindow reads the window from the filter shape instead.
+using DynamicWindow = StaticShape<>;
+using Window3x3 = StaticShape<3, 3>;
+
+// Returns filter window dimension |i| (0 = height, 1 = width).
+template <typename Window>
+inline int FilterWindowDim(const Shape& filter_shape, int i) {
+  return Window::kRank == 2 ? Window::dim(i) : filter_shape[i];
+}
+
+// Runs |tile_fn| with the static window matching |filter_shape|, if any.
+template <typename TileFn>
+inline void DispatchFilterWindow(const Shape& filter_shape, TileFn tile_fn) {
+  if (filter_shape[0] == Window3x3::dim(0) &&
+      filter_shape[1] == Window3x3::dim(1)) {
+    tile_fn(Window3x3());
+  } else {
+    tile_fn(DynamicWindow());
+  }
+}
+
+// Computes the output pixels in the flattened (batch * out_h * out_w) row range
+// [row_begin, row_end) by directly accumulating over the filter taps.
+template <typename T, typename Window>
+void Conv2DDirectTile(const T* input, const Shape& input_shape, const T* filter,
+                      const Shape& filter_shape, T* dst, const Shape& dst_shape,
+                      const Conv2D::Params& params, int row_begin,
+                      int row_end) {
+  const int in_h = input_shape[1];
+  const int in_w = input_shape[2];
+  const int in_c = input_shape[3];
+  const int k_h = FilterWindowDim<Window>(filter_shape, 0);
+  const int k_w = FilterWindowDim<Window>(filter_shape, 1);
+  const int group_in_c = filter_shape[2];
+  const int out_c = filter_shape[3];
+  const int out_h = dst_shape[1];
+  const int out_w = dst_shape[2];
+  const int groups = params.feature_group_count;
+  const int group_out_c = out_c / groups;
+  for (int row = row_begin; row < row_end; ++row) {
+    const int n = row / (out_h * out_w);
+    const int oy = (row / out_w) % out_h;
+    const int ox = row % out_w;
+    T* dst_pixel = dst + static_cast<size_t>(row) * out_c;
+    std::fill_n(dst_pixel, out_c, T(0));
+    for (int ky = 0; ky < k_h; ++ky) {
+      const int iy =
+          oy * params.stride_h + ky * params.dilation_h - params.pad_top;
+      if (iy < 0 || iy >= in_h) continue;
+      for (int kx = 0; kx < k_w; ++kx) {
+        const int ix =
+            ox * params.stride_w + kx * params.dilation_w - params.pad_left;
+        if (ix < 0 || ix >= in_w) continue;
+        const T* input_pixel =
+            input + ((static_cast<size_t>(n) * in_h + iy) * in_w + ix) * in_c;
+        const T* filter_tap =
+            filter + (static_cast<size_t>(ky) * k_w + kx) * group_in_c * out_c;
+        for (int g = 0; g < groups; ++g) {
+          const T* group_input = input_pixel + g * group_in_c;
+          T* group_dst = dst_pixel + g * group_out_c;
+          for (int ic = 0; ic < group_in_c; ++ic) {
+            const T value = group_input[ic];
+            const T* filter_row = filter_tap + ic * out_c + g * group_out_c;
+            for (int oc = 0; oc < group_out_c; ++oc) {
+              group_dst[oc] += value * filter_row[oc];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Packs the receptive fields of the output rows [row_begin, row_end) into
+// |col_buffer| as a row-major [row_count, k_h * k_w * in_c] matrix. Taps that
+// fall into the padding are filled with |pad_value|.
+template <typename T>
+void Im2ColTile(const T* input, const Shape& input_shape,
+                const Shape& filter_shape, const Shape& dst_shape,
+                const Conv2D::Params& params, int row_begin, int row_end,
+                T* col_buffer, T pad_value = T(0)) {
+  const int in_h = input_shape[1];
+  const int in_w = input_shape[2];
+  const int in_c = input_shape[3];
+  const int k_h = filter_shape[0];
+  const int k_w = filter_shape[1];
+  const int out_h = dst_shape[1];
+  const int out_w = dst_shape[2];
+  const size_t depth = static_cast<size_t>(k_h) * k_w * in_c;
+  for (int row = row_begin; row < row_end; ++row) {
+    const int n = row / (out_h * out_w);
+    const int oy = (row / out_w) % out_h;
+    const int ox = row % out_w;
+    T* col_tap = col_buffer + (row - row_begin) * depth;
+    for (int ky = 0; ky < k_h; ++ky) {
+      const int iy =
+          oy * params.stride_h + ky * params.dilation_h - params.pad_top;
+      for (int kx = 0; kx < k_w; ++kx, col_tap += in_c) {
+        const int ix =
+            ox * params.stride_w + kx * params.dilation_w - params.pad_left;
+        if (iy < 0 || iy >= in_h || ix < 0 || ix >= in_w) {
+          std::fill_n(col_tap, in_c, pad_value);
+          continue;
+        }
+        const T* input_pixel =
+            input + ((static_cast<size_t>(n) * in_h + iy) * in_w + ix) * in_c;
+        std::memcpy(col_tap, input_pixel, in_c * sizeof(T));
+      }
+    }
+  }
+}
+
+// Fixed-point helpers matching the rounding of gemmlowp and ruy.
+inline int32_t SaturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  if (a == b && a == std::numeric_limits<int32_t>::min()) {
+    return std::numeric_limits<int32_t>::max();
+  }
+  const int64_t ab = static_cast<int64_t>(a) * b;
+  const int64_t nudge = ab >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+  return static_cast<int32_t>((ab + nudge) / (1ll << 31));
+}
+
+inline int32_t RoundingDivideByPOT(int32_t x, int exponent) {
+  const int32_t mask = static_cast<int32_t>((1ll << exponent) - 1);
+  const int32_t remainder = x & mask;
+  const int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+// Rescales an int32 accumulator to the destination domain of |quantization|.
+inline int32_t Requantize(int32_t accumulator, int32_t multiplier_mantissa,
+                          int32_t multiplier_exponent,
+                          const QuantizationParams& quantization,
+                          int32_t clamp_min, int32_t clamp_max) {
+  const int left_shift =
+      multiplier_exponent > 0 ? std::min(multiplier_exponent, 31) : 0;
+  const int right_shift = multiplier_exponent > 0 ? 0 : -multiplier_exponent;
+  // The left shift saturates as in gemmlowp rather than overflowing.
+  const int64_t shifted =
+      static_cast<int64_t>(accumulator) * (int64_t{1} << left_shift);
+  const int32_t saturated = static_cast<int32_t>(std::min<int64_t>(
+      std::max<int64_t>(shifted, std::numeric_limits<int32_t>::min()),
+      std::numeric_limits<int32_t>::max()));
+  const int64_t value =
+      static_cast<int64_t>(RoundingDivideByPOT(
+          SaturatingRoundingDoublingHighMul(saturated, multiplier_mantissa),
+          right_shift)) +
+      quantization.dst_zero_point;
+  return static_cast<int32_t>(
+      std::min<int64_t>(std::max<int64_t>(value, clamp_min), clamp_max));
+}
+
+// Quantized variant of Conv2DDirectTile.
+template <typename T, typename Window>
+void QuantizedConv2DDirectTile(const QuantizedConv2D::Buffers<T>& buffers,
+                               const Conv2D::Params& params, int row_begin,
+                               int row_end) {
+  const auto& input_shape = buffers.input_shape;
+  const auto& filter_shape = buffers.filter_shape;
+  const auto& quantization = buffers.quantization;
+  const int in_h = input_shape[1];
+  const int in_w = input_shape[2];
+  const int in_c = input_shape[3];
+  const int k_h = FilterWindowDim<Window>(filter_shape, 0);
+  const int k_w = FilterWindowDim<Window>(filter_shape, 1);
+  const int group_in_c = filter_shape[2];
+  const int out_c = filter_shape[3];
+  const int out_h = buffers.dst_shape[1];
+  const int out_w = buffers.dst_shape[2];
+  const int groups = params.feature_group_count;
+  const int group_out_c = out_c / groups;
+  const bool per_channel = buffers.multiplier_mantissa_buffer.size() > 1;
+  const int32_t clamp_min =
+      std::max(quantization.clamp_min,
+               static_cast<int32_t>(std::numeric_limits<T>::lowest()));
+  const int32_t clamp_max =
+      std::min(quantization.clamp_max,
+               static_cast<int32_t>(std::numeric_limits<T>::max()));
+  std::vector<int32_t> accumulators(out_c);
+  for (int row = row_begin; row < row_end; ++row) {
+    const int n = row / (out_h * out_w);
+    const int oy = (row / out_w) % out_h;
+    const int ox = row % out_w;
+    std::fill(accumulators.begin(), accumulators.end(), 0);
+    for (int ky = 0; ky < k_h; ++ky) {
+      const int iy =
+          oy * params.stride_h + ky * params.dilation_h - params.pad_top;
+      if (iy < 0 || iy >= in_h) continue;
+      for (int kx = 0; kx < k_w; ++kx) {
+        const int ix =
+            ox * params.stride_w + kx * params.dilation_w - params.pad_left;
+        if (ix < 0 || ix >= in_w) continue;
+        const T* input_pixel =
+            buffers.input_buffer.data() +
+            ((static_cast<size_t>(n) * in_h + iy) * in_w + ix) * in_c;
+        const T* filter_tap =
+            buffers.filter_buffer.data() +
+            (static_cast<size_t>(ky) * k_w + kx) * group_in_c * out_c;
+        for (int g = 0; g < groups; ++g) {
+          const T* group_input = input_pixel + g * group_in_c;
+          int32_t* group_accumulators = accumulators.data() + g * group_out_c;
+          for (int ic = 0; ic < group_in_c; ++ic) {
+            const int32_t value =
+                static_cast<int32_t>(group_input[ic]) -
+                quantization.lhs_zero_point;
+            const T* filter_row = filter_tap + ic * out_c + g * group_out_c;
+            for (int oc = 0; oc < group_out_c; ++oc) {
+              group_accumulators[oc] +=
+                  value * (static_cast<int32_t>(filter_row[oc]) -
+                           quantization.rhs_zero_point);
+            }
+          }
+        }
+      }
+    }
+    T* dst_pixel = buffers.dst_buffer.data() + static_cast<size_t>(row) * out_c;
+    for (int oc = 0; oc < out_c; ++oc) {
+      int32_t accumulator = accumulators[oc];
+      if (!buffers.bias_buffer.empty()) accumulator += buffers.bias_buffer[oc];
+      const int channel = per_channel ? oc : 0;
+      dst_pixel[oc] = static_cast<T>(Requantize(
+          accumulator, buffers.multiplier_mantissa_buffer[channel],
+          buffers.multiplier_exponent_buffer[channel], quantization, clamp_min,
+          clamp_max));
+    }
+  }
+}
+
+}  // namespace impl
+
+template <typename T>
+Status Conv2D::Execute(RuntimeState* runtime_state,
+                       absl::Span<const T> input_buffer,
+                       const Shape& input_shape,
+                       absl::Span<const T> filter_buffer,
+                       const Shape& filter_shape, absl::Span<T> dst_buffer,
+                       const Shape& dst_shape, const Params& params) {
+  const int k_h = filter_shape[0];
+  const int k_w = filter_shape[1];
+  const int out_c = filter_shape[3];
+  const int depth = k_h * k_w * filter_shape[2];
+  const int row_count = dst_shape[0] * dst_shape[1] * dst_shape[2];
+  const int tile_size = kTileRows;
+  const int tile_count = (row_count + tile_size - 1) / tile_size;
+  auto* thread_pool = &runtime_state->thread_pool;
+  auto* mat_mul_state = runtime_state->mat_mul_state.get();
+
+  if (params.feature_group_count != 1 || depth < kIm2ColMinDepth) {
+    impl::DispatchFilterWindow(filter_shape, [&](auto window) {
+      using Window = decltype(window);
+      thread_pool->ParallelFor(tile_count, [&](int tile_index) {
+        const int row_begin = tile_index * tile_size;
+        impl::Conv2DDirectTile<T, Window>(
+            input_buffer.data(), input_shape, filter_buffer.data(),
+            filter_shape, dst_buffer.data(), dst_shape, params, row_begin,
+            std::min(row_begin + tile_size, row_count));
+      });
+    });
+    return OkStatus();
+  }
+
+  // HWIO filters are already a row-major [depth, out_c] matrix.
+  MatMul::Buffers<T, T> buffers;
+  buffers.rhs_shape = Shape{depth, out_c};
+  buffers.rhs_buffer = filter_buffer;
+  buffers.rhs_cache_owner = params.filter_cache_owner;
+
+  if (k_h == 1 && k_w == 1 && params.stride_h == 1 && params.stride_w == 1 &&
+      params.pad_top == 0 && params.pad_bottom == 0 && params.pad_left == 0 &&
+      params.pad_right == 0) {
+    // Pointwise convolutions are a single GEMM over the input pixels.
+    buffers.lhs_shape = Shape{row_count, depth};
+    buffers.lhs_buffer = input_buffer;
+    buffers.dst_shape = Shape{row_count, out_c};
+    buffers.dst_buffer = dst_buffer;
+    return MatMul::Execute(mat_mul_state, buffers);
+  }
+
+  // Each tile multiplies on the thread running it; nested MatMul calls see the
+  // pool busy and run inline.
+  std::vector<Status> tile_statuses(tile_count);
+  thread_pool->ParallelFor(tile_count, [&](int tile_index) {
+    const int row_begin = tile_index * tile_size;
+    const int row_end = std::min(row_begin + tile_size, row_count);
+    const int tile_rows = row_end - row_begin;
+    std::vector<T> col_buffer(static_cast<size_t>(tile_rows) * depth);
+    impl::Im2ColTile(input_buffer.data(), input_shape, filter_shape, dst_shape,
+                     params, row_begin, row_end, col_buffer.data());
+    MatMul::Buffers<T, T> tile_buffers = buffers;
+    tile_buffers.lhs_shape = Shape{tile_rows, depth};
+    tile_buffers.lhs_buffer = absl::MakeConstSpan(col_buffer);
+    tile_buffers.dst_shape = Shape{tile_rows, out_c};
+    tile_buffers.dst_buffer = dst_buffer.subspan(
+        static_cast<size_t>(row_begin) * out_c, tile_rows * out_c);
+    tile_statuses[tile_index] = MatMul::Execute(mat_mul_state, tile_buffers);
+  });
+  for (auto& status : tile_statuses) {
+    RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status QuantizedConv2D::Execute(RuntimeState* runtime_state,
+                                const Buffers<T>& buffers,
+                                const Conv2D::Params& params) {
+  const auto& filter_shape = buffers.filter_shape;
+  const int k_h = filter_shape[0];
+  const int k_w = filter_shape[1];
+  const int out_c = filter_shape[3];
+  const int depth = k_h * k_w * filter_shape[2];
+  const int row_count =
+      buffers.dst_shape[0] * buffers.dst_shape[1] * buffers.dst_shape[2];
+  const int tile_size = Conv2D::kTileRows;
+  const int tile_count = (row_count + tile_size - 1) / tile_size;
+  auto* thread_pool = &runtime_state->thread_pool;
+  auto* mat_mul_state = runtime_state->mat_mul_state.get();
+
+  if (params.feature_group_count != 1 || depth < Conv2D::kIm2ColMinDepth) {
+    impl::DispatchFilterWindow(filter_shape, [&](auto window) {
+      using Window = decltype(window);
+      thread_pool->ParallelFor(tile_count, [&](int tile_index) {
+        const int row_begin = tile_index * tile_size;
+        impl::QuantizedConv2DDirectTile<T, Window>(
+            buffers, params, row_begin,
+            std::min(row_begin + tile_size, row_count));
+      });
+    });
+    return OkStatus();
+  }
+
+  QuantizedMatMul::Buffers<T> mat_mul_buffers;
+  mat_mul_buffers.rhs_shape = Shape{depth, out_c};
+  mat_mul_buffers.rhs_buffer = buffers.filter_buffer;
+  mat_mul_buffers.bias_buffer = buffers.bias_buffer;
+  mat_mul_buffers.multiplier_mantissa_buffer =
+      buffers.multiplier_mantissa_buffer;
+  mat_mul_buffers.multiplier_exponent_buffer =
+      buffers.multiplier_exponent_buffer;
+  mat_mul_buffers.quantization = buffers.quantization;
+  mat_mul_buffers.rhs_cache_owner = params.filter_cache_owner;
+
+  if (k_h == 1 && k_w == 1 && params.stride_h == 1 && params.stride_w == 1 &&
+      params.pad_top == 0 && params.pad_bottom == 0 && params.pad_left == 0 &&
+      params.pad_right == 0) {
+    mat_mul_buffers.lhs_shape = Shape{row_count, depth};
+    mat_mul_buffers.lhs_buffer = buffers.input_buffer;
+    mat_mul_buffers.dst_shape = Shape{row_count, out_c};
+    mat_mul_buffers.dst_buffer = buffers.dst_buffer;
+    return QuantizedMatMul::Execute(mat_mul_state, mat_mul_buffers);
+  }
+
+  // Padding taps hold the input zero point so that they contribute nothing to
+  // the accumulators.
+  const T pad_value = static_cast<T>(buffers.quantization.lhs_zero_point);
+  std::vector<Status> tile_statuses(tile_count);
+  thread_pool->ParallelFor(tile_count, [&](int tile_index) {
+    const int row_begin = tile_index * tile_size;
+    const int row_end = std::min(row_begin + tile_size, row_count);
+    const int tile_rows = row_end - row_begin;
+    std::vector<T> col_buffer(static_cast<size_t>(tile_rows) * depth);
+    impl::Im2ColTile(buffers.input_buffer.data(), buffers.input_shape,
+                     filter_shape, buffers.dst_shape, params, row_begin,
+                     row_end, col_buffer.data(), pad_value);
+    QuantizedMatMul::Buffers<T> tile_buffers = mat_mul_buffers;
+    tile_buffers.lhs_shape = Shape{tile_rows, depth};
+    tile_buffers.lhs_buffer = absl::MakeConstSpan(col_buffer);
+    tile_buffers.dst_shape = Shape{tile_rows, out_c};
+    tile_buffers.dst_buffer = buffers.dst_buffer.subspan(
+        static_cast<size_t>(row_begin) * out_c, tile_rows * out_c);
+    tile_statuses[tile_index] =
+        QuantizedMatMul::Execute(mat_mul_state, tile_buffers);
+  });
+  for (auto& status : tile_statuses) {
+    RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 }  // namespace kernels
 }  // namespace hal
 }  // namespace iree
@@ -15,26 +15,118 @@
 #ifndef IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 #define IREE_HAL_INTERPRETER_BYTECODE_KERNELS_RUY_H_
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <vector>
+
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "iree/base/status.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/host/host_thread_pool.h"
 #include "tensorflow/lite/experimental/ruy/context.h"
 #include "tensorflow/lite/experimental/ruy/ruy.h"
+#include "tensorflow/lite/experimental/ruy/ruy_advanced.h"
 
 namespace iree {
 namespace hal {
 namespace kernels {
 
-// TODO(benvanik): something more clever for making this shareable.
-// Maybe a factory fn based on the impl selected?
+// State shared by all fibers on a device. ruy contexts are single-threaded and
+// leased per call so that all parallelism comes from the device thread pool.
 struct MatMul::RuntimeState {
-  // TODO(benvanik): share the thread pool but keep context per-fiber?
-  ruy::Context context;
+  // A packed RHS matrix cached for an immutable (constant) buffer.
+  struct PackedRhs {
+    ruy::PrepackedMatrix prepacked;
+    std::vector<std::unique_ptr<uint8_t[]>> allocations;
+  };
+
+  // (owner, data, rows, cols, packing tag)
+  using PackedRhsKey =
+      std::tuple<const void*, const void*, int, int, const void*>;
+
+  // Returns a tag unique to each packing variant (kernel and element types) so
+  // that a constant used by several kernels gets separate cache entries.
+  template <typename... Ts>
+  static const void* PackingTag() {
+    static const char tag = 0;
+    return &tag;
+  }
+
+  explicit RuntimeState(HostThreadPool* thread_pool)
+      : thread_pool(thread_pool) {}
+
+  std::unique_ptr<ruy::Context> AcquireContext() {
+    absl::MutexLock lock(&mutex);
+    if (free_contexts.empty()) {
+      auto context = absl::make_unique<ruy::Context>();
+      context->max_num_threads = 1;
+      return context;
+    }
+    auto context = std::move(free_contexts.back());
+    free_contexts.pop_back();
+    return context;
+  }
+
+  void ReleaseContext(std::unique_ptr<ruy::Context> context) {
+    absl::MutexLock lock(&mutex);
+    free_contexts.push_back(std::move(context));
+  }
+
+  std::shared_ptr<PackedRhs> LookupPackedRhs(const PackedRhsKey& key) {
+    absl::MutexLock lock(&mutex);
+    auto it = packed_rhs_cache.find(key);
+    return it != packed_rhs_cache.end() ? it->second : nullptr;
+  }
+
+  // Inserts |packed_rhs| unless another fiber raced us, in which case the
+  // existing entry is returned.
+  std::shared_ptr<PackedRhs> InsertPackedRhs(
+      const PackedRhsKey& key, std::shared_ptr<PackedRhs> packed_rhs) {
+    absl::MutexLock lock(&mutex);
+    return packed_rhs_cache.emplace(key, std::move(packed_rhs)).first->second;
+  }
+
+  // Returns the number of blocks of LHS rows that an [m, k] * [k, n] multiply
+  // is split into across the thread pool.
+  int ComputeBlockCount(int m, int n, int k) const {
+    const int thread_count = thread_pool->thread_count();
+    if (thread_count == 1 ||
+        static_cast<int64_t>(m) * n * k < kMinParallelMultiplyAdds) {
+      return 1;
+    }
+    return std::max(1, std::min(thread_count, m / kMinRowsPerBlock));
+  }
+
+  HostThreadPool* const thread_pool;
+
+  absl::Mutex mutex;
+  std::vector<std::unique_ptr<ruy::Context>> free_contexts
+      ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<PackedRhsKey, std::shared_ptr<PackedRhs>>
+      packed_rhs_cache ABSL_GUARDED_BY(mutex);
 };
 
-inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState() {
-  return absl::make_unique<RuntimeState>();
+inline std::unique_ptr<MatMul::RuntimeState> MatMul::CreateRuntimeState(
+    HostThreadPool* thread_pool) {
+  return absl::make_unique<RuntimeState>(thread_pool);
+}
+
+inline void MatMul::ReleaseCachedRhs(RuntimeState* runtime_state,
+                                     const void* owner) {
+  absl::MutexLock lock(&runtime_state->mutex);
+  auto& cache = runtime_state->packed_rhs_cache;
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (std::get<0>(it->first) == owner) {
+      cache.erase(it++);
+    } else {
+      ++it;
+    }
+  }
 }
 
 template <typename T>
@@ -136,50 +228,140 @@ Status MatMul::Execute(RuntimeState* runtime_state,
   // until the compiler can reason properly about layout and pre-packing, which
   // is the anticipated future state. This is doing (A * B^T)^T.
   // If needed, it can also be re-arranged to (B * A^T).
-  T* a_data;
-  int a_d0, a_d1;
-  T* b_data;
-  int b_d0, b_d1;
-  T* r_data;
-  int r_d0, r_d1;
-
-  bool transpose_dst = false;
-  T* temp1_buffer = nullptr;
-  T* temp2_buffer = nullptr;
-  {
-    // Do (A * B^T)^T
+  const int m = buffers.lhs_shape[0];
+  const int k = buffers.lhs_shape[1];
+  const int n = buffers.rhs_shape[1];
+
+  ruy::Matrix<T> lhs_matrix;
+  ruy::MakeSimpleLayout(m, k, ruy::Order::kRowMajor, &lhs_matrix.layout);
+  lhs_matrix.data.set(buffers.lhs_buffer.data());
+  ruy::Matrix<T> dst_matrix;
+  ruy::MakeSimpleLayout(m, n, ruy::Order::kColMajor, &dst_matrix.layout);
+
+  // B = RHS^T, either transposed for this call or packed once and cached for
+  // immutable RHS buffers.
+  ruy::Matrix<T> rhs_matrix;
+  ruy::MakeSimpleLayout(k, n, ruy::Order::kColMajor, &rhs_matrix.layout);
+  std::unique_ptr<T[]> transposed_rhs;
+  std::shared_ptr<RuntimeState::PackedRhs> packed_rhs;
+  RuntimeState::PackedRhsKey packed_rhs_key{
+      buffers.rhs_cache_owner, buffers.rhs_buffer.data(), k, n,
+      RuntimeState::PackingTag<MatMul, T, ACC>()};
+  if (buffers.rhs_cache_owner) {
+    packed_rhs = runtime_state->LookupPackedRhs(packed_rhs_key);
+  }
+  if (packed_rhs) {
+    // ruy only reads the prepacked data.
+    rhs_matrix.data.set(buffers.rhs_buffer.data());
+  } else {
     IREE_TRACE_SCOPE0("MatMul#TransposeRhs");
-    // A = LHS
-    a_d0 = buffers.lhs_shape[0];
-    a_d1 = buffers.lhs_shape[1];
-    a_data = const_cast<T*>(buffers.lhs_buffer.data());
-    // B = RHS^T
-    b_d0 = buffers.rhs_shape[0];
-    b_d1 = buffers.rhs_shape[1];
-    b_data = temp1_buffer = new T[b_d0 * b_d1];
-    Transpose2D(b_d0, b_d1, buffers.rhs_buffer.data(), b_data);
-    // R
-    transpose_dst = true;
-    r_d0 = buffers.dst_shape[0];
-    r_d1 = buffers.dst_shape[1];
-    r_data = temp2_buffer = new T[r_d0 * r_d1];
-  }
-
-  ruy::Matrix<T> a_matrix;
-  ruy::MakeSimpleLayout(a_d0, a_d1, ruy::Order::kRowMajor, &a_matrix.layout);
-  a_matrix.data.set(a_data);
-
-  ruy::Matrix<T> b_matrix;
-  ruy::MakeSimpleLayout(b_d0, b_d1, ruy::Order::kColMajor, &b_matrix.layout);
-  b_matrix.data.set(b_data);
-
-  ruy::Matrix<T> r_matrix;
-  ruy::MakeSimpleLayout(r_d0, r_d1, ruy::Order::kColMajor, &r_matrix.layout);
-  r_matrix.data.set(r_data);
-
-  ruy::BasicSpec<ACC, T> spec;
-  spec.bias = buffers.bias_buffer.data();
+    transposed_rhs.reset(new T[k * n]);
+    Transpose2D(k, n, buffers.rhs_buffer.data(), transposed_rhs.get());
+    rhs_matrix.data.set(transposed_rhs.get());
+  }
+  if (!packed_rhs && buffers.rhs_cache_owner) {
+    IREE_TRACE_SCOPE0("MatMul#PackRhs");
+    auto new_packed_rhs = std::make_shared<RuntimeState::PackedRhs>();
+    auto* allocations = &new_packed_rhs->allocations;
+    auto context = runtime_state->AcquireContext();
+    ruy::BasicSpec<ACC, T> spec;
+    ruy::PrePackForMul<ruy::kAllPaths>(
+        lhs_matrix, rhs_matrix, spec, context.get(), &dst_matrix,
+        /*prepacked_lhs=*/nullptr, &new_packed_rhs->prepacked,
+        [allocations](std::size_t size) -> void* {
+          allocations->emplace_back(new uint8_t[size]);
+          return allocations->back().get();
+        });
+    runtime_state->ReleaseContext(std::move(context));
+    packed_rhs = runtime_state->InsertPackedRhs(packed_rhs_key,
+                                                std::move(new_packed_rhs));
+  }
+
+  // Split the rows of the LHS into blocks that run on the thread pool. The
+  // transposed/packed RHS is shared by all blocks.
+  const int block_count = runtime_state->ComputeBlockCount(m, n, k);
+  const int rows_per_block = (m + block_count - 1) / block_count;
+  runtime_state->thread_pool->ParallelFor(block_count, [&](int block_index) {
+    const int row_begin = block_index * rows_per_block;
+    const int rows = std::min(m - row_begin, rows_per_block);
+    if (rows <= 0) return;
 
+    ruy::Matrix<T> a_matrix;
+    ruy::MakeSimpleLayout(rows, k, ruy::Order::kRowMajor, &a_matrix.layout);
+    a_matrix.data.set(buffers.lhs_buffer.data() +
+                      static_cast<size_t>(row_begin) * k);
+
+    std::unique_ptr<T[]> r_data(new T[static_cast<size_t>(rows) * n]);
+    ruy::Matrix<T> r_matrix;
+    ruy::MakeSimpleLayout(rows, n, ruy::Order::kColMajor, &r_matrix.layout);
+    r_matrix.data.set(r_data.get());
+
+    // Bias and per-channel multipliers have one element per destination row.
+    ruy::BasicSpec<ACC, T> spec;
+    if (!buffers.bias_buffer.empty()) {
+      spec.bias = buffers.bias_buffer.data() + row_begin;
+    }
+    if (buffers.multiplier_mantissa_buffer.size() == 1) {
+      spec.multiplier_fixedpoint = buffers.multiplier_mantissa_buffer[0];
+      spec.multiplier_exponent = buffers.multiplier_exponent_buffer[0];
+    } else if (!buffers.multiplier_mantissa_buffer.empty()) {
+      spec.multiplier_fixedpoint_perchannel =
+          buffers.multiplier_mantissa_buffer.data() + row_begin;
+      spec.multiplier_exponent_perchannel =
+          buffers.multiplier_exponent_buffer.data() + row_begin;
+    }
+
+    auto context = runtime_state->AcquireContext();
+    if (packed_rhs) {
+      ruy::MulWithPrepacked<ruy::kAllPaths>(
+          a_matrix, rhs_matrix, spec, context.get(), &r_matrix,
+          /*prepacked_lhs=*/nullptr, &packed_rhs->prepacked);
+    } else {
+      ruy::Mul<ruy::kAllPaths>(a_matrix, rhs_matrix, spec, context.get(),
+                               &r_matrix);
+    }
+    runtime_state->ReleaseContext(std::move(context));
+
+    IREE_TRACE_SCOPE0("MatMul#TransposeDst");
+    // Dims reversed because it is written in col major and the transpose
+    // treats the dims as row major.
+    Transpose2D(n, rows, r_data.get(),
+                buffers.dst_buffer.data() + static_cast<size_t>(row_begin) * n);
+  });
+
+  return OkStatus();
+}
+
+template <typename T>
+Status QuantizedMatMul::Execute(MatMul::RuntimeState* runtime_state,
+                                const Buffers<T>& buffers) {
+  // This computes dst^T = rhs^T * lhs^T so that the RHS (usually the weights)
+  // is the ruy LHS. ruy applies bias and per-channel multipliers per
+  // destination row, which are then our output channels, and the row-major
+  // lhs and dst buffers are already the column-major layouts ruy expects. Only
+  // the RHS needs transposing and that is cached for constants.
+  using RuntimeState = MatMul::RuntimeState;
+  const int m = buffers.lhs_shape[0];
+  const int k = buffers.lhs_shape[1];
+  const int n = buffers.rhs_shape[1];
+  const auto& quantization = buffers.quantization;
+
+  ruy::Matrix<T> weights_matrix;
+  ruy::MakeSimpleLayout(n, k, ruy::Order::kRowMajor, &weights_matrix.layout);
+  weights_matrix.zero_point = static_cast<T>(quantization.rhs_zero_point);
+  ruy::Matrix<T> input_matrix;
+  ruy::MakeSimpleLayout(k, m, ruy::Order::kColMajor, &input_matrix.layout);
+  input_matrix.data.set(buffers.lhs_buffer.data());
+  input_matrix.zero_point = static_cast<T>(quantization.lhs_zero_point);
+  ruy::Matrix<T> output_matrix;
+  ruy::MakeSimpleLayout(n, m, ruy::Order::kColMajor, &output_matrix.layout);
+  output_matrix.data.set(buffers.dst_buffer.data());
+  output_matrix.zero_point = static_cast<T>(quantization.dst_zero_point);
+
+  ruy::BasicSpec<int32_t, T> spec;
+  if (!buffers.bias_buffer.empty()) {
+    spec.bias = buffers.bias_buffer.data();
+  }
   if (buffers.multiplier_mantissa_buffer.size() == 1) {
     spec.multiplier_fixedpoint = buffers.multiplier_mantissa_buffer[0];
     spec.multiplier_exponent = buffers.multiplier_exponent_buffer[0];
@@ -189,18 +371,77 @@ Status MatMul::Execute(RuntimeState* runtime_state,
     spec.multiplier_exponent_perchannel =
         buffers.multiplier_exponent_buffer.data();
   }
+  spec.clamp_min = static_cast<T>(
+      std::max(quantization.clamp_min,
+               static_cast<int32_t>(std::numeric_limits<T>::lowest())));
+  spec.clamp_max = static_cast<T>(
+      std::min(quantization.clamp_max,
+               static_cast<int32_t>(std::numeric_limits<T>::max())));
 
-  ruy::Mul<ruy::kAllPaths>(a_matrix, b_matrix, spec, &runtime_state->context,
-                           &r_matrix);
-
-  if (transpose_dst) {
-    IREE_TRACE_SCOPE0("MatMul#TransposeDst");
-    // Dims reversed because it is written in col major and the transpose
-    // treats the dims as row major.
-    Transpose2D(r_d1, r_d0, r_data, buffers.dst_buffer.data());
+  std::unique_ptr<T[]> transposed_rhs;
+  std::shared_ptr<RuntimeState::PackedRhs> packed_rhs;
+  RuntimeState::PackedRhsKey packed_rhs_key{
+      buffers.rhs_cache_owner, buffers.rhs_buffer.data(), k, n,
+      RuntimeState::PackingTag<QuantizedMatMul, T>()};
+  if (buffers.rhs_cache_owner) {
+    packed_rhs = runtime_state->LookupPackedRhs(packed_rhs_key);
   }
-  delete[] temp1_buffer;
-  delete[] temp2_buffer;
+  if (packed_rhs) {
+    weights_matrix.data.set(buffers.rhs_buffer.data());
+  } else {
+    IREE_TRACE_SCOPE0("QuantizedMatMul#TransposeRhs");
+    transposed_rhs.reset(new T[k * n]);
+    MatMul::Transpose2D(k, n, buffers.rhs_buffer.data(), transposed_rhs.get());
+    weights_matrix.data.set(transposed_rhs.get());
+  }
+  if (!packed_rhs && buffers.rhs_cache_owner) {
+    IREE_TRACE_SCOPE0("QuantizedMatMul#PackRhs");
+    auto new_packed_rhs = std::make_shared<RuntimeState::PackedRhs>();
+    auto* allocations = &new_packed_rhs->allocations;
+    auto context = runtime_state->AcquireContext();
+    ruy::PrePackForMul<ruy::kAllPaths>(
+        weights_matrix, input_matrix, spec, context.get(), &output_matrix,
+        &new_packed_rhs->prepacked, /*prepacked_rhs=*/nullptr,
+        [allocations](std::size_t size) -> void* {
+          allocations->emplace_back(new uint8_t[size]);
+          return allocations->back().get();
+        });
+    runtime_state->ReleaseContext(std::move(context));
+    packed_rhs = runtime_state->InsertPackedRhs(packed_rhs_key,
+                                                std::move(new_packed_rhs));
+  }
+
+  // Blocks of LHS rows are blocks of ruy RHS/destination columns.
+  const int block_count = runtime_state->ComputeBlockCount(m, n, k);
+  const int rows_per_block = (m + block_count - 1) / block_count;
+  runtime_state->thread_pool->ParallelFor(block_count, [&](int block_index) {
+    const int row_begin = block_index * rows_per_block;
+    const int rows = std::min(m - row_begin, rows_per_block);
+    if (rows <= 0) return;
+
+    ruy::Matrix<T> input_block;
+    ruy::MakeSimpleLayout(k, rows, ruy::Order::kColMajor, &input_block.layout);
+    input_block.data.set(buffers.lhs_buffer.data() +
+                         static_cast<size_t>(row_begin) * k);
+    input_block.zero_point = input_matrix.zero_point;
+    ruy::Matrix<T> output_block;
+    ruy::MakeSimpleLayout(n, rows, ruy::Order::kColMajor,
+                          &output_block.layout);
+    output_block.data.set(buffers.dst_buffer.data() +
+                          static_cast<size_t>(row_begin) * n);
+    output_block.zero_point = output_matrix.zero_point;
+
+    auto context = runtime_state->AcquireContext();
+    if (packed_rhs) {
+      ruy::MulWithPrepacked<ruy::kAllPaths>(
+          weights_matrix, input_block, spec, context.get(), &output_block,
+          &packed_rhs->prepacked, /*prepacked_rhs=*/nullptr);
+    } else {
+      ruy::Mul<ruy::kAllPaths>(weights_matrix, input_block, spec, context.get(),
+                               &output_block);
+    }
+    runtime_state->ReleaseContext(std::move(context));
+  });
 
   return OkStatus();
 }
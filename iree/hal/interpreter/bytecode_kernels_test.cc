@@ -14,6 +14,12 @@
 
 #include "iree/hal/interpreter/bytecode_kernels.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
 #include "iree/base/memory.h"
 #include "iree/base/status_matchers.h"
 #include "iree/testing/gtest.h"
@@ -364,6 +370,130 @@ TEST(Pad, HighRank) {
   EXPECT_EQ(dst_buffer, expected_dst);
 }
 
+// Program computing max(tanh(x * y + z), z) - x for inputs [x, y, z].
+std::vector<int32_t> MakeFusedElementwiseTestProgram() {
+  auto op = [](FusedElementwiseOp op) { return static_cast<int32_t>(op); };
+  // clang-format off
+  return {
+      op(FusedElementwiseOp::kMul),  0, 1, 0,  // r3 = x * y
+      op(FusedElementwiseOp::kAdd),  3, 2, 0,  // r4 = r3 + z
+      op(FusedElementwiseOp::kTanh), 4, 0, 0,  // r5 = tanh(r4)
+      op(FusedElementwiseOp::kMax),  5, 2, 0,  // r6 = max(r5, z)
+      op(FusedElementwiseOp::kSub),  6, 0, 0,  // r7 = r6 - x
+  };
+  // clang-format on
+}
+
+TEST(FusedElementwise, MatchesUnfused) {
+  // Not a multiple of the block size to cover the partial last block.
+  const int size = FusedElementwise::kBlockSize * 3 + 17;
+  std::vector<float> x(size), y(size), z(size);
+  for (int i = 0; i < size; ++i) {
+    x[i] = std::sin(i * 0.1f);
+    y[i] = std::cos(i * 0.3f) * 2.0f;
+    z[i] = (i % 7) * 0.25f - 0.75f;
+  }
+
+  std::vector<float> t0(size), t1(size), t2(size), t3(size), expected(size);
+  EXPECT_OK(Mul::Execute<float>(x, y, absl::MakeSpan(t0)));
+  EXPECT_OK(Add::Execute<float>(t0, z, absl::MakeSpan(t1)));
+  EXPECT_OK(Tanh::Execute<float>(t1, absl::MakeSpan(t2)));
+  EXPECT_OK(Max::Execute<float>(t2, z, absl::MakeSpan(t3)));
+  EXPECT_OK(Sub::Execute<float>(t3, x, absl::MakeSpan(expected)));
+
+  std::vector<absl::Span<const float>> inputs = {x, y, z};
+  std::vector<float> dst(size);
+  EXPECT_OK(FusedElementwise::Execute<float>(
+      inputs, MakeFusedElementwiseTestProgram(), absl::MakeSpan(dst)));
+  for (int i = 0; i < size; ++i) {
+    EXPECT_NEAR(dst[i], expected[i], kEpsilon) << "at " << i;
+  }
+}
+
+TEST(FusedElementwise, InPlace) {
+  const int size = FusedElementwise::kBlockSize + 5;
+  std::vector<double> x = MakeIota<double>(size);
+  std::vector<double> y(size, 0.5), z(size, -2.0);
+  std::vector<double> expected(size);
+  for (int i = 0; i < size; ++i) {
+    expected[i] = std::max(std::tanh(x[i] * y[i] + z[i]), z[i]) - x[i];
+  }
+
+  // The output overwrites the first input.
+  std::vector<absl::Span<const double>> inputs = {x, y, z};
+  EXPECT_OK(FusedElementwise::Execute<double>(
+      inputs, MakeFusedElementwiseTestProgram(), absl::MakeSpan(x)));
+  for (int i = 0; i < size; ++i) {
+    EXPECT_NEAR(x[i], expected[i], kEpsilon) << "at " << i;
+  }
+}
+
+// Large enough that the morsel scheduler splits the work across threads.
+constexpr int kMorselTestSize = 256 * 1024;
+
+TEST(ExecuteMorsels, ElementwiseMatchesSerial) {
+  RuntimeState runtime_state;
+  std::vector<float> lhs(kMorselTestSize), rhs(kMorselTestSize);
+  for (int i = 0; i < kMorselTestSize; ++i) {
+    lhs[i] = i * 0.5f;
+    rhs[i] = (i % 13) - 6.0f;
+  }
+  std::vector<float> expected(kMorselTestSize), dst(kMorselTestSize);
+  EXPECT_OK(Add::Execute<float>(lhs, rhs, absl::MakeSpan(expected)));
+  EXPECT_OK(ExecuteMorsels<Add>(&runtime_state, absl::MakeConstSpan(lhs),
+                                absl::MakeConstSpan(rhs),
+                                absl::MakeSpan(dst)));
+  EXPECT_EQ(dst, expected);
+}
+
+TEST(ExecuteMorsels, Convert) {
+  RuntimeState runtime_state;
+  auto src = MakeIota<int32_t>(kMorselTestSize);
+  std::vector<float> dst(kMorselTestSize);
+  EXPECT_OK(ExecuteMorsels<Convert>(&runtime_state, absl::MakeConstSpan(src),
+                                    absl::MakeSpan(dst)));
+  for (int i = 0; i < kMorselTestSize; ++i) {
+    ASSERT_EQ(dst[i], static_cast<float>(src[i])) << "at " << i;
+  }
+}
+
+TEST(ExecuteMorsels, FusedElementwise) {
+  RuntimeState runtime_state;
+  std::vector<float> x(kMorselTestSize), y(kMorselTestSize, 0.5f),
+      z(kMorselTestSize, -0.25f);
+  for (int i = 0; i < kMorselTestSize; ++i) x[i] = std::sin(i * 0.1f);
+  std::vector<absl::Span<const float>> inputs = {x, y, z};
+  std::vector<float> expected(kMorselTestSize), dst(kMorselTestSize);
+  EXPECT_OK(FusedElementwise::Execute<float>(
+      inputs, MakeFusedElementwiseTestProgram(), absl::MakeSpan(expected)));
+  EXPECT_OK(ExecuteFusedElementwiseMorsels<float>(
+      &runtime_state, inputs, MakeFusedElementwiseTestProgram(),
+      absl::MakeSpan(dst)));
+  EXPECT_EQ(dst, expected);
+}
+
+TEST(ExecuteCopyMorsels, MatchesSerial) {
+  RuntimeState runtime_state;
+  Shape src_shape = {1024, 300};
+  auto src_buffer = MakeIota<uint32_t>(src_shape.element_count());
+  auto src_bytes = ReinterpretSpan<uint8_t>(absl::MakeConstSpan(src_buffer));
+  std::vector<int32_t> src_indices = {7, 20};
+  Shape dst_shape = {1100, 256};
+  std::vector<int32_t> dst_indices = {40, 0};
+  std::vector<int32_t> lengths = {1000, 256};
+  std::vector<uint32_t> expected(dst_shape.element_count());
+  std::vector<uint32_t> dst(dst_shape.element_count());
+  EXPECT_OK(Copy::Execute<4>(
+      src_bytes, src_shape, src_indices,
+      ReinterpretSpan<uint8_t>(absl::MakeSpan(expected)), dst_shape,
+      dst_indices, lengths));
+  EXPECT_OK(ExecuteCopyMorsels<4>(
+      &runtime_state, src_bytes, src_shape, src_indices,
+      ReinterpretSpan<uint8_t>(absl::MakeSpan(dst)), dst_shape, dst_indices,
+      lengths));
+  EXPECT_EQ(dst, expected);
+}
+
 TEST(ReduceSum, Scalar) {
   Shape src_shape = {5};
   int32_t dimension = 0;
@@ -400,6 +530,409 @@ TEST(ReduceMin, TwoDimensionsToOne) {
   }
 }
 
+void ExpectMatMulMatchesReference(RuntimeState* runtime_state, int m, int k,
+                                  int n, const void* rhs_cache_owner) {
+  auto lhs_buffer = MakeIota<float>(m * k);
+  auto rhs_buffer = MakeIota<float>(k * n);
+  for (auto& value : rhs_buffer) value *= 0.01f;
+  std::vector<float> dst_buffer(m * n);
+  MatMul::Buffers<float, float> buffers;
+  buffers.lhs_shape = Shape{m, k};
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = Shape{k, n};
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = Shape{m, n};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  buffers.rhs_cache_owner = rhs_cache_owner;
+  EXPECT_OK(MatMul::Execute(runtime_state->mat_mul_state.get(), buffers));
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      float expected = 0.0f;
+      for (int l = 0; l < k; ++l) {
+        expected += lhs_buffer[i * k + l] * rhs_buffer[l * n + j];
+      }
+      EXPECT_NEAR(expected, dst_buffer[i * n + j],
+                  1e-4f * std::abs(expected) + kEpsilon);
+    }
+  }
+}
+
+TEST(MatMul, Small) {
+  RuntimeState runtime_state;
+  ExpectMatMulMatchesReference(&runtime_state, 3, 4, 5,
+                               /*rhs_cache_owner=*/nullptr);
+}
+
+TEST(MatMul, RowBlocks) {
+  // Large enough to be split across threads.
+  RuntimeOptions options;
+  options.thread_count = 4;
+  RuntimeState runtime_state(options);
+  ExpectMatMulMatchesReference(&runtime_state, 250, 32, 64,
+                               /*rhs_cache_owner=*/nullptr);
+}
+
+TEST(MatMul, CachedRhs) {
+  RuntimeState runtime_state;
+  int owner = 0;
+  ExpectMatMulMatchesReference(&runtime_state, 8, 16, 4, &owner);
+  ExpectMatMulMatchesReference(&runtime_state, 8, 16, 4, &owner);
+  MatMul::ReleaseCachedRhs(runtime_state.mat_mul_state.get(), &owner);
+  ExpectMatMulMatchesReference(&runtime_state, 8, 16, 4, &owner);
+}
+
+// Naive reference convolution used to check the optimized Conv2D paths.
+std::vector<float> ReferenceConv2D(absl::Span<const float> input,
+                                   const Shape& input_shape,
+                                   absl::Span<const float> filter,
+                                   const Shape& filter_shape,
+                                   const Shape& dst_shape,
+                                   const Conv2D::Params& params) {
+  int groups = params.feature_group_count;
+  int group_in_c = filter_shape[2];
+  int out_c = filter_shape[3];
+  int group_out_c = out_c / groups;
+  std::vector<float> dst(dst_shape.element_count(), 0.0f);
+  for (int n = 0; n < dst_shape[0]; ++n) {
+    for (int oy = 0; oy < dst_shape[1]; ++oy) {
+      for (int ox = 0; ox < dst_shape[2]; ++ox) {
+        for (int oc = 0; oc < out_c; ++oc) {
+          int g = oc / group_out_c;
+          float sum = 0.0f;
+          for (int ky = 0; ky < filter_shape[0]; ++ky) {
+            for (int kx = 0; kx < filter_shape[1]; ++kx) {
+              int iy = oy * params.stride_h + ky * params.dilation_h -
+                       params.pad_top;
+              int ix = ox * params.stride_w + kx * params.dilation_w -
+                       params.pad_left;
+              if (iy < 0 || iy >= input_shape[1] || ix < 0 ||
+                  ix >= input_shape[2]) {
+                continue;
+              }
+              for (int ic = 0; ic < group_in_c; ++ic) {
+                int input_i =
+                    ((n * input_shape[1] + iy) * input_shape[2] + ix) *
+                        input_shape[3] +
+                    g * group_in_c + ic;
+                int filter_i =
+                    ((ky * filter_shape[1] + kx) * group_in_c + ic) * out_c +
+                    oc;
+                sum += input[input_i] * filter[filter_i];
+              }
+            }
+          }
+          dst[((n * dst_shape[1] + oy) * dst_shape[2] + ox) * out_c + oc] =
+              sum;
+        }
+      }
+    }
+  }
+  return dst;
+}
+
+void ExpectConv2DMatchesReference(const Shape& input_shape,
+                                  const Shape& filter_shape,
+                                  const Shape& dst_shape,
+                                  const Conv2D::Params& params) {
+  auto input_buffer = MakeIota<float>(input_shape.element_count());
+  auto filter_buffer = MakeIota<float>(filter_shape.element_count());
+  for (auto& value : filter_buffer) value *= 0.01f;
+  std::vector<float> dst_buffer(dst_shape.element_count());
+  auto expected_dst = ReferenceConv2D(input_buffer, input_shape, filter_buffer,
+                                      filter_shape, dst_shape, params);
+
+  RuntimeState runtime_state;
+  EXPECT_OK(Conv2D::Execute<float>(
+      &runtime_state, input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, params));
+  ASSERT_EQ(dst_buffer.size(), expected_dst.size());
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    EXPECT_NEAR(expected_dst[i], dst_buffer[i],
+                1e-4f * std::abs(expected_dst[i]) + kEpsilon);
+  }
+}
+
+TEST(Conv2D, DirectPadded) {
+  Shape input_shape = {1, 3, 3, 1};
+  Shape filter_shape = {3, 3, 1, 1};
+  Shape dst_shape = {1, 3, 3, 1};
+  auto input_buffer = MakeIota<float>(input_shape.element_count());
+  std::vector<float> filter_buffer(filter_shape.element_count(), 1.0f);
+  std::vector<float> dst_buffer(dst_shape.element_count());
+  Conv2D::Params params;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  std::vector<float> expected_dst = {12.0f, 21.0f, 16.0f, 27.0f, 45.0f,
+                                     33.0f, 24.0f, 39.0f, 28.0f};
+
+  RuntimeState runtime_state;
+  EXPECT_OK(Conv2D::Execute<float>(
+      &runtime_state, input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, params));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Conv2D, DirectStrided) {
+  Shape input_shape = {1, 3, 3, 1};
+  Shape filter_shape = {3, 3, 1, 1};
+  Shape dst_shape = {1, 2, 2, 1};
+  auto input_buffer = MakeIota<float>(input_shape.element_count());
+  std::vector<float> filter_buffer(filter_shape.element_count(), 1.0f);
+  std::vector<float> dst_buffer(dst_shape.element_count());
+  Conv2D::Params params;
+  params.stride_h = params.stride_w = 2;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  std::vector<float> expected_dst = {12.0f, 16.0f, 24.0f, 28.0f};
+
+  RuntimeState runtime_state;
+  EXPECT_OK(Conv2D::Execute<float>(
+      &runtime_state, input_buffer, input_shape, filter_buffer,
+      filter_shape, absl::MakeSpan(dst_buffer), dst_shape, params));
+  EXPECT_EQ(dst_buffer, expected_dst);
+}
+
+TEST(Conv2D, DirectDilated) {
+  Conv2D::Params params;
+  params.dilation_h = params.dilation_w = 2;
+  ExpectConv2DMatchesReference({1, 6, 5, 2}, {2, 2, 2, 3}, {1, 4, 3, 3},
+                               params);
+}
+
+TEST(Conv2D, DirectGrouped) {
+  Conv2D::Params params;
+  params.feature_group_count = 2;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  ExpectConv2DMatchesReference({2, 4, 4, 8}, {3, 3, 4, 6}, {2, 4, 4, 6},
+                               params);
+}
+
+TEST(Conv2D, Im2ColPadded) {
+  Conv2D::Params params;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  ExpectConv2DMatchesReference({1, 5, 5, 4}, {3, 3, 4, 3}, {1, 5, 5, 3},
+                               params);
+}
+
+TEST(Conv2D, Im2ColStridedAsymmetricPadding) {
+  Conv2D::Params params;
+  params.stride_h = 2;
+  params.stride_w = 3;
+  params.pad_bottom = 1;
+  params.pad_right = 2;
+  ExpectConv2DMatchesReference({2, 7, 8, 3}, {3, 3, 3, 5}, {2, 3, 3, 5},
+                               params);
+}
+
+TEST(Conv2D, Im2ColMultipleTiles) {
+  // More output rows than Conv2D::kTileRows to exercise tiling.
+  Conv2D::Params params;
+  ExpectConv2DMatchesReference({1, 20, 20, 2}, {3, 3, 2, 4}, {1, 18, 18, 4},
+                               params);
+}
+
+TEST(Conv2D, Pointwise) {
+  Conv2D::Params params;
+  ExpectConv2DMatchesReference({1, 3, 3, 16}, {1, 1, 16, 4}, {1, 3, 3, 4},
+                               params);
+}
+
+// Deterministic int8 values covering most of the type range.
+std::vector<int8_t> MakeQuantizedPattern(int size, int seed) {
+  std::vector<int8_t> v(size);
+  for (int i = 0; i < size; ++i) {
+    v[i] = static_cast<int8_t>((i * 37 + seed) % 255 - 127);
+  }
+  return v;
+}
+
+// Requantizes with a double-precision multiplier. Optimized kernels may differ
+// by one due to fixed-point rounding.
+int32_t ReferenceRequantize(int64_t accumulator, int32_t mantissa,
+                            int32_t exponent,
+                            const QuantizationParams& quantization) {
+  double value = static_cast<double>(accumulator) * mantissa /
+                 (1ll << 31) * std::pow(2.0, exponent);
+  int64_t result =
+      static_cast<int64_t>(std::round(value)) + quantization.dst_zero_point;
+  result = std::max<int64_t>(result, std::max(quantization.clamp_min, -128));
+  result = std::min<int64_t>(result, std::min(quantization.clamp_max, 127));
+  return static_cast<int32_t>(result);
+}
+
+struct QuantizedOutputs {
+  std::vector<int32_t> bias;
+  std::vector<int32_t> multiplier_mantissa;
+  std::vector<int32_t> multiplier_exponent;
+  QuantizationParams quantization;
+};
+
+QuantizedOutputs MakeQuantizedOutputs(int channel_count, bool per_channel) {
+  QuantizedOutputs outputs;
+  for (int i = 0; i < channel_count; ++i) {
+    outputs.bias.push_back(i * 100 - 250);
+  }
+  const int multiplier_count = per_channel ? channel_count : 1;
+  for (int i = 0; i < multiplier_count; ++i) {
+    // 0.5 to 1.0 scaled down by 2^-11 to 2^-13.
+    outputs.multiplier_mantissa.push_back((1 << 30) + i * (1 << 26));
+    outputs.multiplier_exponent.push_back(-11 - i % 3);
+  }
+  outputs.quantization.lhs_zero_point = 3;
+  outputs.quantization.rhs_zero_point = -2;
+  outputs.quantization.dst_zero_point = -5;
+  outputs.quantization.clamp_min = -100;
+  outputs.quantization.clamp_max = 110;
+  return outputs;
+}
+
+void ExpectQuantizedMatMulMatchesReference(int m, int k, int n,
+                                           bool per_channel) {
+  auto lhs_buffer = MakeQuantizedPattern(m * k, 1);
+  auto rhs_buffer = MakeQuantizedPattern(k * n, 2);
+  std::vector<int8_t> dst_buffer(m * n);
+  auto outputs = MakeQuantizedOutputs(n, per_channel);
+  QuantizedMatMul::Buffers<int8_t> buffers;
+  buffers.lhs_shape = Shape{m, k};
+  buffers.lhs_buffer = lhs_buffer;
+  buffers.rhs_shape = Shape{k, n};
+  buffers.rhs_buffer = rhs_buffer;
+  buffers.dst_shape = Shape{m, n};
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  buffers.bias_buffer = outputs.bias;
+  buffers.multiplier_mantissa_buffer = outputs.multiplier_mantissa;
+  buffers.multiplier_exponent_buffer = outputs.multiplier_exponent;
+  buffers.quantization = outputs.quantization;
+  RuntimeState runtime_state;
+  EXPECT_OK(
+      QuantizedMatMul::Execute(runtime_state.mat_mul_state.get(), buffers));
+  const auto& quantization = outputs.quantization;
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      int64_t accumulator = outputs.bias[j];
+      for (int l = 0; l < k; ++l) {
+        accumulator += (lhs_buffer[i * k + l] - quantization.lhs_zero_point) *
+                       (rhs_buffer[l * n + j] - quantization.rhs_zero_point);
+      }
+      const int channel = per_channel ? j : 0;
+      EXPECT_NEAR(ReferenceRequantize(accumulator,
+                                      outputs.multiplier_mantissa[channel],
+                                      outputs.multiplier_exponent[channel],
+                                      quantization),
+                  dst_buffer[i * n + j], 1);
+    }
+  }
+}
+
+TEST(QuantizedMatMul, RequantizeSaturatesLeftShift) {
+  // A positive exponent scales the accumulator up before the fixed-point
+  // multiply; as in gemmlowp large accumulators saturate to the int32 range
+  // there instead of overflowing, and are then halved by the 0.5 mantissa.
+  QuantizationParams quantization;
+  const int32_t kMax = std::numeric_limits<int32_t>::max();
+  const int32_t kMin = std::numeric_limits<int32_t>::min();
+  EXPECT_EQ(1 << 30, impl::Requantize(kMax - 10, 1 << 30, 2, quantization,
+                                      kMin, kMax));
+  EXPECT_EQ(-(1 << 30), impl::Requantize(kMin + 10, 1 << 30, 2, quantization,
+                                         kMin, kMax));
+  EXPECT_EQ(1 << 30, impl::Requantize(kMax, 1 << 30, 40, quantization, kMin,
+                                      kMax));
+  // The zero point is added after saturation without overflowing either.
+  quantization.dst_zero_point = 5;
+  EXPECT_EQ(127, impl::Requantize(kMax - 10, 1 << 30, 1, quantization, -128,
+                                  127));
+  quantization.dst_zero_point = -5;
+  EXPECT_EQ(-128, impl::Requantize(kMin + 10, 1 << 30, 1, quantization, -128,
+                                   127));
+  // In-range values are unaffected: 1000 * 0.5 * 2^3.
+  quantization.dst_zero_point = 0;
+  EXPECT_EQ(4000,
+            impl::Requantize(1000, 1 << 30, 3, quantization, kMin, kMax));
+}
+
+TEST(QuantizedMatMul, PerTensor) {
+  ExpectQuantizedMatMulMatchesReference(5, 7, 3, /*per_channel=*/false);
+}
+
+TEST(QuantizedMatMul, PerChannel) {
+  ExpectQuantizedMatMulMatchesReference(9, 16, 6, /*per_channel=*/true);
+}
+
+void ExpectQuantizedConv2DMatchesReference(const Shape& input_shape,
+                                           const Shape& filter_shape,
+                                           const Shape& dst_shape,
+                                           const Conv2D::Params& params) {
+  auto input_buffer = MakeQuantizedPattern(input_shape.element_count(), 1);
+  auto filter_buffer = MakeQuantizedPattern(filter_shape.element_count(), 2);
+  std::vector<int8_t> dst_buffer(dst_shape.element_count());
+  const int out_c = filter_shape[3];
+  auto outputs = MakeQuantizedOutputs(out_c, /*per_channel=*/true);
+  QuantizedConv2D::Buffers<int8_t> buffers;
+  buffers.input_shape = input_shape;
+  buffers.input_buffer = input_buffer;
+  buffers.filter_shape = filter_shape;
+  buffers.filter_buffer = filter_buffer;
+  buffers.dst_shape = dst_shape;
+  buffers.dst_buffer = absl::MakeSpan(dst_buffer);
+  buffers.bias_buffer = outputs.bias;
+  buffers.multiplier_mantissa_buffer = outputs.multiplier_mantissa;
+  buffers.multiplier_exponent_buffer = outputs.multiplier_exponent;
+  buffers.quantization = outputs.quantization;
+  RuntimeState runtime_state;
+  EXPECT_OK(QuantizedConv2D::Execute(&runtime_state, buffers, params));
+
+  // Zero-point-adjusted float copies let ReferenceConv2D compute the int32
+  // accumulators exactly.
+  const auto& quantization = outputs.quantization;
+  std::vector<float> input_values(input_buffer.size());
+  for (int i = 0; i < input_buffer.size(); ++i) {
+    input_values[i] = input_buffer[i] - quantization.lhs_zero_point;
+  }
+  std::vector<float> filter_values(filter_buffer.size());
+  for (int i = 0; i < filter_buffer.size(); ++i) {
+    filter_values[i] = filter_buffer[i] - quantization.rhs_zero_point;
+  }
+  auto accumulators = ReferenceConv2D(input_values, input_shape, filter_values,
+                                      filter_shape, dst_shape, params);
+  for (int i = 0; i < dst_buffer.size(); ++i) {
+    const int oc = i % out_c;
+    EXPECT_NEAR(
+        ReferenceRequantize(static_cast<int64_t>(accumulators[i]) +
+                                outputs.bias[oc],
+                            outputs.multiplier_mantissa[oc],
+                            outputs.multiplier_exponent[oc], quantization),
+        dst_buffer[i], 1);
+  }
+}
+
+TEST(QuantizedConv2D, DirectGrouped) {
+  Conv2D::Params params;
+  params.feature_group_count = 2;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  ExpectQuantizedConv2DMatchesReference({1, 5, 5, 4}, {3, 3, 2, 6},
+                                        {1, 5, 5, 6}, params);
+}
+
+TEST(QuantizedConv2D, DirectDilated) {
+  // A 2x2 window takes the direct path without a static filter window.
+  Conv2D::Params params;
+  params.dilation_h = params.dilation_w = 2;
+  ExpectQuantizedConv2DMatchesReference({1, 6, 5, 2}, {2, 2, 2, 3},
+                                        {1, 4, 3, 3}, params);
+}
+
+TEST(QuantizedConv2D, Im2ColPadded) {
+  // Padding must use the input zero point to contribute nothing.
+  Conv2D::Params params;
+  params.pad_top = params.pad_bottom = params.pad_left = params.pad_right = 1;
+  ExpectQuantizedConv2DMatchesReference({2, 6, 6, 3}, {3, 3, 3, 5},
+                                        {2, 6, 6, 5}, params);
+}
+
+TEST(QuantizedConv2D, Pointwise) {
+  Conv2D::Params params;
+  ExpectQuantizedConv2DMatchesReference({1, 4, 4, 16}, {1, 1, 16, 8},
+                                        {1, 4, 4, 8}, params);
+}
+
 }  // namespace
 }  // namespace kernels
 }  // namespace hal
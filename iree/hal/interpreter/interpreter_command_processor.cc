@@ -20,6 +20,7 @@
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/buffer_view.h"
+#include "iree/hal/host/perf_counters.h"
 #include "iree/hal/interpreter/bytecode_executable.h"
 #include "iree/rt/stack.h"
 
@@ -36,6 +37,7 @@ InterpreterCommandProcessor::~InterpreterCommandProcessor() = default;
 Status InterpreterCommandProcessor::Dispatch(
     const DispatchRequest& dispatch_request) {
   IREE_TRACE_SCOPE0("InterpreterCommandProcessor::Dispatch");
+  IREE_TRACE_FLOW_STEP("InterpreterCommandProcessor::Dispatch");
 
   // Lookup the exported function.
   auto* executable =
@@ -56,6 +58,8 @@ Status InterpreterCommandProcessor::Dispatch(
   }
   absl::InlinedVector<BufferView, 8> results;
 
+  ScopedDispatchProfile profile_scope(executable->dispatch_profile(),
+                                      entry_function.name());
   RETURN_IF_ERROR(executable->module()->Execute(
       &stack, entry_function, std::move(arguments), &results));
 
@@ -24,6 +24,7 @@
 #include "iree/hal/fence.h"
 #include "iree/hal/host/async_command_queue.h"
 #include "iree/hal/host/host_event.h"
+#include "iree/hal/host/host_memory_pool.h"
 #include "iree/hal/host/host_submission_queue.h"
 #include "iree/hal/host/inproc_command_buffer.h"
 #include "iree/hal/interpreter/bytecode_cache.h"
@@ -96,8 +97,16 @@ class UnsynchronizedCommandQueue final : public CommandQueue {
 
 }  // namespace
 
-InterpreterDevice::InterpreterDevice(DeviceInfo device_info)
-    : Device(std::move(device_info)), instance_(make_ref<rt::Instance>()) {
+InterpreterDevice::InterpreterDevice(DeviceInfo device_info, Options options)
+    : Device(std::move(device_info)),
+      dispatch_profile_(options.profile_dispatches
+                            ? absl::make_unique<DispatchProfile>()
+                            : nullptr),
+      instance_(make_ref<rt::Instance>()),
+      kernel_runtime_state_(std::move(options.kernel_options)),
+      allocator_(info().numa_node() >= 0
+                     ? HostMemoryPool::ForNumaNode(info().numa_node())
+                     : HostMemoryPool::Default()) {
   // We currently only expose a single command queue.
   auto command_queue = absl::make_unique<UnsynchronizedCommandQueue>(
       &allocator_, "cpu0",
@@ -105,15 +114,17 @@ InterpreterDevice::InterpreterDevice(DeviceInfo device_info)
 
   // TODO(benvanik): allow injection of the wrapper type to support
   // SyncCommandQueue without always linking in both.
-  auto async_command_queue =
-      absl::make_unique<AsyncCommandQueue>(std::move(command_queue));
+  auto async_command_queue = absl::make_unique<AsyncCommandQueue>(
+      std::move(command_queue), options.queue_cpu_ids);
   command_queues_.push_back(std::move(async_command_queue));
 }
 
 InterpreterDevice::~InterpreterDevice() = default;
 
 ref_ptr<ExecutableCache> InterpreterDevice::CreateExecutableCache() {
-  return make_ref<BytecodeCache>(add_ref(instance_), &allocator_);
+  return make_ref<BytecodeCache>(add_ref(instance_), &allocator_,
+                                 &kernel_runtime_state_,
+                                 dispatch_profile_.get());
 }
 
 StatusOr<ref_ptr<CommandBuffer>> InterpreterDevice::CreateCommandBuffer(
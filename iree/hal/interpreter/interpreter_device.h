@@ -15,6 +15,9 @@
 #ifndef IREE_HAL_INTERPRETER_INTERPRETER_DEVICE_H_
 #define IREE_HAL_INTERPRETER_INTERPRETER_DEVICE_H_
 
+#include <memory>
+#include <vector>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "iree/base/memory.h"
@@ -28,7 +31,21 @@ namespace hal {
 
 class InterpreterDevice final : public Device {
  public:
-  explicit InterpreterDevice(DeviceInfo device_info);
+  struct Options {
+    // Configures the thread pool shared by all kernels.
+    kernels::RuntimeOptions kernel_options;
+
+    // CPU ids the queue thread is pinned to. Empty leaves it unpinned.
+    std::vector<int> queue_cpu_ids;
+
+    // Records the wall time and hardware performance counters of dispatches
+    // of executables prepared with ExecutableCachingMode::kEnableProfiling.
+    bool profile_dispatches = false;
+  };
+
+  // Devices whose |device_info| has a NUMA node allocate from memory bound to
+  // that node.
+  InterpreterDevice(DeviceInfo device_info, Options options);
   ~InterpreterDevice() override;
 
   kernels::RuntimeState* kernel_runtime_state() {
@@ -47,6 +64,10 @@ class InterpreterDevice final : public Device {
 
   ref_ptr<ExecutableCache> CreateExecutableCache() override;
 
+  DispatchProfile* dispatch_profile() const override {
+    return dispatch_profile_.get();
+  }
+
   StatusOr<ref_ptr<CommandBuffer>> CreateCommandBuffer(
       CommandBufferModeBitfield mode,
       CommandCategoryBitfield command_categories) override;
@@ -67,6 +88,7 @@ class InterpreterDevice final : public Device {
   Status WaitIdle(absl::Time deadline) override;
 
  private:
+  std::unique_ptr<DispatchProfile> dispatch_profile_;
   ref_ptr<rt::Instance> instance_;
   kernels::RuntimeState kernel_runtime_state_;
   mutable HostLocalAllocator allocator_;
@@ -14,8 +14,11 @@
 
 #include "iree/hal/interpreter/interpreter_driver.h"
 
+#include <algorithm>
 #include <memory>
 
+#include "absl/strings/str_cat.h"
+#include "iree/base/status.h"
 #include "iree/hal/device_info.h"
 #include "iree/hal/interpreter/interpreter_device.h"
 
@@ -24,37 +27,89 @@ namespace hal {
 
 namespace {
 
-DeviceInfo GetDefaultDeviceInfo() {
+DeviceFeatureBitfield GetSupportedFeatures() {
   DeviceFeatureBitfield supported_features = DeviceFeature::kNone;
-  // TODO(benvanik): implement debugging/profiling features.
+  // TODO(benvanik): implement debugging/coverage features.
   // supported_features |= DeviceFeature::kDebugging;
   // supported_features |= DeviceFeature::kCoverage;
-  // supported_features |= DeviceFeature::kProfiling;
-  DeviceInfo device_info("interpreter", supported_features);
+  supported_features |= DeviceFeature::kProfiling;
+  return supported_features;
+}
+
+DeviceInfo GetDefaultDeviceInfo() {
+  DeviceInfo device_info("interpreter", GetSupportedFeatures());
   // TODO(benvanik): device info.
   return device_info;
 }
 
+DeviceInfo GetNumaDeviceInfo(const NumaNode& numa_node) {
+  return DeviceInfo(absl::StrCat("interpreter-numa", numa_node.id),
+                    GetSupportedFeatures(),
+                    static_cast<DriverDeviceID>(numa_node.id), numa_node.id);
+}
+
 }  // namespace
 
-InterpreterDriver::InterpreterDriver() : Driver("interpreter") {}
+InterpreterDriver::InterpreterDriver(Options options)
+    : Driver("interpreter"), options_(std::move(options)) {
+  if (options_.numa_devices) {
+    numa_nodes_ = QueryNumaNodes();
+  }
+}
 
 InterpreterDriver::~InterpreterDriver() = default;
 
 StatusOr<std::vector<DeviceInfo>>
 InterpreterDriver::EnumerateAvailableDevices() {
   std::vector<DeviceInfo> device_infos;
-  device_infos.push_back(GetDefaultDeviceInfo());
+  if (!options_.numa_devices) {
+    device_infos.push_back(GetDefaultDeviceInfo());
+    return device_infos;
+  }
+  for (const auto& numa_node : numa_nodes_) {
+    device_infos.push_back(GetNumaDeviceInfo(numa_node));
+  }
   return device_infos;
 }
 
 StatusOr<ref_ptr<Device>> InterpreterDriver::CreateDefaultDevice() {
+  if (options_.numa_devices) {
+    return CreateDevice(static_cast<DriverDeviceID>(numa_nodes_.front().id));
+  }
   return CreateDevice(0);
 }
 
 StatusOr<ref_ptr<Device>> InterpreterDriver::CreateDevice(
     DriverDeviceID device_id) {
-  auto device = make_ref<InterpreterDevice>(GetDefaultDeviceInfo());
+  InterpreterDevice::Options device_options;
+  device_options.kernel_options = options_.kernel_options;
+  device_options.profile_dispatches = options_.profile_dispatches;
+  if (!options_.numa_devices) {
+    auto device = make_ref<InterpreterDevice>(GetDefaultDeviceInfo(),
+                                              std::move(device_options));
+    return device;
+  }
+
+  auto it = std::find_if(numa_nodes_.begin(), numa_nodes_.end(),
+                         [device_id](const NumaNode& numa_node) {
+                           return static_cast<DriverDeviceID>(numa_node.id) ==
+                                  device_id;
+                         });
+  if (it == numa_nodes_.end()) {
+    return NotFoundErrorBuilder(IREE_LOC)
+           << "No interpreter device for NUMA node " << device_id;
+  }
+  const auto& numa_node = *it;
+  auto& kernel_options = device_options.kernel_options;
+  if (!numa_node.cpu_ids.empty()) {
+    kernel_options.worker_cpu_ids = numa_node.cpu_ids;
+    if (kernel_options.thread_count <= 0) {
+      kernel_options.thread_count = static_cast<int>(numa_node.cpu_ids.size());
+    }
+  }
+  device_options.queue_cpu_ids = numa_node.cpu_ids;
+  auto device = make_ref<InterpreterDevice>(GetNumaDeviceInfo(numa_node),
+                                            std::move(device_options));
   return device;
 }
 
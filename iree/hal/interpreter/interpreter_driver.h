@@ -15,14 +15,32 @@
 #ifndef IREE_HAL_INTERPRETER_INTERPRETER_DRIVER_H_
 #define IREE_HAL_INTERPRETER_INTERPRETER_DRIVER_H_
 
+#include <vector>
+
 #include "iree/hal/driver.h"
+#include "iree/hal/host/numa_topology.h"
+#include "iree/hal/interpreter/bytecode_kernels.h"
 
 namespace iree {
 namespace hal {
 
 class InterpreterDriver final : public Driver {
  public:
-  InterpreterDriver();
+  struct Options {
+    // Thread pool configuration used by the kernels of each device.
+    kernels::RuntimeOptions kernel_options;
+
+    // Exposes one device per host NUMA node instead of a single device. Each
+    // device allocates from memory bound to its node and pins its queue and
+    // kernel worker threads to the node's CPUs, overriding worker_cpu_ids.
+    // A thread_count of 0 uses one thread per CPU of the node.
+    bool numa_devices = false;
+
+    // Profiles dispatches on each device; see InterpreterDevice::Options.
+    bool profile_dispatches = false;
+  };
+
+  explicit InterpreterDriver(Options options);
   ~InterpreterDriver() override;
 
   StatusOr<std::vector<DeviceInfo>> EnumerateAvailableDevices() override;
@@ -30,6 +48,12 @@ class InterpreterDriver final : public Driver {
   StatusOr<ref_ptr<Device>> CreateDefaultDevice() override;
 
   StatusOr<ref_ptr<Device>> CreateDevice(DriverDeviceID device_id) override;
+
+ private:
+  Options options_;
+
+  // Nodes that devices are created for when Options::numa_devices is set.
+  std::vector<NumaNode> numa_nodes_;
 };
 
 }  // namespace hal
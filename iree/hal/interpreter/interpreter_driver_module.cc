@@ -13,18 +13,53 @@
 // limitations under the License.
 
 #include <memory>
+#include <string>
 
+#include "absl/flags/flag.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "iree/base/init.h"
 #include "iree/base/status.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/hal/interpreter/interpreter_driver.h"
 
+ABSL_FLAG(int, interpreter_thread_count, 0,
+          "Threads used by interpreter kernels (including the calling thread). "
+          "0 uses one per hardware thread.");
+ABSL_FLAG(std::string, interpreter_worker_cpus, "",
+          "Comma-separated CPU ids that interpreter worker threads are pinned "
+          "to, round-robin. Empty leaves workers unpinned.");
+ABSL_FLAG(bool, interpreter_numa_devices, false,
+          "Exposes one interpreter device per NUMA node with node-local "
+          "memory and threads pinned to the node's CPUs.");
+ABSL_FLAG(bool, interpreter_profile_dispatches, false,
+          "Records the wall time and hardware performance counters (where "
+          "available) of each dispatch, aggregated by executable entry point.");
+
 namespace iree {
 namespace hal {
 namespace {
 
 StatusOr<ref_ptr<Driver>> CreateInterpreterDriver() {
-  return make_ref<InterpreterDriver>();
+  // Setup driver options from flags so that other consumers can set them
+  // however they want.
+  InterpreterDriver::Options options;
+  options.kernel_options.thread_count =
+      absl::GetFlag(FLAGS_interpreter_thread_count);
+  for (auto cpu_id_str :
+       absl::StrSplit(absl::GetFlag(FLAGS_interpreter_worker_cpus), ',',
+                      absl::SkipWhitespace())) {
+    int cpu_id = 0;
+    if (!absl::SimpleAtoi(cpu_id_str, &cpu_id)) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Invalid CPU id in --interpreter_worker_cpus: " << cpu_id_str;
+    }
+    options.kernel_options.worker_cpu_ids.push_back(cpu_id);
+  }
+  options.numa_devices = absl::GetFlag(FLAGS_interpreter_numa_devices);
+  options.profile_dispatches =
+      absl::GetFlag(FLAGS_interpreter_profile_dispatches);
+  return make_ref<InterpreterDriver>(std::move(options));
 }
 
 }  // namespace
@@ -25,26 +25,35 @@ namespace hal {
 
 // static
 StatusOr<ref_ptr<rt::Module>> InterpreterModule::FromDef(
-    hal::Allocator* allocator, const ModuleDef& module_def) {
+    hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+    const ModuleDef& module_def) {
   ASSIGN_OR_RETURN(auto module_file,
                    vm::ModuleFile::Create(&module_def, []() {}));
   if (module_file->root() == nullptr) {
     return InvalidArgumentErrorBuilder(IREE_LOC) << "No root ModuleDef present";
   }
 
-  auto module =
-      assign_ref(new InterpreterModule(allocator, std::move(module_file)));
+  auto module = assign_ref(new InterpreterModule(
+      allocator, kernel_runtime_state, std::move(module_file)));
 
   // TODO(benvanik): validate internals here? or make explicit?
 
   return {std::move(module)};
 }
 
-InterpreterModule::InterpreterModule(hal::Allocator* allocator,
-                                     ref_ptr<vm::ModuleFile> module_file)
+InterpreterModule::InterpreterModule(
+    hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+    ref_ptr<vm::ModuleFile> module_file)
     : vm::BytecodeModule(std::move(module_file),
                          vm::interpreter_opcode_table()),
-      allocator_(allocator) {}
+      allocator_(allocator),
+      kernel_runtime_state_(kernel_runtime_state) {}
+
+InterpreterModule::~InterpreterModule() {
+  // Packed constants are keyed on the module that owns their bytecode.
+  kernels::MatMul::ReleaseCachedRhs(kernel_runtime_state_->mat_mul_state.get(),
+                                    static_cast<const rt::Module*>(this));
+}
 
 Status InterpreterModule::Execute(
     rt::Stack* stack, const rt::Function function,
@@ -67,7 +76,7 @@ Status InterpreterModule::Execute(
   }
 
   // Run main dispatch loop until it exits (or errors).
-  RETURN_IF_ERROR(Dispatch(allocator_, &kernel_runtime_state_, stack,
+  RETURN_IF_ERROR(Dispatch(allocator_, kernel_runtime_state_, stack,
                            callee_stack_frame, absl::MakeSpan(*results)));
 
   // Pop the callee frame to balance out the stack.
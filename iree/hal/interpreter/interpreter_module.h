@@ -33,8 +33,12 @@ namespace hal {
 
 class InterpreterModule final : public vm::BytecodeModule {
  public:
-  static StatusOr<ref_ptr<rt::Module>> FromDef(hal::Allocator* allocator,
-                                               const ModuleDef& module_def);
+  // |kernel_runtime_state| is owned by the device and must outlive the module.
+  static StatusOr<ref_ptr<rt::Module>> FromDef(
+      hal::Allocator* allocator, kernels::RuntimeState* kernel_runtime_state,
+      const ModuleDef& module_def);
+
+  ~InterpreterModule() override;
 
   Status Execute(
       rt::Stack* stack, const rt::Function function,
@@ -43,10 +47,11 @@ class InterpreterModule final : public vm::BytecodeModule {
 
  private:
   InterpreterModule(hal::Allocator* allocator,
+                    kernels::RuntimeState* kernel_runtime_state,
                     ref_ptr<vm::ModuleFile> module_file);
 
   hal::Allocator* allocator_;
-  mutable kernels::RuntimeState kernel_runtime_state_;
+  kernels::RuntimeState* kernel_runtime_state_;
 };
 
 }  // namespace hal
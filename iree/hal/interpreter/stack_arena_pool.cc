@@ -0,0 +1,75 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/stack_arena_pool.h"
+
+#include "absl/memory/memory.h"
+#include "iree/base/tracing.h"
+
+namespace iree {
+namespace hal {
+
+StackArena::StackArena(ref_ptr<Buffer> buffer) : buffer_(std::move(buffer)) {}
+
+StatusOr<ref_ptr<Buffer>> StackArena::Subspan(device_size_t byte_offset,
+                                              device_size_t byte_length) {
+  auto key = std::make_pair(byte_offset, byte_length);
+  auto it = subspans_.find(key);
+  if (it != subspans_.end()) {
+    return add_ref(it->second);
+  }
+  ASSIGN_OR_RETURN(auto subspan,
+                   Buffer::Subspan(buffer_, byte_offset, byte_length));
+  subspans_.emplace(key, add_ref(subspan));
+  return subspan;
+}
+
+StackArenaPool::StackArenaPool() = default;
+
+StackArenaPool::~StackArenaPool() = default;
+
+StatusOr<std::unique_ptr<StackArena>> StackArenaPool::Acquire(
+    Allocator* allocator, device_size_t size) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = free_arenas_.find(size);
+    if (it != free_arenas_.end() && !it->second.empty()) {
+      auto arena = std::move(it->second.back());
+      it->second.pop_back();
+      return arena;
+    }
+    ++allocation_count_;
+  }
+
+  IREE_TRACE_SCOPE0("StackArenaPool::Acquire");
+  ASSIGN_OR_RETURN(
+      auto buffer,
+      allocator->Allocate(MemoryType::kHostLocal | MemoryType::kDeviceVisible,
+                          BufferUsage::kAll, size));
+  return absl::make_unique<StackArena>(std::move(buffer));
+}
+
+void StackArenaPool::Release(std::unique_ptr<StackArena> arena) {
+  if (!arena) return;
+  absl::MutexLock lock(&mutex_);
+  free_arenas_[arena->size()].push_back(std::move(arena));
+}
+
+int StackArenaPool::allocation_count() const {
+  absl::MutexLock lock(&mutex_);
+  return allocation_count_;
+}
+
+}  // namespace hal
+}  // namespace iree
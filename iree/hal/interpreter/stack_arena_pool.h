@@ -0,0 +1,94 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_HAL_INTERPRETER_STACK_ARENA_POOL_H_
+#define IREE_HAL_INTERPRETER_STACK_ARENA_POOL_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "iree/base/ref_ptr.h"
+#include "iree/base/status.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
+
+namespace iree {
+namespace hal {
+
+// Scratch memory backing the alloc_stack allocations of a single function
+// invocation. The compiler assigns each allocation a fixed offset in the arena
+// so the same sub-spans are requested by every invocation of the function.
+//
+// StackArena is thread-compatible.
+class StackArena final {
+ public:
+  explicit StackArena(ref_ptr<Buffer> buffer);
+
+  StackArena(const StackArena&) = delete;
+  StackArena& operator=(const StackArena&) = delete;
+
+  // Total size of the arena in bytes.
+  device_size_t size() const { return buffer_->byte_length(); }
+
+  // Returns a buffer referencing |byte_length| bytes at |byte_offset| within
+  // the arena. Sub-spans are cached so that repeated requests for the same
+  // range (as made by each invocation of a function) do not allocate.
+  StatusOr<ref_ptr<Buffer>> Subspan(device_size_t byte_offset,
+                                    device_size_t byte_length);
+
+ private:
+  ref_ptr<Buffer> buffer_;
+  absl::flat_hash_map<std::pair<device_size_t, device_size_t>, ref_ptr<Buffer>>
+      subspans_;
+};
+
+// A pool of StackArenas shared by all fibers executing on a device.
+// Arenas are returned to the pool when the function invocation using them
+// completes and are reused by the next invocation requiring the same size.
+//
+// StackArenaPool is thread-safe.
+class StackArenaPool final {
+ public:
+  StackArenaPool();
+  ~StackArenaPool();
+
+  StackArenaPool(const StackArenaPool&) = delete;
+  StackArenaPool& operator=(const StackArenaPool&) = delete;
+
+  // Acquires an arena of exactly |size| bytes, allocating one from
+  // |allocator| if none are available in the pool.
+  StatusOr<std::unique_ptr<StackArena>> Acquire(Allocator* allocator,
+                                                device_size_t size);
+
+  // Returns |arena| to the pool for reuse.
+  void Release(std::unique_ptr<StackArena> arena);
+
+  // Total number of arenas allocated by the pool.
+  int allocation_count() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<device_size_t, std::vector<std::unique_ptr<StackArena>>>
+      free_arenas_ ABSL_GUARDED_BY(mutex_);
+  int allocation_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_INTERPRETER_STACK_ARENA_POOL_H_
@@ -0,0 +1,90 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/interpreter/stack_arena_pool.h"
+
+#include "iree/base/status_matchers.h"
+#include "iree/hal/host/host_local_allocator.h"
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Tests that released arenas are reused by later acquisitions of the same size.
+TEST(StackArenaPoolTest, ReusesReleasedArenas) {
+  HostLocalAllocator allocator;
+  StackArenaPool pool;
+
+  ASSERT_OK_AND_ASSIGN(auto arena, pool.Acquire(&allocator, 256));
+  EXPECT_EQ(256, arena->size());
+  auto* arena_ptr = arena.get();
+  pool.Release(std::move(arena));
+  EXPECT_EQ(1, pool.allocation_count());
+
+  ASSERT_OK_AND_ASSIGN(arena, pool.Acquire(&allocator, 256));
+  EXPECT_EQ(arena_ptr, arena.get());
+  EXPECT_EQ(1, pool.allocation_count());
+
+  // A different size requires a new arena.
+  ASSERT_OK_AND_ASSIGN(auto other_arena, pool.Acquire(&allocator, 128));
+  EXPECT_EQ(128, other_arena->size());
+  EXPECT_EQ(2, pool.allocation_count());
+
+  pool.Release(std::move(arena));
+  pool.Release(std::move(other_arena));
+}
+
+// Tests that concurrent acquisitions get distinct arenas.
+TEST(StackArenaPoolTest, ConcurrentAcquisitions) {
+  HostLocalAllocator allocator;
+  StackArenaPool pool;
+
+  ASSERT_OK_AND_ASSIGN(auto arena_0, pool.Acquire(&allocator, 64));
+  ASSERT_OK_AND_ASSIGN(auto arena_1, pool.Acquire(&allocator, 64));
+  EXPECT_NE(arena_0.get(), arena_1.get());
+  EXPECT_EQ(2, pool.allocation_count());
+
+  pool.Release(std::move(arena_0));
+  pool.Release(std::move(arena_1));
+  ASSERT_OK_AND_ASSIGN(arena_0, pool.Acquire(&allocator, 64));
+  ASSERT_OK_AND_ASSIGN(arena_1, pool.Acquire(&allocator, 64));
+  EXPECT_EQ(2, pool.allocation_count());
+}
+
+// Tests that sub-spans alias the arena storage and are cached.
+TEST(StackArenaTest, Subspan) {
+  HostLocalAllocator allocator;
+  StackArenaPool pool;
+  ASSERT_OK_AND_ASSIGN(auto arena, pool.Acquire(&allocator, 256));
+
+  ASSERT_OK_AND_ASSIGN(auto subspan_0, arena->Subspan(64, 16));
+  EXPECT_EQ(16, subspan_0->byte_length());
+  ASSERT_OK_AND_ASSIGN(auto subspan_1, arena->Subspan(64, 16));
+  EXPECT_EQ(subspan_0.get(), subspan_1.get());
+
+  // Overlapping sub-spans see each other's writes.
+  ASSERT_OK_AND_ASSIGN(auto subspan_2, arena->Subspan(60, 8));
+  uint32_t value = 0x12345678;
+  ASSERT_OK(subspan_0->WriteData(0, &value, sizeof(value)));
+  uint32_t read_value = 0;
+  ASSERT_OK(subspan_2->ReadData(4, &read_value, sizeof(read_value)));
+  EXPECT_EQ(value, read_value);
+
+  EXPECT_FALSE(arena->Subspan(250, 16).ok());
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
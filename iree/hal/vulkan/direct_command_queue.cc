@@ -114,11 +114,13 @@ Status DirectCommandQueue::Submit(absl::Span<const SubmissionBatch> batches,
 
   // Map the submission batches to VkSubmitInfos.
   // Note that we must keep all arrays referenced alive until submission
-  // completes and since there are a bunch of them we use an arena.
-  Arena arena(4 * 1024);
-  auto submit_infos = arena.AllocateSpan<VkSubmitInfo>(batches.size());
+  // completes and since there are a bunch of them we use an arena. The thread
+  // arena reuses its blocks across submissions.
+  ThreadLocalArena arena;
+  auto submit_infos = arena->AllocateSpan<VkSubmitInfo>(batches.size());
   for (int i = 0; i < batches.size(); ++i) {
-    RETURN_IF_ERROR(TranslateBatchInfo(batches[i], &submit_infos[i], &arena));
+    RETURN_IF_ERROR(
+        TranslateBatchInfo(batches[i], &submit_infos[i], arena.get()));
   }
 
   // TODO(b/140141417): implement timeline semaphore fences and switch here.
@@ -205,9 +205,21 @@ StatusOr<ref_ptr<VmaBuffer>> VmaAllocator::AllocateInternal(
                                      &allocation_create_info, &buffer,
                                      &allocation, &allocation_info));
 
-  return make_ref<VmaBuffer>(this, memory_type, allowed_access, buffer_usage,
-                             allocation_size, 0, allocation_size, buffer,
-                             allocation, allocation_info);
+  auto vma_buffer = make_ref<VmaBuffer>(
+      this, memory_type, allowed_access, buffer_usage, allocation_size, 0,
+      allocation_size, buffer, allocation, allocation_info);
+  TrackAllocation(vma_buffer.get());
+  return vma_buffer;
+}
+
+AllocatorStatistics VmaAllocator::statistics() const {
+  auto statistics = Allocator::statistics();
+  VmaStats vma_stats;
+  vmaCalculateStats(vma_, &vma_stats);
+  statistics.backing_bytes_reserved =
+      vma_stats.total.usedBytes + vma_stats.total.unusedBytes;
+  statistics.backing_bytes_used = vma_stats.total.usedBytes;
+  return statistics;
 }
 
 StatusOr<ref_ptr<Buffer>> VmaAllocator::Allocate(
@@ -84,6 +84,9 @@ class VmaAllocator final : public Allocator {
                                         void* data,
                                         size_t data_length) override;
 
+  // Includes the VMA device memory blocks as the backing memory.
+  AllocatorStatistics statistics() const override;
+
  private:
   VmaAllocator(VkPhysicalDevice physical_device,
                const ref_ptr<VkDeviceHandle>& logical_device,
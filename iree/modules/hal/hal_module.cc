@@ -37,6 +37,28 @@ static void ResetStackFrame(iree_vm_stack_frame_t* frame) {
   }
 }
 
+// Alignment required of constant data to be used in place by kernels.
+// Matches the minimum alignment of rodata segments emitted by the compiler.
+constexpr uintptr_t kConstantDataAlignment = 16;
+
+// Returns true if |value_data| can be wrapped as a read-only buffer of
+// |allocation_size| bytes instead of being copied into a new allocation.
+// Only module-owned data is wrapped: module rodata segments are never mutated
+// and live as long as their module, which the wrapping buffer retains.
+static bool CanWrapConstantData(const iree_vm_ro_byte_buffer_t* value_data,
+                                iree_device_size_t allocation_size) {
+  return value_data->destroy == nullptr && value_data->module != nullptr &&
+         value_data->data.data_length == allocation_size &&
+         reinterpret_cast<uintptr_t>(value_data->data.data) %
+                 kConstantDataAlignment ==
+             0;
+}
+
+// Releases the module retained by a buffer wrapping its constant data.
+static void ReleaseConstantDataModule(void* self, iree_byte_span_t data) {
+  iree_vm_module_release(static_cast<iree_vm_module_t*>(self));
+}
+
 // Pretty prints an array, e.g. [1, 2, 3, 4]
 static std::string PrettyPrint(absl::Span<const int32_t> arr) {
   return "[" + absl::StrJoin(arr, ",") + "]";
@@ -467,17 +489,41 @@ Status HALModuleState::AllocatorAllocateConst(iree_vm_stack_t* stack,
   }
 
   iree_hal_buffer_t* buffer = nullptr;
-  RETURN_IF_ERROR(FromApiStatus(
-      iree_hal_allocator_allocate_buffer(allocator, memory_types, buffer_usage,
-                                         allocation_size, &buffer),
-      IREE_LOC))
-      << "Failed to allocate buffer";
-
-  RETURN_IF_ERROR(
-      FromApiStatus(iree_hal_buffer_write_data(buffer, 0, value_data->data.data,
-                                               value_data->data.data_length),
-                    IREE_LOC))
-      << "Writing constant data";
+  if (CanWrapConstantData(value_data, allocation_size)) {
+    // Reference the constant data in place, which for mapped modules means it
+    // is paged in only when used and is shared with other processes. The
+    // buffer retains the module so that the data outlives the context (and
+    // any mapping of the module file) for as long as the buffer is in use.
+    // Devices that can't access host memory directly will fail and fall back
+    // to a copy.
+    iree_byte_span_t data = {const_cast<uint8_t*>(value_data->data.data),
+                             value_data->data.data_length};
+    iree_hal_buffer_release_callback_t release_callback = {
+        value_data->module, ReleaseConstantDataModule};
+    iree_vm_module_retain(value_data->module);
+    if (iree_hal_allocator_wrap_buffer_with_release(
+            allocator, memory_types, IREE_HAL_MEMORY_ACCESS_READ,
+            static_cast<iree_hal_buffer_usage_t>(
+                buffer_usage | IREE_HAL_BUFFER_USAGE_CONSTANT),
+            data, release_callback, &buffer) != IREE_STATUS_OK) {
+      iree_vm_module_release(value_data->module);
+      buffer = nullptr;
+    }
+  }
+  if (!buffer) {
+    RETURN_IF_ERROR(FromApiStatus(
+        iree_hal_allocator_allocate_buffer(allocator, memory_types,
+                                           buffer_usage, allocation_size,
+                                           &buffer),
+        IREE_LOC))
+        << "Failed to allocate buffer";
+
+    RETURN_IF_ERROR(FromApiStatus(
+        iree_hal_buffer_write_data(buffer, 0, value_data->data.data,
+                                   value_data->data.data_length),
+        IREE_LOC))
+        << "Writing constant data";
+  }
 
   ResetStackFrame(frame);
   frame->return_registers = &kReturnRef.list;
@@ -93,9 +93,23 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_rt_instance_register_driver_ex(
   LOG(INFO) << "Creating default device...";
   IREE_API_ASSIGN_OR_RETURN(auto device, driver->CreateDefaultDevice());
   LOG(INFO) << "Successfully created device '" << device->info().name() << "'";
+  hal::DriverDeviceID default_device_id = device->info().device_id();
   IREE_API_RETURN_IF_ERROR(
       handle->device_manager()->RegisterDevice(std::move(device)));
 
+  // Devices bound to other NUMA nodes are registered as well so that placement
+  // can pick the device local to the calling thread.
+  for (const auto& device_info : available_devices) {
+    if (device_info.numa_node() < 0 ||
+        device_info.device_id() == default_device_id) {
+      continue;
+    }
+    IREE_API_ASSIGN_OR_RETURN(auto numa_device,
+                              driver->CreateDevice(device_info.device_id()));
+    IREE_API_RETURN_IF_ERROR(
+        handle->device_manager()->RegisterDevice(std::move(numa_device)));
+  }
+
   return IREE_STATUS_OK;
 }
 
@@ -578,6 +592,49 @@ iree_rt_context_allocate_device_visible_buffer(
   return IREE_STATUS_OK;
 }
 
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_rt_context_wrap_device_visible_buffer(
+    iree_rt_context_t* context, iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t buffer_usage, iree_byte_span_t data,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_TRACE_SCOPE0("iree_rt_context_wrap_device_visible_buffer");
+
+  if (!out_buffer) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+  std::memset(out_buffer, 0, sizeof(*out_buffer));
+
+  const auto* handle = reinterpret_cast<const Context*>(context);
+  if (!handle) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  } else if (!data.data || !data.data_length || !release_callback.release) {
+    return IREE_STATUS_INVALID_ARGUMENT;
+  }
+
+  // TODO(benvanik): reroute to context based on current policy.
+  auto* device_manager = handle->instance()->device_manager();
+  IREE_API_ASSIGN_OR_RETURN(auto device_placement,
+                            device_manager->ResolvePlacement({}));
+  auto memory_type =
+      hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible;
+  auto usage = static_cast<hal::BufferUsage>(buffer_usage);
+  IREE_API_ASSIGN_OR_RETURN(auto* allocator,
+                            device_manager->FindCompatibleAllocator(
+                                memory_type, usage, {device_placement}));
+  IREE_API_ASSIGN_OR_RETURN(
+      auto buffer,
+      allocator->WrapMutableWithRelease(
+          memory_type, static_cast<hal::MemoryAccessBitfield>(allowed_access),
+          usage, data.data, data.data_length, [release_callback, data]() {
+            release_callback.release(release_callback.self, data);
+          }));
+
+  *out_buffer = reinterpret_cast<iree_hal_buffer_t*>(buffer.release());
+
+  return IREE_STATUS_OK;
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL
 iree_rt_context_allocate_device_local_buffer(
     iree_rt_context_t* context, iree_hal_buffer_usage_t buffer_usage,
@@ -304,6 +304,19 @@ iree_rt_context_allocate_device_visible_buffer(
     iree_host_size_t allocation_size, iree_allocator_t allocator,
     iree_hal_buffer_t** out_buffer);
 
+// Wraps existing host memory in a buffer usable by the context devices without
+// a copy. |release_callback| is called once the buffer has been destroyed.
+//
+// Fails if no device allocator can access host memory in this way, in which
+// case |release_callback| is not called and the caller retains ownership.
+// |out_buffer| must be released by the caller.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_rt_context_wrap_device_visible_buffer(
+    iree_rt_context_t* context, iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t buffer_usage, iree_byte_span_t data,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer);
+
 // Allocates a device-local buffer that is optimal for use with the given
 // |device_placements|. The buffer will not be host-visible and can only be
 // used from compatible device queues.
@@ -20,6 +20,7 @@
 #include "absl/strings/str_cat.h"
 #include "iree/base/status.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/allocator_statistics.h"
 #include "iree/rt/context.h"
 
 namespace iree {
@@ -41,6 +42,7 @@ StatusOr<ref_ptr<Invocation>> Invocation::Create(
     absl::InlinedVector<hal::BufferView, 8> arguments,
     absl::optional<absl::InlinedVector<hal::BufferView, 8>> results) {
   IREE_TRACE_SCOPE0("Invocation::Create");
+  IREE_TRACE_FLOW_BEGIN("Invocation::Create");
 
   const auto& signature = function.signature();
   if (arguments.size() != signature.argument_count()) {
@@ -71,6 +73,8 @@ StatusOr<ref_ptr<Invocation>> Invocation::Create(
   }
 
   // TODO(benvanik): fiber scheduling and such.
+  // Buffers allocated while executing are attributed to the function.
+  hal::AllocationTagScope allocation_tag_scope(function.name());
   auto execute_status = function.module()->Execute(
       &invocation->stack_, function, std::move(arguments), &results_value);
   if (execute_status.ok()) {
@@ -48,6 +48,7 @@ namespace iree {
   TYP(0x04, kF16, "f16", 2)                      \
   TYP(0x05, kF32, "f32", 4)                      \
   TYP(0x06, kF64, "f64", 8)                      \
+  TYP(0x07, kBF16, "bf16", 2)                    \
   TYP(0x80, kDevice, "device", 0)                \
   TYP(0x81, kCommandBuffer, "command_buffer", 0) \
   TYP(0x82, kEvent, "event", 0)                  \
@@ -107,7 +108,18 @@ enum class CmpFPredicate : uint8_t { IREE_CMPF_PREDICATE_LIST(DECLARE_ENUM) };
 #undef DECLARE_ENUM
 
 static constexpr uint8_t kBuiltinTypeCount =
-    static_cast<uint8_t>(BuiltinType::kF64) + 1;
+    static_cast<uint8_t>(BuiltinType::kBF16) + 1;
+
+// Flags passed as the heap type operand of alloc_heap (and alloc_stack in the
+// interpreter).
+enum class AllocHeapFlag : int32_t {
+  kDefault = 0,
+  // The contents of the allocation are undefined. The compiler sets this when
+  // it has proven that every element is written before it is read.
+  kUninitialized = 1 << 0,
+};
+IREE_BITFIELD(AllocHeapFlag);
+using AllocHeapFlagBitfield = AllocHeapFlag;
 
 enum class OpcodeFlag : uint8_t {
   kDefault = 0,
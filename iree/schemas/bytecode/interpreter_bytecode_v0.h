@@ -72,8 +72,9 @@ namespace iree {
   RSV(0x1F, RESERVED_OPC)                                                     \
                                                                               \
   OPC(0x20, kAllocStatic, "alloc_static", FLAG(kDefault), "Icr", FF)          \
-  OPC(0x21, kAllocStack, "alloc_stack", FLAG(kDefault), "itISr", FF)          \
-  OPC(0x22, kAllocStackInit, "alloc_stack_init", FLAG(kDefault), "tIScr", FF) \
+  OPC(0x21, kAllocStack, "alloc_stack", FLAG(kDefault), "iitISr", FF)         \
+  OPC(0x22, kAllocStackInit, "alloc_stack_init", FLAG(kDefault), "itIScr",    \
+      FF)                                                                     \
   OPC(0x23, kAllocHeap, "alloc_heap", FLAG(kDefault), "itISr", FF)            \
   OPC(0x24, kDiscard, "discard", FLAG(kDefault), "s", FF)                     \
                                                                               \
@@ -216,7 +217,6 @@ namespace iree {
                                                                               \
   OPC(0xA0, kMatMulI, "matmul_i", FLAG(kDefault), "sssso", FF)                \
   OPC(0xA1, kMatMulF, "matmul_f", FLAG(kDefault), "sso", FF)                  \
-  /* TODO(benvanik): convolution */                                           \
                                                                               \
   OPC(0xA2, kReduceSumI, "reduce_sum_i", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA3, kReduceSumF, "reduce_sum_f", FLAG(kDefault), "ssio", FF)          \
@@ -224,10 +224,11 @@ namespace iree {
   OPC(0xA5, kReduceMinF, "reduce_min_f", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA6, kReduceMaxI, "reduce_max_i", FLAG(kDefault), "ssio", FF)          \
   OPC(0xA7, kReduceMaxF, "reduce_max_f", FLAG(kDefault), "ssio", FF)          \
-  RSV(0xA8, RESERVED_OPC)                                                     \
-  RSV(0xA9, RESERVED_OPC)                                                     \
-  RSV(0xAA, RESERVED_OPC)                                                     \
-  RSV(0xAB, RESERVED_OPC)                                                     \
+  OPC(0xA8, kConv2DF, "conv2d_f", FLAG(kDefault), "ssIIIio", FF)              \
+  OPC(0xA9, kMatMulQ, "matmul_q", FLAG(kDefault), "sssssiiiiio", FF)          \
+  OPC(0xAA, kConv2DQ, "conv2d_q", FLAG(kDefault), "sssssIIIiiiiiio", FF)      \
+  OPC(0xAB, kFusedElementwiseF, "fused_elementwise_f", FLAG(kDefault), "SIo", \
+      FF)                                                                     \
   RSV(0xAC, RESERVED_OPC)                                                     \
   RSV(0xAD, RESERVED_OPC)                                                     \
   RSV(0xAE, RESERVED_OPC)                                                     \
@@ -320,6 +321,49 @@ enum class InterpreterOpcode : uint8_t {
 };
 #undef DECLARE_ENUM
 
+// alloc_stack and alloc_stack_init take the byte offset of the allocation within
+// the stack arena of the function, which is BytecodeDef::stack_size bytes and
+// reused by each invocation of the function. Offsets are assigned by the
+// compiler such that allocations with overlapping lifetimes do not overlap.
+// alloc_stack is preceded by AllocHeapFlag bits as with alloc_heap: as the
+// arena is reused its range is zeroed unless kUninitialized is set.
+
+// Operations of a fused_elementwise_f program. Each instruction is encoded as
+// kFusedElementwiseInstructionSize int32 values: [op, a, b, c], where a/b/c are
+// the register indices of the operands (unused operands are 0). Registers
+// [0, input count) hold the op inputs and instruction i writes register
+// input count + i. The register written by the last instruction is the result.
+//
+// Semantics match the standalone float opcodes (such as add_f and madd_f).
+#define IREE_FUSED_ELEMENTWISE_OP_LIST(OP) \
+  OP(0, kAdd, "add_f", 2)                  \
+  OP(1, kSub, "sub_f", 2)                  \
+  OP(2, kMul, "mul_f", 2)                  \
+  OP(3, kDiv, "div_f", 2)                  \
+  OP(4, kRem, "rem_f", 2)                  \
+  OP(5, kMin, "min_f", 2)                  \
+  OP(6, kMax, "max_f", 2)                  \
+  OP(7, kAbs, "abs_f", 1)                  \
+  OP(8, kExp, "exp_f", 1)                  \
+  OP(9, kLog, "log_f", 1)                  \
+  OP(10, kRsqrt, "rsqrt_f", 1)             \
+  OP(11, kSqrt, "sqrt_f", 1)               \
+  OP(12, kCos, "cos_f", 1)                 \
+  OP(13, kSin, "sin_f", 1)                 \
+  OP(14, kTanh, "tanh_f", 1)               \
+  OP(15, kFloor, "floor_f", 1)             \
+  OP(16, kCeil, "ceil_f", 1)               \
+  OP(17, kMulAdd, "madd_f", 3)             \
+  OP(18, kClamp, "clamp_f", 3)
+
+#define DECLARE_ENUM(ordinal, enum_name, ...) enum_name = ordinal,
+enum class FusedElementwiseOp : int32_t {
+  IREE_FUSED_ELEMENTWISE_OP_LIST(DECLARE_ENUM)
+};
+#undef DECLARE_ENUM
+
+constexpr int kFusedElementwiseInstructionSize = 4;
+
 }  // namespace iree
 
 #endif  // IREE_SCHEMAS_BYTECODE_INTERPRETER_BYTECODE_V0_H_
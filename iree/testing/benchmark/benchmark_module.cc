@@ -14,11 +14,21 @@
 
 #include "iree/testing/benchmark/benchmark_module.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
 #include "benchmark/benchmark.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
 #include "iree/hal/buffer_view.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/rt/context.h"
@@ -29,61 +39,94 @@
 namespace iree {
 namespace {
 
-StatusOr<hal::BufferView> BufferViewFromConstant(const ShapedBuffer& buf_data,
-                                                 hal::Allocator* allocator) {
-  hal::BufferView view;
-  view.element_size = buf_data.element_size();
-  view.shape = buf_data.shape();
+// Returns views of |host_arguments| usable by the device owning |allocator|.
+StatusOr<std::vector<hal::BufferView>> DeviceBufferViews(
+    absl::Span<const hal::BufferView> host_arguments,
+    hal::Allocator* allocator) {
+  std::vector<hal::BufferView> views;
+  views.reserve(host_arguments.size());
+  for (const auto& host_view : host_arguments) {
+    hal::BufferView view = host_view;
+    if (view.buffer) {
+      ASSIGN_OR_RETURN(view.buffer,
+                       allocator->AllocateConstant(
+                           hal::BufferUsage::kAll | hal::BufferUsage::kConstant,
+                           add_ref(host_view.buffer)));
+    }
+    views.push_back(std::move(view));
+  }
+  return views;
+}
 
-  size_t allocation_size = view.shape.element_count() * view.element_size;
-  ASSIGN_OR_RETURN(
-      view.buffer,
-      allocator->Allocate(
-          hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible,
-          hal::BufferUsage::kAll | hal::BufferUsage::kConstant,
-          allocation_size));
+using Clock = std::chrono::steady_clock;
 
-  RETURN_IF_ERROR(view.buffer->WriteData(0, buf_data.contents().data(),
-                                         buf_data.contents().size()));
+int64_t NanosecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
 
-  return view;
+// Invokes the main function as soon as the previous invocation completes
+// until |end_time|.
+Status RunClosedLoop(ModuleBenchmark* module_benchmark,
+                     const ref_ptr<rt::Context>& context,
+                     Clock::time_point end_time,
+                     LatencyHistogram* latency_ns) {
+  while (true) {
+    auto start_time = Clock::now();
+    if (start_time >= end_time) break;
+    RETURN_IF_ERROR(module_benchmark->Invoke(context));
+    latency_ns->Record(NanosecondsBetween(start_time, Clock::now()));
+  }
+  return OkStatus();
 }
 
-StatusOr<std::vector<hal::BufferView>> BufferViewsFromConstants(
-    absl::Span<const ShapedBuffer> constants, hal::Allocator* allocator) {
-  std::vector<hal::BufferView> views;
-  for (const auto& buf_data : constants) {
-    ASSIGN_OR_RETURN(auto view, BufferViewFromConstant(buf_data, allocator));
-    views.push_back(view);
+// Claims scheduled invocations from |next_index| and runs each at its
+// scheduled time, or as soon as possible if already late.
+Status RunOpenLoop(ModuleBenchmark* module_benchmark,
+                   const ref_ptr<rt::Context>& context,
+                   Clock::time_point base_time, Clock::duration interval,
+                   int64_t invocation_count, std::atomic<int64_t>* next_index,
+                   LatencyHistogram* latency_ns) {
+  while (true) {
+    int64_t index = next_index->fetch_add(1, std::memory_order_relaxed);
+    if (index >= invocation_count) break;
+    auto scheduled_time = base_time + interval * index;
+    std::this_thread::sleep_until(scheduled_time);
+    RETURN_IF_ERROR(module_benchmark->Invoke(context));
+    latency_ns->Record(NanosecondsBetween(scheduled_time, Clock::now()));
   }
-  return views;
+  return OkStatus();
 }
+
 }  // namespace
 
-Status RunModuleBenchmark(benchmark::State& state,
-                          ref_ptr<vm::ModuleFile> main_module_file,
-                          absl::string_view main_function_name,
-                          absl::string_view driver_name,
-                          absl::Span<const ShapedBuffer> arguments_data) {
+// static
+StatusOr<std::unique_ptr<ModuleBenchmark>> ModuleBenchmark::Create(
+    ref_ptr<vm::ModuleFile> main_module_file,
+    absl::string_view main_function_name, absl::string_view driver_name,
+    absl::Span<const hal::BufferView> host_arguments) {
+  auto module_benchmark = absl::WrapUnique(new ModuleBenchmark());
   ASSIGN_OR_RETURN(auto debug_server, rt::debug::CreateDebugServerFromFlags());
-  auto instance = make_ref<rt::Instance>(std::move(debug_server));
+  module_benchmark->instance_ =
+      make_ref<rt::Instance>(std::move(debug_server));
   ASSIGN_OR_RETURN(auto driver,
                    hal::DriverRegistry::shared_registry()->Create(driver_name));
   ASSIGN_OR_RETURN(auto device, driver->CreateDefaultDevice());
-  RETURN_IF_ERROR(instance->device_manager()->RegisterDevice(add_ref(device)));
-  auto policy = make_ref<rt::Policy>();
-  auto context = make_ref<rt::Context>(add_ref(instance), std::move(policy));
+  RETURN_IF_ERROR(module_benchmark->instance_->device_manager()->RegisterDevice(
+      add_ref(device)));
 
-  ASSIGN_OR_RETURN(auto main_module,
+  ASSIGN_OR_RETURN(module_benchmark->main_module_,
                    vm::SequencerModule::FromFile(std::move(main_module_file)));
+  const auto& main_module = module_benchmark->main_module_;
 
   // Register the main module with the context.
   // We could add additional modules (specializations, shared libraries, etc).
   // ModuleFiles are stateless so we could have the same module_file used by
   // multiple contexts simultaneously.
-  RETURN_IF_ERROR(context->RegisterModule(add_ref(main_module)));
+  ASSIGN_OR_RETURN(module_benchmark->context_,
+                   module_benchmark->CreateContext());
 
-  rt::Function main_function;
+  auto& main_function = module_benchmark->main_function_;
   if (!main_function_name.empty()) {
     // User-specified main function.
     ASSIGN_OR_RETURN(main_function,
@@ -100,19 +143,147 @@ Status RunModuleBenchmark(benchmark::State& state,
               "to run";
   }
 
-  // Call into the main function.
-  ASSIGN_OR_RETURN(auto arguments, BufferViewsFromConstants(
-                                       arguments_data, device->allocator()));
+  ASSIGN_OR_RETURN(module_benchmark->arguments_,
+                   DeviceBufferViews(host_arguments, device->allocator()));
+  return module_benchmark;
+}
 
+StatusOr<ref_ptr<rt::Context>> ModuleBenchmark::CreateContext() {
+  auto context =
+      make_ref<rt::Context>(add_ref(instance_), make_ref<rt::Policy>());
+  RETURN_IF_ERROR(context->RegisterModule(add_ref(main_module_)));
+  return context;
+}
+
+Status ModuleBenchmark::Invoke(const ref_ptr<rt::Context>& context) {
+  ASSIGN_OR_RETURN(auto invocation,
+                   rt::Invocation::Create(add_ref(context), main_function_,
+                                          make_ref<rt::Policy>(), {},
+                                          absl::MakeConstSpan(arguments_)));
+  return invocation->Await(absl::InfiniteFuture());
+}
+
+
+Status RunModuleBenchmark(benchmark::State& state,
+                          ref_ptr<vm::ModuleFile> main_module_file,
+                          absl::string_view main_function_name,
+                          absl::string_view driver_name,
+                          absl::Span<const hal::BufferView> host_arguments,
+                          int warmup_iterations) {
+  ASSIGN_OR_RETURN(auto module_benchmark,
+                   ModuleBenchmark::Create(std::move(main_module_file),
+                                           main_function_name, driver_name,
+                                           host_arguments));
+  const auto& context = module_benchmark->context();
+  for (int i = 0; i < warmup_iterations; ++i) {
+    RETURN_IF_ERROR(module_benchmark->Invoke(context));
+  }
   for (auto _ : state) {
-    ASSIGN_OR_RETURN(auto invocation,
-                     rt::Invocation::Create(add_ref(context), main_function,
-                                            make_ref<rt::Policy>(), {},
-                                            absl::MakeConstSpan(arguments)));
-    RETURN_IF_ERROR(invocation->Await(absl::InfiniteFuture()));
+    RETURN_IF_ERROR(module_benchmark->Invoke(context));
   }
-
   return OkStatus();
 }
 
+double LatencyBenchmarkResult::throughput_qps() const {
+  double seconds = absl::ToDoubleSeconds(wall_time);
+  return seconds > 0.0 ? latency_ns.count() / seconds : 0.0;
+}
+
+StatusOr<LatencyBenchmarkResult> RunLatencyBenchmark(
+    ModuleBenchmark* module_benchmark, const LatencyBenchmarkOptions& options) {
+  if (options.thread_count < 1 || options.target_qps < 0.0) {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "Invalid latency benchmark options: " << options.thread_count
+           << " threads at " << options.target_qps << " QPS";
+  }
+
+  std::vector<ref_ptr<rt::Context>> contexts;
+  for (int i = 0; i < options.thread_count; ++i) {
+    if (options.shared_context) {
+      contexts.push_back(add_ref(module_benchmark->context()));
+    } else {
+      ASSIGN_OR_RETURN(auto context, module_benchmark->CreateContext());
+      contexts.push_back(std::move(context));
+    }
+  }
+
+  // Open-loop invocations are scheduled at fixed intervals from the start of
+  // the measured phase regardless of when earlier ones complete.
+  bool is_open_loop = options.target_qps > 0.0;
+  Clock::duration interval{0};
+  int64_t invocation_count = 0;
+  if (is_open_loop) {
+    interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.target_qps));
+    invocation_count = static_cast<int64_t>(
+        absl::ToDoubleSeconds(options.duration) * options.target_qps);
+  }
+  std::atomic<int64_t> next_index{0};
+
+  // Threads warm up independently and then start measuring together.
+  absl::BlockingCounter warmed_up(options.thread_count);
+  absl::Notification start_notification;
+  Clock::time_point start_time;
+  std::vector<Status> statuses(options.thread_count);
+  std::vector<LatencyHistogram> histograms(options.thread_count);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < options.thread_count; ++i) {
+    threads.emplace_back([&, i]() {
+      const auto& context = contexts[i];
+      Status status = OkStatus();
+      for (int j = 0; j < options.warmup_iterations && status.ok(); ++j) {
+        status = module_benchmark->Invoke(context);
+      }
+      warmed_up.DecrementCount();
+      start_notification.WaitForNotification();
+      if (!status.ok()) {
+        statuses[i] = std::move(status);
+      } else if (is_open_loop) {
+        statuses[i] =
+            RunOpenLoop(module_benchmark, context, start_time, interval,
+                        invocation_count, &next_index, &histograms[i]);
+      } else {
+        auto end_time =
+            start_time + absl::ToChronoNanoseconds(options.duration);
+        statuses[i] =
+            RunClosedLoop(module_benchmark, context, end_time, &histograms[i]);
+      }
+    });
+  }
+  warmed_up.Wait();
+  start_time = Clock::now();
+  start_notification.Notify();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  LatencyBenchmarkResult result;
+  result.options = options;
+  result.wall_time =
+      absl::Nanoseconds(NanosecondsBetween(start_time, Clock::now()));
+  for (int i = 0; i < options.thread_count; ++i) {
+    RETURN_IF_ERROR(statuses[i]);
+    result.latency_ns.Merge(histograms[i]);
+  }
+  return result;
+}
+
+void AppendLatencyBenchmarkJson(const LatencyBenchmarkResult& result,
+                                std::string* out) {
+  const auto& options = result.options;
+  absl::StrAppend(
+      out, "{\"mode\":\"",
+      options.target_qps > 0.0 ? "open_loop" : "closed_loop",
+      "\",\"threads\":", options.thread_count, ",\"shared_context\":",
+      options.shared_context ? "true" : "false",
+      ",\"warmup_iterations\":", options.warmup_iterations,
+      ",\"target_qps\":", options.target_qps,
+      ",\"duration_s\":", absl::ToDoubleSeconds(options.duration),
+      ",\"wall_time_s\":", absl::ToDoubleSeconds(result.wall_time),
+      ",\"invocations\":", result.latency_ns.count(),
+      ",\"throughput_qps\":", result.throughput_qps(), ",\"latency_ns\":");
+  result.latency_ns.AppendJson(out);
+  out->append("}");
+}
+
 }  // namespace iree
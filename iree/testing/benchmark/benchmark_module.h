@@ -16,21 +16,105 @@
 #define IREE_BENCHMARK_BENCHMARK_MODULE_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "benchmark/benchmark.h"
-#include "iree/base/shaped_buffer.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer_view.h"
+#include "iree/rt/context.h"
+#include "iree/rt/function.h"
+#include "iree/rt/instance.h"
+#include "iree/testing/benchmark/latency_histogram.h"
 #include "iree/vm/bytecode_module.h"
 
 namespace iree {
 
+// A module loaded on a device with its arguments, ready to be invoked
+// repeatedly from one or more threads.
+class ModuleBenchmark {
+ public:
+  // Loads |main_module_file| on a new device created from |driver_name|.
+  // |host_arguments| are typically host buffers, such as memory-mapped input
+  // files, and are made available to the device once without copies when the
+  // device can use them directly.
+  static StatusOr<std::unique_ptr<ModuleBenchmark>> Create(
+      ref_ptr<vm::ModuleFile> main_module_file,
+      absl::string_view main_function_name, absl::string_view driver_name,
+      absl::Span<const hal::BufferView> host_arguments);
+
+  ModuleBenchmark(const ModuleBenchmark&) = delete;
+  ModuleBenchmark& operator=(const ModuleBenchmark&) = delete;
+
+  // The context created along with the benchmark. Contexts may be shared by
+  // concurrent invocations.
+  const ref_ptr<rt::Context>& context() const { return context_; }
+
+  // Creates an additional context with the main module registered.
+  StatusOr<ref_ptr<rt::Context>> CreateContext();
+
+  // Invokes the main function in |context| and waits for it to complete.
+  Status Invoke(const ref_ptr<rt::Context>& context);
+
+ private:
+  ModuleBenchmark() = default;
+
+  ref_ptr<rt::Instance> instance_;
+  ref_ptr<rt::Module> main_module_;
+  ref_ptr<rt::Context> context_;
+  rt::Function main_function_;
+  std::vector<hal::BufferView> arguments_;
+};
+
+// Runs the Google Benchmark loop for |state|, invoking the main function once
+// per iteration after |warmup_iterations| unmeasured invocations.
 Status RunModuleBenchmark(benchmark::State& state,
                           ref_ptr<vm::ModuleFile> main_module_file,
                           absl::string_view main_function_name,
                           absl::string_view driver_name,
-                          absl::Span<const ShapedBuffer> arguments);
+                          absl::Span<const hal::BufferView> host_arguments,
+                          int warmup_iterations = 0);
+
+struct LatencyBenchmarkOptions {
+  // Number of threads invoking the main function concurrently. In open-loop
+  // mode this bounds the number of invocations in flight.
+  int thread_count = 1;
+  // True if all threads invoke in the benchmark context, otherwise each thread
+  // uses its own context.
+  bool shared_context = true;
+  // Unmeasured invocations made by each thread before measuring starts.
+  int warmup_iterations = 1;
+  // Length of the measured phase.
+  absl::Duration duration = absl::Seconds(5);
+  // Invocations started per second in open-loop mode. If 0 each thread starts
+  // the next invocation as soon as its previous one completes (closed loop).
+  double target_qps = 0.0;
+};
+
+struct LatencyBenchmarkResult {
+  LatencyBenchmarkOptions options;
+  // Wall time from the start of the measured phase until all invocations
+  // completed.
+  absl::Duration wall_time;
+  // Latencies of measured invocations in nanoseconds. In open-loop mode
+  // latencies are measured from the scheduled start time so that time spent
+  // waiting for a free thread is included.
+  LatencyHistogram latency_ns;
+
+  // Completed invocations per second.
+  double throughput_qps() const;
+};
+
+// Measures invocation latencies of |module_benchmark| under |options|.
+StatusOr<LatencyBenchmarkResult> RunLatencyBenchmark(
+    ModuleBenchmark* module_benchmark, const LatencyBenchmarkOptions& options);
+
+// Appends |result| as a JSON object to |out|.
+void AppendLatencyBenchmarkJson(const LatencyBenchmarkResult& result,
+                                std::string* out);
 
 }  // namespace iree
 
@@ -16,15 +16,20 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "benchmark/benchmark.h"
 #include "iree/base/file_io.h"
 #include "iree/base/init.h"
-#include "iree/base/shaped_buffer_string_util.h"
+#include "iree/base/logging.h"
+#include "iree/base/source_location.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer_view_file_util.h"
 #include "iree/testing/benchmark/benchmark_module.h"
 #include "iree/vm/bytecode_module.h"
 
@@ -32,9 +37,35 @@ ABSL_FLAG(std::string, main_module, "", "Main module with entry point.");
 ABSL_FLAG(std::string, main_function, "",
           "Function within the main module to execute.");
 
-ABSL_FLAG(std::string, input_values, "", "Input shapes and optional values.");
+ABSL_FLAG(std::string, input_values, "",
+          "Input shapes and optional values, or @file.npy/@file.npz to load "
+          "arrays and [shape]x[type]=@file to load raw data.");
 ABSL_FLAG(std::string, input_file, "",
-          "Input shapes and optional values serialized in a file.");
+          "Input shapes and optional values serialized in a file, or a "
+          ".npy/.npz file containing the inputs.");
+
+ABSL_FLAG(int, warmup_iterations, 1,
+          "Unmeasured invocations made before measuring (per thread in "
+          "latency modes).");
+
+ABSL_FLAG(std::string, latency_mode, "",
+          "Measures the invocation latency distribution instead of running "
+          "Google Benchmark: closed_loop runs each thread back-to-back and "
+          "open_loop starts invocations at a fixed rate (see --target_qps).");
+ABSL_FLAG(std::string, threads, "1",
+          "Comma delimited list of thread counts to sweep in latency modes. "
+          "In open_loop mode this is the maximum number of invocations in "
+          "flight.");
+ABSL_FLAG(std::string, context_sharing, "shared",
+          "Comma delimited list of shared/per_thread to sweep whether threads "
+          "share one context or each use their own.");
+ABSL_FLAG(std::string, target_qps, "100",
+          "Comma delimited list of invocation rates to sweep in open_loop "
+          "mode.");
+ABSL_FLAG(absl::Duration, latency_duration, absl::Seconds(5),
+          "Measured duration of each latency run.");
+ABSL_FLAG(std::string, latency_json_output, "",
+          "File to write latency results to as JSON; stdout if empty.");
 
 namespace iree {
 namespace {
@@ -45,39 +76,153 @@ namespace {
 //   [shape]xtype=[value]
 // Example:
 //   4x4xi8=0,1,2,3
-StatusOr<std::vector<ShapedBuffer>> ParseInputsFromString(
+// Binary data can be loaded from files with @file.npy, @file.npz, or
+// [shape]xtype=@file for raw data.
+StatusOr<std::vector<hal::BufferView>> ParseInputsFromString(
     absl::string_view contents) {
-  std::vector<ShapedBuffer> inputs;
+  std::vector<hal::BufferView> inputs;
   for (const auto& line :
        absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
-    ASSIGN_OR_RETURN(auto input, ParseShapedBufferFromString(line));
-    inputs.push_back(std::move(input));
+    ASSIGN_OR_RETURN(auto line_inputs, hal::ParseBufferViewsFromSpec(line));
+    for (auto& input : line_inputs) {
+      inputs.push_back(std::move(input));
+    }
   }
   return inputs;
 }
 
-Status Run(benchmark::State& state) {
+StatusOr<ref_ptr<vm::ModuleFile>> LoadModuleFileFromFlags() {
   ASSIGN_OR_RETURN(
       auto main_module_file,
       vm::ModuleFile::LoadFile(ModuleDefIdentifier(),
                                absl::GetFlag(FLAGS_main_module)),
       _ << "while loading module file " << absl::GetFlag(FLAGS_main_module));
+  return main_module_file;
+}
 
-  std::string arguments_file_contents;
+StatusOr<std::vector<hal::BufferView>> ParseInputsFromFlags() {
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
   if (!absl::GetFlag(FLAGS_input_values).empty()) {
-    arguments_file_contents =
+    std::string input_values =
         absl::StrReplaceAll(absl::GetFlag(FLAGS_input_values), {{"\\n", "\n"}});
-  } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
-    ASSIGN_OR_RETURN(arguments_file_contents,
-                     file_io::GetFileContents(absl::GetFlag(FLAGS_input_file)));
+    return ParseInputsFromString(input_values);
+  } else if (hal::IsNpyFilePath(input_file)) {
+    return hal::LoadBufferViewsFromFile(input_file);
+  } else if (!input_file.empty()) {
+    ASSIGN_OR_RETURN(auto arguments_file_contents,
+                     file_io::GetFileContents(input_file));
+    return ParseInputsFromString(arguments_file_contents);
   }
+  return std::vector<hal::BufferView>{};
+}
 
-  ASSIGN_OR_RETURN(auto arguments,
-                   ParseInputsFromString(arguments_file_contents));
-
+Status Run(benchmark::State& state) {
+  ASSIGN_OR_RETURN(auto main_module_file, LoadModuleFileFromFlags());
+  ASSIGN_OR_RETURN(auto arguments, ParseInputsFromFlags());
   return RunModuleBenchmark(state, std::move(main_module_file),
                             absl::GetFlag(FLAGS_main_function),
-                            /*driver_name=*/"interpreter", arguments);
+                            /*driver_name=*/"interpreter", arguments,
+                            absl::GetFlag(FLAGS_warmup_iterations));
+}
+
+// Parses a comma delimited list of numbers from a flag value.
+template <typename T>
+StatusOr<std::vector<T>> ParseNumberList(absl::string_view flag_name,
+                                         absl::string_view value) {
+  std::vector<T> numbers;
+  for (auto number_str :
+       absl::StrSplit(value, absl::ByAnyChar(", "), absl::SkipWhitespace())) {
+    double number = 0.0;
+    if (!absl::SimpleAtod(number_str, &number) || number <= 0.0) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "--" << flag_name << "= has invalid value '" << number_str
+             << "'";
+    }
+    numbers.push_back(static_cast<T>(number));
+  }
+  return numbers;
+}
+
+// Runs the latency benchmark for each combination of options swept by the
+// flags and writes the results as JSON.
+Status RunLatencySweep() {
+  std::string latency_mode = absl::GetFlag(FLAGS_latency_mode);
+  if (latency_mode != "closed_loop" && latency_mode != "open_loop") {
+    return InvalidArgumentErrorBuilder(IREE_LOC)
+           << "--latency_mode= must be closed_loop or open_loop but was '"
+           << latency_mode << "'";
+  }
+  bool is_open_loop = latency_mode == "open_loop";
+  ASSIGN_OR_RETURN(
+      auto thread_counts,
+      ParseNumberList<int>("threads", absl::GetFlag(FLAGS_threads)));
+  std::vector<double> target_qps_values = {0.0};
+  if (is_open_loop) {
+    ASSIGN_OR_RETURN(target_qps_values,
+                     ParseNumberList<double>("target_qps",
+                                             absl::GetFlag(FLAGS_target_qps)));
+  }
+  std::vector<bool> shared_context_values;
+  for (auto sharing : absl::StrSplit(absl::GetFlag(FLAGS_context_sharing),
+                                     absl::ByAnyChar(", "),
+                                     absl::SkipWhitespace())) {
+    if (sharing != "shared" && sharing != "per_thread") {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "--context_sharing= must list shared or per_thread but has '"
+             << sharing << "'";
+    }
+    shared_context_values.push_back(sharing == "shared");
+  }
+
+  ASSIGN_OR_RETURN(auto main_module_file, LoadModuleFileFromFlags());
+  ASSIGN_OR_RETURN(auto arguments, ParseInputsFromFlags());
+  ASSIGN_OR_RETURN(auto module_benchmark,
+                   ModuleBenchmark::Create(std::move(main_module_file),
+                                           absl::GetFlag(FLAGS_main_function),
+                                           /*driver_name=*/"interpreter",
+                                           arguments));
+
+  std::string json =
+      absl::StrCat("{\"main_module\":\"",
+                   absl::CEscape(absl::GetFlag(FLAGS_main_module)),
+                   "\",\"main_function\":\"",
+                   absl::CEscape(absl::GetFlag(FLAGS_main_function)),
+                   "\",\"runs\":[");
+  bool is_first_run = true;
+  for (bool shared_context : shared_context_values) {
+    for (double target_qps : target_qps_values) {
+      for (int thread_count : thread_counts) {
+        LatencyBenchmarkOptions options;
+        options.thread_count = thread_count;
+        options.shared_context = shared_context;
+        options.warmup_iterations = absl::GetFlag(FLAGS_warmup_iterations);
+        options.duration = absl::GetFlag(FLAGS_latency_duration);
+        options.target_qps = target_qps;
+        ASSIGN_OR_RETURN(auto result, RunLatencyBenchmark(
+                                          module_benchmark.get(), options));
+        const auto& latency_ns = result.latency_ns;
+        LOG(INFO) << latency_mode << " threads=" << thread_count
+                  << (shared_context ? " shared" : " per_thread")
+                  << (is_open_loop ? absl::StrCat(" qps=", target_qps) : "")
+                  << ": " << result.throughput_qps() << " invocations/s, p50 "
+                  << latency_ns.ValueAtPercentile(50.0) << "ns, p99 "
+                  << latency_ns.ValueAtPercentile(99.0) << "ns, p99.9 "
+                  << latency_ns.ValueAtPercentile(99.9) << "ns";
+        if (!is_first_run) json += ",";
+        json += "\n";
+        AppendLatencyBenchmarkJson(result, &json);
+        is_first_run = false;
+      }
+    }
+  }
+  json += "\n]}\n";
+
+  std::string output_path = absl::GetFlag(FLAGS_latency_json_output);
+  if (output_path.empty()) {
+    std::cout << json;
+    return OkStatus();
+  }
+  return file_io::SetFileContents(output_path, json);
 }
 
 void BM_RunModule(benchmark::State& state) {
@@ -99,6 +244,10 @@ extern "C" int main(int argc, char** argv) {
   // InitializeEnvironment to avoid failures on unknown flags.
   ::benchmark::Initialize(&argc, argv);
   InitializeEnvironment(&argc, &argv);
+  if (!absl::GetFlag(FLAGS_latency_mode).empty()) {
+    CHECK_OK(RunLatencySweep());
+    return 0;
+  }
   size_t run_benchmark_count = ::benchmark::RunSpecifiedBenchmarks();
   CHECK_GT(run_benchmark_count, 0) << "No benchmarks were run";
   return 0;
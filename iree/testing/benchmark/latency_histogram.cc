@@ -0,0 +1,113 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/testing/benchmark/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+#include "iree/base/logging.h"
+#include "iree/base/math.h"
+
+namespace iree {
+
+constexpr int LatencyHistogram::kDefaultSignificantBits;
+
+LatencyHistogram::LatencyHistogram(int significant_bits)
+    : significant_bits_(significant_bits) {
+  CHECK(significant_bits >= 2 && significant_bits <= 16)
+      << "Unsupported histogram precision " << significant_bits;
+}
+
+int LatencyHistogram::BucketIndex(uint64_t value) const {
+  uint64_t sub_bucket_count = uint64_t{1} << significant_bits_;
+  if (value < sub_bucket_count) return static_cast<int>(value);
+  // Values in [2^(b+m-1), 2^(b+m)) are shifted right by m so that the top b
+  // bits select one of the upper half of the sub-buckets.
+  int magnitude = 64 - CountLeadingZeros64(value) - significant_bits_;
+  uint64_t sub_bucket = value >> magnitude;
+  return static_cast<int>(magnitude * (sub_bucket_count / 2) + sub_bucket);
+}
+
+int64_t LatencyHistogram::BucketMaxValue(int index) const {
+  int sub_bucket_count = 1 << significant_bits_;
+  if (index < sub_bucket_count) return index;
+  int half_count = sub_bucket_count / 2;
+  int magnitude = (index - sub_bucket_count) / half_count + 1;
+  int64_t sub_bucket = index - magnitude * half_count;
+  return ((sub_bucket + 1) << magnitude) - 1;
+}
+
+void LatencyHistogram::Record(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  int index = BucketIndex(static_cast<uint64_t>(value));
+  if (index >= counts_.size()) counts_.resize(index + 1);
+  ++counts_[index];
+  min_ = count_ ? std::min(min_, value) : value;
+  max_ = std::max(max_, value);
+  sum_ += value;
+  ++count_;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  CHECK_EQ(significant_bits_, other.significant_bits_);
+  if (!other.count_) return;
+  if (other.counts_.size() > counts_.size()) {
+    counts_.resize(other.counts_.size());
+  }
+  for (int i = 0; i < other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  min_ = count_ ? std::min(min_, other.min_) : other.min_;
+  max_ = std::max(max_, other.max_);
+  sum_ += other.sum_;
+  count_ += other.count_;
+}
+
+void LatencyHistogram::Reset() {
+  counts_.clear();
+  count_ = 0;
+  sum_ = 0;
+  min_ = 0;
+  max_ = 0;
+}
+
+int64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  if (!count_) return 0;
+  if (percentile <= 0.0) return min_;
+  int64_t target_count = static_cast<int64_t>(
+      std::ceil(std::min(percentile, 100.0) / 100.0 * count_));
+  target_count = std::max<int64_t>(target_count, 1);
+  int64_t running_count = 0;
+  for (int i = 0; i < counts_.size(); ++i) {
+    running_count += counts_[i];
+    if (running_count >= target_count) {
+      return std::max(min_, std::min(BucketMaxValue(i), max_));
+    }
+  }
+  return max_;
+}
+
+void LatencyHistogram::AppendJson(std::string* out) const {
+  absl::StrAppend(out, "{\"count\":", count_, ",\"min\":", min(),
+                  ",\"mean\":", static_cast<int64_t>(std::round(mean())),
+                  ",\"p50\":", ValueAtPercentile(50.0),
+                  ",\"p90\":", ValueAtPercentile(90.0),
+                  ",\"p99\":", ValueAtPercentile(99.0),
+                  ",\"p99.9\":", ValueAtPercentile(99.9), ",\"max\":", max_,
+                  "}");
+}
+
+}  // namespace iree
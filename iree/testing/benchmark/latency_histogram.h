@@ -0,0 +1,83 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_TESTING_BENCHMARK_LATENCY_HISTOGRAM_H_
+#define IREE_TESTING_BENCHMARK_LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace iree {
+
+// A high dynamic range histogram of non-negative integer values, such as
+// latencies in nanoseconds, in the style of HdrHistogram.
+//
+// Values are recorded into log-linear buckets: each power of two range is
+// split into 2^(significant_bits - 1) linear sub-buckets, bounding the relative
+// error of reported values to 2^-(significant_bits - 1) regardless of
+// magnitude. Values below 2^significant_bits are recorded exactly. Memory use
+// grows with the log of the largest value recorded.
+//
+// Recording is not thread-safe; record into one histogram per thread and
+// Merge them afterwards.
+class LatencyHistogram {
+ public:
+  // The default precision is better than 1%.
+  static constexpr int kDefaultSignificantBits = 8;
+
+  explicit LatencyHistogram(int significant_bits = kDefaultSignificantBits);
+
+  // Records a single value. Negative values are recorded as 0.
+  void Record(int64_t value);
+
+  // Adds all values recorded in |other|, which must have the same precision.
+  void Merge(const LatencyHistogram& other);
+
+  // Removes all recorded values.
+  void Reset();
+
+  int64_t count() const { return count_; }
+  int64_t min() const { return count_ ? min_ : 0; }
+  int64_t max() const { return max_; }
+  double mean() const {
+    return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+  }
+
+  // Returns the smallest value such that |percentile| percent of recorded
+  // values are less than or equal to it, within the histogram precision.
+  // |percentile| is in [0, 100]; 0 returns the minimum and 100 the maximum.
+  int64_t ValueAtPercentile(double percentile) const;
+
+  // Appends a JSON object with the count, min, mean, max and common
+  // percentiles (p50/p90/p99/p99.9) to |out|.
+  void AppendJson(std::string* out) const;
+
+ private:
+  // Returns the bucket index that |value| is recorded in.
+  int BucketIndex(uint64_t value) const;
+  // Returns the largest value recorded in the bucket at |index|.
+  int64_t BucketMaxValue(int index) const;
+
+  int significant_bits_;
+  std::vector<int64_t> counts_;
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+};
+
+}  // namespace iree
+
+#endif  // IREE_TESTING_BENCHMARK_LATENCY_HISTOGRAM_H_
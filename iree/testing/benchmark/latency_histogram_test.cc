@@ -0,0 +1,100 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/testing/benchmark/latency_histogram.h"
+
+#include <cstdint>
+#include <string>
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace {
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.min());
+  EXPECT_EQ(0, histogram.max());
+  EXPECT_EQ(0.0, histogram.mean());
+  EXPECT_EQ(0, histogram.ValueAtPercentile(50.0));
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram(/*significant_bits=*/4);
+  for (int i = 1; i <= 10; ++i) {
+    histogram.Record(i);
+  }
+  histogram.Record(-5);
+  EXPECT_EQ(11, histogram.count());
+  EXPECT_EQ(0, histogram.min());
+  EXPECT_EQ(10, histogram.max());
+  EXPECT_EQ(0, histogram.ValueAtPercentile(0.0));
+  EXPECT_EQ(5, histogram.ValueAtPercentile(50.0));
+  EXPECT_EQ(10, histogram.ValueAtPercentile(99.0));
+  EXPECT_EQ(10, histogram.ValueAtPercentile(100.0));
+}
+
+TEST(LatencyHistogramTest, RelativePrecision) {
+  LatencyHistogram histogram;
+  // Uniform values spanning several orders of magnitude.
+  for (int64_t i = 1; i <= 100000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  EXPECT_EQ(100000, histogram.count());
+  EXPECT_EQ(1000, histogram.min());
+  EXPECT_EQ(100000000, histogram.max());
+  EXPECT_NEAR(50000500.0, histogram.mean(), 1.0);
+  const double kTolerance = 1.0 / (1 << 7);
+  for (double percentile : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+    double expected = percentile * 1000000.0;
+    EXPECT_NEAR(expected, histogram.ValueAtPercentile(percentile),
+                expected * kTolerance)
+        << "p" << percentile;
+  }
+}
+
+TEST(LatencyHistogramTest, Merge) {
+  LatencyHistogram a;
+  LatencyHistogram b;
+  for (int i = 0; i < 99; ++i) {
+    a.Record(1000);
+  }
+  b.Record(1000000000);
+  a.Merge(b);
+  EXPECT_EQ(100, a.count());
+  EXPECT_EQ(1000, a.min());
+  EXPECT_EQ(1000000000, a.max());
+  EXPECT_NEAR(1000, a.ValueAtPercentile(99.0), 1000 / 128);
+  EXPECT_EQ(1000000000, a.ValueAtPercentile(100.0));
+
+  a.Reset();
+  EXPECT_EQ(0, a.count());
+  a.Merge(b);
+  EXPECT_EQ(1000000000, a.min());
+}
+
+TEST(LatencyHistogramTest, Json) {
+  LatencyHistogram histogram;
+  histogram.Record(100);
+  std::string json;
+  histogram.AppendJson(&json);
+  EXPECT_EQ(
+      "{\"count\":1,\"min\":100,\"mean\":100,\"p50\":100,\"p90\":100,"
+      "\"p99\":100,\"p99.9\":100,\"max\":100}",
+      json);
+}
+
+}  // namespace
+}  // namespace iree
@@ -25,7 +25,9 @@
 #include "iree/base/init.h"
 #include "iree/base/source_location.h"
 #include "iree/base/status.h"
+#include "iree/hal/buffer_view_file_util.h"
 #include "iree/hal/buffer_view_string_util.h"
+#include "iree/hal/dispatch_profile.h"
 #include "iree/hal/driver_registry.h"
 #include "iree/rt/context.h"
 #include "iree/rt/debug/debug_server_flags.h"
@@ -41,13 +43,19 @@ ABSL_FLAG(std::string, main_function, "",
 ABSL_FLAG(bool, print_disassembly, true,
           "Prints bytecode disassembly for the module.");
 
-ABSL_FLAG(std::string, input_values, "", "Input shapes and optional values.");
+ABSL_FLAG(std::string, input_values, "",
+          "Input shapes and optional values, or @file.npy/@file.npz to load "
+          "arrays and [shape]x[type]=@file to load raw data.");
 ABSL_FLAG(std::string, input_file, "",
-          "Input shapes and optional values serialized in a file.");
+          "Input shapes and optional values serialized in a file, or a "
+          ".npy/.npz file containing the inputs.");
 
 ABSL_FLAG(std::string, output_types, "",
           "Output data types (comma delimited list of b/i/u/f for "
           "binary/signed int/unsigned int/float).");
+ABSL_FLAG(std::string, output_file, "",
+          "Saves results to a .npz file (or a .npy or raw file for a single "
+          "result) instead of printing them.");
 
 namespace iree {
 namespace {
@@ -58,22 +66,29 @@ namespace {
 //   [shape]xtype=[value]
 // Example:
 //   4x4xi8=0,1,2,3
+// Binary data can be loaded from files with @file.npy, @file.npz, or
+// [shape]xtype=@file for raw data. A --input_file ending in .npy or .npz
+// provides all inputs.
 StatusOr<std::vector<hal::BufferView>> ParseInputsFromFlags(
     hal::Allocator* allocator) {
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
   std::string file_contents;
   if (!absl::GetFlag(FLAGS_input_values).empty()) {
     file_contents =
         absl::StrReplaceAll(absl::GetFlag(FLAGS_input_values), {{"\\n", "\n"}});
-  } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
-    ASSIGN_OR_RETURN(file_contents,
-                     file_io::GetFileContents(absl::GetFlag(FLAGS_input_file)));
+  } else if (hal::IsNpyFilePath(input_file)) {
+    return hal::LoadBufferViewsFromFile(input_file, allocator);
+  } else if (!input_file.empty()) {
+    ASSIGN_OR_RETURN(file_contents, file_io::GetFileContents(input_file));
   }
   std::vector<hal::BufferView> inputs;
   for (const auto& line :
        absl::StrSplit(file_contents, '\n', absl::SkipWhitespace())) {
-    ASSIGN_OR_RETURN(auto input,
-                     hal::ParseBufferViewFromString(line, allocator));
-    inputs.push_back(input);
+    ASSIGN_OR_RETURN(auto line_inputs,
+                     hal::ParseBufferViewsFromSpec(line, allocator));
+    for (auto& input : line_inputs) {
+      inputs.push_back(std::move(input));
+    }
   }
   return inputs;
 }
@@ -144,6 +159,12 @@ Status Run() {
   RETURN_IF_ERROR(invocation->Await(absl::InfiniteFuture()));
   ASSIGN_OR_RETURN(auto results, invocation->ConsumeResults());
 
+  // Report dispatch measurements if the device was asked to profile them.
+  if (auto* dispatch_profile = device->dispatch_profile()) {
+    std::cout << "Dispatch profile:\n"
+              << hal::FormatDispatchProfile(*dispatch_profile) << "\n";
+  }
+
   // Dump all results to stdout.
   std::vector<std::string> output_types =
       absl::StrSplit(absl::GetFlag(FLAGS_output_types), absl::ByAnyChar(", "),
@@ -153,12 +174,19 @@ Status Run() {
            << "--output_types= specified but has " << output_types.size()
            << " types when the function returns " << results.size();
   }
+  std::vector<BufferDataPrintMode> print_modes;
+  for (const auto& output_type : output_types) {
+    ASSIGN_OR_RETURN(auto print_mode, ParseBufferDataPrintMode(output_type));
+    print_modes.push_back(print_mode);
+  }
+  if (!absl::GetFlag(FLAGS_output_file).empty()) {
+    return hal::SaveBufferViewsToFile(absl::GetFlag(FLAGS_output_file),
+                                      results, print_modes);
+  }
   for (int i = 0; i < results.size(); ++i) {
     const auto& result = results[i];
-    auto print_mode = BufferDataPrintMode::kFloatingPoint;
-    if (!output_types.empty()) {
-      ASSIGN_OR_RETURN(print_mode, ParseBufferDataPrintMode(output_types[i]));
-    }
+    auto print_mode = print_modes.empty() ? BufferDataPrintMode::kFloatingPoint
+                                          : print_modes[i];
     ASSIGN_OR_RETURN(auto result_str,
                      PrintBufferViewToString(result, print_mode, 1024));
     const auto& buffer = result.buffer;
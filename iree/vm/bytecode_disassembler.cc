@@ -101,6 +101,8 @@ std::string ConstantToString(const Type& type,
       return TypedDataToString<float>(bytes);
     case BuiltinType::kF64:
       return TypedDataToString<double>(bytes);
+    case BuiltinType::kBF16:
+      return TypedDataToString<uint16_t>(bytes);
     default:
       return "<unsupported>";
   }
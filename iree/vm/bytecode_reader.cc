@@ -59,10 +59,6 @@ Status BytecodeReader::ReadShape(Shape* out_shape) {
 StatusOr<Shape> BytecodeReader::ReadShapePieces() {
   // TODO(benvanik): rewrite to be faster (multiple offsets to walk both lists).
   ASSIGN_OR_RETURN(auto shape_dims, ReadIndexList());
-  if (shape_dims.size() >= kMaxRank) {
-    return UnimplementedErrorBuilder(IREE_LOC)
-           << "Shapes limited to rank " << kMaxRank << " right now";
-  }
   int expected_dynamic_dims = 0;
   for (int i = 0; i < shape_dims.size(); ++i) {
     if (shape_dims[i] == -1) {
@@ -87,7 +83,7 @@ StatusOr<Shape> BytecodeReader::ReadShapePieces() {
         return InvalidArgumentErrorBuilder(IREE_LOC)
                << "Dims piece has rank " << dims_piece.size() << "; must be 1";
       }
-      shape[i] = dims_piece[0];
+      shape.set_dim(i, dims_piece[0]);
     }
   }
   return shape;
@@ -133,6 +129,7 @@ Status BytecodeReader::SwitchStackFrame(StackFrame* new_stack_frame) {
   bytecode_limit_ = bytecode_base_ + bytecode.contents()->size();
   bytecode_pc_ = bytecode_base_ + new_stack_frame->offset();
   registers_ = new_stack_frame->mutable_registers();
+  stack_size_ = bytecode.stack_size();
   return OkStatus();
 }
 
@@ -237,7 +234,7 @@ StatusOr<BufferView> BytecodeReader::ReadConstant() {
       // TODO(benvanik): replace with fancy constant pool and such.
       // NOTE: this is not much different than if a alloc_heap+broadcast pair
       // had been in the IR.
-      buffer_view.buffer = hal::HeapBuffer::Allocate(
+      buffer_view.buffer = hal::HeapBuffer::AllocateUninitialized(
           hal::MemoryType::kHostLocal, hal::BufferUsage::kAll,
           buffer_view.byte_length());
       switch (buffer_view.element_size) {
@@ -36,6 +36,9 @@ class BytecodeReader {
 
   StatusOr<const uint8_t*> AdvanceOffset();
 
+  // Size in bytes of the stack arena required by the current function.
+  int32_t stack_size() const { return stack_size_; }
+
   Status SwitchStackFrame(rt::StackFrame* new_stack_frame);
   Status BranchToOffset(int32_t offset);
 
@@ -47,6 +50,18 @@ class BytecodeReader {
 
   StatusOr<hal::BufferView> ReadConstant();
 
+  // Returns the module containing the current function if |ptr| points into the
+  // function bytecode (such as dense constant data returned by ReadConstant)
+  // and nullptr otherwise. Such data is immutable and lives as long as the
+  // module.
+  const rt::Module* LookupBytecodeOwner(const void* ptr) const {
+    const uint8_t* byte_ptr = static_cast<const uint8_t*>(ptr);
+    if (byte_ptr < bytecode_base_ || byte_ptr >= bytecode_limit_) {
+      return nullptr;
+    }
+    return &stack_frame_->module();
+  }
+
   ABSL_ATTRIBUTE_ALWAYS_INLINE StatusOr<int> ReadCount() {
     return ReadValue<uint8_t>();
   }
@@ -161,6 +176,7 @@ class BytecodeReader {
   const uint8_t* bytecode_limit_ = nullptr;
   const uint8_t* bytecode_pc_ = nullptr;
   rt::Registers* registers_ = nullptr;
+  int32_t stack_size_ = 0;
 };
 
 }  // namespace vm
@@ -274,6 +274,11 @@ Status DispatchSequence(const hal::DevicePlacement& placement, rt::Stack* stack,
     executable_spec.executable_data = absl::Span<const uint8_t>(
         executable_def->contents()->data(), executable_def->contents()->size());
     auto executable_cache = placement.device->CreateExecutableCache();
+    auto caching_mode = hal::ExecutableCachingMode::kDefault |
+                        hal::ExecutableCachingMode::kAliasProvidedData;
+    if (placement.device->dispatch_profile()) {
+      caching_mode |= hal::ExecutableCachingMode::kEnableProfiling;
+    }
     ref_ptr<hal::Executable> executable;
     for (auto* executable_def : *multi_arch_executable_def->executables()) {
       if (!executable_cache->CanPrepareFormat(executable_def->format())) {
@@ -284,12 +289,10 @@ Status DispatchSequence(const hal::DevicePlacement& placement, rt::Stack* stack,
       executable_spec.executable_data =
           absl::Span<const uint8_t>(executable_def->contents()->data(),
                                     executable_def->contents()->size());
-      ASSIGN_OR_RETURN(executable,
-                       executable_cache->PrepareExecutable(
-                           hal::ExecutableCachingMode::kDefault |
-                               hal::ExecutableCachingMode::kAliasProvidedData,
-                           executable_spec),
-                       _.LogError());
+      ASSIGN_OR_RETURN(
+          executable,
+          executable_cache->PrepareExecutable(caching_mode, executable_spec),
+          _.LogError());
       break;
     }
     if (!executable) {
@@ -373,13 +376,22 @@ Status DispatchSequence(const hal::DevicePlacement& placement, rt::Stack* stack,
     dst_local->shape = shape;
 
     // TODO(benvanik): pick an allocator and use that instead.
-    CHECK_EQ(heap_type, 0);
+    auto heap_flags = static_cast<AllocHeapFlagBitfield>(heap_type);
+    CHECK_EQ(heap_type & ~static_cast<int32_t>(AllocHeapFlag::kUninitialized),
+             0);
     auto* allocator = placement.device->allocator();
-    ASSIGN_OR_RETURN(
-        dst_local->buffer,
-        allocator->Allocate(
-            hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible,
-            hal::BufferUsage::kAll, allocation_size));
+    auto memory_type =
+        hal::MemoryType::kHostLocal | hal::MemoryType::kDeviceVisible;
+    if (AnyBitSet(heap_flags & AllocHeapFlag::kUninitialized)) {
+      ASSIGN_OR_RETURN(dst_local->buffer,
+                       allocator->AllocateUninitialized(
+                           memory_type, hal::BufferUsage::kAll,
+                           allocation_size));
+    } else {
+      ASSIGN_OR_RETURN(dst_local->buffer,
+                       allocator->Allocate(memory_type, hal::BufferUsage::kAll,
+                                           allocation_size));
+    }
   });
 
   DISPATCH_CORE_OPCODE(kDiscard, {
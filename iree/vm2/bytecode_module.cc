@@ -462,6 +462,7 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
     ref->ref_object.counter = 1;
     ref->data.data = segment->data()->Data();
     ref->data.data_length = segment->data()->size();
+    ref->module = &module->interface;
   }
 
   *out_module_state = (iree_vm_module_state_t*)state;
@@ -595,3 +596,34 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_bytecode_module_create(
   *out_module = &module->interface;
   return IREE_STATUS_OK;
 }
+
+// Conforms to iree_allocator_t::free and releases the file mapping in |self|
+// once the module no longer references the mapped |ptr|.
+static iree_status_t iree_vm_bytecode_module_release_file_mapping(void* self,
+                                                                  void* ptr) {
+  return iree_file_mapping_release((iree_file_mapping_t*)self);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_bytecode_module_create_from_file(iree_string_view_t path,
+                                         iree_allocator_t allocator,
+                                         iree_vm_module_t** out_module) {
+  if (!out_module) return IREE_STATUS_INVALID_ARGUMENT;
+  *out_module = NULL;
+
+  iree_file_mapping_t* file_mapping = NULL;
+  IREE_API_RETURN_IF_API_ERROR(
+      iree_file_mapping_open_read(path, allocator, &file_mapping));
+  iree_byte_span_t file_data = iree_file_mapping_data(file_mapping);
+
+  // The module takes ownership of the mapping and releases it on destruction.
+  iree_allocator_t file_mapping_allocator = {
+      file_mapping, NULL, iree_vm_bytecode_module_release_file_mapping};
+  iree_status_t status = iree_vm_bytecode_module_create(
+      iree_const_byte_span_t{file_data.data, file_data.data_length},
+      file_mapping_allocator, allocator, out_module);
+  if (status != IREE_STATUS_OK) {
+    iree_file_mapping_release(file_mapping);
+  }
+  return status;
+}
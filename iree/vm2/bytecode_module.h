@@ -33,6 +33,16 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_bytecode_module_create(
     iree_allocator_t flatbuffer_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from the ModuleDef FlatBuffer file at |path|.
+// The file is memory mapped and accessed in place for the lifetime of the
+// module: only pages that are used are read and read-only data segments (such
+// as large constants) can be referenced without copying. The mapping is shared
+// with any other process that maps the same file.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_bytecode_module_create_from_file(iree_string_view_t path,
+                                         iree_allocator_t allocator,
+                                         iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -62,10 +62,14 @@ extern "C" {
 // The built-in constant buffer type.
 // This simply points at a span of memory. The memory could be owned (in which
 // case a destroy function must be provided) or unowned (NULL destroy function).
+// Unowned memory may live within |module| (such as bytecode module rodata), in
+// which case it remains valid for as long as the module is retained even after
+// the buffer itself has been released.
 typedef struct {
   iree_vm_ref_object_t ref_object;
   iree_const_byte_span_t data;
   iree_vm_ref_destroy_t destroy;
+  struct iree_vm_module* module;
 } iree_vm_ro_byte_buffer_t;
 
 // Returns the type ID of the iree_vm_ro_byte_buffer_ref_t type.
@@ -0,0 +1,24 @@
+// RUN: iree-run-mlir2 -iree-hal-target-backends=interpreter-bytecode -input-value="1x3x3x1xf32=1 2 3 4 5 6 7 8 9" %s | IreeFileCheck %s
+
+// CHECK-LABEL: EXEC @conv2d_padded
+func @conv2d_padded(%arg0: tensor<1x3x3x1xf32>) -> tensor<1x3x3x1xf32> {
+  %filter = constant dense<1.0> : tensor<3x3x1x1xf32>
+  %0 = "xla_hlo.conv"(%arg0, %filter) {batch_group_count = 1 : i64, dimension_numbers = {input_batch_dimension = 0 : i64, input_feature_dimension = 3 : i64, input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>, kernel_input_feature_dimension = 2 : i64, kernel_output_feature_dimension = 3 : i64, kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>, output_batch_dimension = 0 : i64, output_feature_dimension = 3 : i64, output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>}, feature_group_count = 1 : i64, padding = dense<1> : tensor<2x2xi64>, rhs_dilation = dense<1> : tensor<2xi64>, window_strides = dense<1> : tensor<2xi64>} : (tensor<1x3x3x1xf32>, tensor<3x3x1x1xf32>) -> tensor<1x3x3x1xf32>
+  return %0 : tensor<1x3x3x1xf32>
+}
+
+// CHECK:      1x3x3x1xf32=[
+// CHECK-SAME: [12][21][16]][
+// CHECK-SAME: [27][45][33]][
+// CHECK-SAME: [24][39][28]]
+
+// CHECK-LABEL: EXEC @conv2d_strided
+func @conv2d_strided(%arg0: tensor<1x3x3x1xf32>) -> tensor<1x2x2x1xf32> {
+  %filter = constant dense<1.0> : tensor<3x3x1x1xf32>
+  %0 = "xla_hlo.conv"(%arg0, %filter) {batch_group_count = 1 : i64, dimension_numbers = {input_batch_dimension = 0 : i64, input_feature_dimension = 3 : i64, input_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>, kernel_input_feature_dimension = 2 : i64, kernel_output_feature_dimension = 3 : i64, kernel_spatial_dimensions = dense<[0, 1]> : tensor<2xi64>, output_batch_dimension = 0 : i64, output_feature_dimension = 3 : i64, output_spatial_dimensions = dense<[1, 2]> : tensor<2xi64>}, feature_group_count = 1 : i64, padding = dense<1> : tensor<2x2xi64>, rhs_dilation = dense<1> : tensor<2xi64>, window_strides = dense<2> : tensor<2xi64>} : (tensor<1x3x3x1xf32>, tensor<3x3x1x1xf32>) -> tensor<1x2x2x1xf32>
+  return %0 : tensor<1x2x2x1xf32>
+}
+
+// CHECK:      1x2x2x1xf32=[
+// CHECK-SAME: [12][16]][
+// CHECK-SAME: [24][28]]
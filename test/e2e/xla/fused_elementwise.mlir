@@ -0,0 +1,25 @@
+// RUN: iree-run-mlir2 -iree-hal-target-backends=interpreter-bytecode -input-value="4xf32= 0 1 2 4" -input-value="4xf32= 1 1 1 1" %s | IreeFileCheck %s
+
+// Chains of elementwise ops are fused into a single fused_elementwise_f op.
+
+// CHECK-LABEL: EXEC @chain
+func @chain(%x : tensor<4xf32>, %y : tensor<4xf32>) -> tensor<4xf32> {
+  %zero = constant dense<0.0> : tensor<4xf32>
+  %0 = "xla_hlo.mul"(%x, %x) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "xla_hlo.sub"(%0, %y) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %2 = "xla_hlo.max"(%1, %zero) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %2 : tensor<4xf32>
+}
+// CHECK: 4xf32=0 0 3 15
+
+// -----
+
+// CHECK-LABEL: EXEC @sharedIntermediate
+func @sharedIntermediate(%x : tensor<4xf32>, %y : tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %0 = "xla_hlo.add"(%x, %y) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "xla_hlo.mul"(%0, %0) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %2 = "xla_hlo.sub"(%1, %x) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %0, %2 : tensor<4xf32>, tensor<4xf32>
+}
+// CHECK: 4xf32=1 2 3 5
+// CHECK: 4xf32=1 3 7 21